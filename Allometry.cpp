@@ -6,6 +6,8 @@
 #include "Plot.h"
 #include "ModelMath.h"
 #include "ParsingFunctions.h"
+#include "TreeSnapshot.h"
+#include "TaskPool.h"
 
 using namespace whyDead;
 using namespace std;
@@ -116,7 +118,9 @@ clAllometry::clAllometry(clTreePopulation *p_oPop) {
 
   m_iNumSpecies = 0;
   m_fMaxCrownRad = 0;
+  m_fNCICrownReach = 0;
   m_fMinSaplingHeight = 0;
+  m_bCrownsThreadSafe = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -300,6 +304,31 @@ void clAllometry::GetData(DOMDocument * p_oDoc, clTreePopulation * p_oPop) {
     if (m_fMaxCrownRad < fTempRad)
       m_fMaxCrownRad = fTempRad;
   }
+
+  //The non-spatial density dependent functions keep plot-wide totals and
+  //search with the population's own searches, so they can't be run for
+  //several trees at once
+  m_bCrownsThreadSafe = true;
+  for (i = 0; i < m_iNumSpecies; i++) {
+    if (&clAllometry::CalcNonSpatDensDepExpAdultCrownRad == mp_AdultCrownRad[i]
+        || &clAllometry::CalcNonSpatDensDepExpAdultCrownRad == mp_SaplingCrownRad[i]
+        || &clAllometry::CalcNonSpatDensDepLogAdultCrownDepth == mp_AdultCrownDepth[i]
+        || &clAllometry::CalcNonSpatDensDepLogAdultCrownDepth == mp_SaplingCrownDepth[i])
+      m_bCrownsThreadSafe = false;
+  }
+
+  //How far away a DBH change can reach into NCI crowns
+  m_fNCICrownReach = 0;
+  for (i = 0; i < m_iNumSpecies; i++) {
+    if ((&clAllometry::CalcNCICrownRad == mp_AdultCrownRad[i]
+        || &clAllometry::CalcNCICrownRad == mp_SaplingCrownRad[i])
+        && m_fNCICrownReach < mp_fNCICRMaxCrowdingRadius[i])
+      m_fNCICrownReach = mp_fNCICRMaxCrowdingRadius[i];
+    if ((&clAllometry::CalcNCICrownDepth == mp_AdultCrownDepth[i]
+        || &clAllometry::CalcNCICrownDepth == mp_SaplingCrownDepth[i])
+        && m_fNCICrownReach < mp_fNCICDMaxCrowdingRadius[i])
+      m_fNCICrownReach = mp_fNCICDMaxCrowdingRadius[i];
+  }
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -413,14 +442,17 @@ float clAllometry::CalcSaplingDbh(float fHeight, const int & iSpecies) {
 float clAllometry::CalcAdultCrownRadius(clTree *p_oTree) {
   float fCR;
   int iSp = p_oTree->GetSpecies(), iTp = p_oTree->GetType();
-  p_oTree->GetValue(m_oPop->GetCrownRadiusCode(iSp, iTp), &fCR);
-  if (fCR > 0)
-    return fCR;
+  bool bMemo = CrownMemoUsable();
+  if (bMemo) {
+    p_oTree->GetValue(m_oPop->GetCrownRadiusCode(iSp, iTp), &fCR);
+    if (fCR > 0)
+      return fCR;
+  }
   fCR = (*this.*mp_AdultCrownRad[iSp])(p_oTree);
 
   //Make sure it's not negative
   if (fCR < MINCROWN) fCR = MINCROWN;
-  p_oTree->SetValue(m_oPop->GetCrownRadiusCode(iSp, iTp), fCR);
+  if (bMemo) p_oTree->SetValue(m_oPop->GetCrownRadiusCode(iSp, iTp), fCR);
   return fCR;
 
 }
@@ -431,16 +463,19 @@ float clAllometry::CalcAdultCrownRadius(clTree *p_oTree) {
 float clAllometry::CalcAdultCrownDepth(clTree *p_oTree) {
   float fCD, fHeight;
   int iSp = p_oTree->GetSpecies(), iTp = p_oTree->GetType();
-  p_oTree->GetValue(m_oPop->GetCrownDepthCode(iSp, iTp), &fCD);
-  if (fCD > 0)
-    return fCD;
+  bool bMemo = CrownMemoUsable();
+  if (bMemo) {
+    p_oTree->GetValue(m_oPop->GetCrownDepthCode(iSp, iTp), &fCD);
+    if (fCD > 0)
+      return fCD;
+  }
   fCD = (*this.*mp_AdultCrownDepth[iSp])(p_oTree);
 
   p_oTree->GetValue(m_oPop->GetHeightCode(iSp, p_oTree->GetType()), &fHeight);
 
   fCD = fCD > fHeight ? fHeight : fCD;
   if (fCD < MINCROWN) fCD = MINCROWN;
-  p_oTree->SetValue(m_oPop->GetCrownDepthCode(iSp, iTp), fCD);
+  if (bMemo) p_oTree->SetValue(m_oPop->GetCrownDepthCode(iSp, iTp), fCD);
   return fCD;
 }
 
@@ -450,12 +485,15 @@ float clAllometry::CalcAdultCrownDepth(clTree *p_oTree) {
 float clAllometry::CalcSaplingCrownRadius(clTree *p_oTree) {
   float fCR;
   int iSp = p_oTree->GetSpecies(), iTp = p_oTree->GetType();
-  p_oTree->GetValue(m_oPop->GetCrownRadiusCode(iSp, iTp), &fCR);
-  if (fCR > 0)
-    return fCR;
+  bool bMemo = CrownMemoUsable();
+  if (bMemo) {
+    p_oTree->GetValue(m_oPop->GetCrownRadiusCode(iSp, iTp), &fCR);
+    if (fCR > 0)
+      return fCR;
+  }
   fCR = (*this.*mp_SaplingCrownRad[iSp])(p_oTree);
   if (fCR < MINCROWN) fCR = MINCROWN;
-  p_oTree->SetValue(m_oPop->GetCrownRadiusCode(iSp, iTp), fCR);
+  if (bMemo) p_oTree->SetValue(m_oPop->GetCrownRadiusCode(iSp, iTp), fCR);
   return fCR;
 }
 
@@ -465,12 +503,15 @@ float clAllometry::CalcSaplingCrownRadius(clTree *p_oTree) {
 float clAllometry::CalcSaplingCrownDepth(clTree *p_oTree) {
   float fCD;
   int iSp = p_oTree->GetSpecies(), iTp = p_oTree->GetType();
-  p_oTree->GetValue(m_oPop->GetCrownDepthCode(iSp, iTp), &fCD);
-  if (fCD > 0)
-    return fCD;
+  bool bMemo = CrownMemoUsable();
+  if (bMemo) {
+    p_oTree->GetValue(m_oPop->GetCrownDepthCode(iSp, iTp), &fCD);
+    if (fCD > 0)
+      return fCD;
+  }
   fCD = (*this.*mp_SaplingCrownDepth[iSp])(p_oTree);
   if (fCD < MINCROWN) fCD = MINCROWN;
-  p_oTree->SetValue(m_oPop->GetCrownDepthCode(iSp, iTp), fCD);
+  if (bMemo) p_oTree->SetValue(m_oPop->GetCrownDepthCode(iSp, iTp), fCD);
   return fCD;
 }
 
@@ -973,6 +1014,83 @@ void clAllometry::DoDataUpdates() {
   m_fPlotBasalArea = -1;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// CalcAllCrownDimensions()
+//////////////////////////////////////////////////////////////////////////////
+void clAllometry::CalcAllCrownDimensions() {
+  clTreeSnapshot *p_oSnapshot = m_oPop->GetSnapshot();
+  stcCrownPass stcPass;
+  int i;
+
+  m_oPop->ClearDirtyCrowns();
+  stcPass.p_oAllom = this;
+  stcPass.p_oTrees = p_oSnapshot->GetTrees();
+  stcPass.p_iType = p_oSnapshot->GetType();
+  stcPass.p_iDead = p_oSnapshot->GetDead();
+
+  if (m_bCrownsThreadSafe)
+    m_oPop->mp_oSimManager->GetTaskPool()->ParallelFor(0,
+        p_oSnapshot->GetNumTrees(), stcPass, 64);
+  else
+    for (i = 0; i < p_oSnapshot->GetNumTrees(); i++) stcPass(i);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// CrownMemoUsable()
+//////////////////////////////////////////////////////////////////////////////
+bool clAllometry::CrownMemoUsable() {
+  if (!m_oPop->CrownsDirty()) return true;
+  if (clTaskPool::InParallel()) return false;
+  m_oPop->ClearDirtyCrowns();
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// stcCrownPass::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clAllometry::stcCrownPass::operator()(int i) {
+  if (notdead != p_iDead[i]) return;
+  if (clTreePopulation::sapling == p_iType[i]) {
+    p_oAllom->CalcSaplingCrownRadius(p_oTrees[i]);
+    p_oAllom->CalcSaplingCrownDepth(p_oTrees[i]);
+  } else if (clTreePopulation::adult == p_iType[i] ||
+      clTreePopulation::snag == p_iType[i]) {
+    p_oAllom->CalcAdultCrownRadius(p_oTrees[i]);
+    p_oAllom->CalcAdultCrownDepth(p_oTrees[i]);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// stcCrownNCI::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clAllometry::stcCrownNCI::operator()(clTree *p_oNeighbor,
+    float fDistanceSq) {
+  float fNDbh; //neighbor's dbh
+  int iIsDead = notdead;
+  short int iNeighSpecies = p_oNeighbor->GetSpecies(),
+      iNeighType = p_oNeighbor->GetType(),
+      iDeadCode = p_oPop->GetDeadCodes()[iNeighSpecies][iNeighType];
+
+  if (p_oNeighbor == p_oTarget) return;
+
+  //Get the neighbor's dbh
+  p_oNeighbor->GetValue(p_oPop->GetDbhCode(iNeighSpecies, iNeighType), &fNDbh);
+  if (fNDbh < p_fMinNeighborDBH[iNeighSpecies]) return;
+
+  //Make sure the neighbor's not dead
+  if (-1 != iDeadCode) p_oNeighbor->GetValue(iDeadCode, &iIsDead);
+  if (notdead != iIsDead) return;
+
+  //Only continue if distance is not 0 - it will be a fluke condition to
+  //allow a tree that is literally standing on top of another one not to
+  //affect it competitively, but there it is
+  if (0 == fDistanceSq) return;
+
+  //Add competitive effect to NCI
+  fNCI += p_fLambda[iNeighSpecies] * (pow(fNDbh, fAlpha) /
+      pow(sqrt(fDistanceSq), fBeta));
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // SetupAdultHeightDiam()
 //////////////////////////////////////////////////////////////////////////////
@@ -2827,89 +2945,35 @@ void clAllometry::SetupSeedlingHeightDiam(xercesc::DOMElement * p_oElement) {
 // CalcNCICrownRad()
 //////////////////////////////////////////////////////////////////////////////
 float clAllometry::CalcNCICrownRad(clTree *p_oTree) {
-  clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
-  clTree * p_oNeighbor; //competing neighbor
-  clPlot * p_oPlot = m_oPop->mp_oSimManager->GetPlotObject();
-  char cQuery[75];
+  stcCrownNCI stcCrowding; //adds up NCI from each neighbor
   float fCrowdingEffect, //tree's crowding effect
   fNCI = 0, //the NCI
   fSizeEffect, //tree's size effect
   fTDbh, //tree's dbh
-  fDistance, //distance between target and neighbor
-  fNDbh, //neighbor's dbh
   fCrownRadius,
-  fNeighX, fNeighY, //holders for the neighbor tree's X and Y
   fTargetX, fTargetY; //holders for the target tree's X and Y location
-  int iIsDead;
-  short int iNeighSpecies, iNeighType, //species and type for neighbor
-  iTargetSpecies = p_oTree->GetSpecies(), //target tree's species
-  iTargetType = p_oTree->GetType(),
-  iDeadCode; //neighbor's dead code
+  short int iTargetSpecies = p_oTree->GetSpecies(), //target tree's species
+  iTargetType = p_oTree->GetType();
 
   p_oTree->GetValue(m_oPop->GetDbhCode(iTargetSpecies, iTargetType), &fTDbh);
 
   //Get NCI
-  //Format the query to get all competing neighbors
   p_oTree->GetValue(m_oPop->GetXCode(iTargetSpecies, iTargetType), &fTargetX);
   p_oTree->GetValue(m_oPop->GetYCode(iTargetSpecies, iTargetType), &fTargetY);
 
-  //Get all trees taller than seedlings within the max crowding radius -
-  //seedlings don't compete
-  sprintf(cQuery, "%s%f%s%f%s%f%s%f", "distance=",
-      mp_fNCICRMaxCrowdingRadius[iTargetSpecies], "FROM x=", fTargetX, "y=",
-      fTargetY, "::height=", m_fMinSaplingHeight);
-  p_oAllNeighbors = m_oPop->Find(cQuery);
-
-  //Loop through and assess the competitive effects of each
-  p_oNeighbor = p_oAllNeighbors->NextTree();
-
-  while (p_oNeighbor) {
-    if (p_oNeighbor != p_oTree) {
-      iNeighSpecies = p_oNeighbor->GetSpecies();
-      iNeighType = p_oNeighbor->GetType();
-      if (clTreePopulation::seedling != iNeighType && (clTreePopulation::snag
-          != iNeighType)) {
-        //Get the neighbor's dbh
-        p_oNeighbor->GetValue(m_oPop->GetDbhCode(iNeighSpecies, iNeighType),
-            &fNDbh);
-        if (fNDbh >= mp_fNCICRMinNeighborDBH[iNeighSpecies]) {
-
-          //Make sure the neighbor's not dead
-          iDeadCode = m_oPop->GetIntDataCode("dead", p_oNeighbor->GetSpecies(),
-              p_oNeighbor->GetType());
-          if (-1 != iDeadCode)
-            p_oNeighbor->GetValue(iDeadCode, &iIsDead);
-          else
-            iIsDead = notdead;
-
-          if (notdead == iIsDead) {
-
-            //Get the neighbor's X and Y values
-            p_oNeighbor->GetValue(m_oPop->GetXCode(iNeighSpecies, iNeighType),
-                &fNeighX);
-            p_oNeighbor->GetValue(m_oPop->GetYCode(iNeighSpecies, iNeighType),
-                &fNeighY);
-
-            //Get the distance between the two trees
-            fDistance = p_oPlot->GetDistance(fTargetX, fTargetY, fNeighX,
-                fNeighY);
-
-            //Only continue if distance is not 0 - it will be a fluke condition to
-            //allow a tree that is literally standing on top of another one not to
-            //affect it competitively, but there it is
-            if (0 != fDistance)
-
-              //Add competitive effect to NCI
-              fNCI += mp_fNCICRLambda[iTargetSpecies][iNeighSpecies] * (pow(
-                  fNDbh, mp_fNCICRAlpha[iTargetSpecies]) / pow(fDistance,
-                      mp_fNCICRBeta[iTargetSpecies]));
-
-          }
-        }
-      }
-    }
-    p_oNeighbor = p_oAllNeighbors->NextTree();
-  }
+  //Add up the crowding from all saplings and adults taller than seedlings
+  //within the max crowding radius - seedlings and snags don't compete
+  stcCrowding.p_oTarget = p_oTree;
+  stcCrowding.p_oPop = m_oPop;
+  stcCrowding.p_fLambda = mp_fNCICRLambda[iTargetSpecies];
+  stcCrowding.p_fMinNeighborDBH = mp_fNCICRMinNeighborDBH;
+  stcCrowding.fAlpha = mp_fNCICRAlpha[iTargetSpecies];
+  stcCrowding.fBeta = mp_fNCICRBeta[iTargetSpecies];
+  stcCrowding.fNCI = 0;
+  m_oPop->ForEachNeighbor(fTargetX, fTargetY,
+      mp_fNCICRMaxCrowdingRadius[iTargetSpecies], m_fMinSaplingHeight, (1 << clTreePopulation::sapling) |
+      (1 << clTreePopulation::adult), stcCrowding);
+  fNCI = stcCrowding.fNCI;
 
   //Calculate the crowding effect
   fNCI *= exp(mp_fNCICRGamma[iTargetSpecies] * fTDbh);
@@ -2939,90 +3003,36 @@ float clAllometry::CalcNCICrownRad(clTree *p_oTree) {
 // CalcNCICrownDepth()
 //////////////////////////////////////////////////////////////////////////////
 float clAllometry::CalcNCICrownDepth(clTree *p_oTree) {
-  clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
-  clTree * p_oNeighbor; //competing neighbor
-  clPlot * p_oPlot = m_oPop->mp_oSimManager->GetPlotObject();
-  char cQuery[75];
+  stcCrownNCI stcCrowding; //adds up NCI from each neighbor
   float fCrowdingEffect, //tree's crowding effect
   fNCI = 0, //the NCI
   fSizeEffect, //tree's size effect
   fTDbh, //tree's dbh
-  fDistance, //distance between target and neighbor
-  fNDbh, //neighbor's dbh
   fCrownDepth,
   fHeight,
-  fNeighX, fNeighY, //holders for the neighbor tree's X and Y
   fTargetX, fTargetY; //holders for the target tree's X and Y location
-  int iIsDead;
-  short int iNeighSpecies, iNeighType, //species and type for neighbor
-  iTargetSpecies = p_oTree->GetSpecies(), //target tree's species
-  iTargetType = p_oTree->GetType(),
-  iDeadCode; //neighbor's dead code
+  short int iTargetSpecies = p_oTree->GetSpecies(), //target tree's species
+  iTargetType = p_oTree->GetType();
 
   p_oTree->GetValue(m_oPop->GetDbhCode(iTargetSpecies, iTargetType), &fTDbh);
 
   //Get NCI
-  //Format the query to get all competing neighbors
   p_oTree->GetValue(m_oPop->GetXCode(iTargetSpecies, iTargetType), &fTargetX);
   p_oTree->GetValue(m_oPop->GetYCode(iTargetSpecies, iTargetType), &fTargetY);
 
-  //Get all trees taller than seedlings within the max crowding radius -
-  //seedlings don't compete
-  sprintf(cQuery, "%s%f%s%f%s%f%s%f", "distance=",
-      mp_fNCICDMaxCrowdingRadius[iTargetSpecies], "FROM x=", fTargetX, "y=",
-      fTargetY, "::height=", m_fMinSaplingHeight);
-  p_oAllNeighbors = m_oPop->Find(cQuery);
-
-  //Loop through and assess the competitive effects of each
-  p_oNeighbor = p_oAllNeighbors->NextTree();
-
-  while (p_oNeighbor) {
-    if (p_oNeighbor != p_oTree) {
-      iNeighSpecies = p_oNeighbor->GetSpecies();
-      iNeighType = p_oNeighbor->GetType();
-      if (clTreePopulation::seedling != iNeighType && (clTreePopulation::snag
-          != iNeighType)) {
-        //Get the neighbor's dbh
-        p_oNeighbor->GetValue(m_oPop->GetDbhCode(iNeighSpecies, iNeighType),
-            &fNDbh);
-        if (fNDbh >= mp_fNCICDMinNeighborDBH[iNeighSpecies]) {
-
-          //Make sure the neighbor's not dead
-          iDeadCode = m_oPop->GetIntDataCode("dead", p_oNeighbor->GetSpecies(),
-              p_oNeighbor->GetType());
-          if (-1 != iDeadCode)
-            p_oNeighbor->GetValue(iDeadCode, &iIsDead);
-          else
-            iIsDead = notdead;
-
-          if (notdead == iIsDead) {
-
-            //Get the neighbor's X and Y values
-            p_oNeighbor->GetValue(m_oPop->GetXCode(iNeighSpecies, iNeighType),
-                &fNeighX);
-            p_oNeighbor->GetValue(m_oPop->GetYCode(iNeighSpecies, iNeighType),
-                &fNeighY);
-
-            //Get the distance between the two trees
-            fDistance = p_oPlot->GetDistance(fTargetX, fTargetY, fNeighX,
-                fNeighY);
-
-            //Only continue if distance is not 0 - it will be a fluke condition to
-            //allow a tree that is literally standing on top of another one not to
-            //affect it competitively, but there it is
-            if (0 != fDistance)
-
-              //Add competitive effect to NCI
-              fNCI += mp_fNCICDLambda[iTargetSpecies][iNeighSpecies] * (pow(
-                  fNDbh, mp_fNCICDAlpha[iTargetSpecies]) / pow(fDistance,
-                      mp_fNCICDBeta[iTargetSpecies]));
-
-          }
-        }
-      }
-    }
-    p_oNeighbor = p_oAllNeighbors->NextTree();
-  }
+  //Add up the crowding from all saplings and adults taller than seedlings
+  //within the max crowding radius - seedlings and snags don't compete
+  stcCrowding.p_oTarget = p_oTree;
+  stcCrowding.p_oPop = m_oPop;
+  stcCrowding.p_fLambda = mp_fNCICDLambda[iTargetSpecies];
+  stcCrowding.p_fMinNeighborDBH = mp_fNCICDMinNeighborDBH;
+  stcCrowding.fAlpha = mp_fNCICDAlpha[iTargetSpecies];
+  stcCrowding.fBeta = mp_fNCICDBeta[iTargetSpecies];
+  stcCrowding.fNCI = 0;
+  m_oPop->ForEachNeighbor(fTargetX, fTargetY,
+      mp_fNCICDMaxCrowdingRadius[iTargetSpecies], m_fMinSaplingHeight, (1 << clTreePopulation::sapling) |
+      (1 << clTreePopulation::adult), stcCrowding);
+  fNCI = stcCrowding.fNCI;
 
   //Calculate the crowding effect
   fNCI *= exp(mp_fNCICDGamma[iTargetSpecies] * fTDbh);
@@ -29,6 +29,10 @@
  * <br>April 9, 2009 - Added NCI  crown width and crown depth relationships;
  * caused the crown shape functions to take a tree as an argument; and upgraded
  * version to 2.4 (LEM)
+ * <br>October 17, 2026 - NCI crown functions walk neighbors with
+ * clTreePopulation::ForEachNeighbor(); added CalcAllCrownDimensions() (agent)
+ * <br>October 17, 2026 - Added GetNCICrownReach(); the crown functions clear
+ * crowns made stale by neighbors' size changes before reading them (agent)
  */
 class clAllometry {
 
@@ -209,11 +213,34 @@ public:
    */
   double GetMaxCrownRadius() {return m_fMaxCrownRad;};
 
+  /**
+   * Gets how far away a neighbor's DBH can change an NCI crown.
+   * @return Largest NCI crown radius or depth maximum crowding radius of any
+   * species using an NCI crown function, in m, or 0 if none do.
+   */
+  double GetNCICrownReach() {return m_fNCICrownReach;};
+
   /**
    * Cleanup function that resets the plot density and basal area information.
    */
   void DoDataUpdates();
 
+  /**
+   * Calculates crown radius and crown depth for every living sapling, adult
+   * and snag in one pass, so that later calls for them only read the "Crown
+   * Radius" and "Crown Depth" tree data members. Those values last until the
+   * tree population clears them at the end of the timestep, or until the
+   * tree's height or diameter is set. After this, the crown functions can be
+   * called for these trees from several threads at once.
+   *
+   * Crowns left stale by neighbors' size changes are cleared first (see
+   * clTreePopulation::ClearDirtyCrowns()). The trees are split up through
+   * the sim manager's task pool, unless a
+   * species uses a non-spatial density dependent crown function; those
+   * search the whole plot and are done one tree at a time.
+   */
+  void CalcAllCrownDimensions();
+
 protected:
 
   clTreePopulation *m_oPop; /**<Tree population object*/
@@ -635,6 +662,10 @@ protected:
   /**Maximum possible crown radius*/
   double m_fMaxCrownRad;
 
+  /**Largest NCI crowding radius of any crown function, or 0 if no species
+   * uses an NCI crown function*/
+  double m_fNCICrownReach;
+
   /**The plot's density, in stems/ha; for non-spatial density dependent crown
    * functions*/
   double m_fPlotDensity;
@@ -646,6 +677,58 @@ protected:
   /**Minimum sapling height.  For doing NCI neighbor searches.*/
   double m_fMinSaplingHeight;
 
+  /**Whether every crown function can be run for several trees at once. False
+   * if any species uses a non-spatial density dependent crown function.*/
+  bool m_bCrownsThreadSafe;
+
+  /**
+   * Gets whether the remembered crown radius and depth can be read and
+   * written. If neighbors have changed size since the crowns around them
+   * were cleared, this clears them first. Inside a parallel loop it can't do
+   * that, so the crowns are calculated without being remembered.
+   * @return Whether to use the "Crown Radius" and "Crown Depth" members.
+   */
+  bool CrownMemoUsable();
+
+  /**
+   * Adds up NCI for a crown function's target tree, one neighbor at a time.
+   * This is handed to clTreePopulation::ForEachNeighbor(), with only saplings
+   * and adults let through.
+   */
+  struct stcCrownNCI {
+    clTree *p_oTarget; /**<Target tree, which doesn't crowd itself*/
+    clTreePopulation *p_oPop; /**<Tree population*/
+    double *p_fLambda; /**<Lambda for each neighbor species*/
+    double *p_fMinNeighborDBH; /**<Minimum neighbor DBH for each species*/
+    double fAlpha; /**<Neighbor DBH effect*/
+    double fBeta; /**<Neighbor distance effect*/
+    float fNCI; /**<NCI so far*/
+
+    /**
+     * Adds one neighbor's crowding to the NCI.
+     * @param p_oNeighbor Neighbor.
+     * @param fDistanceSq Squared distance to the neighbor.
+     */
+    void operator()(clTree *p_oNeighbor, float fDistanceSq);
+  };
+
+  /**
+   * Calculates crown dimensions for one tree of a clTreeSnapshot. This is
+   * handed to clTaskPool::ParallelFor() by CalcAllCrownDimensions().
+   */
+  struct stcCrownPass {
+    clAllometry *p_oAllom; /**<Allometry object*/
+    clTree * const *p_oTrees; /**<Snapshot trees*/
+    const short int *p_iType; /**<Snapshot types*/
+    const int *p_iDead; /**<Snapshot dead codes*/
+
+    /**
+     * Calculates crown radius and depth for one tree.
+     * @param i Tree's index in the snapshot.
+     */
+    void operator()(int i);
+  };
+
   /**Total number of species*/
   int m_iNumSpecies;
 
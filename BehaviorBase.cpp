@@ -23,6 +23,8 @@ clBehaviorBase::clBehaviorBase(clSimManager *p_oSimManager)
     m_iNewTreeBools = 0;
     m_iBehaviorListNumber = 0;
     m_sXMLRoot = "";
+    m_iResourcesRead = all_resources;
+    m_iResourcesWritten = all_resources;
   }
   catch(modelErr &err) {throw(err);}
   catch (modelMsg &msg) {throw(msg);} //non-fatal error
@@ -31,11 +31,54 @@ class clTreePopulation;
 * version 2.0 (LEM)
 * <br>May 18, 2015 - Changed GetParentParametersElement so it wasn't an
 * error if element was not found (LEM)
+* <br>October 17, 2026 - Added GetNeighborSearchRadius() (agent)
+* <br>October 17, 2026 - Added resource declarations so the Simulation
+* Manager can schedule behaviors that don't touch the same data to run at the
+* same time (agent)
 */
 class clBehaviorBase : virtual public clWorkerBase{
 
 public:
 
+  /**
+  * Kinds of model data a behavior can read or write. These are bits, so a
+  * behavior's declarations are made by OR-ing them together. The Simulation
+  * Manager uses them to decide which behaviors can run at the same time and
+  * whether the populations need their data updates after a behavior runs.
+  */
+  enum resource {tree_structure = 1, /**<Tree numbers, types, positions,
+     heights, diameters, and dead flags - anything that changes where a tree
+     sorts or whether it exists*/
+     tree_data = 2, /**<Any other tree data member*/
+     own_tree_data = 4, /**<Tree data members this behavior registered
+     itself*/
+     grids = 8, /**<Any grid*/
+     own_grid = 16, /**<Grids this behavior created itself*/
+     plot_climate = 32, /**<The plot's climate values*/
+     random_numbers = 64, /**<The shared random number generator. Drawing a
+     number changes it, so declare this as a write.*/
+     all_resources = 127 /**<Everything*/
+  };
+
+  /**
+  * Gets the model data this behavior reads in Action(), as resource bits.
+  * Behaviors which make no declaration are assumed to read everything.
+  * @return Resources read.
+  */
+  virtual int GetResourcesRead() {return m_iResourcesRead;};
+
+  /**
+  * Gets the model data this behavior changes in Action(), as resource bits.
+  * Behaviors which make no declaration are assumed to write everything, which
+  * keeps them running alone and in list order. A behavior that declares less
+  * than this is promising that its Action() is safe to run at the same time as
+  * other behaviors that don't conflict with it: it must not use the
+  * population's pooled searches (the string form of clTreePopulation::Find()),
+  * send messages, or touch any data it hasn't declared.
+  * @return Resources written.
+  */
+  virtual int GetResourcesWritten() {return m_iResourcesWritten;};
+
   /**
   * Gets the behavior version number.
   * @return Behavior version number.
@@ -84,6 +127,21 @@ public:
    */
   virtual void RegisterTreeDataMembers();
 
+  /**
+   * Gets the largest radius, in meters, that this behavior will use for
+   * neighborhood tree searches. The tree population uses this to choose the
+   * size of its hash table cells if the user has asked it to. This is called
+   * before GetData(), so a behavior that overrides this must read what it
+   * needs from the parameter file itself; it can be assumed that the tree
+   * population has read its data. The default returns 0, meaning the behavior
+   * does no neighborhood searches. Only report radii of the crowding-sized
+   * searches that run for every tree; a light shell's shading reach spans
+   * much of the plot and would make cells far too large.
+   * @param p_oDoc Parsed parameter file.
+   * @return Largest neighborhood search radius, or 0.
+   */
+  virtual float GetNeighborSearchRadius(xercesc::DOMDocument *p_oDoc) {return 0;};
+
   /**
    * Sets the species/type combos for a behavior.  This function is only allowed
    * to be called once, because messing with it would be very awful.  These
@@ -245,6 +303,14 @@ protected:
    * marked between this number and the current version number, inclusive.*/
   float m_fMinimumVersionNumber;
 
+  /**Model data read in Action(), as resource bits. Defaults to
+   * all_resources.*/
+  int m_iResourcesRead;
+
+  /**Model data changed in Action(), as resource bits. Defaults to
+   * all_resources.*/
+  int m_iResourcesWritten;
+
 }; //end of class clBehaviorBase
 
 #endif
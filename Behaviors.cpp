@@ -45,6 +45,7 @@
 #include "Storm.h"
 #include "VolumeCalculator.h"
 #include "GLIMap.h"
+#include "VoxelLight.h"
 #include "DimensionAnalysis.h"
 #include "GapLight.h"
 #include "DoubleMMRelGrowth.h"
@@ -520,6 +521,11 @@ void clBehaviorManager::CreateBehavior(behaviorData * p_data)
       clGLIMap * p_oLight = new clGLIMap(mp_oSimManager);
       mp_oObjectArray[iIndex] = p_oLight;
     }
+    else if (p_data->sNameString.compare("VoxelLight") == 0)
+    {
+      clVoxelLight * p_oLight = new clVoxelLight(mp_oSimManager);
+      mp_oObjectArray[iIndex] = p_oLight;
+    }
     else if (p_data->sNameString.compare("GLIPointCreator") == 0)
     {
       clGLIPoints * p_oLight = new clGLIPoints(mp_oSimManager);
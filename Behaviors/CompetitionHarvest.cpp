@@ -965,7 +965,7 @@ void clCompetitionHarvest::RecalculateCOESpeciesSpecific(clTreePopulation *p_oPo
   clTree *p_oTree;
   bool *p_bEligible = new bool[m_iNumSpecies];
   float fCOE, fHeight, fDbh,
-  fCellLength = p_oPop->GetGridCellSize();
+  fCellLength = p_oPop->GetHashCellLength();
   int iSp, iTp, iX, iY, iRealX, iRealY, iMinX, iMaxX, iMinY, iMaxY;
 
   //Find the grids we are going to change
@@ -1057,7 +1057,7 @@ void clCompetitionHarvest::RecalculateCOENotSpeciesSpecific(clTreePopulation *p_
   clPlot *p_oPlot = mp_oSimManager->GetPlotObject();
   clTree *p_oTree;
   float fCOE, fHeight, fDbh,
-  fCellLength = p_oPop->GetGridCellSize();
+  fCellLength = p_oPop->GetHashCellLength();
   int iSp, iTp, iRealX, iRealY, iX, iY, iMinX, iMaxX, iMinY, iMaxY;
 
   //Find the grids we are going to change
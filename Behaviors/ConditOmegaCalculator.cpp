@@ -511,7 +511,7 @@ void clConditOmegaCalculator::ProcessOwnCell(clTree *p_oFirstTree,
 ////////////////////////////////////////////////////////////////////////////
 void clConditOmegaCalculator::SetUpSearching(clTreePopulation *p_oPop)
 {
-  int iCellSize = p_oPop->GetGridCellSize(),
+  int iCellSize = p_oPop->GetHashCellLength(),
       iNumTotCells = m_iNumXCells * m_iNumYCells,
       i,
       iLimit,           //effective search limit
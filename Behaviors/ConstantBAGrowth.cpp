@@ -15,6 +15,7 @@ clWorkerBase(p_oSimManager), clBehaviorBase(p_oSimManager), clGrowthBase(p_oSimM
 clMichMenBase(p_oSimManager) {
   m_sNameString = "constbagrowthshell";
   m_sXMLRoot = "ConstBAGrowth";
+  m_bThreadSafe = true;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -16,6 +16,7 @@ clGrowthBase( p_oSimManager), clMichMenBase(p_oSimManager)
 {
   m_sNameString = "constradgrowthshell";
   m_sXMLRoot = "ConstRadialGrowth";
+  m_bThreadSafe = true;
 }
 
 //////////////////////////////////////////////////////////////////////////////
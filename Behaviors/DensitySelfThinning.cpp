@@ -19,6 +19,7 @@ clDensitySelfThinning::clDensitySelfThinning(clSimManager *p_oSimManager) :
 
    m_sNameString = "densityselfthinningmortshell";
    m_sXMLRoot = "DensitySelfThinning";
+   m_bThreadSafe = true;
 
    mp_fSelfThinRadius = NULL;
    mp_fMinDensityForMort = NULL;
@@ -222,50 +223,26 @@ void clDensitySelfThinning::CalculateNeighborhoodTreeCountAndMeanDiam10( clTree
   {
     clTreePopulation *p_oPop = (clTreePopulation*)mp_oSimManager->GetPopulationObject("treepopulation");
 
-    clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
-    clTree * p_oNeighbor; //competing neighbor
-    std::stringstream sQuery; //format search strings into this
-
-    float fSumNeighDiam10 = 0, //Sum of the neighbour's Diam10 - eventually to be divided by iNeighborCount
-         fDiam10, //neighbor's Diam10
-         fTargetX, fTargetY; //holders for the target tree's X and Y location
-    int iNeighborCount =0; //Number of neighboring trees
-
-    short int iNeighSpecies, iNeighType, //species and type for neighbor
-         iTargetSpecies = p_oTree->GetSpecies(); //target tree's species
+    stcNeighborCounter stcCounter;
+    float fTargetX, fTargetY; //holders for the target tree's X and Y location
+    short int iTargetSpecies = p_oTree->GetSpecies(); //target tree's species
 
     //Get target tree's coordinates
     p_oTree->GetValue( p_oPop->GetXCode( iTargetSpecies, p_oTree->GetType() ), & fTargetX );
     p_oTree->GetValue( p_oPop->GetYCode( iTargetSpecies, p_oTree->GetType() ), & fTargetY );
 
-    //Get all trees within the max crowding radius -
-    sQuery << "distance=" << mp_fSelfThinRadius[mp_iIndexes[iTargetSpecies]]
-           << "FROM x=" << fTargetX << "y=" << fTargetY << "::height=" << 0.0;
-    p_oAllNeighbors = p_oPop->Find(sQuery.str());
-
-    //Loop through and calculate neighborhood values
-    p_oNeighbor = p_oAllNeighbors->NextTree();
-    while ( p_oNeighbor )
-    {
-      if ( p_oNeighbor != p_oTree )
-      {
-        iNeighType = p_oNeighbor->GetType();
-        if ( iNeighType == clTreePopulation::seedling || iNeighType == clTreePopulation::sapling )
-        {
-          iNeighborCount++;
-          iNeighSpecies = p_oNeighbor->GetSpecies();
-
-           //Get the neighbor's Diam10
-           p_oNeighbor->GetValue( p_oPop->GetDiam10Code( iNeighSpecies, iNeighType ), & fDiam10 );
-           fSumNeighDiam10 += fDiam10;
-        }
-
-      }
-      p_oNeighbor = p_oAllNeighbors->NextTree();
-    }
-
-    *p_fTreeCount = static_cast<float>(iNeighborCount);
-    *p_fMeanDiam10 = fSumNeighDiam10/static_cast<float>(iNeighborCount);
+    //Count seedlings and saplings within the max crowding radius
+    stcCounter.p_oTarget = p_oTree;
+    stcCounter.p_oPop = p_oPop;
+    stcCounter.fSumDiam10 = 0;
+    stcCounter.iCount = 0;
+    p_oPop->ForEachNeighbor(fTargetX, fTargetY,
+        mp_fSelfThinRadius[mp_iIndexes[iTargetSpecies]], 0,
+        (1 << clTreePopulation::seedling) | (1 << clTreePopulation::sapling),
+        stcCounter);
+
+    *p_fTreeCount = static_cast<float>(stcCounter.iCount);
+    *p_fMeanDiam10 = stcCounter.fSumDiam10/static_cast<float>(stcCounter.iCount);
   }
   catch ( modelErr & err )
   {
@@ -284,12 +261,38 @@ void clDensitySelfThinning::CalculateNeighborhoodTreeCountAndMeanDiam10( clTree
   }
 }
 
+////////////////////////////////////////////////////////////////////////////
+// stcNeighborCounter::operator()
+////////////////////////////////////////////////////////////////////////////
+void clDensitySelfThinning::stcNeighborCounter::operator()(clTree *p_oNeighbor, float fDistanceSq)
+{
+  float fDiam10; //neighbor's Diam10
+  short int iNeighSpecies = p_oNeighbor->GetSpecies(),
+            iNeighType = p_oNeighbor->GetType();
+
+  if ( p_oNeighbor == p_oTarget ) return;
+
+  iCount++;
+
+  //Get the neighbor's Diam10
+  p_oNeighbor->GetValue( p_oPop->GetDiam10Code( iNeighSpecies, iNeighType ), & fDiam10 );
+  fSumDiam10 += fDiam10;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // DoMort()
 ////////////////////////////////////////////////////////////////////////////
 deadCode clDensitySelfThinning::DoMort(clTree *p_oTree, const float &fDbh, const short int &iSpecies) {
+  return DoThreadSafeMort(p_oTree, fDbh, iSpecies, clModelMath::randgen);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// DoThreadSafeMort()
+////////////////////////////////////////////////////////////////////////////
+deadCode clDensitySelfThinning::DoThreadSafeMort(clTree *p_oTree,
+    const float &fDbh, const short int &iSpecies, gsl_rng *p_oStream) {
   float fDeathProb, //Probability of mortality
-  fRandom = clModelMath::GetRand(); //random number
+  fRandom = clModelMath::GetRand(p_oStream); //random number
   float fDensity; //Tree density in neighborhood of target tree
   float fMeanDiam10; //Mean Diam10 of trees in target tree's neighborhood
   float fTreeCount; //Number of tree in target tree's neighborhood
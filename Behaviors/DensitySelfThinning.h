@@ -25,6 +25,9 @@
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Neighbors are counted with
+* clTreePopulation::ForEachNeighbor() (agent)
+* <br>October 17, 2026 - Thread-safe, drawing from random streams (agent)
 */
 class clDensitySelfThinning : virtual public clMortalityBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -76,7 +79,39 @@ class clDensitySelfThinning : virtual public clMortalityBase {
   */
   deadCode DoMort(clTree *p_oTree, const float &fDbh, const short int &iSpecies);
 
+  /**
+  * Calculates mortality according to the DensitySelfThinning equation,
+  * drawing from a random stream.  Neighbors are counted whether or not they
+  * are dead, so this only needs the pre-mortality state.
+  * @param p_oTree Tree being evaluated.
+  * @param fDbh DBH of tree being evaluated.
+  * @param iSpecies Species of the tree being evaluated.
+  * @param p_oStream Random stream to draw from.
+  * @return natural if the tree is to die, notdead if it lives.
+  */
+  deadCode DoThreadSafeMort(clTree *p_oTree, const float &fDbh,
+      const short int &iSpecies, gsl_rng *p_oStream);
+
   protected:
+
+  /**
+  * Counts seedling and sapling neighbors and adds up their diam10s. This is
+  * handed to clTreePopulation::ForEachNeighbor().
+  */
+  struct stcNeighborCounter {
+    clTree *p_oTarget; /**<Target tree*/
+    clTreePopulation *p_oPop; /**<Tree population*/
+    float fSumDiam10; /**<Sum of neighbor diam10s*/
+    int iCount; /**<Number of neighbors*/
+
+    /**
+    * Counts one neighbor.
+    * @param p_oNeighbor Neighbor.
+    * @param fDistanceSq Squared distance to neighbor. Not used.
+    */
+    void operator()(clTree *p_oNeighbor, float fDistanceSq);
+  };
+
    int m_iNumberYearsPerTimestep; /**<Number of years per timestep*/
    double *mp_fSelfThinRadius; /**<Radius that defines the neighborhood size (meters)*/
    double *mp_fMinDensityForMort; /**<Minimum neighborhood density subject to mortality (trees/ha)*/
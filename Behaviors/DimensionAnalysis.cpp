@@ -3,6 +3,8 @@
 //---------------------------------------------------------------------------
 #include "DimensionAnalysis.h"
 #include "TreePopulation.h"
+#include "TreeQuery.h"
+#include "TreeSearch.h"
 #include "SimManager.h"
 #include "ParsingFunctions.h"
 #include "Constants.h"
@@ -33,6 +35,10 @@ clDimensionAnalysis::clDimensionAnalysis( clSimManager * p_oSimManager ) : clWor
     //Indicate that this behavior intends to add one tree float data member
     m_iNewTreeFloats = 1;
 
+    //DBH goes in; only this behavior's own data member comes out
+    m_iResourcesRead = tree_structure;
+    m_iResourcesWritten = own_tree_data;
+
     mp_fA = NULL;
     mp_fB = NULL;
     mp_fC = NULL;
@@ -47,7 +53,8 @@ clDimensionAnalysis::clDimensionAnalysis( clSimManager * p_oSimManager ) : clWor
     mp_bUseCorrectionFactor = NULL;
     mp_bConvertDBH = NULL;
     mp_iWhatDia = NULL;
-    m_sQuery = "";
+    mp_oQuery = NULL;
+    mp_oSearch = NULL;
 
   }
   catch ( modelErr & err )
@@ -85,6 +92,8 @@ clDimensionAnalysis::~clDimensionAnalysis()
   delete[] mp_bConvertDBH;
   delete[] mp_iEquationID;
   delete[] mp_iWhatDia;
+  delete mp_oQuery;
+  delete mp_oSearch;
 
   if ( mp_iBiomassCodes )
   {
@@ -104,7 +113,6 @@ void clDimensionAnalysis::GetData( xercesc::DOMDocument * p_oDoc )
   doubleVal * p_fTempValues = NULL; //for getting species-specific values
   intVal * p_iTempValues = NULL; //for getting species-specific values
   boolVal * p_bTempValues = NULL; //for getting species-specific values
-  std::stringstream sQueryTemp;
   try
   {
     DOMElement * p_oElement = GetParentParametersElement(p_oDoc);
@@ -112,7 +120,6 @@ void clDimensionAnalysis::GetData( xercesc::DOMDocument * p_oDoc )
     float fConvertGramsToMg = CONVERT_G_TO_KG * CONVERT_KG_TO_MG,
           fConvertLbsToMg = CONVERT_LBS_TO_KG * CONVERT_KG_TO_MG;
     int i;
-    bool bSapling = false, bAdult = false, bSnag = false;
 
     //*************************
     // Read in parameters
@@ -276,36 +283,19 @@ void clDimensionAnalysis::GetData( xercesc::DOMDocument * p_oDoc )
 
 
     //*************************
-    // Format query string
+    // Build query
     //*************************
     //Do a type/species search on all the types and species
-    sQueryTemp << "species=";
-    for (i = 0; i < m_iNumBehaviorSpecies - 1; i++) {
-      sQueryTemp << mp_iWhatSpecies[i] << ",";
+    delete mp_oQuery;
+    delete mp_oSearch;
+    mp_oQuery = new clTreeQuery(p_oPop);
+    mp_oSearch = new clTreeSearch(p_oPop);
+    for (i = 0; i < m_iNumBehaviorSpecies; i++) {
+      mp_oQuery->AddSpecies(mp_iWhatSpecies[i]);
     }
-    sQueryTemp << mp_iWhatSpecies[m_iNumBehaviorSpecies - 1];
-
-    //Find all the types
     for (i = 0; i < m_iNumSpeciesTypeCombos; i++) {
-      if ( clTreePopulation::sapling == mp_whatSpeciesTypeCombos[i].iType ) {
-        bSapling = true;
-      } else if ( clTreePopulation::adult == mp_whatSpeciesTypeCombos[i].iType ) {
-        bAdult = true;
-      } else if ( clTreePopulation::snag == mp_whatSpeciesTypeCombos[i].iType ) {
-        bSnag = true;
-      }
+      mp_oQuery->AddType(mp_whatSpeciesTypeCombos[i].iType);
     }
-    sQueryTemp << "::type=";
-    if (bSapling) {
-      sQueryTemp << clTreePopulation::sapling << ",";
-    } if (bAdult) {
-      sQueryTemp << clTreePopulation::adult << ",";
-    } if (bSnag) {
-      sQueryTemp << clTreePopulation::snag << ",";
-    }
-
-    //Remove the last comma and put it in m_sQuery
-    m_sQuery = sQueryTemp.str().substr(0, sQueryTemp.str().length() - 1);
 
     delete[] p_fTempValues;
     delete[] p_iTempValues;
@@ -346,16 +336,15 @@ void clDimensionAnalysis::Action()
   try
   {
     clTreePopulation * p_oPop = ( clTreePopulation * ) mp_oSimManager->GetPopulationObject( "treepopulation" );
-    clTreeSearch * p_oBehaviorTrees;
     clTree * p_oTree;
     float fBiomass, //tree's biomass
          fDBH; //tree's dbh
     int iSp, iTp;
 
     //Get the trees that apply to this behavior
-    p_oBehaviorTrees = p_oPop->Find(m_sQuery);
+    p_oPop->Find(*mp_oQuery, mp_oSearch);
 
-    p_oTree = p_oBehaviorTrees->NextTree();
+    p_oTree = mp_oSearch->NextTree();
     while ( p_oTree )
     {
 
@@ -427,7 +416,7 @@ void clDimensionAnalysis::Action()
         p_oTree->SetValue( mp_iBiomassCodes[mp_iIndexes[iSp]] [iTp - clTreePopulation::sapling], fBiomass );
       }
 
-      p_oTree = p_oBehaviorTrees->NextTree();
+      p_oTree = mp_oSearch->NextTree();
     }
   }
   catch ( modelErr & err )
@@ -6,6 +6,9 @@
 
 #include "BehaviorBase.h"
 
+class clTreeQuery;
+class clTreeSearch;
+
 /**
 * Tree Dimension Analysis Version 2.0
 *
@@ -63,6 +66,8 @@
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Declared resources and switched to a search object of
+* its own so it can run alongside other behaviors (agent)
 */
 class clDimensionAnalysis : virtual public clBehaviorBase {
   public:
@@ -184,10 +189,14 @@ class clDimensionAnalysis : virtual public clBehaviorBase {
   * in cm).  Array size is # species to which this behavior applies.*/
   bool *mp_bConvertDBH;
 
-  /**String to pass to clTreePopulation::Find() in order to get the trees for
-  * which to calculate biomass.  This will instigate a species/type search for
-  * all the species and types to which this behavior applies.*/
-  std::string m_sQuery;
+  /**Query to pass to clTreePopulation::Find() in order to get the trees for
+  * which to calculate biomass.  This is a species/type search for all the
+  * species and types to which this behavior applies.*/
+  clTreeQuery *mp_oQuery;
+
+  /**Search object for the trees.  This behavior owns it rather than using the
+  * population's pooled searches, so it can run alongside other behaviors.*/
+  clTreeSearch *mp_oSearch;
 
   /**Holds data member codes for "Biomass" float data member.  First array
   * index is # species to which this behavior applies, second is number types
@@ -4,6 +4,9 @@
 #include "SimManager.h"
 #include "TreePopulation.h"
 #include "DisperseOrg.h"
+#include "ModelMath.h"
+#include "TaskPool.h"
+#include "ParsingFunctions.h"
 #include <stdio.h>
 #include <sstream>
 
@@ -13,7 +16,16 @@ short int clDisperseBase::m_iTotalSpecies = 0;
 short int clDisperseBase::m_iIsGapCode = -1;
 short int clDisperseBase::m_iGapCountCode = -1;
 bool clDisperseBase::m_bUpdatedGapStatus = false;
+bool clDisperseBase::m_bParallel = false;
 clDisperseOrg *clDisperseBase::mp_oDisperseOrg = NULL;
+float *clDisperseBase::mp_fSeedBuffers = NULL;
+gsl_rng **clDisperseBase::mp_oSeedStreams = NULL;
+int clDisperseBase::m_iNumSeedBuffers = 0;
+int clDisperseBase::m_iSeedBufferSize = 0;
+int clDisperseBase::m_iNumSeedXCells = 0;
+int clDisperseBase::m_iNumSeedYCells = 0;
+float clDisperseBase::m_fSeedCellLengthX = 0;
+float clDisperseBase::m_fSeedCellLengthY = 0;
 
 //////////////////////////////////////////////////////////////////////////////
 // Constructor
@@ -24,6 +36,11 @@ clDisperseBase::clDisperseBase(clSimManager *p_oSimManager) :
     //Set the hooked flag to false
     m_bHooked = false;
 
+    mp_oParents = NULL;
+    mp_fParentValues = NULL;
+    m_iNumParents = 0;
+    m_iParentCapacity = 0;
+
     //Now - see if the disperse org object is NULL.  If it is, create it and
     //pass a self pointer so this object will be hooked
     if (mp_oDisperseOrg == NULL)
@@ -55,6 +72,14 @@ clDisperseBase::~clDisperseBase()
   //De-ref for future setup
   mp_oSeedGrid = NULL;
 
+  delete[] mp_oParents;
+  delete[] mp_fParentValues;
+  delete[] mp_fSeedBuffers; mp_fSeedBuffers = NULL;
+  for (int i = 0; i < m_iNumSeedBuffers; i++) gsl_rng_free(mp_oSeedStreams[i]);
+  delete[] mp_oSeedStreams; mp_oSeedStreams = NULL;
+  m_iNumSeedBuffers = 0;
+  m_iSeedBufferSize = 0;
+
   if (m_bHooked) {
     delete mp_oDisperseOrg;
     mp_oDisperseOrg = NULL;
@@ -69,6 +94,10 @@ void clDisperseBase::GetData(xercesc::DOMDocument *p_oDoc) {
  try {
    //If this is hooked, call the growth org's DoSetup function
    if (m_bHooked) {
+     //Parallel dispersal - optional, and off unless asked for
+     m_bParallel = false;
+     FillSingleValue(p_oDoc->getDocumentElement(), "di_parallelDispersal",
+         &m_bParallel, false);
      SetUpBase();
      mp_oDisperseOrg->DoSetup(mp_oSimManager, p_oDoc);
    }
@@ -244,3 +273,226 @@ void clDisperseBase::Action() {
     throw(stcErr);
   }
 }
+
+
+//////////////////////////////////////////////////////////////////////////////
+// AddParent()
+//////////////////////////////////////////////////////////////////////////////
+void clDisperseBase::AddParent(clTree *p_oTree, float fValue,
+    clTreePopulation *p_oPop, clPlot *p_oPlot) {
+  clTree **p_oOldParents = mp_oParents;
+  float *p_fOldValues = mp_fParentValues;
+  int i;
+
+  if (!m_bParallel) {
+    //Disperse now, so the shared generator is drawn in the order the parents
+    //are found
+    if (0 == m_iNumParents) ReserveSeedBuffers();
+    DisperseOneParent(p_oTree, p_oPop, p_oPlot, fValue, mp_fSeedBuffers,
+        clModelMath::randgen);
+    m_iNumParents++;
+    return;
+  }
+
+  if (m_iNumParents == m_iParentCapacity) {
+    //Leave some room so a growing population doesn't reallocate every time
+    m_iParentCapacity = m_iNumParents + m_iNumParents / 4 + 16;
+    mp_oParents = new clTree*[m_iParentCapacity];
+    mp_fParentValues = new float[m_iParentCapacity];
+    for (i = 0; i < m_iNumParents; i++) {
+      mp_oParents[i] = p_oOldParents[i];
+      mp_fParentValues[i] = p_fOldValues[i];
+    }
+    delete[] p_oOldParents;
+    delete[] p_fOldValues;
+  }
+
+  mp_oParents[m_iNumParents] = p_oTree;
+  mp_fParentValues[m_iNumParents] = fValue;
+  m_iNumParents++;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// ReserveSeedBuffers()
+//////////////////////////////////////////////////////////////////////////////
+int clDisperseBase::ReserveSeedBuffers() {
+  int iNumThreads = mp_oSimManager->GetTaskPool()->GetNumThreads(), iSize, i;
+
+  m_iNumSeedXCells = mp_oSeedGrid->GetNumberXCells();
+  m_iNumSeedYCells = mp_oSeedGrid->GetNumberYCells();
+  m_fSeedCellLengthX = mp_oSeedGrid->GetLengthXCells();
+  m_fSeedCellLengthY = mp_oSeedGrid->GetLengthYCells();
+  iSize = m_iTotalSpecies * m_iNumSeedXCells * m_iNumSeedYCells;
+
+  if (iNumThreads > m_iNumSeedBuffers || iSize != m_iSeedBufferSize) {
+    delete[] mp_fSeedBuffers;
+    mp_fSeedBuffers = new float[iNumThreads * iSize];
+    m_iSeedBufferSize = iSize;
+  }
+  if (iNumThreads > m_iNumSeedBuffers) {
+    for (i = 0; i < m_iNumSeedBuffers; i++) gsl_rng_free(mp_oSeedStreams[i]);
+    delete[] mp_oSeedStreams;
+    mp_oSeedStreams = new gsl_rng*[iNumThreads];
+    for (i = 0; i < iNumThreads; i++)
+      mp_oSeedStreams[i] = clModelMath::NewRandomStream();
+    m_iNumSeedBuffers = iNumThreads;
+  }
+
+  for (i = 0; i < iNumThreads * iSize; i++) mp_fSeedBuffers[i] = 0;
+
+  return iNumThreads;
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// ReduceSeedBuffers()
+//////////////////////////////////////////////////////////////////////////////
+void clDisperseBase::ReduceSeedBuffers(int iNumBuffers) {
+  stcReduceSeeds stcReduce;
+  stcReduce.iNumBuffers = iNumBuffers;
+  mp_oSimManager->GetTaskPool()->ParallelFor(0,
+      m_iNumSeedXCells * m_iNumSeedYCells, stcReduce, 64);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// stcReduceSeeds::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clDisperseBase::stcReduceSeeds::operator()(int iCell) {
+  float fSeeds, fGridSeeds;
+  int iNumCells = m_iNumSeedXCells * m_iNumSeedYCells,
+      iX = iCell / m_iNumSeedYCells, iY = iCell % m_iNumSeedYCells, iSp, i;
+  for (iSp = 0; iSp < m_iTotalSpecies; iSp++) {
+    fSeeds = 0;
+    for (i = 0; i < iNumBuffers; i++)
+      fSeeds += mp_fSeedBuffers[i * m_iSeedBufferSize + iSp * iNumCells +
+          iCell];
+    if (fSeeds == 0) continue;
+    mp_oSeedGrid->GetValueOfCell(iX, iY, mp_iNumSeedsCode[iSp], &fGridSeeds);
+    fGridSeeds += fSeeds;
+    mp_oSeedGrid->SetValueOfCell(iX, iY, mp_iNumSeedsCode[iSp], fGridSeeds);
+  }
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// DisperseParents()
+//////////////////////////////////////////////////////////////////////////////
+void clDisperseBase::DisperseParents(clTreePopulation *p_oPop,
+    clPlot *p_oPlot) {
+  stcDisperseParent stcParent;
+  int iNumParents = m_iNumParents, iNumBuffers;
+
+  m_iNumParents = 0;
+  if (0 == iNumParents) return;
+  if (!m_bParallel) {
+    //AddParent() already did the work, into the first buffer
+    ReduceSeedBuffers(1);
+    return;
+  }
+  iNumBuffers = ReserveSeedBuffers();
+
+  stcParent.p_oDisperse = this;
+  stcParent.p_oPop = p_oPop;
+  stcParent.p_oPlot = p_oPlot;
+  stcParent.iTimestep = mp_oSimManager->GetCurrentTimestep();
+  stcParent.iBehavior = GetBehaviorListNumber();
+  mp_oSimManager->GetTaskPool()->ParallelFor(0, iNumParents, stcParent, 16);
+
+  ReduceSeedBuffers(iNumBuffers);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// stcDisperseParent::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clDisperseBase::stcDisperseParent::operator()(int i) {
+  int iBuffer = clTaskPool::GetThreadNumber();
+  clModelMath::SetRandomStream(mp_oSeedStreams[iBuffer], iTimestep, iBehavior,
+      p_oPop->GetStreamKey(p_oDisperse->mp_oParents[i]));
+  p_oDisperse->DisperseOneParent(p_oDisperse->mp_oParents[i], p_oPop, p_oPlot,
+      p_oDisperse->mp_fParentValues[i],
+      mp_fSeedBuffers + iBuffer * m_iSeedBufferSize, mp_oSeedStreams[iBuffer]);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// DisperseCells()
+//////////////////////////////////////////////////////////////////////////////
+void clDisperseBase::DisperseCells(clTreePopulation *p_oPop, clPlot *p_oPlot) {
+  stcDisperseCell stcCell;
+  int iNumBuffers = ReserveSeedBuffers(), i;
+
+  if (!m_bParallel) {
+    for (i = 0; i < m_iNumSeedXCells * m_iNumSeedYCells; i++)
+      DisperseOneCell(i / m_iNumSeedYCells, i % m_iNumSeedYCells, p_oPop,
+          p_oPlot, mp_fSeedBuffers, clModelMath::randgen);
+    ReduceSeedBuffers(1);
+    return;
+  }
+
+  stcCell.p_oDisperse = this;
+  stcCell.p_oPop = p_oPop;
+  stcCell.p_oPlot = p_oPlot;
+  stcCell.iTimestep = mp_oSimManager->GetCurrentTimestep();
+  stcCell.iBehavior = GetBehaviorListNumber();
+  mp_oSimManager->GetTaskPool()->ParallelFor(0,
+      m_iNumSeedXCells * m_iNumSeedYCells, stcCell, 8);
+
+  ReduceSeedBuffers(iNumBuffers);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// stcDisperseCell::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clDisperseBase::stcDisperseCell::operator()(int i) {
+  int iBuffer = clTaskPool::GetThreadNumber();
+  clModelMath::SetRandomStream(mp_oSeedStreams[iBuffer], iTimestep, iBehavior,
+      i);
+  p_oDisperse->DisperseOneCell(i / m_iNumSeedYCells, i % m_iNumSeedYCells,
+      p_oPop, p_oPlot, mp_fSeedBuffers + iBuffer * m_iSeedBufferSize,
+      mp_oSeedStreams[iBuffer]);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// DisperseOneParent()
+//////////////////////////////////////////////////////////////////////////////
+void clDisperseBase::DisperseOneParent(clTree *p_oTree,
+    clTreePopulation *p_oPop, clPlot *p_oPlot, float fValue, float *p_fSeeds,
+    gsl_rng *p_oStream) {
+  modelErr stcErr;
+  stcErr.iErrorCode = BAD_DATA;
+  stcErr.sFunction = "clDisperseBase::DisperseOneParent";
+  stcErr.sMoreInfo = "Behavior \"" + GetName() +
+      "\" does not disperse by parent.";
+  throw(stcErr);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// DisperseOneCell()
+//////////////////////////////////////////////////////////////////////////////
+void clDisperseBase::DisperseOneCell(int iX, int iY, clTreePopulation *p_oPop,
+    clPlot *p_oPlot, float *p_fSeeds, gsl_rng *p_oStream) {
+  modelErr stcErr;
+  stcErr.iErrorCode = BAD_DATA;
+  stcErr.sFunction = "clDisperseBase::DisperseOneCell";
+  stcErr.sMoreInfo = "Behavior \"" + GetName() +
+      "\" does not disperse by grid cell.";
+  throw(stcErr);
+}
+
+
+//////////////////////////////////////////////////////////////////////////////
+// stcAdultBasalArea::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clDisperseBase::stcAdultBasalArea::operator()(clTree *p_oNeighbor,
+    float fDistanceSq) {
+  float fDbh;
+  short int iSp = p_oNeighbor->GetSpecies(), iType = p_oNeighbor->GetType();
+  p_oNeighbor->GetValue(p_oPop->GetDbhCode(iSp, iType), &fDbh);
+  p_fBasalArea[iSp] += clModelMath::CalculateBasalArea(fDbh);
+}
@@ -3,8 +3,12 @@
 #define DisperseBaseH
 //---------------------------------------------------------------------------
 #include "BehaviorBase.h"
+#include <gsl/gsl_rng.h>
 
 class clGrid;
+class clTree;
+class clTreePopulation;
+class clPlot;
 
 class clDisperseOrg;
 
@@ -13,12 +17,27 @@ class clDisperseOrg;
 *
 * This is the base class for disperse behaviors.  This holds common data.
 *
+* Descendents can hand their seed placement to AddParent()/DisperseParents()
+* or DisperseCells().  Normally these work one parent or cell at a time,
+* drawing from the shared random number generator in the same order as
+* always.  If the optional di_parallelDispersal parameter is set to true,
+* they instead split the work among the task pool's threads (see clTaskPool),
+* and each parent or cell draws from its own keyed random stream.  Either
+* way, seeds go into a seed buffer, and the buffers are summed into the seed
+* grid when all the work is done.
+*
 * Copyright 2011 Charles D. Canham.
 * @author Lora E. Murphy
 *
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Added parallel dispersal into per-thread seed
+* buffers (agent)
+* <br>October 17, 2026 - Parallel dispersal runs on the task pool (agent)
+* <br>October 17, 2026 - Parallel dispersal is turned on by the optional
+* di_parallelDispersal parameter; parents' random streams are keyed by tree
+* location (agent)
 */
 class clDisperseBase : virtual public clBehaviorBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -90,6 +109,136 @@ class clDisperseBase : virtual public clBehaviorBase {
   */
   virtual void AddSeeds() = 0;
 
+  /**
+  * Adds a tree to the list of parents to be dispersed by DisperseParents().
+  * Unless dispersal is parallel, the parent is dispersed right away instead,
+  * so that draws from the shared random number generator keep their order.
+  * @param p_oTree Parent tree.
+  * @param fValue Value to pass to DisperseOneParent() for this parent, such as
+  * its DBH or its number of seeds.
+  * @param p_oPop Tree population.
+  * @param p_oPlot Plot object.
+  */
+  void AddParent(clTree *p_oTree, float fValue, clTreePopulation *p_oPop,
+      clPlot *p_oPlot);
+
+  /**
+  * Finishes dispersing the parents added with AddParent() since the last
+  * call, then empties the parent list.  If dispersal is parallel, the
+  * parents are split among the task pool's threads.  Each parent draws its
+  * random numbers from a stream keyed to this behavior, the timestep, and
+  * the parent's location (see clTreePopulation::GetStreamKey()), and the
+  * seed buffers are summed in a fixed order, so the seeds in the grid do not
+  * depend on the number of threads.  Otherwise the parents have already been
+  * dispersed, and this only adds their seeds to the grid.
+  * @param p_oPop Tree population.
+  * @param p_oPlot Plot object.
+  */
+  void DisperseParents(clTreePopulation *p_oPop, clPlot *p_oPlot);
+
+  /**
+  * Adds seeds to every cell of the seed grid through DisperseOneCell().  If
+  * dispersal is parallel, the cells are split among the task pool's threads,
+  * and each cell draws its random numbers from a stream keyed to this
+  * behavior, the timestep, and the cell.  Otherwise the cells are done in
+  * order from the shared random number generator.
+  * @param p_oPop Tree population.
+  * @param p_oPlot Plot object.
+  */
+  void DisperseCells(clTreePopulation *p_oPop, clPlot *p_oPlot);
+
+  /**
+  * Disperses one parent's seeds.  This is called by AddParent() or
+  * DisperseParents(), possibly from several threads at once, so it must not
+  * write to the seed
+  * grid, the trees, or this object.  Seeds go into p_fSeeds with
+  * AddSeedAtPoint(), and random numbers come from p_oStream.  Descendents that
+  * use DisperseParents() must override this.
+  * @param p_oTree Parent tree.
+  * @param p_oPop Tree population.
+  * @param p_oPlot Plot object.
+  * @param fValue Value passed to AddParent() for this parent.
+  * @param p_fSeeds Seed buffer for the calling thread.
+  * @param p_oStream Random stream for this parent: its keyed stream if
+  * dispersal is parallel, or else the shared generator.
+  * @throw modelErr if the descendent doesn't override.
+  */
+  virtual void DisperseOneParent(clTree *p_oTree, clTreePopulation *p_oPop,
+      clPlot *p_oPlot, float fValue, float *p_fSeeds, gsl_rng *p_oStream);
+
+  /**
+  * Adds the seeds for one cell of the seed grid.  This is called by
+  * DisperseCells(), with the same restrictions as DisperseOneParent().  Seeds
+  * go into p_fSeeds with AddSeedsToCell().  Descendents that use
+  * DisperseCells() must override this.
+  * @param iX X grid cell number.
+  * @param iY Y grid cell number.
+  * @param p_oPop Tree population.
+  * @param p_oPlot Plot object.
+  * @param p_fSeeds Seed buffer for the calling thread.
+  * @param p_oStream Random stream for this cell: its keyed stream if
+  * dispersal is parallel, or else the shared generator.
+  * @throw modelErr if the descendent doesn't override.
+  */
+  virtual void DisperseOneCell(int iX, int iY, clTreePopulation *p_oPop,
+      clPlot *p_oPlot, float *p_fSeeds, gsl_rng *p_oStream);
+
+  /**
+  * Adds a seed to a seed buffer.
+  * @param p_fSeeds Seed buffer.
+  * @param fX X coordinate of the seed.  Must be within the plot.
+  * @param fY Y coordinate of the seed.  Must be within the plot.
+  * @param iSp Species of the seed.
+  */
+  void AddSeedAtPoint(float *p_fSeeds, float fX, float fY, short int iSp) {
+    p_fSeeds[(iSp * m_iNumSeedXCells + (int)(fX / m_fSeedCellLengthX))
+        * m_iNumSeedYCells + (int)(fY / m_fSeedCellLengthY)] += 1;
+  };
+
+  /**
+  * Adds seeds to one cell of a seed buffer.
+  * @param p_fSeeds Seed buffer.
+  * @param iX X grid cell number.
+  * @param iY Y grid cell number.
+  * @param iSp Species of the seeds.
+  * @param fNumSeeds Number of seeds to add.
+  */
+  void AddSeedsToCell(float *p_fSeeds, int iX, int iY, short int iSp,
+      float fNumSeeds) {
+    p_fSeeds[(iSp * m_iNumSeedXCells + iX) * m_iNumSeedYCells + iY] +=
+        fNumSeeds;
+  };
+
+  /**
+  * Adds up the basal area of adult neighbors by species.  This is handed to
+  * clTreePopulation::ForEachNeighbor().
+  */
+  struct stcAdultBasalArea {
+    clTreePopulation *p_oPop; /**<Tree population*/
+    float *p_fBasalArea; /**<Basal area so far, by species*/
+
+    /**
+    * Adds one neighbor's basal area.
+    * @param p_oNeighbor Neighbor.
+    * @param fDistanceSq Squared distance to neighbor. Not used.
+    */
+    void operator()(clTree *p_oNeighbor, float fDistanceSq);
+  };
+
+  /**Parents waiting for DisperseParents().  Array size is
+  * m_iParentCapacity.*/
+  clTree **mp_oParents;
+
+  /**Value passed to AddParent() for each parent in mp_oParents.  Array size is
+  * m_iParentCapacity.*/
+  float *mp_fParentValues;
+
+  /**Number of parents in mp_oParents*/
+  int m_iNumParents;
+
+  /**Size of mp_oParents and mp_fParentValues*/
+  int m_iParentCapacity;
+
 
 
 ////////////////////////////////////////////////////////////////////////////
@@ -156,11 +305,107 @@ class clDisperseBase : virtual public clBehaviorBase {
   /**Whether dispersal is stochastic (true) or deterministic (false).*/
   static bool m_bIsStochastic;
 
+  /**Whether parents and cells are dispersed in parallel from keyed random
+   * streams.  From the optional di_parallelDispersal parameter; false if
+   * it's missing.*/
+  static bool m_bParallel;
+
+  /**
+  * Seed buffers, one per thread, each holding a seed count for every species
+  * in every cell of the seed grid.  A buffer is indexed by
+  * (species * m_iNumSeedXCells + X cell) * m_iNumSeedYCells + Y cell.  Array
+  * size is m_iNumSeedBuffers times m_iSeedBufferSize.
+  */
+  static float *mp_fSeedBuffers;
+
+  /**Random streams, one per seed buffer.*/
+  static gsl_rng **mp_oSeedStreams;
+
+  /**Number of seed buffers*/
+  static int m_iNumSeedBuffers;
+
+  /**Number of values in one seed buffer*/
+  static int m_iSeedBufferSize;
+
+  /**Number of seed grid cells in the X direction*/
+  static int m_iNumSeedXCells;
+
+  /**Number of seed grid cells in the Y direction*/
+  static int m_iNumSeedYCells;
+
+  /**Length of seed grid cells in the X direction*/
+  static float m_fSeedCellLengthX;
+
+  /**Length of seed grid cells in the Y direction*/
+  static float m_fSeedCellLengthY;
+
  /**
   * Does disperse base setup.  Sets up the "dispersed_seeds" grid, if the
   * static pointer is NULL, and declares mp_fDbhForReproduction.
   */
   void SetUpBase();
+
+  /**
+  * Makes sure there is a zeroed seed buffer and a random stream for each
+  * thread.
+  * @return Number of threads that will use the buffers.
+  */
+  int ReserveSeedBuffers();
+
+  /**
+  * Adds the seed buffers to the seed grid.  Buffers are added in order, so
+  * the sums don't depend on which thread did what.
+  * @param iNumBuffers Number of buffers in use.
+  */
+  void ReduceSeedBuffers(int iNumBuffers);
+
+  /**
+  * Disperses one parent for DisperseParents().  This is handed to
+  * clTaskPool::ParallelFor().
+  */
+  struct stcDisperseParent {
+    clDisperseBase *p_oDisperse; /**<Behavior doing the dispersing*/
+    clTreePopulation *p_oPop; /**<Tree population*/
+    clPlot *p_oPlot; /**<Plot object*/
+    int iTimestep; /**<Current timestep, for keying random streams*/
+    int iBehavior; /**<Behavior list number, for keying random streams*/
+    /**
+    * Disperses one parent into the calling thread's seed buffer.
+    * @param i Parent's index in mp_oParents.
+    */
+    void operator()(int i);
+  };
+
+  /**
+  * Disperses one seed grid cell for DisperseCells().  This is handed to
+  * clTaskPool::ParallelFor().
+  */
+  struct stcDisperseCell {
+    clDisperseBase *p_oDisperse; /**<Behavior doing the dispersing*/
+    clTreePopulation *p_oPop; /**<Tree population*/
+    clPlot *p_oPlot; /**<Plot object*/
+    int iTimestep; /**<Current timestep, for keying random streams*/
+    int iBehavior; /**<Behavior list number, for keying random streams*/
+    /**
+    * Adds one cell's seeds to the calling thread's seed buffer.
+    * @param i Cell number, X-major.
+    */
+    void operator()(int i);
+  };
+
+  /**
+  * Adds the seed buffers into one seed grid cell for ReduceSeedBuffers().
+  * This is handed to clTaskPool::ParallelFor().
+  */
+  struct stcReduceSeeds {
+    int iNumBuffers; /**<Number of buffers in use*/
+    /**
+    * Adds up one cell.  Each cell belongs to one index, so the grid writes
+    * don't collide.
+    * @param iCell Cell number, X-major.
+    */
+    void operator()(int iCell);
+  };
 };
 //---------------------------------------------------------------------------
 
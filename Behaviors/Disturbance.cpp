@@ -804,7 +804,7 @@ void clDisturbance::GetData(xercesc::DOMDocument * p_oDoc) {
     mp_oPop = (clTreePopulation *) mp_oSimManager->GetPopulationObject(
         "treepopulation");
 
-    m_fPopCellLen = mp_oPop->GetGridCellSize();
+    m_fPopCellLen = mp_oPop->GetHashCellLength();
 
     //Set up the harvest info grid
     SetupGrids();
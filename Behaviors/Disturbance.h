@@ -414,7 +414,7 @@ class clDisturbance : virtual public clBehaviorBase {
   /**Disturbance grid cell Y length*/
   float m_fDistYCellLen;
 
-  /**Tree population grid cell length*/
+  /**Tree population hash table cell length*/
   float m_fPopCellLen;
 
   //Other short int variables which are not data member return codes
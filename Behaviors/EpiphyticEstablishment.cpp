@@ -284,7 +284,7 @@ float clEpiphyticEstablishment::GetGLI( clTreePopulation * p_oPop,
     if ( clTreePopulation::seedling != p_oNeighbor->GetType() )
 
       //Add the effect of the neighbor to the simulated fisheye photo
-      AddTreeToGliFishEye( fX, fY, fHeight, p_oNeighbor, p_oPlot, p_oPop, p_oAllom );
+      AddTreeToGliFishEye( fX, fY, fHeight, p_oNeighbor, p_oPlot, p_oPop, p_oAllom, mp_fPhoto );
 
     p_oNeighbor = p_oShaders->NextTree();
   } //end of while (neighbor != NULL)
@@ -3,6 +3,8 @@
 //---------------------------------------------------------------------------
 #include "FoliarChemistry.h"
 #include "TreePopulation.h"
+#include "TreeQuery.h"
+#include "TreeSearch.h"
 #include "SimManager.h"
 #include "ParsingFunctions.h"
 #include "Grid.h"
@@ -29,6 +31,10 @@ clFoliarChemistry::clFoliarChemistry( clSimManager * p_oSimManager ) : clWorkerB
     m_fVersionNumber = 1;
     m_fMinimumVersionNumber = 1;
 
+    //Tree sizes and positions go in; only this behavior's own grid comes out
+    m_iResourcesRead = tree_structure;
+    m_iResourcesWritten = own_grid;
+
     mp_fA = NULL;
     mp_fB = NULL;
     mp_fN = NULL;
@@ -39,7 +45,8 @@ clFoliarChemistry::clFoliarChemistry( clSimManager * p_oSimManager ) : clWorkerB
     mp_fTannins = NULL;
     mp_fPhenolics = NULL;
     mp_fSLA = NULL;
-    m_cQuery = NULL;
+    mp_oQuery = NULL;
+    mp_oSearch = NULL;
     mp_bAppliesTo = NULL;
     mp_iNCodes = NULL;
     mp_iPCodes = NULL;
@@ -109,7 +116,8 @@ clFoliarChemistry::~clFoliarChemistry()
   delete[] mp_fTannins;
   delete[] mp_fPhenolics;
   delete[] mp_fSLA;
-  delete[] m_cQuery;
+  delete mp_oQuery;
+  delete mp_oSearch;
   delete[] mp_iNCodes;
   delete[] mp_iPCodes;
   delete[] mp_iSLACodes;
@@ -204,7 +212,7 @@ void clFoliarChemistry::GetData( xercesc::DOMDocument * p_oDoc )
     GetAppliesTo();
     GetTreeCodes(p_oPop);
     GetParameterFileData(p_oDoc, p_oPop);
-    FormatQueryString(p_oPop);
+    FormatQuery(p_oPop);
     SetupGrid();
     Action();
   }
@@ -487,7 +495,6 @@ void clFoliarChemistry::Action()
   try
   {
     clTreePopulation * p_oPop = ( clTreePopulation * ) mp_oSimManager->GetPopulationObject( "treepopulation" );
-    clTreeSearch * p_oBehaviorTrees;
     clTree * p_oTree;
     float fGridValue, //value in a grid
     fDbh,
@@ -516,9 +523,9 @@ void clFoliarChemistry::Action()
     }
 
     //Get the trees that apply to this behavior
-    p_oBehaviorTrees = p_oPop->Find( m_cQuery );
+    p_oPop->Find( *mp_oQuery, mp_oSearch );
 
-    p_oTree = p_oBehaviorTrees->NextTree();
+    p_oTree = mp_oSearch->NextTree();
 
     while ( p_oTree )
     {
@@ -602,7 +609,7 @@ void clFoliarChemistry::Action()
         }
       }
 
-      p_oTree = p_oBehaviorTrees->NextTree();
+      p_oTree = mp_oSearch->NextTree();
     }
 
   }
@@ -624,63 +631,20 @@ void clFoliarChemistry::Action()
 }
 
 ////////////////////////////////////////////////////////////////////////////
-// FormatQueryString()
+// FormatQuery()
 ////////////////////////////////////////////////////////////////////////////
-void clFoliarChemistry::FormatQueryString(clTreePopulation *p_oPop)
+void clFoliarChemistry::FormatQuery(clTreePopulation *p_oPop)
 {
-  char * cQueryTemp = new char[(p_oPop->GetNumberOfSpecies() * 4) + 50];
-  char cQueryPiece[5]; //for assembling the search query
   int i;
-  bool bSapling = false, bAdult = false, bSnag = false;
 
-  //Do a type/species search on all the types and species
-  strcpy( cQueryTemp, "species=" );
-  for ( i = 0; i < m_iNumBehaviorSpecies - 1; i++ )
-  {
-    sprintf( cQueryPiece, "%d%s", mp_iWhatSpecies[i], "," );
-    strcat( cQueryTemp, cQueryPiece );
-  }
-  sprintf( cQueryPiece, "%d", mp_iWhatSpecies[m_iNumBehaviorSpecies - 1] );
-  strcat( cQueryTemp, cQueryPiece );
+  delete mp_oQuery;
+  delete mp_oSearch;
+  mp_oQuery = new clTreeQuery(p_oPop);
+  mp_oSearch = new clTreeSearch(p_oPop);
 
-  //Find all the types
+  //Do a type/species search on all the types and species
+  for ( i = 0; i < m_iNumBehaviorSpecies; i++ )
+    mp_oQuery->AddSpecies( mp_iWhatSpecies[i] );
   for ( i = 0; i < m_iNumSpeciesTypeCombos; i++ )
-  {
-    if ( clTreePopulation::sapling == mp_whatSpeciesTypeCombos[i].iType )
-    {
-      bSapling = true;
-    }
-    else if ( clTreePopulation::adult == mp_whatSpeciesTypeCombos[i].iType )
-    {
-      bAdult = true;
-    }
-    else if ( clTreePopulation::snag == mp_whatSpeciesTypeCombos[i].iType )
-    {
-      bSnag = true;
-    }
-  }
-  strcat( cQueryTemp, "::type=" );
-  if ( bSapling )
-  {
-    sprintf( cQueryPiece, "%d%s", clTreePopulation::sapling, "," );
-    strcat( cQueryTemp, cQueryPiece );
-  }
-  if ( bAdult )
-  {
-    sprintf( cQueryPiece, "%d%s", clTreePopulation::adult, "," );
-    strcat( cQueryTemp, cQueryPiece );
-  }
-  if ( bSnag )
-  {
-    sprintf( cQueryPiece, "%d%s", clTreePopulation::snag, "," );
-    strcat( cQueryTemp, cQueryPiece );
-  }
-
-  //Remove the last comma
-  cQueryTemp[strlen( cQueryTemp ) - 1] = '\0';
-
-  //Now put it in m_cQuery, sized correctly
-  m_cQuery = new char[strlen( cQueryTemp ) + 1];
-  strcpy( m_cQuery, cQueryTemp );
-  delete[] cQueryTemp;
+    mp_oQuery->AddType( mp_whatSpeciesTypeCombos[i].iType );
 }
@@ -7,6 +7,8 @@
 #include "BehaviorBase.h"
 
 class clGrid;
+class clTreeQuery;
+class clTreeSearch;
 
 /**
 * Foliar Chemistry Calculator Version 1.0
@@ -29,6 +31,8 @@ class clGrid;
 * <br>December 2, 2008 - Created (LEM)
 * <br>February 13, 2009 - Corrected component calculation (LEM)
 * <br>April 6, 2009 - Changed grid units from Mg to kg (LEM)
+* <br>October 17, 2026 - Declared resources and switched to a search object of
+* its own so it can run alongside other behaviors (agent)
 */
 class clFoliarChemistry : virtual public clBehaviorBase {
   public:
@@ -107,10 +111,14 @@ class clFoliarChemistry : virtual public clBehaviorBase {
   double *mp_fSLA;
 
 
-  /**String to pass to clTreePopulation::Find() in order to get the trees for
-  * which to calculate volume.  This will instigate a species/type search for
-  * all the species and types to which this behavior applies.*/
-  char *m_cQuery;
+  /**Query to pass to clTreePopulation::Find() in order to get the trees for
+  * which to calculate chemistry.  This is a species/type search for all the
+  * species and types to which this behavior applies.*/
+  clTreeQuery *mp_oQuery;
+
+  /**Search object for the trees.  This behavior owns it rather than using the
+  * population's pooled searches, so it can run alongside other behaviors.*/
+  clTreeSearch *mp_oSearch;
 
   /** Holds codes for DBH data member.  First array index is total # species,
    * second is number types (3 - sapling, adult, snag).*/
@@ -183,11 +191,11 @@ class clFoliarChemistry : virtual public clBehaviorBase {
   void GetParameterFileData(xercesc::DOMDocument *p_oDoc, clTreePopulation *p_oPop);
 
   /**
-  * Formats the string in m_cQuery.  This value will be used in Action() to
+  * Builds mp_oQuery and mp_oSearch.  The query will be used in Action() to
   * pass to clTreePopulation::Find() in order to get the trees to act on.
   * @param p_oPop Tree population object.
   */
-  void FormatQueryString(clTreePopulation *p_oPop);
+  void FormatQuery(clTreePopulation *p_oPop);
 
   /**
   * Sets up the "Foliar Chemistry" grid.  This ignores any maps.
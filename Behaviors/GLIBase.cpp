@@ -30,7 +30,7 @@ clGLIBase::~clGLIBase() {
 //////////////////////////////////////////////////////////////////////////////
 void clGLIBase::AddTreeToGliFishEye(const float &fTargetX, const float
     &fTargetY, const float &fTargetHeight, clTree *p_oNeighbor, clPlot *p_oPlot,
-    clTreePopulation *p_oPop, clAllometry *p_oAllom)
+    clTreePopulation *p_oPop, clAllometry *p_oAllom, float **p_fPhoto)
 {
   try {
     float fDistance,         //distance between target and neighbor trees
@@ -79,7 +79,7 @@ void clGLIBase::AddTreeToGliFishEye(const float &fTargetX, const float
 
       GLIFisheyeNoCanopyIntersect(fTargetX, fTargetY, fNeighX, fNeighY,
           fNeighCanrad, fNeighHeight, iSpecies, fTargetHeight,
-          fDistToNearEdge, p_oNeighbor, p_oPlot, p_oAllom);
+          fDistToNearEdge, p_oNeighbor, p_oPlot, p_oAllom, p_fPhoto);
 
     } //end of target tree not under neighbor canopy
 
@@ -90,7 +90,7 @@ void clGLIBase::AddTreeToGliFishEye(const float &fTargetX, const float
 
       GLIFisheyeCanopyIntersect(fTargetX, fTargetY, fNeighX, fNeighY,
           fNeighCanrad, fNeighHeight, iSpecies, fTargetHeight,
-          p_oNeighbor, p_oPlot, p_oAllom);
+          p_oNeighbor, p_oPlot, p_oAllom, p_fPhoto);
 
     } //end of target is under neighbor canopy
   } //end of try block
@@ -111,20 +111,31 @@ void clGLIBase::GLIFisheyeNoCanopyIntersect(const float &fTargetX, const float
   &fTargetY, const float &fNeighX, const float &fNeighY, const float
   &fNeighCanrad, const float &fNeighHeight, const short int &iNeighSpecies,
   const float &fTargetHeight, const float &fDistToNearEdge,
-  clTree *p_oNeighbor, clPlot *p_oPlot, clAllometry *p_oAllom) {
+  clTree *p_oNeighbor, clPlot *p_oPlot, clAllometry *p_oAllom,
+  float **p_fPhoto) {
 
  try {
-   float fSquareOfNearDist,      //square of the distance to the nearest point
-                                 //that is a solution to the system of equations
-         fSquareOfFarDist,       //square of the distance to the farthest point
-                                 //that is a solution to the system of equations
-         fFarX, fNearX, fFarY, fNearY,//two solutions of system of equations -
-                                 //for the far and near sides of neighbor crown
-         fA, fB, fC,             //variables in quadratic formula
+   float fNearDist, fFarDist,    //distance to the near and far sides of the
+                                 //neighbor crown along a chunk's center
+         fSquareOfNearDist,      //squares of the above
+         fSquareOfFarDist,
          fXDist, fYDist,         //distance between two trees in X and Y planes
+         fDistance,              //distance between the two trees
+         fCanradSquared,         //squared neighbor canopy radius
          fCrownBase,             //height of base of neighbor crown
          fLightExtCoeff,         //light extinction coefficient
-         fNeighAzi,              //azimuth to neighbor
+         fNeighAzi,              //azimuth to neighbor, in radians
+         fHalfWidth,             //angle from the neighbor azimuth to the side
+                                 //of its crown, in radians
+         fChunkSize,             //size of an azimuth chunk, in radians
+         fCosChunk, fSinChunk,   //cosine and sine of fChunkSize
+         fChunkX, fChunkY,       //direction of an azimuth chunk's center
+         fTemp,
+         fAlong,                 //distance along a chunk center to the point
+                                 //nearest the neighbor
+         fAcross,                //distance from a chunk center to the neighbor
+         fHalfChord,             //half the chord a chunk center cuts through
+                                 //the neighbor crown
          fHeightDiff,            //difference in crown top heights
          fHeightDiffSquared,     //squared difference in heights
          fHeightDiffChunkConv,   //height diff combined with chunk conversion
@@ -132,17 +143,17 @@ void clGLIBase::GLIFisheyeNoCanopyIntersect(const float &fTargetX, const float
          fCrownBaseDiff,         //difference in height between neighbor crown
                                  //base and target tree crown top
          fCrownBaseDiffSquared,  //squared difference between crown base and ht.
-         fCrownBaseDiffChunkConv,//crown base/height diff combined with chunk
+         fCrownBaseDiffChunkConv;//crown base/height diff combined with chunk
                                  //conversion factor for calc. altitude chunk
-         fAziChunkSlope;         //slope to azimuth chunk
-   int iAziChunkIncrementer,     //increments the azi chunk - or decrements it,
-                                 //depending on the direction we're searching
-       iAltStart, iAltEnd,       //start and end azimuth chunk coordinates
+   int iAltStart, iAltEnd,       //start and end altitude chunk coordinates
        iHomeAziChunk,            //azimuth chunk the neighbor's trunk is in
-       iAziChunk,                //azi chunk we're working with
-       iChunkCounter = 0,        //how many azi chunks we've done
+       iFirstChunk, iLastChunk,  //first and last blocked azimuth chunks,
+                                 //unwrapped - may be off either end
+       iNumWest, iNumEast,       //number of blocked chunks on either side of
+                                 //the home chunk
        iHalfTheAzis = m_iNumAziAng/2, //half the azimuth chunks
-       i;                        //loop counter
+       iAziChunk,                //azi chunk we're working with
+       i, j;                     //loop counters
 
    //Make sure this neighbor tree actually will shade
    //Calculate difference in height between target and neighbor
@@ -174,119 +185,91 @@ void clGLIBase::GLIFisheyeNoCanopyIntersect(const float &fTargetX, const float
    //Distance between the trees in the X and Y planes
    fXDist = p_oPlot->GetXDistance(fTargetX, fNeighX);
    fYDist = p_oPlot->GetYDistance(fTargetY, fNeighY);
+   fDistance = sqrt(fXDist * fXDist + fYDist * fYDist);
+   fCanradSquared = fNeighCanrad * fNeighCanrad;
    //Neighbor's light extinction coefficient
    fLightExtCoeff = GetLightExtinctionCoefficient(p_oNeighbor);
-   //Start the azimuth searching to the west of the tree
-   iAziChunkIncrementer = -1;
-   //Slope of line to azimuth chunk - for the first time use actual slope to
-   //ensure that we get a hit on the azimuth chunk
-   fAziChunkSlope = (fXDist == 0) ? 100000.0 : fYDist / fXDist;
 
    //**************************************
-   //Find the azimuth chunk containing the neighbor -
-   //our starting point
+   //Find the blocked azimuth chunks. A chunk is blocked if the line through
+   //its center hits the neighbor crown, which is when the center is within
+   //asin(radius / distance) of the azimuth to the neighbor. The chunk holding
+   //the neighbor is always blocked.
    //**************************************
-   //Get the azimuth to the neighbor
-   fNeighAzi = p_oPlot->GetFastAzimuthAngle(fTargetX, fTargetY, fNeighX,
-                   fNeighY);
-   iHomeAziChunk = (int)floor(fNeighAzi * m_fAziChunkConverter);
-   iAziChunk = iHomeAziChunk;
+   fChunkSize = (2.0 * M_PI) / m_iNumAziAng;
+   fNeighAzi = atan2(fXDist, fYDist);
+   if (fNeighAzi < 0) fNeighAzi += 2.0 * M_PI;
+   iHomeAziChunk = (int)floor(fNeighAzi / fChunkSize);
+   if (iHomeAziChunk >= m_iNumAziAng) iHomeAziChunk = m_iNumAziAng - 1;
+   fHalfWidth = fNeighCanrad >= fDistance ? M_PI / 2.0 :
+       asin(fNeighCanrad / fDistance);
+   iFirstChunk = (int)ceil((fNeighAzi - fHalfWidth) / fChunkSize - 0.5);
+   iLastChunk = (int)floor((fNeighAzi + fHalfWidth) / fChunkSize - 0.5);
+   iNumWest = iHomeAziChunk - iFirstChunk;
+   iNumEast = iLastChunk - iHomeAziChunk;
+   if (iNumWest < 0) iNumWest = 0;
+   if (iNumEast < 0) iNumEast = 0;
+   //Never go more than half way around the sky in either direction
+   if (iNumWest >= iHalfTheAzis - 1) {
+     iNumWest = iHalfTheAzis - 1;
+     iNumEast = 0;
+   }
+   else if (iNumEast > iHalfTheAzis - 1) iNumEast = iHalfTheAzis - 1;
+   if (iNumWest < 0) iNumWest = 0;
+   if (iNumEast < 0) iNumEast = 0;
 
    //**************************************
-   //Find all azimuth chunks blocked by the neighbor.  Check chunks on either
-   //side of the starting point until we find them all - and for each one,
-   //calculate the altitude chunks covered and add the whole business to the
-   //photo array
+   //For each blocked chunk, find the altitude chunks covered and multiply the
+   //light extinction coefficient into the photo array. The chunk center's
+   //direction is stepped along by rotating it one chunk at a time. Do all
+   //calculations as though the target tree is at the origin.
    //**************************************
-
-   while (1) {
-
-     //We have to use linear algebra to solve the system of equations of
-     //the circle of the neighbor's canopy and the line from the target to
-     //the center of the azimuth chunk in question.  The slope of the line
-     //is in mp_fAziSlope.  Do all calculations as though the target tree
-     //is at the origin.
-
-     //Plug in for a, b, and c in the quadratic formula
-     fA = 1.0 + fAziChunkSlope * fAziChunkSlope;
-     fB = -2.0 * (fXDist + fAziChunkSlope * fYDist);
-     fC = fYDist * fYDist + fXDist * fXDist - fNeighCanrad * fNeighCanrad;
-     fC = fB * fB - 4.0 * fA * fC;
-
-     //If fC is positive, it means that the system of equations has a real
-     //solution, the circle and line intersect, and thus the azimuth chunk is
-     //blocked.
-     if (fC >= 0.0) {
-
-       //Finish solving the quadratic formula so we can calculate altitude angles.
-       //We'll have an X,Y point for the slope's intersection with the near and
-       //far sides of the neighbor's crown
-       fC = sqrt((double) fC);
-       fNearX = (-fB - fC) / (2.0 * fA);
-       fFarX = (-fB + fC) / (2.0 * fA);
-       fNearY = fAziChunkSlope * fNearX;
-       fFarY = fAziChunkSlope * fFarX;
-
-       //Calculate the squares of the distances to the near and far points on the
-       //neighbor's crown - we don't need to bother taking the square roots
-       fSquareOfNearDist = fNearX * fNearX + fNearY * fNearY;
-       fSquareOfFarDist = fFarX * fFarX + fFarY * fFarY;
-
-       //Switch them in case we were wrong about which point was near
-       if (fSquareOfNearDist > fSquareOfFarDist) {
-         fA = fSquareOfNearDist; //dangerously reusing fA!
-         fSquareOfNearDist = fSquareOfFarDist;
-         fSquareOfFarDist = fA;
-       }
-
-       //Calculate the starting and ending altitude chunks for this azimuth
-       //chunk
-       iAltStart = (int) (fCrownBaseDiffChunkConv /
-                    sqrt((double)(fSquareOfFarDist + fCrownBaseDiffSquared)));
-       if (iAltStart < m_iMinAngRow)  iAltStart = m_iMinAngRow;
-
-       iAltEnd = (int) (fHeightDiffChunkConv /
-                    sqrt((double)(fSquareOfNearDist + fHeightDiffSquared)));
-       if (iAltEnd >= m_iNumAltAng)  iAltEnd = m_iNumAltAng - 1;
-
-       //Now multiply the light extinction coefficient into the photo array for
-       //the altitude chunks for this azimuth angle
-       for (i = iAltStart; i <= iAltEnd; i++)
-         mp_fPhoto[i][iAziChunk] *= fLightExtCoeff;
-
-     } //end of if (fC >= 0.0)
-
-     //If that azimuth chunk wasn't blocked, we're done searching in this
-     //direction.  If we've also searched the other direction, quit
-     else if (iAziChunkIncrementer == 1) return;
-
-     //We still need to search the other direction
-     else {
-
-       //Go back to the home chunk - we'll increment past it below
-       iAziChunk = iHomeAziChunk;
-       //Flip the incrementer to the other direction
-       iAziChunkIncrementer = 1;
-       //Start the chunk counter over
-       iChunkCounter = 0;
+   fCosChunk = cos(fChunkSize);
+   fSinChunk = sin(fChunkSize);
+   fTemp = (iHomeAziChunk - iNumWest + 0.5) * fChunkSize;
+   fChunkX = sin(fTemp);
+   fChunkY = cos(fTemp);
+   iAziChunk = iHomeAziChunk - iNumWest;
+   if (iAziChunk < 0) iAziChunk += m_iNumAziAng;
+   for (j = -iNumWest; j <= iNumEast; j++) {
+
+     if (0 == j) {
+       //The home chunk is measured along the line to the neighbor itself
+       fNearDist = fDistance - fNeighCanrad;
+       fFarDist = fDistance + fNeighCanrad;
+     } else {
+       fAlong = fXDist * fChunkX + fYDist * fChunkY;
+       fAcross = fXDist * fChunkY - fYDist * fChunkX;
+       fHalfChord = fCanradSquared - fAcross * fAcross;
+       fHalfChord = fHalfChord > 0 ? sqrt(fHalfChord) : 0;
+       fNearDist = fAlong - fHalfChord;
+       fFarDist = fAlong + fHalfChord;
      }
+     fSquareOfNearDist = fNearDist * fNearDist;
+     fSquareOfFarDist = fFarDist * fFarDist;
 
-      //Increment the azimuth chunk in the appropriate direction
-     iAziChunk += iAziChunkIncrementer;
-     iChunkCounter++;
-
-     //If we've done half the azimuth angles, quit even if we're still
-     //finding solutions
-     if (iChunkCounter == iHalfTheAzis) return;
+     //Calculate the starting and ending altitude chunks for this azimuth
+     //chunk
+     iAltStart = (int) (fCrownBaseDiffChunkConv /
+                  sqrt((double)(fSquareOfFarDist + fCrownBaseDiffSquared)));
+     if (iAltStart < m_iMinAngRow)  iAltStart = m_iMinAngRow;
 
-     //If we've gone too far in either direction, wrap around
-     if (iAziChunk < 0)
-     iAziChunk = m_iNumAziAng - 1;
-     else if(iAziChunk == m_iNumAziAng)
-     iAziChunk = 0;
+     iAltEnd = (int) (fHeightDiffChunkConv /
+                  sqrt((double)(fSquareOfNearDist + fHeightDiffSquared)));
+     if (iAltEnd >= m_iNumAltAng)  iAltEnd = m_iNumAltAng - 1;
 
-     fAziChunkSlope = mp_fAziSlope[iAziChunk];
-   } //end of while (1)
+     //Now multiply the light extinction coefficient into the photo array for
+     //the altitude chunks for this azimuth angle
+     for (i = iAltStart; i <= iAltEnd; i++)
+       p_fPhoto[i][iAziChunk] *= fLightExtCoeff;
+
+     //Move to the next chunk clockwise
+     fTemp = fChunkX * fCosChunk + fChunkY * fSinChunk;
+     fChunkY = fChunkY * fCosChunk - fChunkX * fSinChunk;
+     fChunkX = fTemp;
+     iAziChunk++;
+     if (iAziChunk == m_iNumAziAng) iAziChunk = 0;
+   }
 
  } //end of try block
  catch (modelErr&err) {throw(err);}
@@ -306,7 +289,7 @@ void clGLIBase::GLIFisheyeCanopyIntersect(const float &fTargetX, const float
   &fTargetY, const float &fNeighX, const float &fNeighY, const float
   &fNeighCanrad, const float &fNeighHeight, const short int &iNeighSpecies,
   const float &fTargetHeight, clTree *p_oNeighbor, clPlot *p_oPlot,
-  clAllometry *p_oAllom) {
+  clAllometry *p_oAllom, float **p_fPhoto) {
  try {
    float fXDist, fYDist, //distance between two trees in X and Y directions
          fLightExtCoeff, //light extinction coefficient
@@ -352,7 +335,7 @@ void clGLIBase::GLIFisheyeCanopyIntersect(const float &fTargetX, const float
      iAziEnd = m_iNumAziAng - 1;
      for (i = iAltStart; i <= iAltEnd; i++)
        for (j = iAziStart; j <= iAziEnd; j++)
-         mp_fPhoto[i][j] *= fLightExtCoeff;
+         p_fPhoto[i][j] *= fLightExtCoeff;
 
    } else { //neighbor blocks part of sky
      //Do half the sky - we'll solve in both directions at once
@@ -400,7 +383,7 @@ void clGLIBase::GLIFisheyeCanopyIntersect(const float &fTargetX, const float
 
          //Use coords to loop thru chunk of sky array and mark it as blocked
          for (k = iAltStart; k <= iAltEnd; k++)
-           mp_fPhoto[k][iAziChunk] *= fLightExtCoeff;
+           p_fPhoto[k][iAziChunk] *= fLightExtCoeff;
        } //end of for (int j = 0; j < 2; j++)
      } //end of for (i = 0; i < iHalfAzi; i++)
    } //end of else
@@ -414,4 +397,14 @@ void clGLIBase::GLIFisheyeCanopyIntersect(const float &fTargetX, const float
    throw(stcErr);
  }
 }
+
+//////////////////////////////////////////////////////////////////////////////
+// stcFishEyeShaders::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clGLIBase::stcFishEyeShaders::operator()(clTree *p_oNeighbor,
+    float fDistanceSq) {
+  if (p_oNeighbor != p_oTarget)
+    p_oLight->AddTreeToGliFishEye(fX, fY, fHeight, p_oNeighbor, p_oPlot,
+        p_oPop, p_oAllom, p_fPhoto);
+}
 //----------------------------------------------------------------------------
@@ -39,6 +39,10 @@ class clAllometry;
 * <br>Edit history:
 * <br>-----------------
 * <br>April 28, 2004 - Submitted as beta (LEM)
+* <br>October 17, 2026 - The fisheye functions draw into a photo array passed
+* to them, so several threads can draw at once; added stcFishEyeShaders (agent)
+* <br>October 17, 2026 - GLIFisheyeNoCanopyIntersect() finds the blocked
+* azimuth chunks from the crown's angular width instead of searching (agent)
 */
 class clGLIBase : virtual public clLightBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -104,16 +108,21 @@ class clGLIBase : virtual public clLightBase {
    * @param p_oPlot Pointer to the plot object
    * @param p_oPop Pointer to the tree population object
    * @param p_oAllom Pointer to an allometry object
+   * @param p_fPhoto Fisheye photo array to draw the neighbor into
    */
   void AddTreeToGliFishEye(const float &fTargetX, const float &fTargetY, const
     float &fTargetHeight, clTree *p_oNeighbor, clPlot *p_oPlot,
-    clTreePopulation *p_oPop, clAllometry *p_oAllom);
+    clTreePopulation *p_oPop, clAllometry *p_oAllom, float **p_fPhoto);
 
   /**
    * Adds one shading neighbor to the fisheye photo array for a GLI
    * calculation when the canopies of the two trees do not overlap.  Called by
    * AddTreeToGliFishEye().
    *
+   * The blocked azimuth chunks are those whose centers are within
+   * asin(crown radius / distance) of the azimuth to the neighbor, plus the
+   * chunk the neighbor is in; they are found directly from that angle.
+   *
    * @param fTargetX X coordinate of target tree
    * @param fTargetY Y coordinate of target tree
    * @param fNeighX X coordinate of shading neighbor
@@ -127,13 +136,14 @@ class clGLIBase : virtual public clLightBase {
    * @param p_oNeighbor The neighbor to be added
    * @param p_oPlot Pointer to plot object
    * @param p_oAllom Pointer to an allometry object
+   * @param p_fPhoto Fisheye photo array to draw the neighbor into
    */
   void GLIFisheyeNoCanopyIntersect(const float &fTargetX, const float
       &fTargetY, const float &fNeighX, const float &fNeighY, const float
       &fNeighCanrad, const float &fNeighHeight,
       const short int &iNeighSpecies, const float &fTargetHeight,
       const float &fDistToNearEdge, clTree *p_oNeighbor, clPlot *p_oPlot,
-      clAllometry *p_oAllom);
+      clAllometry *p_oAllom, float **p_fPhoto);
 
   /**
    * Adds one shading neighbor to the fisheye photo array for a GLI
@@ -151,12 +161,38 @@ class clGLIBase : virtual public clLightBase {
    * @param p_oNeighbor The neighbor to be added
    * @param p_oPlot Pointer to plot object
    * @param p_oAllom Pointer to an allometry object
+   * @param p_fPhoto Fisheye photo array to draw the neighbor into
    */
   void GLIFisheyeCanopyIntersect(const float &fTargetX, const float
       &fTargetY, const float &fNeighX, const float &fNeighY, const float
       &fNeighCanrad, const float &fNeighHeight,
       const short int &iNeighSpecies, const float &fTargetHeight,
-      clTree *p_oNeighbor, clPlot *p_oPlot, clAllometry *p_oAllom);
+      clTree *p_oNeighbor, clPlot *p_oPlot, clAllometry *p_oAllom,
+      float **p_fPhoto);
+
+  /**
+  * Adds each shading neighbor of a point to a fisheye photo. This is handed
+  * to clTreePopulation::ForEachNeighbor(), with seedlings masked out.
+  */
+  struct stcFishEyeShaders {
+    clGLIBase *p_oLight; /**<Light object doing the drawing*/
+    clTree *p_oTarget; /**<Target tree, which doesn't shade itself; can be
+    NULL*/
+    clPlot *p_oPlot; /**<Plot object*/
+    clTreePopulation *p_oPop; /**<Tree population*/
+    clAllometry *p_oAllom; /**<Allometry object*/
+    float **p_fPhoto; /**<Fisheye photo array to draw into*/
+    float fX; /**<X coordinate of the photo*/
+    float fY; /**<Y coordinate of the photo*/
+    float fHeight; /**<Height of the photo, in meters*/
+
+    /**
+    * Adds one neighbor to the photo.
+    * @param p_oNeighbor Neighbor.
+    * @param fDistanceSq Squared distance to neighbor. Not used.
+    */
+    void operator()(clTree *p_oNeighbor, float fDistanceSq);
+  };
 };
 //---------------------------------------------------------------------------
 #endif
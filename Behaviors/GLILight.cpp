@@ -6,6 +6,7 @@
 #include "LightOrg.h"
 #include "Allometry.h"
 #include <stdio.h>
+#include <math.h>
 #include <sstream>
 
 /////////////////////////////////////////////////////////////////////////////
@@ -20,6 +21,10 @@ clLightBase( p_oSimManager ), clGLIBase(p_oSimManager) {
   m_sXMLRoot = "GLILight";
 
   m_iPhotoDepth = clLightOrg::mid;
+
+  //Light is drawn into a per-thread photo and the searches don't use the
+  //population's search objects
+  m_bThreadSafe = true;
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -153,15 +158,44 @@ void clGliLight::DoShellSetup(xercesc::DOMDocument *p_oDoc) {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////
+// GetPhotoHeight()
+////////////////////////////////////////////////////////////////////////////
+float clGliLight::GetPhotoHeight(clTree *p_oTree, clTreePopulation *p_oPop) {
+  clAllometry *p_oAllom = p_oPop->GetAllometryObject();
+  float fTreeHeight;
+  short int iSpecies = p_oTree->GetSpecies(), iType = p_oTree->GetType();
+
+  p_oTree->GetValue(p_oPop->GetHeightCode(iSpecies, iType), &fTreeHeight);
+  if (m_iPhotoDepth == clLightOrg::mid) {
+    if (clTreePopulation::adult == iType) {
+      fTreeHeight = fTreeHeight -
+          (0.5 * p_oAllom->CalcAdultCrownDepth(p_oTree));
+    } else if (clTreePopulation::sapling == iType) {//sapling
+      fTreeHeight = fTreeHeight -
+          (0.5 * p_oAllom->CalcSaplingCrownDepth(p_oTree));
+    }
+    //else ; //seedlings - tree height is already OK
+  }
+  return fTreeHeight;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// GetLightReach()
+////////////////////////////////////////////////////////////////////////////
+float clGliLight::GetLightReach(clTree *p_oTree, clTreePopulation *p_oPop) {
+  return (mp_oLightOrg->GetMaxTreeHeight() - GetPhotoHeight(p_oTree, p_oPop))
+      * m_fRcpTanMinAng + p_oPop->GetAllometryObject()->GetMaxCrownRadius();
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // CalcLightValue()
 ////////////////////////////////////////////////////////////////////////////
 float clGliLight::CalcLightValue(clTree *p_oTree, clTreePopulation *p_oPop) {
-  clTreeSearch *p_oShaders; //neighborhood trees who can shade each target
-  clTree *p_oNeighbor; //shading neighbors
+  stcFishEyeShaders stcShaders; //adds shading neighbors to the photo
   clPlot *p_oPlot; //plot object - for calculating distances
   clAllometry *p_oAllom = p_oPop->GetAllometryObject();
-  char cQuery[75]; //format search strings into this
+  float **p_fPhoto = GetPhotoArray(); //this thread's fisheye photo
   float fTreeHeight, //height of target tree - if fisheye is taken at mid-crown
   //this must be calculated
   fMaxSearchRad,  //maximum search radius
@@ -176,51 +210,35 @@ float clGliLight::CalcLightValue(clTree *p_oTree, clTreePopulation *p_oPop) {
   //Initialize photo array
   for (i = 0; i < m_iNumAltAng; i++)
     for (j = 0; j < m_iNumAziAng; j++)
-      mp_fPhoto[i][j] = 1.0;
+      p_fPhoto[i][j] = 1.0;
 
   iSpecies = p_oTree->GetSpecies();
   iType = p_oTree->GetType();
 
   //Calculate the height of the fish-eye photo, either mid or top crown
-  p_oTree->GetValue(p_oPop->GetHeightCode(iSpecies, iType), &fTreeHeight);
-  if (m_iPhotoDepth == clLightOrg::mid) {
-    if (clTreePopulation::adult == iType) {
-      fTreeHeight = fTreeHeight -
-          (0.5 * p_oAllom->CalcAdultCrownDepth(p_oTree));
-    } else if (clTreePopulation::sapling == iType) {//sapling
-      fTreeHeight = fTreeHeight -
-          (0.5 * p_oAllom->CalcSaplingCrownDepth(p_oTree));
-    }
-    //else ; //seedlings - tree height is already OK
-  }
+  fTreeHeight = GetPhotoHeight(p_oTree, p_oPop);
 
   //Calculate search radius to look for shading neighbors
   fMaxSearchRad = (mp_oLightOrg->GetMaxTreeHeight() - fTreeHeight) *
       m_fRcpTanMinAng + p_oAllom->GetMaxCrownRadius();
 
-  //Get a list of all trees that are within the search radius and taller than
-  //the fish-eye photo height
+  //Add all trees that are within the search radius and taller than the
+  //fish-eye photo height to the photo. Seedlings don't shade, and the target
+  //tree is skipped.
   p_oTree->GetValue(p_oPop->GetXCode(iSpecies, iType), &fX);
   p_oTree->GetValue(p_oPop->GetYCode(iSpecies, iType), &fY);
-  sprintf(cQuery, "%s%f%s%f%s%f%s%f", "distance=", fMaxSearchRad, " FROM x=",
-      fX, "y=", fY, "::height=", fTreeHeight);
-  p_oShaders = p_oPop->Find(cQuery);
-
-  p_oNeighbor = p_oShaders->NextTree();
-  while (p_oNeighbor != NULL) {
-
-    //Skip seedlings, which don't shade, and the target tree if returned
-    if (clTreePopulation::seedling != p_oNeighbor->GetType() &&
-        p_oNeighbor != p_oTree) {
-
-      //Add the effect of the neighbor to the simulated fisheye photo
-      AddTreeToGliFishEye(fX, fY, fTreeHeight, p_oNeighbor, p_oPlot, p_oPop,
-          p_oAllom);
-
-    }
-
-    p_oNeighbor = p_oShaders->NextTree();
-  } //end of while (neighbor != NULL)
+  stcShaders.p_oLight = this;
+  stcShaders.p_oTarget = p_oTree;
+  stcShaders.p_oPlot = p_oPlot;
+  stcShaders.p_oPop = p_oPop;
+  stcShaders.p_oAllom = p_oAllom;
+  stcShaders.p_fPhoto = p_fPhoto;
+  stcShaders.fX = fX;
+  stcShaders.fY = fY;
+  stcShaders.fHeight = fTreeHeight;
+  p_oPop->ForEachNeighbor(fX, fY, fMaxSearchRad, fTreeHeight,
+      (1 << clTreePopulation::sapling) | (1 << clTreePopulation::adult) |
+      (1 << clTreePopulation::snag), stcShaders);
 
   //Write photo array
   /*   fstream photo("Gli Light Photo array.xls", ios::app | ios::out);
@@ -231,7 +249,7 @@ float clGliLight::CalcLightValue(clTree *p_oTree, clTreePopulation *p_oPop) {
    for (i = 0; i < m_iNumAltAng; i++) {
      photo << "\n" << i;
      for (j = 0; j < m_iNumAziAng; j++)
-       photo << "\t" << mp_fPhoto[i][j];
+       photo << "\t" << p_fPhoto[i][j];
    }
    photo.close();*/
 
@@ -239,7 +257,7 @@ float clGliLight::CalcLightValue(clTree *p_oTree, clTreePopulation *p_oPop) {
   fGli = 0.0;
   for (i = 0; i < m_iNumAltAng; i++)
     for (j = 0; j < m_iNumAziAng; j++)
-      fGli += (mp_fPhoto[i][j] * mp_fBrightness[i][j]);
+      fGli += (p_fPhoto[i][j] * mp_fBrightness[i][j]);
   fGli *= 100;
   return fGli;
 }
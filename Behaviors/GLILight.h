@@ -28,6 +28,9 @@ class clTreePopulation;
  * <br>Edit history:
  * <br>-----------------
  * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+ * <br>October 17, 2026 - Thread-safe: finds shading neighbors with
+ * clTreePopulation::ForEachNeighbor() and draws into a per-thread photo (agent)
+ * <br>October 17, 2026 - Added GetLightReach() (agent)
 */
 
 class clGliLight : virtual public clGLIBase {
@@ -59,10 +62,30 @@ public:
    */
   float CalcLightValue(clTree *p_oTree, clTreePopulation *p_oPop);
 
+  /**
+   * Gets the search radius for a tree's shading neighbors, which is as far
+   * as other trees can be and change its GLI.
+   * @param p_oTree Tree whose GLI is in question.
+   * @param p_oPop Pointer to the tree population object.
+   * @return Search radius, in meters.
+   */
+  float GetLightReach(clTree *p_oTree, clTreePopulation *p_oPop);
+
   clLightOrg::fotocrowndpth m_iPhotoDepth; /**<Depth of fisheye photo in tree.
   Defaults to top of crown, and thus is not required in the parameter file. Old
   parameter fotodepth*/
 
+
+  protected:
+
+  /**
+   * Gets the height of a tree's fisheye photo, which is at the top or the
+   * middle of its crown depending on m_iPhotoDepth.
+   * @param p_oTree Tree.
+   * @param p_oPop Pointer to the tree population object.
+   * @return Photo height, in meters.
+   */
+  float GetPhotoHeight(clTree *p_oTree, clTreePopulation *p_oPop);
 };
 //---------------------------------------------------------------------------
 #endif
@@ -8,7 +8,9 @@
 #include "TreePopulation.h"
 #include "LightOrg.h"
 #include "Allometry.h"
+#include "TaskPool.h"
 #include <stdio.h>
+#include <stdlib.h>
 #include <sstream>
 
 ////////////////////////////////////////////////////////////////////////////
@@ -26,6 +28,32 @@ clGLIMap::clGLIMap( clSimManager * p_oSimManager ) :
   mp_oMapGrid = NULL;
   m_fLightHeight = 0;
   m_fMaxSearchDistance = 0;
+  mp_fCellGli = NULL;
+  mp_fLightHeights = NULL;
+  mp_fMaxSearchDistances = NULL;
+  mp_iGridGliCodes = NULL;
+  m_iNumHeights = 0;
+  mp_fMapPhotos = NULL;
+  m_iNumPhotoThreads = 0;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Destructor
+////////////////////////////////////////////////////////////////////////////
+clGLIMap::~clGLIMap()
+{
+  int i, j;
+  for ( i = 0; i < m_iNumPhotoThreads * m_iNumHeights; i++ )
+  {
+    for ( j = 0; j < m_iNumAltAng; j++ )
+      delete[] mp_fMapPhotos[i][j];
+    delete[] mp_fMapPhotos[i];
+  }
+  delete[] mp_fMapPhotos;
+  delete[] mp_fCellGli;
+  delete[] mp_fLightHeights;
+  delete[] mp_fMaxSearchDistances;
+  delete[] mp_iGridGliCodes;
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -65,31 +93,43 @@ void clGLIMap::SetUpGrid()
 {
   float fGLI; //for setting initial value
   short int iNumXCells, iNumYCells, //number X and Y grid cells
-       i, j; //loop counters
+       i, j, k; //loop counters
   std::stringstream sMapName;
   sMapName << "GLI Map " << GetBehaviorListNumber();
   mp_oMapGrid = mp_oSimManager->GetGridObject( sMapName.str().c_str() );
+  bool bCreated = false;
 
   if ( !mp_oMapGrid )
   {
-    //Create the grid with one float data member
-    mp_oMapGrid = mp_oSimManager->CreateGrid( sMapName.str().c_str(), 0, 1, 0, 0 );
-    //Register the data member - called "GLI"
-    m_iGridGliCode = mp_oMapGrid->RegisterFloat( "GLI" );
+    //Create the grid with one float data member per height
+    mp_oMapGrid = mp_oSimManager->CreateGrid( sMapName.str().c_str(), 0,
+        m_iNumHeights, 0, 0 );
+    bCreated = true;
   }
-  else
+
+  //Register or get the data members - called "GLI", "GLI 2", "GLI 3"...
+  mp_iGridGliCodes = new short int[m_iNumHeights];
+  for ( k = 0; k < m_iNumHeights; k++ )
   {
-    //Get the data member code
-    m_iGridGliCode = mp_oMapGrid->GetFloatDataCode( "GLI" );
-    if ( -1 == m_iGridGliCode )
+    std::stringstream sLabel;
+    sLabel << "GLI";
+    if ( k > 0 ) sLabel << " " << ( k + 1 );
+    if ( bCreated )
+      mp_iGridGliCodes[k] = mp_oMapGrid->RegisterFloat( sLabel.str() );
+    else
     {
-      modelErr stcErr;
-      stcErr.iErrorCode = BAD_DATA;
-      stcErr.sFunction = "clGLIMap::SetUpGrid" ;
-      stcErr.sMoreInfo = "\"GLI Map\" grid was incorrectly set up in the parameter file.  Missing float \"GLI\".";
-      throw( stcErr );
+      mp_iGridGliCodes[k] = mp_oMapGrid->GetFloatDataCode( sLabel.str() );
+      if ( -1 == mp_iGridGliCodes[k] )
+      {
+        modelErr stcErr;
+        stcErr.iErrorCode = BAD_DATA;
+        stcErr.sFunction = "clGLIMap::SetUpGrid" ;
+        stcErr.sMoreInfo = "\"GLI Map\" grid was incorrectly set up in the parameter file.  Missing float \"" + sLabel.str() + "\".";
+        throw( stcErr );
+      }
     }
   }
+  m_iGridGliCode = mp_iGridGliCodes[0];
 
   //Set all the values to -1
   iNumXCells = mp_oMapGrid->GetNumberXCells();
@@ -97,8 +137,10 @@ void clGLIMap::SetUpGrid()
   fGLI = 0;
   for ( i = 0; i < iNumXCells; i++ )
     for ( j = 0; j < iNumYCells; j++ )
-      mp_oMapGrid->SetValueOfCell( i, j, m_iGridGliCode, fGLI );
+      for ( k = 0; k < m_iNumHeights; k++ )
+        mp_oMapGrid->SetValueOfCell( i, j, mp_iGridGliCodes[k], fGLI );
 
+  mp_fCellGli = new float[iNumXCells * iNumYCells * m_iNumHeights];
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -124,9 +166,12 @@ void clGLIMap::DoSetupCalculations()
     mp_fAziSlope[i + iHalfAzi] = mp_fAziSlope[i];
   }
 
-  //Calculate search radius to look for shading neighbors
+  //Calculate search radius to look for shading neighbors at each height
   clTreePopulation *p_oPop = (clTreePopulation*) mp_oSimManager->GetPopulationObject("treepopulation");
-  m_fMaxSearchDistance = ( mp_oLightOrg->GetMaxTreeHeight() - m_fLightHeight ) * m_fRcpTanMinAng + p_oPop->GetAllometryObject()->GetMaxCrownRadius();
+  mp_fMaxSearchDistances = new float[m_iNumHeights];
+  for ( i = 0; i < m_iNumHeights; i++ )
+    mp_fMaxSearchDistances[i] = ( mp_oLightOrg->GetMaxTreeHeight() - mp_fLightHeights[i] ) * m_fRcpTanMinAng + p_oPop->GetAllometryObject()->GetMaxCrownRadius();
+  m_fMaxSearchDistance = mp_fMaxSearchDistances[0];
 }
 
 
@@ -227,6 +272,23 @@ void clGLIMap::ReadParameterFileData( xercesc::DOMDocument * p_oDoc )
   //Get the photo height value - required
   FillSingleValue( p_oElement, "li_mapLightHeight", & m_fLightHeight, true );
 
+  //There may be more than one height
+  DOMNodeList * p_oHeightList;
+  XMLCh *sVal = XMLString::transcode( "li_mapLightHeight" );
+  char *cData;
+  int i;
+  p_oHeightList = p_oElement->getElementsByTagName( sVal );
+  XMLString::release(&sVal);
+  m_iNumHeights = p_oHeightList->getLength();
+  mp_fLightHeights = new float[m_iNumHeights];
+  mp_fLightHeights[0] = m_fLightHeight;
+  for ( i = 1; i < m_iNumHeights; i++ )
+  {
+    cData = XMLString::transcode( p_oHeightList->item( i )->getFirstChild()->getNodeValue() );
+    mp_fLightHeights[i] = atof( cData );
+    delete[] cData; cData = NULL;
+  }
+
   //Get our values
   //Number of alitude angles
   FillSingleValue( p_oElement, "li_numAltGrids", & m_iNumAltAng, true );
@@ -256,13 +318,16 @@ void clGLIMap::ReadParameterFileData( xercesc::DOMDocument * p_oDoc )
     throw( stcErr );
   }
 
-  if ( 0 > m_fLightHeight )
+  for ( i = 0; i < m_iNumHeights; i++ )
   {
-    modelErr stcErr;
-    stcErr.iErrorCode = BAD_DATA;
-    stcErr.sFunction = "clGLIMap::ReadParameterFileData" ;
-    stcErr.sMoreInfo = "The height of the GLI point for the GLI map cannot be less than 0.";
-    throw( stcErr );
+    if ( 0 > mp_fLightHeights[i] )
+    {
+      modelErr stcErr;
+      stcErr.iErrorCode = BAD_DATA;
+      stcErr.sFunction = "clGLIMap::ReadParameterFileData" ;
+      stcErr.sMoreInfo = "The height of the GLI point for the GLI map cannot be less than 0.";
+      throw( stcErr );
+    }
   }
 
   //Make sure azimuth of north is between 0 and 2PI
@@ -277,6 +342,101 @@ void clGLIMap::ReadParameterFileData( xercesc::DOMDocument * p_oDoc )
 
 
 
+////////////////////////////////////////////////////////////////////////////
+// ReserveMapPhotos()
+////////////////////////////////////////////////////////////////////////////
+void clGLIMap::ReserveMapPhotos( int iNumThreads )
+{
+  float ***p_fOldPhotos = mp_fMapPhotos;
+  int i, j;
+
+  if ( iNumThreads <= m_iNumPhotoThreads ) return;
+
+  mp_fMapPhotos = new float ** [iNumThreads * m_iNumHeights];
+  for ( i = 0; i < m_iNumPhotoThreads * m_iNumHeights; i++ )
+    mp_fMapPhotos[i] = p_fOldPhotos[i];
+  for ( ; i < iNumThreads * m_iNumHeights; i++ )
+  {
+    mp_fMapPhotos[i] = new float * [m_iNumAltAng];
+    for ( j = 0; j < m_iNumAltAng; j++ )
+      mp_fMapPhotos[i][j] = new float[m_iNumAziAng];
+  }
+  delete[] p_fOldPhotos;
+  m_iNumPhotoThreads = iNumThreads;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// stcMapShaders::operator()
+////////////////////////////////////////////////////////////////////////////
+void clGLIMap::stcMapShaders::operator()( clTree * p_oNeighbor, float fDistanceSq )
+{
+  float fHeight;
+  int iSp = p_oNeighbor->GetSpecies(), iTp = p_oNeighbor->GetType(), k;
+
+  p_oNeighbor->GetValue( p_oPop->GetHeightCode( iSp, iTp ), & fHeight );
+  for ( k = 0; k < p_oMap->m_iNumHeights; k++ )
+    if ( fHeight > p_oMap->mp_fLightHeights[k] && fDistanceSq <=
+        p_oMap->mp_fMaxSearchDistances[k] * p_oMap->mp_fMaxSearchDistances[k] )
+      p_oMap->AddTreeToGliFishEye( fX, fY, p_oMap->mp_fLightHeights[k],
+          p_oNeighbor, p_oPlot, p_oPop, p_oAllom, p_fPhotos[k] );
+}
+
+////////////////////////////////////////////////////////////////////////////
+// stcMapRow::operator()
+////////////////////////////////////////////////////////////////////////////
+void clGLIMap::stcMapRow::operator()( int iX )
+{
+  stcMapShaders stcShaders; //adds shading neighbors to the photos
+  int iNumYCells = p_oMap->mp_oMapGrid->GetNumberYCells(),
+      iNumHeights = p_oMap->m_iNumHeights,
+      iLowest = 0, //index of the lowest height
+      iY, i, j, k; //loop counters
+  float ***p_fPhotos = p_oMap->mp_fMapPhotos +
+      clTaskPool::GetThreadNumber() * iNumHeights, //this thread's photos
+        fGli; //global light index - end result of all this math
+
+  for ( k = 1; k < iNumHeights; k++ )
+    if ( p_oMap->mp_fLightHeights[k] < p_oMap->mp_fLightHeights[iLowest] )
+      iLowest = k;
+
+  stcShaders.p_oMap = p_oMap;
+  stcShaders.p_oPlot = p_oPlot;
+  stcShaders.p_oPop = p_oPop;
+  stcShaders.p_oAllom = p_oPop->GetAllometryObject();
+  stcShaders.p_fPhotos = p_fPhotos;
+
+  for ( iY = 0; iY < iNumYCells; iY++ )
+  {
+    //First find the point at which to calculate gli - center of the grid
+    //cell
+    p_oMap->mp_oMapGrid->GetPointOfCell( iX, iY, & stcShaders.fX, & stcShaders.fY );
+
+    //Initialize photo arrays
+    for ( k = 0; k < iNumHeights; k++ )
+      for ( i = 0; i < p_oMap->m_iNumAltAng; i++ )
+        for ( j = 0; j < p_oMap->m_iNumAziAng; j++ )
+          p_fPhotos[k][i][j] = 1.0;
+
+    //Add all trees that are within the search radius and taller than the
+    //lowest fish-eye photo height to the photos. Seedlings don't shade.
+    p_oPop->ForEachNeighbor( stcShaders.fX, stcShaders.fY,
+        p_oMap->mp_fMaxSearchDistances[iLowest],
+        p_oMap->mp_fLightHeights[iLowest],
+        ( 1 << clTreePopulation::sapling ) | ( 1 << clTreePopulation::adult ) |
+        ( 1 << clTreePopulation::snag ), stcShaders );
+
+    //Calculate GLI
+    for ( k = 0; k < iNumHeights; k++ )
+    {
+      fGli = 0.0;
+      for ( i = 0; i < p_oMap->m_iNumAltAng; i++ )
+        for ( j = 0; j < p_oMap->m_iNumAziAng; j++ )
+          fGli += ( p_fPhotos[k][i][j] * p_oMap->mp_fBrightness[i][j] );
+      p_oMap->mp_fCellGli[( iX * iNumYCells + iY ) * iNumHeights + k] = fGli * 100;
+    }
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // Action()
 ////////////////////////////////////////////////////////////////////////////
@@ -285,60 +445,27 @@ void clGLIMap::Action()
   try
   {
     clTreePopulation * p_oPop = ( clTreePopulation * ) mp_oSimManager->GetPopulationObject( "treepopulation" );
-    clTreeSearch * p_oShaders; //neighborhood trees who can shade each target
-    clTree * p_oNeighbor; //shading neighbors
-    clPlot * p_oPlot = mp_oSimManager->GetPlotObject();
-    clAllometry * p_oAllom = p_oPop->GetAllometryObject();
-    char cQuery[75]; //format search strings into this
-    float fGli, //global light index - end result of all this math
-         fX, fY; //holders for the tree's X and Y location
+    clTaskPool * p_oPool = mp_oSimManager->GetTaskPool();
+    stcMapRow stcRow; //calculates one row of cells
     int iNumXCells = mp_oMapGrid->GetNumberXCells(), iNumYCells = mp_oMapGrid->GetNumberYCells(),
-        iX, iY, i, j; //loop counters
-
-    for ( iX = 0; iX < iNumXCells; iX++ )
-    {
-      for ( iY = 0; iY < iNumYCells; iY++ )
-      {
-
-        //First find the point at which to calculate gli - center of the grid
-        //cell - place in fX and fY
-        mp_oMapGrid->GetPointOfCell( iX, iY, & fX, & fY );
+        iCell, k; //loop counters
 
-        //Initialize photo array
-        for ( i = 0; i < m_iNumAltAng; i++ )
-          for ( j = 0; j < m_iNumAziAng; j++ )
-            mp_fPhoto[i] [j] = 1.0;
+    if ( p_oPool->GetNumThreads() > 1 )
+      mp_oLightOrg->CacheCrownDimensions();
+    ReserveMapPhotos( p_oPool->GetNumThreads() );
 
-        //Get a list of all trees that are within the search radius and taller than
-        //the fish-eye photo height
-        sprintf( cQuery, "%s%f%s%f%s%f%s%f", "distance=", m_fMaxSearchDistance, " FROM x=", fX, "y=", fY,
-             "::height=", m_fLightHeight );
-        p_oShaders = p_oPop->Find( cQuery );
+    //Calculate each row of cells
+    stcRow.p_oMap = this;
+    stcRow.p_oPlot = mp_oSimManager->GetPlotObject();
+    stcRow.p_oPop = p_oPop;
+    p_oPool->ParallelFor( 0, iNumXCells, stcRow );
 
-        p_oNeighbor = p_oShaders->NextTree();
-        while ( p_oNeighbor != NULL )
-        {
+    //Assign GLI to the grid
+    for ( iCell = 0; iCell < iNumXCells * iNumYCells; iCell++ )
+      for ( k = 0; k < m_iNumHeights; k++ )
+        mp_oMapGrid->SetValueOfCell( iCell / iNumYCells, iCell % iNumYCells,
+            mp_iGridGliCodes[k], mp_fCellGli[iCell * m_iNumHeights + k] );
 
-          //Skip seedlings, which don't shade, and the target tree if returned
-          if ( clTreePopulation::seedling != p_oNeighbor->GetType() )
-
-               //Add the effect of the neighbor to the simulated fisheye photo
-               AddTreeToGliFishEye( fX, fY, m_fLightHeight, p_oNeighbor, p_oPlot, p_oPop, p_oAllom );
-
-          p_oNeighbor = p_oShaders->NextTree();
-        } //end of while (neighbor != NULL)
-
-        //Calculate GLI
-        fGli = 0.0;
-        for ( i = 0; i < m_iNumAltAng; i++ )
-          for ( j = 0; j < m_iNumAziAng; j++ )
-            fGli += ( mp_fPhoto[i] [j] * mp_fBrightness[i] [j] );
-        fGli *= 100;
-
-        //Assign GLI to the grid
-        mp_oMapGrid->SetValueAtPoint( fX, fY, m_iGridGliCode, fGli );
-      }
-    }
     //Call the base class function - if this is the hooked clLightBase object,
     //light assignments proceed normally
     clLightBase::Action();
@@ -359,4 +486,3 @@ void clGLIMap::Action()
     throw( stcErr );
   }
 }
-
@@ -20,6 +20,13 @@ class clTreePopulation;
 * trees and calculates a GLI for every grid cell no matter what.)  This
 * behavior does not need to be applied to any trees.
 *
+* The parameter file may give "li_mapLightHeight" more than once to map
+* several heights. All heights are done in one neighbor search per cell: the
+* search uses the lowest height's distance, and each neighbor is drawn into
+* the photo of each height it would have been found for on its own. The first
+* height's GLI goes in the grid's "GLI" data member, and the others' in
+* "GLI 2", "GLI 3", and so on, in parameter file order.
+*
 * Nothing else is done with the GLI values.  This is an analysis behavior that
 * prepares some calculations; the user can output the GLI map grid and then
 * use the values however they see fit.
@@ -43,6 +50,10 @@ class clTreePopulation;
  * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
  * <br>May 14, 2015 - Made it so multiple copies of this behavior will each
  * have their own grid map (LEM)
+ * <br>October 17, 2026 - Grid cells are calculated in parallel where
+ * available (agent)
+ * <br>October 17, 2026 - Rows of grid cells are run through the task pool;
+ * several map heights can be done in one neighbor search (agent)
 */
 class clGLIMap : public clGLIBase {
 
@@ -57,7 +68,10 @@ class clGLIMap : public clGLIBase {
   */
   clGLIMap(clSimManager *p_oSimManager);
 
- //~clGLIMap(); //use default destructor
+  /**
+  * Destructor.
+  */
+  ~clGLIMap();
 
   /**
   * Does setup for this object.  Calls the following functions:
@@ -76,7 +90,10 @@ class clGLIMap : public clGLIBase {
 
   /**
   * Creates the GLI map.  Each cell in the "GLI Map" grid, below, gets its GLI
-  * calculated at the height value in m_fLightHeight in the center of the cell.
+  * calculated at each height in mp_fLightHeights in the center of the cell.
+  * Each row of cells (one X cell) is a task for the sim manager's task pool.
+  * Each thread draws into its own fisheye photos, and the values are put in
+  * the grid afterwards.
   */
   void Action();
 
@@ -90,33 +107,104 @@ class clGLIMap : public clGLIBase {
 
   /**
    * Gets the height above the ground, in m, at which the quadrat light values
-   * are calculated.
+   * are calculated. If there are several, this is the first.
    * @return Light height.
    */
   float GetLightHeight() {return m_fLightHeight;};
 
   /**
-   * Gets the maximum search distance for shading neighbors.
+   * Gets the maximum search distance for shading neighbors. If there are
+   * several heights, this is for the first.
    * @return Maximum search distance for shading neighbors.
    */
   float GetMaxSearchDistance() {return m_fMaxSearchDistance;};
 
+  /**
+   * Gets the number of heights mapped.
+   * @return Number of heights.
+   */
+  int GetNumHeights() {return m_iNumHeights;};
+
  protected:
 
   /**
   * Grid object which holds the GLI values.  The name of the grid is "GLI Map X",
-  * where X is the behavior order number. There is one float data member ("GLI")
-  * for holding GLI as a value from 0 to 100.  Grid data in the parameter file
-  * can only set cell resolution; any map values will be ignored.
+  * where X is the behavior order number. There is one float data member for
+  * each height for holding GLI as a value from 0 to 100: "GLI" for the first,
+  * then "GLI 2", and so on.  Grid data in the parameter file can only set cell
+  * resolution; any map values will be ignored.
   */
   clGrid *mp_oMapGrid;
 
   double m_fLightHeight;  /**<The height above the ground, in m, at which the
-                        quadrat light values are calculated.*/
+                        quadrat light values are calculated. The first of
+                        mp_fLightHeights.*/
   float m_fMaxSearchDistance; /**<Maximum search distance for shading
-                                 neighbors.*/
+                                 neighbors. The first of
+                                 mp_fMaxSearchDistances.*/
   short int m_iGridGliCode;/**<Return code for the "GLI Map" grid to get and set
-                        GLI in the cells.*/
+                        GLI in the cells. The first of mp_iGridGliCodes.*/
+  float *mp_fCellGli; /**<GLI calculated for each grid cell and height, before
+                        it is put in the grid. Array size is number of X cells
+                        times number of Y cells times m_iNumHeights, indexed by
+                        ((X cell * number of Y cells) + Y cell) * m_iNumHeights
+                        + height.*/
+
+  float *mp_fLightHeights; /**<Heights to map, in m. Array size is
+                        m_iNumHeights.*/
+  float *mp_fMaxSearchDistances; /**<Maximum search distance for shading
+                        neighbors at each height. Array size is
+                        m_iNumHeights.*/
+  short int *mp_iGridGliCodes; /**<"GLI Map" grid data member code for each
+                        height. Array size is m_iNumHeights.*/
+  int m_iNumHeights; /**<Number of heights mapped.*/
+
+  /**Fisheye photos for each thread and height, drawn into during Action().
+   * Array size is m_iNumPhotoThreads * m_iNumHeights, indexed by (thread *
+   * m_iNumHeights) + height; each is sized like mp_fPhoto.*/
+  float ***mp_fMapPhotos;
+  /**Number of threads mp_fMapPhotos has photos for.*/
+  int m_iNumPhotoThreads;
+
+  /**
+  * Draws each shading neighbor of a cell center into the photo of each
+  * height it shades. This is handed to clTreePopulation::ForEachNeighbor()
+  * with the lowest height's search; a neighbor is drawn for a height only if
+  * it is taller and within that height's search distance, which gives the
+  * same photo as searching for that height by itself.
+  */
+  struct stcMapShaders {
+    clGLIMap *p_oMap; /**<Map behavior*/
+    clPlot *p_oPlot; /**<Plot object*/
+    clTreePopulation *p_oPop; /**<Tree population*/
+    clAllometry *p_oAllom; /**<Allometry object*/
+    float ***p_fPhotos; /**<One photo per height*/
+    float fX; /**<X coordinate of the cell center*/
+    float fY; /**<Y coordinate of the cell center*/
+
+    /**
+    * Adds one neighbor to the photos.
+    * @param p_oNeighbor Neighbor.
+    * @param fDistanceSq Squared distance to neighbor.
+    */
+    void operator()(clTree *p_oNeighbor, float fDistanceSq);
+  };
+
+  /**
+  * Calculates GLI for one row of map cells. This is handed to
+  * clTaskPool::ParallelFor().
+  */
+  struct stcMapRow {
+    clGLIMap *p_oMap; /**<Map behavior*/
+    clPlot *p_oPlot; /**<Plot object*/
+    clTreePopulation *p_oPop; /**<Tree population*/
+
+    /**
+    * Calculates each cell in a row.
+    * @param iX X cell number of the row.
+    */
+    void operator()(int iX);
+  };
 
   /**
   * Reads in needed parameter file data.  First this looks for the "gliMap" tag
@@ -132,7 +220,7 @@ class clGLIMap : public clGLIBase {
   * <li>The tag "gliMap" or its required data is not present</li>
   * <li>Number of azimuth sky divisions is less than or equal to 0</li>
   * <li>Number of altitude sky divisions is less than or equal to 0</li>
-  * <li>Height of GLI point is less than 0</li>
+  * <li>Height of any GLI point is less than 0</li>
   * </ul>
   */
   void ReadParameterFileData(xercesc::DOMDocument *p_oDoc);
@@ -147,7 +235,7 @@ class clGLIMap : public clGLIBase {
   /**
   * Performs setup calculations.  This calculates the values for
   * m_fAziChunkConverter, m_fRcpTanMinAng, mp_fAziSlope, and
-  * m_fMaxSearchDistance.
+  * mp_fMaxSearchDistances.
   */
   void DoSetupCalculations();
 
@@ -157,6 +245,13 @@ class clGLIMap : public clGLIBase {
   */
   void SetUpGrid();
 
+  /**
+  * Makes sure mp_fMapPhotos has photos for a number of threads. Photos
+  * already made are kept.
+  * @param iNumThreads Number of threads.
+  */
+  void ReserveMapPhotos(int iNumThreads);
+
 };
 //---------------------------------------------------------------------------
 #endif // GLIMap_H
@@ -354,7 +354,7 @@ void clGLIPoints::Action()
         if ( clTreePopulation::seedling != p_oNeighbor->GetType() )
 
              //Add the effect of the neighbor to the simulated fisheye photo
-               AddTreeToGliFishEye( mp_pointsList[iPoint].fX, mp_pointsList[iPoint].fY, mp_pointsList[iPoint].fHeight, p_oNeighbor, p_oPlot, p_oPop, p_oAllom );
+               AddTreeToGliFishEye( mp_pointsList[iPoint].fX, mp_pointsList[iPoint].fY, mp_pointsList[iPoint].fHeight, p_oNeighbor, p_oPlot, p_oPop, p_oAllom, mp_fPhoto );
 
         p_oNeighbor = p_oShaders->NextTree();
       } //end of while (neighbor != NULL)
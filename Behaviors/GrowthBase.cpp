@@ -20,6 +20,9 @@ clGrowthBase::clGrowthBase(clSimManager *p_oSimManager) :
     //Default the "go last" flag to false
     m_bGoLast = false;
 
+    //Shells must opt in to parallel calculation
+    m_bThreadSafe = false;
+
     //Now - see if the growth org object is NULL.  If it is, create it and pass
     //a self pointer so this object will be hooked
     if (mp_oGrowthOrg == NULL)
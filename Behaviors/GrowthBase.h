@@ -69,6 +69,7 @@ class clAllometry;
 * <br>May 21, 2004 - Added support for separate diameter / height
 * increments (LEM)
 * <br>February 24, 2005 - Added new data member "Growth" to replace "lgm" (LEM)
+* <br>October 17, 2026 - Added m_bThreadSafe (agent)
 */
 
 class clGrowthBase : virtual public clBehaviorBase {
@@ -221,6 +222,16 @@ class clGrowthBase : virtual public clBehaviorBase {
   * This defaults to false.*/
   bool m_bGoLast;
 
+  /**Whether or not this behavior's CalcDiameterGrowthValue(),
+  * CalcHeightGrowthValue(), and GetGrowthMemberValue() can be called for many
+  * trees at once from different threads.  To set this to true, those functions
+  * must read nothing but the tree passed, the behavior's own parameters, and
+  * values calculated in PreGrowthCalcs(); they must not write to any tree or
+  * member variable, and must not draw random numbers.  clGrowthOrg will then
+  * calculate growth for this behavior's trees ahead of applying it, and may do
+  * so in parallel.  This defaults to false.*/
+  bool m_bThreadSafe;
+
   /**
   * Triggers all growth setup if an object is hooked.  This will be the same
   * for all descendent classes.  If a particular object is hooked, it calls
@@ -6,6 +6,7 @@
 #include "Allometry.h"
 #include <stdio.h>
 #include <fstream>
+#include "TaskPool.h"
 #include <sstream>
 
 //////////////////////////////////////////////////////////////////////////////
@@ -25,11 +26,20 @@ clGrowthOrg::clGrowthOrg( clGrowthBase * p_oHookedShell )
     mp_iHeightCodes = NULL;
     mp_fMaxTreeHeight = NULL;
     mp_oShellList = NULL;
-
+    mp_bPrecalculate = NULL;
+    mp_oBufferTrees = NULL;
+    mp_fBufferDiam = NULL;
+    mp_fBufferHeight = NULL;
+    mp_fBufferGrowth = NULL;
+    mp_cBufferStatus = NULL;
+
+    m_iBufferSize = 0;
+    m_bTwoPhase = false;
     m_iTotalSpecies = 0;
     m_iTotalTypes = 0;
     m_iNumShells = 0;
     mp_oPop = NULL;
+    mp_oTaskPool = NULL;
 
     //Make sure the hooked shell object pointer isn't NULL - if it is throw
     //error
@@ -94,6 +104,10 @@ clGrowthOrg::~clGrowthOrg()
     for ( i = 0; i < m_iTotalSpecies; i++ )
       delete[] mp_iHeightCodes[i];
 
+  if ( mp_bPrecalculate )
+    for ( i = 0; i < m_iTotalSpecies; i++ )
+      delete[] mp_bPrecalculate[i];
+
   delete[] mp_fMaxTreeHeight; mp_fMaxTreeHeight = NULL;
 
   delete[] mp_oDiameterGrowthTable; mp_oDiameterGrowthTable = NULL;
@@ -103,6 +117,12 @@ clGrowthOrg::~clGrowthOrg()
   delete[] mp_iDiamCodes; mp_iDiamCodes = NULL;
   delete[] mp_iHeightCodes; mp_iHeightCodes = NULL;
   delete[] mp_oShellList; mp_oShellList = NULL;
+  delete[] mp_bPrecalculate; mp_bPrecalculate = NULL;
+  delete[] mp_oBufferTrees; mp_oBufferTrees = NULL;
+  delete[] mp_fBufferDiam; mp_fBufferDiam = NULL;
+  delete[] mp_fBufferHeight; mp_fBufferHeight = NULL;
+  delete[] mp_fBufferGrowth; mp_fBufferGrowth = NULL;
+  delete[] mp_cBufferStatus; mp_cBufferStatus = NULL;
 }
 
 
@@ -126,6 +146,57 @@ void clGrowthOrg::GetMaxTreeHeights()
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// GetPrecalculateFlags
+/////////////////////////////////////////////////////////////////////////////*/
+void clGrowthOrg::GetPrecalculateFlags()
+{
+  clGrowthBase *p_oDiam, *p_oHeight;
+  int i, j;
+
+  m_bTwoPhase = false;
+  mp_bPrecalculate = new bool*[m_iTotalSpecies];
+  for ( i = 0; i < m_iTotalSpecies; i++ )
+  {
+    mp_bPrecalculate[i] = new bool[m_iTotalTypes];
+    for ( j = 0; j < m_iTotalTypes; j++ )
+    {
+      p_oDiam = mp_oDiameterGrowthTable[i][j];
+      p_oHeight = mp_oHeightGrowthTable[i][j];
+      mp_bPrecalculate[i][j] = NULL != p_oDiam && p_oDiam->m_bThreadSafe &&
+          (clGrowthBase::diameter_only != p_oDiam->GetGrowthMethod() ||
+           (NULL != p_oHeight && p_oHeight->m_bThreadSafe));
+      if (mp_bPrecalculate[i][j]) m_bTwoPhase = true;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ReserveBuffers
+/////////////////////////////////////////////////////////////////////////////*/
+void clGrowthOrg::ReserveBuffers(int iNumTrees)
+{
+  clTree **p_oOldTrees = mp_oBufferTrees;
+  int i;
+
+  if (iNumTrees <= m_iBufferSize) return;
+
+  delete[] mp_fBufferDiam;
+  delete[] mp_fBufferHeight;
+  delete[] mp_fBufferGrowth;
+  delete[] mp_cBufferStatus;
+
+  //Leave some room so a growing population doesn't reallocate every time
+  m_iBufferSize = iNumTrees + iNumTrees / 4 + 1;
+  mp_oBufferTrees = new clTree*[m_iBufferSize];
+  for (i = 0; i < iNumTrees - 1; i++) mp_oBufferTrees[i] = p_oOldTrees[i];
+  delete[] p_oOldTrees;
+  mp_fBufferDiam = new float[m_iBufferSize];
+  mp_fBufferHeight = new float[m_iBufferSize];
+  mp_fBufferGrowth = new float[m_iBufferSize];
+  mp_cBufferStatus = new char[m_iBufferSize];
+}
+
 
 //////////////////////////////////////////////////////////////////////////////
 // DoSetup
@@ -149,6 +220,7 @@ void clGrowthOrg::DoSetup( clSimManager * p_oSimManager, xercesc::DOMDocument *
     //Get the tree population object, and from it the numbers of species and types
     p_oTempPop = p_oSimManager->GetPopulationObject( "treepopulation" );
     mp_oPop = ( clTreePopulation * ) p_oTempPop;
+    mp_oTaskPool = p_oSimManager->GetTaskPool();
 
     //Get the return codes for the "Light" data member variable for each
     //species/type combo that has a shell pointer in the functions table
@@ -165,6 +237,9 @@ void clGrowthOrg::DoSetup( clSimManager * p_oSimManager, xercesc::DOMDocument *
     //Get the asymptotic tree height limits
     GetMaxTreeHeights();
 
+    //Find out which trees can have growth calculated ahead of time
+    GetPrecalculateFlags();
+
   }
   catch ( modelErr & err )
   {
@@ -518,6 +593,21 @@ void clGrowthOrg::GetHeightVariableCodes()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////
+// stcCalcGrowth::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clGrowthOrg::stcCalcGrowth::operator()(int i)
+{
+  clTree *p_oTree = p_oOrg->mp_oBufferTrees[i];
+
+  p_oOrg->mp_cBufferStatus[i] = 0;
+  if (!p_oOrg->mp_bPrecalculate[p_oTree->GetSpecies()][p_oTree->GetType()])
+    p_oOrg->mp_cBufferStatus[i] = 2;
+  else if (p_oOrg->CalcTreeGrowth(p_oTree, p_oOrg->mp_fBufferDiam[i],
+      p_oOrg->mp_fBufferHeight[i], p_oOrg->mp_fBufferGrowth[i]))
+    p_oOrg->mp_cBufferStatus[i] = 1;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // DoGrowthAssignments()
 //////////////////////////////////////////////////////////////////////////////
@@ -529,96 +619,66 @@ void clGrowthOrg::DoGrowthAssignments()
     clTree * p_oTree; //for working with a single tree
     float fDiamGrowthVal = 0, //diameter growth value to be assigned to the tree
          fHeightGrowthVal = 0, //height growth value to be assigned to the tree
-         fOldDiam = 0, //old diameter value to be changed
-         fOldHeight = 0, //old height value to be changed
          fGrowthMemberVal = 0; //new value going into "Growth" data member
-    int iDead;
-    short int iSp, //species of a given tree
-               iDeadCode; //dead code for a tree
-    clGrowthBase::growthType iGrowthType; //type of growth behavior
+    stcCalcGrowth stcCalc; //for calculating growth ahead of time
+    int iNumTrees, i;
 
     //Call the PreGrowthCalcs() function for all shells
-    for (int i = 0; i < m_iNumShells; i++) {
+    for (i = 0; i < m_iNumShells; i++) {
       mp_oShellList[i]->PreGrowthCalcs( mp_oPop );
     }
 
     //Ask the tree population to find all trees
     p_oAllTrees = mp_oPop->Find( "all" );
 
-    //Go through the trees one at a time
-    p_oTree = p_oAllTrees->NextTree();
-    while ( p_oTree )
+    if (!m_bTwoPhase || mp_oTaskPool->GetNumThreads() < 2)
     {
-      //Cache tree species but not tree type - it can change
-      iSp = p_oTree->GetSpecies();
-
-      //Check to see if this species/type combo has a diameter growth
-      //shell to calculate its value - if it does, get it
-      if ( NULL != mp_oDiameterGrowthTable[iSp] [p_oTree->GetType()] )
+      //Go through the trees one at a time
+      p_oTree = p_oAllTrees->NextTree();
+      while ( p_oTree )
       {
+        if (CalcTreeGrowth(p_oTree, fDiamGrowthVal, fHeightGrowthVal,
+            fGrowthMemberVal))
+          ApplyTreeGrowth(p_oTree, fDiamGrowthVal, fHeightGrowthVal,
+              fGrowthMemberVal);
+        p_oTree = p_oAllTrees->NextTree();
+      }
+      return;
+    }
 
-        //Make sure this tree is not dead from a previous disturbance
-        iDeadCode = mp_oPop->GetIntDataCode("dead", iSp, p_oTree->GetType());
-        if (-1 != iDeadCode) {
-          p_oTree->GetValue(iDeadCode, &iDead);
-          if (iDead > notdead) goto nextTree;
-        }
-
-        iGrowthType = mp_oDiameterGrowthTable[iSp] [p_oTree->GetType()]->GetGrowthMethod();
-
-        //If we're using both diam and height growth, and diam growth wants to
-        //go last, and height doesn't object, call height first
-        if (clGrowthBase::diameter_only == iGrowthType &&
-            mp_oDiameterGrowthTable[iSp][p_oTree->GetType()]->m_bGoLast &&
-            !mp_oHeightGrowthTable[iSp][p_oTree->GetType()]->m_bGoLast) {
-
-          fHeightGrowthVal = mp_oHeightGrowthTable[iSp] [p_oTree->GetType()]->CalcHeightGrowthValue( p_oTree, mp_oPop, 0 );
-          fDiamGrowthVal = mp_oDiameterGrowthTable[iSp] [p_oTree->GetType()]->CalcDiameterGrowthValue( p_oTree, mp_oPop, fHeightGrowthVal );
-        } else {
-
-          //Either growth only, or growth goes first
-          fDiamGrowthVal = mp_oDiameterGrowthTable[iSp] [p_oTree->GetType()]->CalcDiameterGrowthValue( p_oTree, mp_oPop, 0 );
-
-          //If appropriate, get the height increment as well
-          if ( clGrowthBase::diameter_only == iGrowthType )
-          {
-            fHeightGrowthVal = mp_oHeightGrowthTable[iSp] [p_oTree->GetType()]->CalcHeightGrowthValue( p_oTree, mp_oPop, fDiamGrowthVal );
-          }
-        }
-
-        //Get the new "Growth" value, if appropriate
-        fGrowthMemberVal = mp_oDiameterGrowthTable[iSp] [p_oTree->GetType()]->GetGrowthMemberValue(p_oTree, fDiamGrowthVal);
-
-        //Add the values to the tree.  Delay tree population updates until all trees are done
-        p_oTree->GetValue( mp_iDiamCodes[iSp] [p_oTree->GetType()], & fOldDiam );
-        fDiamGrowthVal += fOldDiam;
-
-        if ( clGrowthBase::diameter_auto == iGrowthType )
-        {
-          //Allow the height to update automatically
-          p_oTree->SetValue( mp_iDiamCodes[iSp] [p_oTree->GetType()], fDiamGrowthVal, false, true );
-        }
-        else if ( clGrowthBase::diameter_only == iGrowthType )
-        {
-
-          //Do not allow the height to update automatically
-          p_oTree->SetValue( mp_iDiamCodes[iSp] [p_oTree->GetType()], fDiamGrowthVal, false, false );
+    //Collect the trees
+    iNumTrees = 0;
+    p_oTree = p_oAllTrees->NextTree();
+    while ( p_oTree )
+    {
+      ReserveBuffers(iNumTrees + 1);
+      mp_oBufferTrees[iNumTrees] = p_oTree;
+      iNumTrees++;
+      p_oTree = p_oAllTrees->NextTree();
+    }
 
-          //Increment the height as well
-          p_oTree->GetValue( mp_iHeightCodes[iSp] [p_oTree->GetType()], & fOldHeight );
-          fHeightGrowthVal += fOldHeight;
-          if (fHeightGrowthVal > mp_fMaxTreeHeight[iSp]) fHeightGrowthVal =  mp_fMaxTreeHeight[iSp];
-          p_oTree->SetValue( mp_iHeightCodes[iSp] [p_oTree->GetType()], fHeightGrowthVal, false, false );
-        }
+    //Calculate growth for every tree whose shells allow it.  Nothing is
+    //applied yet, so every tree sees the pre-growth state.
+    stcCalc.p_oOrg = this;
+    mp_oTaskPool->ParallelFor(0, iNumTrees, stcCalc, 256);
 
-        if (mp_iGrowthCodes[iSp][p_oTree->GetType()] > -1) {
-          p_oTree->SetValue(mp_iGrowthCodes[iSp][p_oTree->GetType()], fGrowthMemberVal);
-        }
+    //Apply growth in tree order, calculating it now for any trees whose
+    //shells couldn't do it ahead of time
+    for (i = 0; i < iNumTrees; i++)
+    {
+      if (2 == mp_cBufferStatus[i])
+      {
+        if (CalcTreeGrowth(mp_oBufferTrees[i], fDiamGrowthVal, fHeightGrowthVal,
+            fGrowthMemberVal))
+          ApplyTreeGrowth(mp_oBufferTrees[i], fDiamGrowthVal, fHeightGrowthVal,
+              fGrowthMemberVal);
       }
-
-      nextTree:
-      p_oTree = p_oAllTrees->NextTree();
-    } //end of while (p_oTree)
+      else if (1 == mp_cBufferStatus[i])
+      {
+        ApplyTreeGrowth(mp_oBufferTrees[i], mp_fBufferDiam[i],
+            mp_fBufferHeight[i], mp_fBufferGrowth[i]);
+      }
+    }
   }
   catch ( modelErr & err )
   {
@@ -637,6 +697,96 @@ void clGrowthOrg::DoGrowthAssignments()
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// CalcTreeGrowth()
+//////////////////////////////////////////////////////////////////////////////
+bool clGrowthOrg::CalcTreeGrowth(clTree *p_oTree, float &fDiamGrowth,
+    float &fHeightGrowth, float &fGrowthMember)
+{
+  clGrowthBase *p_oDiamShell, *p_oHeightShell;
+  int iDead;
+  short int iSp = p_oTree->GetSpecies(), iTp = p_oTree->GetType(),
+            iDeadCode; //dead code for a tree
+
+  //Check to see if this species/type combo has a diameter growth
+  //shell to calculate its value
+  p_oDiamShell = mp_oDiameterGrowthTable[iSp][iTp];
+  if ( NULL == p_oDiamShell ) return false;
+
+  //Make sure this tree is not dead from a previous disturbance
+  iDeadCode = mp_oPop->GetDeadCodes()[iSp][iTp];
+  if (-1 != iDeadCode) {
+    p_oTree->GetValue(iDeadCode, &iDead);
+    if (iDead > notdead) return false;
+  }
+
+  fHeightGrowth = 0;
+  p_oHeightShell = mp_oHeightGrowthTable[iSp][iTp];
+
+  //If we're using both diam and height growth, and diam growth wants to
+  //go last, and height doesn't object, call height first
+  if (clGrowthBase::diameter_only == p_oDiamShell->GetGrowthMethod() &&
+      p_oDiamShell->m_bGoLast && !p_oHeightShell->m_bGoLast) {
+
+    fHeightGrowth = p_oHeightShell->CalcHeightGrowthValue( p_oTree, mp_oPop, 0 );
+    fDiamGrowth = p_oDiamShell->CalcDiameterGrowthValue( p_oTree, mp_oPop, fHeightGrowth );
+  } else {
+
+    //Either growth only, or growth goes first
+    fDiamGrowth = p_oDiamShell->CalcDiameterGrowthValue( p_oTree, mp_oPop, 0 );
+
+    //If appropriate, get the height increment as well
+    if ( clGrowthBase::diameter_only == p_oDiamShell->GetGrowthMethod() )
+    {
+      fHeightGrowth = p_oHeightShell->CalcHeightGrowthValue( p_oTree, mp_oPop, fDiamGrowth );
+    }
+  }
+
+  //Get the new "Growth" value
+  fGrowthMember = p_oDiamShell->GetGrowthMemberValue(p_oTree, fDiamGrowth);
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ApplyTreeGrowth()
+//////////////////////////////////////////////////////////////////////////////
+void clGrowthOrg::ApplyTreeGrowth(clTree *p_oTree, float fDiamGrowth,
+    float fHeightGrowth, float fGrowthMember)
+{
+  float fOldDiam = 0, //old diameter value to be changed
+        fOldHeight = 0; //old height value to be changed
+  //Cache tree species but not tree type - it can change
+  short int iSp = p_oTree->GetSpecies();
+  clGrowthBase::growthType iGrowthType =
+      mp_oDiameterGrowthTable[iSp] [p_oTree->GetType()]->GetGrowthMethod();
+
+  //Add the values to the tree.  Delay tree population updates until all trees are done
+  p_oTree->GetValue( mp_iDiamCodes[iSp] [p_oTree->GetType()], & fOldDiam );
+  fDiamGrowth += fOldDiam;
+
+  if ( clGrowthBase::diameter_auto == iGrowthType )
+  {
+    //Allow the height to update automatically
+    p_oTree->SetValue( mp_iDiamCodes[iSp] [p_oTree->GetType()], fDiamGrowth, false, true );
+  }
+  else if ( clGrowthBase::diameter_only == iGrowthType )
+  {
+
+    //Do not allow the height to update automatically
+    p_oTree->SetValue( mp_iDiamCodes[iSp] [p_oTree->GetType()], fDiamGrowth, false, false );
+
+    //Increment the height as well
+    p_oTree->GetValue( mp_iHeightCodes[iSp] [p_oTree->GetType()], & fOldHeight );
+    fHeightGrowth += fOldHeight;
+    if (fHeightGrowth > mp_fMaxTreeHeight[iSp]) fHeightGrowth =  mp_fMaxTreeHeight[iSp];
+    p_oTree->SetValue( mp_iHeightCodes[iSp] [p_oTree->GetType()], fHeightGrowth, false, false );
+  }
+
+  if (mp_iGrowthCodes[iSp][p_oTree->GetType()] > -1) {
+    p_oTree->SetValue(mp_iGrowthCodes[iSp][p_oTree->GetType()], fGrowthMember);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // DoTreeDataMemberRegistrations()
 //////////////////////////////////////////////////////////////////////////////
@@ -9,7 +9,9 @@
 class clGrowthBase;
 class clSimManager;
 class clTreePopulation;
+class clTaskPool;
 class clNCIGrowth;
+class clTree;
 
 /**
 * Class for organizing growth behaviors.
@@ -72,6 +74,9 @@ class clNCIGrowth;
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Growth for thread-safe shells is calculated ahead of
+* being applied, in parallel where available (agent)
+* <br>October 17, 2026 - Two-phase growth runs on the task pool (agent)
 */
 class clGrowthOrg {
   public:
@@ -128,6 +133,17 @@ class clGrowthOrg {
   *
   * In all cases, height is limited to the values in mp_fMaxTreeHeight, which
   * are the maximum tree height for each species minus 0.001.
+  *
+  * If any species/type combo's shells are all thread-safe (see
+  * clGrowthBase::m_bThreadSafe), this happens in two phases.  First, the
+  * trees are collected, and growth is calculated for every tree whose shells
+  * are thread-safe and stored in a side buffer.  These calculations are
+  * spread across the task pool's threads (see clTaskPool).  Then the trees are applied
+  * one at a time in their original order; trees whose shells aren't
+  * thread-safe have their growth calculated at that point, exactly as they
+  * would have been otherwise.  Since thread-safe shells only read the tree
+  * they are given, which hasn't been changed when its growth is calculated,
+  * the results are identical to calculating everything one tree at a time.
   */
   void DoGrowthAssignments();
 
@@ -215,7 +231,23 @@ class clGrowthOrg {
      clTreePopulation *p_oPop);
 
   protected:
+
+  /**
+  * Calculates growth ahead of time for one tree in mp_oBufferTrees, if its
+  * shells are all thread-safe, and sets its mp_cBufferStatus. This is handed
+  * to clTaskPool::ParallelFor().
+  */
+  struct stcCalcGrowth {
+    clGrowthOrg *p_oOrg; /**<Growth org object doing the calculating*/
+    /**
+    * Calculates growth for one tree.
+    * @param i Tree's index in mp_oBufferTrees.
+    */
+    void operator()(int i);
+  };
+
   clTreePopulation *mp_oPop; /**<A pointer to the tree population object*/
+  clTaskPool *mp_oTaskPool; /**<Task pool for two-phase growth*/
 
   clGrowthBase ***mp_oDiameterGrowthTable; /**<Array of growth shell objects
   which either update diameter only or update diameter when height is
@@ -269,6 +301,32 @@ class clGrowthOrg {
   */
   short int **mp_iHeightCodes;
 
+  /**
+  * Whether or not each species/type combo can have its growth calculated ahead
+  * of time: it has growth, and all of its shells are thread-safe.  Array size
+  * is # species by # types.
+  */
+  bool **mp_bPrecalculate;
+
+  /**Trees collected for two-phase growth.  Array size is
+  * m_iBufferSize.*/
+  clTree **mp_oBufferTrees;
+  /**Diameter growth calculated for each tree in mp_oBufferTrees.*/
+  float *mp_fBufferDiam;
+  /**Height growth calculated for each tree in mp_oBufferTrees.*/
+  float *mp_fBufferHeight;
+  /**"Growth" member value calculated for each tree in mp_oBufferTrees.*/
+  float *mp_fBufferGrowth;
+  /**Status of each tree in mp_oBufferTrees: 0 if it gets no growth, 1 if its
+  * growth has been calculated, 2 if its growth must still be calculated.*/
+  char *mp_cBufferStatus;
+  /**Size of the two-phase growth buffers.*/
+  int m_iBufferSize;
+
+  /**Whether or not any species/type combo has true in mp_bPrecalculate.  If
+  * not, growth is done one tree at a time.*/
+  bool m_bTwoPhase;
+
 
   /**
   * Declares and populates the growth object tables.  First, it declares
@@ -328,6 +386,43 @@ class clGrowthOrg {
   * to tree height.
   */
   void GetMaxTreeHeights();
+
+  /**
+  * Populates mp_bPrecalculate and m_bTwoPhase from the growth tables.
+  */
+  void GetPrecalculateFlags();
+
+  /**
+  * Calculates growth for one tree without changing it.
+  * @param p_oTree Tree for which to calculate growth.
+  * @param fDiamGrowth Set to the diameter growth, in cm.
+  * @param fHeightGrowth Set to the height growth, in m, if there is a separate
+  * height shell.
+  * @param fGrowthMember Set to the value for the "Growth" data member.
+  * @return True if the tree gets growth; false if it has no growth shell or is
+  * already dead.
+  */
+  bool CalcTreeGrowth(clTree *p_oTree, float &fDiamGrowth,
+      float &fHeightGrowth, float &fGrowthMember);
+
+  /**
+  * Applies calculated growth to a tree.
+  * @param p_oTree Tree to which to apply growth.
+  * @param fDiamGrowth Diameter growth, in cm.
+  * @param fHeightGrowth Height growth, in m.  Ignored unless the tree's
+  * diameter shell is diameter_only.
+  * @param fGrowthMember Value for the "Growth" data member.
+  */
+  void ApplyTreeGrowth(clTree *p_oTree, float fDiamGrowth, float fHeightGrowth,
+      float fGrowthMember);
+
+  /**
+  * Makes sure the two-phase growth buffers can hold a certain number of
+  * trees.  This is called as trees are collected, so the trees already in
+  * mp_oBufferTrees are kept.
+  * @param iNumTrees Number of trees; all but the last are already collected.
+  */
+  void ReserveBuffers(int iNumTrees);
 };
 //---------------------------------------------------------------------------
 #endif
@@ -6,8 +6,23 @@
 #include "TreePopulation.h"
 #include "Allometry.h"
 #include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <string.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 clLightOrg *clLightBase::mp_oLightOrg = NULL;
+clLightBase::stcBrightnessTable *clLightBase::mp_oBrightnessCache = NULL;
+
+/**Marks the start of a brightness cache file*/
+static const char BRIGHTNESS_CACHE_ID[8] = {'S','R','T','S','K','Y','0','1'};
+
+/**Frees the sky brightness cache when the program ends*/
+static struct stcBrightnessCacheCleanup {
+  ~stcBrightnessCacheCleanup() {clLightBase::ClearBrightnessCache();};
+} stcCleanupBrightness;
 //---------------------------------------------------------------------------
 ///////////////////////////////////////////////////////////////////////////////
 // Constructor
@@ -49,6 +64,11 @@ clLightBase::clLightBase( clSimManager * p_oSimManager ) : clWorkerBase( p_oSimM
 
     mp_fBrightness = NULL;
     mp_fPhoto = NULL;
+    mp_fThreadPhoto = NULL;
+    m_iNumThreadPhotos = 0;
+
+    //Shells must opt in to parallel calculation
+    m_bThreadSafe = false;
   }
   catch ( modelErr & err )
   {
@@ -97,6 +117,16 @@ clLightBase::~clLightBase()
   }
   delete[] mp_fBrightness;
   delete[] mp_fPhoto;
+
+  for ( int i = 1; i < m_iNumThreadPhotos; i++ )
+  {
+    for ( int j = 0; j < m_iNumAltAng; j++ )
+    {
+      delete[] mp_fThreadPhoto[i][j];
+    }
+    delete[] mp_fThreadPhoto[i];
+  }
+  delete[] mp_fThreadPhoto;
 }
 
 
@@ -234,6 +264,11 @@ void clLightBase::PopulateGLIBrightnessArray()
          fClearSkyTransCoef, //clear sky transmission coefficient
          fBeamFracGlobalRad, //beam fraction of global radiation
          fTotalBeam; //the sum of all beam radiation
+    stcBrightnessTable stcKey; //for finding this array in the cache
+
+    //Use the array from an earlier shell or run, if there is one
+    MakeBrightnessKey( gliBrightness, stcKey );
+    if ( GetCachedBrightness( stcKey ) ) return;
 
     //Get the plot object to query
     p_oPlot = mp_oSimManager->GetPlotObject();
@@ -395,6 +430,8 @@ void clLightBase::PopulateGLIBrightnessArray()
       delete[] p_fBrightCopy;
     }
 
+    CacheBrightness( stcKey );
+
     //Write brightness array
    /* using namespace std;
         fstream brightness("GLI Brightness array.txt", ios::trunc | ios::out); brightness << "Segment";
@@ -455,6 +492,11 @@ void clLightBase::PopulateSailLightBrightnessArray()
          fClearSkyTransCoef, //clear sky transmission coefficient
          fBeamFracGlobalRad, //beam fraction of global radiation
          fTotalBeam; //the sum of all beam radiation
+    stcBrightnessTable stcKey; //for finding this array in the cache
+
+    //Use the array from an earlier shell or run, if there is one
+    MakeBrightnessKey( sailBrightness, stcKey );
+    if ( GetCachedBrightness( stcKey ) ) return;
 
     //Get the plot object to query
     p_oPlot = mp_oSimManager->GetPlotObject();
@@ -603,6 +645,8 @@ void clLightBase::PopulateSailLightBrightnessArray()
 
     delete[] p_fDiffuseRad;
 
+    CacheBrightness( stcKey );
+
     //Write brightness array
     /*   fstream brightness("Sail Brightness array.xls", ios::trunc | ios::out); brightness << "Segment";
     for (i = 0; i < m_iNumAltAng; i++) brightness << "\t" << i; for (i = 0; i < m_iNumAziAng; i++) {
@@ -633,3 +677,263 @@ void clLightBase::PopulateSailLightBrightnessArray()
 float clLightBase::GetLightExtinctionCoefficient(clTree *p_oTree)   {
    return mp_oLightOrg->GetLightExtCoeff(p_oTree);
 }
+
+///////////////////////////////////////////////////////////////////////////////
+// ReservePhotoArrays()
+///////////////////////////////////////////////////////////////////////////////
+void clLightBase::ReservePhotoArrays( int iNumThreads )
+{
+  float ***p_fOldPhotos = mp_fThreadPhoto;
+  int i, j;
+
+  if ( iNumThreads <= m_iNumThreadPhotos ) return;
+
+  mp_fThreadPhoto = new float ** [iNumThreads];
+  mp_fThreadPhoto[0] = NULL;
+  for ( i = 1; i < m_iNumThreadPhotos; i++ )
+    mp_fThreadPhoto[i] = p_fOldPhotos[i];
+  for ( i = m_iNumThreadPhotos > 1 ? m_iNumThreadPhotos : 1; i < iNumThreads; i++ )
+  {
+    mp_fThreadPhoto[i] = new float * [m_iNumAltAng];
+    for ( j = 0; j < m_iNumAltAng; j++ )
+      mp_fThreadPhoto[i][j] = new float[m_iNumAziAng];
+  }
+  delete[] p_fOldPhotos;
+  m_iNumThreadPhotos = iNumThreads;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// GetPhotoArray()
+///////////////////////////////////////////////////////////////////////////////
+float** clLightBase::GetPhotoArray()
+{
+#ifdef _OPENMP
+  int iThread = omp_get_thread_num();
+  if ( iThread > 0 && iThread < m_iNumThreadPhotos )
+    return mp_fThreadPhoto[iThread];
+#endif
+  return mp_fPhoto;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// MakeBrightnessKey()
+///////////////////////////////////////////////////////////////////////////////
+void clLightBase::MakeBrightnessKey( int iKind, stcBrightnessTable & stcKey )
+{
+  stcKey.fLatitude = mp_oSimManager->GetPlotObject()->GetLatitude();
+  stcKey.fAzimuthOfNorth = m_fAzimuthOfNorth;
+  stcKey.fClearSkyTransCoef = mp_oLightOrg->GetClearSkyTransmissionCoefficient();
+  stcKey.fBeamFracGlobalRad = mp_oLightOrg->GetBeamFractionGlobalRadiation();
+  stcKey.iKind = iKind;
+  stcKey.iFirstJulDay = mp_oLightOrg->GetFirstDayOfGrowingSeason();
+  stcKey.iLastJulDay = mp_oLightOrg->GetLastDayOfGrowingSeason();
+  stcKey.iNumAltAng = m_iNumAltAng;
+  stcKey.iNumAziAng = m_iNumAziAng;
+  stcKey.iMinAngRow = m_iMinAngRow;
+  stcKey.p_fBrightness = NULL;
+  stcKey.p_oNext = NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// FindBrightness()
+///////////////////////////////////////////////////////////////////////////////
+clLightBase::stcBrightnessTable* clLightBase::FindBrightness(
+    stcBrightnessTable & stcKey )
+{
+  stcBrightnessTable * p_oTable = mp_oBrightnessCache;
+  while ( p_oTable )
+  {
+    if ( p_oTable->iKind == stcKey.iKind &&
+         p_oTable->fLatitude == stcKey.fLatitude &&
+         p_oTable->fAzimuthOfNorth == stcKey.fAzimuthOfNorth &&
+         p_oTable->fClearSkyTransCoef == stcKey.fClearSkyTransCoef &&
+         p_oTable->fBeamFracGlobalRad == stcKey.fBeamFracGlobalRad &&
+         p_oTable->iFirstJulDay == stcKey.iFirstJulDay &&
+         p_oTable->iLastJulDay == stcKey.iLastJulDay &&
+         p_oTable->iNumAltAng == stcKey.iNumAltAng &&
+         p_oTable->iNumAziAng == stcKey.iNumAziAng &&
+         p_oTable->iMinAngRow == stcKey.iMinAngRow )
+      return p_oTable;
+    p_oTable = p_oTable->p_oNext;
+  }
+  return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// GetCachedBrightness()
+///////////////////////////////////////////////////////////////////////////////
+bool clLightBase::GetCachedBrightness( stcBrightnessTable & stcKey )
+{
+  stcBrightnessTable * p_oTable = FindBrightness( stcKey );
+  std::string sFile;
+  int i, j;
+
+  if ( NULL == p_oTable )
+  {
+    sFile = GetBrightnessCacheFile();
+    if ( 0 == sFile.length() ) return false;
+    ReadBrightnessCacheFile( sFile );
+    p_oTable = FindBrightness( stcKey );
+    if ( NULL == p_oTable ) return false;
+  }
+
+  for ( i = 0; i < m_iNumAltAng; i++ )
+    for ( j = 0; j < m_iNumAziAng; j++ )
+      mp_fBrightness[i] [j] = p_oTable->p_fBrightness[i * m_iNumAziAng + j];
+  return true;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// CacheBrightness()
+///////////////////////////////////////////////////////////////////////////////
+void clLightBase::CacheBrightness( stcBrightnessTable & stcKey )
+{
+  stcBrightnessTable * p_oTable;
+  std::string sFile;
+  std::stringstream sTempFile;
+  int i, j;
+
+  if ( NULL != FindBrightness( stcKey ) ) return;
+
+  p_oTable = new stcBrightnessTable( stcKey );
+  p_oTable->p_fBrightness = new float[m_iNumAltAng * m_iNumAziAng];
+  for ( i = 0; i < m_iNumAltAng; i++ )
+    for ( j = 0; j < m_iNumAziAng; j++ )
+      p_oTable->p_fBrightness[i * m_iNumAziAng + j] = mp_fBrightness[i] [j];
+  p_oTable->p_oNext = mp_oBrightnessCache;
+  mp_oBrightnessCache = p_oTable;
+
+  //Batch runs share the arrays through the cache file. Pick up anything other
+  //runs have added to it since it was read, so it isn't lost on rewriting.
+  sFile = GetBrightnessCacheFile();
+  if ( 0 == sFile.length() ) return;
+  ReadBrightnessCacheFile( sFile );
+  sTempFile << sFile << "." << mp_oSimManager->GetBatchGroup() << "_"
+            << mp_oSimManager->GetBatchNumber() << ".tmp";
+  WriteBrightnessCacheFile( sFile, sTempFile.str() );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// GetBrightnessCacheFile()
+///////////////////////////////////////////////////////////////////////////////
+std::string clLightBase::GetBrightnessCacheFile()
+{
+  if ( 0 == mp_oSimManager->GetBatchNumber() ||
+       0 == mp_oSimManager->GetBatchFilename().length() )
+    return "";
+  return mp_oSimManager->GetBatchFilename() + ".skycache";
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ReadBrightnessCacheFile()
+///////////////////////////////////////////////////////////////////////////////
+void clLightBase::ReadBrightnessCacheFile( std::string sFile )
+{
+  FILE * p_oFile = fopen( sFile.c_str(), "rb" );
+  stcBrightnessTable stcKey, * p_oTable;
+  char cID[sizeof( BRIGHTNESS_CACHE_ID )];
+  float * p_fValues;
+  int iSize;
+
+  if ( NULL == p_oFile ) return;
+  if ( 1 != fread( cID, sizeof( cID ), 1, p_oFile ) ||
+       0 != memcmp( cID, BRIGHTNESS_CACHE_ID, sizeof( cID ) ) )
+  {
+    fclose( p_oFile );
+    return;
+  }
+
+  //Read arrays until the end of the file, or until something doesn't look
+  //right
+  while ( 1 == fread( & stcKey.fLatitude, sizeof( double ), 1, p_oFile ) &&
+          1 == fread( & stcKey.fAzimuthOfNorth, sizeof( double ), 1, p_oFile ) &&
+          1 == fread( & stcKey.fClearSkyTransCoef, sizeof( float ), 1, p_oFile ) &&
+          1 == fread( & stcKey.fBeamFracGlobalRad, sizeof( float ), 1, p_oFile ) &&
+          1 == fread( & stcKey.iKind, sizeof( int ), 1, p_oFile ) &&
+          1 == fread( & stcKey.iFirstJulDay, sizeof( int ), 1, p_oFile ) &&
+          1 == fread( & stcKey.iLastJulDay, sizeof( int ), 1, p_oFile ) &&
+          1 == fread( & stcKey.iNumAltAng, sizeof( int ), 1, p_oFile ) &&
+          1 == fread( & stcKey.iNumAziAng, sizeof( int ), 1, p_oFile ) &&
+          1 == fread( & stcKey.iMinAngRow, sizeof( int ), 1, p_oFile ) )
+  {
+    if ( stcKey.iNumAltAng <= 0 || stcKey.iNumAziAng <= 0 ||
+         stcKey.iNumAltAng > 10000 || stcKey.iNumAziAng > 10000 ) break;
+    iSize = stcKey.iNumAltAng * stcKey.iNumAziAng;
+    p_fValues = new float[iSize];
+    if ( ( size_t ) iSize != fread( p_fValues, sizeof( float ), iSize, p_oFile ) )
+    {
+      delete[] p_fValues;
+      break;
+    }
+    if ( NULL != FindBrightness( stcKey ) )
+    {
+      delete[] p_fValues;
+      continue;
+    }
+    p_oTable = new stcBrightnessTable( stcKey );
+    p_oTable->p_fBrightness = p_fValues;
+    p_oTable->p_oNext = mp_oBrightnessCache;
+    mp_oBrightnessCache = p_oTable;
+  }
+  fclose( p_oFile );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// WriteBrightnessCacheFile()
+///////////////////////////////////////////////////////////////////////////////
+void clLightBase::WriteBrightnessCacheFile( std::string sFile,
+    std::string sTempFile )
+{
+  FILE * p_oFile = fopen( sTempFile.c_str(), "wb" );
+  stcBrightnessTable * p_oTable = mp_oBrightnessCache;
+  bool bOK;
+
+  if ( NULL == p_oFile ) return;
+  bOK = 1 == fwrite( BRIGHTNESS_CACHE_ID, sizeof( BRIGHTNESS_CACHE_ID ), 1, p_oFile );
+  while ( bOK && p_oTable )
+  {
+    bOK = 1 == fwrite( & p_oTable->fLatitude, sizeof( double ), 1, p_oFile ) &&
+          1 == fwrite( & p_oTable->fAzimuthOfNorth, sizeof( double ), 1, p_oFile ) &&
+          1 == fwrite( & p_oTable->fClearSkyTransCoef, sizeof( float ), 1, p_oFile ) &&
+          1 == fwrite( & p_oTable->fBeamFracGlobalRad, sizeof( float ), 1, p_oFile ) &&
+          1 == fwrite( & p_oTable->iKind, sizeof( int ), 1, p_oFile ) &&
+          1 == fwrite( & p_oTable->iFirstJulDay, sizeof( int ), 1, p_oFile ) &&
+          1 == fwrite( & p_oTable->iLastJulDay, sizeof( int ), 1, p_oFile ) &&
+          1 == fwrite( & p_oTable->iNumAltAng, sizeof( int ), 1, p_oFile ) &&
+          1 == fwrite( & p_oTable->iNumAziAng, sizeof( int ), 1, p_oFile ) &&
+          1 == fwrite( & p_oTable->iMinAngRow, sizeof( int ), 1, p_oFile ) &&
+          ( size_t ) ( p_oTable->iNumAltAng * p_oTable->iNumAziAng ) ==
+          fwrite( p_oTable->p_fBrightness, sizeof( float ),
+              p_oTable->iNumAltAng * p_oTable->iNumAziAng, p_oFile );
+    p_oTable = p_oTable->p_oNext;
+  }
+  if ( 0 != fclose( p_oFile ) ) bOK = false;
+  if ( !bOK )
+  {
+    remove( sTempFile.c_str() );
+    return;
+  }
+
+  //Windows won't rename over an existing file
+  if ( 0 != rename( sTempFile.c_str(), sFile.c_str() ) )
+  {
+    remove( sFile.c_str() );
+    if ( 0 != rename( sTempFile.c_str(), sFile.c_str() ) )
+      remove( sTempFile.c_str() );
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// ClearBrightnessCache()
+///////////////////////////////////////////////////////////////////////////////
+void clLightBase::ClearBrightnessCache()
+{
+  stcBrightnessTable * p_oTable;
+  while ( mp_oBrightnessCache )
+  {
+    p_oTable = mp_oBrightnessCache;
+    mp_oBrightnessCache = p_oTable->p_oNext;
+    delete[] p_oTable->p_fBrightness;
+    delete p_oTable;
+  }
+}
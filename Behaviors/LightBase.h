@@ -44,6 +44,11 @@ class clQuadratGLILight;
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
 * <tr>August 19, 2015 - Added sky rotation (LEM)
+* <br>October 17, 2026 - Added per-thread photo arrays, m_bThreadSafe, and
+* PreLightCalcs() (agent)
+* <br>October 17, 2026 - Added GetLightReach() (agent)
+* <br>October 17, 2026 - Sky brightness arrays are cached in memory and, for
+* batch runs, on disk (agent)
 */
 class clLightBase : virtual public clBehaviorBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -98,6 +103,33 @@ class clLightBase : virtual public clBehaviorBase {
   */
   virtual float CalcLightValue(clTree *p_oTree, clTreePopulation *p_oPop) = 0;
 
+  /**
+  * Performs calculations that must happen each timestep before any light
+  * values are calculated. clLightOrg calls this once per timestep for each
+  * shell in its light functions table, before it calls CalcLightValue() for
+  * any tree. Trees for which clLightOrg::LightIsCurrent() is true won't have
+  * CalcLightValue() called. Override if needed.
+  *
+  * @param p_oPop Tree population object.
+  */
+  virtual void PreLightCalcs(clTreePopulation *p_oPop) {;};
+
+  /**
+  * Gets how far from a tree other trees can be and still change the value
+  * CalcLightValue() gives it. clLightOrg uses this to decide whether a tree
+  * can keep its light value from the last timestep. Shells whose light values
+  * depend only on the trees within some distance can override this; the
+  * default means the reach is unknown, and trees always get new light values.
+  * If the shell is thread-safe, this may be called from several threads at
+  * once, with crown dimensions already calculated.
+  *
+  * @param p_oTree Tree whose light value is in question.
+  * @param p_oPop Tree population object.
+  * @return Reach, in meters, or -1 if unknown.
+  */
+  virtual float GetLightReach(clTree *p_oTree, clTreePopulation *p_oPop)
+      {return -1;};
+
   /**
   * Gets the light org object.
   *
@@ -133,6 +165,12 @@ class clLightBase : virtual public clBehaviorBase {
 
   float GetBrightness(int alt, int azi) {return mp_fBrightness[alt][azi];};
 
+  /**
+  * Frees all sky brightness arrays kept in memory. They can always be
+  * calculated again, so this is safe to call between runs.
+  */
+  static void ClearBrightnessCache();
+
   protected:
 
   static clLightOrg *mp_oLightOrg; /**<clLightOrg object - this pointer is held
@@ -157,6 +195,23 @@ class clLightBase : virtual public clBehaviorBase {
    * index increases from 0 to 2PI. Each child object needs its own copy of this.*/
   float **mp_fPhoto;
 
+  /**Simulated fisheye photo arrays for the second and later threads when
+   * light is calculated in parallel. The first thread uses mp_fPhoto, so
+   * element 0 is always NULL. Array size is m_iNumThreadPhotos; each photo is
+   * sized like mp_fPhoto. Use GetPhotoArray() rather than reading this
+   * directly.*/
+  float ***mp_fThreadPhoto;
+
+  /**Size of mp_fThreadPhoto.*/
+  int m_iNumThreadPhotos;
+
+  /**Whether CalcLightValue() can be called for several trees at once from
+   * different threads. A thread-safe shell may only read trees, draw its
+   * fisheye photo in GetPhotoArray(), and write nothing else. It may assume
+   * that crown radius and depth have already been calculated for every
+   * living tree. Shells must opt in to parallel calculation.*/
+  bool m_bThreadSafe;
+
   /**The altitude angle below which the sky is assumed to be dark. Could be in
    * degrees or radians, depending on what the child object is working in. Each
    * child object needs its own copy of this.*/
@@ -179,6 +234,36 @@ class clLightBase : virtual public clBehaviorBase {
    * copy of this.*/
   int m_iMinAngRow;
 
+  /**
+  * A sky brightness array kept for reuse. The key is everything the
+  * brightness array depends on; two arrays with the same key are the same.
+  */
+  struct stcBrightnessTable {
+    double fLatitude; /**<Plot latitude, in degrees*/
+    double fAzimuthOfNorth; /**<Azimuth of north, in radians*/
+    float fClearSkyTransCoef; /**<Clear sky transmission coefficient*/
+    float fBeamFracGlobalRad; /**<Beam fraction of global radiation*/
+    int iKind; /**<Which function made it - gliBrightness or sailBrightness*/
+    int iFirstJulDay; /**<First day of the growing season*/
+    int iLastJulDay; /**<Last day of the growing season*/
+    int iNumAltAng; /**<Number of altitude angles*/
+    int iNumAziAng; /**<Number of azimuth angles*/
+    int iMinAngRow; /**<Row of the minimum sun angle*/
+    float *p_fBrightness; /**<Brightness, altitude-major. Array size is
+    iNumAltAng * iNumAziAng.*/
+    stcBrightnessTable *p_oNext; /**<Next array in the cache*/
+  };
+
+  /**Kinds of sky brightness array*/
+  enum brightnessKind {gliBrightness, /**<From PopulateGLIBrightnessArray()*/
+                       sailBrightness /**<From PopulateSailLightBrightnessArray()*/
+  };
+
+  /**Sky brightness arrays already calculated, as a linked list. This is
+   * shared by all shells and lasts until ClearBrightnessCache() is called, so
+   * runs after the first in a batch find their arrays here.*/
+  static stcBrightnessTable *mp_oBrightnessCache;
+
   /**
   * Triggers all light setup. This will be the same for all descendent classes.
   * If a particular object is hooked, it calls the light org object's DoSetup()
@@ -218,6 +303,78 @@ class clLightBase : virtual public clBehaviorBase {
   */
   void PopulateSailLightBrightnessArray();
 
+  /**
+  * Fills in the key of a sky brightness array for this shell's current
+  * settings.
+  * @param iKind Which kind of array, from brightnessKind.
+  * @param stcKey Key to fill in. p_fBrightness and p_oNext are set to NULL.
+  */
+  void MakeBrightnessKey(int iKind, stcBrightnessTable &stcKey);
+
+  /**
+  * Copies a sky brightness array matching a key into mp_fBrightness, if one
+  * has already been calculated. The memory cache is checked first, then, in a
+  * batch run, the cache file.
+  * @param stcKey Key of the array.
+  * @return True if the array was found and copied.
+  */
+  bool GetCachedBrightness(stcBrightnessTable &stcKey);
+
+  /**
+  * Keeps a copy of mp_fBrightness in the memory cache and, in a batch run,
+  * the cache file. Problems with the file are ignored, since it is only a
+  * cache.
+  * @param stcKey Key of the array.
+  */
+  void CacheBrightness(stcBrightnessTable &stcKey);
+
+  /**
+  * Gets the name of the brightness cache file, which sits next to the batch
+  * file.
+  * @return Cache file name, or an empty string if this is not a batch run.
+  */
+  std::string GetBrightnessCacheFile();
+
+  /**
+  * Finds a sky brightness array in the memory cache.
+  * @param stcKey Key of the array.
+  * @return Array, or NULL if it isn't there.
+  */
+  static stcBrightnessTable* FindBrightness(stcBrightnessTable &stcKey);
+
+  /**
+  * Adds the arrays in a cache file to the memory cache, skipping any already
+  * there. A file that is missing or can't be read adds nothing.
+  * @param sFile Cache file name.
+  */
+  static void ReadBrightnessCacheFile(std::string sFile);
+
+  /**
+  * Writes the memory cache to a cache file. The arrays are written to a
+  * temporary file first, then moved into place, so a run reading the file at
+  * the same time never sees half of it.
+  * @param sFile Cache file name.
+  * @param sTempFile Temporary file name. Must be unique to this run.
+  */
+  static void WriteBrightnessCacheFile(std::string sFile, std::string sTempFile);
+
+  /**
+  * Makes sure there is a fisheye photo array for each of a number of
+  * threads. Photos already made are kept. This must be called outside of any
+  * parallel section, and after mp_fPhoto has been allocated.
+  *
+  * @param iNumThreads Number of threads that will draw photos.
+  */
+  void ReservePhotoArrays(int iNumThreads);
+
+  /**
+  * Gets the fisheye photo array belonging to the calling thread. Outside a
+  * parallel section, or when not built with OpenMP, this is mp_fPhoto.
+  *
+  * @return Photo array for the current thread.
+  */
+  float** GetPhotoArray();
+
 
 
  //Solar geometry equations - inline
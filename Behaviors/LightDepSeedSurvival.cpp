@@ -430,7 +430,7 @@ float clLightDepSeedSurvival::GetGLI( clTreePopulation * p_oPop, const float & f
     if ( clTreePopulation::seedling != p_oNeighbor->GetType() )
 
       //Add the effect of the neighbor to the simulated fisheye photo
-      AddTreeToGliFishEye( fX, fY, m_fLightHeight, p_oNeighbor, p_oPlot, p_oPop, p_oAllom );
+      AddTreeToGliFishEye( fX, fY, m_fLightHeight, p_oNeighbor, p_oPlot, p_oPop, p_oAllom, mp_fPhoto );
 
     p_oNeighbor = p_oShaders->NextTree();
   } //end of while (neighbor != NULL)
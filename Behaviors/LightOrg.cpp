@@ -5,6 +5,8 @@
 #include "TreePopulation.h"
 #include "ParsingFunctions.h"
 #include "Allometry.h"
+#include "Grid.h"
+#include "TaskPool.h"
 #include <sstream>
 
 //////////////////////////////////////////////////////////////////////////////
@@ -22,6 +24,24 @@ clLightOrg::clLightOrg( clLightBase * p_oHookedShell )
     mp_fLightExtCoef = NULL;
     mp_fSnagLightExtCoef = NULL;
     mp_iSnagAgeClasses = NULL;
+    mp_oShellList = NULL;
+    mp_oBufferTrees = NULL;
+    mp_oTaskPool = NULL;
+    mp_fBufferLight = NULL;
+    mp_cBufferStatus = NULL;
+    m_iBufferSize = 0;
+    m_iNumShells = 0;
+    m_bTwoPhase = false;
+    mp_oCountsGrid = NULL;
+    mp_iChangedCellSums = NULL;
+    m_lLightEpoch = 0;
+    m_lNumLightCalculated = 0;
+    m_lNumLightReused = 0;
+    m_iRefreshInterval = 1;
+    m_iTimestepsSinceRefresh = -1;
+    m_iCalculatedCode = -1;
+    m_iReusedCode = -1;
+    m_bFullRefresh = true;
     m_fBeamFracGlobRad = 0;
     m_fClearSkyTransCoeff = 0;
     m_iFirstJulDay = 0;
@@ -89,6 +109,11 @@ clLightOrg::~clLightOrg()
   delete[] mp_iLightCodes;
   delete[] mp_fSnagLightExtCoef;
   delete[] mp_iSnagAgeClasses;
+  delete[] mp_oShellList;
+  delete[] mp_oBufferTrees;
+  delete[] mp_fBufferLight;
+  delete[] mp_cBufferStatus;
+  delete[] mp_iChangedCellSums;
 }
 
 
@@ -113,6 +138,7 @@ void clLightOrg::DoSetup( clSimManager * p_oSimManager, xercesc::DOMDocument * p
 
     //Get the tree population object, and from it the numbers of species and types
     mp_oPop = ( clTreePopulation * ) p_oSimManager->GetPopulationObject( "treepopulation" );
+    mp_oTaskPool = p_oSimManager->GetTaskPool();
 
     m_iTotalSpecies = mp_oPop->GetNumberOfSpecies();
     m_iTotalTypes = mp_oPop->GetNumberOfTypes();
@@ -130,6 +156,26 @@ void clLightOrg::DoSetup( clSimManager * p_oSimManager, xercesc::DOMDocument * p
     //Get needed data from the parameter file
     GetParameterFileData( p_oSimManager, p_oDoc );
 
+    //Set up the grid for reporting incremental light counts
+    if ( 1 != m_iRefreshInterval )
+    {
+      mp_oCountsGrid = p_oSimManager->GetGridObject( "Light Recalculation" );
+      if ( NULL == mp_oCountsGrid )
+        mp_oCountsGrid = p_oSimManager->CreateGrid( "Light Recalculation",
+                          2,                      //number of ints
+                          0,                      //number of floats
+                          0,                      //number of chars
+                          0,                      //number of bools
+                          mp_oPop->GetXPlotLength(),  //X cell length
+                          mp_oPop->GetYPlotLength()); //Y cell length
+      m_iCalculatedCode = mp_oCountsGrid->GetIntDataCode( "Calculated" );
+      if ( -1 == m_iCalculatedCode )
+        m_iCalculatedCode = mp_oCountsGrid->RegisterInt( "Calculated" );
+      m_iReusedCode = mp_oCountsGrid->GetIntDataCode( "Reused" );
+      if ( -1 == m_iReusedCode )
+        m_iReusedCode = mp_oCountsGrid->RegisterInt( "Reused" );
+    }
+
     //Calculate maximum tree height
     clAllometry *p_oAllom = mp_oPop->GetAllometryObject();
     for ( i = 0; i < m_iTotalSpecies; i++ )
@@ -182,10 +228,14 @@ void clLightOrg::PopulateLightFunctionsTable( clSimManager * p_oSimManager, clTr
         mp_oLightFunctionTable[i] [j] = NULL;
     }
 
+    //Declare the shell list - no bigger than the number of behaviors
+    iNumBehaviors = p_oSimManager->GetNumberOfBehaviors();
+    mp_oShellList = new clLightBase * [iNumBehaviors];
+    m_iNumShells = 0;
+    m_bTwoPhase = false;
+
     //Now go through all the behaviors to pick out the light shells - should have
     //the string "lightshell" in their namestrings
-    //Get total number of behaviors
-    iNumBehaviors = p_oSimManager->GetNumberOfBehaviors();
     for ( i = 0; i < iNumBehaviors; i++ ) {
       p_oTempBehavior = p_oSimManager->GetBehaviorObject( i );
       sBehaviorName = p_oTempBehavior->GetName();
@@ -217,6 +267,14 @@ void clLightOrg::PopulateLightFunctionsTable( clSimManager * p_oSimManager, clTr
           else
             mp_oLightFunctionTable[combo.iSpecies] [combo.iType] = p_oLightShell;
         }
+
+        //Add the shell to the list if it has any trees
+        if ( iNumCombos > 0 )
+        {
+          mp_oShellList[m_iNumShells] = p_oLightShell;
+          m_iNumShells++;
+          if ( p_oLightShell->m_bThreadSafe ) m_bTwoPhase = true;
+        }
       } //end of if (NULL != strstr(cBehaviorName, cShellMarker))
     } //end of for (i = 0; i < iNumBehaviors; i++)
   }
@@ -247,6 +305,7 @@ void clLightOrg::GetParameterFileData( clSimManager * p_oSimManager, xercesc::DO
   {
     DOMElement * p_oElement; //for retrieving values from the parameter file
     clLightBase * p_oTemp; //for finding light objects
+    double fVal;
     int iVal;
     short int //iTotalTypes = mp_oPop->GetNumberOfTypes(),
          iNumBehaviors = p_oSimManager->GetNumberOfBehaviors(), i, j; //loop counters
@@ -294,6 +353,20 @@ void clLightOrg::GetParameterFileData( clSimManager * p_oSimManager, xercesc::DO
     //End of growing season
     FillSingleValue( p_oElement, "li_julianDayGrowthEnds", & m_iLastJulDay, true );
 
+    //Incremental light - optional
+    FillSingleValue( p_oElement, "li_lightRefreshInterval", & m_iRefreshInterval, false );
+    fVal = 0;
+    FillSingleValue( p_oElement, "li_lightChangeTolerance", & fVal, false );
+    if ( m_iRefreshInterval < 0 || fVal < 0 )
+    {
+      modelErr stcErr;
+      stcErr.iErrorCode = BAD_DATA;
+      stcErr.sFunction = "clLightOrg::GetParameterFileData" ;
+      stcErr.sMoreInfo = "The light refresh interval and light change tolerance cannot be negative.";
+      throw( stcErr );
+    }
+    mp_oPop->SetSizeChangeTolerance( fVal );
+
     //Snag parameters, if appropriate
     if ( mp_fSnagLightExtCoef )
     {
@@ -431,6 +504,81 @@ void clLightOrg::DoTreeDataMemberRegistrations( clSimManager * p_oSimManager, cl
 }
 
 
+//////////////////////////////////////////////////////////////////////////////
+// CalcTreeLight()
+//////////////////////////////////////////////////////////////////////////////
+bool clLightOrg::CalcTreeLight( clTree * p_oTree, float & fLightVal )
+{
+  int iIsDead;
+  short int iSp = p_oTree->GetSpecies(), iType = p_oTree->GetType(),
+            iDeadCode; //dead code for a tree
+
+  //Check to see if this species/type combo has a light shell to calculate
+  //its value
+  if ( NULL == mp_oLightFunctionTable[iSp] [iType] ) return false;
+
+  //Make sure this tree is not dead from a previous disturbance
+  iDeadCode = mp_oPop->GetIntDataCode( "dead", iSp, iType );
+  if ( -1 != iDeadCode )
+  {
+    p_oTree->GetValue( iDeadCode, & iIsDead );
+  }
+  else
+    iIsDead = notdead;
+  if ( notdead != iIsDead ) return false;
+
+  fLightVal = mp_oLightFunctionTable[iSp] [iType]->CalcLightValue( p_oTree, mp_oPop );
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ReserveBuffers()
+//////////////////////////////////////////////////////////////////////////////
+void clLightOrg::ReserveBuffers( int iNumTrees )
+{
+  clTree ** p_oOldTrees = mp_oBufferTrees;
+  int i;
+
+  if ( iNumTrees <= m_iBufferSize ) return;
+
+  delete[] mp_fBufferLight;
+  delete[] mp_cBufferStatus;
+
+  //Leave some room so a growing population doesn't reallocate every time
+  m_iBufferSize = iNumTrees + iNumTrees / 4 + 1;
+  mp_oBufferTrees = new clTree * [m_iBufferSize];
+  for ( i = 0; i < iNumTrees - 1; i++ ) mp_oBufferTrees[i] = p_oOldTrees[i];
+  delete[] p_oOldTrees;
+  mp_fBufferLight = new float[m_iBufferSize];
+  mp_cBufferStatus = new char[m_iBufferSize];
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// CacheCrownDimensions()
+//////////////////////////////////////////////////////////////////////////////
+void clLightOrg::CacheCrownDimensions()
+{
+  mp_oPop->GetAllometryObject()->CalcAllCrownDimensions();
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// stcCalcLight::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clLightOrg::stcCalcLight::operator()( int i )
+{
+  clTree * p_oTree = p_oOrg->mp_oBufferTrees[i];
+  clLightBase * p_oShell =
+      p_oOrg->mp_oLightFunctionTable[p_oTree->GetSpecies()] [p_oTree->GetType()];
+
+  p_oOrg->mp_cBufferStatus[i] = 0;
+  if ( NULL != p_oShell && !p_oShell->m_bThreadSafe )
+    p_oOrg->mp_cBufferStatus[i] = 2;
+  else if ( p_oOrg->LightIsCurrent( p_oTree ) )
+    p_oOrg->mp_cBufferStatus[i] = 3;
+  else if ( p_oOrg->CalcTreeLight( p_oTree, p_oOrg->mp_fBufferLight[i] ) )
+    p_oOrg->mp_cBufferStatus[i] = 1;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // DoLightAssignments()
 //////////////////////////////////////////////////////////////////////////////
@@ -441,47 +589,89 @@ void clLightOrg::DoLightAssignments()
     clTreeSearch * p_oAllTrees; //search object for getting all trees
     clTree * p_oTree; //for working with a single tree
     float fLightVal; //light value to be assigned to the tree
-    int iIsDead;
-    short int iSp, iType, //species and type of a given tree
-              iDeadCode; //dead code for a tree
+    stcCalcLight stcCalc; //for calculating light ahead of time
+    int iNumTrees, iNumThreads, i;
+
+    //Find out which trees need new light, so the shells can skip the rest
+    FindChangedCells();
+
+    //Call the PreLightCalcs() function for all shells
+    for ( i = 0; i < m_iNumShells; i++ )
+      mp_oShellList[i]->PreLightCalcs( mp_oPop );
 
     //Ask the tree population to find all trees
     p_oAllTrees = mp_oPop->Find( "all" );
 
-    //Go through the trees one at a time
-    p_oTree = p_oAllTrees->NextTree();
-    while ( p_oTree )
+    iNumThreads = mp_oTaskPool->GetNumThreads();
+    if ( !m_bTwoPhase || iNumThreads < 2 )
     {
-      //Get the tree's species and type
-      iSp = p_oTree->GetSpecies();
-      iType = p_oTree->GetType();
-
-      //Check to see if this species/type combo has a light shell to calculate
-      //its value - if it does, get it
-      if ( NULL != mp_oLightFunctionTable[iSp] [iType] )
+      //Go through the trees one at a time
+      p_oTree = p_oAllTrees->NextTree();
+      while ( p_oTree )
       {
-
-        //Make sure this tree is not dead from a previous disturbance
-        iDeadCode = mp_oPop->GetIntDataCode( "dead", iSp, p_oTree->GetType() );
-        if ( -1 != iDeadCode )
+        //Assign the value to the "Light" float data member of the tree,
+        //unless it can keep the one it has
+        if ( LightIsCurrent( p_oTree ) )
+          m_lNumLightReused++;
+        else if ( CalcTreeLight( p_oTree, fLightVal ) )
         {
-          p_oTree->GetValue( iDeadCode, & iIsDead );
+          p_oTree->SetValue( mp_iLightCodes[p_oTree->GetSpecies()] [p_oTree->GetType()], fLightVal, false );
+          m_lNumLightCalculated++;
         }
-        else
-          iIsDead = notdead;
 
-        if ( notdead == iIsDead )
-        {
+        p_oTree = p_oAllTrees->NextTree();
+      } //end of while (p_oTree)
+      EndLightAssignments();
+      return;
+    }
 
-          fLightVal = mp_oLightFunctionTable[iSp] [iType]->CalcLightValue( p_oTree, mp_oPop );
+    //Collect the trees
+    iNumTrees = 0;
+    p_oTree = p_oAllTrees->NextTree();
+    while ( p_oTree )
+    {
+      ReserveBuffers( iNumTrees + 1 );
+      mp_oBufferTrees[iNumTrees] = p_oTree;
+      iNumTrees++;
+      p_oTree = p_oAllTrees->NextTree();
+    }
 
-          //Assign the value to the "Light" float data member of the tree
-          p_oTree->SetValue( mp_iLightCodes[iSp] [iType], fLightVal, false );
-        }
-      }
+    //Get everything the shells write on first use written now, and give
+    //each thread its own photo
+    CacheCrownDimensions();
+    for ( i = 0; i < m_iNumShells; i++ )
+      if ( mp_oShellList[i]->m_bThreadSafe )
+        mp_oShellList[i]->ReservePhotoArrays( iNumThreads );
 
-      p_oTree = p_oAllTrees->NextTree();
-    } //end of while (p_oTree)
+    //Bring the tree snapshot up to date so that shading neighbor searches
+    //run over its packed arrays
+    mp_oPop->GetSnapshot();
+
+    //Calculate light for every tree whose shell allows it
+    stcCalc.p_oOrg = this;
+    mp_oTaskPool->ParallelFor( 0, iNumTrees, stcCalc, 64 );
+
+    //Assign light in tree order, calculating it now for any trees whose
+    //shells couldn't do it ahead of time
+    for ( i = 0; i < iNumTrees; i++ )
+    {
+      p_oTree = mp_oBufferTrees[i];
+      if ( 2 == mp_cBufferStatus[i] )
+      {
+        if ( LightIsCurrent( p_oTree ) )
+          mp_cBufferStatus[i] = 3;
+        else
+          mp_cBufferStatus[i] = CalcTreeLight( p_oTree, mp_fBufferLight[i] ) ? 1 : 0;
+      }
+      if ( 1 == mp_cBufferStatus[i] )
+      {
+        p_oTree->SetValue( mp_iLightCodes[p_oTree->GetSpecies()] [p_oTree->GetType()], mp_fBufferLight[i], false );
+        m_lNumLightCalculated++;
+      }
+      else if ( 3 == mp_cBufferStatus[i] )
+        m_lNumLightReused++;
+    }
+    EndLightAssignments();
   }
   catch ( modelErr & err )
   {
@@ -501,6 +691,123 @@ void clLightOrg::DoLightAssignments()
 }
 
 
+//////////////////////////////////////////////////////////////////////////////
+// FindChangedCells()
+//////////////////////////////////////////////////////////////////////////////
+void clLightOrg::FindChangedCells()
+{
+  int iNumXCells = mp_oPop->GetNumXCells(), iNumYCells = mp_oPop->GetNumYCells(),
+      iRow = iNumYCells + 1, iX, iY;
+
+  m_lNumLightCalculated = 0;
+  m_lNumLightReused = 0;
+
+  m_bFullRefresh = 1 == m_iRefreshInterval || -1 == m_iTimestepsSinceRefresh
+      || ( m_iRefreshInterval > 0 && m_iTimestepsSinceRefresh >= m_iRefreshInterval );
+  if ( m_bFullRefresh )
+  {
+    m_iTimestepsSinceRefresh = 1;
+    return;
+  }
+  m_iTimestepsSinceRefresh++;
+
+  //Add up the changed cells so that any rectangle of them can be counted
+  //with four lookups
+  if ( NULL == mp_iChangedCellSums )
+    mp_iChangedCellSums = new int[( iNumXCells + 1 ) * iRow];
+  for ( iY = 0; iY < iRow; iY++ ) mp_iChangedCellSums[iY] = 0;
+  for ( iX = 0; iX < iNumXCells; iX++ )
+  {
+    mp_iChangedCellSums[( iX + 1 ) * iRow] = 0;
+    for ( iY = 0; iY < iNumYCells; iY++ )
+      mp_iChangedCellSums[( iX + 1 ) * iRow + iY + 1] =
+          ( mp_oPop->GetCellChangeEpoch( iX, iY ) > m_lLightEpoch ? 1 : 0 )
+          + mp_iChangedCellSums[iX * iRow + iY + 1]
+          + mp_iChangedCellSums[( iX + 1 ) * iRow + iY]
+          - mp_iChangedCellSums[iX * iRow + iY];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// GetCellRuns()
+//////////////////////////////////////////////////////////////////////////////
+int clLightOrg::GetCellRuns( float fCoord, float fReach, float fPlotLength,
+    int iNumCells, int * p_iFirst, int * p_iLast )
+{
+  float fLow = fCoord - fReach, fHigh = fCoord + fReach,
+        fCellLength = mp_oPop->GetHashCellLength();
+
+  //The stretch covers the whole plot
+  if ( fHigh - fLow >= fPlotLength )
+  {
+    p_iFirst[0] = 0;
+    p_iLast[0] = iNumCells - 1;
+    return 1;
+  }
+
+  if ( fLow < 0 ) fLow += fPlotLength;
+  if ( fHigh >= fPlotLength ) fHigh -= fPlotLength;
+  p_iFirst[0] = ( int ) floor( fLow / fCellLength );
+  p_iLast[0] = ( int ) floor( fHigh / fCellLength );
+  if ( p_iFirst[0] >= iNumCells ) p_iFirst[0] = iNumCells - 1;
+  if ( p_iLast[0] >= iNumCells ) p_iLast[0] = iNumCells - 1;
+  if ( fLow <= fHigh ) return 1;
+
+  //The stretch wraps around the plot edge
+  p_iFirst[1] = 0;
+  p_iLast[1] = p_iLast[0];
+  p_iLast[0] = iNumCells - 1;
+  return 2;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// LightIsCurrent()
+//////////////////////////////////////////////////////////////////////////////
+bool clLightOrg::LightIsCurrent( clTree * p_oTree )
+{
+  clLightBase * p_oShell;
+  float fX, fY, fReach;
+  int p_iFirstX[2], p_iLastX[2], p_iFirstY[2], p_iLastY[2], iNumXRuns,
+      iNumYRuns, iRow = mp_oPop->GetNumYCells() + 1, iX, iY;
+  short int iSp = p_oTree->GetSpecies(), iTp = p_oTree->GetType();
+
+  if ( m_bFullRefresh ) return false;
+  p_oShell = mp_oLightFunctionTable[iSp] [iTp];
+  if ( NULL == p_oShell ) return false;
+  fReach = p_oShell->GetLightReach( p_oTree, mp_oPop );
+  if ( fReach < 0 ) return false;
+
+  p_oTree->GetValue( mp_oPop->GetXCode( iSp, iTp ), & fX );
+  p_oTree->GetValue( mp_oPop->GetYCode( iSp, iTp ), & fY );
+  iNumXRuns = GetCellRuns( fX, fReach, mp_oPop->GetXPlotLength(),
+      mp_oPop->GetNumXCells(), p_iFirstX, p_iLastX );
+  iNumYRuns = GetCellRuns( fY, fReach, mp_oPop->GetYPlotLength(),
+      mp_oPop->GetNumYCells(), p_iFirstY, p_iLastY );
+
+  //The tree's light is current if no cell in the square around it changed
+  for ( iX = 0; iX < iNumXRuns; iX++ )
+    for ( iY = 0; iY < iNumYRuns; iY++ )
+      if ( mp_iChangedCellSums[( p_iLastX[iX] + 1 ) * iRow + p_iLastY[iY] + 1]
+         - mp_iChangedCellSums[p_iFirstX[iX] * iRow + p_iLastY[iY] + 1]
+         - mp_iChangedCellSums[( p_iLastX[iX] + 1 ) * iRow + p_iFirstY[iY]]
+         + mp_iChangedCellSums[p_iFirstX[iX] * iRow + p_iFirstY[iY]] > 0 )
+        return false;
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// EndLightAssignments()
+//////////////////////////////////////////////////////////////////////////////
+void clLightOrg::EndLightAssignments()
+{
+  m_lLightEpoch = mp_oPop->GetTreeEpoch();
+  if ( mp_oCountsGrid )
+  {
+    mp_oCountsGrid->SetValueOfCell( 0, 0, m_iCalculatedCode, ( int ) m_lNumLightCalculated );
+    mp_oCountsGrid->SetValueOfCell( 0, 0, m_iReusedCode, ( int ) m_lNumLightReused );
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // GetLightExtCoeff()
 //////////////////////////////////////////////////////////////////////////////
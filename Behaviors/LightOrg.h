@@ -11,6 +11,8 @@ class DOMDocument;
 
 class clTreePopulation;
 class clTree;
+class clGrid;
+class clTaskPool;
 
 /**
 * Light org - Version 1.0
@@ -31,6 +33,18 @@ class clTree;
 * descended from the clLightBase class.  This class can still perform useful
 * services for them, such as keeping the common light parameters.
 *
+* Light can be recalculated incrementally. With "li_lightRefreshInterval" set
+* to anything but 1, a tree keeps last timestep's light value if its shell
+* knows how far away trees can affect its light (see
+* clLightBase::GetLightReach()) and no tree population hash cell within that
+* distance has changed since light was last assigned. What counts as a
+* change is set by "li_lightChangeTolerance" (see
+* clTreePopulation::SetSizeChangeTolerance()). Every tree gets new light
+* every li_lightRefreshInterval timesteps, or never if it is 0. The number of
+* trees whose light was calculated and reused each timestep is put in a grid
+* called "Light Recalculation", with one cell and the int data members
+* "Calculated" and "Reused".
+*
 * A fatal error will be thrown if the number of years per timestep in the
 * sim manager is not an integer.  This is less a calculations problem than a
 * conceptual one; these light behaviors cannot handle partial growing seasons
@@ -42,6 +56,14 @@ class clTree;
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Light for trees whose shells are thread-safe is
+* calculated ahead of time, in parallel where available; added
+* clLightBase::PreLightCalcs() calls (agent)
+* <br>October 17, 2026 - Added incremental light recalculation (agent)
+* <br>October 17, 2026 - Two-phase light runs on the task pool (agent)
+* <br>October 17, 2026 - Changed cells are found before PreLightCalcs(), and
+* LightIsCurrent() is public, so shells can skip trees keeping their light
+* (agent)
 */
 class clLightOrg {
   public:
@@ -63,9 +85,34 @@ class clLightOrg {
   * light values and their assignment to individual trees.  This should be
   * called each timestep by the hooked shell's
   * Action() function.
+  *
+  * First the hash cells that have changed since light was last assigned are
+  * found, and then each shell's PreLightCalcs() is called. If any shell is
+  * thread-safe
+  * (see clLightBase::m_bThreadSafe), the trees are then collected and the
+  * light for every tree with a thread-safe shell is calculated into a buffer,
+  * split among the task pool's threads (see clTaskPool). Each thread draws
+  * into its own fisheye photo. Then the trees are visited in their original
+  * order and the buffered values assigned; trees with other shells have their
+  * light calculated at that point, as they otherwise would. No shell reads the
+  * "Light" data member, so the results are the same as calculating one tree
+  * at a time.
+  *
+  * In incremental mode, trees whose light is still current keep their
+  * "Light" value and are skipped in both phases.
   */
   void DoLightAssignments();
 
+  /**
+  * Makes sure that every living sapling, adult, and snag has its crown radius
+  * and crown depth stored. clAllometry calculates these the first time they
+  * are asked for and stores them on the tree, which is a write; once this has
+  * been called, asking for them only reads. Call this outside of any parallel
+  * section before starting light calculations that run in parallel. The work
+  * is done by clAllometry::CalcAllCrownDimensions().
+  */
+  void CacheCrownDimensions();
+
   /**
   * Performs setup functions.  It creates and populates the light functions
   * table.  It can find any light shell behavior as long as the
@@ -145,6 +192,20 @@ class clLightOrg {
   */
   int GetLastDayOfGrowingSeason() {return m_iLastJulDay;};
 
+  /**
+  * Gets the number of trees whose light was calculated in the last call to
+  * DoLightAssignments().
+  * @return Number of trees.
+  */
+  long GetNumLightCalculated() {return m_lNumLightCalculated;};
+
+  /**
+  * Gets the number of trees that kept their light value from the timestep
+  * before in the last call to DoLightAssignments().
+  * @return Number of trees.
+  */
+  long GetNumLightReused() {return m_lNumLightReused;};
+
   /**
   * Gets a pointer to a light shell object.
   * @param iSp Species for which to get the light shell object.
@@ -155,8 +216,35 @@ class clLightOrg {
   clLightBase* GetLightShell(short int iSp, short int iTp)
      {return mp_oLightFunctionTable[iSp][iTp];};
 
+  /**
+  * Decides whether a tree can keep the light value it already has. This can
+  * be called from several threads at once for trees with thread-safe shells.
+  * The changed cells are found before any shell's PreLightCalcs() is called,
+  * so shells can use this to skip work for trees that won't need light.
+  * @param p_oTree Tree.
+  * @return True if no hash cell within the reach of the tree's light shell
+  * has changed since light was last assigned.
+  */
+  bool LightIsCurrent(clTree *p_oTree);
+
   protected:
+
+  /**
+  * Calculates light ahead of time for one tree in mp_oBufferTrees, if its
+  * shell is thread-safe, and sets its mp_cBufferStatus. This is handed to
+  * clTaskPool::ParallelFor().
+  */
+  struct stcCalcLight {
+    clLightOrg *p_oOrg; /**<Light org object doing the calculating*/
+    /**
+    * Calculates light for one tree.
+    * @param i Tree's index in mp_oBufferTrees.
+    */
+    void operator()(int i);
+  };
+
   clTreePopulation *mp_oPop; /**<Stashed pointer to the tree population object*/
+  clTaskPool *mp_oTaskPool; /**<Task pool for two-phase light*/
 
   clLightBase ***mp_oLightFunctionTable; /**<Light shell objects.  Array size is
   number of species by number of types.  For each combo, this points to the
@@ -207,6 +295,112 @@ class clLightOrg {
   requires light)*/
   short int **mp_iLightCodes;
 
+  /**List of light shells that are assigned to at least one species/type combo.
+  Array size is m_iNumShells.*/
+  clLightBase **mp_oShellList;
+
+  /**Trees collected for two-phase light calculations. Array size is
+  m_iBufferSize.*/
+  clTree **mp_oBufferTrees;
+
+  /**Light value for each tree in mp_oBufferTrees.*/
+  float *mp_fBufferLight;
+
+  /**What to do with each tree in mp_oBufferTrees: 0 = nothing, 1 = assign the
+  value in mp_fBufferLight, 2 = calculate its light in order, 3 = keep the
+  light it has.*/
+  char *mp_cBufferStatus;
+
+  /**Size of the two-phase light buffers.*/
+  int m_iBufferSize;
+
+  /**Number of shells in mp_oShellList.*/
+  int m_iNumShells;
+
+  /**Whether or not any shell in mp_oShellList is thread-safe. If not, trees
+  get their light calculated one at a time.*/
+  bool m_bTwoPhase;
+
+  /**Grid for the numbers of trees whose light was calculated and reused.
+  NULL unless light is recalculated incrementally.*/
+  clGrid *mp_oCountsGrid;
+
+  /**For each tree population hash cell, the number of changed cells at or
+  below it in X and Y, for counting the changed cells in a rectangle. Array
+  size is (number of X cells + 1) * (number of Y cells + 1).*/
+  int *mp_iChangedCellSums;
+
+  /**Tree epoch when light was last assigned. See
+  clTreePopulation::GetCellChangeEpoch().*/
+  unsigned long m_lLightEpoch;
+
+  /**Number of trees whose light was calculated in the last timestep.*/
+  long m_lNumLightCalculated;
+
+  /**Number of trees whose light was reused in the last timestep.*/
+  long m_lNumLightReused;
+
+  /**Number of timesteps between forced recalculations of every tree's light.
+  1 means every timestep, which turns incremental light off; 0 means never.
+  From the parameter file, "li_lightRefreshInterval".*/
+  int m_iRefreshInterval;
+
+  /**Number of timesteps since every tree's light was last recalculated, or
+  -1 if light has never been assigned.*/
+  int m_iTimestepsSinceRefresh;
+
+  /**Code for the "Calculated" int data member of mp_oCountsGrid.*/
+  short int m_iCalculatedCode;
+
+  /**Code for the "Reused" int data member of mp_oCountsGrid.*/
+  short int m_iReusedCode;
+
+  /**Whether every tree gets new light this timestep.*/
+  bool m_bFullRefresh;
+
+  /**
+  * Decides whether every tree needs new light this timestep, and if not,
+  * finds the hash cells that have changed since light was last assigned.
+  * Resets the light counts.
+  */
+  void FindChangedCells();
+
+  /**
+  * Gets the hash cells that a stretch of the plot, centered on a point,
+  * covers in one direction. The stretch may wrap around the plot edge, so
+  * it can take two runs of cells.
+  * @param fCoord Coordinate of the point.
+  * @param fReach Distance from the point to either end of the stretch.
+  * @param fPlotLength Plot length in this direction.
+  * @param iNumCells Number of hash cells in this direction.
+  * @param p_iFirst Set to the first cell of each run.
+  * @param p_iLast Set to the last cell of each run.
+  * @return Number of runs, 1 or 2.
+  */
+  int GetCellRuns(float fCoord, float fReach, float fPlotLength,
+    int iNumCells, int *p_iFirst, int *p_iLast);
+
+  /**
+  * Finishes a timestep's light assignments by saving the tree epoch and
+  * reporting the light counts.
+  */
+  void EndLightAssignments();
+
+  /**
+  * Calculates light for one tree, if it has a light shell and is alive.
+  * @param p_oTree Tree for which to calculate light.
+  * @param fLightVal Set to the tree's light value.
+  * @return Whether or not the tree should be assigned fLightVal.
+  */
+  bool CalcTreeLight(clTree *p_oTree, float &fLightVal);
+
+  /**
+  * Makes sure the two-phase light buffers can hold a number of trees. Trees
+  * already collected are kept.
+  * @param iNumTrees Number of trees.
+  */
+  void ReserveBuffers(int iNumTrees);
+
   /**
   * Declares the light functions table and populates it with the appropriate
   * behavior pointers.  It does this by going through the behaviors and looking
@@ -215,6 +409,8 @@ class clLightOrg {
   * these combos, their respective place in the table is populated with the
   * behavior's pointer.
   *
+  * This also assembles mp_oShellList.
+  *
   * @param p_oSimManager Sim Manager object.
   * @param p_oPop Tree population object.
   * @throw Error if a species/type combo is claimed by more than one behavior.
@@ -240,6 +436,8 @@ class clLightOrg {
   * class is not greater than the first</li>
   * <li>Any of the light extinction coefficients are not between 0 and 1</li>
   * <li>The value of the clear sky transmission coefficient is 0</li>
+  * <li>The light refresh interval or the light change tolerance is
+  * negative</li>
   * </ul>
   */
   void GetParameterFileData(clSimManager *p_oSimManager, xercesc::DOMDocument *p_oDoc);
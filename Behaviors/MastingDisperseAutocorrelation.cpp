@@ -825,11 +825,16 @@ void clMastingDisperseAutocorrelation::AddSeeds()
       p_oTree->SetValue(mp_iPrevseedsCodes[iSp][iType], fSeeds);
 
       // Send out these seeds
-      DisperseOneParentSeeds( p_oTree, p_oPop, p_oPlot, fSeeds );
+      AddParent( p_oTree, fSeeds, p_oPop, p_oPlot );
 
       nextTree:
       p_oTree = p_oAllTrees->NextTree();
     } //end of while (p_oTree) */
+
+    delete[] p_fFractionParticipating;
+
+    //Disperse the parents' seeds
+    DisperseParents( p_oPop, p_oPlot );
   }
   catch ( modelErr & err )
   {
@@ -849,9 +854,9 @@ void clMastingDisperseAutocorrelation::AddSeeds()
 }
 
 //////////////////////////////////////////////////////////////////////////////
-// DisperseOneParentSeeds
+// DisperseOneParent
 //////////////////////////////////////////////////////////////////////////////
-void clMastingDisperseAutocorrelation::DisperseOneParentSeeds( clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fSeeds )
+void clMastingDisperseAutocorrelation::DisperseOneParent( clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fSeeds, float * p_fSeeds, gsl_rng * p_oStream )
 {
   try
   {
@@ -860,7 +865,6 @@ void clMastingDisperseAutocorrelation::DisperseOneParentSeeds( clTree * p_oTree,
     fDistance, //distance from the parent tree at which a seed lands
     fPrevBucket, //value in the previous bucket of the probability array
     fX, fY, //coordinates of tree
-    fNumGridSeeds, //number of seeds in the seed grid
     fSeedX, fSeedY, //coordinates of seed
     fAngle, //angle from the parent tree from which a seed lands
     f; //loop counter
@@ -880,7 +884,7 @@ void clMastingDisperseAutocorrelation::DisperseOneParentSeeds( clTree * p_oTree,
       //parent tree the seed lands - use a random number and find the first
       //probability array bucket with a value greater than the random
       iDistanceCounter = 0;
-      fRand = clModelMath::GetRand();
+      fRand = clModelMath::GetRand( p_oStream );
       while ( fRand > mp_fSeedCDF[iSpIndex][iDistanceCounter] )
         iDistanceCounter++;
 
@@ -892,7 +896,7 @@ void clMastingDisperseAutocorrelation::DisperseOneParentSeeds( clTree * p_oTree,
            / ( mp_fSeedCDF[iSpIndex][iDistanceCounter] - fPrevBucket ) );
 
       //Get a random direction to pitch the seed
-      fRand = clModelMath::GetRand();
+      fRand = clModelMath::GetRand( p_oStream );
       fAngle = 2.0 * M_PI * fRand;
       fAngle = std::max(2.0 * M_PI * fRand, (2.0 * M_PI)-0.00001);
 
@@ -900,10 +904,8 @@ void clMastingDisperseAutocorrelation::DisperseOneParentSeeds( clTree * p_oTree,
       fSeedX = p_oPlot->CorrectX( cos( fAngle ) * fDistance + fX );
       fSeedY = p_oPlot->CorrectY( sin( fAngle ) * fDistance + fY );
 
-      //Increment the seed counter at the seed's location in the grid
-      mp_oSeedGrid->GetValueAtPoint( fSeedX, fSeedY, mp_iNumSeedsCode[iSp], & fNumGridSeeds );
-      fNumGridSeeds++;
-      mp_oSeedGrid->SetValueAtPoint( fSeedX, fSeedY, mp_iNumSeedsCode[iSp], fNumGridSeeds );
+      //Increment the seed counter at the seed's location in the buffer
+      AddSeedAtPoint( p_fSeeds, fSeedX, fSeedY, iSp );
     } //end of for (i = 0; i < iNumSeeds; i++)
   }
   catch ( modelErr & err )
@@ -918,7 +920,7 @@ void clMastingDisperseAutocorrelation::DisperseOneParentSeeds( clTree * p_oTree,
   {
     modelErr stcErr;
     stcErr.iErrorCode = UNKNOWN;
-    stcErr.sFunction = "clMastingDisperseAutocorrelation::DisperseOneParentSeeds" ;
+    stcErr.sFunction = "clMastingDisperseAutocorrelation::DisperseOneParent" ;
     throw( stcErr );
   }
 }
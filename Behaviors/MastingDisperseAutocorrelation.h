@@ -200,8 +200,9 @@ public:
    void FormatQueryString(clTreePopulation *p_oPop);
 
    /**
-   * Performs dispersal of seeds for one tree. The number of seeds is calculated
-   * by using the pointer in mp_GetSeeds. Each seed is given a random azimuth
+   * Performs dispersal of seeds for one tree. This is called by
+   * clDisperseBase::AddParent() or DisperseParents(), with the number of
+   * seeds calculated in AddSeeds(). Each seed is given a random azimuth
    * direction from the parent. Then each seed is given a random distance from
    * the parent that conforms to the chosen probability distribution function.
    * This is done by comparing a random value to successive values in the
@@ -209,11 +210,13 @@ public:
    * value than the random number. Once the seed has an azimuth direction and
    * a distance, it is added to the species total in the appropriate grid cell.
    * @param p_oTree Tree for which to perform dispersal.
-   * @param fSeeds Number of seeds to disperse.
-   * @param p_oPlot Plot object
    * @param p_oPop Tree Population object
+   * @param p_oPlot Plot object
+   * @param fSeeds Number of seeds to disperse.
+   * @param p_fSeeds Seed buffer to add seeds to.
+   * @param p_oStream Random stream to draw from.
    */
-   void DisperseOneParentSeeds(clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fSeeds );
+   void DisperseOneParent(clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fSeeds, float * p_fSeeds, gsl_rng * p_oStream );
 
    /**
    * Extracts needed parameter file data. (Some parameters are extracted by
@@ -267,9 +270,12 @@ public:
     * <ul><li>Calculate its probability of reproducing</li>
     * <li>If reproducing, calculate autocorrelation coefficient</li>
     * <li>Calculate total number of seeds</li>
-    * <li>Disperse seeds</li>
     * </ul></li>
+    * <li>Disperse all trees' seeds with clDisperseBase::AddParent() and
+    * DisperseParents()</li>
     * </ul>
+    * The per-tree calculations update tree data members, so they are done
+    * serially from the shared random number generator.
     */
    void AddSeeds();
 
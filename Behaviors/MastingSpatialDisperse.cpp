@@ -827,16 +827,17 @@ void clMastingSpatialDisperse::AddSeeds()
         p_oTree->GetValue( p_oPop->GetDbhCode( iSp, iType ), & fDbh );
 
         //If the tree is larger than the minimum size for reproduction,
-        //and a random number lets it participate, let it reproduce
-        if ( fDbh >= mp_fDbhForReproduction[mp_iIndexes[iSp]] &&
-             clModelMath::GetRand() <
-              mp_fFractionParticipating[mp_iEvent[mp_iIndexes[iSp]]][mp_iIndexes[iSp]] )
-          DisperseOneParentSeeds( p_oTree, p_oPop, p_oPlot, fDbh );
+        //it's a candidate for reproducing
+        if ( fDbh >= mp_fDbhForReproduction[mp_iIndexes[iSp]] )
+          AddParent( p_oTree, fDbh, p_oPop, p_oPlot );
 
       }
 
       p_oTree = p_oAllTrees->NextTree();
     } //end of while (p_oTree)
+
+    //Disperse the parents' seeds
+    DisperseParents( p_oPop, p_oPlot );
   }
   catch ( modelErr & err )
   {
@@ -856,9 +857,9 @@ void clMastingSpatialDisperse::AddSeeds()
 }
 
 //////////////////////////////////////////////////////////////////////////////
-// DisperseOneParentSeeds
+// DisperseOneParent
 //////////////////////////////////////////////////////////////////////////////
-void clMastingSpatialDisperse::DisperseOneParentSeeds( clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh )
+void clMastingSpatialDisperse::DisperseOneParent( clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh, float * p_fSeeds, gsl_rng * p_oStream )
 {
   try
   {
@@ -867,7 +868,6 @@ void clMastingSpatialDisperse::DisperseOneParentSeeds( clTree * p_oTree, clTreeP
     fDistance, //distance from the parent tree at which a seed lands
     fPrevBucket, //value in the previous bucket of the probability array
     fX, fY, //coordinates of tree
-    fNumGridSeeds, //number of seeds in the seed grid
     fSeedX, fSeedY, //coordinates of seed
     fAngle, //angle from the parent tree from which a seed lands
     fNumSeeds, //number of seeds produced by the tree
@@ -878,13 +878,18 @@ void clMastingSpatialDisperse::DisperseOneParentSeeds( clTree * p_oTree, clTreeP
     iSpIndex = mp_iIndexes[iSp],
     iEvent = mp_iEvent[iSpIndex];
 
+    //A random number decides whether this tree participates
+    if ( clModelMath::GetRand( p_oStream ) >=
+         mp_fFractionParticipating[iEvent][iSpIndex] )
+      return;
+
     //Get the X and Y coords of the tree
     p_oTree->GetValue( p_oPop->GetXCode( iSp, iType ), & fX );
     p_oTree->GetValue( p_oPop->GetYCode( iSp, iType ), & fY );
 
     //Calculate number of seeds produced, based on species
     //fecundity and the dbh of the tree
-    fNumSeeds = (* this.*mp_GetSeeds[iSpIndex])( fDbh, iSp );
+    fNumSeeds = (* this.*mp_GetSeeds[iSpIndex])( fDbh, iSp, p_oStream );
 
     //Disperse the seeds produced
     for ( f = 0; f < fNumSeeds; f++ )
@@ -893,7 +898,7 @@ void clMastingSpatialDisperse::DisperseOneParentSeeds( clTree * p_oTree, clTreeP
       //parent tree the seed lands - use a random number and find the first
       //probability array bucket with a value greater than the random
       iDistanceCounter = 0;
-      fRand = clModelMath::GetRand();
+      fRand = clModelMath::GetRand( p_oStream );
       while ( fRand > mp_fSeedCDF[iEvent][iSpIndex][iDistanceCounter] )
         iDistanceCounter++;
 
@@ -905,7 +910,7 @@ void clMastingSpatialDisperse::DisperseOneParentSeeds( clTree * p_oTree, clTreeP
            / ( mp_fSeedCDF[iEvent][iSpIndex][iDistanceCounter] - fPrevBucket ) );
 
       //Get a random direction to pitch the seed
-      fRand = clModelMath::GetRand();
+      fRand = clModelMath::GetRand( p_oStream );
       fAngle = 2.0 * M_PI * fRand;
       fAngle = std::max(2.0 * M_PI * fRand, (2.0 * M_PI)-0.00001);
 
@@ -913,10 +918,8 @@ void clMastingSpatialDisperse::DisperseOneParentSeeds( clTree * p_oTree, clTreeP
       fSeedX = p_oPlot->CorrectX( cos( fAngle ) * fDistance + fX );
       fSeedY = p_oPlot->CorrectY( sin( fAngle ) * fDistance + fY );
 
-      //Increment the seed counter at the seed's location in the grid
-      mp_oSeedGrid->GetValueAtPoint( fSeedX, fSeedY, mp_iNumSeedsCode[iSp], & fNumGridSeeds );
-      fNumGridSeeds++;
-      mp_oSeedGrid->SetValueAtPoint( fSeedX, fSeedY, mp_iNumSeedsCode[iSp], fNumGridSeeds );
+      //Increment the seed counter at the seed's location in the buffer
+      AddSeedAtPoint( p_fSeeds, fSeedX, fSeedY, iSp );
     } //end of for (i = 0; i < iNumSeeds; i++)
   }
   catch ( modelErr & err )
@@ -931,7 +934,7 @@ void clMastingSpatialDisperse::DisperseOneParentSeeds( clTree * p_oTree, clTreeP
   {
     modelErr stcErr;
     stcErr.iErrorCode = UNKNOWN;
-    stcErr.sFunction = "clSpatialDisperse::DisperseOneParentSeeds" ;
+    stcErr.sFunction = "clMastingSpatialDisperse::DisperseOneParent" ;
     throw( stcErr );
   }
 }
@@ -1149,19 +1152,19 @@ void clMastingSpatialDisperse::DecideMast() {
 //////////////////////////////////////////////////////////////////////////////
 // GetNumberOfSeedsNoDraw
 ///////////////////////////////////////////////////////////////////////////////
-float clMastingSpatialDisperse::GetNumberOfSeedsNoDraw(const float &fDbh, const short int &iSp) {
+float clMastingSpatialDisperse::GetNumberOfSeedsNoDraw(const float &fDbh, const short int &iSp, gsl_rng *p_oStream) {
   return clModelMath::RandomRound( mp_fFecundity[mp_iIndexes[iSp]]
        * pow( fDbh, mp_fBeta[mp_iEvent[mp_iIndexes[iSp]]][mp_iIndexes[iSp]] )
-       * m_iNumYearsPerTimestep );
+       * m_iNumYearsPerTimestep, p_oStream );
 }
 
 
 //////////////////////////////////////////////////////////////////////////////
 // GetNumberOfSeedsDrawNormal
 ///////////////////////////////////////////////////////////////////////////////
-float clMastingSpatialDisperse::GetNumberOfSeedsDrawNormal(const float &fDbh, const short int &iSp) {
+float clMastingSpatialDisperse::GetNumberOfSeedsDrawNormal(const float &fDbh, const short int &iSp, gsl_rng *p_oStream) {
   float fSTR = mp_fStrMean[mp_iEvent[mp_iIndexes[iSp]]][mp_iIndexes[iSp]] +
-               clModelMath::NormalRandomDraw(mp_fStrStdDev[mp_iEvent[mp_iIndexes[iSp]]][mp_iIndexes[iSp]]);
+               clModelMath::NormalRandomDraw(mp_fStrStdDev[mp_iEvent[mp_iIndexes[iSp]]][mp_iIndexes[iSp]], p_oStream);
   return fSTR * m_iNumYearsPerTimestep *
         pow( (fDbh / 30), mp_fBeta[mp_iEvent[mp_iIndexes[iSp]]][mp_iIndexes[iSp]]);
 }
@@ -1169,10 +1172,10 @@ float clMastingSpatialDisperse::GetNumberOfSeedsDrawNormal(const float &fDbh, co
 //////////////////////////////////////////////////////////////////////////////
 // GetNumberOfSeedsDrawLognormal
 ///////////////////////////////////////////////////////////////////////////////
-float clMastingSpatialDisperse::GetNumberOfSeedsDrawLognormal(const float &fDbh, const short int &iSp) {
+float clMastingSpatialDisperse::GetNumberOfSeedsDrawLognormal(const float &fDbh, const short int &iSp, gsl_rng *p_oStream) {
   float fSTR = clModelMath::LognormalRandomDraw(
                 mp_fStrMean[mp_iEvent[mp_iIndexes[iSp]]][mp_iIndexes[iSp]],
-                mp_fStrStdDev[mp_iEvent[mp_iIndexes[iSp]]][mp_iIndexes[iSp]]);
+                mp_fStrStdDev[mp_iEvent[mp_iIndexes[iSp]]][mp_iIndexes[iSp]], p_oStream);
   return fSTR * m_iNumYearsPerTimestep *
         pow( (fDbh / 30), mp_fBeta[mp_iEvent[mp_iIndexes[iSp]]][mp_iIndexes[iSp]]);
 }
@@ -52,6 +52,9 @@ class clTree;
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Parents are dispersed through
+* clDisperseBase::DisperseParents(), in parallel from per-parent random
+* streams if di_parallelDispersal is set (agent)
 */
 class clMastingSpatialDisperse : virtual public clDisperseBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -179,7 +182,7 @@ friend class clTestMastingSpatialDisperse;
   char *m_cQuery;
 
   /**Define a type for pointers to functions of the GetNumberOfSeeds type*/
-  typedef float (clMastingSpatialDisperse::*Ptr2GetNumberOfSeeds)(const float &, const short int &);
+  typedef float (clMastingSpatialDisperse::*Ptr2GetNumberOfSeeds)(const float &, const short int &, gsl_rng *);
 
   /**Function pointer array for the appropriate function for calculating
   * the number of seeds.  Array size is number of species to which this behavior
@@ -243,7 +246,10 @@ friend class clTestMastingSpatialDisperse;
   void FormatQueryString(clTreePopulation *p_oPop);
 
   /**
-  * Performs dispersal of seeds for one tree. The number of seeds is calculated
+  * Performs dispersal of seeds for one tree. This is called by
+  * clDisperseBase::DisperseParents(). First, a random number is compared to
+  * the appropriate value in mp_fFractionParticipating to determine whether
+  * this tree will produce seeds. If so, the number of seeds is calculated
   * by using the pointer in mp_GetSeeds. Each seed is given a random azimuth
   * direction from the parent. Then each seed is given a random distance from
   * the parent that conforms to the chosen probability distribution function.
@@ -252,11 +258,13 @@ friend class clTestMastingSpatialDisperse;
   * value than the random number. Once the seed has an azimuth direction and
   * a distance, it is added to the species total in the appropriate grid cell.
   * @param p_oTree Tree for which to perform dispersal.
-  * @param fDbh DBH of the tree, in cm.
-  * @param p_oPlot Plot object
   * @param p_oPop Tree Population object
+  * @param p_oPlot Plot object
+  * @param fDbh DBH of the tree, in cm.
+  * @param p_fSeeds Seed buffer to add seeds to.
+  * @param p_oStream Random stream to draw from.
   */
-  void DisperseOneParentSeeds(clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh );
+  void DisperseOneParent(clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh, float * p_fSeeds, gsl_rng * p_oStream );
 
   /**
   * Extracts needed parameter file data. (Some parameters are extracted by
@@ -305,10 +313,9 @@ friend class clTestMastingSpatialDisperse;
   * Performs disperse. First, DecideMast() is called to determine which species
   * mast this timestep. Then, for any species with STRs that are drawn per
   * species, fecundity is calculated. Then this gets the group of trees to
-  * which this behavior applies. For each, a random number is compared to the
-  * appropriate value in mp_fFractionParticipating to determine whether this
-  * tree will produce seeds. That tree is passed to DisperseOneParentSeeds()
-  * for seed creation and distribution.
+  * which this behavior applies. Each tree big enough to reproduce is handed to
+  * clDisperseBase::AddParent() and DisperseParents(), which call
+  * DisperseOneParent() for seed creation and distribution.
   */
   void AddSeeds();
 
@@ -332,18 +339,20 @@ friend class clTestMastingSpatialDisperse;
    * Fecundity should have already been calculated.
    * @param fDbh DBH of the tree, in cm
    * @param iSp Tree species number
+   * @param p_oStream Random stream to draw from.
    * @return Number of seeds.
    */
-  float GetNumberOfSeedsNoDraw(const float &fDbh, const short int &iSp);
+  float GetNumberOfSeedsNoDraw(const float &fDbh, const short int &iSp, gsl_rng *p_oStream);
 
   /**
    * Gets the number of seeds for a tree when the tree needs a normal STR draw.
    * @htmlonly seeds = STR * (DBH / 30)<sup>&beta;</sup> @endhtmlonly
    * @param fDbh DBH of the tree, in cm
    * @param iSp Tree species number
+   * @param p_oStream Random stream to draw from.
    * @return Number of seeds.
    */
-  float GetNumberOfSeedsDrawNormal(const float &fDbh, const short int &iSp);
+  float GetNumberOfSeedsDrawNormal(const float &fDbh, const short int &iSp, gsl_rng *p_oStream);
 
   /**
    * Gets the number of seeds for a tree when the tree needs a lognormal STR
@@ -351,9 +360,10 @@ friend class clTestMastingSpatialDisperse;
    * @htmlonly seeds = STR * (DBH / 30)<sup>&beta;</sup> @endhtmlonly
    * @param fDbh DBH of the tree, in cm
    * @param iSp Tree species number
+   * @param p_oStream Random stream to draw from.
    * @return Number of seeds.
    */
-  float GetNumberOfSeedsDrawLognormal(const float &fDbh, const short int &iSp);
+  float GetNumberOfSeedsDrawLognormal(const float &fDbh, const short int &iSp, gsl_rng *p_oStream);
 };
 //---------------------------------------------------------------------------
 #endif
@@ -3,6 +3,8 @@
 //---------------------------------------------------------------------------
 #include "MerchValueCalculator.h"
 #include "TreePopulation.h"
+#include "TreeQuery.h"
+#include "TreeSearch.h"
 #include "SimManager.h"
 #include "ParsingFunctions.h"
 #include "Grid.h"
@@ -40,6 +42,11 @@ clMerchValueCalculator::clMerchValueCalculator( clSimManager * p_oSimManager ) :
     //member
     m_iNewTreeFloats = 1;
 
+    //Tree sizes go in; only this behavior's own data member and grid
+    //come out
+    m_iResourcesRead = tree_structure;
+    m_iResourcesWritten = own_tree_data | own_grid;
+
     m_iMaxLogs = 6;
     m_iDBHIncs = 16;
     m_iFormDBHIncs = 31;
@@ -55,7 +62,8 @@ clMerchValueCalculator::clMerchValueCalculator( clSimManager * p_oSimManager ) :
     mp_fFormClass81Table = NULL;
     mp_fFormClass84Table = NULL;
     mp_fFormClass85Table = NULL;
-    m_cQuery = NULL;
+    mp_oQuery = NULL;
+    mp_oSearch = NULL;
     mp_iMerchValCodes = NULL;
     mp_iValueCodes = NULL;
     mp_oValueGrid = NULL;
@@ -85,7 +93,8 @@ clMerchValueCalculator::~clMerchValueCalculator()
   int i;
 	delete[] mp_fVal;
   delete[] mp_fFormClass;
-  delete[] m_cQuery;
+  delete mp_oQuery;
+  delete mp_oSearch;
   delete[] mp_iValueCodes;
 
   if ( mp_iMerchValCodes )
@@ -227,7 +236,7 @@ void clMerchValueCalculator::GetData( xercesc::DOMDocument * p_oDoc )
     clTreePopulation * p_oPop = ( clTreePopulation * ) mp_oSimManager->GetPopulationObject( "treepopulation" );
 
     GetParameterFileData(p_oDoc, p_oPop);
-    FormatQueryString(p_oPop);
+    FormatQuery(p_oPop);
     PopulateTables();
     SetupGrid();
     Action();
@@ -390,7 +399,6 @@ void clMerchValueCalculator::Action()
   try
   {
     clTreePopulation * p_oPop = ( clTreePopulation * ) mp_oSimManager->GetPopulationObject( "treepopulation" );
-    clTreeSearch * p_oBehaviorTrees;
     clTree * p_oTree;
     float *p_fSpeciesTotals = new float[m_iNumTotalSpecies];
     float fValue, //tree's value
@@ -409,9 +417,9 @@ void clMerchValueCalculator::Action()
     }
 
     //Get the trees that apply to this behavior
-    p_oBehaviorTrees = p_oPop->Find( m_cQuery );
+    p_oPop->Find( *mp_oQuery, mp_oSearch );
 
-    p_oTree = p_oBehaviorTrees->NextTree();
+    p_oTree = mp_oSearch->NextTree();
     while ( p_oTree )
     {
 
@@ -437,7 +445,7 @@ void clMerchValueCalculator::Action()
         p_fSpeciesTotals[iSp] += fValue;
       }
 
-      p_oTree = p_oBehaviorTrees->NextTree();
+      p_oTree = mp_oSearch->NextTree();
     }
 
     //Set the species totals into our grid
@@ -465,65 +473,22 @@ void clMerchValueCalculator::Action()
 }
 
 ////////////////////////////////////////////////////////////////////////////
-// FormatQueryString()
+// FormatQuery()
 ////////////////////////////////////////////////////////////////////////////
-void clMerchValueCalculator::FormatQueryString(clTreePopulation *p_oPop)
+void clMerchValueCalculator::FormatQuery(clTreePopulation *p_oPop)
 {
-  char * cQueryTemp = new char[(p_oPop->GetNumberOfSpecies() * 4) + 50];
-  char cQueryPiece[5]; //for assembling the search query
   int i;
-  bool bSapling = false, bAdult = false, bSnag = false;
 
-  //Do a type/species search on all the types and species
-  strcpy( cQueryTemp, "species=" );
-  for ( i = 0; i < m_iNumBehaviorSpecies - 1; i++ )
-  {
-    sprintf( cQueryPiece, "%d%s", mp_iWhatSpecies[i], "," );
-    strcat( cQueryTemp, cQueryPiece );
-  }
-  sprintf( cQueryPiece, "%d", mp_iWhatSpecies[m_iNumBehaviorSpecies - 1] );
-  strcat( cQueryTemp, cQueryPiece );
+  delete mp_oQuery;
+  delete mp_oSearch;
+  mp_oQuery = new clTreeQuery(p_oPop);
+  mp_oSearch = new clTreeSearch(p_oPop);
 
-  //Find all the types
+  //Do a type/species search on all the types and species
+  for ( i = 0; i < m_iNumBehaviorSpecies; i++ )
+    mp_oQuery->AddSpecies( mp_iWhatSpecies[i] );
   for ( i = 0; i < m_iNumSpeciesTypeCombos; i++ )
-  {
-    if ( clTreePopulation::sapling == mp_whatSpeciesTypeCombos[i].iType )
-    {
-      bSapling = true;
-    }
-    else if ( clTreePopulation::adult == mp_whatSpeciesTypeCombos[i].iType )
-    {
-      bAdult = true;
-    }
-    else if ( clTreePopulation::snag == mp_whatSpeciesTypeCombos[i].iType )
-    {
-      bSnag = true;
-    }
-  }
-  strcat( cQueryTemp, "::type=" );
-  if ( bSapling )
-  {
-    sprintf( cQueryPiece, "%d%s", clTreePopulation::sapling, "," );
-    strcat( cQueryTemp, cQueryPiece );
-  }
-  if ( bAdult )
-  {
-    sprintf( cQueryPiece, "%d%s", clTreePopulation::adult, "," );
-    strcat( cQueryTemp, cQueryPiece );
-  }
-  if ( bSnag )
-  {
-    sprintf( cQueryPiece, "%d%s", clTreePopulation::snag, "," );
-    strcat( cQueryTemp, cQueryPiece );
-  }
-
-  //Remove the last comma
-  cQueryTemp[strlen( cQueryTemp ) - 1] = '\0';
-
-  //Now put it in m_cQuery, sized correctly
-  m_cQuery = new char[strlen( cQueryTemp ) + 1];
-  strcpy( m_cQuery, cQueryTemp );
-  delete[] cQueryTemp;
+    mp_oQuery->AddType( mp_whatSpeciesTypeCombos[i].iType );
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -7,6 +7,8 @@
 #include "BehaviorBase.h"
 
 class clGrid;
+class clTreeQuery;
+class clTreeSearch;
 
 /**
 * Merchantable Timber Value Calculator Version 1.0
@@ -319,6 +321,8 @@ class clGrid;
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Declared resources and switched to a search object of
+* its own so it can run alongside other behaviors (agent)
 */
 class clMerchValueCalculator : virtual public clBehaviorBase {
   public:
@@ -422,10 +426,14 @@ class clMerchValueCalculator : virtual public clBehaviorBase {
    * second index is m_iMaxLogs.*/
   float **mp_fFormClass85Table;
 
-  /**String to pass to clTreePopulation::Find() in order to get the trees for
-  * which to calculate volume.  This will instigate a species/type search for
-  * all the species and types to which this behavior applies.*/
-  char *m_cQuery;
+  /**Query to pass to clTreePopulation::Find() in order to get the trees for
+  * which to calculate volume.  This is a species/type search for all the
+  * species and types to which this behavior applies.*/
+  clTreeQuery *mp_oQuery;
+
+  /**Search object for the trees.  This behavior owns it rather than using the
+  * population's pooled searches, so it can run alongside other behaviors.*/
+  clTreeSearch *mp_oSearch;
 
   /**Holds data member codes for "Merch Val" float data member.  First array
   * index is total # species, second is number types (3 - sapling, adult,
@@ -500,11 +508,11 @@ class clMerchValueCalculator : virtual public clBehaviorBase {
   void GetParameterFileData(xercesc::DOMDocument *p_oDoc, clTreePopulation *p_oPop);
 
   /**
-  * Formats the string in m_cQuery.  This value will be used in Action() to
+  * Builds mp_oQuery and mp_oSearch.  The query will be used in Action() to
   * pass to clTreePopulation::Find() in order to get the trees to act on.
   * @param p_oPop Tree population object.
   */
-  void FormatQueryString(clTreePopulation *p_oPop);
+  void FormatQuery(clTreePopulation *p_oPop);
 
   /**
   * Populates the taper and form class board feet tables.  The table arrays are
@@ -29,6 +29,9 @@ clMortalityBase::clMortalityBase(clSimManager *p_oSimManager) :
 
   mp_bUsesThisMortality = NULL;
   m_iNumTotalSpecies = 0;
+
+  //Shells must opt in to parallel evaluation
+  m_bThreadSafe = false;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -90,6 +93,8 @@ void clMortalityBase::PopulateUsesThisMortality() {
 // GetData()
 /////////////////////////////////////////////////////////////////////////////*/
 void clMortalityBase::GetData(xercesc::DOMDocument *p_oDoc) {
+  if (m_bHooked)
+    mp_oMortalityOrg->GetParameterFileData(p_oDoc);
   DoShellSetup(p_oDoc);
 }
 
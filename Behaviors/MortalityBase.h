@@ -4,6 +4,7 @@
 #define MortalityBaseH
 //---------------------------------------------------------------------------
 #include "BehaviorBase.h"
+#include <gsl/gsl_rng.h>
 
 class clTree;
 class clMortalityOrg;
@@ -40,6 +41,7 @@ using namespace whyDead;
 * <br>April 5, 2005 - Added a pre-calculation stage for the sake of NCI (LEM)
 * <br>February 8, 2008 - Changed mortality flags from simple booleans to reason
 * codes (LEM)
+* <br>October 17, 2026 - Added m_bThreadSafe and DoThreadSafeMort() (agent)
 */
 class clMortalityBase : virtual public clBehaviorBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -81,6 +83,23 @@ class clMortalityBase : virtual public clBehaviorBase {
   */
   virtual deadCode DoMort(clTree *p_oTree, const float &fDbh, const short int &iSpecies) = 0;
 
+  /**
+  * Determines whether or not a tree dies, for shells that have set
+  * m_bThreadSafe, when two-phase mortality is turned on.  clMortalityOrg
+  * calls this instead of DoMort() for those shells, possibly for many trees at once from different threads.  Any
+  * random numbers must come from p_oStream, which has been keyed to this
+  * shell, the tree, and the timestep.  The default just calls DoMort().
+  *
+  * @param p_oTree Tree being evaluated.  It must not be modified.
+  * @param fDbh DBH of tree being evaluated - for seedlings will be 0
+  * @param iSpecies Species of the tree being evaluated
+  * @param p_oStream Random stream to draw from.
+  * @return Why the tree is dead (including the code meaning "not dead").
+  */
+  virtual deadCode DoThreadSafeMort(clTree *p_oTree, const float &fDbh,
+      const short int &iSpecies, gsl_rng *p_oStream)
+      {return DoMort(p_oTree, fDbh, iSpecies);};
+
   /**
   * Gets the mortality org object.
   * @return Mortality org object.
@@ -136,6 +155,14 @@ class clMortalityBase : virtual public clBehaviorBase {
   bool **mp_bUsesThisMortality; /**<2D array, species by type, of whether or not
                  this mortality shell applies to a given species/type combo.*/
 
+  /**Whether or not this shell can evaluate many trees at once from different
+  * threads.  To set this to true, DoThreadSafeMort() must read nothing but the
+  * tree passed, its neighbors as they were before this mortality step, the
+  * shell's own parameters, and values calculated in PreMortCalcs(); it must
+  * not write to any tree or member variable, and must draw random numbers only
+  * from the stream it is given.  This defaults to false.*/
+  bool m_bThreadSafe;
+
   /**
   * Triggers all mortality setup.
   * This will be the same for all descendent classes.  If a particular object
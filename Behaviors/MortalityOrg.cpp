@@ -3,7 +3,11 @@
 #include "SimManager.h"
 #include "MortalityBase.h"
 #include "TreePopulation.h"
+#include "ModelMath.h"
+#include "ParsingFunctions.h"
+#include "TaskPool.h"
 #include <stdio.h>
+#include <string.h>
 #include <fstream>
 
 //////////////////////////////////////////////////////////////////////////////
@@ -14,7 +18,16 @@ clMortalityOrg::clMortalityOrg(clMortalityBase *p_oHookedShell) {
   mp_oMortShellList = NULL;
   mp_iDeadCodes = NULL;
   mp_bUsesMortality = NULL;
+  mp_bPrecalculate = NULL;
+  mp_iShellIndex = NULL;
+  mp_oBufferTrees = NULL;
+  mp_iBufferDead = NULL;
+  mp_oStreams = NULL;
   mp_oPop = NULL;
+  mp_oSimManager = NULL;
+  m_bTwoPhase = false;
+  m_iBufferSize = 0;
+  m_iNumStreams = 0;
 
   m_iTotalSpecies = 0;
   m_iTotalTypes = 0;
@@ -50,9 +63,22 @@ clMortalityOrg::~clMortalityOrg() {
       delete[] mp_iDeadCodes[i];
     }
   }
+  if (mp_bPrecalculate) {
+    for (i = 0; i < m_iTotalSpecies; i++) {
+      delete[] mp_bPrecalculate[i];
+    }
+  }
+  for (i = 0; i < m_iNumStreams; i++) {
+    gsl_rng_free(mp_oStreams[i]);
+  }
   delete[] mp_bUsesMortality;
   delete[] mp_iDeadCodes;
   delete[] mp_oMortShellList;
+  delete[] mp_bPrecalculate;
+  delete[] mp_iShellIndex;
+  delete[] mp_oBufferTrees;
+  delete[] mp_iBufferDead;
+  delete[] mp_oStreams;
 }
 
 //////////////////////////////////////////////////////////////////////////////
@@ -63,6 +89,7 @@ void clMortalityOrg::UpdateDataMemberRegistrations(clSimManager *p_oSimManager,
   short int i, j, iNumCombos = 0;
 
   //Get the tree population object, and from it the numbers of species and types
+  mp_oSimManager = p_oSimManager;
   mp_oPop = (clTreePopulation*) p_oSimManager->GetPopulationObject("treepopulation");
 
   m_iTotalSpecies = mp_oPop->GetNumberOfSpecies();
@@ -78,6 +105,7 @@ void clMortalityOrg::UpdateDataMemberRegistrations(clSimManager *p_oSimManager,
 
   //Populate the table of species/type combos that use any kind of mortality
   PopulateUsesMortality();
+  PopulatePrecalculate();
 
   //Clear the existing list of species/type combos from the hooked mortality object
   delete[] p_oHooked->mp_whatSpeciesTypeCombos;
@@ -186,6 +214,7 @@ void clMortalityOrg::AssembleMortShellList(clSimManager *p_oSimManager) {
 
   //Declare the list array
   mp_oMortShellList = new clMortalityBase*[m_iNumMortShells];
+  mp_iShellIndex = new short int[m_iNumMortShells];
   for (i = 0; i < m_iNumMortShells; i++)
     mp_oMortShellList[i] = NULL;
 
@@ -200,6 +229,7 @@ void clMortalityOrg::AssembleMortShellList(clSimManager *p_oSimManager) {
       p_oMortShell = dynamic_cast<clMortalityBase*>(p_oTempBehavior);
 
       mp_oMortShellList[j] = p_oMortShell;
+      mp_iShellIndex[j] = i;
       j++;
     } //end of if (NULL != strstr(cBehaviorName, cShellMarker))
   } //end of for (i = 0; i < iNumBehaviors; i++)
@@ -232,6 +262,84 @@ void clMortalityOrg::PopulateUsesMortality() {
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// GetParameterFileData()
+//////////////////////////////////////////////////////////////////////////////
+void clMortalityOrg::GetParameterFileData(xercesc::DOMDocument *p_oDoc) {
+  //Two-phase mortality - optional, and off unless asked for
+  m_bTwoPhase = false;
+  FillSingleValue(p_oDoc->getDocumentElement(), "mo_twoPhaseMortality",
+      &m_bTwoPhase, false);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// PopulatePrecalculate()
+//////////////////////////////////////////////////////////////////////////////
+void clMortalityOrg::PopulatePrecalculate() {
+  short int i, j, k; //loop counters
+
+  mp_bPrecalculate = new bool*[m_iTotalSpecies];
+  for (i = 0; i < m_iTotalSpecies; i++) {
+    mp_bPrecalculate[i] = new bool[m_iTotalTypes];
+    for (j = 0; j < m_iTotalTypes; j++) {
+      mp_bPrecalculate[i][j] = mp_bUsesMortality[i][j];
+      for (k = 0; k < m_iNumMortShells; k++)
+        if (mp_oMortShellList[k]->mp_bUsesThisMortality[i][j] &&
+            !mp_oMortShellList[k]->m_bThreadSafe)
+          mp_bPrecalculate[i][j] = false;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ReserveBuffers()
+//////////////////////////////////////////////////////////////////////////////
+void clMortalityOrg::ReserveBuffers(int iNumTrees) {
+  clTree **p_oOldTrees = mp_oBufferTrees;
+  int i;
+
+  if (iNumTrees <= m_iBufferSize) return;
+
+  delete[] mp_iBufferDead;
+
+  //Leave some room so a growing population doesn't reallocate every time
+  m_iBufferSize = iNumTrees + iNumTrees / 4 + 1;
+  mp_oBufferTrees = new clTree*[m_iBufferSize];
+  for (i = 0; i < iNumTrees - 1; i++) mp_oBufferTrees[i] = p_oOldTrees[i];
+  delete[] p_oOldTrees;
+  mp_iBufferDead = new int[m_iBufferSize];
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// RunGauntlet()
+//////////////////////////////////////////////////////////////////////////////
+int clMortalityOrg::RunGauntlet(clTree *p_oTree, gsl_rng *p_oStream) {
+  clMortalityBase *p_oShell;
+  float fDbh;                   //dbh of tree (0 for seedlings)
+  int iDeadCode;                //value for "dead" data member
+  short int iSp = p_oTree->GetSpecies(), iType = p_oTree->GetType(), i;
+
+  if (iType == clTreePopulation::seedling)
+    fDbh = 0;
+  else
+    p_oTree->GetValue(mp_oPop->GetDbhCode(iSp, iType), &fDbh);
+
+  p_oTree->GetValue(mp_iDeadCodes[iSp][iType], &iDeadCode);
+  for (i = 0; i < m_iNumMortShells; i++) {
+    p_oShell = mp_oMortShellList[i];
+    if (iDeadCode == notdead && p_oShell->mp_bUsesThisMortality[iSp][iType]) {
+      if (p_oShell->m_bThreadSafe) {
+        clModelMath::SetRandomStream(p_oStream,
+            mp_oSimManager->GetCurrentTimestep(), mp_iShellIndex[i],
+            mp_oPop->GetStreamKey(p_oTree));
+        iDeadCode = p_oShell->DoThreadSafeMort(p_oTree, fDbh, iSp, p_oStream);
+      }
+      else iDeadCode = p_oShell->DoMort(p_oTree, fDbh, iSp);
+    }
+  }
+  return iDeadCode;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // DoMortality()
 //////////////////////////////////////////////////////////////////////////////
@@ -251,6 +359,11 @@ void clMortalityOrg::DoMortality() {
   //Ask the tree population to find all trees
   p_oAllTrees = mp_oPop->Find("all");
 
+  if (m_bTwoPhase) {
+    DoTwoPhaseMortality(p_oAllTrees);
+    return;
+  }
+
   //Go through the trees one at a time
   p_oTree = p_oAllTrees->NextTree();
   while (p_oTree) {
@@ -280,3 +393,62 @@ void clMortalityOrg::DoMortality() {
     p_oTree = p_oAllTrees->NextTree();
   } //end of while (p_oTree)
 }
+
+//////////////////////////////////////////////////////////////////////////////
+// stcCalcMort::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clMortalityOrg::stcCalcMort::operator()(int i) {
+  clTree *p_oTree = p_oOrg->mp_oBufferTrees[i];
+
+  p_oOrg->mp_iBufferDead[i] = -1;
+  if (p_oOrg->mp_bPrecalculate[p_oTree->GetSpecies()][p_oTree->GetType()])
+    p_oOrg->mp_iBufferDead[i] = p_oOrg->RunGauntlet(p_oTree,
+        p_oOrg->mp_oStreams[clTaskPool::GetThreadNumber()]);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// DoTwoPhaseMortality()
+//////////////////////////////////////////////////////////////////////////////
+void clMortalityOrg::DoTwoPhaseMortality(clTreeSearch *p_oAllTrees) {
+  clTaskPool *p_oTaskPool = mp_oSimManager->GetTaskPool();
+  clTree *p_oTree;              //for working with a single tree
+  stcCalcMort stcCalc;          //for evaluating trees ahead of time
+  int iNumTrees = 0, iNumThreads = p_oTaskPool->GetNumThreads(), i;
+
+  //Collect the trees
+  p_oTree = p_oAllTrees->NextTree();
+  while (p_oTree) {
+    ReserveBuffers(iNumTrees + 1);
+    mp_oBufferTrees[iNumTrees] = p_oTree;
+    iNumTrees++;
+    p_oTree = p_oAllTrees->NextTree();
+  }
+
+  //Make sure there's a random stream for each thread
+  if (iNumThreads > m_iNumStreams) {
+    for (i = 0; i < m_iNumStreams; i++) gsl_rng_free(mp_oStreams[i]);
+    delete[] mp_oStreams;
+    mp_oStreams = new gsl_rng*[iNumThreads];
+    for (i = 0; i < iNumThreads; i++)
+      mp_oStreams[i] = clModelMath::NewRandomStream();
+    m_iNumStreams = iNumThreads;
+  }
+
+  //Evaluate every tree whose shells are all thread-safe.  Nothing is written
+  //to the trees yet.
+  stcCalc.p_oOrg = this;
+  p_oTaskPool->ParallelFor(0, iNumTrees, stcCalc, 256);
+
+  //Write the results in tree order, running the gauntlet now for trees that
+  //use shells that aren't thread-safe
+  for (i = 0; i < iNumTrees; i++) {
+    p_oTree = mp_oBufferTrees[i];
+    if (-1 == mp_iBufferDead[i]) {
+      if (!mp_bUsesMortality[p_oTree->GetSpecies()][p_oTree->GetType()])
+        continue;
+      mp_iBufferDead[i] = RunGauntlet(p_oTree, mp_oStreams[0]);
+    }
+    p_oTree->SetValue(mp_iDeadCodes[p_oTree->GetSpecies()][p_oTree->GetType()],
+        mp_iBufferDead[i]);
+  }
+}
@@ -4,10 +4,16 @@
 #define MortalityOrgH
 //---------------------------------------------------------------------------
 
+#include <xercesc/dom/DOM.hpp>
+#include <gsl/gsl_rng.h>
+
 class clMortalityBase;
 class DOMDocument;
 class clSimManager;
 class clTreePopulation;
+class clTree;
+class clTreeSearch;
+class clTaskPool;
 
 /**
 * Mortality org - Version 1.1
@@ -32,6 +38,13 @@ class clTreePopulation;
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Trees whose shells are all thread-safe are evaluated
+* ahead of time, in parallel where available (agent)
+* <br>October 17, 2026 - Two-phase mortality is turned on by the optional
+* mo_twoPhaseMortality parameter; random streams are keyed by tree location
+* (agent)
+* <br>October 17, 2026 - Moved GetStreamKey() to clTreePopulation (agent)
+* <br>October 17, 2026 - Two-phase mortality runs on the task pool (agent)
 */
 class clMortalityOrg {
   public:
@@ -55,6 +68,23 @@ class clMortalityOrg {
   * bucket in mp_bUsesMortality is set to true, then the tree goes through the
   * gauntlet.  This should be called each timestep by the hooked shell's
   * Action() function.
+  *
+  * If the parameter file turns on two-phase mortality, this happens in two
+  * phases.  The trees are collected, and every tree whose
+  * species/type combo uses only thread-safe shells runs the gauntlet against
+  * the pre-mortality state, with the results held in a buffer instead of
+  * written to the trees.  The trees are split among the task pool's threads
+  * (see clTaskPool) in runs of consecutive trees, which are grouped by hash
+  * table cell.
+  * Then the trees are visited in their original order and the buffered results
+  * written; trees with shells that aren't thread-safe run the gauntlet at that
+  * point, as they otherwise would.  Thread-safe shells (see
+  * clMortalityBase::m_bThreadSafe) draw their random numbers from streams
+  * keyed to the shell, the tree's location, and the timestep (see
+  * clModelMath::SetRandomStream()), so the results do not depend on the
+  * number of threads or on which other trees exist.  Because these draws
+  * differ from the shared generator's, two-phase mortality must be asked
+  * for; otherwise every shell uses DoMort() and runs are as before.
   */
   void DoMortality();
 
@@ -108,6 +138,14 @@ class clMortalityOrg {
   */
   void UpdateDataMemberRegistrations(clSimManager *p_oSimManager, clMortalityBase *p_oHooked);
 
+  /**
+  * Reads the optional mo_twoPhaseMortality flag, which turns on two-phase
+  * mortality; it is off if missing.  This is called by the hooked object's
+  * GetData() function.
+  * @param p_oDoc Parsed parameter file.
+  */
+  void GetParameterFileData(xercesc::DOMDocument *p_oDoc);
+
   /**
   * Gets a particular mortality shell.
   *
@@ -119,6 +157,20 @@ class clMortalityOrg {
 
 protected:
 
+  /**
+  * Runs one tree in mp_oBufferTrees through the gauntlet ahead of time, if
+  * its shells are all thread-safe, and puts the result in mp_iBufferDead.
+  * This is handed to clTaskPool::ParallelFor().
+  */
+  struct stcCalcMort {
+    clMortalityOrg *p_oOrg; /**<Mortality org object doing the calculating*/
+    /**
+    * Evaluates one tree.
+    * @param i Tree's index in mp_oBufferTrees.
+    */
+    void operator()(int i);
+  };
+
   /**Stashed pointer to the tree population object*/
   clTreePopulation *mp_oPop;
 
@@ -145,6 +197,38 @@ protected:
   gauntlet.*/
   bool **mp_bUsesMortality;
 
+  /**Simulation manager.*/
+  clSimManager *mp_oSimManager;
+
+  /**Index in the behavior list of each shell in mp_oMortShellList, for keying
+  * random streams.*/
+  short int *mp_iShellIndex;
+
+  /**2-D array - species by type - of whether or not a species/type combo uses
+  * mortality and all of the shells it uses are thread-safe.*/
+  bool **mp_bPrecalculate;
+
+  /**Whether or not to do two-phase mortality, from the optional
+  * mo_twoPhaseMortality parameter.  If not, trees go through the gauntlet
+  * one at a time.*/
+  bool m_bTwoPhase;
+
+  /**Trees collected for two-phase mortality.  Array size is m_iBufferSize.*/
+  clTree **mp_oBufferTrees;
+
+  /**Dead code result for each tree in mp_oBufferTrees, or -1 if the tree
+  * still has to run the gauntlet.*/
+  int *mp_iBufferDead;
+
+  /**Size of the two-phase mortality buffers.*/
+  int m_iBufferSize;
+
+  /**One random stream per thread.  Array size is m_iNumStreams.*/
+  gsl_rng **mp_oStreams;
+
+  /**Number of random streams.*/
+  int m_iNumStreams;
+
   /**
   * Populates the mortality shell array with the appropriate behavior
   * pointers.  It does this by going through the behaviors and looking for the
@@ -161,6 +245,35 @@ protected:
   * mp_bUsesMortality to true.
   */
   void PopulateUsesMortality();
+
+  /**
+  * Populates mp_bPrecalculate.
+  */
+  void PopulatePrecalculate();
+
+  /**
+  * Does two-phase mortality for DoMortality().
+  * @param p_oAllTrees Search for all trees.
+  */
+  void DoTwoPhaseMortality(clTreeSearch *p_oAllTrees);
+
+  /**
+  * Runs one tree through the mortality gauntlet for two-phase mortality,
+  * without changing it.  Thread-safe shells get DoThreadSafeMort() with
+  * p_oStream keyed to them and the tree; others get DoMort().
+  * @param p_oTree Tree to evaluate.
+  * @param p_oStream Random stream for this thread.
+  * @return Tree's dead code.
+  */
+  int RunGauntlet(clTree *p_oTree, gsl_rng *p_oStream);
+
+  /**
+  * Makes sure the two-phase mortality buffers can hold a certain number of
+  * trees.  This is called as trees are collected, so the trees already in
+  * mp_oBufferTrees are kept.
+  * @param iNumTrees Number of trees; all but the last are already collected.
+  */
+  void ReserveBuffers(int iNumTrees);
 };
 //---------------------------------------------------------------------------
 #endif
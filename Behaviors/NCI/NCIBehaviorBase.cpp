@@ -85,6 +85,46 @@ clNCIBehaviorBase::~clNCIBehaviorBase() {
   delete mp_oInfectionEffect;
 }
 
+////////////////////////////////////////////////////////////////////////////
+// GetMaxCrowdingRadius()
+////////////////////////////////////////////////////////////////////////////
+float clNCIBehaviorBase::GetMaxCrowdingRadius(DOMElement * p_oElement) {
+  const char *cTags[] = {"nciMaxCrowdingRadius", "nciMaxAdultCrowdingRadius",
+                         "nciMaxSaplingCrowdingRadius"};
+  DOMNodeList *p_oNodeList;
+  DOMNode *p_oNode, *p_oValue;
+  XMLCh *sVal;
+  char *cData;
+  float fRadius, fMaxRadius = 0;
+  int i;
+
+  for (i = 0; i < 3; i++) {
+    sVal = XMLString::transcode(cTags[i]);
+    p_oNodeList = p_oElement->getElementsByTagName(sVal);
+    XMLString::release(&sVal);
+    if (0 == p_oNodeList->getLength()) continue;
+
+    //The value is either the tag's own text or the text of each species
+    //sub-tag
+    p_oNode = p_oNodeList->item(0)->getFirstChild();
+    while (p_oNode) {
+      p_oValue = NULL;
+      if (DOMNode::TEXT_NODE == p_oNode->getNodeType())
+        p_oValue = p_oNode;
+      else if (DOMNode::ELEMENT_NODE == p_oNode->getNodeType())
+        p_oValue = p_oNode->getFirstChild();
+      if (p_oValue) {
+        cData = XMLString::transcode(p_oValue->getNodeValue());
+        fRadius = atof(cData);
+        delete[] cData; cData = NULL;
+        if (fRadius > fMaxRadius) fMaxRadius = fRadius;
+      }
+      p_oNode = p_oNode->getNextSibling();
+    }
+  }
+  return fMaxRadius;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // ReadParameterFile()
 ////////////////////////////////////////////////////////////////////////////
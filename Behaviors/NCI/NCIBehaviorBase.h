@@ -31,6 +31,7 @@ class clInfectionEffectBase;
 * <br>Edit history:
 * <br>-----------------
 * <br>December 18, 2013: Created (LEM)
+* <br>October 17, 2026: Added GetMaxCrowdingRadius() (agent)
 */
 class clNCIBehaviorBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -120,6 +121,18 @@ class clNCIBehaviorBase {
                          clBehaviorBase *p_oNCI,
                          bool bUsingDiam);
 
+  /**
+  * Gets the largest crowding radius in the parameter file, whatever NCI term
+  * it belongs to. This looks at nciMaxCrowdingRadius,
+  * nciMaxAdultCrowdingRadius, and nciMaxSaplingCrowdingRadius, whether they
+  * hold a single value or a value per species. Missing tags are skipped.
+  * This is for choosing the tree population's hash table cell size before
+  * the NCI term has been set up.
+  * @param p_oElement Parent element for this behavior.
+  * @return Largest crowding radius, or 0 if there is none.
+  */
+  float GetMaxCrowdingRadius(xercesc::DOMElement * p_oElement);
+
 };
 //---------------------------------------------------------------------------
 #endif
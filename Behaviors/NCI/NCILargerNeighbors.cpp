@@ -68,7 +68,7 @@ clNCITermBase::ncivals clNCILargerNeighbors::CalculateNCITerm(clTree * p_oTree,
           fNeighDbh > fTargetDbh) {
 
         //Make sure the neighbor's not dead
-        iDeadCode = p_oPop->GetIntDataCode( "dead", iNeighSpecies, iNeighType );
+        iDeadCode = p_oPop->GetDeadCodes()[iNeighSpecies][iNeighType];
         if ( -1 != iDeadCode )  p_oNeighbor->GetValue( iDeadCode, & iIsDead );
         else iIsDead = notdead;
 
@@ -78,7 +78,7 @@ clNCITermBase::ncivals clNCINeighborBA::CalculateNCITerm(clTree * p_oTree, clTre
         {
 
           //Make sure the neighbor's not dead
-          iDeadCode = p_oPop->GetIntDataCode( "dead", iNeighSpecies, iNeighType );
+          iDeadCode = p_oPop->GetDeadCodes()[iNeighSpecies][iNeighType];
           if ( -1 != iDeadCode )
           {
             p_oNeighbor->GetValue( iDeadCode, & iIsDead );
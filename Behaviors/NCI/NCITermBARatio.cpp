@@ -1,15 +1,18 @@
 #include "NCITermBARatio.h"
 #include "TreePopulation.h"
+#include "TreeQuery.h"
+#include "TreeSearch.h"
 #include "Plot.h"
 #include "BehaviorBase.h"
 #include "ParsingFunctions.h"
-#include <sstream>
 #include <math.h>
 
 //////////////////////////////////////////////////////////////////////////////
 // Constructor
 //////////////////////////////////////////////////////////////////////////////
 clNCITermBARatio::clNCITermBARatio() {
+  mp_oNeighborQuery = NULL;
+  mp_oNeighborSearch = NULL;
   mp_fMaxSaplingRadius = NULL;
   mp_fMaxAdultRadius = NULL;
   mp_fMaxCrowdingRadius = NULL;
@@ -23,6 +26,8 @@ clNCITermBARatio::clNCITermBARatio() {
 // Destructor
 //////////////////////////////////////////////////////////////////////////////
 clNCITermBARatio::~clNCITermBARatio() {
+  delete mp_oNeighborQuery;
+  delete mp_oNeighborSearch;
   delete[] mp_fMaxSaplingRadius;
   delete[] mp_fMaxAdultRadius;
   delete[] mp_fMaxCrowdingRadius;
@@ -36,7 +41,6 @@ clNCITermBase::ncivals clNCITermBARatio::CalculateNCITerm(clTree * p_oTree, clTr
   clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
   clTree * p_oNeighbor; //competing neighbor
   ncivals toReturn;
-  std::stringstream sQuery; //format search strings into this
   float fNeighDbh, //neighbor's dbh
         fNeighBA,
         fTotBA = 0,
@@ -55,9 +59,9 @@ clNCITermBase::ncivals clNCITermBARatio::CalculateNCITerm(clTree * p_oTree, clTr
 
   //Get all trees taller than seedlings within the max crowding radius -
   //seedlings don't compete
-  sQuery << "distance=" << mp_fMaxCrowdingRadius[iSpecies] << "FROM x="
-         << fX << "y=" << fY << "::height=" << m_fMinSaplingHeight;
-  p_oAllNeighbors = p_oPop->Find(sQuery.str());
+  mp_oNeighborQuery->SetDistanceHeight(mp_fMaxCrowdingRadius[iSpecies], m_fMinSaplingHeight, fX, fY);
+  p_oPop->Find(*mp_oNeighborQuery, mp_oNeighborSearch);
+  p_oAllNeighbors = mp_oNeighborSearch;
 
   //Loop through and assess the competitive effects of each
   p_oNeighbor = p_oAllNeighbors->NextTree();
@@ -85,7 +89,7 @@ clNCITermBase::ncivals clNCITermBARatio::CalculateNCITerm(clTree * p_oTree, clTr
       goto nextTree;
 
     //Make sure the neighbor's not dead
-    iDeadCode = p_oPop->GetIntDataCode( "dead", iNeighSpecies, iNeighType );
+    iDeadCode = p_oPop->GetDeadCodes()[iNeighSpecies][iNeighType];
     if ( -1 != iDeadCode )  p_oNeighbor->GetValue( iDeadCode, & iIsDead );
     else iIsDead = notdead;
 
@@ -122,6 +126,8 @@ void clNCITermBARatio::DoSetup(clTreePopulation *p_oPop, clBehaviorBase *p_oNCI,
       iNumTotalSpecies = p_oPop->GetNumberOfSpecies(),
       i;
 
+  mp_oNeighborQuery = new clTreeQuery(p_oPop);
+  mp_oNeighborSearch = new clTreeSearch(p_oPop);
   //Make sure this is only applied to saplings and bigger
   for (i = 0; i < p_oNCI->GetNumSpeciesTypeCombos(); i++) {
     if (p_oNCI->GetSpeciesTypeCombo(i).iType == clTreePopulation::seedling) {
@@ -3,6 +3,9 @@
 
 #include "NCITermBase.h"
 
+class clTreeQuery;
+class clTreeSearch;
+
 /**
  * This calculates a basal area ratio for a tree.
  *
@@ -52,6 +55,14 @@ public:
 
 protected:
 
+  /**Neighbor search query, built once in DoSetup() and re-aimed at each
+   * target tree's location.*/
+  clTreeQuery *mp_oNeighborQuery;
+
+  /**Neighbor search, re-armed with mp_oNeighborQuery for each target tree so
+   * that no new search objects pile up during a timestep.*/
+  clTreeSearch *mp_oNeighborSearch;
+
   /**Maximum search radius, in meters, in which to look for
    * neighbors. Array is sized number of species.*/
   double *mp_fMaxCrowdingRadius;
@@ -1,15 +1,18 @@
 #include "NCITermBARatioDBHDefault.h"
 #include "TreePopulation.h"
+#include "TreeQuery.h"
+#include "TreeSearch.h"
 #include "Plot.h"
 #include "BehaviorBase.h"
 #include "ParsingFunctions.h"
-#include <sstream>
 #include <math.h>
 
 //////////////////////////////////////////////////////////////////////////////
 // Constructor
 //////////////////////////////////////////////////////////////////////////////
 clNCITermBARatioDBHDefault::clNCITermBARatioDBHDefault() {
+  mp_oNeighborQuery = NULL;
+  mp_oNeighborSearch = NULL;
   m_fMaxSaplingRadius = 0;
   m_fMaxAdultRadius = 0;
   m_fMaxCrowdingRadius = 0;
@@ -19,6 +22,14 @@ clNCITermBARatioDBHDefault::clNCITermBARatioDBHDefault() {
   iNumNCIs = 2;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// Destructor
+//////////////////////////////////////////////////////////////////////////////
+clNCITermBARatioDBHDefault::~clNCITermBARatioDBHDefault() {
+  delete mp_oNeighborQuery;
+  delete mp_oNeighborSearch;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // CalculateNCITerm
 //////////////////////////////////////////////////////////////////////////////
@@ -27,7 +38,6 @@ clNCITermBase::ncivals clNCITermBARatioDBHDefault::CalculateNCITerm(clTree * p_o
   clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
   clTree * p_oNeighbor; //competing neighbor
   ncivals toReturn;
-  std::stringstream sQuery; //format search strings into this
   float fNeighDbh, //neighbor's dbh
         fNeighBA,
         fTotBA = 0,
@@ -43,9 +53,9 @@ clNCITermBase::ncivals clNCITermBARatioDBHDefault::CalculateNCITerm(clTree * p_o
 
   //Get all trees taller than seedlings within the max crowding radius -
   //seedlings don't compete
-  sQuery << "distance=" << m_fMaxCrowdingRadius << "FROM x="
-         << fX << "y=" << fY << "::height=" << m_fMinSaplingHeight;
-  p_oAllNeighbors = p_oPop->Find(sQuery.str());
+  mp_oNeighborQuery->SetDistanceHeight(m_fMaxCrowdingRadius, m_fMinSaplingHeight, fX, fY);
+  p_oPop->Find(*mp_oNeighborQuery, mp_oNeighborSearch);
+  p_oAllNeighbors = mp_oNeighborSearch;
 
   //Loop through and assess the competitive effects of each
   p_oNeighbor = p_oAllNeighbors->NextTree();
@@ -73,7 +83,7 @@ clNCITermBase::ncivals clNCITermBARatioDBHDefault::CalculateNCITerm(clTree * p_o
       goto nextTree;
 
     //Make sure the neighbor's not dead
-    iDeadCode = p_oPop->GetIntDataCode( "dead", iNeighSpecies, iNeighType );
+    iDeadCode = p_oPop->GetDeadCodes()[iNeighSpecies][iNeighType];
     if ( -1 != iDeadCode )  p_oNeighbor->GetValue( iDeadCode, & iIsDead );
     else iIsDead = notdead;
 
@@ -109,6 +119,8 @@ void clNCITermBARatioDBHDefault::DoSetup(clTreePopulation *p_oPop, clBehaviorBas
   int iNumTotalSpecies = p_oPop->GetNumberOfSpecies(),
       i;
 
+  mp_oNeighborQuery = new clTreeQuery(p_oPop);
+  mp_oNeighborSearch = new clTreeSearch(p_oPop);
   //Get the default DBH
   FillSingleValue(p_oElement, "nciBADefaultDBH", &m_fDefaultBA, true);
   //Calculate the BA
@@ -3,6 +3,9 @@
 
 #include "NCITermBase.h"
 
+class clTreeQuery;
+class clTreeSearch;
+
 /**
  * This calculates a basal area ratio for a tree, using a single default value
  * for target tree size.
@@ -28,9 +31,9 @@ public:
   clNCITermBARatioDBHDefault();
 
   /**
-   * Destructor. Not needed.
+   * Destructor.
    */
-  //~clNCITermBARatioDBHDefault();
+  ~clNCITermBARatioDBHDefault();
 
   /**
    * Calculates NCI according to above equation.
@@ -54,6 +57,14 @@ public:
 
 protected:
 
+  /**Neighbor search query, built once in DoSetup() and re-aimed at each
+   * target tree's location.*/
+  clTreeQuery *mp_oNeighborQuery;
+
+  /**Neighbor search, re-armed with mp_oNeighborQuery for each target tree so
+   * that no new search objects pile up during a timestep.*/
+  clTreeSearch *mp_oNeighborSearch;
+
   /**Maximum search radius, in meters, in which to look for
    * neighbors.*/
   double m_fMaxCrowdingRadius;
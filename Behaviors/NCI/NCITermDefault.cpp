@@ -45,79 +45,67 @@ clNCITermDefault::~clNCITermDefault() {
 //////////////////////////////////////////////////////////////////////////////
 clNCITermBase::ncivals clNCITermDefault::CalculateNCITerm(clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, const float &fX, const float &fY, const int &iSpecies) {
 
-  clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
-  clTree * p_oNeighbor; //competing neighbor
+  stcNCIAccumulator stcNCI;
   ncivals toReturn;
-  std::stringstream sQuery; //format search strings into this
-  float fNCI = 0, //nci - the end result of all this math
-      fDistance, //distance between target and neighbor
-      fDbh, //neighbor's dbh
-      fNeighX, fNeighY; //holders for the neighbor tree's X and Y
-  int iIsDead; //neighbor's damage value
-  short int iNeighSpecies, iNeighType, //species and type for neighbor
-  iDeadCode; //neighbor's dead code
-
-  //Format the query to get all competing neighbors
-
-  //Get all trees taller than seedlings within the max crowding radius -
-  //seedlings don't compete
-  sQuery << "distance=" << mp_fMaxCrowdingRadius[iSpecies] << "FROM x="
-         << fX << "y=" << fY << "::height=" << m_fMinSaplingHeight;
-  p_oAllNeighbors = p_oPop->Find(sQuery.str());
-
-  //Loop through and assess the competitive effects of each
-  p_oNeighbor = p_oAllNeighbors->NextTree();
-
-  while ( p_oNeighbor ) {
-    if ( p_oNeighbor != p_oTree ) {
-
-      iNeighSpecies = p_oNeighbor->GetSpecies();
-      iNeighType = p_oNeighbor->GetType();
-
-      if ( clTreePopulation::seedling != iNeighType && ((clTreePopulation::snag != iNeighType) || m_bIncludeSnags)) {
-
-        //Get the neighbor's dbh
-        p_oNeighbor->GetValue( p_oPop->GetDbhCode( iNeighSpecies, iNeighType ), & fDbh );
-
-        if ( fDbh >= mp_fMinimumNeighborDBH[iNeighSpecies] ) {
-
-          //Make sure the neighbor's not dead
-          iDeadCode = p_oPop->GetIntDataCode( "dead", iNeighSpecies, iNeighType );
-          if ( -1 != iDeadCode ) {
-            p_oNeighbor->GetValue( iDeadCode, & iIsDead );
-          } else
-            iIsDead = notdead;
-
-          if (notdead == iIsDead || natural == iIsDead) {
-
-            //Get the neighbor's X and Y values
-            p_oNeighbor->GetValue( p_oPop->GetXCode( iNeighSpecies, iNeighType ), & fNeighX );
-            p_oNeighbor->GetValue( p_oPop->GetYCode( iNeighSpecies, iNeighType ), & fNeighY );
-
-            //Get the distance between the two trees
-            fDistance = p_oPlot->GetDistance( fX, fY, fNeighX, fNeighY );
-
-            //Only continue if distance is not 0 - it will be a fluke condition to
-            //allow a tree that is literally standing on top of another one not to
-            //affect it competitively, but there it is
-            if ( 0 != fDistance )
-
-              //Add competitive effect to NCI
-              fNCI += mp_fLambda[iSpecies][iNeighSpecies]
-                    * ( pow( fDbh / m_fDbhDivisor, mp_fAlpha[iSpecies])
-                    / pow( fDistance, mp_fBeta[iSpecies] ) );
-
-          }
-        }
-      }
-    }
-    p_oNeighbor = p_oAllNeighbors->NextTree();
-  }
-
-  toReturn.fNCI1 = fNCI;
+  int iTypeMask; //types that compete
+
+  stcNCI.p_oTarget = p_oTree;
+  stcNCI.p_iDbhCodes = p_oPop->GetDbhCodes();
+  stcNCI.p_iDeadCodes = p_oPop->GetDeadCodes();
+  stcNCI.p_fLambda = mp_fLambda[iSpecies];
+  stcNCI.p_fMinimumNeighborDBH = mp_fMinimumNeighborDBH;
+  stcNCI.fAlpha = mp_fAlpha[iSpecies];
+  stcNCI.fBeta = mp_fBeta[iSpecies];
+  stcNCI.fDbhDivisor = m_fDbhDivisor;
+  stcNCI.fNCI = 0;
+
+  //Seedlings don't compete; snags only compete if asked for
+  iTypeMask = (1 << clTreePopulation::sapling) | (1 << clTreePopulation::adult);
+  if (m_bIncludeSnags) iTypeMask |= 1 << clTreePopulation::snag;
+
+  //Assess the competitive effects of all trees taller than seedlings within
+  //the max crowding radius
+  p_oPop->ForEachNeighbor(fX, fY, mp_fMaxCrowdingRadius[iSpecies],
+      m_fMinSaplingHeight, iTypeMask, stcNCI);
+
+  toReturn.fNCI1 = stcNCI.fNCI;
   return toReturn;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// stcNCIAccumulator::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clNCITermDefault::stcNCIAccumulator::operator()(clTree *p_oNeighbor, float fDistanceSq) {
+  float fDbh; //neighbor's dbh
+  int iIsDead; //neighbor's damage value
+  short int iNeighSpecies = p_oNeighbor->GetSpecies(),
+      iNeighType = p_oNeighbor->GetType(),
+      iDeadCode; //neighbor's dead code
+
+  //Only continue if distance is not 0 - it will be a fluke condition to
+  //allow a tree that is literally standing on top of another one not to
+  //affect it competitively, but there it is
+  if (p_oNeighbor == p_oTarget || 0 == fDistanceSq) return;
+
+  //Get the neighbor's dbh
+  p_oNeighbor->GetValue( p_iDbhCodes[iNeighSpecies][iNeighType], & fDbh );
+  if ( fDbh < p_fMinimumNeighborDBH[iNeighSpecies] ) return;
+
+  //Make sure the neighbor's not dead
+  iDeadCode = p_iDeadCodes[iNeighSpecies][iNeighType];
+  if ( -1 != iDeadCode ) {
+    p_oNeighbor->GetValue( iDeadCode, & iIsDead );
+  } else
+    iIsDead = notdead;
+
+  if (notdead == iIsDead || natural == iIsDead)
+
+    //Add competitive effect to NCI
+    fNCI += p_fLambda[iNeighSpecies]
+          * ( pow( fDbh / fDbhDivisor, fAlpha )
+          / pow( sqrt( fDistanceSq ), fBeta ) );
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // DoSetup
 //////////////////////////////////////////////////////////////////////////////
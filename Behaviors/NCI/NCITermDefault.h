@@ -67,6 +67,29 @@ public:
 
 protected:
 
+  /**
+   * Adds up NCI for one target tree. This is handed to
+   * clTreePopulation::ForEachNeighbor(), which calls it for each neighbor.
+   */
+  struct stcNCIAccumulator {
+    clTree *p_oTarget; /**<Target tree*/
+    short int **p_iDbhCodes; /**<DBH codes, by species and type*/
+    short int **p_iDeadCodes; /**<"dead" codes, by species and type*/
+    double *p_fLambda; /**<Lambda row for the target species*/
+    double *p_fMinimumNeighborDBH; /**<Minimum neighbor DBH, by species*/
+    double fAlpha; /**<Alpha for the target species*/
+    double fBeta; /**<Beta for the target species*/
+    double fDbhDivisor; /**<DBH divisor*/
+    float fNCI; /**<NCI so far*/
+
+    /**
+     * Adds one neighbor's competitive effect to NCI.
+     * @param p_oNeighbor Neighbor.
+     * @param fDistanceSq Squared distance from the target to the neighbor.
+     */
+    void operator()(clTree *p_oNeighbor, float fDistanceSq);
+  };
+
   /**Lamba for NCI. Array sized number of total species by number of total
    * species.*/
   double **mp_fLambda;
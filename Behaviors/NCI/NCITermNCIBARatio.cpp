@@ -1,5 +1,7 @@
 #include "NCITermNCIBARatio.h"
 #include "TreePopulation.h"
+#include "TreeQuery.h"
+#include "TreeSearch.h"
 #include "Plot.h"
 #include "SimManager.h"
 #include "BehaviorBase.h"
@@ -11,6 +13,8 @@
 // Constructor
 //////////////////////////////////////////////////////////////////////////////
 clNCITermNCIBARatio::clNCITermNCIBARatio(bool bUseDefaultBA) {
+  mp_oNeighborQuery = NULL;
+  mp_oNeighborSearch = NULL;
   mp_fAlpha = NULL;
   mp_fBeta = NULL;
   mp_fLambda = NULL;
@@ -40,6 +44,8 @@ clNCITermNCIBARatio::clNCITermNCIBARatio(bool bUseDefaultBA) {
 clNCITermNCIBARatio::~clNCITermNCIBARatio() {
   int i;
 
+  delete mp_oNeighborQuery;
+  delete mp_oNeighborSearch;
   delete[] mp_fAlpha;
   delete[] mp_fBeta;
   delete[] mp_iWhatSpecies;
@@ -60,7 +66,6 @@ clNCITermBase::ncivals clNCITermNCIBARatio::CalculateNCITerm(clTree * p_oTree, c
   clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
   clTree * p_oNeighbor; //competing neighbor
   ncivals toReturn;
-  std::stringstream sQuery; //format search strings into this
   float fNCI = 0, //nci - the end result of all this math
       fDistance, //distance between target and neighbor
       fDbh,
@@ -80,9 +85,9 @@ clNCITermBase::ncivals clNCITermNCIBARatio::CalculateNCITerm(clTree * p_oTree, c
 
   //Get all trees taller than seedlings within the max crowding radius -
   //seedlings don't compete
-  sQuery << "distance=" << m_fMaxCrowdingRadius << "FROM x="
-         << fX << "y=" << fY << "::height=" << m_fMinSaplingHeight;
-  p_oAllNeighbors = p_oPop->Find(sQuery.str());
+  mp_oNeighborQuery->SetDistanceHeight(m_fMaxCrowdingRadius, m_fMinSaplingHeight, fX, fY);
+  p_oPop->Find(*mp_oNeighborQuery, mp_oNeighborSearch);
+  p_oAllNeighbors = mp_oNeighborSearch;
 
   //Loop through and assess the competitive effects of each
   p_oNeighbor = p_oAllNeighbors->NextTree();
@@ -97,7 +102,7 @@ clNCITermBase::ncivals clNCITermNCIBARatio::CalculateNCITerm(clTree * p_oTree, c
         clTreePopulation::snag == iNeighType) goto nextTree;
 
     //Make sure the neighbor's not dead
-    iDeadCode = p_oPop->GetIntDataCode( "dead", iNeighSpecies, iNeighType );
+    iDeadCode = p_oPop->GetDeadCodes()[iNeighSpecies][iNeighType];
     if ( -1 != iDeadCode )  p_oNeighbor->GetValue( iDeadCode, & iIsDead );
     else iIsDead = notdead;
 
@@ -158,6 +163,8 @@ void clNCITermNCIBARatio::DoSetup(clTreePopulation *p_oPop, clBehaviorBase *p_oN
   std::stringstream sLabel;
   int i, j;
 
+  mp_oNeighborQuery = new clTreeQuery(p_oPop);
+  mp_oNeighborSearch = new clTreeSearch(p_oPop);
   m_iNumBehaviorSpecies = p_oNCI->GetNumBehaviorSpecies();
   mp_iWhatSpecies = new short int[m_iNumBehaviorSpecies];
   for (i = 0; i < m_iNumBehaviorSpecies; i++) {
@@ -3,6 +3,9 @@
 
 #include "NCITermBase.h"
 
+class clTreeQuery;
+class clTreeSearch;
+
 /**
  * This calculates NCI for a tree according to the function:
  *
@@ -71,6 +74,14 @@ public:
 
 protected:
 
+  /**Neighbor search query, built once in DoSetup() and re-aimed at each
+   * target tree's location.*/
+  clTreeQuery *mp_oNeighborQuery;
+
+  /**Neighbor search, re-armed with mp_oNeighborQuery for each target tree so
+   * that no new search objects pile up during a timestep.*/
+  clTreeSearch *mp_oNeighborSearch;
+
   /**Pointer to the plot object, so we can get the temperature*/
   clPlot *mp_oPlot;
 
@@ -1,5 +1,7 @@
 #include "NCITermWithNeighborDamage.h"
 #include "TreePopulation.h"
+#include "TreeQuery.h"
+#include "TreeSearch.h"
 #include "Plot.h"
 #include "BehaviorBase.h"
 #include "ParsingFunctions.h"
@@ -10,6 +12,8 @@
 // Constructor
 //////////////////////////////////////////////////////////////////////////////
 clNCITermWithNeighborDamage::clNCITermWithNeighborDamage() {
+  mp_oNeighborQuery = NULL;
+  mp_oNeighborSearch = NULL;
   mp_fAlpha = NULL;
   mp_fBeta = NULL;
   mp_fLambda = NULL;
@@ -32,6 +36,8 @@ clNCITermWithNeighborDamage::clNCITermWithNeighborDamage() {
 clNCITermWithNeighborDamage::~clNCITermWithNeighborDamage() {
   int i;
 
+  delete mp_oNeighborQuery;
+  delete mp_oNeighborSearch;
   delete[] mp_fAlpha;
   delete[] mp_fBeta;
   delete[] mp_fMaxCrowdingRadius;
@@ -57,7 +63,6 @@ clNCITermBase::ncivals clNCITermWithNeighborDamage::CalculateNCITerm(clTree * p_
   clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
   clTree * p_oNeighbor; //competing neighbor
   ncivals toReturn;
-  std::stringstream sQuery; //format search strings into this
   float fNCI = 0, //nci - the end result of all this math
       fDistance, //distance between target and neighbor
       fDbh, //neighbor's dbh
@@ -71,10 +76,9 @@ clNCITermBase::ncivals clNCITermWithNeighborDamage::CalculateNCITerm(clTree * p_
 
   //Get all trees taller than seedlings within the max crowding radius -
   //seedlings don't compete
-  sQuery << "distance=" << mp_fMaxCrowdingRadius[iSpecies] << "FROM x="
-      << fX << "y=" << fY << "::height=" << m_fMinSaplingHeight;
-  p_oAllNeighbors = p_oPop->Find(sQuery.str());
-  sQuery.str("");
+  mp_oNeighborQuery->SetDistanceHeight(mp_fMaxCrowdingRadius[iSpecies], m_fMinSaplingHeight, fX, fY);
+  p_oPop->Find(*mp_oNeighborQuery, mp_oNeighborSearch);
+  p_oAllNeighbors = mp_oNeighborSearch;
 
   //Loop through and assess the competitive effects of each
   p_oNeighbor = p_oAllNeighbors->NextTree();
@@ -93,7 +97,7 @@ clNCITermBase::ncivals clNCITermWithNeighborDamage::CalculateNCITerm(clTree * p_
         if (fDbh >= mp_fMinimumNeighborDBH[iNeighSpecies]) {
 
           //Make sure the neighbor's not dead
-          iDeadCode = p_oPop->GetIntDataCode( "dead", iNeighSpecies, iNeighType );
+          iDeadCode = p_oPop->GetDeadCodes()[iNeighSpecies][iNeighType];
           if (-1 != iDeadCode) {
             p_oNeighbor->GetValue( iDeadCode, & iIsDead );
           }
@@ -159,6 +163,8 @@ void clNCITermWithNeighborDamage::DoSetup(clTreePopulation *p_oPop, clBehaviorBa
       iNumBehaviorSpecies = p_oNCI->GetNumBehaviorSpecies(),
       i, j;
 
+  mp_oNeighborQuery = new clTreeQuery(p_oPop);
+  mp_oNeighborSearch = new clTreeSearch(p_oPop);
   m_iNumTotalSpecies = p_oPop->GetNumberOfSpecies();
   m_fMinSaplingHeight = 50;
   //Get the minimum sapling height
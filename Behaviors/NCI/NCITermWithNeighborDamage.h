@@ -3,6 +3,9 @@
 
 #include "NCITermBase.h"
 
+class clTreeQuery;
+class clTreeSearch;
+
 /**
  * Calculates NCI according to a function that takes into account neighbors
  * damaged by storms (class clStormDamageApplier).
@@ -78,6 +81,14 @@ public:
 
 protected:
 
+  /**Neighbor search query, built once in DoSetup() and re-aimed at each
+   * target tree's location.*/
+  clTreeQuery *mp_oNeighborQuery;
+
+  /**Neighbor search, re-armed with mp_oNeighborQuery for each target tree so
+   * that no new search objects pile up during a timestep.*/
+  clTreeSearch *mp_oNeighborSearch;
+
   /**Lamba for NCI. Array sized number of total species by number of total
    * species.*/
   double **mp_fLambda;
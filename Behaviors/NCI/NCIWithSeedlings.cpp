@@ -1,5 +1,7 @@
 #include "NCIWithSeedlings.h"
 #include "TreePopulation.h"
+#include "TreeQuery.h"
+#include "TreeSearch.h"
 #include "Plot.h"
 #include "BehaviorBase.h"
 #include "ParsingFunctions.h"
@@ -11,6 +13,8 @@
 // Constructor
 //////////////////////////////////////////////////////////////////////////////
 clNCIWithSeedlings::clNCIWithSeedlings() {
+  mp_oNeighborQuery = NULL;
+  mp_oNeighborSearch = NULL;
   mp_fAlpha = NULL;
   mp_fBeta = NULL;
   mp_fLambda = NULL;
@@ -29,6 +33,8 @@ clNCIWithSeedlings::clNCIWithSeedlings() {
 clNCIWithSeedlings::~clNCIWithSeedlings() {
   int i;
 
+  delete mp_oNeighborQuery;
+  delete mp_oNeighborSearch;
   delete[] mp_fAlpha;
   delete[] mp_fBeta;
   delete[] mp_fMaxCrowdingRadius;
@@ -49,7 +55,6 @@ clNCITermBase::ncivals clNCIWithSeedlings::CalculateNCITerm(clTree * p_oTree, cl
   clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
   clTree * p_oNeighbor; //competing neighbor
   ncivals toReturn;
-  std::stringstream sQuery; //format search strings into this
   float fNCI = 0, //nci - the end result of all this math
       fDistance, //distance between target and neighbor
       fDiam10, //neighbor's dbh
@@ -63,9 +68,9 @@ clNCITermBase::ncivals clNCIWithSeedlings::CalculateNCITerm(clTree * p_oTree, cl
 
   //Get all trees taller than seedlings within the max crowding radius -
   //seedlings don't compete
-  sQuery << "distance=" << mp_fMaxCrowdingRadius[iSpecies] << "FROM x="
-         << fX << "y=" << fY << "::height=0";
-  p_oAllNeighbors = p_oPop->Find(sQuery.str());
+  mp_oNeighborQuery->SetDistanceHeight(mp_fMaxCrowdingRadius[iSpecies], 0, fX, fY);
+  p_oPop->Find(*mp_oNeighborQuery, mp_oNeighborSearch);
+  p_oAllNeighbors = mp_oNeighborSearch;
 
   //Loop through and assess the competitive effects of each
   p_oNeighbor = p_oAllNeighbors->NextTree();
@@ -79,7 +84,7 @@ clNCITermBase::ncivals clNCIWithSeedlings::CalculateNCITerm(clTree * p_oTree, cl
     if (clTreePopulation::snag == iNeighType && !m_bIncludeSnags) goto nextTree;
 
     //Make sure the neighbor's not dead
-    iDeadCode = p_oPop->GetIntDataCode( "dead", p_oNeighbor->GetSpecies(), p_oNeighbor->GetType() );
+    iDeadCode = p_oPop->GetDeadCodes()[p_oNeighbor->GetSpecies()][p_oNeighbor->GetType()];
     if ( -1 != iDeadCode ) {
       p_oNeighbor->GetValue( iDeadCode, & iIsDead );
       if (iIsDead != notdead && iIsDead != natural) goto nextTree;
@@ -131,6 +136,8 @@ void clNCIWithSeedlings::DoSetup(clTreePopulation *p_oPop, clBehaviorBase *p_oNC
   int iNumBehaviorSpecies = p_oNCI->GetNumBehaviorSpecies(),
       i, j;
 
+  mp_oNeighborQuery = new clTreeQuery(p_oPop);
+  mp_oNeighborSearch = new clTreeSearch(p_oPop);
   m_iNumTotalSpecies = p_oPop->GetNumberOfSpecies();
 
   mp_fAlpha = new double[m_iNumTotalSpecies];
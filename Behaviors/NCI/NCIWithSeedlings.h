@@ -3,6 +3,9 @@
 
 #include "NCITermBase.h"
 
+class clTreeQuery;
+class clTreeSearch;
+
 /**
  * Calculates NCI and allows seedlings to compete.
  *
@@ -69,6 +72,14 @@ public:
 
 protected:
 
+  /**Neighbor search query, built once in DoSetup() and re-aimed at each
+   * target tree's location.*/
+  clTreeQuery *mp_oNeighborQuery;
+
+  /**Neighbor search, re-armed with mp_oNeighborQuery for each target tree so
+   * that no new search objects pile up during a timestep.*/
+  clTreeSearch *mp_oNeighborSearch;
+
   /**Lamba for NCI. Array sized number of total species by number of total
    * species.*/
   double **mp_fLambda;
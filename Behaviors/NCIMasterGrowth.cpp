@@ -33,6 +33,9 @@ clNCIMasterGrowth::clNCIMasterGrowth(clSimManager * p_oSimManager) :
   m_sNameString = "ncigrowthshell";
   m_sXMLRoot = "NCIMasterGrowth";
 
+  //Growth is all calculated in PreGrowthCalcs
+  m_bThreadSafe = true;
+
   //Version 3
   m_fVersionNumber = 3.0;
   m_fMinimumVersionNumber = 3.0;
@@ -95,6 +98,15 @@ void clNCIMasterGrowth::GetTreeMemberCodes() {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////
+// GetNeighborSearchRadius()
+////////////////////////////////////////////////////////////////////////////
+float clNCIMasterGrowth::GetNeighborSearchRadius(xercesc::DOMDocument * p_oDoc) {
+  DOMElement *p_oElement = GetParentParametersElement(p_oDoc);
+  if (NULL == p_oElement) return 0;
+  return GetMaxCrowdingRadius(p_oElement);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // DoShellSetup()
 ////////////////////////////////////////////////////////////////////////////
@@ -306,7 +318,10 @@ void clNCIMasterGrowth::PreGrowthCalcs(clTreePopulation * p_oPop) {
     fAmountDiamIncrease, //amount diameter increase
     fTempDiamIncrease; //amount diameter increase - intermediate
     int iNumberYearsPerTimestep = mp_oSimManager->GetNumberOfYearsPerTimestep(), iIsDead;
-    short int iSpecies, iType, //type and species of a tree
+    short int **p_iDeadCodes = p_oPop->GetDeadCodes(), //dead codes table
+    **p_iXCodes = p_oPop->GetXCodes(), **p_iYCodes = p_oPop->GetYCodes(),
+    **p_iDbhCodes = p_oPop->GetDbhCodes(),
+    iSpecies, iType, //type and species of a tree
     i, //loop counter
     iDeadCode; //tree's dead code
 
@@ -345,7 +360,7 @@ void clNCIMasterGrowth::PreGrowthCalcs(clTreePopulation * p_oPop) {
       if ( -1 != mp_iGrowthCodes[iSpecies][iType]) {
 
         //Make sure tree's not dead
-        iDeadCode = p_oPop->GetIntDataCode( "dead", p_oTree->GetSpecies(), p_oTree->GetType() );
+        iDeadCode = p_iDeadCodes[iSpecies][iType];
         if ( -1 != iDeadCode )
         {
           p_oTree->GetValue( iDeadCode, & iIsDead );
@@ -358,15 +373,15 @@ void clNCIMasterGrowth::PreGrowthCalcs(clTreePopulation * p_oPop) {
           if (iType == clTreePopulation::seedling) {
             p_oTree->GetValue(p_oPop->GetDiam10Code(iSpecies, iType), &fDiam);
           } else {
-            p_oTree->GetValue(p_oPop->GetDbhCode(iSpecies, iType), &fDiam);
+            p_oTree->GetValue(p_iDbhCodes[iSpecies][iType], &fDiam);
           }
 
           //First calculate the pieces that have no DBH component and thus will
           //not change in our loop
 
           //Get NCI
-          p_oTree->GetValue( p_oPop->GetXCode( iSpecies, iType ), & fX );
-          p_oTree->GetValue( p_oPop->GetYCode( iSpecies, iType ), & fY );
+          p_oTree->GetValue( p_iXCodes[iSpecies][iType], & fX );
+          p_oTree->GetValue( p_iYCodes[iSpecies][iType], & fY );
           nci = mp_oNCITerm->CalculateNCITerm(p_oTree, p_oPop, p_oPlot, fX, fY, iSpecies);
 
           //Get the tree's damage effect
@@ -42,6 +42,7 @@ class clTreePopulation;
   <br>November 1, 2013: Added infection effect (LEM)
   <br>December 23, 2013: Made child of clNCIBehaviorBase; added stochasticity
   (LEM)
+  <br>October 17, 2026: Added GetNeighborSearchRadius() (agent)
 */
 class clNCIMasterGrowth : virtual public clGrowthBase, clNCIBehaviorBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -101,6 +102,15 @@ class clNCIMasterGrowth : virtual public clGrowthBase, clNCIBehaviorBase {
   */
   void DoShellSetup(xercesc::DOMDocument *p_oDoc);
 
+  /**
+  * Gets the largest crowding radius in this behavior's parameters, so the
+  * tree population can size its hash table cells.
+  * @param p_oDoc DOM tree of parsed input tree.
+  * @return Largest crowding radius, or 0 if this behavior has no parameters
+  * in this file.
+  */
+  float GetNeighborSearchRadius(xercesc::DOMDocument *p_oDoc);
+
   /**
   * Captures the namestring passed to this behavior. This is overridden from
   * clBehaviorBase so we can capture the namestring passed. Since this class
@@ -32,6 +32,9 @@ clWorkerBase( p_oSimManager ), clBehaviorBase( p_oSimManager ), clMortalityBase(
     m_sNameString = "ncimortshell";
     m_sXMLRoot = "NCIMasterMortality";
 
+    //Mortality is all decided in PreMortCalcs
+    m_bThreadSafe = true;
+
     //Version 3
     m_fVersionNumber = 3.0;
     m_fMinimumVersionNumber = 3.0;
@@ -109,6 +112,15 @@ void clNCIMasterMortality::GetTreeMemberCodes() {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////
+// GetNeighborSearchRadius()
+////////////////////////////////////////////////////////////////////////////
+float clNCIMasterMortality::GetNeighborSearchRadius(xercesc::DOMDocument * p_oDoc) {
+  DOMElement *p_oElement = GetParentParametersElement(p_oDoc);
+  if (NULL == p_oElement) return 0;
+  return GetMaxCrowdingRadius(p_oElement);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // DoShellSetup()
 ////////////////////////////////////////////////////////////////////////////
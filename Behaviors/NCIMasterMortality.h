@@ -32,6 +32,8 @@ class clPlot;
 * <br>-----------------
 * <br>June 28, 2013 - Created (LEM)
 * <br>November 1, 2013: Added infection effect (LEM)
+* <br>October 17, 2026: Added GetNeighborSearchRadius() (agent)
+* <br>October 17, 2026: Declared thread-safe (agent)
 */
 class clNCIMasterMortality : virtual public clMortalityBase, clNCIBehaviorBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -71,6 +73,15 @@ class clNCIMasterMortality : virtual public clMortalityBase, clNCIBehaviorBase {
   */
   void DoShellSetup(xercesc::DOMDocument *p_oDoc);
 
+  /**
+  * Gets the largest crowding radius in this behavior's parameters, so the
+  * tree population can size its hash table cells.
+  * @param p_oDoc DOM tree of parsed input tree.
+  * @return Largest crowding radius, or 0 if this behavior has no parameters
+  * in this file.
+  */
+  float GetNeighborSearchRadius(xercesc::DOMDocument *p_oDoc);
+
   /**
   * Performs calculations before any trees have been killed.  This finds all
   * trees to which this behavior applies and performs their NCI calculations.
@@ -63,6 +63,15 @@ clNCIMasterQuadratGrowth::~clNCIMasterQuadratGrowth() {
   delete[] mp_fRandSigma;
 }
 
+////////////////////////////////////////////////////////////////////////////
+// GetNeighborSearchRadius()
+////////////////////////////////////////////////////////////////////////////
+float clNCIMasterQuadratGrowth::GetNeighborSearchRadius(xercesc::DOMDocument * p_oDoc) {
+  DOMElement *p_oElement = GetParentParametersElement(p_oDoc);
+  if (NULL == p_oElement) return 0;
+  return GetMaxCrowdingRadius(p_oElement);
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // DoShellSetup()
 ////////////////////////////////////////////////////////////////////////////
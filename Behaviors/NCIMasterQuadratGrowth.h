@@ -40,6 +40,7 @@ class clGrid;
   <br>Edit history:
   <br>-----------------
   <br>January 7, 2013: Created (LEM)
+  <br>October 17, 2026: Added GetNeighborSearchRadius() (agent)
 */
 class clNCIMasterQuadratGrowth : virtual public clGrowthBase, clNCIBehaviorBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -99,6 +100,15 @@ class clNCIMasterQuadratGrowth : virtual public clGrowthBase, clNCIBehaviorBase
   */
   void DoShellSetup(xercesc::DOMDocument *p_oDoc);
 
+  /**
+  * Gets the largest crowding radius in this behavior's parameters, so the
+  * tree population can size its hash table cells.
+  * @param p_oDoc DOM tree of parsed input tree.
+  * @return Largest crowding radius, or 0 if this behavior has no parameters
+  * in this file.
+  */
+  float GetNeighborSearchRadius(xercesc::DOMDocument *p_oDoc);
+
   /**
   * Captures the namestring passed to this behavior. This is overridden from
   * clBehaviorBase so we can capture the namestring passed. Since this class
@@ -406,12 +406,10 @@ void clNeighborhoodSeedPredation::GetOfftakes(clTreePopulation * p_oPop,
     const double* p_fP0, double **p_fPn, float *p_fOfftake, const int &iX,
     const int &iY) {
 
-  clTreeSearch * p_oTrees;             //saplings and adults
-  clTree * p_oTree;                    //single tree to count
-  char cQuery[75];                     //format search string into this
-  float fTotalBA, fDbh, fX, fY;
+  stcBasalAreaSum stcBA;                //adds up basal area of neighbors
+  float fTotalBA, fX, fY;
   int iNumSpecies = p_oPop->GetNumberOfSpecies(),
-      iSp, iTp, i;
+      iSp, i;
   float *p_fBasalArea = new float[iNumSpecies]; //basal area per species
 
   //Get all neighbors within the specified radius and calculate
@@ -419,28 +417,11 @@ void clNeighborhoodSeedPredation::GetOfftakes(clTreePopulation * p_oPop,
   for (iSp = 0; iSp < iNumSpecies; iSp++)
     p_fBasalArea[iSp] = 0;
   mp_oSeedGrid->GetPointOfCell(iX, iY, &fX, &fY);
-  sprintf(cQuery, "%s%f%s%f%s%f%s%f", "distance=", m_fRadius, "FROM x=", fX,
-      "y=", fY, "::height=", 0.0);
-  p_oTrees = p_oPop->Find(cQuery);
-  p_oTree = p_oTrees->NextTree();
-
-  while (NULL != p_oTree) {
-
-    //Get the tree's DBH and make sure it's eligible
-    iSp = p_oTree->GetSpecies();
-    iTp = p_oTree->GetType();
-    if (iTp == clTreePopulation::sapling || iTp == clTreePopulation::adult) {
-
-      p_oTree->GetValue(p_oPop->GetDbhCode(iSp, iTp), &fDbh);
-      if (fDbh >= mp_fMinNeighDBH[iSp]) {
-
-        //Get tree's "basal area" - since it's relative BA, we really
-        //only need to square the DBH
-        p_fBasalArea[iSp] += pow(fDbh, 2);
-      }
-    }
-    p_oTree = p_oTrees->NextTree();
-  }
+  stcBA.p_oPop = p_oPop;
+  stcBA.p_fMinNeighDBH = mp_fMinNeighDBH;
+  stcBA.p_fBasalArea = p_fBasalArea;
+  p_oPop->ForEachNeighbor(fX, fY, m_fRadius, 0,
+      (1 << clTreePopulation::sapling) | (1 << clTreePopulation::adult), stcBA);
 
   //Get relative BA for each species
   fTotalBA = 0;
@@ -463,6 +444,24 @@ void clNeighborhoodSeedPredation::GetOfftakes(clTreePopulation * p_oPop,
   delete[] p_fBasalArea;
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// stcBasalAreaSum::operator()
+//////////////////////////////////////////////////////////////////////////////
+void clNeighborhoodSeedPredation::stcBasalAreaSum::operator()(clTree *p_oTree,
+    float fDistanceSq) {
+  float fDbh;
+  int iSp = p_oTree->GetSpecies(), iTp = p_oTree->GetType();
+
+  //Get the tree's DBH and make sure it's eligible
+  p_oTree->GetValue(p_oPop->GetDbhCode(iSp, iTp), &fDbh);
+  if (fDbh >= p_fMinNeighDBH[iSp]) {
+
+    //Get tree's "basal area" - since it's relative BA, we really
+    //only need to square the DBH
+    p_fBasalArea[iSp] += pow(fDbh, 2);
+  }
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // SetupGrids()
 ////////////////////////////////////////////////////////////////////////////
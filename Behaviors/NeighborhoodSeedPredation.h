@@ -7,6 +7,7 @@
 #include "BehaviorBase.h"
 
 class clGrid;
+class clTree;
 /**
 * Neighborhood Seed Predationon - version 1.1
 *
@@ -67,6 +68,8 @@ class clGrid;
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Neighbor basal area is added up with
+* clTreePopulation::ForEachNeighbor() (agent)
 */
 class clNeighborhoodSeedPredation : public clBehaviorBase {
 
@@ -103,6 +106,23 @@ public:
 
 protected:
 
+  /**
+   * Adds up relative basal area by species around a point. This is handed to
+   * clTreePopulation::ForEachNeighbor().
+   */
+  struct stcBasalAreaSum {
+    clTreePopulation *p_oPop; /**<Tree population*/
+    double *p_fMinNeighDBH; /**<Minimum neighbor DBH, by species*/
+    float *p_fBasalArea; /**<Sum of squared DBH, by species*/
+
+    /**
+     * Adds one neighbor's squared DBH.
+     * @param p_oTree Neighbor.
+     * @param fDistanceSq Squared distance to neighbor. Not used.
+     */
+    void operator()(clTree *p_oTree, float fDistanceSq);
+  };
+
   /**
     * Does setup. This reads in values from the parameter file, gets the pointer
     * to the dispersed seeds grid, and sets up the output grid.
@@ -150,10 +150,10 @@ void clOutput::GetData( DOMDocument * p_oDoc )
   bool bTest;
 
   //Get the number of cells in each direction
-  m_iNumXCells = p_oPop->GetNumXCells();
-  m_iNumYCells = p_oPop->GetNumYCells();
   m_fXCellLength = p_oPop->GetGridCellSize();
   m_fYCellLength = p_oPop->GetGridCellSize();
+  m_iNumXCells = (int)ceil( mp_oSimManager->GetPlotObject()->GetXPlotLength() / m_fXCellLength );
+  m_iNumYCells = (int)ceil( mp_oSimManager->GetPlotObject()->GetYPlotLength() / m_fYCellLength );
 
   ExtractLiveTreeInfo( p_oDoc );
   ExtractDeadTreeInfo( p_oDoc );
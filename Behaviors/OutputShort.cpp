@@ -4,6 +4,7 @@
 #include "SimManager.h"
 #include "Plot.h"
 #include "TreePopulation.h"
+#include "TreeSnapshot.h"
 #include "GhostTreePopulation.h"
 #include "ParsingFunctions.h"
 #include "PlatformFuncs.h"
@@ -511,10 +512,10 @@ void clShortOutput::ExtractSubplotInfo( xercesc::DOMDocument * p_oDoc )
     bool bDuplicate; //for searching for duplicate values
 
     //Get the number of cells in each direction
-    m_iNumXCells = p_oPop->GetNumXCells();
-    m_iNumYCells = p_oPop->GetNumYCells();
     m_fXCellLength = p_oPop->GetGridCellSize();
     m_fYCellLength = p_oPop->GetGridCellSize();
+    m_iNumXCells = (int)ceil( fPlotLengthX / m_fXCellLength );
+    m_iNumYCells = (int)ceil( fPlotLengthY / m_fYCellLength );
 
     //Check to see if there is user-specified grid cell size information - we've
     //already collected the default info in case there isn't
@@ -955,29 +956,30 @@ void clShortOutput::GetLiveTreeStats() {
     // Tree data saving
     //******************************
     if ( 0 == m_iNumSubplotsToSave ) {
-        //Get all trees of this type
-      p_oTypeTrees = p_oTrees->Find( "all" );
+      //Nothing here changes trees, so read them from the population's
+      //snapshot arrays instead of searching
+      clTreeSnapshot *p_oSnapshot = p_oTrees->GetSnapshot();
+      const float *p_fDbh = p_oSnapshot->GetDbh();
+      const short int *p_iSpecies = p_oSnapshot->GetSpecies(),
+                      *p_iType = p_oSnapshot->GetType();
+      int iNumTrees = p_oSnapshot->GetNumTrees();
 
       //Go through the trees one at a time and add each's data to the running
       //totals
-      p_oTree = p_oTypeTrees->NextTree();
-      while ( p_oTree ) {
-        iTypeIndex = p_oTree->GetType();
+      for ( i = 0; i < iNumTrees; i++ ) {
+        iTypeIndex = p_iType[i];
         if ( mp_bSaveAnyLive[iTypeIndex] )  {
-          iSpecies = p_oTree->GetSpecies();
+          iSpecies = p_iSpecies[i];
           if ( mp_bSaveAnyLiveBA[iTypeIndex] ) { //Basal area
-            //Get the dbh
-            p_oTree->GetValue( p_oTrees->GetDbhCode( iSpecies, iTypeIndex ), & fDbh );
             //Calculate basal area and add to array total
-            fBA = clModelMath::CalculateBasalArea( fDbh );
+            fBA = clModelMath::CalculateBasalArea( p_fDbh[i] );
             mp_fLiveABA[iTypeIndex] [iSpecies] += fBA;
           } //end of check for basal area
 
           //Density
           mp_fLiveADN[iTypeIndex] [iSpecies] ++;
         }
-        p_oTree = p_oTypeTrees->NextTree();
-      } //end of while (p_oTree)
+      } //end of for ( i = 0; i < iNumTrees; i++ )
     } else { //if ( 0 == m_iNumSubplotsToSave ) {
       //Get all trees of this type
       p_oTypeTrees = p_oTrees->Find( "all" );
@@ -24,6 +24,7 @@ clPowerHeightGrowth::clPowerHeightGrowth(clSimManager * p_oSimManager) :
 
     m_sNameString = "powergrowthshell";
     m_sXMLRoot = "PowerGrowth";
+    m_bThreadSafe = true;
 
   } catch (modelErr& err) {
     throw(err);
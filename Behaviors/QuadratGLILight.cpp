@@ -6,6 +6,7 @@
 #include "TreePopulation.h"
 #include "Allometry.h"
 #include "LightOrg.h"
+#include "TaskPool.h"
 #include <stdio.h>
 
 ////////////////////////////////////////////////////////////////////////////
@@ -24,8 +25,23 @@ clQuadratGLILight::clQuadratGLILight(clSimManager * p_oSimManager) :
   m_fMaxSearchRad = 0;
   m_iGridGliCode = -1;
   mp_oQuadrats = NULL;
+  mp_fCellGli = NULL;
+  mp_iCellsToDo = NULL;
+  mp_iRowStart = NULL;
 
   m_bCalcAll = false;
+
+  //All the quadrats are calculated in PreLightCalcs
+  m_bThreadSafe = true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Destructor
+////////////////////////////////////////////////////////////////////////////
+clQuadratGLILight::~clQuadratGLILight() {
+  delete[] mp_fCellGli;
+  delete[] mp_iCellsToDo;
+  delete[] mp_iRowStart;
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -201,6 +217,10 @@ void clQuadratGLILight::DoShellSetup(xercesc::DOMDocument * p_oDoc) {
     for ( j = 0; j < iNumYCells; j++ )
     mp_oQuadrats->SetValueOfCell( i, j, m_iGridGliCode, fAngChunk );
 
+    mp_fCellGli = new float[iNumXCells * iNumYCells];
+    mp_iCellsToDo = new int[iNumXCells * iNumYCells];
+    mp_iRowStart = new int[iNumXCells + 1];
+
   }
   catch ( modelErr & err )
   {
@@ -224,16 +244,10 @@ void clQuadratGLILight::DoShellSetup(xercesc::DOMDocument * p_oDoc) {
 ////////////////////////////////////////////////////////////////////////////
 float clQuadratGLILight::CalcLightValue(clTree * p_oTree,
     clTreePopulation * p_oPop) {
-  clTreeSearch * p_oShaders; //neighborhood trees who can shade each target
-  clTree * p_oNeighbor; //shading neighbors
-  clPlot * p_oPlot = mp_oSimManager->GetPlotObject();
-  clAllometry * p_oAllom = p_oPop->GetAllometryObject();
-  char cQuery[75]; //format search strings into this
   float fGli, //global light index - end result of all this math
   fX, fY; //holders for the tree's X and Y location
   short int iSpecies, iType, //for holding species and type
-  iXCell, iYCell, //quadrat numbers
-  i, j; //loop counter
+  iXCell, iYCell; //quadrat numbers
 
   iSpecies = p_oTree->GetSpecies();
   iType = p_oTree->GetType();
@@ -241,50 +255,163 @@ float clQuadratGLILight::CalcLightValue(clTree * p_oTree,
   p_oTree->GetValue( p_oPop->GetYCode( iSpecies, iType ), & fY );
 
   //Check to see if there's already a value in the quadrat array for this
-  //tree's quadrat - if so, assign it and exit
+  //tree's quadrat - if so, assign it and exit. There always will be if
+  //PreLightCalcs() has run.
   mp_oQuadrats->GetValueAtPoint( fX, fY, m_iGridGliCode, & fGli );
-  if ( fGli > 0 ) return fGli;
+  if ( fGli >= 0 ) return fGli;
 
   //Nope - no value for this point yet - calculate the gli
   //First find the point at which to calculate gli - center of the tree's
   //quadrat - place in fX and fY
   mp_oQuadrats->GetCellOfPoint( fX, fY, & iXCell, & iYCell );
   mp_oQuadrats->GetPointOfCell( iXCell, iYCell, & fX, & fY );
+  fGli = CalcQuadratGli( fX, fY, GetPhotoArray(), p_oPop );
 
-  //Initialize photo array
-  for ( i = 0; i < m_iNumAltAng; i++ )
-    for ( j = 0; j < m_iNumAziAng; j++ )
-      mp_fPhoto[i] [j] = 1.0;
-
-  //Get a list of all trees that are within the search radius and taller than
-  //the fish-eye photo height
-  sprintf( cQuery, "%s%f%s%f%s%f%s%f", "distance=", m_fMaxSearchRad, " FROM x=", fX, "y=", fY, "::height=", m_fLightHeight );
-  p_oShaders = p_oPop->Find( cQuery );
-
-  p_oNeighbor = p_oShaders->NextTree();
-  while ( p_oNeighbor != NULL )
-  {
+  //Assign GLI to the grid
+  mp_oQuadrats->SetValueAtPoint( fX, fY, m_iGridGliCode, fGli );
 
-    //Skip seedlings, which don't shade, and the target tree if returned
-    if ( clTreePopulation::seedling != p_oNeighbor->GetType() )
+  return fGli;
+}
 
-      //Add the effect of the neighbor to the simulated fisheye photo
-      AddTreeToGliFishEye( fX, fY, m_fLightHeight, p_oNeighbor, p_oPlot, p_oPop, p_oAllom );
+////////////////////////////////////////////////////////////////////////////
+// CalcQuadratGli()
+////////////////////////////////////////////////////////////////////////////
+float clQuadratGLILight::CalcQuadratGli(float fX, float fY, float **p_fPhoto,
+    clTreePopulation * p_oPop) {
+  stcFishEyeShaders stcShaders; //adds shading neighbors to the photo
+  float fGli; //global light index - end result of all this math
+  short int i, j; //loop counter
 
-    p_oNeighbor = p_oShaders->NextTree();
-  } //end of while (neighbor != NULL)
+  //Initialize photo array
+  for ( i = 0; i < m_iNumAltAng; i++ )
+    for ( j = 0; j < m_iNumAziAng; j++ )
+      p_fPhoto[i] [j] = 1.0;
+
+  //Add all trees that are within the search radius and taller than the
+  //fish-eye photo height to the photo. Seedlings don't shade.
+  stcShaders.p_oLight = this;
+  stcShaders.p_oTarget = NULL;
+  stcShaders.p_oPlot = mp_oSimManager->GetPlotObject();
+  stcShaders.p_oPop = p_oPop;
+  stcShaders.p_oAllom = p_oPop->GetAllometryObject();
+  stcShaders.p_fPhoto = p_fPhoto;
+  stcShaders.fX = fX;
+  stcShaders.fY = fY;
+  stcShaders.fHeight = m_fLightHeight;
+  p_oPop->ForEachNeighbor( fX, fY, m_fMaxSearchRad, m_fLightHeight,
+      ( 1 << clTreePopulation::sapling ) | ( 1 << clTreePopulation::adult ) |
+      ( 1 << clTreePopulation::snag ), stcShaders );
 
   //Calculate GLI
   fGli = 0.0;
   for ( i = 0; i < m_iNumAltAng; i++ )
     for ( j = 0; j < m_iNumAziAng; j++ )
-      fGli += ( mp_fPhoto[i] [j] * mp_fBrightness[i] [j] );
+      fGli += ( p_fPhoto[i] [j] * mp_fBrightness[i] [j] );
   fGli *= 100;
 
+  return fGli;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CalcQuadrats()
+////////////////////////////////////////////////////////////////////////////
+void clQuadratGLILight::CalcQuadrats(clTreePopulation * p_oPop, bool bAll) {
+  clTaskPool * p_oPool = mp_oSimManager->GetTaskPool();
+  clTreeSearch * p_oAllTrees; //for finding the quadrats with trees
+  clTree * p_oTree;
+  stcQuadratRow stcRow; //calculates one row of quadrats
+  float fGli, fX, fY;
+  short int **p_iDeadCodes = p_oPop->GetDeadCodes(),
+  iNumXCells = mp_oQuadrats->GetNumberXCells(),
+  iNumYCells = mp_oQuadrats->GetNumberYCells(),
+  iXCell, iYCell, iSp, iTp;
+  int iNumToDo = 0, iCell, iIsDead, i;
+
+  //Mark the quadrats that need GLI in mp_fCellGli with 0
+  for ( i = 0; i < iNumXCells * iNumYCells; i++ )
+    mp_fCellGli[i] = -1;
+  if ( bAll ) {
+    for ( iXCell = 0; iXCell < iNumXCells; iXCell++ ) {
+      for ( iYCell = 0; iYCell < iNumYCells; iYCell++ ) {
+        mp_oQuadrats->GetValueOfCell( iXCell, iYCell, m_iGridGliCode, & fGli );
+        if ( fGli < 0 ) mp_fCellGli[iXCell * iNumYCells + iYCell] = 0;
+      }
+    }
+  } else {
+    p_oAllTrees = p_oPop->Find( "all" );
+    p_oTree = p_oAllTrees->NextTree();
+    while ( p_oTree ) {
+      iSp = p_oTree->GetSpecies();
+      iTp = p_oTree->GetType();
+      iIsDead = notdead;
+      if ( -1 != p_iDeadCodes[iSp] [iTp] )
+        p_oTree->GetValue( p_iDeadCodes[iSp] [iTp], & iIsDead );
+      if ( this == mp_oLightOrg->GetLightShell( iSp, iTp ) &&
+          notdead == iIsDead ) {
+        p_oTree->GetValue( p_oPop->GetXCode( iSp, iTp ), & fX );
+        p_oTree->GetValue( p_oPop->GetYCode( iSp, iTp ), & fY );
+        mp_oQuadrats->GetCellOfPoint( fX, fY, & iXCell, & iYCell );
+        mp_oQuadrats->GetValueOfCell( iXCell, iYCell, m_iGridGliCode, & fGli );
+        if ( fGli < 0 ) mp_fCellGli[iXCell * iNumYCells + iYCell] = 0;
+      }
+      p_oTree = p_oAllTrees->NextTree();
+    }
+  }
+
+  //List the marked quadrats row by row
+  for ( iXCell = 0; iXCell < iNumXCells; iXCell++ ) {
+    mp_iRowStart[iXCell] = iNumToDo;
+    for ( iYCell = 0; iYCell < iNumYCells; iYCell++ ) {
+      iCell = iXCell * iNumYCells + iYCell;
+      if ( 0 == mp_fCellGli[iCell] ) {
+        mp_iCellsToDo[iNumToDo] = iCell;
+        iNumToDo++;
+      }
+    }
+  }
+  mp_iRowStart[iNumXCells] = iNumToDo;
+  if ( 0 == iNumToDo ) return;
+
+  if ( p_oPool->GetNumThreads() > 1 ) {
+    mp_oLightOrg->CacheCrownDimensions();
+    ReservePhotoArrays( p_oPool->GetNumThreads() );
+  }
+
+  //Calculate each row of quadrats
+  stcRow.p_oLight = this;
+  stcRow.p_oPop = p_oPop;
+  p_oPool->ParallelFor( 0, iNumXCells, stcRow );
+
   //Assign GLI to the grid
-  mp_oQuadrats->SetValueAtPoint( fX, fY, m_iGridGliCode, fGli );
+  for ( i = 0; i < iNumToDo; i++ ) {
+    iCell = mp_iCellsToDo[i];
+    mp_oQuadrats->SetValueOfCell( iCell / iNumYCells, iCell % iNumYCells,
+        m_iGridGliCode, mp_fCellGli[iCell] );
+  }
+}
 
-  return fGli;
+////////////////////////////////////////////////////////////////////////////
+// stcQuadratRow::operator()
+////////////////////////////////////////////////////////////////////////////
+void clQuadratGLILight::stcQuadratRow::operator()(int iX) {
+  float fCellX, fCellY;
+  int iNumYCells = p_oLight->mp_oQuadrats->GetNumberYCells(), iCell, i;
+
+  for ( i = p_oLight->mp_iRowStart[iX]; i < p_oLight->mp_iRowStart[iX + 1];
+      i++ ) {
+    iCell = p_oLight->mp_iCellsToDo[i];
+    p_oLight->mp_oQuadrats->GetPointOfCell( iCell / iNumYCells,
+        iCell % iNumYCells, & fCellX, & fCellY );
+    p_oLight->mp_fCellGli[iCell] = p_oLight->CalcQuadratGli( fCellX, fCellY,
+        p_oLight->GetPhotoArray(), p_oPop );
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// PreLightCalcs()
+////////////////////////////////////////////////////////////////////////////
+void clQuadratGLILight::PreLightCalcs(clTreePopulation * p_oPop) {
+  CalcQuadrats( p_oPop, m_bCalcAll );
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -298,64 +425,9 @@ void clQuadratGLILight::Action() {
   if (!m_bCalcAll)
     return;
 
-  clTreeSearch * p_oShaders; //neighborhood trees who can shade each target
-  clTree * p_oNeighbor; //shading neighbors
-  clPlot * p_oPlot = mp_oSimManager->GetPlotObject();
-  clTreePopulation *p_oPop =
-      (clTreePopulation*) mp_oSimManager->GetPopulationObject("treepopulation");
-  clAllometry * p_oAllom = p_oPop->GetAllometryObject();
-  char cQuery[75]; //format search strings into this
-  float fGli, //global light index - end result of all this math
-      fX, fY; //holders for the tree's X and Y location
-  short int iNumXCells = mp_oQuadrats->GetNumberXCells(), iNumYCells =
-      mp_oQuadrats->GetNumberXCells(), iXCell, iYCell, //quadrat numbers
-      i, j; //loop counter
-
-  for (iXCell = 0; iXCell < iNumXCells; iXCell++) {
-    for (iYCell = 0; iYCell < iNumYCells; iYCell++) {
-
-      mp_oQuadrats->GetValueOfCell(iXCell, iYCell, m_iGridGliCode, &fGli);
-      if (fGli < 0) {
-
-        //First find the point at which to calculate gli - center of the quadrat
-        mp_oQuadrats->GetPointOfCell(iXCell, iYCell, &fX, &fY);
-
-        //Initialize photo array
-        for (i = 0; i < m_iNumAltAng; i++)
-          for (j = 0; j < m_iNumAziAng; j++)
-            mp_fPhoto[i] [j] = 1.0;
-
-        //Get a list of all trees that are within the search radius and taller than
-        //the fish-eye photo height
-        sprintf(cQuery, "%s%f%s%f%s%f%s%f", "distance=", m_fMaxSearchRad,
-            " FROM x=", fX, "y=", fY, "::height=", m_fLightHeight);
-        p_oShaders = p_oPop->Find(cQuery);
-
-        p_oNeighbor = p_oShaders->NextTree();
-        while (p_oNeighbor != NULL) {
-
-          //Skip seedlings, which don't shade
-          if (clTreePopulation::seedling != p_oNeighbor->GetType() )
-
-            //Add the effect of the neighbor to the simulated fisheye photo
-            AddTreeToGliFishEye(fX, fY, m_fLightHeight, p_oNeighbor, p_oPlot,
-                p_oPop, p_oAllom);
-
-          p_oNeighbor = p_oShaders->NextTree();
-        } //end of while (neighbor != NULL)
-
-        //Calculate GLI
-        fGli = 0.0;
-        for (i = 0; i < m_iNumAltAng; i++)
-          for (j = 0; j < m_iNumAziAng; j++)
-            fGli += (mp_fPhoto[i] [j] * mp_fBrightness[i] [j] );
-        fGli *= 100;
-
-        //Assign GLI to the grid
-        mp_oQuadrats->SetValueAtPoint(fX, fY, m_iGridGliCode, fGli);
-      }
-    }
-  }
+  //Calculate any quadrats that were missed
+  CalcQuadrats( ( clTreePopulation * ) mp_oSimManager->GetPopulationObject(
+      "treepopulation" ), true );
 }
 
 ////////////////////////////////////////////////////////////////////////////
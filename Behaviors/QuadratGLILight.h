@@ -35,6 +35,10 @@ class clTreePopulation;
  * <br>Edit history:
  * <br>-----------------
  * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+ * <br>October 17, 2026 - Quadrats are all calculated in PreLightCalcs(), in
+ * parallel where available, so CalcLightValue() is thread-safe (agent)
+ * <br>October 17, 2026 - Quadrats are calculated a row at a time through the
+ * task pool (agent)
  */
 class clQuadratGLILight : public clGLIBase {
 
@@ -49,7 +53,10 @@ public:
    */
   clQuadratGLILight(clSimManager *p_oSimManager);
 
-  //~clQuadratGLILight(); //use default destructor
+  /**
+   * Destructor.
+   */
+  ~clQuadratGLILight();
 
   /**
    * Reads some extra parameters from the parameter file.  If there's no
@@ -70,6 +77,14 @@ public:
    */
   float CalcLightValue(clTree *p_oTree, clTreePopulation *p_oPop);
 
+  /**
+   * Calculates GLI for each quadrat that holds a living tree to which this
+   * behavior applies, or for every quadrat if m_bCalcAll is true. After this,
+   * CalcLightValue() only reads the grid.
+   * @param p_oPop Tree population object.
+   */
+  void PreLightCalcs(clTreePopulation *p_oPop);
+
   /**
    * Resets all the values in the grid to -1.
    */
@@ -117,6 +132,56 @@ protected:
   bool m_bCalcAll; /**<Whether to always calculate all GLIs (true) or only
   calculate on an as-needed basis (false)*/
 
+  /**GLI calculated for each quadrat in CalcQuadrats(), before it is put in
+   * the grid. Array size is number of X cells times number of Y cells, indexed
+   * by (X cell * number of Y cells) + Y cell.*/
+  float *mp_fCellGli;
+
+  /**Index, as in mp_fCellGli, of each quadrat CalcQuadrats() is to calculate,
+   * in index order. Same size as mp_fCellGli.*/
+  int *mp_iCellsToDo;
+
+  /**Where each row of quadrats (one X cell) starts in mp_iCellsToDo. Array
+   * size is number of X cells + 1; the last is the number of quadrats to
+   * do.*/
+  int *mp_iRowStart;
+
+  /**
+   * Calculates GLI for the quadrats to do in one row. This is handed to
+   * clTaskPool::ParallelFor().
+   */
+  struct stcQuadratRow {
+    clQuadratGLILight *p_oLight; /**<Light behavior*/
+    clTreePopulation *p_oPop; /**<Tree population*/
+
+    /**
+     * Calculates each quadrat to do in a row.
+     * @param iX X cell number of the row.
+     */
+    void operator()(int iX);
+  };
+
+  /**
+   * Calculates the GLI at a point at m_fLightHeight.
+   * @param fX X coordinate of the point.
+   * @param fY Y coordinate of the point.
+   * @param p_fPhoto Fisheye photo array to use.
+   * @param p_oPop Tree population object.
+   * @return GLI as a percentage of full sun between 0 and 100.
+   */
+  float CalcQuadratGli(float fX, float fY, float **p_fPhoto,
+      clTreePopulation *p_oPop);
+
+  /**
+   * Calculates GLI for quadrats that don't have it yet and puts it in the grid.
+   * Each row of quadrats is a task for the sim manager's task pool, and each
+   * thread draws into its own fisheye photo.
+   * @param p_oPop Tree population object.
+   * @param bAll If true, every quadrat is calculated. If false, only those
+   * quadrats that hold a living tree to which this behavior applies.
+   */
+  void CalcQuadrats(clTreePopulation *p_oPop, bool bAll);
+
 };
 //---------------------------------------------------------------------------
 #endif
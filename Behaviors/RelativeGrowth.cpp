@@ -21,6 +21,7 @@ clRelativeGrowth::clRelativeGrowth(clSimManager *p_oSimManager) :
     m_fVersionNumber = 1.2;
     m_fMinimumVersionNumber = 1.1;
     mp_fExp = NULL;
+    m_bThreadSafe = true;
 
     m_iNumberYearsPerTimestep = 0;
 }
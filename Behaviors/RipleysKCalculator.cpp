@@ -49,6 +49,9 @@ clRipleysKCalculator::clRipleysKCalculator( clSimManager * p_oSimManager ) : clW
     m_fVersionNumber = 1;
     m_fMinimumVersionNumber = 1;
 
+    //Tree positions go in; only this behavior's own grid comes out
+    m_iResourcesRead = tree_structure;
+    m_iResourcesWritten = own_grid;
   }
   catch ( modelErr & err )
   {
@@ -526,7 +529,7 @@ float *p_fNumTrees, const int &iX, const int &iY)
 ////////////////////////////////////////////////////////////////////////////
 void clRipleysKCalculator::SetUpSearching(clTreePopulation *p_oPop)
 {
-  int iCellSize = p_oPop->GetGridCellSize(),
+  int iCellSize = p_oPop->GetHashCellLength(),
       iNumTotCells = m_iNumXCells * m_iNumYCells,
       i,
       iLimit,           //effective search limit
@@ -39,6 +39,8 @@ class clPlot;
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Declared resources so it can run alongside other
+* behaviors (agent)
 */
 class clRipleysKCalculator : virtual public clBehaviorBase {
   friend class clTestRipleysKCalculator;
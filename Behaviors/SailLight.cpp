@@ -24,6 +24,10 @@ clSailLight::clSailLight(clSimManager * p_oSimManager) :
 
   //Set the namestring
   m_sNameString = "saillightshell";
+
+  //Light is drawn into a per-thread photo and the searches don't use the
+  //population's search objects
+  m_bThreadSafe = true;
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -139,11 +143,10 @@ void clSailLight::DoShellSetup(xercesc::DOMDocument * p_oDoc) {
 // CalcLightValue()
 ////////////////////////////////////////////////////////////////////////////
 float clSailLight::CalcLightValue(clTree * p_oTree, clTreePopulation * p_oPop) {
-  clTreeSearch * p_oShaders; //neighborhood trees who can shade each target
-  clTree * p_oNeighbor; //shading neighbors
+  stcSailShaders stcShaders; //adds shading neighbors to the photo
   clPlot * p_oPlot; //plot object - for calculating distances
   clAllometry * p_oAllom = p_oPop->GetAllometryObject();
-  char cQuery[75]; //format search strings into this
+  float ** p_fPhoto = GetPhotoArray(); //this thread's fisheye photo
   float fTreeHeight, //height of target tree - if fisheye is taken at mid-crown
   //this must be calculated
   fFracShade, //fraction shade - the end result of all this math
@@ -157,7 +160,7 @@ float clSailLight::CalcLightValue(clTree * p_oTree, clTreePopulation * p_oPop) {
   //Initialize photo array
   for ( i = 0; i < m_iNumAltAng; i++ )
     for ( j = 0; j < m_iNumAziAng; j++ )
-      mp_fPhoto[i] [j] = 1.0;
+      p_fPhoto[i] [j] = 1.0;
 
   //Target tree information
   iSpecies = p_oTree->GetSpecies();
@@ -176,27 +179,21 @@ float clSailLight::CalcLightValue(clTree * p_oTree, clTreePopulation * p_oPop) {
   }
   //else ; seedlings are already OK with full tree height
 
-  //Get a list of all trees that are within the search radius and taller than
-  //the fish-eye photo height
-  sprintf( cQuery, "%s%f%s%f%s%f%s%f", "distance=", m_fMaxShadingRadius, " FROM x=", fTargetX, "y=", fTargetY,
-      "::height=", fTreeHeight );
-  p_oShaders = p_oPop->Find( cQuery );
-
-  p_oNeighbor = p_oShaders->NextTree();
-  while ( p_oNeighbor != NULL )
-  {
-
-    //Skip seedlings, which don't shade, and the target tree if returned
-    if ( clTreePopulation::seedling != p_oNeighbor->GetType() && p_oNeighbor != p_oTree )
-    {
-
-      //Add the effect of the neighbor to the simulated fisheye photo
-      AddTreeToSailFishEye( fTargetX, fTargetY, fTreeHeight, p_oNeighbor, p_oPlot, p_oPop, p_oAllom );
-
-    }
-
-    p_oNeighbor = p_oShaders->NextTree();
-  } //end of while (neighbor != NULL)
+  //Add all trees that are within the search radius and taller than the
+  //fish-eye photo height to the photo. Seedlings don't shade, and the target
+  //tree is skipped.
+  stcShaders.p_oLight = this;
+  stcShaders.p_oTarget = p_oTree;
+  stcShaders.p_oPlot = p_oPlot;
+  stcShaders.p_oPop = p_oPop;
+  stcShaders.p_oAllom = p_oAllom;
+  stcShaders.p_fPhoto = p_fPhoto;
+  stcShaders.fX = fTargetX;
+  stcShaders.fY = fTargetY;
+  stcShaders.fHeight = fTreeHeight;
+  p_oPop->ForEachNeighbor( fTargetX, fTargetY, m_fMaxShadingRadius, fTreeHeight,
+      ( 1 << clTreePopulation::sapling ) | ( 1 << clTreePopulation::adult ) |
+      ( 1 << clTreePopulation::snag ), stcShaders );
 
   //Write photo array
   //        fstream brightness("Photo.xls", ios::trunc | ios::out);
@@ -208,7 +205,7 @@ float clSailLight::CalcLightValue(clTree * p_oTree, clTreePopulation * p_oPop) {
   fFracShade = 0.0;
   for ( i = 0; i < m_iNumAltAng; i++ )
     for ( j = 0; j < m_iNumAziAng; j++ )
-      fFracShade += ( mp_fPhoto[i] [j] * mp_fBrightness[i] [j] );
+      fFracShade += ( p_fPhoto[i] [j] * mp_fBrightness[i] [j] );
   fFracShade = 1 - fFracShade;
   if (fFracShade < 0) fFracShade = 0;
   if (fFracShade > 1) fFracShade = 1;
@@ -220,7 +217,8 @@ float clSailLight::CalcLightValue(clTree * p_oTree, clTreePopulation * p_oPop) {
 /////////////////////////////////////////////////////////////////////////////*/
 void clSailLight::AddTreeToSailFishEye(const float & fTargetX,
     const float & fTargetY, const float & fTargetHeight, clTree * p_oNeighbor,
-    clPlot * p_oPlot, clTreePopulation * p_oPop, clAllometry * p_oAllom) {
+    clPlot * p_oPlot, clTreePopulation * p_oPop, clAllometry * p_oAllom,
+    float ** p_fPhoto) {
   try
   {
     float fCrownAngle, //degrees of sky blocked by 0.5 canopy width
@@ -343,7 +341,7 @@ void clSailLight::AddTreeToSailFishEye(const float & fTargetX,
 
       for ( j = iAziStart; j <= iAziEnd; j++ )
       for ( i = iAltStart; i <= iAltEnd; i++ )
-      mp_fPhoto[i] [j] *= fLightExtCoeff;
+      p_fPhoto[i] [j] *= fLightExtCoeff;
       //correct when the tree straddles north
     }
     else
@@ -351,9 +349,9 @@ void clSailLight::AddTreeToSailFishEye(const float & fTargetX,
       for ( i = iAltStart; i <= iAltEnd; i++ )
       {
         for ( j = iAziStart; j < m_iNumAziAng; j++ )
-        mp_fPhoto[i] [j] *= fLightExtCoeff;
+        p_fPhoto[i] [j] *= fLightExtCoeff;
         for ( j = 0; j <= iAziEnd; j++ )
-        mp_fPhoto[i] [j] *= fLightExtCoeff;
+        p_fPhoto[i] [j] *= fLightExtCoeff;
       }
     }
   }
@@ -373,3 +371,13 @@ void clSailLight::AddTreeToSailFishEye(const float & fTargetX,
     throw( stcErr );
   }
 }
+
+////////////////////////////////////////////////////////////////////////////
+// stcSailShaders::operator()
+////////////////////////////////////////////////////////////////////////////
+void clSailLight::stcSailShaders::operator()(clTree * p_oNeighbor,
+    float fDistanceSq) {
+  if ( p_oNeighbor != p_oTarget )
+    p_oLight->AddTreeToSailFishEye( fX, fY, fHeight, p_oNeighbor, p_oPlot,
+        p_oPop, p_oAllom, p_fPhoto );
+}
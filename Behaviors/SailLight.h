@@ -20,6 +20,9 @@
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Thread-safe: finds shading neighbors with
+* clTreePopulation::ForEachNeighbor() and draws into a per-thread photo (agent)
+* <br>October 17, 2026 - Added GetLightReach() (agent)
 */
 class clSailLight : public clLightBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -57,6 +60,17 @@ class clSailLight : public clLightBase {
   */
   float CalcLightValue(clTree *p_oTree, clTreePopulation *p_oPop);
 
+  /**
+  * Gets how far shading neighbors can be from a tree, which is the maximum
+  * shading radius.
+  *
+  * @param p_oTree Tree whose fraction shade is in question.
+  * @param p_oPop Tree population object.
+  * @return Maximum shading radius, in meters.
+  */
+  float GetLightReach(clTree *p_oTree, clTreePopulation *p_oPop)
+    {return m_fMaxShadingRadius;};
+
   protected:
 
   double m_fMaxShadingRadius; /**<Maximum radius at which trees can shade, in meters*/
@@ -82,10 +96,34 @@ class clSailLight : public clLightBase {
   * @param p_oPlot Pointer to the plot object
   * @param p_oPop Pointer to the tree population object
   * @param p_oAllom Pointer to an allometry object
+  * @param p_fPhoto Fisheye photo array to draw the neighbor into
   */
   void AddTreeToSailFishEye(const float &fTargetX, const float &fTargetY, const
     float &fTargetHeight, clTree *p_oNeighbor, clPlot *p_oPlot,
-    clTreePopulation *p_oPop, clAllometry *p_oAllom);
+    clTreePopulation *p_oPop, clAllometry *p_oAllom, float **p_fPhoto);
+
+  /**
+  * Adds each shading neighbor of a target tree to a fisheye photo. This is
+  * handed to clTreePopulation::ForEachNeighbor(), with seedlings masked out.
+  */
+  struct stcSailShaders {
+    clSailLight *p_oLight; /**<Light object doing the drawing*/
+    clTree *p_oTarget; /**<Target tree, which doesn't shade itself*/
+    clPlot *p_oPlot; /**<Plot object*/
+    clTreePopulation *p_oPop; /**<Tree population*/
+    clAllometry *p_oAllom; /**<Allometry object*/
+    float **p_fPhoto; /**<Fisheye photo array to draw into*/
+    float fX; /**<X coordinate of the target*/
+    float fY; /**<Y coordinate of the target*/
+    float fHeight; /**<Height of the photo, in meters*/
+
+    /**
+    * Adds one neighbor to the photo.
+    * @param p_oNeighbor Neighbor.
+    * @param fDistanceSq Squared distance to neighbor. Not used.
+    */
+    void operator()(clTree *p_oNeighbor, float fDistanceSq);
+  };
 };
 //---------------------------------------------------------------------------
 #endif
@@ -18,6 +18,7 @@ clSenescenceMort::clSenescenceMort( clSimManager * p_oSimManager ) : clWorkerBas
 
     m_sNameString = "senescencemortshell";
     m_sXMLRoot = "Senescence";
+    m_bThreadSafe = true;
 
     mp_fRandomAlpha = NULL;
     mp_fRandomBeta = NULL;
@@ -139,10 +140,19 @@ void clSenescenceMort::DoShellSetup( xercesc::DOMDocument * p_oDoc )
 // DoMort()
 ////////////////////////////////////////////////////////////////////////////
 deadCode clSenescenceMort::DoMort(clTree * p_oTree, const float & fDiam, const short int & iSpecies )
+{
+  return DoThreadSafeMort(p_oTree, fDiam, iSpecies, clModelMath::randgen);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// DoThreadSafeMort()
+////////////////////////////////////////////////////////////////////////////
+deadCode clSenescenceMort::DoThreadSafeMort(clTree * p_oTree,
+    const float & fDiam, const short int & iSpecies, gsl_rng *p_oStream)
 {
   double fFracDbh, fIntDbh; //for splitting diam into integer and
   //fractional parts
-  float fRandom = clModelMath::GetRand(), fDeathProb; //probability of death for this tree
+  float fRandom = clModelMath::GetRand(p_oStream), fDeathProb; //probability of death for this tree
 
   //Split the diameter into integer and fractional parts
   fFracDbh = modf( ( double )fDiam, & fIntDbh );
@@ -24,6 +24,7 @@
  * <br>Edit history:
  * <br>-----------------
  * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+ * <br>October 17, 2026 - Thread-safe, drawing from random streams (agent)
  */
 
 class clSenescenceMort : virtual public clMortalityBase {
@@ -57,6 +58,18 @@ public:
    */
   deadCode DoMort(clTree *p_oTree, const float &fDiam, const short int &iSpecies);
 
+  /**
+   * Calculates mortality according to senescence, drawing from a random
+   * stream.
+   * @param fDiam DBH of tree being evaluated - for seedlings will be 0
+   * @param p_oTree Tree being evaluated
+   * @param iSpecies Species of the tree being evaluated
+   * @param p_oStream Random stream to draw from.
+   * @return natural if the tree is to die, notdead if it lives.
+   */
+  deadCode DoThreadSafeMort(clTree *p_oTree, const float &fDiam,
+      const short int &iSpecies, gsl_rng *p_oStream);
+
 protected:
 
   doubleVal *mp_fRandomAlpha; /**<Random mortality alpha, for calculating annual probability of death.  Array size is number of species to which this behavior applies.*/
@@ -29,6 +29,7 @@ clSizeDepLogisticGrowth::clSizeDepLogisticGrowth( clSimManager * p_oSimManager )
 
     m_sNameString = "sizedeplogisticgrowthshell";
     m_sXMLRoot = "SizeDependentLogisticGrowth";
+    m_bThreadSafe = true;
   }
   catch ( modelErr & err )
   {
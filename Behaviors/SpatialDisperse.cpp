@@ -992,14 +992,7 @@ void clSpatialDispersal::AddSeeds()
         //let it reproduce
         if ( fDbh >= mp_fDbhForReproduction[mp_iIndexes[iSp]] ) {
 
-          if ( m_bIsGap )
-          {
-            SpatialDisperse( p_oTree, p_oPop, p_oPlot, fDbh );
-          }
-          else
-          {
-            NonSpatialDisperse( p_oTree, p_oPop, p_oPlot, fDbh );
-          }
+          AddParent( p_oTree, fDbh, p_oPop, p_oPlot );
         }
       }
 
@@ -1026,19 +1019,15 @@ void clSpatialDispersal::AddSeeds()
           //let it reproduce
           if ( fDbh >= mp_fDbhForReproduction[mp_iIndexes[iSp]] ) {
 
-            if ( m_bIsGap )
-            {
-              SpatialDisperse( p_oTree, p_oPop, p_oPlot, fDbh );
-            }
-            else
-            {
-              NonSpatialDisperse( p_oTree, p_oPop, p_oPlot, fDbh );
-            }
+            AddParent( p_oTree, fDbh, p_oPop, p_oPlot );
           }
         }
         p_oTree = p_oTree->GetTaller();
       }
     } //end of if (m_bStumps)
+
+    //Disperse the parents' seeds
+    DisperseParents( p_oPop, p_oPlot );
   }
   catch ( modelErr & err )
   {
@@ -1057,10 +1046,25 @@ void clSpatialDispersal::AddSeeds()
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// DisperseOneParent
+//////////////////////////////////////////////////////////////////////////////
+void clSpatialDispersal::DisperseOneParent( clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh, float * p_fSeeds, gsl_rng * p_oStream )
+{
+  if ( m_bIsGap )
+  {
+    SpatialDisperse( p_oTree, p_oPop, p_oPlot, fDbh, p_fSeeds, p_oStream );
+  }
+  else
+  {
+    NonSpatialDisperse( p_oTree, p_oPop, p_oPlot, fDbh, p_fSeeds, p_oStream );
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // SpatialDisperse
 ///////////////////////////////////////////////////////////////////////////////
-void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh )
+void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh, float * p_fSeeds, gsl_rng * p_oStream )
 {
   try
   {
@@ -1076,7 +1080,6 @@ void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p
          fAngle, //angle from the parent tree from which a seed lands
          fSurvivalChance, //ratio of gap to canopy fecundity
          fStepDistance, //distance we cover in a step between two seed positions
-         fNumGridSeeds, //number of seeds in the seedling grid
          fWalkDistance, //distance to walk when adjusting seed position
          fNumSeeds, //number of seeds produced by one tree
          f, //loop counter for working with seeds
@@ -1128,11 +1131,11 @@ void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p
       //STR and canopy STR.
       if ( mp_fStr[canopy] [iSpIndex] >= mp_fStr[gap] [iSpIndex] )
       {
-        fNumSeeds = GetNumberOfSeeds( fDbh, iSp, canopy, iCanFunc );
+        fNumSeeds = GetNumberOfSeeds( fDbh, iSp, canopy, iCanFunc, p_oStream );
       }
       else
       {
-        fNumSeeds = GetNumberOfSeeds( fDbh, iSp, gap, iGapFunc );
+        fNumSeeds = GetNumberOfSeeds( fDbh, iSp, gap, iGapFunc, p_oStream );
       }
 
       fSurvivalChance = ( mp_fStr[gap] [iSpIndex] * ( pow( ( fDbh / 30 ), mp_fBeta[gap] [iSpIndex] ) ) )
@@ -1152,7 +1155,7 @@ void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p
       //Use the cumulative probability array to determine how far away from the
       //parent tree the seed lands - use a random number and find the first
       //probability array bucket with a value greater than the random
-      fRand = clModelMath::GetRand();
+      fRand = clModelMath::GetRand( p_oStream );
       if ( fRand == 0 )
         fRand = 0.0001; //prevent error when the probability at 1 meter is 0
 
@@ -1178,7 +1181,7 @@ void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p
            / ( mp_fCumProb[iFunction] [iCover] [iSpIndex] [iDistanceCounter] - fPrevBucket ) );
 
       //Get a random direction to pitch the seed
-      fRand = clModelMath::GetRand();
+      fRand = clModelMath::GetRand( p_oStream );
       //Prevent errors when fRand is 0 or 1
       if ( fRand == 0 ) fRand = 0.0001;
       if ( fRand == 1 ) fRand = 0.9999;
@@ -1200,7 +1203,7 @@ void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p
       { //lower gap STR
         if ( bIsSeedInGap )
         {
-          fRand = clModelMath::GetRand();
+          fRand = clModelMath::GetRand( p_oStream );
           if ( fRand <= fSurvivalChance ) bSurvives = true;
           else
             bSurvives = false;
@@ -1212,7 +1215,7 @@ void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p
       { //lower canopy STR
         if ( !bIsSeedInGap )
         {
-          fRand = clModelMath::GetRand();
+          fRand = clModelMath::GetRand( p_oStream );
           if ( fRand <= 1 / fSurvivalChance ) bSurvives = true;
           else
             bSurvives = false;
@@ -1239,7 +1242,7 @@ void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p
       {
         //Recalc dispersal distance as if it dispersed from canopy
         iDistanceCounter = 0;
-        fRand = clModelMath::GetRand();
+        fRand = clModelMath::GetRand( p_oStream );
         while ( fRand > mp_fCumProb[iCanFunc] [canopy] [iSpIndex] [iDistanceCounter] )
           iDistanceCounter++;
         fPrevBucket = ( iDistanceCounter == 0 ) ? 0.0 : mp_fCumProb[iCanFunc] [canopy] [iSpIndex] [iDistanceCounter - 1];
@@ -1268,7 +1271,7 @@ void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p
 
           //Calculate dispersal distance again as though parent were also in gap
           iDistanceCounter = 0;
-          fRand = clModelMath::GetRand();
+          fRand = clModelMath::GetRand( p_oStream );
           while ( fRand > mp_fCumProb[iGapFunc] [gap] [iSpIndex] [iDistanceCounter] )
             iDistanceCounter++;
           fPrevBucket = ( iDistanceCounter == 0 ) ? 0.0 : mp_fCumProb[iGapFunc] [gap] [iSpIndex] [iDistanceCounter - 1];
@@ -1319,10 +1322,8 @@ void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p
 
     plantSeed:
 
-      //Increment the seed counter at the seed's location in the grid
-      mp_oSeedGrid->GetValueAtPoint( fSeedX, fSeedY, mp_iNumSeedsCode[iSp], & fNumGridSeeds );
-      fNumGridSeeds++;
-      mp_oSeedGrid->SetValueAtPoint( fSeedX, fSeedY, mp_iNumSeedsCode[iSp], fNumGridSeeds );
+      //Increment the seed counter at the seed's location in the buffer
+      AddSeedAtPoint( p_fSeeds, fSeedX, fSeedY, iSp );
 
 
     nextSeed:;
@@ -1349,7 +1350,7 @@ void clSpatialDispersal::SpatialDisperse( clTree * p_oTree, clTreePopulation * p
 //////////////////////////////////////////////////////////////////////////////
 // NonSpatialDisperse
 //////////////////////////////////////////////////////////////////////////////
-void clSpatialDispersal::NonSpatialDisperse( clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh )
+void clSpatialDispersal::NonSpatialDisperse( clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh, float * p_fSeeds, gsl_rng * p_oStream )
 {
   try
   {
@@ -1358,7 +1359,6 @@ void clSpatialDispersal::NonSpatialDisperse( clTree * p_oTree, clTreePopulation
     fDistance, //distance from the parent tree at which a seed lands
     fPrevBucket, //value in the previous bucket of the probability array
     fX, fY, //coordinates of tree
-    fNumGridSeeds, //number of seeds in the seed grid
     fSeedX, fSeedY, //coordinates of seed
     fAngle, //angle from the parent tree from which a seed lands
     fNumSeeds, //number of seeds produced by the tree
@@ -1375,7 +1375,7 @@ void clSpatialDispersal::NonSpatialDisperse( clTree * p_oTree, clTreePopulation
 
     //Calculate number of seeds produced, based on species
     //fecundity and the dbh of the tree
-    fNumSeeds = GetNumberOfSeeds( fDbh, iSp, canopy, iCanFunc );
+    fNumSeeds = GetNumberOfSeeds( fDbh, iSp, canopy, iCanFunc, p_oStream );
 
     //Disperse the seeds produced
     for ( f = 0; f < fNumSeeds; f++ )
@@ -1384,7 +1384,7 @@ void clSpatialDispersal::NonSpatialDisperse( clTree * p_oTree, clTreePopulation
       //parent tree the seed lands - use a random number and find the first
       //probability array bucket with a value greater than the random
       iDistanceCounter = 0;
-      fRand = clModelMath::GetRand();
+      fRand = clModelMath::GetRand( p_oStream );
       while ( fRand > mp_fCumProb[iCanFunc] [canopy] [iSpIndex] [iDistanceCounter] )
         iDistanceCounter++;
 
@@ -1396,7 +1396,7 @@ void clSpatialDispersal::NonSpatialDisperse( clTree * p_oTree, clTreePopulation
            / ( mp_fCumProb[iCanFunc] [canopy] [iSpIndex] [iDistanceCounter] - fPrevBucket ) );
 
       //Get a random direction to pitch the seed
-      fRand = clModelMath::GetRand();
+      fRand = clModelMath::GetRand( p_oStream );
       fAngle = 2.0 * M_PI * fRand;
       fAngle = std::max(2.0 * M_PI * fRand, (2.0 * M_PI)-0.00001);
 
@@ -1404,10 +1404,8 @@ void clSpatialDispersal::NonSpatialDisperse( clTree * p_oTree, clTreePopulation
       fSeedX = p_oPlot->CorrectX( cos( fAngle ) * fDistance + fX );
       fSeedY = p_oPlot->CorrectY( sin( fAngle ) * fDistance + fY );
 
-      //Increment the seed counter at the seed's location in the grid
-      mp_oSeedGrid->GetValueAtPoint( fSeedX, fSeedY, mp_iNumSeedsCode[iSp], & fNumGridSeeds );
-      fNumGridSeeds++;
-      mp_oSeedGrid->SetValueAtPoint( fSeedX, fSeedY, mp_iNumSeedsCode[iSp], fNumGridSeeds );
+      //Increment the seed counter at the seed's location in the buffer
+      AddSeedAtPoint( p_fSeeds, fSeedX, fSeedY, iSp );
     } //end of for (i = 0; i < iNumSeeds; i++)
   }
   catch ( modelErr & err )
@@ -1582,10 +1580,10 @@ void clSpatialDispersal::SetNameData(std::string sNameString)
 ////////////////////////////////////////////////////////////////////////////
 // GetNumberOfSeeds()
 ////////////////////////////////////////////////////////////////////////////
-float clSpatialDispersal::GetNumberOfSeeds(float fDbh, short int iSp, int iCover, int iFunc )
+float clSpatialDispersal::GetNumberOfSeeds(float fDbh, short int iSp, int iCover, int iFunc, gsl_rng * p_oStream )
 {
   return clModelMath::RandomRound( mp_fFecundity[iFunc] [iCover] [mp_iIndexes[iSp]]
-       * pow( fDbh, mp_fBeta[iCover] [mp_iIndexes[iSp]] ) * m_iNumYearsPerTimestep );
+       * pow( fDbh, mp_fBeta[iCover] [mp_iIndexes[iSp]] ) * m_iNumYearsPerTimestep, p_oStream );
 }
 
 /*/ ////////////////////////////////////////////////////////////////////////////
@@ -45,6 +45,9 @@ class clTree;
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
 * <br>April 2, 2021 - Unified beta and STR for the two functions because
 * those are always the same
+* <br>October 17, 2026 - Parents are dispersed through
+* clDisperseBase::DisperseParents(), in parallel from per-parent random
+* streams if di_parallelDispersal is set (agent)
 */
 class clSpatialDispersal : virtual public clDisperseBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -209,8 +212,10 @@ protected:
   * @param fDbh DBH of the tree, in cm.
   * @param p_oPlot Plot object
   * @param p_oPop Tree Population object
+  * @param p_fSeeds Seed buffer to add seeds to.
+  * @param p_oStream Random stream to draw from.
   */
-  void SpatialDisperse(clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh );
+  void SpatialDisperse(clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh, float * p_fSeeds, gsl_rng * p_oStream );
 
   /**
   * Performs dispersal of seeds for one tree according to non-gap disperse.
@@ -225,8 +230,22 @@ protected:
   * @param fDbh DBH of the tree, in cm.
   * @param p_oPlot Plot object
   * @param p_oPop Tree Population object
+  * @param p_fSeeds Seed buffer to add seeds to.
+  * @param p_oStream Random stream to draw from.
   */
-  void NonSpatialDisperse(clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh );
+  void NonSpatialDisperse(clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh, float * p_fSeeds, gsl_rng * p_oStream );
+
+  /**
+  * Disperses one parent's seeds with SpatialDisperse() or NonSpatialDisperse().
+  * This is called by clDisperseBase::DisperseParents().
+  * @param p_oTree Parent tree.
+  * @param p_oPop Tree Population object
+  * @param p_oPlot Plot object
+  * @param fDbh DBH of the tree, in cm.
+  * @param p_fSeeds Seed buffer to add seeds to.
+  * @param p_oStream Random stream to draw from.
+  */
+  void DisperseOneParent(clTree * p_oTree, clTreePopulation * p_oPop, clPlot * p_oPlot, float fDbh, float * p_fSeeds, gsl_rng * p_oStream );
 
   /**
   * Extracts needed parameter file data.  This function takes into account
@@ -291,8 +310,10 @@ protected:
 
   /**
   * Performs dispersal.  This searches for all types to which it is applied.
-  * For trees which are of the appropriate species/type combo, either
-  * SpatialDisperse() or NonSpatialDisperse() is called.
+  * Trees which are of the appropriate species/type combo and big enough to
+  * reproduce are handed to clDisperseBase::AddParent() and
+  * DisperseParents(), which call either SpatialDisperse() or
+  * NonSpatialDisperse() for each.
   */
   void AddSeeds();
 
@@ -306,9 +327,10 @@ protected:
   * @param iSp Tree species number
   * @param iCover Forest cover
   * @param iFunc Disperse function used
+  * @param p_oStream Random stream to draw from.
   * @return Number of seeds.
   */
-  float GetNumberOfSeeds(float fDbh, short int iSp, int iCover, int iFunc);
+  float GetNumberOfSeeds(float fDbh, short int iSp, int iCover, int iFunc, gsl_rng * p_oStream);
 
 };
 //---------------------------------------------------------------------------
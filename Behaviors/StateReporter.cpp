@@ -27,6 +27,10 @@ clStateReporter::clStateReporter( clSimManager * p_oSimManager ) : clWorkerBase(
     m_fVersionNumber = 1;
     m_fMinimumVersionNumber = 1;
 
+    //Climate goes in; only this behavior's own grid comes out
+    m_iResourcesRead = plot_climate;
+    m_iResourcesWritten = own_grid;
+
     mp_oGrid = NULL;
     m_iPrecipGridCode = -1;
     m_iTempGridCode = -1;
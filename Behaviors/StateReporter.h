@@ -23,6 +23,8 @@ class clGrid;
 * <br>Edit history:
 * <br>-----------------
 * <br>January 7, 2010 - Created (LEM)
+* <br>October 17, 2026 - Declared resources so it can run alongside other
+* behaviors (agent)
 */
 class clStateReporter : virtual public clBehaviorBase {
   public:
@@ -34,6 +34,8 @@ clStochDoubleLogTempDepNeighDisperse::clStochDoubleLogTempDepNeighDisperse( clSi
     mp_fCh = NULL;
     mp_fA = NULL;
     mp_fB = NULL;
+    mp_fFecundity = NULL;
+    mp_bPresent = NULL;
 
     m_fRadius = 0;
     m_fMinSaplingHeight = 0;
@@ -83,6 +85,8 @@ clStochDoubleLogTempDepNeighDisperse::~clStochDoubleLogTempDepNeighDisperse()
   delete[] mp_fCh;
   delete[] mp_fA;
   delete[] mp_fB;
+  delete[] mp_fFecundity;
+  delete[] mp_bPresent;
 }
 
 
@@ -249,10 +253,6 @@ void clStochDoubleLogTempDepNeighDisperse::DoShellSetup( DOMDocument * p_oDoc )
 ////////////////////////////////////////////////////////////////////////////
 void clStochDoubleLogTempDepNeighDisperse::AddSeeds()
 {
-  float *p_fBAC = NULL,
-        *p_fFecundity = NULL;
-  bool *p_bPresent = NULL;
-
   try
   {
     clTreePopulation * p_oPop = ( clTreePopulation * ) mp_oSimManager->GetPopulationObject( "treepopulation" );
@@ -260,46 +260,30 @@ void clStochDoubleLogTempDepNeighDisperse::AddSeeds()
     clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
     clTree * p_oNeighbor; //competing neighbor
     char cQuery[75]; //format search strings into this
-    int iNumXCells = mp_oSeedGrid->GetNumberXCells(), //number x cells in seed grid
-        iNumYCells = mp_oSeedGrid->GetNumberYCells(), //number y cells in seed grid
-        iTotalNumSpecies = p_oPop->GetNumberOfSpecies();
-    float fNumGridSeeds, //seeds already in one grid cell
-          fTemp,
-          fMeanTempC = p_oPlot->GetMeanAnnualTemp(),
+    int iTotalNumSpecies = p_oPop->GetNumberOfSpecies();
+    float fMeanTempC = p_oPlot->GetMeanAnnualTemp(),
           fMeanTempK = fMeanTempC + 273.15,
-          fNeighDbh, //DBH of neighbors for calculating basal area
-          //grid cell lengths in the middle of the grid
-          fMidX = mp_oSeedGrid->GetLengthXCells(),
-          fMidY = mp_oSeedGrid->GetLengthYCells(),
-          fMidArea = fMidX * fMidY, //shortcut
-          //possible short grid cell lengths on the edge of the grid
-          fEndX = p_oPlot->GetXPlotLength() - ((iNumXCells - 1)*fMidX),
-          fEndY = p_oPlot->GetYPlotLength() - ((iNumYCells - 1)*fMidY),
-          fArea, //one cell's area
-          fPCc, fPCa,
-          fCellX, fCellY; //one cell's X and Y dimensions
-    int iNumYrs = mp_oSimManager->GetNumberOfYearsPerTimestep();
-    short int i, iSpecies,
-              iNeighSpecies, iNeighType,
-              iX, iY;
+          fPCc, fPCa;
+    short int i, iSpecies;
 
-    p_fBAC = new float[iTotalNumSpecies];
-    p_fFecundity = new float[iTotalNumSpecies];
-    p_bPresent = new bool[iTotalNumSpecies];
+    if ( NULL == mp_fFecundity ) {
+      mp_fFecundity = new float[iTotalNumSpecies];
+      mp_bPresent = new bool[iTotalNumSpecies];
+    }
 
     //Determine if there are any species that have no adults present in the
     //plot
-    for ( i = 0; i < iTotalNumSpecies; i++ ) p_bPresent[i] = true;
+    for ( i = 0; i < iTotalNumSpecies; i++ ) mp_bPresent[i] = true;
     for ( i = 0; i < m_iNumBehaviorSpecies; i++ )
-      p_bPresent[mp_iWhatSpecies[i]] = false; //Species this behavior is not
+      mp_bPresent[mp_iWhatSpecies[i]] = false; //Species this behavior is not
     //applied to are now set to true
     iSpecies = iTotalNumSpecies - m_iNumBehaviorSpecies;
     sprintf(cQuery, "type=%d", clTreePopulation::adult);
     p_oAllNeighbors = p_oPop->Find(cQuery);
     p_oNeighbor = p_oAllNeighbors->NextTree();
     while (p_oNeighbor && iSpecies < iTotalNumSpecies) {
-      if (false == p_bPresent[p_oNeighbor->GetSpecies()]) {
-        p_bPresent[p_oNeighbor->GetSpecies()] = true;
+      if (false == mp_bPresent[p_oNeighbor->GetSpecies()]) {
+        mp_bPresent[p_oNeighbor->GetSpecies()] = true;
         iSpecies++;
       }
       p_oNeighbor = p_oAllNeighbors->NextTree();
@@ -308,7 +292,7 @@ void clStochDoubleLogTempDepNeighDisperse::AddSeeds()
     //For any species not present, do colonization
     for ( i = 0; i < m_iNumBehaviorSpecies; i++ ) {
       iSpecies = mp_iWhatSpecies[i];
-      if (false == p_bPresent[iSpecies]) {
+      if (false == mp_bPresent[iSpecies]) {
 
         //Calculate cumulative probability of colonization
         fPCc = mp_fPA[iSpecies] * exp(-0.5*pow((fMeanTempC - mp_fPM[iSpecies])/mp_fPB[iSpecies],2));
@@ -316,7 +300,7 @@ void clStochDoubleLogTempDepNeighDisperse::AddSeeds()
         //Calculate annualized probability of colonization
         fPCa = 1-pow((1-fPCc),(1/m_fAnnualizePeriod));
         if (clModelMath::GetRand() <= fPCa) //colonize
-          p_bPresent[iSpecies] = true;
+          mp_bPresent[iSpecies] = true;
       }
     }
 
@@ -324,108 +308,123 @@ void clStochDoubleLogTempDepNeighDisperse::AddSeeds()
     if (m_bFecTempDep) {
       for ( i = 0; i < m_iNumBehaviorSpecies; i++ ) {
         iSpecies = mp_iWhatSpecies[i];
-        p_fFecundity[iSpecies] = mp_fB[iSpecies] *
+        mp_fFecundity[iSpecies] = mp_fB[iSpecies] *
             (mp_fAl[iSpecies] + ((1-mp_fAl[iSpecies])/(1+pow(mp_fBl[iSpecies]/fMeanTempK , mp_fCl[iSpecies])))) *
             (mp_fAh[iSpecies] + ((1-mp_fAh[iSpecies])/(1+pow(fMeanTempK /mp_fBh[iSpecies], mp_fCh[iSpecies]))));
       }
     } else {
       for ( i = 0; i < m_iNumBehaviorSpecies; i++ ) {
         iSpecies = mp_iWhatSpecies[i];
-        p_fFecundity[iSpecies] = mp_fB[iSpecies] ;
+        mp_fFecundity[iSpecies] = mp_fB[iSpecies] ;
       }
     }
 
-    //Loop through the grid cells of the seed grid and put seeds in each
-    for ( iX = 0; iX < iNumXCells; iX++ ) {
-      for ( iY = 0; iY < iNumYCells; iY++ ) {
-
-        //Get the area of this cell, correcting for possible short edges
-        if (iX != iNumXCells - 1 && iY != iNumYCells - 1) fArea = fMidArea;
-        else {
-          if (iX == iNumXCells - 1) fCellX = fEndX;
-          else fCellX = fMidX;
-          if (iY == iNumYCells - 1) fCellY = fEndY;
-          else fCellY = fMidY;
-          fArea = fCellX * fCellY;
-        }
-        //Turn into correction factor
-        fArea /= m_fAnalysisPlotSize;
-
-        //Get the coordinates of the grid cell center - dangerously reuse
-        //fCellX and fCellY
-        mp_oSeedGrid->GetPointOfCell(iX, iY, &fCellX, &fCellY);
-
-        //Get conspecific adult basal area for each species in the neighborhood
-        //of this grid cell
-        for (i=0; i<iTotalNumSpecies; i++)
-          p_fBAC[i] = 0;
-        sprintf( cQuery, "%s%f%s%f%s%f%s%f", "distance=", m_fRadius,
-            "FROM x=", fCellX, "y=", fCellY, "::height=", m_fMinSaplingHeight );
-        p_oAllNeighbors = p_oPop->Find( cQuery );
-        p_oNeighbor = p_oAllNeighbors->NextTree();
-        while ( p_oNeighbor ) {
-          iNeighType = p_oNeighbor->GetType();
-          if ( clTreePopulation::adult == iNeighType) {
-            iNeighSpecies = p_oNeighbor->GetSpecies();
-            //Get the neighbor's dbh
-            p_oNeighbor->GetValue(p_oPop->GetDbhCode(iNeighSpecies, iNeighType),
-                & fNeighDbh );
-            p_fBAC[iNeighSpecies] += clModelMath::CalculateBasalArea(fNeighDbh);
-          }
-          p_oNeighbor = p_oAllNeighbors->NextTree();
-        }
+    //Put seeds in each grid cell of the seed grid
+    DisperseCells( p_oPop, p_oPlot );
+  }
+  catch ( modelErr & err )
+  {
+    throw( err );
+  }
+  catch ( modelMsg & msg )
+  {
+    throw( msg );
+  } //non-fatal error
+  catch ( ... )
+  {
+    modelErr stcErr;
+    stcErr.iErrorCode = UNKNOWN;
+    stcErr.sFunction = "clStochDoubleLogTempDepNeighDisperse::AddSeeds" ;
+    throw( stcErr );
+  }
+}
 
-        //Calculate the number of seeds for each species
-        for (i = 0; i < m_iNumBehaviorSpecies; i++) {
+////////////////////////////////////////////////////////////////////////////
+// DisperseOneCell()
+////////////////////////////////////////////////////////////////////////////
+void clStochDoubleLogTempDepNeighDisperse::DisperseOneCell( int iX, int iY,
+    clTreePopulation * p_oPop, clPlot * p_oPlot, float * p_fSeeds,
+    gsl_rng * p_oStream )
+{
+  float *p_fBAC = NULL;
 
-          iSpecies = mp_iWhatSpecies[i];
-          if (p_bPresent[iSpecies]) {
+  try
+  {
+    stcAdultBasalArea stcBA; //adds up basal area of neighbors
+    int iNumXCells = mp_oSeedGrid->GetNumberXCells(), //number x cells in seed grid
+        iNumYCells = mp_oSeedGrid->GetNumberYCells(), //number y cells in seed grid
+        iTotalNumSpecies = p_oPop->GetNumberOfSpecies();
+    float fNumGridSeeds, //seeds for one species in this grid cell
+          //grid cell lengths in the middle of the grid
+          fMidX = mp_oSeedGrid->GetLengthXCells(),
+          fMidY = mp_oSeedGrid->GetLengthYCells(),
+          fArea, //this cell's area
+          fCellX, fCellY; //this cell's X and Y dimensions
+    int iNumYrs = mp_oSimManager->GetNumberOfYearsPerTimestep();
+    short int i, iSpecies;
+
+    //Get the area of this cell, correcting for possible short edges
+    if (iX == iNumXCells - 1) fCellX = p_oPlot->GetXPlotLength() - ((iNumXCells - 1)*fMidX);
+    else fCellX = fMidX;
+    if (iY == iNumYCells - 1) fCellY = p_oPlot->GetYPlotLength() - ((iNumYCells - 1)*fMidY);
+    else fCellY = fMidY;
+    fArea = fCellX * fCellY;
+    //Turn into correction factor
+    fArea /= m_fAnalysisPlotSize;
+
+    //Get the coordinates of the grid cell center - dangerously reuse
+    //fCellX and fCellY
+    mp_oSeedGrid->GetPointOfCell(iX, iY, &fCellX, &fCellY);
+
+    //Get conspecific adult basal area for each species in the neighborhood
+    //of this grid cell
+    p_fBAC = new float[iTotalNumSpecies];
+    for (i=0; i<iTotalNumSpecies; i++)
+      p_fBAC[i] = 0;
+    stcBA.p_oPop = p_oPop;
+    stcBA.p_fBasalArea = p_fBAC;
+    p_oPop->ForEachNeighbor(fCellX, fCellY, m_fRadius, m_fMinSaplingHeight,
+        1 << clTreePopulation::adult, stcBA);
 
-            fNumGridSeeds = mp_fA[iSpecies] + p_fFecundity[iSpecies] * p_fBAC[iSpecies];
+    //Calculate the number of seeds for each species
+    for (i = 0; i < m_iNumBehaviorSpecies; i++) {
 
-            //Poisson draw if appropriate
-            if (!m_bDeterministic) {
-              fNumGridSeeds = clModelMath::PoissonRandomDraw(fNumGridSeeds);
-            }
+      iSpecies = mp_iWhatSpecies[i];
+      if (mp_bPresent[iSpecies]) {
 
-            //Scale to seeds per grid cell per timestep
-            fNumGridSeeds *= iNumYrs * fArea;
+        fNumGridSeeds = mp_fA[iSpecies] + mp_fFecundity[iSpecies] * p_fBAC[iSpecies];
 
-            //Place the seeds in the seed grid
-            mp_oSeedGrid->GetValueOfCell( iX, iY, mp_iNumSeedsCode[mp_iWhatSpecies[i]], & fTemp );
-            fTemp += fNumGridSeeds;
-            mp_oSeedGrid->SetValueOfCell( iX, iY, mp_iNumSeedsCode[mp_iWhatSpecies[i]], fTemp );
-          }
+        //Poisson draw if appropriate
+        if (!m_bDeterministic) {
+          fNumGridSeeds = clModelMath::PoissonRandomDraw(fNumGridSeeds, p_oStream);
         }
+
+        //Scale to seeds per grid cell per timestep
+        fNumGridSeeds *= iNumYrs * fArea;
+
+        //Place the seeds in the seed buffer
+        AddSeedsToCell( p_fSeeds, iX, iY, iSpecies, fNumGridSeeds );
       }
     }
 
     delete[] p_fBAC;
-    delete[] p_fFecundity;
-    delete[] p_bPresent;
   }
   catch ( modelErr & err )
   {
     delete[] p_fBAC;
-    delete[] p_fFecundity;
-    delete[] p_bPresent;
     throw( err );
   }
   catch ( modelMsg & msg )
   {
     delete[] p_fBAC;
-    delete[] p_fFecundity;
-    delete[] p_bPresent;
     throw( msg );
   } //non-fatal error
   catch ( ... )
   {
     delete[] p_fBAC;
-    delete[] p_fFecundity;
-    delete[] p_bPresent;
     modelErr stcErr;
     stcErr.iErrorCode = UNKNOWN;
-    stcErr.sFunction = "clStochDoubleLogTempDepNeighDisperse::AddSeeds" ;
+    stcErr.sFunction = "clStochDoubleLogTempDepNeighDisperse::DisperseOneCell" ;
     throw( stcErr );
   }
 }
@@ -71,6 +71,9 @@
  * <br>Edit history:
  * <br>-----------------
  * <br>February 20, 2014 - Created (LEM)
+ * <br>October 17, 2026 - Grid cells are filled through
+ * clDisperseBase::DisperseCells(); if di_parallelDispersal is set, Poisson
+ * draws come from per-cell random streams (agent)
  */
 class clStochDoubleLogTempDepNeighDisperse : virtual public clDisperseBase {
 
@@ -122,6 +125,13 @@ class clStochDoubleLogTempDepNeighDisperse : virtual public clDisperseBase {
   /** B parameter - sized number of species.*/
   double *mp_fB;
 
+  /** Fecundity term for this timestep - sized total number of species.*/
+  float *mp_fFecundity;
+
+  /** Whether each species is present or colonizing this timestep - sized total
+   * number of species.*/
+  bool *mp_bPresent;
+
   /** Neighborhood search radius.*/
   double m_fRadius;
 
@@ -147,10 +157,25 @@ class clStochDoubleLogTempDepNeighDisperse : virtual public clDisperseBase {
   void DoShellSetup(xercesc::DOMDocument *p_oDoc);
 
   /**
-   * Does dispersal.
+   * Does dispersal. This decides which species are present or colonizing and
+   * calculates each species's fecundity, then each grid cell gets its seeds
+   * from DisperseOneCell().
    */
   void AddSeeds();
 
+  /**
+   * Adds seeds to one grid cell, from the neighborhood basal area of each
+   * species. This is called by clDisperseBase::DisperseCells().
+   * @param iX X grid cell number.
+   * @param iY Y grid cell number.
+   * @param p_oPop Tree population.
+   * @param p_oPlot Plot object.
+   * @param p_fSeeds Seed buffer to add seeds to.
+   * @param p_oStream Random stream to draw from.
+   */
+  void DisperseOneCell(int iX, int iY, clTreePopulation *p_oPop,
+      clPlot *p_oPlot, float *p_fSeeds, gsl_rng *p_oStream);
+
 };
 //---------------------------------------------------------------------------
 #endif
@@ -18,6 +18,7 @@ clStochasticMort::clStochasticMort(clSimManager *p_oSimManager) :
 
    m_sNameString = "stochasticmortshell";
    m_sXMLRoot = "StochasticMortality";
+   m_bThreadSafe = true;
    mp_fRandomMort = NULL;
  }
  catch (modelErr&err) {throw(err);}
@@ -86,7 +87,15 @@ void clStochasticMort::DoShellSetup(xercesc::DOMDocument *p_oDoc) {
 ///////////////////////////////////////////////////////////////////////////
 deadCode clStochasticMort::DoMort(clTree *p_oTree, const float &fDiam,
      const short int &iSpecies) {
-  if (clModelMath::GetRand() < mp_fRandomMort[iSpecies])
+  return DoThreadSafeMort(p_oTree, fDiam, iSpecies, clModelMath::randgen);
+}
+
+///////////////////////////////////////////////////////////////////////////
+// DoThreadSafeMort()
+///////////////////////////////////////////////////////////////////////////
+deadCode clStochasticMort::DoThreadSafeMort(clTree *p_oTree, const float &fDiam,
+     const short int &iSpecies, gsl_rng *p_oStream) {
+  if (clModelMath::GetRand(p_oStream) < mp_fRandomMort[iSpecies])
     return natural;
   else
     return notdead;
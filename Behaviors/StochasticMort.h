@@ -17,6 +17,7 @@
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Thread-safe, drawing from random streams (agent)
 */
 class clStochasticMort : virtual public clMortalityBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -52,6 +53,18 @@ class clStochasticMort : virtual public clMortalityBase {
   */
   deadCode DoMort(clTree *p_oTree, const float &fDbh, const short int &iSpecies);
 
+  /**
+  * Calculates mortality stochastically, drawing from a random stream.
+  *
+  * @param fDbh DBH of tree being evaluated - for seedlings will be 0
+  * @param p_oTree Tree being evaluated
+  * @param iSpecies Species of the tree being evaluated
+  * @param p_oStream Random stream to draw from.
+  * @return natural if the tree is to die, notdead if it lives.
+  */
+  deadCode DoThreadSafeMort(clTree *p_oTree, const float &fDbh,
+      const short int &iSpecies, gsl_rng *p_oStream);
+
   protected:
 
   /**Random mortality rate per species.  This is read as an annual value and
@@ -30,6 +30,8 @@ clTempDependentNeighborhoodDisperse::clTempDependentNeighborhoodDisperse( clSimM
     mp_fPresB = NULL;
     mp_fPresM = NULL;
     mp_fThreshold = NULL;
+    mp_fFunctionalA = NULL;
+    mp_fFecundity = NULL;
     m_bDoPresenceTesting = false;
     m_fRadius = 0;
     m_fMinSaplingHeight = 0;
@@ -71,6 +73,8 @@ clTempDependentNeighborhoodDisperse::~clTempDependentNeighborhoodDisperse()
   delete[] mp_fPresB;
   delete[] mp_fPresM;
   delete[] mp_fThreshold;
+  delete[] mp_fFunctionalA;
+  delete[] mp_fFecundity;
 }
 
 
@@ -208,11 +212,6 @@ void clTempDependentNeighborhoodDisperse::DoShellSetup( DOMDocument * p_oDoc )
 ////////////////////////////////////////////////////////////////////////////
 void clTempDependentNeighborhoodDisperse::AddSeeds()
 {
-  float *p_fBAC = NULL,
-        *p_fFecundity = NULL,
-        *p_fFunctionalA = NULL; //Intercept actually used - zero this out if a
-            //species fails presence testing
-
   try
   {
     clTreePopulation * p_oPop = ( clTreePopulation * ) mp_oSimManager->GetPopulationObject( "treepopulation" );
@@ -220,35 +219,20 @@ void clTempDependentNeighborhoodDisperse::AddSeeds()
     clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
     clTree * p_oNeighbor; //competing neighbor
     char cQuery[75]; //format search strings into this
-    int iNumXCells = mp_oSeedGrid->GetNumberXCells(), //number x cells in seed grid
-        iNumYCells = mp_oSeedGrid->GetNumberYCells(), //number y cells in seed grid
-        iTotalNumSpecies = p_oPop->GetNumberOfSpecies();
-    float fNumGridSeeds, //seeds already in one grid cell
-          fTemp,
-          fMeanTempC = p_oPlot->GetMeanAnnualTemp(),
-          fNeighDbh, //DBH of neighbors for calculating basal area
-          //grid cell lengths in the middle of the grid
-          fMidX = mp_oSeedGrid->GetLengthXCells(),
-          fMidY = mp_oSeedGrid->GetLengthYCells(),
-          fMidArea = fMidX * fMidY, //shortcut
-          //possible short grid cell lengths on the edge of the grid
-          fEndX = p_oPlot->GetXPlotLength() - ((iNumXCells - 1)*fMidX),
-          fEndY = p_oPlot->GetYPlotLength() - ((iNumYCells - 1)*fMidY),
-          fArea, //one cell's area
-          fCellX, fCellY; //one cell's X and Y dimensions
-    int iNumYrs = mp_oSimManager->GetNumberOfYearsPerTimestep();
-    short int i, iSpecies,
-              iNeighSpecies, iNeighType,
-              iX, iY;
-
-    p_fBAC = new float[iTotalNumSpecies];
-    p_fFunctionalA = new float[iTotalNumSpecies];
-    p_fFecundity = new float[iTotalNumSpecies];
+    int iTotalNumSpecies = p_oPop->GetNumberOfSpecies();
+    float fTemp,
+          fMeanTempC = p_oPlot->GetMeanAnnualTemp();
+    short int i, iSpecies;
+
+    if ( NULL == mp_fFunctionalA ) {
+      mp_fFunctionalA = new float[iTotalNumSpecies];
+      mp_fFecundity = new float[iTotalNumSpecies];
+    }
 
     //Set all functional intercept values equal to that parameter
     for ( i = 0; i < m_iNumBehaviorSpecies; i++ ) {
       iSpecies = mp_iWhatSpecies[i];
-      p_fFunctionalA[iSpecies] = mp_fA[iSpecies];
+      mp_fFunctionalA[iSpecies] = mp_fA[iSpecies];
     }
 
     if ( m_bDoPresenceTesting ) {
@@ -278,7 +262,7 @@ void clTempDependentNeighborhoodDisperse::AddSeeds()
         if (false == p_bPresent[iSpecies]) {
           fTemp = exp(-0.5*pow((fMeanTempC - mp_fPresM[iSpecies])/mp_fPresB[iSpecies],2));
           if (fTemp < mp_fThreshold[iSpecies]) //fail - set intercept to 0
-            p_fFunctionalA[iSpecies] = 0;
+            mp_fFunctionalA[iSpecies] = 0;
         }
       }
       delete[] p_bPresent;
@@ -287,92 +271,107 @@ void clTempDependentNeighborhoodDisperse::AddSeeds()
     //Calculate fecundity for each species
     for ( i = 0; i < m_iNumBehaviorSpecies; i++ ) {
       iSpecies = mp_iWhatSpecies[i];
-      p_fFecundity[iSpecies] = mp_fB[iSpecies] *
+      mp_fFecundity[iSpecies] = mp_fB[iSpecies] *
         exp(-0.5*pow((fMeanTempC - mp_fFecM[iSpecies])/mp_fFecN[iSpecies],2));
     }
 
-    //Loop through the grid cells of the seed grid and put seeds in each
-    for ( iX = 0; iX < iNumXCells; iX++ ) {
-      for ( iY = 0; iY < iNumYCells; iY++ ) {
-
-        //Get the area of this cell, correcting for possible short edges
-        if (iX != iNumXCells - 1 && iY != iNumYCells - 1) fArea = fMidArea;
-        else {
-          if (iX == iNumXCells - 1) fCellX = fEndX;
-          else fCellX = fMidX;
-          if (iY == iNumYCells - 1) fCellY = fEndY;
-          else fCellY = fMidY;
-          fArea = fCellX * fCellY;
-        }
+    //Put seeds in each grid cell of the seed grid
+    DisperseCells( p_oPop, p_oPlot );
+  }
+  catch ( modelErr & err )
+  {
+    throw( err );
+  }
+  catch ( modelMsg & msg )
+  {
+    throw( msg );
+  } //non-fatal error
+  catch ( ... )
+  {
+    modelErr stcErr;
+    stcErr.iErrorCode = UNKNOWN;
+    stcErr.sFunction = "clTempDependentNeighborhoodDisperse::AddSeeds" ;
+    throw( stcErr );
+  }
+}
 
-        //Get the coordinates of the grid cell center - dangerously reuse
-        //fCellX and fCellY
-        mp_oSeedGrid->GetPointOfCell(iX, iY, &fCellX, &fCellY);
-
-        //Get conspecific adult basal area for each species in the neighborhood
-        //of this grid cell
-        for (i=0; i<iTotalNumSpecies; i++)
-          p_fBAC[i] = 0;
-        sprintf( cQuery, "%s%f%s%f%s%f%s%f", "distance=", m_fRadius,
-            "FROM x=", fCellX, "y=", fCellY, "::height=", m_fMinSaplingHeight );
-        p_oAllNeighbors = p_oPop->Find( cQuery );
-        p_oNeighbor = p_oAllNeighbors->NextTree();
-        while ( p_oNeighbor ) {
-          iNeighType = p_oNeighbor->GetType();
-          if ( clTreePopulation::adult == iNeighType) {
-            iNeighSpecies = p_oNeighbor->GetSpecies();
-            //Get the neighbor's dbh
-            p_oNeighbor->GetValue(p_oPop->GetDbhCode(iNeighSpecies, iNeighType),
-                & fNeighDbh );
-            p_fBAC[iNeighSpecies] += clModelMath::CalculateBasalArea(fNeighDbh);
-          }
-          p_oNeighbor = p_oAllNeighbors->NextTree();
-        }
+////////////////////////////////////////////////////////////////////////////
+// DisperseOneCell()
+////////////////////////////////////////////////////////////////////////////
+void clTempDependentNeighborhoodDisperse::DisperseOneCell( int iX, int iY,
+    clTreePopulation * p_oPop, clPlot * p_oPlot, float * p_fSeeds,
+    gsl_rng * p_oStream )
+{
+  float *p_fBAC = NULL;
 
-        //Calculate the number of seeds for each species
-        for (i = 0; i < m_iNumBehaviorSpecies; i++) {
-          iSpecies = mp_iWhatSpecies[i];
-          fNumGridSeeds = p_fFunctionalA[iSpecies] + p_fFecundity[iSpecies] *
-              p_fBAC[iSpecies];
+  try
+  {
+    stcAdultBasalArea stcBA; //adds up basal area of neighbors
+    int iNumXCells = mp_oSeedGrid->GetNumberXCells(), //number x cells in seed grid
+        iNumYCells = mp_oSeedGrid->GetNumberYCells(), //number y cells in seed grid
+        iTotalNumSpecies = p_oPop->GetNumberOfSpecies();
+    float fNumGridSeeds, //seeds for one species in this grid cell
+          //grid cell lengths in the middle of the grid
+          fMidX = mp_oSeedGrid->GetLengthXCells(),
+          fMidY = mp_oSeedGrid->GetLengthYCells(),
+          fArea, //this cell's area
+          fCellX, fCellY; //this cell's X and Y dimensions
+    int iNumYrs = mp_oSimManager->GetNumberOfYearsPerTimestep();
+    short int i, iSpecies;
 
-          //Scale from seeds per square meter per year to seeds per grid cell
-          //per timestep
-          fNumGridSeeds *= iNumYrs * fArea;
+    //Get the area of this cell, correcting for possible short edges
+    if (iX == iNumXCells - 1) fCellX = p_oPlot->GetXPlotLength() - ((iNumXCells - 1)*fMidX);
+    else fCellX = fMidX;
+    if (iY == iNumYCells - 1) fCellY = p_oPlot->GetYPlotLength() - ((iNumYCells - 1)*fMidY);
+    else fCellY = fMidY;
+    fArea = fCellX * fCellY;
 
-          //Place the seeds in the seed grid - dangerously reuse fLambda
-          mp_oSeedGrid->GetValueOfCell( iX, iY, mp_iNumSeedsCode[mp_iWhatSpecies[i]], & fTemp );
-          fTemp += fNumGridSeeds;
-          mp_oSeedGrid->SetValueOfCell( iX, iY, mp_iNumSeedsCode[mp_iWhatSpecies[i]], fTemp );
-        }
-      }
+    //Get the coordinates of the grid cell center - dangerously reuse
+    //fCellX and fCellY
+    mp_oSeedGrid->GetPointOfCell(iX, iY, &fCellX, &fCellY);
+
+    //Get conspecific adult basal area for each species in the neighborhood
+    //of this grid cell
+    p_fBAC = new float[iTotalNumSpecies];
+    for (i=0; i<iTotalNumSpecies; i++)
+      p_fBAC[i] = 0;
+    stcBA.p_oPop = p_oPop;
+    stcBA.p_fBasalArea = p_fBAC;
+    p_oPop->ForEachNeighbor(fCellX, fCellY, m_fRadius, m_fMinSaplingHeight,
+        1 << clTreePopulation::adult, stcBA);
+
+    //Calculate the number of seeds for each species
+    for (i = 0; i < m_iNumBehaviorSpecies; i++) {
+      iSpecies = mp_iWhatSpecies[i];
+      fNumGridSeeds = mp_fFunctionalA[iSpecies] + mp_fFecundity[iSpecies] *
+          p_fBAC[iSpecies];
+
+      //Scale from seeds per square meter per year to seeds per grid cell
+      //per timestep
+      fNumGridSeeds *= iNumYrs * fArea;
+
+      //Place the seeds in the seed buffer
+      AddSeedsToCell( p_fSeeds, iX, iY, iSpecies, fNumGridSeeds );
     }
 
     delete[] p_fBAC;
-    delete[] p_fFecundity;
-    delete[] p_fFunctionalA;
   }
   catch ( modelErr & err )
   {
     delete[] p_fBAC;
-    delete[] p_fFecundity;
-    delete[] p_fFunctionalA;
     throw( err );
   }
   catch ( modelMsg & msg )
   {
     delete[] p_fBAC;
-    delete[] p_fFecundity;
-    delete[] p_fFunctionalA;
     throw( msg );
   } //non-fatal error
   catch ( ... )
   {
     delete[] p_fBAC;
-    delete[] p_fFecundity;
-    delete[] p_fFunctionalA;
     modelErr stcErr;
     stcErr.iErrorCode = UNKNOWN;
-    stcErr.sFunction = "clTempDependentNeighborhoodDisperse::AddSeeds" ;
+    stcErr.sFunction = "clTempDependentNeighborhoodDisperse::DisperseOneCell" ;
     throw( stcErr );
   }
 }
@@ -49,6 +49,8 @@
  * <br>Edit history:
  * <br>-----------------
  * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+ * <br>October 17, 2026 - Grid cells are filled through
+ * clDisperseBase::DisperseCells() (agent)
  */
 class clTempDependentNeighborhoodDisperse : virtual public clDisperseBase {
 
@@ -81,6 +83,11 @@ class clTempDependentNeighborhoodDisperse : virtual public clDisperseBase {
   double *mp_fA;
   /**B parameter - sized number of species.*/
   double *mp_fB;
+  /**Intercept actually used this timestep - zero if a species fails
+   * presence testing.  Sized total number of species.*/
+  float *mp_fFunctionalA;
+  /**Fecundity term for this timestep - sized total number of species.*/
+  float *mp_fFecundity;
   /**Neighborhood search radius.*/
   double m_fRadius;
   /**Minimum sapling height. For doing neighbor searches.*/
@@ -101,14 +108,27 @@ class clTempDependentNeighborhoodDisperse : virtual public clDisperseBase {
    * for which there are no adults, the presence test function is calculated. If
    * a species fails the test, its intercept for this time step is set to zero.
    * Then, mean annual temperature is retrieved from the plot object and the
-   * fecundity term calculated for each species. For each grid cell, the
-   * neighborhood basal area of each species is calculated. The number of seeds
-   * per square meter is calculated and scaled to the appropriate grid cell size
-   * and number of years. The resulting number of seeds is assigned to the grid
-   * cell.
+   * fecundity term calculated for each species. Then each grid cell gets its
+   * seeds from DisperseOneCell().
    */
   void AddSeeds();
 
+  /**
+   * Adds seeds to one grid cell. The neighborhood basal area of each species
+   * is calculated. The number of seeds per square meter is calculated and
+   * scaled to the appropriate grid cell size and number of years. The
+   * resulting number of seeds is assigned to the grid cell. This is called by
+   * clDisperseBase::DisperseCells().
+   * @param iX X grid cell number.
+   * @param iY Y grid cell number.
+   * @param p_oPop Tree population.
+   * @param p_oPlot Plot object.
+   * @param p_fSeeds Seed buffer to add seeds to.
+   * @param p_oStream Random stream to draw from. Not used.
+   */
+  void DisperseOneCell(int iX, int iY, clTreePopulation *p_oPop,
+      clPlot *p_oPlot, float *p_fSeeds, gsl_rng *p_oStream);
+
 };
 //---------------------------------------------------------------------------
 #endif
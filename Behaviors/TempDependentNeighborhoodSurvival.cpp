@@ -262,45 +262,39 @@ deadCode clTempDependentNeighborhoodSurvival::DoMort( clTree * p_oTree, const fl
 ////////////////////////////////////////////////////////////////////////////
 float clTempDependentNeighborhoodSurvival::GetBAT(float &fX, float &fY, clTreePopulation *p_oPop)
 {
-  clTreeSearch * p_oAllNeighbors; //neighborhood trees within crowding radius
-  clTree * p_oNeighbor; //competing neighbor
-  char cQuery[75]; //format search strings into this
-  float fDbh, //neighbor's dbh
-        fBAT = 0;
-  int iIsDead; //whether a neighbor is dead
-  short int iSpecies, iType, //species and type for neighbor
-            iDeadCode; //neighbor's dead code
+  stcBATSum stcBAT;
 
-  //Get all trees taller than seedlings within the max crowding radius -
+  //Add up all adults taller than seedlings within the max crowding radius -
   //seedlings don't compete
-  sprintf( cQuery, "%s%f%s%f%s%f%s%f", "distance=", m_fRadius, "FROM x=", fX,
-       "y=", fY, "::height=", m_fMinSaplingHeight );
-  p_oAllNeighbors = p_oPop->Find( cQuery );
-
-  //Loop through and find all the adults
-  p_oNeighbor = p_oAllNeighbors->NextTree();
-
-  while ( p_oNeighbor ) {
-
-    iType = p_oNeighbor->GetType();
-    if ( clTreePopulation::adult == iType) {
-      iSpecies = p_oNeighbor->GetSpecies();
-      //Get the neighbor's dbh
-      p_oNeighbor->GetValue( p_oPop->GetDbhCode( iSpecies, iType ), & fDbh );
+  stcBAT.p_iDbhCodes = p_oPop->GetDbhCodes();
+  stcBAT.p_iDeadCodes = p_oPop->GetDeadCodes();
+  stcBAT.fBAT = 0;
+  p_oPop->ForEachNeighbor(fX, fY, m_fRadius, m_fMinSaplingHeight,
+      1 << clTreePopulation::adult, stcBAT);
+  return stcBAT.fBAT;
+}
 
-      //Make sure the neighbor's not dead due to a disturbance event
-      iDeadCode = p_oPop->GetIntDataCode( "dead", iSpecies, iType );
-      if ( -1 != iDeadCode )  p_oNeighbor->GetValue( iDeadCode, & iIsDead );
-      else iIsDead = notdead;
+////////////////////////////////////////////////////////////////////////////
+// stcBATSum::operator()
+////////////////////////////////////////////////////////////////////////////
+void clTempDependentNeighborhoodSurvival::stcBATSum::operator()(clTree *p_oNeighbor, float fDistanceSq)
+{
+  float fDbh; //neighbor's dbh
+  int iIsDead; //whether a neighbor is dead
+  short int iSpecies = p_oNeighbor->GetSpecies(),
+            iType = p_oNeighbor->GetType(),
+            iDeadCode; //neighbor's dead code
 
-      if ( notdead == iIsDead || natural == iIsDead)
-        fBAT += clModelMath::CalculateBasalArea(fDbh);
+  //Get the neighbor's dbh
+  p_oNeighbor->GetValue( p_iDbhCodes[iSpecies][iType], & fDbh );
 
-    }
+  //Make sure the neighbor's not dead due to a disturbance event
+  iDeadCode = p_iDeadCodes[iSpecies][iType];
+  if ( -1 != iDeadCode )  p_oNeighbor->GetValue( iDeadCode, & iIsDead );
+  else iIsDead = notdead;
 
-    p_oNeighbor = p_oAllNeighbors->NextTree();
-  }
-  return fBAT;
+  if ( notdead == iIsDead || natural == iIsDead)
+    fBAT += clModelMath::CalculateBasalArea(fDbh);
 }
 
 ////////////////////////////////////////////////////////////////////////////
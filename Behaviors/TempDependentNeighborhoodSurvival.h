@@ -44,6 +44,8 @@ class clGrid;
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Neighbor basal area is added up with
+* clTreePopulation::ForEachNeighbor() (agent)
 */
 class clTempDependentNeighborhoodSurvival : virtual public clMortalityBase {
 //note: need the virtual keyword to avoid base class ambiguity.
@@ -98,6 +100,23 @@ class clTempDependentNeighborhoodSurvival : virtual public clMortalityBase {
 
   protected:
 
+  /**
+   * Adds up the basal area of live adult neighbors. This is handed to
+   * clTreePopulation::ForEachNeighbor().
+   */
+  struct stcBATSum {
+    short int **p_iDbhCodes; /**<DBH codes, by species and type*/
+    short int **p_iDeadCodes; /**<"dead" codes, by species and type*/
+    float fBAT; /**<Basal area so far*/
+
+    /**
+     * Adds one neighbor's basal area.
+     * @param p_oNeighbor Neighbor.
+     * @param fDistanceSq Squared distance to neighbor. Not used.
+     */
+    void operator()(clTree *p_oNeighbor, float fDistanceSq);
+  };
+
   /**
    * Grid holding survival rate for each species.  The grid name is
    * "Temperature Dependent Neighborhood Survival". It has X+1 float data
@@ -0,0 +1,495 @@
+//---------------------------------------------------------------------------
+#include "VoxelLight.h"
+#include "ParsingFunctions.h"
+#include "SimManager.h"
+#include "TreePopulation.h"
+#include "TreeSnapshot.h"
+#include "TaskPool.h"
+#include "LightOrg.h"
+#include "Allometry.h"
+#include "Plot.h"
+#include <math.h>
+#include <sstream>
+
+/////////////////////////////////////////////////////////////////////////////
+// Constructor
+////////////////////////////////////////////////////////////////////////////
+clVoxelLight::clVoxelLight(clSimManager *p_oSimManager) :
+clWorkerBase( p_oSimManager ), clBehaviorBase( p_oSimManager ),
+clLightBase( p_oSimManager ) {
+
+  //Set the namestring
+  m_sNameString = "voxellightshell";
+  m_sXMLRoot = "VoxelLight";
+
+  mp_fExtinction = NULL;
+  mp_fVoxelGli = NULL;
+  mp_bNeeded = NULL;
+  mp_fRayX = NULL;
+  mp_fRayY = NULL;
+  mp_fRayZ = NULL;
+  mp_fRayBrightness = NULL;
+  m_fVoxelSize = 0;
+  m_fVoxelHeight = 0;
+  m_fVoxelLengthX = 0;
+  m_fVoxelLengthY = 0;
+  m_fPlotLengthX = 0;
+  m_fPlotLengthY = 0;
+  m_fMaxTreeHeight = 0;
+  m_fRcpTanMinAng = 0;
+  m_iNumXVoxels = 0;
+  m_iNumYVoxels = 0;
+  m_iNumLayers = 0;
+  m_iNumRays = 0;
+
+  //Trees only read the voxel grid, which is filled before light calculations
+  //start
+  m_bThreadSafe = true;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// Destructor
+////////////////////////////////////////////////////////////////////////////
+clVoxelLight::~clVoxelLight() {
+  delete[] mp_fExtinction;
+  delete[] mp_fVoxelGli;
+  delete[] mp_bNeeded;
+  delete[] mp_fRayX;
+  delete[] mp_fRayY;
+  delete[] mp_fRayZ;
+  delete[] mp_fRayBrightness;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// DoShellSetup()
+////////////////////////////////////////////////////////////////////////////
+void clVoxelLight::DoShellSetup(xercesc::DOMDocument *p_oDoc) {
+  try {
+    DOMElement *p_oElement = GetParentParametersElement(p_oDoc);
+    clTreePopulation *p_oPop = (clTreePopulation *) mp_oSimManager->
+        GetPopulationObject("treepopulation");
+    clAllometry *p_oAllom = p_oPop->GetAllometryObject();
+    clPlot *p_oPlot = mp_oSimManager->GetPlotObject();
+    int iNumBoundaries, i, j;
+
+    //Get our values
+    //Number of alitude angles
+    FillSingleValue(p_oElement, "li_numAltGrids", &m_iNumAltAng, true);
+    //Number of azimuth angles
+    FillSingleValue(p_oElement, "li_numAziGrids", &m_iNumAziAng, true);
+    //Minimum sun angle
+    FillSingleValue(p_oElement, "li_minSunAngle", &m_fMinSunAngle, true);
+    //Azimuth of north - not required
+    FillSingleValue( p_oElement, "li_AziOfNorth", & m_fAzimuthOfNorth, false );
+    //Voxel width and height
+    FillSingleValue(p_oElement, "li_voxelSize", &m_fVoxelSize, true);
+    FillSingleValue(p_oElement, "li_voxelHeight", &m_fVoxelHeight, true);
+
+    //Validate the data
+    if ( 0 >= m_iNumAltAng )
+    {
+      modelErr stcErr;
+      stcErr.iErrorCode = BAD_DATA;
+      stcErr.sFunction = "clVoxelLight::DoShellSetup" ;
+      stcErr.sMoreInfo = "The number of sky altitude divisions must be greater than 0.";
+      throw( stcErr );
+    }
+
+    if ( 0 >= m_iNumAziAng )
+    {
+      modelErr stcErr;
+      stcErr.iErrorCode = BAD_DATA;
+      stcErr.sFunction = "clVoxelLight::DoShellSetup" ;
+      stcErr.sMoreInfo = "The number of sky azimuth divisions must be greater than 0.";
+      throw( stcErr );
+    }
+
+    if (0 > m_fAzimuthOfNorth || (2.0 * M_PI) < m_fAzimuthOfNorth) {
+      modelErr stcErr;
+      stcErr.iErrorCode = BAD_DATA;
+      stcErr.sFunction = "clVoxelLight::DoShellSetup" ;
+      stcErr.sMoreInfo = "Azimuth of north must be between 0 and 2PI.";
+      throw( stcErr );
+    }
+
+    if (0 >= m_fVoxelSize || 0 >= m_fVoxelHeight) {
+      modelErr stcErr;
+      stcErr.iErrorCode = BAD_DATA;
+      stcErr.sFunction = "clVoxelLight::DoShellSetup" ;
+      std::stringstream s;
+      s << "Voxel width and height must be greater than 0. Values: "
+        << m_fVoxelSize << ", " << m_fVoxelHeight;
+      stcErr.sMoreInfo = s.str();
+      throw( stcErr );
+    }
+
+    //Declare the sky brightness and photo arrays
+    mp_fBrightness = new float*[m_iNumAltAng];
+    mp_fPhoto = new float*[m_iNumAltAng];
+    for (i = 0; i < m_iNumAltAng; i++)  {
+      mp_fBrightness[i] = new float[m_iNumAziAng];
+      mp_fPhoto[i] = new float[m_iNumAziAng];
+      for (j = 0; j < m_iNumAziAng; j++)
+        mp_fBrightness[i][j] = 0;
+    }
+
+    m_iMinAngRow = (int)floor(sin(m_fMinSunAngle) * m_iNumAltAng);
+    m_fRcpTanMinAng = 1 / (tan(m_fMinSunAngle));
+    PopulateGLIBrightnessArray();
+    SetupRays();
+
+    //Lay out the voxels. The widths are adjusted so that a whole number of
+    //voxels fits across the plot, so rays can wrap around its edges.
+    m_fPlotLengthX = p_oPlot->GetXPlotLength();
+    m_fPlotLengthY = p_oPlot->GetYPlotLength();
+    m_iNumXVoxels = (int)ceil(m_fPlotLengthX / m_fVoxelSize);
+    m_iNumYVoxels = (int)ceil(m_fPlotLengthY / m_fVoxelSize);
+    if (m_iNumXVoxels < 1) m_iNumXVoxels = 1;
+    if (m_iNumYVoxels < 1) m_iNumYVoxels = 1;
+    m_fVoxelLengthX = m_fPlotLengthX / m_iNumXVoxels;
+    m_fVoxelLengthY = m_fPlotLengthY / m_iNumYVoxels;
+
+    //The grid goes up to the tallest possible tree
+    m_fMaxTreeHeight = 0;
+    for (i = 0; i < p_oPop->GetNumberOfSpecies(); i++)
+      if (p_oAllom->GetMaxTreeHeight(i) > m_fMaxTreeHeight)
+        m_fMaxTreeHeight = p_oAllom->GetMaxTreeHeight(i);
+    m_iNumLayers = (int)ceil(m_fMaxTreeHeight / m_fVoxelHeight);
+    if (m_iNumLayers < 1) m_iNumLayers = 1;
+
+    mp_fExtinction = new float[m_iNumXVoxels * m_iNumYVoxels * m_iNumLayers];
+    iNumBoundaries = m_iNumXVoxels * m_iNumYVoxels * (m_iNumLayers + 1);
+    mp_fVoxelGli = new float[iNumBoundaries];
+    mp_bNeeded = new bool[iNumBoundaries];
+    for (i = 0; i < iNumBoundaries; i++) {
+      mp_fVoxelGli[i] = 100;
+      mp_bNeeded[i] = false;
+    }
+  }
+  catch (modelErr&err) {throw(err);}
+  catch (modelMsg &msg) {throw(msg);} //non-fatal error
+  catch (...) {
+    modelErr stcErr;
+    stcErr.iErrorCode = UNKNOWN;
+    stcErr.sFunction = "clVoxelLight::DoShellSetup";
+    throw(stcErr);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// SetupRays()
+////////////////////////////////////////////////////////////////////////////
+void clVoxelLight::SetupRays() {
+  float fSinAlt, fCosAlt, fAzi;
+  int i, j;
+
+  m_iNumRays = 0;
+  for (i = m_iMinAngRow; i < m_iNumAltAng; i++)
+    for (j = 0; j < m_iNumAziAng; j++)
+      if (mp_fBrightness[i][j] > 0) m_iNumRays++;
+
+  mp_fRayX = new float[m_iNumRays];
+  mp_fRayY = new float[m_iNumRays];
+  mp_fRayZ = new float[m_iNumRays];
+  mp_fRayBrightness = new float[m_iNumRays];
+
+  //Altitude rows are equal divisions of the sine of the altitude angle, and
+  //azimuth columns go clockwise from north (the plot's Y axis)
+  m_iNumRays = 0;
+  for (i = m_iMinAngRow; i < m_iNumAltAng; i++) {
+    fSinAlt = (i + 0.5) / m_iNumAltAng;
+    fCosAlt = sqrt(1 - fSinAlt * fSinAlt);
+    for (j = 0; j < m_iNumAziAng; j++) {
+      if (mp_fBrightness[i][j] <= 0) continue;
+      fAzi = (j + 0.5) * 2.0 * M_PI / m_iNumAziAng;
+      mp_fRayX[m_iNumRays] = fCosAlt * sin(fAzi);
+      mp_fRayY[m_iNumRays] = fCosAlt * cos(fAzi);
+      mp_fRayZ[m_iNumRays] = fSinAlt;
+      mp_fRayBrightness[m_iNumRays] = mp_fBrightness[i][j];
+      m_iNumRays++;
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// PreLightCalcs()
+////////////////////////////////////////////////////////////////////////////
+void clVoxelLight::PreLightCalcs(clTreePopulation *p_oPop) {
+  clTreeSnapshot *p_oSnapshot;
+  const float *p_fX, *p_fY, *p_fHeight;
+  const short int *p_iSpecies, *p_iType;
+  const int *p_iDead;
+  clTree * const *p_oTrees;
+  stcVoxelRow stcRow; //calculates one row of columns
+  int iNumBoundaries = m_iNumXVoxels * m_iNumYVoxels * (m_iNumLayers + 1), i;
+
+  mp_oLightOrg->CacheCrownDimensions();
+  FillVoxels(p_oPop);
+
+  //Find the layer boundaries that hold trees using this shell that need new
+  //light; the rest keep what they have
+  p_oSnapshot = p_oPop->GetSnapshot();
+  p_fX = p_oSnapshot->GetX();
+  p_fY = p_oSnapshot->GetY();
+  p_fHeight = p_oSnapshot->GetHeight();
+  p_iSpecies = p_oSnapshot->GetSpecies();
+  p_iType = p_oSnapshot->GetType();
+  p_iDead = p_oSnapshot->GetDead();
+  p_oTrees = p_oSnapshot->GetTrees();
+  for (i = 0; i < iNumBoundaries; i++) mp_bNeeded[i] = false;
+  for (i = 0; i < p_oSnapshot->GetNumTrees(); i++)
+    if (notdead == p_iDead[i] &&
+        this == mp_oLightOrg->GetLightShell(p_iSpecies[i], p_iType[i]) &&
+        !mp_oLightOrg->LightIsCurrent(p_oTrees[i]))
+      mp_bNeeded[GetBoundaryIndex(p_fX[i], p_fY[i], p_fHeight[i])] = true;
+
+  //Calculate them
+  stcRow.p_oLight = this;
+  mp_oSimManager->GetTaskPool()->ParallelFor(0, m_iNumXVoxels, stcRow);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// FillVoxels()
+////////////////////////////////////////////////////////////////////////////
+void clVoxelLight::FillVoxels(clTreePopulation *p_oPop) {
+  clAllometry *p_oAllom = p_oPop->GetAllometryObject();
+  clTreeSnapshot *p_oSnapshot = p_oPop->GetSnapshot();
+  const float *p_fX = p_oSnapshot->GetX(),
+              *p_fY = p_oSnapshot->GetY(),
+              *p_fHeight = p_oSnapshot->GetHeight(),
+              *p_fCrownRad = p_oSnapshot->GetCrownRadius(),
+              *p_fCrownDepth = p_oSnapshot->GetCrownDepth();
+  const short int *p_iType = p_oSnapshot->GetType();
+  const int *p_iDead = p_oSnapshot->GetDead();
+  clTree * const *p_oTrees = p_oSnapshot->GetTrees();
+  float fRadius, fDepth, fLightExtCoeff, fChord;
+  int iNumVoxels = m_iNumXVoxels * m_iNumYVoxels * m_iNumLayers, i;
+
+  for (i = 0; i < iNumVoxels; i++) mp_fExtinction[i] = 0;
+
+  for (i = 0; i < p_oSnapshot->GetNumTrees(); i++) {
+    //Seedlings don't shade, and neither do dead trees
+    if (notdead != p_iDead[i]) continue;
+    if (clTreePopulation::sapling == p_iType[i] ||
+        clTreePopulation::adult == p_iType[i]) {
+      fRadius = p_fCrownRad[i];
+      fDepth = p_fCrownDepth[i];
+    } else if (clTreePopulation::snag == p_iType[i]) {
+      fRadius = p_oAllom->CalcAdultCrownRadius(p_oTrees[i]);
+      fDepth = p_oAllom->CalcAdultCrownDepth(p_oTrees[i]);
+    } else continue;
+    if (fRadius <= 0 || fDepth <= 0) continue;
+    if (fDepth > p_fHeight[i]) fDepth = p_fHeight[i];
+
+    fLightExtCoeff = GetLightExtinctionCoefficient(p_oTrees[i]);
+    if (fLightExtCoeff >= 1) continue;
+    if (fLightExtCoeff < 1.0E-6) fLightExtCoeff = 1.0E-6;
+
+    //A ray along the crown's mean chord is dimmed by the light extinction
+    //coefficient
+    fChord = 2 * fRadius * fDepth / (fRadius + fDepth);
+    AddCrown(p_fX[i], p_fY[i], p_fHeight[i] - fDepth, p_fHeight[i], fRadius,
+        -log(fLightExtCoeff) / fChord);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// AddCrown()
+////////////////////////////////////////////////////////////////////////////
+void clVoxelLight::AddCrown(float fX, float fY, float fBase, float fTop,
+    float fRadius, float fRate) {
+  const int iNumSamples = 4; //samples per voxel side
+  float fRadiusSq = fRadius * fRadius, fColumnArea, fScale, fDX, fDY,
+        fLayerBottom, fLayerTop;
+  int iMinX, iMaxX, iMinY, iMaxY, iNumHits, iTotalHits, iX, iY, iWrapX,
+      iWrapY, iSX, iSY, iLayer, iFirstLayer, iLastLayer, iColumn, iPass;
+
+  iFirstLayer = (int)floor(fBase / m_fVoxelHeight);
+  iLastLayer = (int)ceil(fTop / m_fVoxelHeight) - 1;
+  if (iFirstLayer < 0) iFirstLayer = 0;
+  if (iLastLayer >= m_iNumLayers) iLastLayer = m_iNumLayers - 1;
+  if (iLastLayer < iFirstLayer) return;
+
+  //Columns the crown can reach, without wrapping; no more than the whole plot
+  iMinX = (int)floor((fX - fRadius) / m_fVoxelLengthX);
+  iMaxX = (int)floor((fX + fRadius) / m_fVoxelLengthX);
+  iMinY = (int)floor((fY - fRadius) / m_fVoxelLengthY);
+  iMaxY = (int)floor((fY + fRadius) / m_fVoxelLengthY);
+  if (iMaxX - iMinX >= m_iNumXVoxels) iMaxX = iMinX + m_iNumXVoxels - 1;
+  if (iMaxY - iMinY >= m_iNumYVoxels) iMaxY = iMinY + m_iNumYVoxels - 1;
+  fColumnArea = m_fVoxelLengthX * m_fVoxelLengthY;
+
+  //Count the sample points inside the crown on the first pass, and spread
+  //the crown on the second. Coverage is scaled so the crown's whole area is
+  //spread; if it is too small to hit any sample point, it all goes in the
+  //column holding its center.
+  iTotalHits = 0;
+  fScale = 0;
+  for (iPass = 0; iPass < 2; iPass++) {
+    if (1 == iPass) {
+      if (0 == iTotalHits) {
+        iMinX = iMaxX = (int)floor(fX / m_fVoxelLengthX);
+        iMinY = iMaxY = (int)floor(fY / m_fVoxelLengthY);
+        fScale = M_PI * fRadiusSq / fColumnArea;
+      }
+      else fScale = M_PI * fRadiusSq / (fColumnArea * iTotalHits);
+    }
+    for (iX = iMinX; iX <= iMaxX; iX++) {
+      iWrapX = ((iX % m_iNumXVoxels) + m_iNumXVoxels) % m_iNumXVoxels;
+      for (iY = iMinY; iY <= iMaxY; iY++) {
+        iWrapY = ((iY % m_iNumYVoxels) + m_iNumYVoxels) % m_iNumYVoxels;
+        if (1 == iPass && 0 == iTotalHits) iNumHits = 1;
+        else {
+          iNumHits = 0;
+          for (iSX = 0; iSX < iNumSamples; iSX++) {
+            fDX = (iX + (iSX + 0.5) / iNumSamples) * m_fVoxelLengthX - fX;
+            for (iSY = 0; iSY < iNumSamples; iSY++) {
+              fDY = (iY + (iSY + 0.5) / iNumSamples) * m_fVoxelLengthY - fY;
+              if (fDX * fDX + fDY * fDY <= fRadiusSq) iNumHits++;
+            }
+          }
+        }
+        if (0 == iPass) {
+          iTotalHits += iNumHits;
+          continue;
+        }
+        if (0 == iNumHits) continue;
+
+        //Each layer gets the part of the crown's depth that is in it
+        iColumn = (iWrapX * m_iNumYVoxels + iWrapY) * m_iNumLayers;
+        for (iLayer = iFirstLayer; iLayer <= iLastLayer; iLayer++) {
+          fLayerBottom = iLayer * m_fVoxelHeight;
+          fLayerTop = fLayerBottom + m_fVoxelHeight;
+          if (fLayerBottom < fBase) fLayerBottom = fBase;
+          if (fLayerTop > fTop) fLayerTop = fTop;
+          if (fLayerTop <= fLayerBottom) continue;
+          mp_fExtinction[iColumn + iLayer] += fRate * fScale * iNumHits *
+              (fLayerTop - fLayerBottom) / m_fVoxelHeight;
+        }
+      }
+    }
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// GetBoundaryIndex()
+////////////////////////////////////////////////////////////////////////////
+int clVoxelLight::GetBoundaryIndex(float fX, float fY, float fHeight) {
+  int iX = (int)floor(fX / m_fVoxelLengthX),
+      iY = (int)floor(fY / m_fVoxelLengthY),
+      iBoundary = (int)ceil(fHeight / m_fVoxelHeight);
+  if (iX < 0) iX = 0;
+  if (iX >= m_iNumXVoxels) iX = m_iNumXVoxels - 1;
+  if (iY < 0) iY = 0;
+  if (iY >= m_iNumYVoxels) iY = m_iNumYVoxels - 1;
+  if (iBoundary < 0) iBoundary = 0;
+  if (iBoundary > m_iNumLayers) iBoundary = m_iNumLayers;
+  return (iX * m_iNumYVoxels + iY) * (m_iNumLayers + 1) + iBoundary;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// MarchRays()
+////////////////////////////////////////////////////////////////////////////
+float clVoxelLight::MarchRays(int iX, int iY, int iBoundary) {
+  const float fMaxDepth = 30; //optical depth past which a ray is dark
+  float fGli = 0, fDepth, fT, fNextT, fTMaxX, fTMaxY, fTMaxZ, fTDeltaX,
+        fTDeltaY, fTDeltaZ, fBig = 1.0E30;
+  int iRay, iVX, iVY, iLayer, iStepX, iStepY;
+
+  if (iBoundary >= m_iNumLayers) return 100;
+
+  //Walk each ray through the voxels it crosses in order (Amanatides and
+  //Woo), starting from the center of the column at the bottom of the layer.
+  //Distances along the ray are in meters.
+  for (iRay = 0; iRay < m_iNumRays; iRay++) {
+    iVX = iX;
+    iVY = iY;
+    iLayer = iBoundary;
+    iStepX = mp_fRayX[iRay] > 0 ? 1 : -1;
+    iStepY = mp_fRayY[iRay] > 0 ? 1 : -1;
+    fTDeltaX = 0 == mp_fRayX[iRay] ? fBig : m_fVoxelLengthX / fabs(mp_fRayX[iRay]);
+    fTDeltaY = 0 == mp_fRayY[iRay] ? fBig : m_fVoxelLengthY / fabs(mp_fRayY[iRay]);
+    fTDeltaZ = m_fVoxelHeight / mp_fRayZ[iRay];
+    fTMaxX = 0.5 * fTDeltaX;
+    fTMaxY = 0.5 * fTDeltaY;
+    fTMaxZ = fTDeltaZ;
+    fT = 0;
+    fDepth = 0;
+    while (iLayer < m_iNumLayers && fDepth < fMaxDepth) {
+      fNextT = fTMaxX < fTMaxY ? fTMaxX : fTMaxY;
+      if (fTMaxZ < fNextT) fNextT = fTMaxZ;
+      fDepth += mp_fExtinction[(iVX * m_iNumYVoxels + iVY) * m_iNumLayers +
+          iLayer] * (fNextT - fT);
+      fT = fNextT;
+      if (fTMaxZ <= fT) {
+        iLayer++;
+        fTMaxZ += fTDeltaZ;
+      }
+      if (fTMaxX <= fT) {
+        iVX += iStepX;
+        if (iVX < 0) iVX = m_iNumXVoxels - 1;
+        else if (iVX >= m_iNumXVoxels) iVX = 0;
+        fTMaxX += fTDeltaX;
+      }
+      if (fTMaxY <= fT) {
+        iVY += iStepY;
+        if (iVY < 0) iVY = m_iNumYVoxels - 1;
+        else if (iVY >= m_iNumYVoxels) iVY = 0;
+        fTMaxY += fTDeltaY;
+      }
+    }
+    if (fDepth < fMaxDepth) fGli += mp_fRayBrightness[iRay] * exp(-fDepth);
+  }
+  return 100 * fGli;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// stcVoxelRow::operator()
+////////////////////////////////////////////////////////////////////////////
+void clVoxelLight::stcVoxelRow::operator()(int iX) {
+  int iNumBoundaries = p_oLight->m_iNumLayers + 1, iY, iBoundary, iIndex;
+  for (iY = 0; iY < p_oLight->m_iNumYVoxels; iY++) {
+    iIndex = (iX * p_oLight->m_iNumYVoxels + iY) * iNumBoundaries;
+    for (iBoundary = 0; iBoundary < iNumBoundaries; iBoundary++)
+      if (p_oLight->mp_bNeeded[iIndex + iBoundary])
+        p_oLight->mp_fVoxelGli[iIndex + iBoundary] =
+            p_oLight->MarchRays(iX, iY, iBoundary);
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// GetLightReach()
+////////////////////////////////////////////////////////////////////////////
+float clVoxelLight::GetLightReach(clTree *p_oTree, clTreePopulation *p_oPop) {
+  float fHeight, fBoundary;
+  short int iSpecies = p_oTree->GetSpecies(), iType = p_oTree->GetType();
+
+  p_oTree->GetValue(p_oPop->GetHeightCode(iSpecies, iType), &fHeight);
+  fBoundary = ceil(fHeight / m_fVoxelHeight) * m_fVoxelHeight;
+  if (fBoundary > m_fMaxTreeHeight) fBoundary = m_fMaxTreeHeight;
+  return (m_fMaxTreeHeight - fBoundary) * m_fRcpTanMinAng +
+      p_oPop->GetAllometryObject()->GetMaxCrownRadius() +
+      sqrt(m_fVoxelLengthX * m_fVoxelLengthX +
+           m_fVoxelLengthY * m_fVoxelLengthY);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// CalcLightValue()
+////////////////////////////////////////////////////////////////////////////
+float clVoxelLight::CalcLightValue(clTree *p_oTree, clTreePopulation *p_oPop) {
+  float fX, fY, fHeight;
+  int iIndex, iColumn, iNumBoundaries = m_iNumLayers + 1;
+  short int iSpecies = p_oTree->GetSpecies(), iType = p_oTree->GetType();
+
+  p_oTree->GetValue(p_oPop->GetXCode(iSpecies, iType), &fX);
+  p_oTree->GetValue(p_oPop->GetYCode(iSpecies, iType), &fY);
+  p_oTree->GetValue(p_oPop->GetHeightCode(iSpecies, iType), &fHeight);
+
+  iIndex = GetBoundaryIndex(fX, fY, fHeight);
+  if (mp_bNeeded[iIndex]) return mp_fVoxelGli[iIndex];
+
+  //This tree wasn't there when the grid was filled
+  iColumn = iIndex / iNumBoundaries;
+  return MarchRays(iColumn / m_iNumYVoxels, iColumn % m_iNumYVoxels,
+      iIndex % iNumBoundaries);
+}
@@ -0,0 +1,219 @@
+//---------------------------------------------------------------------------
+
+#ifndef VoxelLightH
+#define VoxelLightH
+//---------------------------------------------------------------------------
+
+#include "LightBase.h"
+
+/**
+* Voxel Light - Version 1.0
+*
+* This calculates GLI for trees from a three-dimensional grid of the canopy
+* instead of from a fisheye photo of each tree's neighbors. The namestring for
+* this behavior is "voxellightshell". The parameter file call string is
+* "VoxelLight".
+*
+* Once per timestep, before any light is calculated, every shading crown is
+* spread into a grid of boxes (voxels) covering the plot from the ground to
+* the tallest possible tree. Each crown is the same cylinder the GLI shells
+* use, running from the crown base to the top of the tree. It is given an
+* extinction rate (per meter) such that a ray crossing the crown along its
+* mean chord (4 * volume / surface area) is dimmed by the crown's light
+* extinction coefficient, and that rate is split among the voxels it covers
+* in proportion to how much of each it fills. Horizontal coverage is found by
+* sampling each voxel column on a 4 X 4 grid of points. Seedlings do not
+* shade.
+*
+* GLI is then found by marching one ray up from a point through the voxel
+* grid for each sky brightness segment above the minimum sun angle (from
+* PopulateGLIBrightnessArray()), adding up how much each voxel it crosses
+* dims it. Rays wrap around the plot edges. GLI is 100 times the sum of sky
+* brightness times the fraction of each ray that gets through.
+*
+* Light is calculated at the center of voxel columns, at the voxel layer
+* boundary at or just above the top of each tree. A tree's light is the value
+* for the column it is in, so a tree's own crown never shades it, but neither
+* does the crown of a neighbor that ends in the same layer. These values are
+* calculated for every column and layer boundary holding a tree that uses
+* this shell and needs new light (see clLightOrg::LightIsCurrent()), shared
+* by all the trees there, and split up among threads. In incremental light
+* mode, boundaries holding only trees that keep their light are skipped. The
+* voxel grid itself is still filled every timestep. This
+* keeps the cost of the timestep tied to the size of the plot and the number
+* of sky segments instead of the number of neighbors each tree has.
+*
+* The results approach those of clGliLight with the photo at the top of the
+* crown as the voxels get smaller. Voxels smaller than crowns give the best
+* results. The parameters are those of clGliLight, plus the voxel width and
+* height.
+*
+* Copyright 2026 agent.
+* @author agent
+*
+* <br>Edit history:
+* <br>-----------------
+* <br>October 17, 2026 - Created (agent)
+* <br>October 17, 2026 - Boundaries holding only trees whose light is
+* current are skipped (agent)
+*/
+class clVoxelLight : public clLightBase {
+//note: need the virtual keyword to avoid base class ambiguity.
+
+  public:
+
+  /**
+  * Constructor.
+  *
+  * @param p_oSimManager Sim Manager object.
+  */
+  clVoxelLight(clSimManager *p_oSimManager);
+
+  /**
+  * Destructor.
+  */
+  ~clVoxelLight();
+
+  /**
+  * Reads parameters from the parameter file, lays out the voxel grid, and
+  * populates the sky brightness array.
+  *
+  * @param p_oDoc DOM tree of parsed input file.
+  * @throws modelErr if the number of altitude or azimuth divisions, the voxel
+  * width, or the voxel height is not greater than zero, or if the azimuth of
+  * north is not between 0 and 2PI.
+  */
+  void DoShellSetup(xercesc::DOMDocument *p_oDoc);
+
+  /**
+  * Fills the voxel grid with this timestep's crowns and calculates GLI at
+  * each voxel column and layer boundary that holds a tree using this shell
+  * whose light isn't current.
+  *
+  * @param p_oPop Tree population object.
+  */
+  void PreLightCalcs(clTreePopulation *p_oPop);
+
+  /**
+  * Gets the GLI for a tree. This is the value calculated in PreLightCalcs()
+  * for the tree's voxel column and layer, or, for a tree that wasn't there
+  * then, a new value calculated from the voxel grid.
+  *
+  * @param p_oTree Tree for which to calculate GLI.
+  * @param p_oPop Tree population object.
+  * @return GLI value, between 0 and 100.
+  */
+  float CalcLightValue(clTree *p_oTree, clTreePopulation *p_oPop);
+
+  /**
+  * Gets how far shading neighbors can be from a tree. This is the distance
+  * at the minimum sun angle from the tree's layer boundary to the tallest
+  * possible tree, plus the maximum crown radius and the width of a voxel.
+  *
+  * @param p_oTree Tree whose GLI is in question.
+  * @param p_oPop Tree population object.
+  * @return Reach, in meters.
+  */
+  float GetLightReach(clTree *p_oTree, clTreePopulation *p_oPop);
+
+  protected:
+
+  /**
+  * Calculates GLI at each needed layer boundary in one row of voxel columns.
+  * This is handed to clTaskPool::ParallelFor().
+  */
+  struct stcVoxelRow {
+    clVoxelLight *p_oLight; /**<Light object doing the calculating*/
+    /**
+    * Calculates one row of columns.
+    * @param iX Column number in the X direction.
+    */
+    void operator()(int iX);
+  };
+
+  /**Extinction rate of each voxel, per meter. Array size is m_iNumXVoxels *
+   * m_iNumYVoxels * m_iNumLayers, X-major, with the layers of a column
+   * together, ground up.*/
+  float *mp_fExtinction;
+
+  /**GLI at each voxel column and layer boundary. Array size is m_iNumXVoxels
+   * * m_iNumYVoxels * (m_iNumLayers + 1), X-major, with the boundaries of a
+   * column together, ground up. Only valid where mp_bNeeded is true.*/
+  float *mp_fVoxelGli;
+
+  /**Whether mp_fVoxelGli was calculated this timestep. Sized like
+   * mp_fVoxelGli.*/
+  bool *mp_bNeeded;
+
+  /**X component of each ray's direction. Array size is m_iNumRays.*/
+  float *mp_fRayX;
+  /**Y component of each ray's direction. Array size is m_iNumRays.*/
+  float *mp_fRayY;
+  /**Z component of each ray's direction. Array size is m_iNumRays.*/
+  float *mp_fRayZ;
+  /**Sky brightness of each ray. Array size is m_iNumRays.*/
+  float *mp_fRayBrightness;
+
+  double m_fVoxelSize; /**<Requested voxel width, in meters*/
+  double m_fVoxelHeight; /**<Voxel height, in meters*/
+  float m_fVoxelLengthX; /**<Voxel length in X - voxels tile the plot exactly*/
+  float m_fVoxelLengthY; /**<Voxel length in Y - voxels tile the plot exactly*/
+  float m_fPlotLengthX; /**<Plot length in X*/
+  float m_fPlotLengthY; /**<Plot length in Y*/
+  float m_fMaxTreeHeight; /**<Height of the tallest possible tree, in meters*/
+  float m_fRcpTanMinAng; /**<Reciprocal of the tangent of the minimum sun angle*/
+  int m_iNumXVoxels; /**<Number of voxel columns in X*/
+  int m_iNumYVoxels; /**<Number of voxel columns in Y*/
+  int m_iNumLayers; /**<Number of voxel layers*/
+  int m_iNumRays; /**<Number of sky segments with any brightness*/
+
+  /**
+  * Sets up the rays, one through the center of each sky segment above the
+  * minimum sun angle with any brightness.
+  */
+  void SetupRays();
+
+  /**
+  * Spreads this timestep's shading crowns into the voxel grid.
+  *
+  * @param p_oPop Tree population object.
+  */
+  void FillVoxels(clTreePopulation *p_oPop);
+
+  /**
+  * Adds one crown to the voxel grid.
+  *
+  * @param fX X coordinate of the crown center.
+  * @param fY Y coordinate of the crown center.
+  * @param fBase Height of the crown base, in meters.
+  * @param fTop Height of the crown top, in meters.
+  * @param fRadius Crown radius, in meters.
+  * @param fRate Crown extinction rate, per meter.
+  */
+  void AddCrown(float fX, float fY, float fBase, float fTop, float fRadius,
+      float fRate);
+
+  /**
+  * Gets the voxel column and layer boundary for a tree.
+  *
+  * @param fX X coordinate of the tree.
+  * @param fY Y coordinate of the tree.
+  * @param fHeight Height of the tree, in meters.
+  * @return Index into mp_fVoxelGli.
+  */
+  int GetBoundaryIndex(float fX, float fY, float fHeight);
+
+  /**
+  * Calculates GLI at the center of a voxel column, at a layer boundary, by
+  * marching each ray up through the voxel grid. This only reads the grid.
+  *
+  * @param iX Column number in X.
+  * @param iY Column number in Y.
+  * @param iBoundary Layer boundary, from 0 (the ground) to m_iNumLayers (the
+  * top of the grid).
+  * @return GLI value, between 0 and 100.
+  */
+  float MarchRays(int iX, int iY, int iBoundary);
+};
+//---------------------------------------------------------------------------
+#endif
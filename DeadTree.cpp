@@ -45,6 +45,20 @@ clDeadTree::clDeadTree(int iType, int iSpecies, int iNumFloats, int iNumInts,
   m_iDeadCode = notdead;
 }
 
+////////////////////////////////////////////////////////////////////////////
+// Constructor
+///////////////////////////////////////////////////////////////////////////*/
+clDeadTree::clDeadTree() {
+  m_iSpecies = 0;
+  m_iType = 0;
+  m_iDeadCode = notdead;
+  mp_oNext = NULL;
+  mp_fFloatValues = NULL;
+  mp_iIntValues = NULL;
+  mp_sStringValues = NULL;
+  mp_bBoolValues = NULL;
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // Destructor
 ////////////////////////////////////////////////////////////////////////////
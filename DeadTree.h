@@ -27,6 +27,8 @@ using namespace whyDead;
 * <br>Edit history:
 * <br>-----------------
 * <br>January 6, 2011 - Created (LEM)
+* <br>October 17, 2026 - Added a default constructor so dead trees can be
+* allocated in slabs by the ghost tree population (agent)
 */
 class clDeadTree {
   friend class clTreePopulation;
@@ -112,6 +114,12 @@ class clDeadTree {
   clDeadTree(int iType, int iSpecies, int iNumFloats, int iNumInts, int iNumStrings,
     int iNumBools);
 
+ /**
+  * Constructor.  No arrays are declared.  The ghost tree population uses this
+  * to allocate dead trees in slabs, and points their arrays into slab storage.
+  */
+  clDeadTree();
+
  /**
   * Destructor.  Deletes arrays.
   */
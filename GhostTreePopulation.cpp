@@ -1,6 +1,7 @@
 #include <stddef.h>
 #include <math.h>
 #include "GhostTreePopulation.h"
+#include "TreePopulation.h"
 #include "Tree.h"
 #include "DeadTree.h"
 #include "SimManager.h"
@@ -12,6 +13,7 @@
 /////////////////////////////////////////////////////////////////////////////
 clGhostTreePopulation::~clGhostTreePopulation() {
   TimestepCleanup();
+  DeletePools();
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -23,6 +25,13 @@ clGhostTreePopulation::clGhostTreePopulation(clSimManager * p_oSimManager) :
   m_sNameString = "GhostTreePopulation";
 
   mp_oTrees = NULL;
+  mp_oSlabs = NULL;
+  mp_oCurrentSlab = NULL;
+  mp_iNumUsedInSlab = NULL;
+  m_iNumSpecies = 0;
+  m_iNumTypes = 0;
+  m_lNumDeadTreeSlabs = 0;
+  m_lNumDeadTreesAllocated = 0;
 
   //Allowed file types
   m_iNumAllowedTypes = 5;
@@ -38,7 +47,8 @@ clGhostTreePopulation::clGhostTreePopulation(clSimManager * p_oSimManager) :
 // AddTree()
 ///////////////////////////////////////////////////////////////////////////
 void clGhostTreePopulation::AddTree(clTree * p_oTree, deadCode iDeadReasonCode) {
-  clDeadTree *p_oDeadClone = p_oTree->MakeDeadClone();
+  clDeadTree *p_oDeadClone = p_oTree->MakeDeadClone(
+      AllocateDeadTree(p_oTree->GetSpecies(), p_oTree->GetType()));
              //*p_oNextTree = NULL, *p_oTreeHolder = NULL;
 
   p_oDeadClone->SetDeadReasonCode(iDeadReasonCode);
@@ -64,15 +74,142 @@ void clGhostTreePopulation::AddTree(clTree * p_oTree, deadCode iDeadReasonCode)
 // TimestepCleanup()
 //////////////////////////////////////////////////////////////////////////////
 void clGhostTreePopulation::TimestepCleanup() {
+  int i, j;
 
-  clDeadTree * p_oTree = NULL, *p_oNextTree = NULL;
-
-  p_oTree = mp_oTrees;
-  while (p_oTree != NULL) {
-    p_oNextTree = p_oTree->GetNext();
-    delete p_oTree;
-    p_oTree = p_oNextTree;
+  //Rewind the slabs - the trees in them get overwritten as they're re-used
+  if (mp_oSlabs) {
+    for (i = 0; i < m_iNumSpecies; i++)
+      for (j = 0; j < m_iNumTypes; j++) {
+        mp_oCurrentSlab[i][j] = mp_oSlabs[i][j];
+        mp_iNumUsedInSlab[i][j] = 0;
+      }
   }
 
   mp_oTrees = NULL;
 }
+
+//////////////////////////////////////////////////////////////////////////////
+// CreatePools()
+//////////////////////////////////////////////////////////////////////////////
+void clGhostTreePopulation::CreatePools() {
+  clTreePopulation *p_oPop = (clTreePopulation*) mp_oSimManager->GetPopulationObject("treepopulation");
+  int i, j;
+
+  m_iNumSpecies = p_oPop->GetNumberOfSpecies();
+  m_iNumTypes = p_oPop->GetNumberOfTypes();
+  mp_oSlabs = new stcDeadTreeSlab**[m_iNumSpecies];
+  mp_oCurrentSlab = new stcDeadTreeSlab**[m_iNumSpecies];
+  mp_iNumUsedInSlab = new int*[m_iNumSpecies];
+  for (i = 0; i < m_iNumSpecies; i++) {
+    mp_oSlabs[i] = new stcDeadTreeSlab*[m_iNumTypes];
+    mp_oCurrentSlab[i] = new stcDeadTreeSlab*[m_iNumTypes];
+    mp_iNumUsedInSlab[i] = new int[m_iNumTypes];
+    for (j = 0; j < m_iNumTypes; j++) {
+      mp_oSlabs[i][j] = NULL;
+      mp_oCurrentSlab[i][j] = NULL;
+      mp_iNumUsedInSlab[i][j] = 0;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// DeletePools()
+//////////////////////////////////////////////////////////////////////////////
+void clGhostTreePopulation::DeletePools() {
+  stcDeadTreeSlab *p_slab, *p_nextSlab;
+  int i, j, k;
+
+  if (NULL == mp_oSlabs) return;
+
+  for (i = 0; i < m_iNumSpecies; i++) {
+    for (j = 0; j < m_iNumTypes; j++) {
+      p_slab = mp_oSlabs[i][j];
+      while (p_slab) {
+        p_nextSlab = p_slab->p_nextSlab;
+        //The trees' arrays belong to the slab - don't let the trees delete them
+        for (k = 0; k < DEAD_TREE_SLAB_SIZE; k++) {
+          p_slab->p_oTrees[k].mp_fFloatValues = NULL;
+          p_slab->p_oTrees[k].mp_iIntValues = NULL;
+          p_slab->p_oTrees[k].mp_sStringValues = NULL;
+          p_slab->p_oTrees[k].mp_bBoolValues = NULL;
+        }
+        delete[] p_slab->p_oTrees;
+        delete[] p_slab->p_fFloats;
+        delete[] p_slab->p_iInts;
+        delete[] p_slab->p_sStrings;
+        delete[] p_slab->p_bBools;
+        delete p_slab;
+        p_slab = p_nextSlab;
+      }
+    }
+    delete[] mp_oSlabs[i];
+    delete[] mp_oCurrentSlab[i];
+    delete[] mp_iNumUsedInSlab[i];
+  }
+  delete[] mp_oSlabs; mp_oSlabs = NULL;
+  delete[] mp_oCurrentSlab; mp_oCurrentSlab = NULL;
+  delete[] mp_iNumUsedInSlab; mp_iNumUsedInSlab = NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// AllocateDeadTree()
+//////////////////////////////////////////////////////////////////////////////
+clDeadTree* clGhostTreePopulation::AllocateDeadTree(int iSpecies, int iType) {
+  stcDeadTreeSlab *p_slab;
+  clTreePopulation *p_oPop;
+  clDeadTree *p_oTree;
+  int iNumFloats, iNumInts, iNumStrings, iNumBools, k;
+
+  if (NULL == mp_oSlabs) CreatePools();
+
+  p_slab = mp_oCurrentSlab[iSpecies][iType];
+  if (p_slab && DEAD_TREE_SLAB_SIZE == mp_iNumUsedInSlab[iSpecies][iType]) {
+    //Move on to the next slab, if there is one
+    p_slab = p_slab->p_nextSlab;
+    mp_iNumUsedInSlab[iSpecies][iType] = 0;
+    if (p_slab) mp_oCurrentSlab[iSpecies][iType] = p_slab;
+  }
+
+  if (NULL == p_slab) {
+    //All slabs for this species and type are used - make a new one
+    p_oPop = (clTreePopulation*) mp_oSimManager->GetPopulationObject("treepopulation");
+    iNumFloats = p_oPop->mp_iNumTreeFloatVals[iSpecies][iType];
+    iNumInts = p_oPop->mp_iNumTreeIntVals[iSpecies][iType];
+    iNumStrings = p_oPop->mp_iNumTreeStringVals[iSpecies][iType];
+    iNumBools = p_oPop->mp_iNumTreeBoolVals[iSpecies][iType];
+
+    p_slab = new stcDeadTreeSlab;
+    p_slab->p_oTrees = new clDeadTree[DEAD_TREE_SLAB_SIZE];
+    p_slab->p_fFloats = new float[DEAD_TREE_SLAB_SIZE * iNumFloats];
+    p_slab->p_iInts = new int[DEAD_TREE_SLAB_SIZE * iNumInts];
+    p_slab->p_sStrings = new std::string[DEAD_TREE_SLAB_SIZE * iNumStrings];
+    p_slab->p_bBools = new bool[DEAD_TREE_SLAB_SIZE * iNumBools];
+    p_slab->p_nextSlab = NULL;
+    for (k = 0; k < DEAD_TREE_SLAB_SIZE; k++) {
+      p_slab->p_oTrees[k].m_iSpecies = iSpecies;
+      p_slab->p_oTrees[k].m_iType = iType;
+      if (iNumFloats > 0)
+        p_slab->p_oTrees[k].mp_fFloatValues = &p_slab->p_fFloats[k * iNumFloats];
+      if (iNumInts > 0)
+        p_slab->p_oTrees[k].mp_iIntValues = &p_slab->p_iInts[k * iNumInts];
+      if (iNumStrings > 0)
+        p_slab->p_oTrees[k].mp_sStringValues = &p_slab->p_sStrings[k * iNumStrings];
+      if (iNumBools > 0)
+        p_slab->p_oTrees[k].mp_bBoolValues = &p_slab->p_bBools[k * iNumBools];
+    }
+
+    //Append it to the end of the list
+    if (NULL == mp_oCurrentSlab[iSpecies][iType])
+      mp_oSlabs[iSpecies][iType] = p_slab;
+    else
+      mp_oCurrentSlab[iSpecies][iType]->p_nextSlab = p_slab;
+    mp_oCurrentSlab[iSpecies][iType] = p_slab;
+    mp_iNumUsedInSlab[iSpecies][iType] = 0;
+    m_lNumDeadTreeSlabs++;
+  }
+
+  p_oTree = &p_slab->p_oTrees[mp_iNumUsedInSlab[iSpecies][iType]];
+  mp_iNumUsedInSlab[iSpecies][iType]++;
+  m_lNumDeadTreesAllocated++;
+  return p_oTree;
+}
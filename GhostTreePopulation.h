@@ -7,6 +7,10 @@
 
 class clTree;
 class clDeadTree;
+class clTreePopulation;
+
+/**Number of dead trees allocated at once when a dead tree slab list runs out*/
+#define DEAD_TREE_SLAB_SIZE 128
 
 using namespace whyDead;
 
@@ -19,12 +23,18 @@ using namespace whyDead;
 *
 * The trees are not sorted, just held in a simple linked list.
 *
+* Dead trees are not created and deleted one at a time. They are handed out
+* from slabs, one list of slabs per species/type combo, with each slab's value
+* arrays carved out of contiguous blocks. At the end of the timestep the slabs
+* are simply rewound for re-use.
+*
 * Copyright 2010 Charles D. Canham.
 * @author Lora E. Murphy
 *
 * <br>Edit history:
 * <br>-----------------
 * <br>December 21, 2010 - Created (LEM)
+* <br>October 17, 2026 - Dead trees come from recycled slabs (agent)
 */
 class clGhostTreePopulation : public clPopulationBase {
 
@@ -72,6 +82,20 @@ class clGhostTreePopulation : public clPopulationBase {
   */
   void GetData(xercesc::DOMDocument *p_oDoc) {;};
 
+  /**
+  * Gets the number of dead tree slabs that have been allocated. Each slab
+  * holds DEAD_TREE_SLAB_SIZE trees.
+  * @return Number of dead tree slabs.
+  */
+  long GetNumDeadTreeSlabs() {return m_lNumDeadTreeSlabs;};
+
+  /**
+  * Gets the number of dead trees that have been handed out from the slabs
+  * over the whole run.
+  * @return Number of dead trees handed out.
+  */
+  long GetNumDeadTreesAllocated() {return m_lNumDeadTreesAllocated;};
+
 
 ///////////////////////////////////////////////////////////////////////////
 //                            PROTECTED
@@ -79,13 +103,67 @@ class clGhostTreePopulation : public clPopulationBase {
   protected:
 
   /**
-  * Deletes all trees.
+  * Empties the population. The dead tree slabs are rewound so that their
+  * trees can be handed out again; nothing is deleted.
   */
   void TimestepCleanup();
 
+  /**
+  * Declares the slab list arrays. This is done the first time a tree is
+  * added, since the tree population must be set up first.
+  */
+  void CreatePools();
+
+  /**
+  * Deletes all slabs and the slab list arrays.
+  */
+  void DeletePools();
+
+  /**
+  * Hands out a dead tree from the slabs for a species and type, adding a new
+  * slab if all existing ones are in use.
+  * @param iSpecies Species.
+  * @param iType Type.
+  * @return Dead tree with arrays sized for that species and type.
+  */
+  clDeadTree* AllocateDeadTree(int iSpecies, int iType);
+
+  /**A slab of dead trees, with contiguous storage for their values.*/
+  struct stcDeadTreeSlab {
+    clDeadTree *p_oTrees; /**<Array of DEAD_TREE_SLAB_SIZE trees*/
+    float *p_fFloats; /**<Float storage for all trees in the slab*/
+    int *p_iInts; /**<Int storage for all trees in the slab*/
+    std::string *p_sStrings; /**<String storage for all trees in the slab*/
+    bool *p_bBools; /**<Bool storage for all trees in the slab*/
+    stcDeadTreeSlab *p_nextSlab; /**<Next slab on the list*/
+  };
+
   /** Linked list of dead trees */
   clDeadTree *mp_oTrees;
 
+  /**Lists of slabs. Array size is number of species by number of types.*/
+  stcDeadTreeSlab ***mp_oSlabs;
+
+  /**Slab currently handing out trees. Array size is number of species by
+   * number of types.*/
+  stcDeadTreeSlab ***mp_oCurrentSlab;
+
+  /**Number of trees handed out from the current slab. Array size is number of
+   * species by number of types.*/
+  int **mp_iNumUsedInSlab;
+
+  /**Number of species the slab lists were declared for.*/
+  int m_iNumSpecies;
+
+  /**Number of types the slab lists were declared for.*/
+  int m_iNumTypes;
+
+  /**Number of dead tree slabs allocated.*/
+  long m_lNumDeadTreeSlabs;
+
+  /**Number of dead trees handed out.*/
+  long m_lNumDeadTreesAllocated;
+
 }; //end of class GhostTreePopulation
 //----------------------------------------------------------------------------
 #endif
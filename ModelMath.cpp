@@ -8,12 +8,71 @@
 #include "Messages.h"
 
 gsl_rng *clModelMath::randgen = gsl_rng_alloc(gsl_rng_mt19937);
+long clModelMath::m_lStreamSeed = 0;
+
+/////////////////////////////////////////////////////////////////////////////
+// Philox-4x32-10 generator, packaged as a GSL generator type so that all the
+// GSL distribution functions can use it.  The state is a 64-bit key and a
+// 128-bit counter; each block of four outputs is the counter encrypted with
+// the key, and the first counter word counts blocks.
+/////////////////////////////////////////////////////////////////////////////
+struct stcPhiloxState {
+  uint32_t p_iKey[2];     /**<Key*/
+  uint32_t p_iCounter[4]; /**<Counter*/
+  uint32_t p_iOut[4];     /**<Current block of output*/
+  int iNext;              /**<Next unused output in p_iOut; 4 if used up*/
+};
+
+static void PhiloxBlock(stcPhiloxState *p_oState) {
+  const uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57,
+                 W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+  uint32_t c0 = p_oState->p_iCounter[0], c1 = p_oState->p_iCounter[1],
+           c2 = p_oState->p_iCounter[2], c3 = p_oState->p_iCounter[3],
+           k0 = p_oState->p_iKey[0], k1 = p_oState->p_iKey[1];
+  uint64_t p0, p1;
+  int i;
+
+  for (i = 0; i < 10; i++) {
+    p0 = (uint64_t)M0 * c0;
+    p1 = (uint64_t)M1 * c2;
+    c0 = (uint32_t)(p1 >> 32) ^ c1 ^ k0;
+    c1 = (uint32_t)p1;
+    c2 = (uint32_t)(p0 >> 32) ^ c3 ^ k1;
+    c3 = (uint32_t)p0;
+    k0 += W0; k1 += W1;
+  }
+  p_oState->p_iOut[0] = c0; p_oState->p_iOut[1] = c1;
+  p_oState->p_iOut[2] = c2; p_oState->p_iOut[3] = c3;
+  p_oState->p_iCounter[0]++;
+  p_oState->iNext = 0;
+}
+
+static unsigned long PhiloxGet(void *p_vState) {
+  stcPhiloxState *p_oState = (stcPhiloxState*) p_vState;
+  if (p_oState->iNext > 3) PhiloxBlock(p_oState);
+  return p_oState->p_iOut[p_oState->iNext++];
+}
+
+static double PhiloxGetDouble(void *p_vState) {
+  return PhiloxGet(p_vState) / 4294967296.0;
+}
+
+static void PhiloxSet(void *p_vState, unsigned long iSeed) {
+  stcPhiloxState *p_oState = (stcPhiloxState*) p_vState;
+  p_oState->p_iKey[0] = (uint32_t) iSeed;
+  p_oState->p_iKey[1] = (uint32_t) ((uint64_t) iSeed >> 32);
+  memset(p_oState->p_iCounter, 0, sizeof(p_oState->p_iCounter));
+  p_oState->iNext = 4;
+}
+
+static const gsl_rng_type philox_type = {"philox4x32", 0xffffffffUL, 0,
+    sizeof(stcPhiloxState), &PhiloxSet, &PhiloxGet, &PhiloxGetDouble};
 
 /////////////////////////////////////////////////////////////////////////////
 // GetRand()
 /////////////////////////////////////////////////////////////////////////////
-float clModelMath::GetRand() {
-  return (gsl_rng_uniform(randgen));
+float clModelMath::GetRand(gsl_rng *p_oStream) {
+  return (gsl_rng_uniform(p_oStream));
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -74,7 +133,7 @@ float clModelMath::Round(float fNumber, int iNumDigits) {
 /////////////////////////////////////////////////////////////////////////////
 // RandomRound()
 /////////////////////////////////////////////////////////////////////////////
-int clModelMath::RandomRound(float fNumber) {
+int clModelMath::RandomRound(float fNumber, gsl_rng *p_oStream) {
   double fIntegerPart = 0, //we'll split a float number into integer and
   //fractional parts - this is the integer part
   fFractionalPart = 0; //fractional part
@@ -82,7 +141,7 @@ int clModelMath::RandomRound(float fNumber) {
   //Split the number into integer and fractional part
   fFractionalPart = modf( fNumber, & fIntegerPart );
 
-  return ( GetRand() <= fFractionalPart ? ( int )( fIntegerPart + 1 ) : ( int )fIntegerPart );
+  return ( GetRand(p_oStream) <= fFractionalPart ? ( int )( fIntegerPart + 1 ) : ( int )fIntegerPart );
 }
 
 //---------------------------------------------------------------------------
@@ -132,23 +191,25 @@ float clModelMath::CalculateLognormalFunction(float fX0, float fXb,
 /////////////////////////////////////////////////////////////////////////////
 // PoissonRandomDraw()
 /////////////////////////////////////////////////////////////////////////////
-int clModelMath::PoissonRandomDraw(float fLambda) {
-  return (gsl_ran_poisson(randgen, fLambda));
+int clModelMath::PoissonRandomDraw(float fLambda, gsl_rng *p_oStream) {
+  return (gsl_ran_poisson(p_oStream, fLambda));
 }
 
 /////////////////////////////////////////////////////////////////////////////
 // LognormalRandomDraw()
 /////////////////////////////////////////////////////////////////////////////
-float clModelMath::LognormalRandomDraw(float fMean, float fStdDev) {
-  return (gsl_ran_lognormal(randgen, fMean, fStdDev));
+float clModelMath::LognormalRandomDraw(float fMean, float fStdDev,
+    gsl_rng *p_oStream) {
+  return (gsl_ran_lognormal(p_oStream, fMean, fStdDev));
 }
 
 /////////////////////////////////////////////////////////////////////////////
 // NegBinomialRandomDraw()
 /////////////////////////////////////////////////////////////////////////////
-int clModelMath::NegBinomialRandomDraw(float fMean, float fClumping) {
+int clModelMath::NegBinomialRandomDraw(float fMean, float fClumping,
+    gsl_rng *p_oStream) {
   double fPDF, fCDF;
-  float fRand = GetRand();
+  float fRand = GetRand(p_oStream);
   int iCount = 0;
   fPDF = pow((fClumping/(fClumping+fMean)), fClumping); //term for PDF for zero counts
   fCDF = fPDF;
@@ -165,8 +226,8 @@ int clModelMath::NegBinomialRandomDraw(float fMean, float fClumping) {
 /////////////////////////////////////////////////////////////////////////////
 // NormalRandomDraw()
 /////////////////////////////////////////////////////////////////////////////
-float clModelMath::NormalRandomDraw(float fStdDev) {
-  return gsl_ran_gaussian(randgen, fStdDev);
+float clModelMath::NormalRandomDraw(float fStdDev, gsl_rng *p_oStream) {
+  return gsl_ran_gaussian(p_oStream, fStdDev);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -194,10 +255,11 @@ float clModelMath::AddBarkToDBH(float fDIB, float fA, float fB, float fC) {
 /////////////////////////////////////////////////////////////////////////////
 // InverseGaussianRandomDraw()
 /////////////////////////////////////////////////////////////////////////////
-float clModelMath::InverseGaussianRandomDraw(float fMu, float fLambda) {
+float clModelMath::InverseGaussianRandomDraw(float fMu, float fLambda,
+    gsl_rng *p_oStream) {
   float n, v, w, c, x, p;
 
-  n = gsl_ran_gaussian(randgen, 1);
+  n = gsl_ran_gaussian(p_oStream, 1);
   v = n*n;
   w = fMu*v;
   c = fMu/(2.0*fLambda);
@@ -205,7 +267,7 @@ float clModelMath::InverseGaussianRandomDraw(float fMu, float fLambda) {
   x = fMu + c*(w - sqrt(w*(4.0*fLambda + w)));
   p = fMu/(fMu + x);
 
-  if (p > gsl_rng_uniform(randgen))
+  if (p > gsl_rng_uniform(p_oStream))
     return (x);
   else
     return (fMu*fMu/x);
@@ -214,6 +276,38 @@ float clModelMath::InverseGaussianRandomDraw(float fMu, float fLambda) {
 /////////////////////////////////////////////////////////////////////////////
 // GammaRandomDraw()
 /////////////////////////////////////////////////////////////////////////////
-float clModelMath::GammaRandomDraw(float fMean, float fScale) {
-  return gsl_ran_gamma(randgen, fMean / fScale, fScale);
+float clModelMath::GammaRandomDraw(float fMean, float fScale,
+    gsl_rng *p_oStream) {
+  return gsl_ran_gamma(p_oStream, fMean / fScale, fScale);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// NewRandomStream()
+/////////////////////////////////////////////////////////////////////////////
+gsl_rng* clModelMath::NewRandomStream() {
+  return gsl_rng_alloc(&philox_type);
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SetRandomStream()
+/////////////////////////////////////////////////////////////////////////////
+void clModelMath::SetRandomStream(gsl_rng *p_oStream, int iTimestep,
+    int iBehavior, uint32_t iItem) {
+  stcPhiloxState *p_oState;
+
+  if (NULL == p_oStream || &philox_type != p_oStream->type) {
+    modelErr stcErr;
+    stcErr.sFunction = "clModelMath::SetRandomStream" ;
+    stcErr.sMoreInfo = "Generator was not made by NewRandomStream.";
+    stcErr.iErrorCode = ILLEGAL_OP;
+    throw( stcErr );
+  }
+
+  //The seed is the key; what's being drawn for fills out the counter, leaving
+  //the first word to count draws
+  p_oState = (stcPhiloxState*) p_oStream->state;
+  PhiloxSet(p_oState, m_lStreamSeed);
+  p_oState->p_iCounter[1] = iItem;
+  p_oState->p_iCounter[2] = (uint32_t) iTimestep;
+  p_oState->p_iCounter[3] = (uint32_t) iBehavior;
 }
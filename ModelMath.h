@@ -17,15 +17,28 @@
 * was used. But I have also opened up the random number generator so that
 * other classes can use the GSL functions directly if they wish.
 *
+* Besides the one shared generator, there are random streams.  A stream is a
+* GSL generator of a counter-based type (Philox-4x32-10, from Salmon et al.
+* 2011, "Parallel random numbers: as easy as 1, 2, 3").  Each draw is a
+* function of the run's seed, a key, and the number of draws already taken
+* from that key, and of nothing else.  A behavior that keys a stream to
+* a timestep, itself, and a tree or cell before drawing for that tree or cell
+* gets the same numbers no matter what order the trees or cells are visited
+* in, or how many threads are doing the visiting.  Any of the draw functions
+* below can take a stream in place of the shared generator, and so can any
+* GSL distribution function.
+*
 * Copyright 2005 Charles D. Canham.
 * @author Lora E. Murphy
 *
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Added keyed random streams (agent)
 */
 
 #include <gsl/gsl_rng.h>
+#include <stdint.h>
 
 class clModelMath {
 
@@ -48,9 +61,10 @@ class clModelMath {
   * Random number generator. This just wraps a call to GSL's uniform random
   * number generator.
   *
+  * @param p_oStream Generator to draw from; defaults to the shared generator.
   * @return a random number between 0 and 1.
   */
-  static float GetRand();
+  static float GetRand(gsl_rng *p_oStream = randgen);
 
   /**
   * Calculates basal area.
@@ -77,9 +91,10 @@ class clModelMath {
   * equal to it, one is added to the integer part; otherwise the integer part
   * is returned as-is.
   * @param fNumber Number to round.
+  * @param p_oStream Generator to draw from; defaults to the shared generator.
   * @return Rounded number.
   */
-  static int RandomRound(float fNumber);
+  static int RandomRound(float fNumber, gsl_rng *p_oStream = randgen);
 
   /**
   * Calculates the exponential of the Weibull probability distribution function
@@ -111,9 +126,10 @@ class clModelMath {
   * GSL function.
   *
   * @param fLambda Lambda (mean) of the Poisson function.
+  * @param p_oStream Generator to draw from; defaults to the shared generator.
   * @return Integer random draw.
   */
-  static int PoissonRandomDraw(float fLambda);
+  static int PoissonRandomDraw(float fLambda, gsl_rng *p_oStream = randgen);
 
   /**
   * Returns a random lognormally-distributed number.  The lognormal
@@ -128,9 +144,11 @@ class clModelMath {
   * @param fMean Mean of the distribution, or zeta in the above formula.
   * @param fStdDev Standard deviation of the distribution, or sigma in the
   * above formula.
+  * @param p_oStream Generator to draw from; defaults to the shared generator.
   * @return Random lognormally-distributed number.
   */
-  static float LognormalRandomDraw(float fMean, float fStdDev);
+  static float LognormalRandomDraw(float fMean, float fStdDev,
+      gsl_rng *p_oStream = randgen);
 
   /**
   * Returns a random normally-distributed number with mean zero and standard
@@ -141,9 +159,10 @@ class clModelMath {
   *
   * This function just wraps the appropriate GSL function.
   * @param fStdDev Standard deviation.
+  * @param p_oStream Generator to draw from; defaults to the shared generator.
   * @return Random normally-distributed number.
   */
-  static float NormalRandomDraw(float fStdDev);
+  static float NormalRandomDraw(float fStdDev, gsl_rng *p_oStream = randgen);
 
   /**
   * Returns a random negative binomially-distributed number.  The form of the
@@ -151,9 +170,11 @@ class clModelMath {
   * (The Ecological Detective).  Charlie Canham created this code.
   * @param fMean Function mean.
   * @param fClumping Clumping parameter.
+  * @param p_oStream Generator to draw from; defaults to the shared generator.
   * @return Random negative-binomially-distributed number.
   */
-  static int NegBinomialRandomDraw(float fMean, float fClumping);
+  static int NegBinomialRandomDraw(float fMean, float fClumping,
+      gsl_rng *p_oStream = randgen);
 
   /**
   * Adds bark to a tree diameter.  The equation is:
@@ -187,8 +208,10 @@ class clModelMath {
     @endhtmlonly
    * @param fMu: mu.
    * @param fLambda: lambda.
+   * @param p_oStream Generator to draw from; defaults to the shared generator.
    */
-  static float InverseGaussianRandomDraw(float fMu, float fLambda);
+  static float InverseGaussianRandomDraw(float fMu, float fLambda,
+      gsl_rng *p_oStream = randgen);
 
   /**
    * Returns a random number drawn from the gamma distribution. This is a
@@ -196,9 +219,33 @@ class clModelMath {
    * parameter, and b = scale parameter. The shape parameter a = mean / scale.
    * @param fMean Function mean.
    * @param fScale Scale parameter.
+   * @param p_oStream Generator to draw from; defaults to the shared generator.
    * @return Desired random deviate.
    */
-  static float GammaRandomDraw(float fMean, float fScale);
+  static float GammaRandomDraw(float fMean, float fScale,
+      gsl_rng *p_oStream = randgen);
+
+  /**
+   * Creates a new random stream.  It must be keyed with SetRandomStream()
+   * before use, and freed with gsl_rng_free() when done.  Each thread drawing
+   * numbers at the same time needs its own stream.
+   * @return New random stream.
+   */
+  static gsl_rng* NewRandomStream();
+
+  /**
+   * Keys a random stream, and rewinds it to its first draw.  The numbers that
+   * follow depend only on the run's random seed and the values passed here.
+   * @param p_oStream Stream to key; must come from NewRandomStream().
+   * @param iTimestep Current timestep.
+   * @param iBehavior Something identifying the caller, such as its index in
+   * the behavior list, so that two behaviors drawing for the same tree don't
+   * get the same numbers.
+   * @param iItem The tree, cell, or other item being drawn for.
+   * @throw modelErr if p_oStream is not a random stream.
+   */
+  static void SetRandomStream(gsl_rng *p_oStream, int iTimestep, int iBehavior,
+      uint32_t iItem);
 
   /**Random number generator. Currently set to the Mersenne Twister algorithm.*/
   static gsl_rng *randgen;
@@ -209,7 +256,13 @@ class clModelMath {
   */
   static void SetRandomSeed(long iSeed) {
    gsl_rng_set (randgen, iSeed);
+   m_lStreamSeed = iSeed;
  }
+
+  protected:
+  /**Seed that random streams are keyed from - the last seed passed to
+  * SetRandomSeed().*/
+  static long m_lStreamSeed;
 };
 //---------------------------------------------------------------------------
 #endif
@@ -8,6 +8,9 @@
 #include <stdlib.h>
 #include <string.h>
 #include <string>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
 #else
 //Windows defines
 #include <io.h>
@@ -308,3 +311,72 @@ void ReplaceAll( std::string &source, const std::string &find,
     source.replace( j, find.length(), replace );
   }
 }
+
+////////////////////////////////////////////////////////////////////////////
+// GetNumProcessors
+////////////////////////////////////////////////////////////////////////////
+#ifdef linux
+//Linux version
+int GetNumProcessors() {
+  long iNum = sysconf(_SC_NPROCESSORS_ONLN);
+  return iNum > 0 ? (int)iNum : 1;
+}
+#else
+//Windows version
+int GetNumProcessors() {
+  SYSTEM_INFO stcInfo;
+  GetSystemInfo(&stcInfo);
+  return stcInfo.dwNumberOfProcessors > 0 ? (int)stcInfo.dwNumberOfProcessors : 1;
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////
+// StartWorker
+////////////////////////////////////////////////////////////////////////////
+#ifdef linux
+//Linux version
+long StartWorker() {
+  return (long)fork();
+}
+#else
+//Windows version - no workers
+long StartWorker() {
+  return -1;
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////
+// WaitForWorker
+////////////////////////////////////////////////////////////////////////////
+#ifdef linux
+//Linux version
+long WaitForWorker(int &iStatus) {
+  int iWaitStatus;
+  pid_t iPid = waitpid(-1, &iWaitStatus, 0);
+  if (iPid <= 0) return -1;
+  iStatus = WIFEXITED(iWaitStatus) ? WEXITSTATUS(iWaitStatus) : -1;
+  return (long)iPid;
+}
+#else
+//Windows version - no workers
+long WaitForWorker(int &iStatus) {
+  iStatus = -1;
+  return -1;
+}
+#endif
+
+////////////////////////////////////////////////////////////////////////////
+// ExitWorker
+////////////////////////////////////////////////////////////////////////////
+#ifdef linux
+//Linux version
+void ExitWorker(int iStatus) {
+  fflush(NULL);
+  _exit(iStatus);
+}
+#else
+//Windows version - no workers
+void ExitWorker(int iStatus) {
+  exit(iStatus);
+}
+#endif
@@ -18,6 +18,7 @@ using namespace std;
 * <br>April 28, 2004 - Submitted as beta (LEM)
 * <br>June 20, 2007 - New Linux versions of the functions, based on code
 * originally written by Daniel Lipsitt, to whom great thanks is owed (LEM)
+* <br>October 17, 2026 - Added worker process functions for batch runs (agent)
 */
 
  /**
@@ -100,5 +101,41 @@ using namespace std;
  void ReplaceAll( std::string &source, const std::string &find,
        const std::string& replace );
 
+
+ /**
+  * Gets the number of processors available.
+  * @return Number of processors, or 1 if it can't be found.
+  */
+ int GetNumProcessors();
+
+ /**
+  * Starts a worker process which is a copy of this one, with the same memory
+  * contents, picking up at the point of the call. Both processes return from
+  * this function; they can tell which is which by the return value. The worker
+  * should end by calling ExitWorker(). Flush any buffered output before
+  * calling, or the worker will write it a second time.
+  *
+  * Only Linux supports workers; for Windows this always returns -1.
+  * @return 0 in the worker; the worker's process ID in the parent; or -1 if
+  * the worker could not be started.
+  */
+ long StartWorker();
+
+ /**
+  * Waits for any worker started with StartWorker() to finish.
+  * @param iStatus Set to the worker's exit status. A worker that didn't exit
+  * normally gets -1.
+  * @return Process ID of the worker that finished, or -1 if there are no
+  * workers running.
+  */
+ long WaitForWorker(int &iStatus);
+
+ /**
+  * Ends a worker process without running any cleanup (the cleanup belongs to
+  * the parent's copy of the memory).
+  * @param iStatus Exit status to report to WaitForWorker().
+  */
+ void ExitWorker(int iStatus);
+
 //---------------------------------------------------------------------------
 #endif
@@ -5,6 +5,7 @@
 #include <string>
 #include <time.h> //for getting dates
 #include <queue>
+#include <stdlib.h>
 #include "SimManager.h"
 
 //Interface stuff
@@ -22,7 +23,12 @@
 // the application name.  This starts the application using the interactive
 // text interface.  In the second, there is one argument, a filename, after the
 // application name.  This causes the application to start and immediately
-// begin processing that file (i.e., command-line style).
+// begin processing that file (i.e., command-line style).  A second argument
+// after a parameter file is the number of timesteps to run; after a batch
+// file, it is the number of runs to do at once (0 for one per processor).
+// Either way, "-threads N" anywhere after the application name sets the number
+// of threads each run uses (0 for one per processor, 1 to run serially); this
+// overrides "numThreads" in the parameter file.
 //
 // In either mode, you can pause an in-process run.  The method depends on the
 // active interface DLL (with the DOS one, hit any key; with the Java one,
@@ -79,6 +85,26 @@ int main( int argc, char * argv[] )
   int iMajorVersion = 7, iMinorVersion = 06;
   clSimManager p_oSimManager( iMajorVersion, iMinorVersion, sPath);
 
+  //***************************************
+  // Pull out the number of threads, if it was given
+  //***************************************
+  for ( int i = 1; i < argc - 1; i++ )
+  {
+    if ( string( argv[i] ) == "-threads" )
+    {
+      int iNumThreads = atoi( argv[i + 1] );
+      if ( ( 0 == iNumThreads && argv[i + 1] [0] != '0' ) || iNumThreads < 0 )
+      {
+        cout << "Unrecognized number of threads: " << argv[i + 1] << "\n";
+        return 1;
+      }
+      p_oSimManager.SetCommandLineThreads( iNumThreads );
+      for ( int j = i + 2; j < argc; j++ ) argv[j - 2] = argv[j];
+      argc -= 2;
+      break;
+    }
+  }
+
   //***************************************
   // Command line mode or text interface mode?
   // If the model was started with an argument, assume it is
@@ -115,7 +141,19 @@ int main( int argc, char * argv[] )
       fileType iFileType = p_oSimManager.GetFileType( argv[1] );
       if ( batchfile == iFileType )
       {
-        p_oSimManager.RunBatch( argv[1] );
+        //If there's an extra argument, it's the number of runs to do at once
+        int iNumWorkers = -1;
+        if ( 3 == argc )
+        {
+          iNumWorkers = atoi( argv[2] );
+          if ( ( 0 == iNumWorkers && argv[2] [0] != '0' ) || iNumWorkers < 0 )
+          {
+            cerr << "Couldn't read number of workers: " << argv[2] << "\n";
+            return 1;
+          }
+        }
+
+        p_oSimManager.RunBatch( argv[1], iNumWorkers );
         if ( p_oSimManager.GetSimState() == clSimManager::Run_Complete
              || p_oSimManager.GetSimState() == clSimManager::No_Data )
              {
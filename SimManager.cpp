@@ -22,8 +22,11 @@
 #include "PopulationBase.h"
 #include "ParsingFunctions.h"
 #include "ModelMath.h"
+#include "PlatformFuncs.h"
+#include "TaskPool.h"
 
 //XML includes
+
 #include <xercesc/sax/HandlerBase.hpp>
 #include <xercesc/util/XMLString.hpp>
 #include <xercesc/util/PlatformUtils.hpp>
@@ -47,6 +50,15 @@ clSimManager::clSimManager( int iMajorVersion, int iMinorVersion, const string s
     mp_oGridManager = NULL;
     mp_oPlot = NULL;
 
+    mp_oTaskPool = new clTaskPool();
+    m_iCommandLineThreads = -1;
+    m_iDefaultThreads = 0;
+
+    mp_oSchedule = NULL;
+    mp_iLevelStart = NULL;
+    mp_iBehaviorLevel = NULL;
+    m_iScheduleSize = 0;
+
     m_eSimState = No_Data;
 
     m_iBatchNumber = 0;
@@ -105,6 +117,12 @@ clSimManager::~clSimManager()
   delete mp_oBehaviorManager; mp_oBehaviorManager = NULL;
   delete mp_oPlot; mp_oPlot = NULL;
 
+  delete[] mp_oSchedule;
+  delete[] mp_iLevelStart;
+  delete[] mp_iBehaviorLevel;
+
+  delete mp_oTaskPool; mp_oTaskPool = NULL;
+
   //Shut down the XML tools
   delete mp_oXMLParser;
   XMLPlatformUtils::Terminate();
@@ -501,11 +519,9 @@ unsigned long clSimManager::RunSim( int iNumStepsToRun )
     using namespace std;
     DOMDocument * p_oDoc; //in case we need to parse and reload the par file
     clWorkerBase * p_oTempObject = NULL;
-    clBehaviorBase * p_oBehavior = NULL;
     clPopulationBase * p_oPopulation = NULL;
     modelMsg stcMsg; //for checking for messages
-    int iNumBehaviors = 0, //number of behaviors - for looping through
-        //and calling their Action() functions
+    int iNumLevels = 0, //number of behavior levels this timestep
         iNumPopulations = 0, //number of populations
         iTimestep = 0, //current timestep - loop counter
         iStartTimestep = 0, //the timestep to start on this time
@@ -582,9 +598,6 @@ unsigned long clSimManager::RunSim( int iNumStepsToRun )
       m_iTargetTimestep = iEndTimestep;
     } //end of else - not paused
 
-    //Query the behavior manager for the number of behaviors to run
-    //each timestep
-    iNumBehaviors = mp_oBehaviorManager->GetNumberOfObjects();
     iNumPopulations = mp_oPopulationManager->GetNumberOfObjects();
 
     //TIMESTEP LOOP
@@ -610,29 +623,36 @@ unsigned long clSimManager::RunSim( int iNumStepsToRun )
 
       m_iCurrentTimestep = iTimestep;
 
-      //Run each behavior object
-      for ( int i = 0; i < iNumBehaviors; i++ )
+      //Run the behaviors a level at a time
+      iNumLevels = ScheduleBehaviors();
+      for ( int iLevel = 0; iLevel < iNumLevels; iLevel++ )
       {
-        p_oTempObject = mp_oBehaviorManager->PassObjectPointer( i );
-        p_oBehavior = dynamic_cast < clBehaviorBase * > ( p_oTempObject );
 
 #ifdef DEBUG
-        stcMsg.iMessageCode = INFO;
-        stringstream msg;
-        fstream out( "debug log.txt", ios::out | ios::app );
-        msg << "Timestep " << iTimestep << ": Starting behavior " << p_oBehavior->GetName() << " at " << clock();
-        out << "Timestep " << iTimestep << ": Starting behavior " << p_oBehavior->GetName() << " at " << clock() << "\n";
-        out.close();
-        stcMsg.sMoreInfo = msg.str();
-        SendMessage( stcMsg );
+        for ( int i = mp_iLevelStart[iLevel]; i < mp_iLevelStart[iLevel + 1]; i++ )
+        {
+          clBehaviorBase * p_oBehavior = mp_oSchedule[i];
+          stcMsg.iMessageCode = INFO;
+          stringstream msg;
+          fstream out( "debug log.txt", ios::out | ios::app );
+          msg << "Timestep " << iTimestep << ": Starting behavior " << p_oBehavior->GetName() << " at " << clock();
+          out << "Timestep " << iTimestep << ": Starting behavior " << p_oBehavior->GetName() << " at " << clock() << "\n";
+          out.close();
+          stcMsg.sMoreInfo = msg.str();
+          SendMessage( stcMsg );
+        }
 #endif
 
-        p_oBehavior->Action();
-        for ( int j = 0; j < iNumPopulations; j++ )
+        //The populations only need updating if trees were added, removed,
+        //moved, or changed size
+        if ( RunBehaviorLevel( iLevel ) )
         {
-          p_oTempObject = mp_oPopulationManager->PassObjectPointer( j );
-          p_oPopulation = dynamic_cast < clPopulationBase * > ( p_oTempObject );
-          p_oPopulation->DoDataUpdates();
+          for ( int j = 0; j < iNumPopulations; j++ )
+          {
+            p_oTempObject = mp_oPopulationManager->PassObjectPointer( j );
+            p_oPopulation = dynamic_cast < clPopulationBase * > ( p_oTempObject );
+            p_oPopulation->DoDataUpdates();
+          }
         }
       }
 
@@ -716,6 +736,156 @@ unsigned long clSimManager::RunSim( int iNumStepsToRun )
 }
 
 
+/////////////////////////////////////////////////////////////////////////////
+// ScheduleBehaviors()
+/////////////////////////////////////////////////////////////////////////////
+int clSimManager::ScheduleBehaviors()
+{
+  clBehaviorBase * p_oBehavior, * p_oEarlier;
+  int iNumBehaviors = mp_oBehaviorManager->GetNumberOfObjects(),
+      iNumLevels = 0, i, j, iLevel;
+
+  if ( iNumBehaviors > m_iScheduleSize )
+  {
+    delete[] mp_oSchedule;
+    delete[] mp_iLevelStart;
+    delete[] mp_iBehaviorLevel;
+    m_iScheduleSize = iNumBehaviors;
+    mp_oSchedule = new clBehaviorBase * [m_iScheduleSize];
+    mp_iLevelStart = new int[m_iScheduleSize + 1];
+    mp_iBehaviorLevel = new int[m_iScheduleSize];
+  }
+
+  //Each behavior goes one level past the highest earlier behavior it
+  //conflicts with
+  for ( i = 0; i < iNumBehaviors; i++ )
+  {
+    p_oBehavior = dynamic_cast < clBehaviorBase * >
+        ( mp_oBehaviorManager->PassObjectPointer( i ) );
+    mp_iBehaviorLevel[i] = 0;
+    for ( j = 0; j < i; j++ )
+    {
+      if ( mp_iBehaviorLevel[j] < mp_iBehaviorLevel[i] ) continue;
+      p_oEarlier = dynamic_cast < clBehaviorBase * >
+          ( mp_oBehaviorManager->PassObjectPointer( j ) );
+      if ( BehaviorsConflict( p_oEarlier, p_oBehavior ) )
+        mp_iBehaviorLevel[i] = mp_iBehaviorLevel[j] + 1;
+    }
+    if ( mp_iBehaviorLevel[i] >= iNumLevels )
+      iNumLevels = mp_iBehaviorLevel[i] + 1;
+  }
+
+  //Group the behaviors by level, keeping list order within each level
+  j = 0;
+  for ( iLevel = 0; iLevel < iNumLevels; iLevel++ )
+  {
+    mp_iLevelStart[iLevel] = j;
+    for ( i = 0; i < iNumBehaviors; i++ )
+      if ( iLevel == mp_iBehaviorLevel[i] )
+        mp_oSchedule[j++] = dynamic_cast < clBehaviorBase * >
+            ( mp_oBehaviorManager->PassObjectPointer( i ) );
+  }
+  mp_iLevelStart[iNumLevels] = j;
+
+  return iNumLevels;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// BehaviorsConflict()
+/////////////////////////////////////////////////////////////////////////////
+bool clSimManager::BehaviorsConflict(clBehaviorBase *p_oFirst,
+    clBehaviorBase *p_oSecond)
+{
+  int iFirstRead = p_oFirst->GetResourcesRead(),
+      iFirstWrite = p_oFirst->GetResourcesWritten(),
+      iSecondRead = p_oSecond->GetResourcesRead(),
+      iSecondWrite = p_oSecond->GetResourcesWritten();
+
+  //Copies of the same behavior share their "own" data
+  if ( p_oFirst->GetName() == p_oSecond->GetName() )
+  {
+    iFirstRead = ShareOwnResources( iFirstRead );
+    iFirstWrite = ShareOwnResources( iFirstWrite );
+    iSecondRead = ShareOwnResources( iSecondRead );
+    iSecondWrite = ShareOwnResources( iSecondWrite );
+  }
+
+  return ResourcesOverlap( iFirstWrite, iSecondRead | iSecondWrite ) ||
+         ResourcesOverlap( iSecondWrite, iFirstRead | iFirstWrite );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ResourcesOverlap()
+/////////////////////////////////////////////////////////////////////////////
+bool clSimManager::ResourcesOverlap(int iFirst, int iSecond)
+{
+  int iOwn = clBehaviorBase::own_tree_data | clBehaviorBase::own_grid;
+
+  if ( iFirst & iSecond & ~iOwn ) return true;
+
+  //One behavior's own data is part of the general pool to everyone else
+  if ( ( iFirst & clBehaviorBase::own_tree_data ) &&
+      ( iSecond & clBehaviorBase::tree_data ) ) return true;
+  if ( ( iFirst & clBehaviorBase::tree_data ) &&
+      ( iSecond & clBehaviorBase::own_tree_data ) ) return true;
+  if ( ( iFirst & clBehaviorBase::own_grid ) &&
+      ( iSecond & clBehaviorBase::grids ) ) return true;
+  if ( ( iFirst & clBehaviorBase::grids ) &&
+      ( iSecond & clBehaviorBase::own_grid ) ) return true;
+
+  return false;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ShareOwnResources()
+/////////////////////////////////////////////////////////////////////////////
+int clSimManager::ShareOwnResources(int iResources)
+{
+  if ( iResources & clBehaviorBase::own_tree_data )
+    iResources |= clBehaviorBase::tree_data;
+  if ( iResources & clBehaviorBase::own_grid )
+    iResources |= clBehaviorBase::grids;
+  return iResources;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// SetCommandLineThreads()
+/////////////////////////////////////////////////////////////////////////////
+void clSimManager::SetCommandLineThreads(int iNumThreads)
+{
+  mp_oTaskPool->SetNumThreads( iNumThreads );
+  m_iCommandLineThreads = iNumThreads;
+}
+
+
+/////////////////////////////////////////////////////////////////////////////
+// stcRunBehavior::operator()
+/////////////////////////////////////////////////////////////////////////////
+void clSimManager::stcRunBehavior::operator()(int i)
+{
+  p_oSchedule[i]->Action();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// RunBehaviorLevel()
+/////////////////////////////////////////////////////////////////////////////
+bool clSimManager::RunBehaviorLevel(int iLevel)
+{
+  int iFirst = mp_iLevelStart[iLevel], iLast = mp_iLevelStart[iLevel + 1], i;
+  bool bStructureChanged = false;
+
+  for ( i = iFirst; i < iLast; i++ )
+    if ( mp_oSchedule[i]->GetResourcesWritten() & clBehaviorBase::tree_structure )
+      bStructureChanged = true;
+
+  stcRunBehavior stcRun;
+  stcRun.p_oSchedule = mp_oSchedule;
+  mp_oTaskPool->ParallelFor( iFirst, iLast, stcRun );
+
+  return bStructureChanged;
+}
+
+
 /////////////////////////////////////////////////////////////////////////////
 // TimestepCleanup()
 /////////////////////////////////////////////////////////////////////////////
@@ -1287,8 +1457,18 @@ void clSimManager::DoSetup( DOMDocument * p_oDoc )
       m_iActualSeed = m_iRandomSeed;
     }
 
+    //Give each run of a batch its own seed
+    if ( m_iBatchNumber > 1 )
+      m_iActualSeed = DeriveRunSeed( m_iActualSeed, m_iBatchNumber );
+
     clModelMath::SetRandomSeed(m_iActualSeed);
 
+    //Get the number of threads, if present; the command line wins
+    iTemp = m_iDefaultThreads;
+    FillSingleValue( p_oElement, "numThreads", & iTemp, false );
+    if ( m_iCommandLineThreads >= 0 ) iTemp = m_iCommandLineThreads;
+    mp_oTaskPool->SetNumThreads( iTemp );
+
     //log.open(logFileName, ios::out | ios::app);
     //log << "Beginning of run for par file " << m_strParFilename << "\n";
     //log.close();
@@ -1316,33 +1496,23 @@ void clSimManager::DoSetup( DOMDocument * p_oDoc )
 /////////////////////////////////////////////////////////////////////////////
 // RunBatch()
 /////////////////////////////////////////////////////////////////////////////
-void clSimManager::RunBatch(string sBatchFile) {
+void clSimManager::RunBatch(string sBatchFile, int iNumWorkers) {
   using namespace std;
-  DOMDocument * p_oBatchFileDoc, //Document object model of the batch file
-  * p_oParFileDoc; //DOM of par file
+  DOMDocument * p_oBatchFileDoc; //Document object model of the batch file
   DOMElement * p_oBatchElement; //Element variable for batch group
-  DOMNode * p_oBatchNode, //Node variable for batch group
-  * p_oFilenameNode; //Node for detailed output filename
+  DOMNode * p_oBatchNode; //Node variable for batch group
   DOMNodeList * p_oBatchGroups, //List of all batch group
   * p_oNodeList;
-  fileType iFileType;
-
-  //This is the list of parameter file names and number of times to run
-  //each
-  struct stcParFiles
-  {
-    string sParFileName;
-    short int iNumRuns;
-  }
-  * p_parFileList;
+  stcParFiles * p_parFileList; //par file names and number of times to run each
 
   fstream file; //for checking the validity of file names
-  stringstream strNewFileName; //for assembling the new output filenames
+  stringstream sFailedRuns; //list of runs that didn't finish
   char * cNumRunsText; //text for number of times to run
-  std::string strDetailedOutputFileName, //file name of detailed output file, if any
-  strShortOutFileName; //file name of short output file, if any
+  time_t iBatchStart;
   int iNumBatchGroups = 0, //number of par file / run number pairs
       iNumNodes = 0, //used for counting search results
+      iNumRuns = 0, //number of runs started
+      iNumFailed = 0, //number of runs that didn't finish
       iStart,
       i, j; //loop counter
   bool bPausedFlag = (0 != m_iBatchNumber);
@@ -1382,12 +1552,33 @@ void clSimManager::RunBatch(string sBatchFile) {
   mp_oXMLParser->parse(m_sBatchFilename.c_str());
   p_oBatchFileDoc = mp_oXMLParser->getDocument();
 
+  //Number of workers - the argument wins over the batch file, which wins
+  //over the default of one
+  if ( iNumWorkers < 0 ) {
+    iNumWorkers = 1;
+    p_oNodeList = p_oBatchFileDoc->getElementsByTagName( XMLString::transcode( "ba_numWorkers" ) );
+    if ( 0 != p_oNodeList->getLength() ) {
+      cNumRunsText = XMLString::transcode( p_oNodeList->item( 0 )->getFirstChild()->getNodeValue() );
+      iNumWorkers = atoi( cNumRunsText );
+      if ( 0 == iNumWorkers && strcmp( cNumRunsText, "0" ) != 0 ) {
+        modelErr stcErr;
+        stcErr.sFunction = "clSimManager::RunBatch" ;
+        stcErr.iErrorCode = BAD_DATA;
+        std::stringstream s;
+        s << "Number of workers is not a number:  " << cNumRunsText;
+        stcErr.sMoreInfo = s.str();
+        throw( stcErr );
+      }
+    }
+  }
+  if ( 0 >= iNumWorkers ) iNumWorkers = GetNumProcessors();
+
   //Count the number of batch groups
   p_oBatchGroups = p_oBatchFileDoc->getElementsByTagName( XMLString::transcode( "ba_parFile" ) );
   iNumBatchGroups = p_oBatchGroups->getLength();
 
   //Declare the filename array to match
-  p_parFileList = new struct stcParFiles[iNumBatchGroups];
+  p_parFileList = new stcParFiles[iNumBatchGroups];
 
   for ( i = 0; i < iNumBatchGroups; i++ )
   {
@@ -1466,6 +1657,19 @@ void clSimManager::RunBatch(string sBatchFile) {
     }
   } //end of for (i = 0; i < iNumBatchGroups; i++)
 
+  iBatchStart = time( NULL );
+
+  //****************************************
+  //Workers
+  //If more than one worker was asked for, farm the runs out to worker
+  //processes.  A batch that was paused partway picks up in this process.
+  //****************************************
+  if ( iNumWorkers > 1 && !bPausedFlag && 0 == m_iBatchGroup )
+  {
+    RunBatchWithWorkers( p_parFileList, iNumBatchGroups, iNumWorkers );
+    delete[] p_parFileList;
+    return;
+  }
 
   //****************************************
   //Main Loop
@@ -1484,38 +1688,6 @@ void clSimManager::RunBatch(string sBatchFile) {
 
       //Set the filename as the current parameter filename
       m_sParFilename = p_parFileList[i].sParFileName;
-      iFileType = GetFileType(m_sParFilename);
-
-      mp_oXMLParser->parse(p_parFileList[i].sParFileName.c_str());
-      p_oParFileDoc = mp_oXMLParser->getDocument();
-      //In batch mode - we need to check for the presence of output settings.
-      //If it exists, grab the file names - we'll rename them for each run
-      //so they're not overwritten
-      p_oNodeList = p_oParFileDoc->getElementsByTagName( XMLString::transcode( "ou_filename" ) );
-      if ( 0 != p_oNodeList->getLength() )
-      {
-        strDetailedOutputFileName = XMLString::transcode( p_oNodeList->item( 0 )->getFirstChild()->getNodeValue() );
-        //trim off the file extension, if it exists
-        if ( "" != strDetailedOutputFileName )
-        {
-          strDetailedOutputFileName = strDetailedOutputFileName.substr( 0, strDetailedOutputFileName.find( TARBALL_FILE_EXT ) );
-        }
-      }
-      else
-        strDetailedOutputFileName = "";
-      //Short output
-      p_oNodeList = p_oParFileDoc->getElementsByTagName( XMLString::transcode( "so_filename" ) );
-      if ( 0 != p_oNodeList->getLength() )
-      {
-        strShortOutFileName = XMLString::transcode( p_oNodeList->item( 0 )->getFirstChild()->getNodeValue() );
-        //trim off the file extension, if it exists
-        if ( "" != strShortOutFileName )
-        {
-          strShortOutFileName = strShortOutFileName.substr( 0, strShortOutFileName.find( SHORT_OUTPUT_FILE_EXT ) );
-        }
-      }
-      else
-        strShortOutFileName = "";
 
       //Perform the number of runs specified
       cout << "\nBeginning runs for file " << p_parFileList[i].sParFileName << ".\n" << flush;
@@ -1532,39 +1704,17 @@ void clSimManager::RunBatch(string sBatchFile) {
         GoToNoDataState();
 
         m_iBatchNumber = j+1;
+        iNumRuns++;
 
-        //Re-parse the parameter file if this isn't the first timestep -
-        //otherwise we can just keep the parsed doc from above
-        if ( j > 0 ) {
-          mp_oXMLParser->parse(p_parFileList[i].sParFileName.c_str());
-          p_oParFileDoc = mp_oXMLParser->getDocument();
-        }
-        //Rename the output files in the DOM
-        if ( strDetailedOutputFileName != "" )
-        {
-          strNewFileName.str( "" );
-          strNewFileName << strDetailedOutputFileName << "_" << j + 1;
-          p_oNodeList = p_oParFileDoc->getElementsByTagName( XMLString::transcode( "ou_filename" ) );
-          p_oFilenameNode = p_oNodeList->item( 0 )->getFirstChild();
-          p_oFilenameNode->setNodeValue( XMLString::transcode( strNewFileName.str().c_str() ) );
-        }
-        if ( strShortOutFileName != "" )
-        {
-          strNewFileName.str( "" );
-          strNewFileName << strShortOutFileName << "_" << j + 1;
-          p_oNodeList = p_oParFileDoc->getElementsByTagName( XMLString::transcode( "so_filename" ) );
-          p_oFilenameNode = p_oNodeList->item( 0 )->getFirstChild();
-          p_oFilenameNode->setNodeValue( XMLString::transcode( strNewFileName.str().c_str() ) );
-        }
-
-        //Send in the par file
-        ReadParameterFile( p_oParFileDoc, iFileType );
+        //Send in the par file, with the output files renamed for this run
+        LoadBatchRun( j + 1 );
 
         //Run
         RunSim();
 
         //If the user quit this run, then quit the batch
         if (m_bUserQuit || m_bUserPaused) {
+          delete[] p_parFileList;
           return;
         }
         cout << "Run " << ( j + 1 ) << " of " << p_parFileList[i].iNumRuns << " completed.\n" << flush;
@@ -1582,6 +1732,7 @@ void clSimManager::RunBatch(string sBatchFile) {
       stcErr.sFunction = "Xerces parser";
       stcErr.sMoreInfo = message;
       XMLString::release(&message);
+      delete[] p_parFileList;
       throw(stcErr);
     }
     catch ( modelErr & err )
@@ -1591,6 +1742,8 @@ void clSimManager::RunBatch(string sBatchFile) {
         s << "Random seed: " << m_iActualSeed;
         err.sMoreInfo += s.str();
       }
+      iNumFailed++;
+      sFailedRuns << "\n  " << p_parFileList[i].sParFileName << ", run " << ( j + 1 );
       GoToNoDataState();
       ExternalErrorHandler( err, m_eSimState, true );
       goto NextBatchGroup;
@@ -1600,6 +1753,8 @@ void clSimManager::RunBatch(string sBatchFile) {
       modelErr stcErr;
       stcErr.iErrorCode = UNKNOWN;
       stcErr.sFunction = "clSimManager::RunBatch" ;
+      iNumFailed++;
+      sFailedRuns << "\n  " << p_parFileList[i].sParFileName << ", run " << ( j + 1 );
       GoToNoDataState();
       ExternalErrorHandler( stcErr, m_eSimState, true );
       goto NextBatchGroup;
@@ -1608,10 +1763,253 @@ void clSimManager::RunBatch(string sBatchFile) {
     NextBatchGroup:;
   } //end of for (i = 0; i < iNumBatchGroups; i++)
   m_iBatchGroup = 0;
+  ReportBatchSummary( iNumRuns, iNumFailed, sFailedRuns.str(), iBatchStart );
   //Delete the par file array
   delete[] p_parFileList;
 }
 
+/////////////////////////////////////////////////////////////////////////////
+// DeriveRunSeed()
+/////////////////////////////////////////////////////////////////////////////
+long clSimManager::DeriveRunSeed(long lSeed, int iRun) {
+  unsigned long iHash;
+
+  if ( iRun <= 1 ) return lSeed;
+
+  //Mix the seed and run number (MurmurHash3's 32-bit finalizer) so nearby
+  //seeds and run numbers don't give nearby streams
+  iHash = ( (unsigned long)( lSeed < 0 ? -lSeed : lSeed ) +
+      (unsigned long)iRun * 0x9E3779B9UL ) & 0xFFFFFFFFUL;
+  iHash ^= iHash >> 16;
+  iHash = ( iHash * 0x85EBCA6BUL ) & 0xFFFFFFFFUL;
+  iHash ^= iHash >> 13;
+  iHash = ( iHash * 0xC2B2AE35UL ) & 0xFFFFFFFFUL;
+  iHash ^= iHash >> 16;
+
+  iHash &= 0x7FFFFFFFUL;
+  if ( 0 == iHash ) iHash = 1;
+  return -(long)iHash;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// RunBatchWithWorkers()
+/////////////////////////////////////////////////////////////////////////////
+void clSimManager::RunBatchWithWorkers(stcParFiles *p_parFileList,
+    int iNumBatchGroups, int iNumWorkers) {
+  using namespace std;
+  stringstream sFailedRuns; //list of runs that didn't finish
+  time_t iBatchStart = time( NULL );
+  long * p_iWorkerID = new long[iNumWorkers]; //process ID of each worker slot
+  int * p_iWorkerGroup = new int[iNumWorkers], //batch group of each slot's run
+      * p_iWorkerRun = new int[iNumWorkers], //run number of each slot's run
+      iNextGroup = 0, iNextRun = 0, //next run to start
+      iNumRuns = 0, //number of runs, total
+      iNumDone = 0, //number of runs finished
+      iNumFailed = 0, //number of runs that didn't finish
+      iNumRunning = 0, //number of workers running
+      iStatus, i;
+  long iID;
+  bool bStop = false; //whether a user quit or paused a run
+
+  for ( i = 0; i < iNumBatchGroups; i++ ) iNumRuns += p_parFileList[i].iNumRuns;
+  for ( i = 0; i < iNumWorkers; i++ ) p_iWorkerID[i] = -1;
+
+  cout << "\nStarting " << iNumRuns << " runs with " << iNumWorkers
+       << " workers.\n" << flush;
+
+  //Skip over any batch groups with no runs
+  while ( iNextGroup < iNumBatchGroups && 0 == p_parFileList[iNextGroup].iNumRuns )
+    iNextGroup++;
+
+  while ( iNumRunning > 0 || ( iNextGroup < iNumBatchGroups && !bStop ) )
+  {
+    //Fill any empty worker slots
+    for ( i = 0; i < iNumWorkers && iNextGroup < iNumBatchGroups && !bStop; i++ )
+    {
+      if ( -1 != p_iWorkerID[i] ) continue;
+
+      //Don't let the worker inherit anything waiting to be written
+      cout << flush;
+      iID = StartWorker();
+      if ( 0 == iID )
+      {
+        //This is the worker - do the run and quit.  Unless told otherwise,
+        //it gets its share of the processors instead of all of them.
+        m_iDefaultThreads = GetNumProcessors() / iNumWorkers;
+        if ( m_iDefaultThreads < 1 ) m_iDefaultThreads = 1;
+        iStatus = DoWorkerRun( p_parFileList[iNextGroup], iNextGroup, iNextRun );
+        cout << flush;
+        ExitWorker( iStatus );
+      }
+      if ( iID < 0 )
+      {
+        iNumDone++;
+        iNumFailed++;
+        sFailedRuns << "\n  " << p_parFileList[iNextGroup].sParFileName
+                    << ", run " << ( iNextRun + 1 ) << " (couldn't start worker)";
+      }
+      else
+      {
+        p_iWorkerID[i] = iID;
+        p_iWorkerGroup[i] = iNextGroup;
+        p_iWorkerRun[i] = iNextRun;
+        iNumRunning++;
+      }
+
+      //Move on to the next run
+      iNextRun++;
+      if ( iNextRun >= p_parFileList[iNextGroup].iNumRuns )
+      {
+        iNextRun = 0;
+        iNextGroup++;
+        while ( iNextGroup < iNumBatchGroups && 0 == p_parFileList[iNextGroup].iNumRuns )
+          iNextGroup++;
+      }
+    }
+
+    if ( 0 == iNumRunning ) break;
+
+    //Wait for a worker to finish, then report on it
+    iID = WaitForWorker( iStatus );
+    if ( iID < 0 ) break;
+    for ( i = 0; i < iNumWorkers; i++ )
+      if ( iID == p_iWorkerID[i] ) break;
+    if ( i == iNumWorkers ) continue; //not one of ours
+    p_iWorkerID[i] = -1;
+    iNumRunning--;
+    iNumDone++;
+
+    cout << "Run " << ( p_iWorkerRun[i] + 1 ) << " of "
+         << p_parFileList[p_iWorkerGroup[i]].iNumRuns << " for file "
+         << p_parFileList[p_iWorkerGroup[i]].sParFileName;
+    if ( 0 == iStatus )
+      cout << " completed.";
+    else
+    {
+      cout << ( 2 == iStatus ? " stopped by user." : " failed." );
+      iNumFailed++;
+      sFailedRuns << "\n  " << p_parFileList[p_iWorkerGroup[i]].sParFileName
+                  << ", run " << ( p_iWorkerRun[i] + 1 );
+      //A user stopping a run stops the batch
+      if ( 2 == iStatus ) bStop = true;
+    }
+    cout << " (" << iNumDone << " of " << iNumRuns << " runs finished)\n" << flush;
+  }
+
+  ReportBatchSummary( iNumDone, iNumFailed, sFailedRuns.str(), iBatchStart );
+  GoToNoDataState();
+  m_iBatchGroup = 0;
+
+  delete[] p_iWorkerID;
+  delete[] p_iWorkerGroup;
+  delete[] p_iWorkerRun;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// DoWorkerRun()
+/////////////////////////////////////////////////////////////////////////////
+int clSimManager::DoWorkerRun(stcParFiles &stcParFile, int iGroup, int iRun) {
+  try
+  {
+    GoToNoDataState();
+    m_iBatchGroup = iGroup + 1;
+    m_iBatchNumber = iRun + 1;
+    m_sParFilename = stcParFile.sParFileName;
+
+    LoadBatchRun( iRun + 1 );
+    RunSim();
+
+    if ( m_bUserQuit || m_bUserPaused ) return 2;
+    return 0;
+  }
+  catch (SAXParseException & err) {
+    modelErr stcErr;
+    char* message = XMLString::transcode(err.getMessage());
+    stcErr.iErrorCode = BAD_XML_FILE;
+    stcErr.sFunction = "Xerces parser";
+    stcErr.sMoreInfo = message;
+    XMLString::release(&message);
+    ExternalErrorHandler( stcErr, m_eSimState, true );
+  }
+  catch ( modelErr & err )
+  {
+    if (err.sMoreInfo.compare("Random seed") != 0) {
+      stringstream s;
+      s << "Random seed: " << m_iActualSeed;
+      err.sMoreInfo += s.str();
+    }
+    ExternalErrorHandler( err, m_eSimState, true );
+  }
+  catch ( ... )
+  {
+    modelErr stcErr;
+    stcErr.iErrorCode = UNKNOWN;
+    stcErr.sFunction = "clSimManager::DoWorkerRun" ;
+    ExternalErrorHandler( stcErr, m_eSimState, true );
+  }
+  return 1;
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// LoadBatchRun()
+/////////////////////////////////////////////////////////////////////////////
+void clSimManager::LoadBatchRun(int iRun) {
+  DOMDocument * p_oParFileDoc; //DOM of par file
+
+  mp_oXMLParser->parse(m_sParFilename.c_str());
+  p_oParFileDoc = mp_oXMLParser->getDocument();
+
+  //Rename the output files in the DOM so runs don't overwrite each other
+  RenameBatchOutput( p_oParFileDoc, "ou_filename", TARBALL_FILE_EXT, iRun );
+  RenameBatchOutput( p_oParFileDoc, "so_filename", SHORT_OUTPUT_FILE_EXT, iRun );
+
+  ReadParameterFile( p_oParFileDoc, GetFileType(m_sParFilename) );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// RenameBatchOutput()
+/////////////////////////////////////////////////////////////////////////////
+void clSimManager::RenameBatchOutput(DOMDocument *p_oDoc, const char *cTag,
+    const std::string &sExtension, int iRun) {
+  DOMNodeList * p_oNodeList;
+  DOMNode * p_oFilenameNode;
+  stringstream strNewFileName; //for assembling the new output filename
+  std::string sFileName;
+
+  p_oNodeList = p_oDoc->getElementsByTagName( XMLString::transcode( cTag ) );
+  if ( 0 == p_oNodeList->getLength() ) return;
+  p_oFilenameNode = p_oNodeList->item( 0 )->getFirstChild();
+  sFileName = XMLString::transcode( p_oFilenameNode->getNodeValue() );
+  if ( "" == sFileName ) return;
+
+  //trim off the file extension, if it exists
+  sFileName = sFileName.substr( 0, sFileName.find( sExtension ) );
+  strNewFileName << sFileName << "_" << iRun;
+  p_oFilenameNode->setNodeValue( XMLString::transcode( strNewFileName.str().c_str() ) );
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// ReportBatchSummary()
+/////////////////////////////////////////////////////////////////////////////
+void clSimManager::ReportBatchSummary(int iNumRuns, int iNumFailed,
+    std::string sFailedRuns, time_t iBatchStart) {
+  long iRunTime = (long)difftime( time( NULL ), iBatchStart );
+  int iHrs, iMin;
+
+  iHrs = (int)( iRunTime / 3600 );
+  iRunTime -= iHrs * 3600;
+  iMin = (int)( iRunTime / 60 );
+  iRunTime -= iMin * 60;
+
+  cout << "\nBatch finished: " << iNumRuns << " runs, "
+       << ( iNumRuns - iNumFailed ) << " completed, " << iNumFailed
+       << " did not. Elapsed time: " << iHrs << ":" << iMin << ":" << iRunTime
+       << "\n";
+  if ( iNumFailed > 0 )
+    cout << "Runs that did not complete:" << sFailedRuns << "\n";
+  cout << flush;
+}
+
 
 /////////////////////////////////////////////////////////////////////////////
 // CreateGrid()
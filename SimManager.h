@@ -9,6 +9,7 @@
 #include "Constants.h"
 #include "DataTypes.h"
 
+#include <time.h>
 #include <xercesc/dom/DOM.hpp>
 #include <xercesc/parsers/XercesDOMParser.hpp>
 
@@ -24,6 +25,7 @@ class clGrid;
 class clPopulationBase;
 class clWorkerBase;
 class clModelMath;
+class clTaskPool;
 
 /**
 * SIMULATION MANAGER - Version 1.0
@@ -52,6 +54,17 @@ class clModelMath;
 * <br>Edit history:
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
+* <br>October 17, 2026 - Behaviors now run in levels built from their resource
+* declarations; behaviors in the same level can run at the same time, and
+* populations only do their data updates after a level that changed tree
+* structure (agent)
+* <br>October 17, 2026 - Batch runs can be done by several worker processes at
+* once; each batch run gets its own random seed (agent)
+* <br>October 17, 2026 - Added the task pool, with its number of threads from
+* the parameter file or the command line (agent)
+* <br>October 17, 2026 - Added GetBatchGroup() and GetBatchFilename() (agent)
+* <br>October 17, 2026 - Batch workers default to their share of the
+* processors for threads (agent)
 */
 class clSimManager {
   friend class clTestSimManager; /**<For automated testing*/
@@ -108,6 +121,18 @@ class clSimManager {
   clPlot *mp_oPlot; /**<The plot object.  This does not have its own object
         manager - it remains in the purview of the simulation manager.*/
 
+  clTaskPool *mp_oTaskPool; /**<Task pool for running loops on several
+        threads.  This lasts as long as the simulation manager.*/
+
+  /**Number of threads given on the command line, which overrides the
+   * parameter file; -1 if none was given.*/
+  int m_iCommandLineThreads;
+
+  /**Number of threads to use when neither the command line nor the parameter
+   * file gives one; 0 means one per processor. Batch workers set this so that
+   * together they don't ask for more threads than there are processors.*/
+  int m_iDefaultThreads;
+
   /**File path and name of the parameter file.*/
   std::string m_sParFilename;
   /**File path and name of the parameter file, if using.*/
@@ -119,11 +144,163 @@ class clSimManager {
   //XML tools
   xercesc::XercesDOMParser *mp_oXMLParser; /**<Xerces file parser.*/
 
+  /**Behaviors in the order they run this timestep, grouped by level. Array
+   * size is m_iScheduleSize.*/
+  clBehaviorBase **mp_oSchedule;
+
+  /**Where each level starts in mp_oSchedule. Level i runs from
+   * mp_iLevelStart[i] up to, but not including, mp_iLevelStart[i + 1]. Array
+   * size is m_iScheduleSize + 1.*/
+  int *mp_iLevelStart;
+
+  /**Level of each behavior, in behavior list order. Array size is
+   * m_iScheduleSize.*/
+  int *mp_iBehaviorLevel;
+
+  /**Size of the schedule arrays.*/
+  int m_iScheduleSize;
+
+  /**
+  * Sorts the behaviors into levels for this timestep. A behavior goes in the
+  * level after the highest level of any behavior before it in the list that it
+  * conflicts with, so behaviors in the same level never conflict and each
+  * behavior still runs after every earlier behavior whose data it depends on.
+  * Behaviors that make no resource declarations conflict with everything, so a
+  * list of such behaviors gets one level per behavior, in list order. The
+  * levels are rebuilt every timestep so behaviors can change their
+  * declarations, for instance to declare nothing on a timestep they skip.
+  * @return Number of levels.
+  */
+  int ScheduleBehaviors();
+
+  /**
+  * Decides whether two behaviors can't run at the same time. They conflict if
+  * either writes what the other reads or writes. A behavior's own tree data and
+  * own grids don't conflict with another behavior's own, but do conflict with
+  * anyone using tree data or grids in general. Copies of the same behavior
+  * share their data members and grids, so for them "own" counts as general.
+  * @param p_oFirst First behavior.
+  * @param p_oSecond Second behavior.
+  * @return Whether the behaviors conflict.
+  */
+  bool BehaviorsConflict(clBehaviorBase *p_oFirst, clBehaviorBase *p_oSecond);
+
+  /**
+  * Decides whether two sets of resource bits from different behaviors touch
+  * the same data. Own tree data and own grids only meet their general
+  * counterparts.
+  * @param iFirst First set of resource bits.
+  * @param iSecond Second set of resource bits.
+  * @return Whether the sets overlap.
+  */
+  bool ResourcesOverlap(int iFirst, int iSecond);
+
+  /**
+  * Adds the general tree data and grid bits to a set of resource bits that
+  * includes own tree data or own grids, so that copies of the same behavior
+  * are seen to share them.
+  * @param iResources Resource bits.
+  * @return Resource bits with the general bits added.
+  */
+  int ShareOwnResources(int iResources);
+
+  /**
+  * Calls Action() for behaviors in mp_oSchedule. This is handed to
+  * clTaskPool::ParallelFor().
+  */
+  struct stcRunBehavior {
+    clBehaviorBase **p_oSchedule; /**<Behaviors to run*/
+    /**
+    * Runs one behavior.
+    * @param i Behavior's index in p_oSchedule.
+    */
+    void operator()(int i);
+  };
+
+  /**
+  * Runs the behaviors in one level. If there is more than one and more than
+  * one thread is available, they run at the same time through the task pool;
+  * an error thrown by any of them is held until all are done, and the one
+  * from the behavior earliest in the list is thrown.
+  * @param iLevel Level to run.
+  * @return Whether any behavior in the level declared that it changes tree
+  * structure, meaning the populations need their data updates.
+  */
+  bool RunBehaviorLevel(int iLevel);
+
+  /**Batch run parameter file name and number of times to run it*/
+  struct stcParFiles
+  {
+    std::string sParFileName; /**<Parameter file*/
+    short int iNumRuns; /**<Number of times to run it*/
+  };
+
   /**
   * Triggers the timestep cleanup functions of each of the object managers.
   */
   void TimestepCleanup();
 
+  /**
+  * Does the runs of a batch in worker processes, keeping up to the requested
+  * number going at once. Each run's outcome is reported as its worker finishes.
+  * If a user quits or pauses a run, no new runs are started.
+  * @param p_parFileList Parameter files to run.
+  * @param iNumBatchGroups Number of parameter files.
+  * @param iNumWorkers Maximum number of runs at once.
+  */
+  void RunBatchWithWorkers(stcParFiles *p_parFileList, int iNumBatchGroups,
+      int iNumWorkers);
+
+  /**
+  * Does one batch run inside a worker process. Errors are reported through
+  * the interface, not thrown.
+  * @param stcParFile Parameter file to run.
+  * @param iGroup Index of the parameter file in the batch.
+  * @param iRun Index of the run for that parameter file.
+  * @return Worker exit status: 0 if the run completed, 1 if there was an
+  * error, and 2 if a user quit or paused.
+  */
+  int DoWorkerRun(stcParFiles &stcParFile, int iGroup, int iRun);
+
+  /**
+  * Parses m_sParFilename, renames its output files for one batch run, and reads
+  * it in. The output file names get "_" and the run number added before the
+  * extension.
+  * @param iRun Run number, starting at 1.
+  */
+  void LoadBatchRun(int iRun);
+
+  /**
+  * Adds a batch run number to an output file name in a parsed parameter file.
+  * Nothing happens if there is no such file name.
+  * @param p_oDoc Parsed parameter file.
+  * @param cTag Tag holding the file name.
+  * @param sExtension File extension to trim off before the number is added.
+  * @param iRun Run number.
+  */
+  void RenameBatchOutput(xercesc::DOMDocument *p_oDoc, const char *cTag,
+      const std::string &sExtension, int iRun);
+
+  /**
+  * Writes the summary at the end of a batch.
+  * @param iNumRuns Number of runs started.
+  * @param iNumFailed Number of runs that didn't complete.
+  * @param sFailedRuns List of the runs that didn't complete.
+  * @param iBatchStart Time the batch started.
+  */
+  void ReportBatchSummary(int iNumRuns, int iNumFailed, std::string sFailedRuns,
+      time_t iBatchStart);
+
+  /**
+  * Works out the random seed for one run of a batch, so that the runs differ
+  * even if they share a fixed seed or start in the same second. The first run
+  * keeps the seed it was given.
+  * @param lSeed Seed from the parameter file, or from the clock.
+  * @param iRun Run number, starting at 1.
+  * @return Seed for the run. This is always negative.
+  */
+  long DeriveRunSeed(long lSeed, int iRun);
+
   /**
   * Performs any cleanup necessary at the end of a run and triggers the
   * end-of-run cleanup functions of each of the object managers.
@@ -214,6 +391,19 @@ class clSimManager {
   */
   int GetBatchNumber() {return m_iBatchNumber;};
 
+  /**
+  * Returns the parameter file group of the current run within its batch.
+  * @return Parameter file group, or 0 if not in a batch run.
+  */
+  int GetBatchGroup() {return m_iBatchGroup;};
+
+  /**
+  * Returns the batch file path and name.
+  * @return Batch file path and name, or an empty string if there hasn't been
+  * a batch.
+  */
+  std::string GetBatchFilename() {return m_sBatchFilename;};
+
   /**
   * Enum for simulation states.
   */
@@ -447,12 +637,45 @@ class clSimManager {
   */
   clPlot* GetPlotObject() {return mp_oPlot;};
 
+  /**
+  * Returns the task pool, for running loops on several threads.
+  *
+  * @return The task pool.
+  */
+  clTaskPool* GetTaskPool() {return mp_oTaskPool;};
+
+  /**
+  * Sets the number of threads from the command line. This overrides the
+  * "numThreads" value in parameter files read from now on, and takes effect
+  * right away.
+  * @param iNumThreads Number of threads; 0 means one per processor.
+  * @throw modelErr if iNumThreads is negative.
+  */
+  void SetCommandLineThreads(int iNumThreads);
+
   /**
   * Executes a batch run as specified in a batch file.
   *
+  * If more than one worker is used, the runs are handed out to worker
+  * processes, each a copy of this one, and that many run at the same time.
+  * Each run still gets its own output file names and random seed, exactly as
+  * it would in a one-worker batch, so results do not depend on the number of
+  * workers. Progress is reported as each run finishes. A batch that was
+  * paused partway through always picks up in this process. Workers are only
+  * available on Linux; elsewhere the runs are done one at a time. A worker
+  * whose run doesn't set the number of threads, on the command line or in
+  * the parameter file, gets the number of processors divided by the number
+  * of workers, and at least one.
+  *
+  * Either way, a summary is written at the end of the batch with the number of
+  * runs that did and didn't complete, and the elapsed time.
+  *
   * @param sBatchFile File path and name to the batch file to execute.
+  * @param iNumWorkers Number of runs to do at once. Zero means one per
+  * processor. If this is less than zero, the value of ba_numWorkers in the
+  * batch file is used, if present; otherwise, one.
   */
-  void RunBatch(std::string sBatchFile);
+  void RunBatch(std::string sBatchFile, int iNumWorkers = -1);
 
   /**
   * Creates a new grid object.  This function merely passes along the request
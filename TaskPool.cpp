@@ -0,0 +1,90 @@
+//---------------------------------------------------------------------------
+#include "TaskPool.h"
+#include "PlatformFuncs.h"
+#include <sstream>
+//---------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////
+// Constructor
+////////////////////////////////////////////////////////////////////////////
+clTaskPool::clTaskPool() {
+#ifdef _OPENMP
+  m_iNumThreads = omp_get_max_threads();
+#else
+  m_iNumThreads = 1;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////
+// SetNumThreads()
+////////////////////////////////////////////////////////////////////////////
+void clTaskPool::SetNumThreads(int iNumThreads) {
+  if (iNumThreads < 0) {
+    modelErr stcErr;
+    stcErr.iErrorCode = BAD_DATA;
+    stcErr.sFunction = "clTaskPool::SetNumThreads";
+    std::stringstream s;
+    s << "Number of threads cannot be negative. Value: " << iNumThreads;
+    stcErr.sMoreInfo = s.str();
+    throw(stcErr);
+  }
+  if (0 == iNumThreads) iNumThreads = GetNumProcessors();
+  if (iNumThreads < 1) iNumThreads = 1;
+
+#ifdef _OPENMP
+  omp_set_num_threads(iNumThreads);
+  m_iNumThreads = iNumThreads;
+#else
+  m_iNumThreads = 1;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////
+// RunInParallel()
+////////////////////////////////////////////////////////////////////////////
+bool clTaskPool::RunInParallel(int iCount, int iGrain) {
+#ifdef _OPENMP
+  return m_iNumThreads > 1 && iCount > iGrain && !omp_in_parallel();
+#else
+  return false;
+#endif
+}
+
+////////////////////////////////////////////////////////////////////////////
+// KeepError()
+////////////////////////////////////////////////////////////////////////////
+void clTaskPool::KeepError(stcTaskErrors *p_stcErrors, int iIndex,
+    const modelErr &stcErr) {
+#ifdef _OPENMP
+#pragma omp critical (taskPoolError)
+#endif
+  if (iIndex < p_stcErrors->iFirst) {
+    p_stcErrors->iFirst = iIndex;
+    p_stcErrors->stcErr = stcErr;
+    p_stcErrors->bIsMsg = false;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// KeepMessage()
+////////////////////////////////////////////////////////////////////////////
+void clTaskPool::KeepMessage(stcTaskErrors *p_stcErrors, int iIndex,
+    const modelMsg &stcMsg) {
+#ifdef _OPENMP
+#pragma omp critical (taskPoolError)
+#endif
+  if (iIndex < p_stcErrors->iFirst) {
+    p_stcErrors->iFirst = iIndex;
+    p_stcErrors->stcMsg = stcMsg;
+    p_stcErrors->bIsMsg = true;
+  }
+}
+
+////////////////////////////////////////////////////////////////////////////
+// ThrowFirstError()
+////////////////////////////////////////////////////////////////////////////
+void clTaskPool::ThrowFirstError(stcTaskErrors *p_stcErrors, int iNone) {
+  if (p_stcErrors->iFirst == iNone) return;
+  if (p_stcErrors->bIsMsg) throw(p_stcErrors->stcMsg);
+  throw(p_stcErrors->stcErr);
+}
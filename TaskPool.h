@@ -0,0 +1,330 @@
+//---------------------------------------------------------------------------
+
+#ifndef TaskPoolH
+#define TaskPoolH
+//---------------------------------------------------------------------------
+#include "Messages.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/**
+* Task Pool Class - Version 1.0
+* This class runs loops on several threads for the core model and behaviors.
+* There is one, owned by clSimManager; behaviors get it with
+* clSimManager::GetTaskPool().
+*
+* The pool sits on top of OpenMP. A loop's range is split in half, over and
+* over, into tasks no bigger than the grain size. Threads take tasks from
+* their own queues and steal from each other's when they run out, so uneven
+* work evens itself out. If SORTIE was compiled without OpenMP, if the pool
+* has one thread, or if a loop is started from a thread that is already
+* running in parallel, the loop runs serially in the calling thread.
+*
+* The number of threads is set with SetNumThreads(), which also sets it for
+* any other OpenMP code in the model. clSimManager sets it from the
+* "numThreads" value in the parameter file, or from the command line.
+*
+* A loop body is a function object. It may be called from several threads at
+* once, so it must only write to things that belong to the index it was
+* given (or to a per-thread buffer picked with GetThreadNumber()). If a body
+* throws a modelErr or modelMsg, the loop finishes and then throws the one
+* from the lowest index, the same one a serial loop would have thrown first.
+*
+* ParallelReduce() combines partial results in a fixed order that depends
+* only on the range and the grain size. Its result is the same no matter how
+* many threads there are, including for floating-point sums.
+*
+* Copyright 2026 agent.
+* @author agent
+*
+* <br>Edit history:
+* <br>-----------------
+* <br>October 17, 2026 - Created (agent)
+*/
+class clTaskPool {
+
+  public:
+
+  /**
+  * Constructor. The number of threads starts at the OpenMP default.
+  */
+  clTaskPool();
+
+  /**
+  * Sets the number of threads for the pool and for other OpenMP code.
+  * @param iNumThreads Number of threads. 0 means one per processor.
+  * @throw modelErr if iNumThreads is negative.
+  */
+  void SetNumThreads(int iNumThreads);
+
+  /**
+  * Gets the number of threads.
+  * @return Number of threads; always 1 if compiled without OpenMP.
+  */
+  int GetNumThreads() {return m_iNumThreads;};
+
+  /**
+  * Gets the number of the calling thread, from 0 to GetNumThreads() - 1.
+  * Use this to pick a per-thread buffer inside a loop body.
+  * @return Thread number.
+  */
+  static int GetThreadNumber() {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+  };
+
+  /**
+  * Gets whether the caller is running inside a parallel loop.
+  * @return Whether other threads may be running the same loop.
+  */
+  static bool InParallel() {
+#ifdef _OPENMP
+    return 0 != omp_in_parallel();
+#else
+    return false;
+#endif
+  };
+
+  /**
+  * Calls fn(i) once for each i from iFirst up to, but not including, iLast.
+  * @param iFirst First index.
+  * @param iLast One past the last index.
+  * @param fn Function object to call.
+  * @param iGrain Smallest number of indexes to hand to a thread at once.
+  * Bigger is less overhead, smaller is better balance.
+  * @throw The first modelErr or modelMsg (by index) thrown by fn.
+  */
+  template <class Body>
+  void ParallelFor(int iFirst, int iLast, Body &fn, int iGrain = 1) {
+    stcTaskErrors stcErrors;
+    if (iGrain < 1) iGrain = 1;
+    if (!RunInParallel(iLast - iFirst, iGrain)) {
+      for (int i = iFirst; i < iLast; i++) fn(i);
+      return;
+    }
+    stcErrors.iFirst = iLast;
+#ifdef _OPENMP
+#pragma omp parallel
+#pragma omp single
+#endif
+    ForRange(iFirst, iLast, &fn, iGrain, &stcErrors);
+    ThrowFirstError(&stcErrors, iLast);
+  };
+
+  /**
+  * Calls fn(iX, iY) once for each cell of a grid.
+  * @param iNumXCells Number of cells in the X direction.
+  * @param iNumYCells Number of cells in the Y direction.
+  * @param fn Function object to call.
+  * @param iGrain Smallest number of cells to hand to a thread at once.
+  * @throw The first modelErr or modelMsg (in X-major cell order) thrown by
+  * fn.
+  */
+  template <class Body>
+  void ParallelForCells(int iNumXCells, int iNumYCells, Body &fn,
+      int iGrain = 1) {
+    stcCellBody<Body> stcCells;
+    stcCells.p_fn = &fn;
+    stcCells.iNumYCells = iNumYCells;
+    ParallelFor(0, iNumXCells * iNumYCells, stcCells, iGrain);
+  };
+
+  /**
+  * Reduces a range of indexes to one value. Each piece of the range gets a
+  * copy of tIdentity and calls fn(i, tPartial) for each of its indexes; the
+  * pieces are then joined with combine(tLeft, tRight), which must fold
+  * tRight into tLeft.
+  * @param iFirst First index.
+  * @param iLast One past the last index.
+  * @param tIdentity Starting value for each piece, such as 0 for a sum.
+  * @param fn Function object to call for each index.
+  * @param combine Function object that joins two pieces.
+  * @param iGrain Smallest piece of the range. This, and not the number of
+  * threads, decides how the pieces are joined.
+  * @return Reduced value. tIdentity if the range is empty.
+  * @throw The first modelErr or modelMsg (by index) thrown by fn.
+  */
+  template <class T, class Body, class Combine>
+  T ParallelReduce(int iFirst, int iLast, const T &tIdentity, Body &fn,
+      Combine &combine, int iGrain = 256) {
+    stcTaskErrors stcErrors;
+    T tResult = tIdentity;
+    if (iGrain < 1) iGrain = 1;
+    if (!RunInParallel(iLast - iFirst, iGrain)) {
+      ReduceRange(iFirst, iLast, &tIdentity, &fn, &combine, iGrain, &tResult,
+          (stcTaskErrors*)NULL);
+      return tResult;
+    }
+    stcErrors.iFirst = iLast;
+#ifdef _OPENMP
+#pragma omp parallel
+#pragma omp single
+#endif
+    ReduceRange(iFirst, iLast, &tIdentity, &fn, &combine, iGrain, &tResult,
+        &stcErrors);
+    ThrowFirstError(&stcErrors, iLast);
+    return tResult;
+  };
+
+  protected:
+
+  /**
+  * The first error thrown in a parallel loop.
+  */
+  struct stcTaskErrors {
+    modelErr stcErr; /**<First error, if it was a modelErr*/
+    modelMsg stcMsg; /**<First error, if it was a modelMsg*/
+    int iFirst; /**<Index that threw the first error*/
+    bool bIsMsg; /**<Whether the first error was a modelMsg*/
+    stcTaskErrors() {iFirst = 0; bIsMsg = false;};
+  };
+
+  /**
+  * Turns a grid cell loop body into an index loop body.
+  */
+  template <class Body>
+  struct stcCellBody {
+    Body *p_fn; /**<Cell loop body*/
+    int iNumYCells; /**<Number of cells in the Y direction*/
+    /**
+    * Calls the cell loop body for one cell.
+    * @param i Cell number, X-major.
+    */
+    void operator()(int i) {(*p_fn)(i / iNumYCells, i % iNumYCells);};
+  };
+
+  /**Number of threads*/
+  int m_iNumThreads;
+
+  /**
+  * Decides whether a loop can be split among threads.
+  * @param iCount Number of indexes in the loop.
+  * @param iGrain Grain size.
+  * @return Whether to run in parallel.
+  */
+  bool RunInParallel(int iCount, int iGrain);
+
+  /**
+  * Keeps an error if it came from a lower index than any so far.
+  * @param p_stcErrors Errors so far.
+  * @param iIndex Index that threw.
+  * @param stcErr Error thrown.
+  */
+  static void KeepError(stcTaskErrors *p_stcErrors, int iIndex,
+      const modelErr &stcErr);
+
+  /**
+  * Keeps a message if it came from a lower index than any error so far.
+  * @param p_stcErrors Errors so far.
+  * @param iIndex Index that threw.
+  * @param stcMsg Message thrown.
+  */
+  static void KeepMessage(stcTaskErrors *p_stcErrors, int iIndex,
+      const modelMsg &stcMsg);
+
+  /**
+  * Throws the kept error, if there is one.
+  * @param p_stcErrors Errors from a loop.
+  * @param iNone Value of iFirst that means there was no error.
+  */
+  static void ThrowFirstError(stcTaskErrors *p_stcErrors, int iNone);
+
+  /**
+  * Runs part of a ParallelFor(). The upper half of the range is handed off
+  * as a task until what's left is no bigger than the grain, which is run
+  * here.
+  * @param iFirst First index.
+  * @param iLast One past the last index.
+  * @param p_fn Loop body.
+  * @param iGrain Grain size.
+  * @param p_stcErrors Where to keep errors.
+  */
+  template <class Body>
+  void ForRange(int iFirst, int iLast, Body *p_fn, int iGrain,
+      stcTaskErrors *p_stcErrors) {
+    int iMid, i;
+    while (iLast - iFirst > iGrain) {
+      iMid = iFirst + (iLast - iFirst) / 2;
+#ifdef _OPENMP
+#pragma omp task firstprivate(iMid, iLast, p_fn, iGrain, p_stcErrors)
+#endif
+      ForRange(iMid, iLast, p_fn, iGrain, p_stcErrors);
+      iLast = iMid;
+    }
+    for (i = iFirst; i < iLast; i++) {
+      try {
+        (*p_fn)(i);
+      }
+      catch (modelErr &err) {KeepError(p_stcErrors, i, err);}
+      catch (modelMsg &msg) {KeepMessage(p_stcErrors, i, msg);}
+      catch (...) {
+        modelErr stcErr;
+        stcErr.iErrorCode = UNKNOWN;
+        stcErr.sFunction = "clTaskPool::ParallelFor";
+        KeepError(p_stcErrors, i, stcErr);
+      }
+    }
+  };
+
+  /**
+  * Runs part of a ParallelReduce(). A range bigger than the grain is split in
+  * half; the upper half is a task, and its result is combined into the lower
+  * half's when both are done.
+  * @param iFirst First index.
+  * @param iLast One past the last index.
+  * @param p_tIdentity Starting value for each piece.
+  * @param p_fn Loop body.
+  * @param p_combine Joins two pieces.
+  * @param iGrain Grain size.
+  * @param p_tResult Where to put this part's result. Must start out as the
+  * identity.
+  * @param p_stcErrors Where to keep errors, or NULL to let them be thrown.
+  */
+  template <class T, class Body, class Combine>
+  void ReduceRange(int iFirst, int iLast, const T *p_tIdentity, Body *p_fn,
+      Combine *p_combine, int iGrain, T *p_tResult,
+      stcTaskErrors *p_stcErrors) {
+    int iMid, i;
+    if (iLast - iFirst > iGrain) {
+      T tUpper = *p_tIdentity;
+      T *p_tUpper = &tUpper;
+      iMid = iFirst + (iLast - iFirst) / 2;
+#ifdef _OPENMP
+#pragma omp task firstprivate(iMid, iLast, p_tIdentity, p_fn, p_combine, \
+    iGrain, p_tUpper, p_stcErrors)
+#endif
+      ReduceRange(iMid, iLast, p_tIdentity, p_fn, p_combine, iGrain, p_tUpper,
+          p_stcErrors);
+      ReduceRange(iFirst, iMid, p_tIdentity, p_fn, p_combine, iGrain,
+          p_tResult, p_stcErrors);
+#ifdef _OPENMP
+#pragma omp taskwait
+#endif
+      (*p_combine)(*p_tResult, tUpper);
+      return;
+    }
+    if (NULL == p_stcErrors) {
+      for (i = iFirst; i < iLast; i++) (*p_fn)(i, *p_tResult);
+      return;
+    }
+    for (i = iFirst; i < iLast; i++) {
+      try {
+        (*p_fn)(i, *p_tResult);
+      }
+      catch (modelErr &err) {KeepError(p_stcErrors, i, err);}
+      catch (modelMsg &msg) {KeepMessage(p_stcErrors, i, msg);}
+      catch (...) {
+        modelErr stcErr;
+        stcErr.iErrorCode = UNKNOWN;
+        stcErr.sFunction = "clTaskPool::ParallelReduce";
+        KeepError(p_stcErrors, i, stcErr);
+      }
+    }
+  };
+};
+//---------------------------------------------------------------------------
+#endif
@@ -12,90 +12,20 @@ using namespace std;
 ////////////////////////////////////////////////////////////////////////////
 // Constructor
 ///////////////////////////////////////////////////////////////////////////*/
-clTree::clTree(int iType, int iSpecies, int iNumFloats, int iNumInts,
-    int iNumStrings, int iNumBools, clTreePopulation *p_oTreePop) {
-  try {
-    int i;
-
-    //mp_oTreePop is static - it may already be initialized
-    if (NULL == mp_oTreePop) mp_oTreePop = p_oTreePop;
-
-    mp_oPrevious = NULL;
-    mp_oNext = NULL;
-
-    //Verify that type and species is okay
-    if (iType<clTreePopulation::seed || iType>clTreePopulation::woody_debris) {
-      modelErr stcErr;
-      stcErr.iErrorCode = BAD_DATA;
-      stcErr.sFunction = "clTree::clTree";
-      std::stringstream s;
-      s << "Unrecognized tree type:  " << iType;
-      stcErr.sMoreInfo = s.str();
-      throw(stcErr);
-    }
-    if (iSpecies < 0 || iSpecies >= mp_oTreePop->m_iNumSpecies) {
-      modelErr stcErr;
-      stcErr.iErrorCode = BAD_DATA;
-      stcErr.sFunction = "clTree::clTree";
-      std::stringstream s;
-      s << "Unrecognized tree type:  " << iType;
-      stcErr.sMoreInfo = s.str();
-      throw(stcErr);
-    }
-    if (iNumFloats < 0 || iNumInts < 0 || iNumStrings < 0 || iNumBools < 0) {
-      modelErr stcErr;
-      stcErr.iErrorCode = BAD_DATA;
-      stcErr.sFunction = "clTree::clTree";
-      stcErr.sMoreInfo = "Data member numbers cannot be less than zero.";
-      throw(stcErr);
-    }
-
-    m_iSpecies = iSpecies;
-    m_iType = iType;
-
-    //Null out the pointers
-    mp_fFloatValues = NULL;
-    mp_iIntValues = NULL;
-    mp_sStringValues = NULL;
-    mp_bBoolValues = NULL;
-
-    if (iNumFloats > 0) {
-      mp_fFloatValues = new float[iNumFloats];
-      for (i = 0; i < iNumFloats; i++)
-        mp_fFloatValues[i] = 0;
-    }
-    if (iNumInts > 0) {
-      mp_iIntValues = new int[iNumInts];
-      for (i = 0; i < iNumInts; i++)
-        mp_iIntValues[i] = 0;
-    }
-    if (iNumStrings > 0) {
-      mp_sStringValues = new string[iNumStrings];
-    }
-    if (iNumBools > 0) {
-      mp_bBoolValues = new bool[iNumBools];
-      for (i = 0; i < iNumBools; i++)
-        mp_bBoolValues[i] = false;
-    }
-  }
-  catch (modelErr&err) {throw(err);}
-  catch (modelMsg &msg) {throw(msg);} //non-fatal error
-  catch (...) {
-    modelErr stcErr;    stcErr.iErrorCode = UNKNOWN;
-    stcErr.sFunction = "clTree::clTree";
-    throw(stcErr);
-  }
+clTree::clTree() {
+  m_iSpecies = 0;
+  m_iType = 0;
+  m_iSlot = -1;
+  mp_sStringValues = NULL;
+  mp_oPrevious = NULL;
+  mp_oNext = NULL;
 }
 
 ////////////////////////////////////////////////////////////////////////////
 // Destructor
 ////////////////////////////////////////////////////////////////////////////
 clTree::~clTree() {
-  //Delete all arrays
-  delete[] mp_fFloatValues;
-  delete[] mp_iIntValues;
   delete[] mp_sStringValues;
-  delete[] mp_bBoolValues;
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -138,21 +68,21 @@ void clTree::GetValue(short int iCode, int *p_iValHolder) {
     stcErr.sMoreInfo = "Bad tree int data code.";
     throw(stcErr);
   }
-  *p_iValHolder = mp_iIntValues[iCode];
+  *p_iValHolder = mp_oTreePop->mp_iIntColumns[m_iSpecies][m_iType][iCode][m_iSlot];
 }
 
 ////////////////////////////////////////////////////////////////////////////
 // GetValue
 ///////////////////////////////////////////////////////////////////////////*/
 void clTree::GetValue(short int iCode, float *p_fValHolder) {
-  *p_fValHolder = mp_fFloatValues[iCode];
+  *p_fValHolder = mp_oTreePop->mp_fFloatColumns[m_iSpecies][m_iType][iCode][m_iSlot];
 }
 
 ////////////////////////////////////////////////////////////////////////////
 // GetValue
 ///////////////////////////////////////////////////////////////////////////*/
 void clTree::GetValue(short int iCode, bool *p_bValHolder) {
-  *p_bValHolder = mp_bBoolValues[iCode];
+  *p_bValHolder = mp_oTreePop->mp_bBoolColumns[m_iSpecies][m_iType][iCode][m_iSlot];
 }
 
 ////////////////////////////////////////////////////////////////////////////
@@ -166,25 +96,35 @@ void clTree::GetValue(short int iCode, string *p_sValHolder) {
 ////////////////////////////////////////////////////////////////////////////
 // MakeDeadClone
 ////////////////////////////////////////////////////////////////////////////
-clDeadTree* clTree::MakeDeadClone() {
-  clDeadTree *p_oClone = new clDeadTree(m_iType, m_iSpecies,
+clDeadTree* clTree::MakeDeadClone(clDeadTree *p_oClone) {
+  int i;
+
+  if (NULL == p_oClone) {
+    p_oClone = new clDeadTree(m_iType, m_iSpecies,
       mp_oTreePop->mp_iNumTreeFloatVals[m_iSpecies] [m_iType],
       mp_oTreePop->mp_iNumTreeIntVals[m_iSpecies] [m_iType],
       mp_oTreePop->mp_iNumTreeStringVals[m_iSpecies] [m_iType],
       mp_oTreePop->mp_iNumTreeBoolVals[m_iSpecies] [m_iType]);
-
-  int i;
+  } else {
+    p_oClone->m_iSpecies = m_iSpecies;
+    p_oClone->m_iType = m_iType;
+    p_oClone->m_iDeadCode = notdead;
+    p_oClone->mp_oNext = NULL;
+  }
 
   for (i = 0; i < mp_oTreePop->mp_iNumTreeFloatVals[m_iSpecies][m_iType]; i++) {
-    p_oClone->mp_fFloatValues[i] = mp_fFloatValues[i];
+    p_oClone->mp_fFloatValues[i] =
+        mp_oTreePop->mp_fFloatColumns[m_iSpecies][m_iType][i][m_iSlot];
   }
 
   for (i = 0; i < mp_oTreePop->mp_iNumTreeIntVals[m_iSpecies][m_iType]; i++) {
-    p_oClone->mp_iIntValues[i] = mp_iIntValues[i];
+    p_oClone->mp_iIntValues[i] =
+        mp_oTreePop->mp_iIntColumns[m_iSpecies][m_iType][i][m_iSlot];
   }
 
   for (i = 0; i < mp_oTreePop->mp_iNumTreeBoolVals[m_iSpecies][m_iType]; i++) {
-    p_oClone->mp_bBoolValues[i] = mp_bBoolValues[i];
+    p_oClone->mp_bBoolValues[i] =
+        mp_oTreePop->mp_bBoolColumns[m_iSpecies][m_iType][i][m_iSlot];
   }
 
   for (i = 0; i < mp_oTreePop->mp_iNumTreeStringVals[m_iSpecies][m_iType]; i++) {
@@ -19,6 +19,11 @@ class clDeadTree;
 * ahead of time.  Species and type are, because these must be known to locate
 * other values.
 *
+* A tree does not own its float, int, and bool values. These live in columnar
+* storage in the tree population, one contiguous array per data member per
+* species/type; the tree only holds its slot index into those columns. String
+* values are rare enough that they are still kept in a per-tree array.
+*
 * Trees can't be created or destroyed except by the tree population.
 *
 * Copyright 2003 Charles D. Canham.
@@ -28,6 +33,10 @@ class clDeadTree;
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
 * <br>November 12, 2012 - Chars became strings (LEM)
+* <br>October 17, 2026 - Float, int, and bool values moved to columnar storage
+* in the tree population (agent)
+* <br>October 17, 2026 - Trees are pooled by the tree population instead of
+* being created and deleted one at a time (agent)
 */
 class clTree {
   friend class clTreePopulation;
@@ -151,41 +160,31 @@ class clTree {
 
   /**
    * Makes a dead clone of this tree.
+   * @param p_oClone Dead tree into which to copy this tree's values. It must
+   * have arrays sized for this tree's species and type. If NULL, a new dead
+   * tree is created.
    * @return Clone.
    */
-  clDeadTree* MakeDeadClone();
+  clDeadTree* MakeDeadClone(clDeadTree *p_oClone = NULL);
 
   protected:
  /**
-  * Constructor.  Arrays are sized here.  All values will be initialized
-  * to 0, empty string, and false.
-  *
-  * @param iType New tree's type.
-  * @param iSpecies New tree's species.
-  * @param iNumFloats Number of floats this tree will have.
-  * @param iNumInts Number of integers this tree will have.
-  * @param iNumStrings Number of strings this tree will have.
-  * @param iNumBools Number of bools this tree will have.
-  * @param p_oTreePop Tree population object.
-  * @throw BAD_DATA error if a value is less than zero.
+  * Constructor.  Trees are created in slabs by the tree population, which sets
+  * species, type, storage slot, and the string array when it hands a tree
+  * out; this just nulls everything.
   */
-  clTree(int iType, int iSpecies, int iNumFloats, int iNumInts, int iNumStrings,
-    int iNumBools, clTreePopulation *p_oTreePop);
+  clTree();
 
  /**
-  * Destructor.  Deletes arrays.
+  * Destructor.  Deletes the string array.
   */
   ~clTree();
 
   short unsigned int m_iSpecies; /**<Species*/
   short unsigned int m_iType; /**<Type*/
-  //These are the arrays of values that can be registered as part of this class
-  //The char array should be an array of pointers, not actual values - thus the
-  //double pointer
-  float *mp_fFloatValues; /**<Array of float data members*/
-  int *mp_iIntValues; /**<Array of integer data members*/
+  int m_iSlot; /**<Index of this tree's values in the tree population's data
+  member columns for its species and type*/
   std::string *mp_sStringValues; /**<Array of string data members*/
-  bool *mp_bBoolValues; /**<Array of bool data members*/
   static clTreePopulation *mp_oTreePop; /**<Tree population.  Declare as static
   - we don't need a
   bazillion copies of this running around.  This is somewhat dangerous as we
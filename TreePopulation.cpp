@@ -1,4 +1,5 @@
 #include <stddef.h>
+#include <stdlib.h>
 #include <math.h>
 #include <fstream>
 #include <sstream>
@@ -15,6 +16,8 @@
 #include "ParsingFunctions.h"
 #include "PlatformFuncs.h"
 #include "GhostTreePopulation.h"
+#include "TreeQuery.h"
+#include "TreeSnapshot.h"
 
 /////////////////////////////////////////////////////////////////////////////
 // Constructor
@@ -27,7 +30,9 @@ clTreePopulation::clTreePopulation(clSimManager * p_oSimManager) :
     m_sNameString = "treepopulation";
     //         m_iNumHeightDivs = 10;
     m_iSizeHeightDivs = 4;
-    m_iLengthGrids = 8;
+    m_iGridCellSize = 8;
+    m_iLengthGrids = m_iGridCellSize;
+    m_fInvLengthGrids = 1.0 / m_iLengthGrids;
     m_iNumTypes = 7;
 
 
@@ -76,6 +81,40 @@ clTreePopulation::clTreePopulation(clSimManager * p_oSimManager) :
     mp_iCrownDepthCode = NULL;
     mp_iAgeCode = NULL;
     mp_iWhyDeadCode = NULL;
+    mp_fFloatColumns = NULL;
+    mp_iIntColumns = NULL;
+    mp_bBoolColumns = NULL;
+    mp_iColumnCapacity = NULL;
+    mp_iNumColumnSlots = NULL;
+    mp_iFreeSlots = NULL;
+    mp_iNumFreeSlots = NULL;
+    mp_treeSlabs = NULL;
+    mp_oFreeTrees = NULL;
+    m_lNumTreeSlabs = 0;
+    m_lNumTreesAllocated = 0;
+    m_lNumTreesRecycled = 0;
+    m_lNumColumnGrows = 0;
+    m_lNumOpenSearches = 0;
+    m_lSearchEpoch = 0;
+    m_lTreeEpoch = 0;
+    mp_oSnapshot = NULL;
+    mp_lCellChangeEpoch = NULL;
+    mp_fCellSizeChange = NULL;
+    mp_bCrownCellDirty = NULL;
+    m_bCrownsDirty = false;
+    m_fSizeChangeTolerance = 0;
+    m_lNumCellsRepaired = 0;
+    m_lNumCellsBulkSorted = 0;
+    mp_oSortTrees = NULL;
+    mp_fSortHeights = NULL;
+    m_iSortCapacity = 0;
+    m_intHandles.p_sLabels = NULL;
+    m_intHandles.p_iCodes = NULL;
+    m_intHandles.iNumHandles = 0;
+    m_intHandles.iCapacity = 0;
+    m_floatHandles = m_intHandles;
+    m_boolHandles = m_intHandles;
+    m_iDeadHandle = -1;
 
     mp_openSearches = NULL;
     stcOpenSearches * p_dummyRecord;
@@ -120,6 +159,23 @@ clTreePopulation::~clTreePopulation() {
 
   TimestepCleanup();
   EmptyHashTable();
+  DeleteTreePools();
+  DeleteTreeColumns();
+  DeleteDataHandles(m_intHandles);
+  DeleteDataHandles(m_floatHandles);
+  DeleteDataHandles(m_boolHandles);
+  delete[] mp_oSortTrees;
+  mp_oSortTrees = NULL;
+  delete[] mp_fSortHeights;
+  mp_fSortHeights = NULL;
+  delete mp_oSnapshot;
+  mp_oSnapshot = NULL;
+  delete[] mp_lCellChangeEpoch;
+  mp_lCellChangeEpoch = NULL;
+  delete[] mp_fCellSizeChange;
+  mp_fCellSizeChange = NULL;
+  delete[] mp_bCrownCellDirty;
+  mp_bCrownCellDirty = NULL;
 
   //Delete the hash table, if it hasn't been already
   if (mp_oTreeShortest) {
@@ -509,6 +565,38 @@ void clTreePopulation::SetupCalculations() {
 
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// ChooseGridCellSize()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::ChooseGridCellSize(DOMDocument * p_oDoc) {
+  clBehaviorBase * p_oBehavior;
+  float fRadius, fMaxRadius = 0, fMaxLength;
+  int iNumBehaviors, i;
+
+  if (0 == m_iLengthGrids)
+  {
+    iNumBehaviors = mp_oSimManager->GetNumberOfBehaviors();
+    for (i = 0; i < iNumBehaviors; i++)
+    {
+      p_oBehavior = mp_oSimManager->GetBehaviorObject(i);
+      fRadius = p_oBehavior->GetNeighborSearchRadius(p_oDoc);
+      if (fRadius > fMaxRadius) fMaxRadius = fRadius;
+    }
+
+    if (0 == fMaxRadius)
+      m_iLengthGrids = m_iGridCellSize;
+    else
+      m_iLengthGrids = (int)ceil(fMaxRadius / 2);
+
+    fMaxLength = m_fPlotLengthX < m_fPlotLengthY ? m_fPlotLengthX :
+        m_fPlotLengthY;
+    if (m_iLengthGrids > fMaxLength) m_iLengthGrids = (int)fMaxLength;
+    if (m_iLengthGrids < 2) m_iLengthGrids = 2;
+  }
+
+  m_fInvLengthGrids = 1.0 / m_iLengthGrids;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // CreateHashTable()
 //////////////////////////////////////////////////////////////////////////////
@@ -532,6 +620,20 @@ void clTreePopulation::CreateHashTable() {
       }
     }
   }
+
+  //Every cell starts out unchanged
+  delete[] mp_lCellChangeEpoch;
+  delete[] mp_fCellSizeChange;
+  delete[] mp_bCrownCellDirty;
+  mp_lCellChangeEpoch = new unsigned long[m_iNumXCells * m_iNumYCells];
+  mp_fCellSizeChange = new float[m_iNumXCells * m_iNumYCells];
+  mp_bCrownCellDirty = new bool[m_iNumXCells * m_iNumYCells];
+  for (int i = 0; i < m_iNumXCells * m_iNumYCells; i++) {
+    mp_lCellChangeEpoch[i] = 0;
+    mp_fCellSizeChange[i] = 0;
+    mp_bCrownCellDirty[i] = false;
+  }
+  m_bCrownsDirty = false;
 }
 
 
@@ -552,9 +654,12 @@ void clTreePopulation::GetData(DOMDocument * p_oDoc) {
       GetPlotDimensions();
       ReadParameters(p_oDoc);
       SetupCalculations();
+      ChooseGridCellSize(p_oDoc);
       CreateHashTable();
       DoTreeDataStructureSetup();
       DataMemberRegistrations();
+      CreateTreeColumns();
+      CreateTreePools();
     }
     CreateTreesFromInitialDensities(p_oDoc);
     CreateSnagsFromInitialDensities(p_oDoc);
@@ -621,6 +726,18 @@ void clTreePopulation::ReadParameters(DOMDocument * p_oDoc) {
     FillSpeciesSpecificValue(p_oElement, "tr_maxSeedlingHeight", "tr_mshVal", mp_fMaxSeedlingHeight, this, true);
     FillSingleValue(p_oElement, "tr_seedDiam10Cm", & m_fNewSeedlingDiam10, true);
 
+    //Hash table cell size - not required; 0 means choose it automatically
+    m_iLengthGrids = m_iGridCellSize;
+    FillSingleValue(p_oElement, "tr_hashCellSize", & m_iLengthGrids, false);
+    if (m_iLengthGrids < 0)
+    {
+      modelErr stcErr;
+      stcErr.sFunction = "clTreePopulation::ReadParameters" ;
+      stcErr.iErrorCode = BAD_DATA;
+      stcErr.sMoreInfo = "The hash table cell size cannot be negative.";
+      throw(stcErr);
+    }
+
     //Size classes - not required
     //Get number of size classes
     sVal = XMLString::transcode("tr_sizeClasses");
@@ -848,6 +965,10 @@ void clTreePopulation::DoTreeDataStructureSetup() {
       } //end of for (j = 0; j < m_iNumTypes; j++)
     } //end of for (i = 0; i < m_iNumSpecies; i++)
 
+    //Set up the handle for "dead" now, so it will be filled in as mortality
+    //behaviors register it
+    m_iDeadHandle = GetIntDataHandle("dead");
+
     //Register the tree population's values
     for (i = 0; i < m_iNumSpecies; i++) {
       for (j = 0; j < m_iNumTypes; j++)  {
@@ -2525,17 +2646,68 @@ void clTreePopulation::CreateTreesFromTreeMap(DOMDocument * p_oDoc) {
 }
 
 
+//////////////////////////////////////////////////////////////////////////////
+// ParseFindFloat()
+//
+// Reads a number from a Find() argument value.  Leading and trailing spaces
+// and a trailing comma are allowed; anything else around the number is a
+// BAD_DATA error.
+//////////////////////////////////////////////////////////////////////////////
+static float ParseFindFloat(const std::string &sVal) {
+  const char *cStart = sVal.c_str();
+  char *cEnd;
+  double fVal = strtod(cStart, &cEnd);
+  bool bGood = cEnd != cStart;
+  while (bGood && '\0' != *cEnd) {
+    if (' ' != *cEnd && ',' != *cEnd) bGood = false;
+    cEnd++;
+  }
+  if (!bGood) {
+    modelErr stcErr;
+    stcErr.sFunction = "clTreePopulation::Find" ;
+    stcErr.iErrorCode = BAD_DATA;
+    stcErr.sMoreInfo = "Unrecognized float value: ";
+    stcErr.sMoreInfo += sVal;
+    throw(stcErr);
+  }
+  return (float)fVal;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ParseFindInt()
+//
+// Reads a whole number from a Find() argument value, the same way as
+// ParseFindFloat().
+//////////////////////////////////////////////////////////////////////////////
+static int ParseFindInt(const std::string &sVal) {
+  const char *cStart = sVal.c_str();
+  char *cEnd;
+  long iVal = strtol(cStart, &cEnd, 10);
+  bool bGood = cEnd != cStart;
+  while (bGood && '\0' != *cEnd) {
+    if (' ' != *cEnd && ',' != *cEnd) bGood = false;
+    cEnd++;
+  }
+  if (!bGood) {
+    modelErr stcErr;
+    stcErr.sFunction = "clTreePopulation::Find" ;
+    stcErr.iErrorCode = BAD_DATA;
+    stcErr.sMoreInfo = "Unrecognized integer value: ";
+    stcErr.sMoreInfo += sVal;
+    throw(stcErr);
+  }
+  return (int)iVal;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // Find()
 /////////////////////////////////////////////////////////////////////////////*/
 clTreeSearch * clTreePopulation::Find(string sArgs) {
   using namespace std;
-  stcOpenSearches * p_prevRecord = NULL, * p_nextRecord = NULL, * p_newRecord = NULL; //to add a new search object to the searches list
   clTreeSearch * p_results = NULL;
   //holders for the possible search parameters
   string strTempArg, strArgType, strArgVal, strTemp; //for use by anybody - but don't plan on needing it later
-  float fTemp; //for use by anybody - but don't plan on needing it later
-  string::size_type pos;
+  string::size_type pos, posX, posY;
   int iSpecies, iType;
   unsigned long int iTemp; //for use by anybody - but don't plan on needing
   //it later
@@ -2543,21 +2715,8 @@ clTreeSearch * clTreePopulation::Find(string sArgs) {
   //Make sure we have results - if we don't return NULL
   if (sArgs.length() == 0) return p_results;
 
-  //***********************************************
-  //Get our new tree search object going
-  //***********************************************
-  p_results = new clTreeSearch(this, mp_oSimManager->GetPlotObject());
-
-  //Add the new search to the search requests list
-  //Get the initial dummy record
-  p_prevRecord = mp_openSearches;
-  //Get the record it links to as next
-  p_nextRecord = p_prevRecord->p_nextSearch;
-  //Make the new record and insert it in between the two
-  p_newRecord = new stcOpenSearches;
-  p_newRecord->p_oSearch = p_results;
-  p_prevRecord->p_nextSearch = p_newRecord;
-  p_newRecord->p_nextSearch = p_nextRecord;
+  //The string is parsed into a query, which then goes to the typed Find
+  clTreeQuery oQuery(this);
 
   //**************************************************
   //Parse out the argument string - loop through it and process the arguments
@@ -2581,7 +2740,7 @@ clTreeSearch * clTreePopulation::Find(string sArgs) {
     {
       if ("" != strArgVal)
       {
-        p_results->m_bTypeUsed = true;
+        oQuery.m_bTypeUsed = true;
         //parse out the values
         while (strArgVal.length() > 0)
         {
@@ -2589,8 +2748,8 @@ clTreeSearch * clTreePopulation::Find(string sArgs) {
           //Place a bit in the position corresponding to the type's enum
           //value, counting from the right.  (So if it's "adult" and
           //adult's enum is 3, place a 1 in the third bit from the right.)
-          iType = atoi(strTemp.c_str());
-          if ((0 == iType && "0" != strTemp) || iType < 0 || iType > clTreePopulation::woody_debris)
+          iType = ParseFindInt(strTemp);
+          if (iType < 0 || iType > clTreePopulation::woody_debris)
           {
             modelErr stcErr;
             stcErr.sFunction = "clTreePopulation::Find" ;
@@ -2600,8 +2759,8 @@ clTreeSearch * clTreePopulation::Find(string sArgs) {
             stcErr.sMoreInfo = s.str();
             throw(stcErr);
           }
-          iTemp = (int)pow(2, (double)iType);
-          p_results->m_iWhatTypes = p_results->m_iWhatTypes | iTemp;
+          iTemp = 1 << iType;
+          oQuery.m_iWhatTypes = oQuery.m_iWhatTypes | iTemp;
           pos = strArgVal.find_first_of(",") != string::npos ? strArgVal.find_first_of(",") + 1 : strArgVal.length();
           strArgVal.erase(0, pos);
         }
@@ -2613,13 +2772,13 @@ clTreeSearch * clTreePopulation::Find(string sArgs) {
     {
       if ("" != strArgVal)
       {
-        p_results->m_bSpeciesUsed = true;
+        oQuery.m_bSpeciesUsed = true;
         while (strArgVal.length() > 0)
         {
           //trim out the species numbers, starting with the first
           strTemp = strArgVal.substr(0, strArgVal.find_first_of(","));
           //convert the species number from a string to an integer
-          iSpecies = atoi(strTemp.c_str());
+          iSpecies = ParseFindInt(strTemp);
           //Make sure it's a valid species - if not throw an error
           if (iSpecies < 0 || iSpecies >= m_iNumSpecies)
           {
@@ -2630,7 +2789,7 @@ clTreeSearch * clTreePopulation::Find(string sArgs) {
             stcErr.sMoreInfo += strTemp;
             throw(stcErr);
           }
-          p_results->mp_bWhatSpecies[iSpecies] = true;
+          oQuery.mp_bWhatSpecies[iSpecies] = true;
 
           //remove the first value, leaving the others in the string
           pos = strArgVal.find_first_of(",");
@@ -2645,22 +2804,8 @@ clTreeSearch * clTreePopulation::Find(string sArgs) {
     {
       if ("" != strArgVal)
       {
-        //Try to translate the value to a float
-        fTemp = atof(strArgVal.c_str());
-        //If it's 0 - either it wasn't a number or it was really 0 - check
-        //string length to know
-        if (0 == fTemp && "0" != strArgVal.substr(0, 1))
-        {
-          //untranslatable text - error
-          modelErr stcErr;
-          stcErr.sFunction = "clTreePopulation::Find" ;
-          stcErr.iErrorCode = BAD_DATA;
-          stcErr.sMoreInfo = "Unrecognized float value: ";
-          stcErr.sMoreInfo += strArgVal;
-          throw(stcErr);
-        }
-        p_results->m_fHeightCutoff = fTemp;
-        p_results->m_bDistanceHeightUsed = true;
+        oQuery.m_fHeightCutoff = ParseFindFloat(strArgVal);
+        oQuery.m_bDistanceHeightUsed = true;
       } //end of if ("" != strArgVal)
     } //end of else if ("height" == strArgType)
 
@@ -2669,22 +2814,32 @@ clTreeSearch * clTreePopulation::Find(string sArgs) {
     {
       if ("" != strArgVal)
       {
-        p_results->m_bDistanceHeightUsed = true;
-        //get the distance value
-        fTemp = atof(strArgVal.substr(0, strArgVal.find("FROM")).c_str());
-        p_results->m_fDistanceCutoff = fTemp;
-        //get the X and Y
-        fTemp = atof(strArgVal.substr(strArgVal.find("x=") + 2, strArgVal.find("Y=")).c_str());
-        p_results->m_fFromX = fTemp;
-        fTemp = atof(strArgVal.substr(strArgVal.find("y=") + 2).c_str());
-        p_results->m_fFromY = fTemp;
+        oQuery.m_bDistanceHeightUsed = true;
+        //The value looks like "10FROM x=5y=6" - find the pieces
+        pos = strArgVal.find("FROM");
+        posX = strArgVal.find("x=");
+        posY = strArgVal.find("y=");
+        if (string::npos == pos || string::npos == posX ||
+            string::npos == posY || pos > posX || posX > posY)
+        {
+          modelErr stcErr;
+          stcErr.sFunction = "clTreePopulation::Find" ;
+          stcErr.iErrorCode = BAD_DATA;
+          stcErr.sMoreInfo = "Unrecognized distance argument: ";
+          stcErr.sMoreInfo += strArgVal;
+          throw(stcErr);
+        }
+        oQuery.m_fDistanceCutoff = ParseFindFloat(strArgVal.substr(0, pos));
+        oQuery.m_fFromX = ParseFindFloat(strArgVal.substr(posX + 2,
+            posY - posX - 2));
+        oQuery.m_fFromY = ParseFindFloat(strArgVal.substr(posY + 2));
       } //end of if ("" != strArgVal)
     } //end of else if ("distance" == strArgType)
 
     /** ALL */
     else if ("all" == strArgType)
     {
-      p_results->m_bAllUsed = true;
+      oQuery.m_bAllUsed = true;
     }
 
     else
@@ -2699,13 +2854,161 @@ clTreeSearch * clTreePopulation::Find(string sArgs) {
     }
   } //end of while (sArgs.length() > 0)
 
-  //Now we have parsed all our search arguments and passed them to our tree
-  //search object.  Trigger the tree search object's Setup() method.
-  p_results->Setup();
+  //Now we have parsed all our search arguments - run the search
+  p_results = Find(oQuery);
 
   return p_results;
 }
 
+///////////////////////////////////////////////////////////////////////////
+// Find()
+//////////////////////////////////////////////////////////////////////////*/
+clTreeSearch * clTreePopulation::Find(const clTreeQuery &oQuery) {
+  stcOpenSearches * p_prevRecord = NULL, * p_nextRecord = NULL, * p_newRecord = NULL; //to add a new search object to the searches list
+  clTreeSearch * p_results = NULL;
+
+  //***********************************************
+  //Get our new tree search object going
+  //***********************************************
+  p_results = new clTreeSearch(this, mp_oSimManager->GetPlotObject());
+
+  //Add the new search to the search requests list
+  //Get the initial dummy record
+  p_prevRecord = mp_openSearches;
+  //Get the record it links to as next
+  p_nextRecord = p_prevRecord->p_nextSearch;
+  //Make the new record and insert it in between the two
+  p_newRecord = new stcOpenSearches;
+  p_newRecord->p_oSearch = p_results;
+  p_prevRecord->p_nextSearch = p_newRecord;
+  p_newRecord->p_nextSearch = p_nextRecord;
+  m_lNumOpenSearches++;
+
+  //Copy over the search criteria and trigger the search object's Setup()
+  p_results->Arm(oQuery);
+
+  return p_results;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// Find()
+//////////////////////////////////////////////////////////////////////////*/
+void clTreePopulation::Find(const clTreeQuery &oQuery, clTreeSearch *p_oSearch) {
+  if (NULL == p_oSearch || p_oSearch->mp_oTreePop != this) {
+    modelErr stcErr;
+    stcErr.iErrorCode = ILLEGAL_OP;
+    stcErr.sFunction = "clTreePopulation::Find";
+    stcErr.sMoreInfo = "Search object does not belong to this population.";
+    throw(stcErr);
+  }
+  p_oSearch->Arm(oQuery);
+}
+
+///////////////////////////////////////////////////////////////////////////
+// GetSnapshot()
+//////////////////////////////////////////////////////////////////////////*/
+clTreeSnapshot* clTreePopulation::GetSnapshot() {
+  if (NULL == mp_oSnapshot) mp_oSnapshot = new clTreeSnapshot(this);
+  if (!mp_oSnapshot->IsCurrent()) mp_oSnapshot->Build();
+  return mp_oSnapshot;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// GetNeighborRows()
+//////////////////////////////////////////////////////////////////////////*/
+void clTreePopulation::GetNeighborRows(float fX, float fY, float fRadius,
+    float fMinHeight, int &iMinY, int &iMaxY, int &iStartDiv) {
+  float fReach;
+
+  if (fRadius < 0 || fMinHeight < 0) {
+    modelErr stcErr;
+    stcErr.iErrorCode = BAD_DATA;
+    stcErr.sFunction = "clTreePopulation::GetNeighborRows";
+    stcErr.sMoreInfo = "Either distance or height search criterion is a negative number.";
+    throw(stcErr);
+  }
+  if (fX < 0 || fX >= m_fPlotLengthX || fY < 0 || fY >= m_fPlotLengthY) {
+    modelErr stcErr;
+    stcErr.iErrorCode = BAD_DATA;
+    stcErr.sFunction = "clTreePopulation::GetNeighborRows";
+    stcErr.sMoreInfo = "Either X or Y search point is outside plot.";
+    throw(stcErr);
+  }
+
+  //Get the starting height division based on the target height
+  iStartDiv = (int)floor(fMinHeight / m_iSizeHeightDivs);
+  if (iStartDiv >= m_iNumHeightDivs) iStartDiv = m_iNumHeightDivs - 1;
+
+  //Don't reach more than halfway around the plot in either direction, and
+  //never walk a row twice
+  fReach = fRadius < m_fPlotLengthY / 2 ? fRadius : m_fPlotLengthY / 2;
+  iMinY = GetUncorrectedCell(fY - fReach, m_fPlotLengthY, m_iNumYCells);
+  iMaxY = GetUncorrectedCell(fY + fReach, m_fPlotLengthY, m_iNumYCells);
+  if (iMaxY - iMinY >= m_iNumYCells) iMaxY = iMinY + m_iNumYCells - 1;
+}
+
+///////////////////////////////////////////////////////////////////////////
+// GetNeighborColumns()
+//////////////////////////////////////////////////////////////////////////*/
+void clTreePopulation::GetNeighborColumns(float fX, float fY, float fRadius,
+    int iY, int &iMinX, int &iMaxX) {
+  float fSouth = iY * m_iLengthGrids, //south edge of row
+        fNorth = (iY + 1) * m_iLengthGrids, //north edge of row
+        fYDist, fXDist, fTemp;
+
+  //Get the Y distance, corrected for torus, from the point to the nearest
+  //edge of the row - zero if the point is in the row
+  if (fNorth > m_fPlotLengthY) fNorth = m_fPlotLengthY;
+  if (fY >= fSouth && fY < fNorth) {
+    fYDist = 0;
+  } else {
+    fYDist = fabs(fY - fSouth);
+    if (m_fPlotLengthY - fYDist < fYDist) fYDist = m_fPlotLengthY - fYDist;
+    fTemp = fabs(fY - fNorth);
+    if (m_fPlotLengthY - fTemp < fTemp) fTemp = m_fPlotLengthY - fTemp;
+    if (fTemp < fYDist) fYDist = fTemp;
+  }
+
+  //Solve for how far the circle reaches in X in this row
+  fXDist = fRadius * fRadius - fYDist * fYDist;
+  fXDist = fXDist > 0 ? sqrt(fXDist) : 0;
+
+  if (fXDist >= m_fPlotLengthX / 2) {
+    //It's the whole row
+    iMinX = 0;
+    iMaxX = m_iNumXCells - 1;
+    return;
+  }
+
+  iMinX = GetUncorrectedCell(fX - fXDist, m_fPlotLengthX, m_iNumXCells);
+  iMaxX = GetUncorrectedCell(fX + fXDist, m_fPlotLengthX, m_iNumXCells);
+  if (iMaxX - iMinX >= m_iNumXCells) {
+    //It's the whole row
+    iMinX = 0;
+    iMaxX = m_iNumXCells - 1;
+  }
+}
+
+///////////////////////////////////////////////////////////////////////////
+// GetUncorrectedCell()
+//////////////////////////////////////////////////////////////////////////*/
+int clTreePopulation::GetUncorrectedCell(float fCoord, float fPlotLength,
+    int iNumCells) {
+  int iCell;
+  if (fCoord < 0) {
+    iCell = (int)floor((fCoord + fPlotLength) * m_fInvLengthGrids);
+    if (iCell >= iNumCells) iCell = iNumCells - 1;
+    return iCell - iNumCells;
+  }
+  if (fCoord >= fPlotLength) {
+    iCell = (int)floor((fCoord - fPlotLength) * m_fInvLengthGrids);
+    return iCell + iNumCells;
+  }
+  iCell = (int)floor(fCoord * m_fInvLengthGrids);
+  if (iCell >= iNumCells) iCell = iNumCells - 1;
+  return iCell;
+}
+
 
 
 
@@ -2722,12 +3025,13 @@ void clTreePopulation::AddTreeToHashTable(clTree * p_oNewTree) {
     int iX = 0, iY = 0, iHeightDiv = 0, iSp, iType;
     float fHeight, fNeighHeight, fX, fY;
 
+    m_lTreeEpoch++;
     iSp = p_oNewTree->GetSpecies();
     iType = p_oNewTree->GetType();
     p_oNewTree->GetValue(mp_iHeightCode[iSp][iType], & fHeight);
-    //Validate that the coordinates are within the plot - if they're not delete
-    //the tree and return an error.  We need to delete the tree now because it
-    //doesn't have an "owner" to delete it in its destructor
+    //Validate that the coordinates are within the plot - if they're not free
+    //the tree and return an error.  We need to free the tree now because it
+    //doesn't have an "owner" to free it in its destructor
     p_oNewTree->GetValue(mp_iXCode[iSp][iType], & fX);
     p_oNewTree->GetValue(mp_iYCode[iSp][iType], & fY);
     if (fX > m_fPlotLengthX || fX < 0 || fY > m_fPlotLengthY || fY < 0)
@@ -2735,16 +3039,17 @@ void clTreePopulation::AddTreeToHashTable(clTree * p_oNewTree) {
       modelErr stcErr;
       stcErr.sFunction = "clTreePopulation::AddTreeToHashTable" ;
       stcErr.iErrorCode = BAD_DATA;
-      delete p_oNewTree;
+      FreeTree(p_oNewTree);
       std::stringstream s;
       s << "Tree outside plot: X = " << fX << " Y = " << fY;
       stcErr.sMoreInfo = s.str();
       throw(stcErr);
     }
+    MarkCellChanged(p_oNewTree);
 
     //First calculate the coordinates of the grid cell this tree will be in
-    iX = (int)(fX / m_iLengthGrids);
-    iY = (int)(fY / m_iLengthGrids);
+    iX = GetHashCell(fX, m_iNumXCells);
+    iY = GetHashCell(fY, m_iNumYCells);
 
     //Get the height division this tree will be in - divide by size of height div
     iHeightDiv = (int)(fHeight / m_iSizeHeightDivs);
@@ -2913,7 +3218,7 @@ clTree* clTreePopulation::KillTree(clTree * p_oOldTree, deadCode iReason) {
   {
     //All others - remove from memory
     RemoveTreeFromHashTable(p_oOldTree);
-    delete p_oOldTree;
+    FreeTree(p_oOldTree);
     return NULL;
   }
 }
@@ -2930,12 +3235,14 @@ void clTreePopulation::RemoveTreeFromHashTable(clTree * p_oByeTree) {
     int iX = 0, iY = 0, iHeightDiv = 0;
     unsigned short int iSp, iType; //the tree's species and type codes
 
+    m_lTreeEpoch++;
     iSp = p_oByeTree->GetSpecies();
     iType = p_oByeTree->GetType();
+    MarkCellChanged(p_oByeTree);
     p_oByeTree->GetValue(mp_iXCode[iSp][iType], & fX);
     p_oByeTree->GetValue(mp_iYCode[iSp][iType], & fY);
-    iX = (int)floor(fX / m_iLengthGrids);
-    iY = (int)floor(fY / m_iLengthGrids);
+    iX = GetHashCell(fX, m_iNumXCells);
+    iY = GetHashCell(fY, m_iNumYCells);
     p_oByeTree->GetValue(mp_iHeightCode[iSp][iType], & fTempHeight);
     iHeightDiv = (int)floor(fTempHeight / m_iSizeHeightDivs);
     if (iHeightDiv > m_iNumHeightDivs - 1) iHeightDiv = m_iNumHeightDivs - 1;
@@ -3030,6 +3337,144 @@ void clTreePopulation::RemoveTreeFromHashTable(clTree * p_oByeTree) {
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// MarkCellChanged()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::MarkCellChanged(clTree * p_oTree) {
+  float fX, fY;
+  int iX, iY;
+  unsigned short int iSp = p_oTree->GetSpecies(), iType = p_oTree->GetType();
+
+  if (NULL == mp_lCellChangeEpoch) return;
+  p_oTree->GetValue(mp_iXCode[iSp][iType], & fX);
+  p_oTree->GetValue(mp_iYCode[iSp][iType], & fY);
+  iX = GetHashCell(fX, m_iNumXCells);
+  iY = GetHashCell(fY, m_iNumYCells);
+  mp_lCellChangeEpoch[iX * m_iNumYCells + iY] = m_lTreeEpoch;
+  mp_fCellSizeChange[iX * m_iNumYCells + iY] = 0;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// AddCellSizeChange()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::AddCellSizeChange(clTree * p_oTree, float fOldValue,
+    float fNewValue) {
+  float fX, fY, fChange;
+  int iCell;
+  unsigned short int iSp = p_oTree->GetSpecies(), iType = p_oTree->GetType();
+
+  if (NULL == mp_lCellChangeEpoch || fNewValue == fOldValue) return;
+
+  //Any change counts if there is no tolerance, or if there was no size
+  if (m_fSizeChangeTolerance <= 0 || 0 == fOldValue) {
+    MarkCellChanged(p_oTree);
+    return;
+  }
+
+  //Small changes add up until, together, they pass the tolerance, so that
+  //slow growth can't go unnoticed forever
+  p_oTree->GetValue(mp_iXCode[iSp][iType], & fX);
+  p_oTree->GetValue(mp_iYCode[iSp][iType], & fY);
+  iCell = GetHashCell(fX, m_iNumXCells) * m_iNumYCells +
+      GetHashCell(fY, m_iNumYCells);
+  fChange = fabs(fNewValue - fOldValue) / fabs(fOldValue);
+  mp_fCellSizeChange[iCell] += fChange;
+  if (mp_fCellSizeChange[iCell] > m_fSizeChangeTolerance)
+    MarkCellChanged(p_oTree);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// GetStreamKey()
+//////////////////////////////////////////////////////////////////////////////
+uint32_t clTreePopulation::GetStreamKey(clTree *p_oTree) {
+  float fX, fY;
+  uint32_t iKey, iY;
+  short int iSp = p_oTree->GetSpecies(), iType = p_oTree->GetType();
+
+  //A tree never moves, so its location identifies it however many other
+  //trees come and go.  Mix the bits of the coordinates, species and type.
+  p_oTree->GetValue(GetXCode(iSp, iType), &fX);
+  p_oTree->GetValue(GetYCode(iSp, iType), &fY);
+  memcpy(&iKey, &fX, sizeof(iKey));
+  memcpy(&iY, &fY, sizeof(iY));
+  iKey ^= (iY + 0x9E3779B9u + (iKey << 6) + (iKey >> 2));
+  iKey ^= ((uint32_t) iSp << 8 | (uint32_t) iType) * 0x85EBCA6Bu;
+  iKey ^= iKey >> 16;
+  iKey *= 0x7FEB352Du;
+  iKey ^= iKey >> 15;
+  return iKey;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// MarkCrownCellDirty()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::MarkCrownCellDirty(clTree * p_oTree) {
+  float fX, fY;
+  unsigned short int iSp = p_oTree->GetSpecies(), iType = p_oTree->GetType();
+
+  if (NULL == mp_bCrownCellDirty || mp_oAllom->GetNCICrownReach() <= 0)
+    return;
+  p_oTree->GetValue(mp_iXCode[iSp][iType], & fX);
+  p_oTree->GetValue(mp_iYCode[iSp][iType], & fY);
+  mp_bCrownCellDirty[GetHashCell(fX, m_iNumXCells) * m_iNumYCells +
+      GetHashCell(fY, m_iNumYCells)] = true;
+  m_bCrownsDirty = true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ClearDirtyCrowns()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::ClearDirtyCrowns() {
+  clTree * p_oTree;
+  bool * p_bClear;
+  int iNumCells = m_iNumXCells * m_iNumYCells, iNumOutX, iNumOutY, iX, iY,
+      i, j, k;
+  unsigned short int iSp, iType;
+
+  if (!m_bCrownsDirty) return;
+  m_bCrownsDirty = false;
+
+  //Find the cells within reach of any dirty cell, wrapping around the plot
+  //edges, so that each is only walked once
+  iNumOutX = (int)ceil(mp_oAllom->GetNCICrownReach() / m_iLengthGrids);
+  iNumOutY = iNumOutX;
+  if (2 * iNumOutX + 1 > m_iNumXCells) iNumOutX = m_iNumXCells / 2;
+  if (2 * iNumOutY + 1 > m_iNumYCells) iNumOutY = m_iNumYCells / 2;
+  p_bClear = new bool[iNumCells];
+  for (i = 0; i < iNumCells; i++) p_bClear[i] = false;
+  for (iX = 0; iX < m_iNumXCells; iX++)
+    for (iY = 0; iY < m_iNumYCells; iY++)
+    {
+      if (!mp_bCrownCellDirty[iX * m_iNumYCells + iY]) continue;
+      mp_bCrownCellDirty[iX * m_iNumYCells + iY] = false;
+      for (i = iX - iNumOutX; i <= iX + iNumOutX; i++)
+        for (j = iY - iNumOutY; j <= iY + iNumOutY; j++)
+          p_bClear[((i + m_iNumXCells) % m_iNumXCells) * m_iNumYCells +
+              (j + m_iNumYCells) % m_iNumYCells] = true;
+    }
+
+  for (iX = 0; iX < m_iNumXCells; iX++)
+    for (iY = 0; iY < m_iNumYCells; iY++)
+    {
+      if (!p_bClear[iX * m_iNumYCells + iY]) continue;
+      p_oTree = NULL;
+      for (k = 0; k < m_iNumHeightDivs && !p_oTree; k++)
+        p_oTree = mp_oTreeShortest[iX][iY][k];
+      while (p_oTree)
+      {
+        iSp = p_oTree->m_iSpecies;
+        iType = p_oTree->m_iType;
+        if (sapling == iType || adult == iType || snag == iType)
+        {
+          TreeFloat(p_oTree, mp_iCrownRadCode[iSp][iType]) = -1;
+          TreeFloat(p_oTree, mp_iCrownDepthCode[iSp][iType]) = -1;
+        }
+        p_oTree = p_oTree->mp_oNext;
+      }
+    }
+  delete[] p_bClear;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // UpdateTreeInHashTable()
 //////////////////////////////////////////////////////////////////////////////
@@ -3053,8 +3498,8 @@ void clTreePopulation::UpdateTreeInHashTable(clTree * p_oChangedTree) {
 
     p_oChangedTree->GetValue(mp_iXCode[p_oChangedTree->GetSpecies()][p_oChangedTree->GetType()], & fX);
     p_oChangedTree->GetValue(mp_iYCode[p_oChangedTree->GetSpecies()][p_oChangedTree->GetType()], & fY);
-    iX = (int)floor(fX / m_iLengthGrids);
-    iY = (int)floor(fY / m_iLengthGrids);
+    iX = GetHashCell(fX, m_iNumXCells);
+    iY = GetHashCell(fY, m_iNumYCells);
     iCurHeightDiv = (int)(floor(fHeight) / m_iSizeHeightDivs);
     if (iCurHeightDiv > m_iNumHeightDivs - 1)
       iCurHeightDiv = m_iNumHeightDivs - 1;
@@ -3290,6 +3735,14 @@ void clTreePopulation::EmptyHashTable() {
     clTree * p_oTree = NULL, * p_oNextTree = NULL;
     int i, j, k; //loop counters
 
+    m_lSearchEpoch++;
+    m_lTreeEpoch++;
+    if (mp_lCellChangeEpoch)
+      for (i = 0; i < m_iNumXCells * m_iNumYCells; i++) {
+        mp_lCellChangeEpoch[i] = m_lTreeEpoch;
+        mp_fCellSizeChange[i] = 0;
+      }
+
     //Delete the trees
     for (i = 0; i < m_iNumXCells; i++)
       for (j = 0; j < m_iNumYCells; j++)
@@ -3305,7 +3758,7 @@ void clTreePopulation::EmptyHashTable() {
         while (p_oTree != NULL)
         {
           p_oNextTree = p_oTree->GetTaller();
-          delete p_oTree;
+          FreeTree(p_oTree);
           p_oTree = p_oNextTree;
         }
       }
@@ -3343,133 +3796,109 @@ void clTreePopulation::EmptyHashTable() {
 void clTreePopulation::SortHashTable() {
   try
   {
-    clTree * p_oTargetTree, * p_oNeighbor, * p_oOldShorter, * p_oOldTaller, * p_oNewShorter;
-    float fTargetHeight, fNeighborHeight;
-    int iTemp;
-    short iHeightDiv, i, j, k; //loop counters
-    bool bMove;
+    clTree * p_oTree, ** p_oNewTrees;
+    float fHeight, * p_fNewHeights;
+    long lMoves, lMaxMoves;
+    int iNumTrees, iNumDescents, iHeightDiv, iLastDiv, iCapacity, m, n;
+    short i, j, k; //loop counters
 
-    //Start by sorting the trees using the insertion sort algorithm.  Start at
-    //the tallest tree and work down.  Don't worry about the height division
-    //pointers - only the tallest pointer, so we have a starting point.
     for (i = 0; i < m_iNumXCells; i++)
       for (j = 0; j < m_iNumYCells; j++)
       {
-        for (k = m_iNumHeightDivs - 1; k >= 0; k--)
+        //Get a tree, any tree, and work down to the shortest in the cell
+        p_oTree = NULL;
+        for (k = 0; k < m_iNumHeightDivs && !p_oTree; k++)
+          p_oTree = mp_oTreeShortest[i][j][k];
+        if (!p_oTree) continue;
+        while (p_oTree->mp_oPrevious) p_oTree = p_oTree->mp_oPrevious;
+
+        //Gather the cell's trees and heights, shortest to tallest, and count
+        //how many neighboring pairs are out of order
+        iNumTrees = 0;
+        iNumDescents = 0;
+        while (p_oTree)
         {
-          p_oTargetTree = mp_oTreeTallest[i][j][k];
-          if (p_oTargetTree) break;
-        }
-        while (p_oTargetTree)
-        { //go through all the trees from tallest down
-          //Get the height of the tree we're working with
-          bMove = false;
-          p_oTargetTree->GetValue(mp_iHeightCode[p_oTargetTree->GetSpecies()][p_oTargetTree->GetType()], & fTargetHeight);
-          //get the neighbors on either side of the target
-          p_oOldShorter = p_oTargetTree->GetShorter();
-          p_oOldTaller = p_oTargetTree->GetTaller();
-          //the trees taller than this one are already sorted - move this tree
-          //up in the list until it gets to where it belongs
-          p_oNeighbor = p_oOldTaller;
-          while (p_oNeighbor)
-          {
-            p_oNeighbor->GetValue(mp_iHeightCode[p_oNeighbor->GetSpecies()][p_oNeighbor->GetType()], & fNeighborHeight);
-            //if the target is shorter than the neighbor we've found the
-            //target's place in the hash table, so break the loop
-            if (fNeighborHeight >= fTargetHeight) break;
-            else
-              bMove = true; //this lets us know we have a switch to make -
-            //if the target's in the right place we'll never get to this line
-            p_oNewShorter = p_oNeighbor; //we'll hold onto the tree shorter
-            //than the neighbor
-            p_oNeighbor = p_oNeighbor->GetTaller();
-          }
-          //Did we need to move?
-          if (bMove)
+          if (iNumTrees == m_iSortCapacity)
           {
-            //Close the gap between the old neighbors
-            if (p_oOldShorter) p_oOldShorter->mp_oNext = p_oOldTaller;
-            if (p_oOldTaller) p_oOldTaller->mp_oPrevious = p_oOldShorter;
-            //If the neighbor exists, put the target as its shorter
-            if (p_oNeighbor)
+            //Grow the scratch space
+            iCapacity = 0 == m_iSortCapacity ? 256 : m_iSortCapacity * 2;
+            p_oNewTrees = new clTree*[iCapacity * 2];
+            p_fNewHeights = new float[iCapacity * 2];
+            for (m = 0; m < iNumTrees; m++)
             {
-              p_oNewShorter = p_oNeighbor->GetShorter();
-              p_oNewShorter->mp_oNext = p_oTargetTree;
-              p_oNeighbor->mp_oPrevious = p_oTargetTree;
-              p_oTargetTree->mp_oNext = p_oNeighbor;
-              p_oTargetTree->mp_oPrevious = p_oNewShorter;
+              p_oNewTrees[m] = mp_oSortTrees[m];
+              p_fNewHeights[m] = mp_fSortHeights[m];
             }
-            else
+            delete[] mp_oSortTrees;
+            delete[] mp_fSortHeights;
+            mp_oSortTrees = p_oNewTrees;
+            mp_fSortHeights = p_fNewHeights;
+            m_iSortCapacity = iCapacity;
+          }
+          fHeight = TreeFloat(p_oTree, mp_iHeightCode[p_oTree->m_iSpecies][p_oTree->m_iType]);
+          if (iNumTrees > 0 && mp_fSortHeights[iNumTrees - 1] > fHeight)
+            iNumDescents++;
+          mp_oSortTrees[iNumTrees] = p_oTree;
+          mp_fSortHeights[iNumTrees] = fHeight;
+          iNumTrees++;
+          p_oTree = p_oTree->mp_oNext;
+        }
+
+        //Put the trees in order
+        if (iNumDescents > 0)
+        {
+          //Repair with an insertion sort. In a big cell, stop if the trees
+          //have to be shifted too far and bulk sort instead - the insertion
+          //sort is stable, so the partly sorted array still merges into the
+          //same order
+          lMaxMoves = iNumTrees < HASH_SORT_MIN_BULK ? -1 :
+              (long)iNumTrees * HASH_SORT_MOVE_RATIO;
+          lMoves = 0;
+          for (m = 1; m < iNumTrees; m++)
+          {
+            p_oTree = mp_oSortTrees[m];
+            fHeight = mp_fSortHeights[m];
+            for (n = m - 1; n >= 0 && mp_fSortHeights[n] > fHeight; n--)
             {
-              //If the neighbor doesn't exist, the target is now tallest
-              //p_oNewShorter holds the last tree
-              p_oNewShorter->mp_oNext = p_oTargetTree;
-              p_oTargetTree->mp_oPrevious = p_oNewShorter;
-              p_oTargetTree->mp_oNext = NULL;
+              mp_oSortTrees[n + 1] = mp_oSortTrees[n];
+              mp_fSortHeights[n + 1] = mp_fSortHeights[n];
             }
-          } //end of if (bMove)
-          p_oTargetTree = p_oOldShorter;
-        } //end of while (p_oTargetTree)
+            mp_oSortTrees[n + 1] = p_oTree;
+            mp_fSortHeights[n + 1] = fHeight;
+            lMoves += m - 1 - n;
+            if (lMaxMoves >= 0 && lMoves > lMaxMoves) break;
+          }
+          if (m < iNumTrees)
+          {
+            MergeSortCell(iNumTrees);
+            m_lNumCellsBulkSorted++;
+          }
+          else m_lNumCellsRepaired++;
+        }
 
         //****************************************
-        //Now do the height division pointers for this grid cell
+        //Relink the cell and rebuild the height division pointers in one pass
         //****************************************
         for (k = 0; k < m_iNumHeightDivs; k++)
-        {
-          //Get a tree, any tree
-          p_oTargetTree = mp_oTreeShortest[i][j][k];
-          if (p_oTargetTree) break;
-        }
-        //NULL out all current height div pointers
-        for (k = 0; k < m_iNumHeightDivs; k++)
         {
           mp_oTreeShortest[i][j][k] = NULL;
           mp_oTreeTallest[i][j][k] = NULL;
         }
-        if (p_oTargetTree)
+        iLastDiv = -1;
+        for (m = 0; m < iNumTrees; m++)
         {
-          //Now work down to the smallest tree in the grid cell
-          while (p_oTargetTree)
+          p_oTree = mp_oSortTrees[m];
+          p_oTree->mp_oPrevious = m > 0 ? mp_oSortTrees[m - 1] : NULL;
+          p_oTree->mp_oNext = m < iNumTrees - 1 ? mp_oSortTrees[m + 1] : NULL;
+
+          iHeightDiv = (int)floor(mp_fSortHeights[m] / m_iSizeHeightDivs);
+          iHeightDiv = iHeightDiv < m_iNumHeightDivs - 1 ? iHeightDiv : m_iNumHeightDivs - 1;
+          if (iHeightDiv != iLastDiv)
           {
-            p_oOldShorter = p_oTargetTree;
-            p_oTargetTree = p_oTargetTree->GetShorter();
+            mp_oTreeShortest[i][j][iHeightDiv] = p_oTree;
+            iLastDiv = iHeightDiv;
           }
-          p_oTargetTree = p_oOldShorter;
-          //OK, p_oTargetTree is now the shortest in the cell.  Work up and
-          //do the pointers by comparing to neighbors on either side
-          while (p_oTargetTree)
-          {
-            p_oTargetTree->GetValue(mp_iHeightCode[p_oTargetTree->GetSpecies()][p_oTargetTree->GetType()], & fTargetHeight);
-            iHeightDiv =(int)floor(fTargetHeight / m_iSizeHeightDivs);
-            iHeightDiv = iHeightDiv < m_iNumHeightDivs - 1 ? iHeightDiv : m_iNumHeightDivs - 1;
-            //Check taller - if in a different height div or nonexistent, the
-            //target tree is the tallest in this height div
-            p_oOldTaller = p_oTargetTree->GetTaller();
-            if (!p_oOldTaller) mp_oTreeTallest[i][j][iHeightDiv] = p_oTargetTree;
-            else
-            {
-              p_oOldTaller->GetValue(mp_iHeightCode[p_oOldTaller->GetSpecies()]
-                                                     [p_oOldTaller->GetType()], & fNeighborHeight);
-              iTemp = (int)floor(fNeighborHeight / m_iSizeHeightDivs);
-              iTemp = iTemp < m_iNumHeightDivs - 1 ? iTemp : m_iNumHeightDivs - 1;
-              if (iTemp != iHeightDiv)
-                mp_oTreeTallest[i][j][iHeightDiv] = p_oTargetTree;
-            }
-            //Check shorter - if in a different height div or nonexistent, the
-            //target tree is the shortest in this height div
-            p_oOldShorter = p_oTargetTree->GetShorter();
-            if (!p_oOldShorter) mp_oTreeShortest[i][j][iHeightDiv] = p_oTargetTree;
-            else
-            {
-              p_oOldShorter->GetValue(mp_iHeightCode[p_oOldShorter->GetSpecies()]
-                                                      [p_oOldShorter->GetType()], & fNeighborHeight);
-              iTemp = (int)floor(fNeighborHeight / m_iSizeHeightDivs);
-              iTemp = iTemp < m_iNumHeightDivs - 1 ? iTemp : m_iNumHeightDivs - 1;
-              if (iTemp != iHeightDiv)
-                mp_oTreeShortest[i][j][iHeightDiv] = p_oTargetTree;
-            }
-            p_oTargetTree = p_oOldTaller;
-          } //end of while (p_oTargetTree)
+          mp_oTreeTallest[i][j][iHeightDiv] = p_oTree;
         }
       } //end of for (j = 0; j < m_iNumYCells; j++)
 
@@ -3493,6 +3922,60 @@ void clTreePopulation::SortHashTable() {
 }
 
 
+//////////////////////////////////////////////////////////////////////////////
+// MergeSortCell
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::MergeSortCell(int iNumTrees) {
+  clTree ** p_oFrom = mp_oSortTrees, ** p_oTo = mp_oSortTrees + m_iSortCapacity,
+         ** p_oSwapTrees;
+  float * p_fFrom = mp_fSortHeights, * p_fTo = mp_fSortHeights + m_iSortCapacity,
+        * p_fSwapHeights;
+  int iWidth, iLeft, iMid, iRight, a, b, c;
+
+  //Merge runs of doubling width back and forth between the two halves of the
+  //scratch space. Taking from the left run on ties keeps the sort stable.
+  for (iWidth = 1; iWidth < iNumTrees; iWidth *= 2)
+  {
+    for (iLeft = 0; iLeft < iNumTrees; iLeft += 2 * iWidth)
+    {
+      iMid = iLeft + iWidth < iNumTrees ? iLeft + iWidth : iNumTrees;
+      iRight = iLeft + 2 * iWidth < iNumTrees ? iLeft + 2 * iWidth : iNumTrees;
+      a = iLeft; b = iMid; c = iLeft;
+      while (a < iMid && b < iRight)
+      {
+        if (p_fFrom[b] < p_fFrom[a])
+        {
+          p_oTo[c] = p_oFrom[b]; p_fTo[c] = p_fFrom[b]; b++;
+        }
+        else
+        {
+          p_oTo[c] = p_oFrom[a]; p_fTo[c] = p_fFrom[a]; a++;
+        }
+        c++;
+      }
+      while (a < iMid)
+      {
+        p_oTo[c] = p_oFrom[a]; p_fTo[c] = p_fFrom[a]; a++; c++;
+      }
+      while (b < iRight)
+      {
+        p_oTo[c] = p_oFrom[b]; p_fTo[c] = p_fFrom[b]; b++; c++;
+      }
+    }
+    p_oSwapTrees = p_oFrom; p_oFrom = p_oTo; p_oTo = p_oSwapTrees;
+    p_fSwapHeights = p_fFrom; p_fFrom = p_fTo; p_fTo = p_fSwapHeights;
+  }
+
+  //If the sorted trees ended up in the second half, copy them back
+  if (p_oFrom != mp_oSortTrees)
+    for (a = 0; a < iNumTrees; a++)
+    {
+      mp_oSortTrees[a] = p_oFrom[a];
+      mp_fSortHeights[a] = p_fFrom[a];
+    }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////
 // TimestepCleanup()
 //////////////////////////////////////////////////////////////////////////////
@@ -3527,6 +4010,9 @@ void clTreePopulation::TimestepCleanup() {
     }
     //set the next record for the dummy record to NULL
     mp_openSearches->p_nextSearch = NULL;
+    m_lNumOpenSearches = 0;
+    //Caller-owned searches may point to trees about to be freed
+    m_lSearchEpoch++;
     m_bDoUpdates = false;
 
     //Delete all stumps
@@ -3563,8 +4049,14 @@ void clTreePopulation::TimestepCleanup() {
           }
           p_oTree = p_oTree->GetTaller();
         }
+        //Every crown is cleared, so no cell is left dirty
+        if (mp_bCrownCellDirty)
+          mp_bCrownCellDirty[i * m_iNumYCells + j] = false;
       }
+    m_bCrownsDirty = false;
 
+    //Put the data member columns back into hash table order
+    CompactTreeColumns();
   }
   catch (modelErr & err)
   {
@@ -3639,50 +4131,46 @@ clTree * clTreePopulation::CreateTree(float fX, float fY, int iSp, int iType,
     //If the diam10 wasn't passed, get a random one
     if (0 == fDiam)
       fDiam = GetRandomDiam10Value();
-    p_oTree = new clTree(iType, iSp, mp_iNumTreeFloatVals[iSp][iType], mp_iNumTreeIntVals[iSp][iType],
-        mp_iNumTreeStringVals[iSp][iType], mp_iNumTreeBoolVals[iSp][iType], this);
+    p_oTree = AllocateTree(iSp, iType);
     //Set the X and Y values directly, but let SetValue do the allometry
     //updates for us
-    p_oTree->mp_fFloatValues[mp_iXCode[iSp][iType]] = fX;
-    p_oTree->mp_fFloatValues[mp_iYCode[iSp][iType]] = fY;
+    TreeFloat(p_oTree, mp_iXCode[iSp][iType]) = fX;
+    TreeFloat(p_oTree, mp_iYCode[iSp][iType]) = fY;
     p_oTree->SetValue(mp_iDiam10Code[iSp][iType], fDiam, false);
     p_oTree->mp_oPrevious = NULL; p_oTree->mp_oNext = NULL;
   } //end of if (seedling == iType)
   else if (sapling == iType)
   {
-    p_oTree = new clTree(iType, iSp, mp_iNumTreeFloatVals[iSp][iType], mp_iNumTreeIntVals[iSp][iType],
-        mp_iNumTreeStringVals[iSp][iType], mp_iNumTreeBoolVals[iSp][iType], this);
+    p_oTree = AllocateTree(iSp, iType);
     //Set the X and Y values directly, but let SetValue do the allometry
     //updates for us
-    p_oTree->mp_fFloatValues[mp_iXCode[iSp][iType]] = fX;
-    p_oTree->mp_fFloatValues[mp_iYCode[iSp][iType]] = fY;
-    p_oTree->mp_fFloatValues[mp_iCrownRadCode[iSp][iType]] = -1;
-    p_oTree->mp_fFloatValues[mp_iCrownDepthCode[iSp][iType]] = -1;
+    TreeFloat(p_oTree, mp_iXCode[iSp][iType]) = fX;
+    TreeFloat(p_oTree, mp_iYCode[iSp][iType]) = fY;
+    TreeFloat(p_oTree, mp_iCrownRadCode[iSp][iType]) = -1;
+    TreeFloat(p_oTree, mp_iCrownDepthCode[iSp][iType]) = -1;
     p_oTree->SetValue(mp_iDbhCode[iSp][iType], fDiam, false);
     p_oTree->mp_oPrevious = NULL; p_oTree->mp_oNext = NULL;
   } //end of if (sapling == iType)
   else if (adult == iType || snag == iType)
   {
-    p_oTree = new clTree(iType, iSp, mp_iNumTreeFloatVals[iSp][iType], mp_iNumTreeIntVals[iSp][iType],
-        mp_iNumTreeStringVals[iSp][iType], mp_iNumTreeBoolVals[iSp][iType], this);
+    p_oTree = AllocateTree(iSp, iType);
     //Set the X and Y values directly, but let SetValue do the allometry
     //updates for us
-    p_oTree->mp_fFloatValues[mp_iXCode[iSp][iType]] = fX;
-    p_oTree->mp_fFloatValues[mp_iYCode[iSp][iType]] = fY;
-    p_oTree->mp_fFloatValues[mp_iCrownRadCode[iSp][iType]] = -1;
-    p_oTree->mp_fFloatValues[mp_iCrownDepthCode[iSp][iType]] = -1;
+    TreeFloat(p_oTree, mp_iXCode[iSp][iType]) = fX;
+    TreeFloat(p_oTree, mp_iYCode[iSp][iType]) = fY;
+    TreeFloat(p_oTree, mp_iCrownRadCode[iSp][iType]) = -1;
+    TreeFloat(p_oTree, mp_iCrownDepthCode[iSp][iType]) = -1;
     p_oTree->SetValue(mp_iDbhCode[iSp][iType], fDiam, false);
     p_oTree->mp_oPrevious = NULL; p_oTree->mp_oNext = NULL;
   } //end of if (adult == iType)
   else if (stump == iType)
   {
-    p_oTree = new clTree(iType, iSp, mp_iNumTreeFloatVals[iSp][iType], mp_iNumTreeIntVals[iSp][iType],
-        mp_iNumTreeStringVals[iSp][iType], mp_iNumTreeBoolVals[iSp][iType], this);
+    p_oTree = AllocateTree(iSp, iType);
 
     //Set X, Y, and DBH values
-    p_oTree->mp_fFloatValues[mp_iXCode[iSp][iType]] = fX;
-    p_oTree->mp_fFloatValues[mp_iYCode[iSp][iType]] = fY;
-    p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] = fDiam;
+    TreeFloat(p_oTree, mp_iXCode[iSp][iType]) = fX;
+    TreeFloat(p_oTree, mp_iYCode[iSp][iType]) = fY;
+    TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) = fDiam;
 
     p_oTree->mp_oNext = mp_oStumps; //NULL OK
     mp_oStumps = p_oTree;
@@ -3756,7 +4244,7 @@ void clTreePopulation::DeleteStumps() {
     while (p_oStump)
     {
       p_oNextStump = p_oStump->mp_oNext;
-      delete p_oStump;
+      FreeTree(p_oStump);
       p_oStump = p_oNextStump;
     }
 
@@ -3780,6 +4268,416 @@ void clTreePopulation::DeleteStumps() {
 }
 
 
+//////////////////////////////////////////////////////////////////////////////
+// CreateTreePools()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::CreateTreePools() {
+  int i, j;
+
+  mp_oFreeTrees = new clTree**[m_iNumSpecies];
+  for (i = 0; i < m_iNumSpecies; i++) {
+    mp_oFreeTrees[i] = new clTree*[m_iNumTypes];
+    for (j = 0; j < m_iNumTypes; j++)
+      mp_oFreeTrees[i][j] = NULL;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// DeleteTreePools()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::DeleteTreePools() {
+  stcTreeSlab *p_slab = mp_treeSlabs, *p_nextSlab;
+  int i;
+
+  while (p_slab) {
+    p_nextSlab = p_slab->p_nextSlab;
+    delete[] p_slab->p_oTrees;
+    delete p_slab;
+    p_slab = p_nextSlab;
+  }
+  mp_treeSlabs = NULL;
+
+  if (mp_oFreeTrees) {
+    for (i = 0; i < m_iNumSpecies; i++)
+      delete[] mp_oFreeTrees[i];
+    delete[] mp_oFreeTrees;
+    mp_oFreeTrees = NULL;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// AllocateTree()
+//////////////////////////////////////////////////////////////////////////////
+clTree* clTreePopulation::AllocateTree(int iSpecies, int iType) {
+  clTree *p_oTree;
+  int i;
+
+  if (iType < seed || iType > woody_debris) {
+    modelErr stcErr;
+    stcErr.iErrorCode = BAD_DATA;
+    stcErr.sFunction = "clTreePopulation::AllocateTree";
+    std::stringstream s;
+    s << "Unrecognized tree type:  " << iType;
+    stcErr.sMoreInfo = s.str();
+    throw(stcErr);
+  }
+  if (iSpecies < 0 || iSpecies >= m_iNumSpecies) {
+    modelErr stcErr;
+    stcErr.iErrorCode = BAD_DATA;
+    stcErr.sFunction = "clTreePopulation::AllocateTree";
+    std::stringstream s;
+    s << "Unrecognized species:  " << iSpecies;
+    stcErr.sMoreInfo = s.str();
+    throw(stcErr);
+  }
+
+  //clTree's tree population pointer is static - it may already be set
+  if (NULL == clTree::mp_oTreePop) clTree::mp_oTreePop = this;
+
+  if (NULL == mp_oFreeTrees[iSpecies][iType]) {
+    //Pool is empty - make a new slab and put its trees on the free list
+    stcTreeSlab *p_slab = new stcTreeSlab;
+    p_slab->p_oTrees = new clTree[TREE_SLAB_SIZE];
+    p_slab->p_nextSlab = mp_treeSlabs;
+    mp_treeSlabs = p_slab;
+    for (i = 0; i < TREE_SLAB_SIZE - 1; i++)
+      p_slab->p_oTrees[i].mp_oNext = &p_slab->p_oTrees[i + 1];
+    p_slab->p_oTrees[TREE_SLAB_SIZE - 1].mp_oNext = NULL;
+    mp_oFreeTrees[iSpecies][iType] = p_slab->p_oTrees;
+    m_lNumTreeSlabs++;
+  } else {
+    m_lNumTreesRecycled++;
+  }
+
+  p_oTree = mp_oFreeTrees[iSpecies][iType];
+  mp_oFreeTrees[iSpecies][iType] = p_oTree->mp_oNext;
+  m_lNumTreesAllocated++;
+
+  p_oTree->m_iSpecies = iSpecies;
+  p_oTree->m_iType = iType;
+  p_oTree->mp_oNext = NULL;
+  p_oTree->mp_oPrevious = NULL;
+  p_oTree->m_iSlot = AllocateTreeSlot(iSpecies, iType);
+
+  //A recycled tree already has its string array; a new one needs it made
+  if (mp_iNumTreeStringVals[iSpecies][iType] > 0) {
+    if (NULL == p_oTree->mp_sStringValues)
+      p_oTree->mp_sStringValues = new string[mp_iNumTreeStringVals[iSpecies][iType]];
+    else
+      for (i = 0; i < mp_iNumTreeStringVals[iSpecies][iType]; i++)
+        p_oTree->mp_sStringValues[i] = "";
+  }
+
+  return p_oTree;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// FreeTree()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::FreeTree(clTree *p_oTree) {
+  unsigned short int iSp = p_oTree->m_iSpecies, iTp = p_oTree->m_iType;
+
+  ReleaseTreeSlot(iSp, iTp, p_oTree->m_iSlot);
+  p_oTree->m_iSlot = -1;
+  p_oTree->mp_oPrevious = NULL;
+  p_oTree->mp_oNext = mp_oFreeTrees[iSp][iTp];
+  mp_oFreeTrees[iSp][iTp] = p_oTree;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// CreateTreeColumns()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::CreateTreeColumns() {
+  int i, j;
+
+  mp_fFloatColumns = new float***[m_iNumSpecies];
+  mp_iIntColumns = new int***[m_iNumSpecies];
+  mp_bBoolColumns = new bool***[m_iNumSpecies];
+  mp_iColumnCapacity = new int*[m_iNumSpecies];
+  mp_iNumColumnSlots = new int*[m_iNumSpecies];
+  mp_iFreeSlots = new int**[m_iNumSpecies];
+  mp_iNumFreeSlots = new int*[m_iNumSpecies];
+  for (i = 0; i < m_iNumSpecies; i++) {
+    mp_fFloatColumns[i] = new float**[m_iNumTypes];
+    mp_iIntColumns[i] = new int**[m_iNumTypes];
+    mp_bBoolColumns[i] = new bool**[m_iNumTypes];
+    mp_iColumnCapacity[i] = new int[m_iNumTypes];
+    mp_iNumColumnSlots[i] = new int[m_iNumTypes];
+    mp_iFreeSlots[i] = new int*[m_iNumTypes];
+    mp_iNumFreeSlots[i] = new int[m_iNumTypes];
+    for (j = 0; j < m_iNumTypes; j++) {
+      //Columns start out empty - they are sized the first time a tree of
+      //this species and type is created
+      mp_fFloatColumns[i][j] = new float*[mp_iNumTreeFloatVals[i][j]];
+      mp_iIntColumns[i][j] = new int*[mp_iNumTreeIntVals[i][j]];
+      mp_bBoolColumns[i][j] = new bool*[mp_iNumTreeBoolVals[i][j]];
+      mp_iColumnCapacity[i][j] = 0;
+      mp_iNumColumnSlots[i][j] = 0;
+      mp_iFreeSlots[i][j] = NULL;
+      mp_iNumFreeSlots[i][j] = 0;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// DeleteTreeColumns()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::DeleteTreeColumns() {
+  int i, j, k;
+
+  if (NULL == mp_fFloatColumns) return;
+
+  for (i = 0; i < m_iNumSpecies; i++) {
+    for (j = 0; j < m_iNumTypes; j++) {
+      if (mp_iColumnCapacity[i][j] > 0) {
+        for (k = 0; k < mp_iNumTreeFloatVals[i][j]; k++)
+          delete[] mp_fFloatColumns[i][j][k];
+        for (k = 0; k < mp_iNumTreeIntVals[i][j]; k++)
+          delete[] mp_iIntColumns[i][j][k];
+        for (k = 0; k < mp_iNumTreeBoolVals[i][j]; k++)
+          delete[] mp_bBoolColumns[i][j][k];
+      }
+      delete[] mp_fFloatColumns[i][j];
+      delete[] mp_iIntColumns[i][j];
+      delete[] mp_bBoolColumns[i][j];
+      delete[] mp_iFreeSlots[i][j];
+    }
+    delete[] mp_fFloatColumns[i];
+    delete[] mp_iIntColumns[i];
+    delete[] mp_bBoolColumns[i];
+    delete[] mp_iColumnCapacity[i];
+    delete[] mp_iNumColumnSlots[i];
+    delete[] mp_iFreeSlots[i];
+    delete[] mp_iNumFreeSlots[i];
+  }
+  delete[] mp_fFloatColumns; mp_fFloatColumns = NULL;
+  delete[] mp_iIntColumns; mp_iIntColumns = NULL;
+  delete[] mp_bBoolColumns; mp_bBoolColumns = NULL;
+  delete[] mp_iColumnCapacity; mp_iColumnCapacity = NULL;
+  delete[] mp_iNumColumnSlots; mp_iNumColumnSlots = NULL;
+  delete[] mp_iFreeSlots; mp_iFreeSlots = NULL;
+  delete[] mp_iNumFreeSlots; mp_iNumFreeSlots = NULL;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// GrowTreeColumns()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::GrowTreeColumns(int iSpecies, int iType) {
+  float *p_fNewColumn;
+  int *p_iNewColumn, *p_iNewFree,
+      iOldCapacity = mp_iColumnCapacity[iSpecies][iType],
+      iNewCapacity = iOldCapacity * 2,
+      i, k;
+  bool *p_bNewColumn;
+
+  if (iNewCapacity < 256) iNewCapacity = 256;
+
+  for (k = 0; k < mp_iNumTreeFloatVals[iSpecies][iType]; k++) {
+    p_fNewColumn = new float[iNewCapacity];
+    for (i = 0; i < iOldCapacity; i++)
+      p_fNewColumn[i] = mp_fFloatColumns[iSpecies][iType][k][i];
+    if (iOldCapacity > 0) delete[] mp_fFloatColumns[iSpecies][iType][k];
+    mp_fFloatColumns[iSpecies][iType][k] = p_fNewColumn;
+  }
+  for (k = 0; k < mp_iNumTreeIntVals[iSpecies][iType]; k++) {
+    p_iNewColumn = new int[iNewCapacity];
+    for (i = 0; i < iOldCapacity; i++)
+      p_iNewColumn[i] = mp_iIntColumns[iSpecies][iType][k][i];
+    if (iOldCapacity > 0) delete[] mp_iIntColumns[iSpecies][iType][k];
+    mp_iIntColumns[iSpecies][iType][k] = p_iNewColumn;
+  }
+  for (k = 0; k < mp_iNumTreeBoolVals[iSpecies][iType]; k++) {
+    p_bNewColumn = new bool[iNewCapacity];
+    for (i = 0; i < iOldCapacity; i++)
+      p_bNewColumn[i] = mp_bBoolColumns[iSpecies][iType][k][i];
+    if (iOldCapacity > 0) delete[] mp_bBoolColumns[iSpecies][iType][k];
+    mp_bBoolColumns[iSpecies][iType][k] = p_bNewColumn;
+  }
+
+  //The free stack can never hold more than the capacity
+  p_iNewFree = new int[iNewCapacity];
+  for (i = 0; i < mp_iNumFreeSlots[iSpecies][iType]; i++)
+    p_iNewFree[i] = mp_iFreeSlots[iSpecies][iType][i];
+  delete[] mp_iFreeSlots[iSpecies][iType];
+  mp_iFreeSlots[iSpecies][iType] = p_iNewFree;
+
+  mp_iColumnCapacity[iSpecies][iType] = iNewCapacity;
+  m_lNumColumnGrows++;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// AllocateTreeSlot()
+//////////////////////////////////////////////////////////////////////////////
+int clTreePopulation::AllocateTreeSlot(int iSpecies, int iType) {
+  int iSlot, k;
+
+  if (NULL == mp_fFloatColumns) {
+    modelErr stcErr;
+    stcErr.iErrorCode = ILLEGAL_OP;
+    stcErr.sFunction = "clTreePopulation::AllocateTreeSlot";
+    stcErr.sMoreInfo = "Trees cannot be created before the tree data structure is set up.";
+    throw(stcErr);
+  }
+
+  if (mp_iNumFreeSlots[iSpecies][iType] > 0) {
+    mp_iNumFreeSlots[iSpecies][iType]--;
+    iSlot = mp_iFreeSlots[iSpecies][iType][mp_iNumFreeSlots[iSpecies][iType]];
+  } else {
+    if (mp_iNumColumnSlots[iSpecies][iType] == mp_iColumnCapacity[iSpecies][iType])
+      GrowTreeColumns(iSpecies, iType);
+    iSlot = mp_iNumColumnSlots[iSpecies][iType];
+    mp_iNumColumnSlots[iSpecies][iType]++;
+  }
+
+  //Initialize the values
+  for (k = 0; k < mp_iNumTreeFloatVals[iSpecies][iType]; k++)
+    mp_fFloatColumns[iSpecies][iType][k][iSlot] = 0;
+  for (k = 0; k < mp_iNumTreeIntVals[iSpecies][iType]; k++)
+    mp_iIntColumns[iSpecies][iType][k][iSlot] = 0;
+  for (k = 0; k < mp_iNumTreeBoolVals[iSpecies][iType]; k++)
+    mp_bBoolColumns[iSpecies][iType][k][iSlot] = false;
+
+  return iSlot;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ReleaseTreeSlot()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::ReleaseTreeSlot(int iSpecies, int iType, int iSlot) {
+  if (NULL == mp_iFreeSlots) return;
+  mp_iFreeSlots[iSpecies][iType][mp_iNumFreeSlots[iSpecies][iType]] = iSlot;
+  mp_iNumFreeSlots[iSpecies][iType]++;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// CompactTreeColumns()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::CompactTreeColumns() {
+  try
+  {
+    float ****p_fNewFloat;
+    int ****p_iNewInt;
+    bool ****p_bNewBool;
+    clTree *p_oTree;
+    int i, j, k, iSp, iTp, iSlot, iCapacity;
+
+    if (NULL == mp_fFloatColumns) return;
+
+    //Declare the new columns at the current capacity and zero the slot counts
+    p_fNewFloat = new float***[m_iNumSpecies];
+    p_iNewInt = new int***[m_iNumSpecies];
+    p_bNewBool = new bool***[m_iNumSpecies];
+    for (i = 0; i < m_iNumSpecies; i++) {
+      p_fNewFloat[i] = new float**[m_iNumTypes];
+      p_iNewInt[i] = new int**[m_iNumTypes];
+      p_bNewBool[i] = new bool**[m_iNumTypes];
+      for (j = 0; j < m_iNumTypes; j++) {
+        iCapacity = mp_iColumnCapacity[i][j];
+        p_fNewFloat[i][j] = new float*[mp_iNumTreeFloatVals[i][j]];
+        p_iNewInt[i][j] = new int*[mp_iNumTreeIntVals[i][j]];
+        p_bNewBool[i][j] = new bool*[mp_iNumTreeBoolVals[i][j]];
+        if (iCapacity > 0) {
+          for (k = 0; k < mp_iNumTreeFloatVals[i][j]; k++)
+            p_fNewFloat[i][j][k] = new float[iCapacity];
+          for (k = 0; k < mp_iNumTreeIntVals[i][j]; k++)
+            p_iNewInt[i][j][k] = new int[iCapacity];
+          for (k = 0; k < mp_iNumTreeBoolVals[i][j]; k++)
+            p_bNewBool[i][j][k] = new bool[iCapacity];
+        }
+        mp_iNumColumnSlots[i][j] = 0;
+        mp_iNumFreeSlots[i][j] = 0;
+      }
+    }
+
+    //Copy the trees over in hash table order, then the stumps
+    for (i = 0; i < m_iNumXCells; i++)
+      for (j = 0; j < m_iNumYCells; j++)
+      {
+        p_oTree = mp_oTreeShortest[i][j][0];
+        if (!p_oTree)
+          for (k = 1; k < m_iNumHeightDivs; k++)
+          {
+            p_oTree = mp_oTreeShortest[i][j][k];
+            if (p_oTree)
+              break;
+          }
+        while (p_oTree != NULL)
+        {
+          iSp = p_oTree->m_iSpecies;
+          iTp = p_oTree->m_iType;
+          iSlot = mp_iNumColumnSlots[iSp][iTp];
+          for (k = 0; k < mp_iNumTreeFloatVals[iSp][iTp]; k++)
+            p_fNewFloat[iSp][iTp][k][iSlot] = TreeFloat(p_oTree, k);
+          for (k = 0; k < mp_iNumTreeIntVals[iSp][iTp]; k++)
+            p_iNewInt[iSp][iTp][k][iSlot] = TreeInt(p_oTree, k);
+          for (k = 0; k < mp_iNumTreeBoolVals[iSp][iTp]; k++)
+            p_bNewBool[iSp][iTp][k][iSlot] = TreeBool(p_oTree, k);
+          p_oTree->m_iSlot = iSlot;
+          mp_iNumColumnSlots[iSp][iTp]++;
+          p_oTree = p_oTree->GetTaller();
+        }
+      }
+    p_oTree = mp_oStumps;
+    while (p_oTree != NULL)
+    {
+      iSp = p_oTree->m_iSpecies;
+      iTp = p_oTree->m_iType;
+      iSlot = mp_iNumColumnSlots[iSp][iTp];
+      for (k = 0; k < mp_iNumTreeFloatVals[iSp][iTp]; k++)
+        p_fNewFloat[iSp][iTp][k][iSlot] = TreeFloat(p_oTree, k);
+      for (k = 0; k < mp_iNumTreeIntVals[iSp][iTp]; k++)
+        p_iNewInt[iSp][iTp][k][iSlot] = TreeInt(p_oTree, k);
+      for (k = 0; k < mp_iNumTreeBoolVals[iSp][iTp]; k++)
+        p_bNewBool[iSp][iTp][k][iSlot] = TreeBool(p_oTree, k);
+      p_oTree->m_iSlot = iSlot;
+      mp_iNumColumnSlots[iSp][iTp]++;
+      p_oTree = p_oTree->mp_oNext;
+    }
+
+    //Swap in the new columns
+    for (i = 0; i < m_iNumSpecies; i++) {
+      for (j = 0; j < m_iNumTypes; j++) {
+        if (mp_iColumnCapacity[i][j] > 0) {
+          for (k = 0; k < mp_iNumTreeFloatVals[i][j]; k++)
+            delete[] mp_fFloatColumns[i][j][k];
+          for (k = 0; k < mp_iNumTreeIntVals[i][j]; k++)
+            delete[] mp_iIntColumns[i][j][k];
+          for (k = 0; k < mp_iNumTreeBoolVals[i][j]; k++)
+            delete[] mp_bBoolColumns[i][j][k];
+        }
+        delete[] mp_fFloatColumns[i][j];
+        delete[] mp_iIntColumns[i][j];
+        delete[] mp_bBoolColumns[i][j];
+      }
+      delete[] mp_fFloatColumns[i];
+      delete[] mp_iIntColumns[i];
+      delete[] mp_bBoolColumns[i];
+    }
+    delete[] mp_fFloatColumns;
+    delete[] mp_iIntColumns;
+    delete[] mp_bBoolColumns;
+    mp_fFloatColumns = p_fNewFloat;
+    mp_iIntColumns = p_iNewInt;
+    mp_bBoolColumns = p_bNewBool;
+  } //end of try block
+  catch (modelErr & err)
+  {
+    throw(err);
+  }
+  catch (modelMsg & msg)
+  {
+    throw(msg);
+  } //non-fatal error
+  catch (...)
+  {
+    modelErr stcErr;
+    stcErr.iErrorCode = UNKNOWN;
+    stcErr.sFunction = "clTreePopulation::CompactTreeColumns" ;
+    throw(stcErr);
+  }
+}
+
+
 //////////////////////////////////////////////////////////////////////////////
 // CreateTreesFromTextTreeMap()
 //////////////////////////////////////////////////////////////////////////////
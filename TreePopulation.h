@@ -7,14 +7,26 @@
 #include "Constants.h"
 #include "ModelMath.h"
 #include <string.h>
+#include <math.h>
 #include <sstream>
 
 class clAllometry;
 class clGhostTreePopulation;
+class clTreeQuery;
+class clTreeSnapshot;
 
 #define MINDIAM 0.001
 #define MINHEIGHT 0.001
 #define MINCROWN 0.001
+/**Number of trees allocated at once when a tree pool runs dry*/
+#define TREE_SLAB_SIZE 256
+/**Hash table cells with fewer trees than this are always sorted with an
+insertion sort*/
+#define HASH_SORT_MIN_BULK 64
+/**When sorting a bigger hash table cell with an insertion sort, if the trees
+have been shifted more than this many places per tree, it is finished with a
+merge sort instead*/
+#define HASH_SORT_MOVE_RATIO 64
 
 using namespace whyDead;
 /**
@@ -54,6 +66,13 @@ using namespace whyDead;
 * leave it to the compiler to turn my divisions into shifts - makes the code
 * easier to read.)
 *
+* Tree float, int, and bool data members are stored here rather than in the
+* trees themselves. Each species/type combo has one contiguous column per
+* registered data member, and each tree holds a slot index into the columns
+* for its species and type. Slots are renumbered in hash table order at the
+* end of each timestep, so behaviors walking the hash table read values
+* sequentially.
+*
 * Copyright 2003 Charles D. Canham.
 * @author Lora E. Murphy
 *
@@ -61,11 +80,41 @@ using namespace whyDead;
 * <br>-----------------
 * <br>October 20, 2011 - Wiped the slate clean for SORTIE 7.0 (LEM)
 * <br>November 12, 2012 - Chars became strings (LEM)
+* <br>October 17, 2026 - Added columnar storage of tree data members (agent)
+* <br>October 17, 2026 - Trees are handed out from per-species/type slab pools
+* and recycled instead of being deleted (agent)
+* <br>October 17, 2026 - Added Find() taking a clTreeQuery; the string form
+* now parses into one (agent)
+* <br>October 17, 2026 - Added caller-owned, re-armable searches and a search
+* epoch to mark them stale (agent)
+* <br>October 17, 2026 - Added ForEachNeighbor() (agent)
+* <br>October 17, 2026 - Added interned data member handles and unchecked
+* code tables for core data members (agent)
+* <br>October 17, 2026 - SortHashTable() picks between in-place repair and
+* a bulk sort for each cell (agent)
+* <br>October 17, 2026 - The hash table cell size can be set in the parameter
+* file or chosen from the behaviors' neighborhood search radii (agent)
+* <br>October 17, 2026 - Added GetSnapshot() for behaviors that only read
+* trees (agent)
+* <br>October 17, 2026 - Setting a tree's height or diameter clears its
+* remembered crown radius and depth (agent)
+* <br>October 17, 2026 - A sapling's or adult's size change marks its
+* neighbors' remembered crowns out of date if NCI crown functions are in use;
+* added CrownsDirty() and ClearDirtyCrowns() (agent)
+* <br>October 17, 2026 - Added GetStreamKey(), moved from clMortalityOrg so
+* that every behavior keys a tree's random streams the same way (agent)
+* <br>October 17, 2026 - Each hash cell remembers the tree epoch of its last
+* change; added GetTreeEpoch(), GetCellChangeEpoch() and
+* SetSizeChangeTolerance() (agent)
+* <br>October 17, 2026 - GetGridCellSize() is the 8 m standard grid again;
+* added GetHashCellLength() for the hash table cell length (agent)
 */
 class clTreePopulation : public clPopulationBase {
   friend class clTreeSearch;
+  friend class clTreeSnapshot;
   friend class clTree;
   friend class clAllometry;
+  friend class clGhostTreePopulation;
 
   private:
   /**
@@ -136,12 +185,154 @@ class clTreePopulation : public clPopulationBase {
   * If no trees are found as the result of a search, the NextTree() method of
   * the returned treeSearch object returns NULL.
   *
+  * This form parses the string into a clTreeQuery and passes it to the typed
+  * form of Find(). Code that searches repeatedly should build a clTreeQuery
+  * once and use the typed form directly.
+  *
   * @param sArgs String with query terms for the search.
   * @throws Error if the query cannot be understood, such as an unrecognized
   * argument or text that cannot be turned into a number.
   */
   clTreeSearch* Find(std::string sArgs);
 
+  /**
+  * Acquires trees which meet the criteria in an already-built query. This
+  * works the same as the string form of Find() but does no parsing.
+  *
+  * @param oQuery Search criteria.
+  * @return Search object. Use its NextTree() method to get trees.
+  * @throws Error if the criteria are not a valid combination or if a
+  * distance/height center point is outside the plot.
+  */
+  clTreeSearch* Find(const clTreeQuery &oQuery);
+
+  /**
+  * Arms a caller-owned search object with a query. The search is not put on
+  * the list of open searches and the population never deletes it, so it can
+  * be kept as a member or on the stack and re-armed for each target tree
+  * without using more memory. A caller-owned search kept across timesteps
+  * returns no trees until it is armed again, since the trees it pointed to
+  * may be gone.
+  *
+  * @param oQuery Search criteria.
+  * @param p_oSearch Search object to arm. Use its NextTree() method to get
+  * trees.
+  * @throws Error if the criteria are not a valid combination or if a
+  * distance/height center point is outside the plot.
+  */
+  void Find(const clTreeQuery &oQuery, clTreeSearch *p_oSearch);
+
+  /**
+  * Calls a function object once for each tree within a given distance of a
+  * point. This finds the same trees as a distance/height search, but walks the
+  * hash table cells directly instead of handing trees out one at a time
+  * through a clTreeSearch, so the compiler can inline the function object
+  * into the loop.
+  *
+  * The function object is called as fn(p_oTree, fDistanceSq), where
+  * fDistanceSq is the squared distance from the point to the tree, corrected
+  * for torus wrapping. Each tree is visited once. The function object must not
+  * add, remove, or move trees.
+  *
+  * If the tree snapshot is current (see GetSnapshot()), the search runs over
+  * the snapshot's packed arrays with clTreeSnapshot::ForEachNeighbor(), which
+  * tests trees four at a time. Otherwise it follows the hash table's lists.
+  * The trees visited, and their order, are the same either way. This never
+  * builds the snapshot, so it is safe to call from many threads at once; a
+  * behavior that wants the faster search should call GetSnapshot() before
+  * starting. This is defined in TreeSnapshot.h, which is included at the end
+  * of this file.
+  *
+  * @param fX X coordinate of the point.
+  * @param fY Y coordinate of the point.
+  * @param fRadius Maximum distance from the point, in meters.
+  * @param fMinHeight Trees must be taller than this, in meters. Can be zero.
+  * @param iTypeMask Which types to visit, as bits flipped by type number
+  * (1 << clTreePopulation::adult, and so on). Pass 0 to visit all types.
+  * @param fn Function object to call for each tree.
+  * @throws Error if the radius or height is negative or if the point is
+  * outside the plot.
+  */
+  template <class Visitor>
+  void ForEachNeighbor(float fX, float fY, float fRadius, float fMinHeight,
+      int iTypeMask, Visitor &fn);
+
+  /**
+  * Gets the number of searches currently on the open searches list.
+  * @return Number of open population-owned searches.
+  */
+  long GetNumOpenSearches() {return m_lNumOpenSearches;};
+
+  /**
+  * Gets a read-only snapshot of every tree in the hash table, packed into
+  * arrays and ordered by hash table cell. The snapshot is built the first
+  * time it is asked for and rebuilt only when a tree has changed since; see
+  * clTreeSnapshot for what counts as a change. The population owns the
+  * snapshot.
+  * @return Up-to-date snapshot.
+  */
+  clTreeSnapshot* GetSnapshot();
+
+  /**
+  * Gets the tree epoch. This moves on whenever a tree is added to or removed
+  * from the hash table, changes type, or has its height, diameter, or dead
+  * code set.
+  * @return Tree epoch.
+  */
+  unsigned long GetTreeEpoch() {return m_lTreeEpoch;};
+
+  /**
+  * Gets the tree epoch at the last change to the trees in a hash cell. A cell
+  * changes when a tree in it is added, removed, changes type or has its dead
+  * code set, or when the height and diameter changes in it since it last
+  * changed add up to more than the size change tolerance (see
+  * SetSizeChangeTolerance()). A behavior can save GetTreeEpoch() and later
+  * find the cells that have changed since, which are the ones whose value
+  * here is greater.
+  * @param iX Hash cell number in the X direction.
+  * @param iY Hash cell number in the Y direction.
+  * @return Tree epoch of the cell's last change.
+  */
+  unsigned long GetCellChangeEpoch(int iX, int iY)
+      {return mp_lCellChangeEpoch[iX * m_iNumYCells + iY];};
+
+  /**
+  * Gets the key for a tree's random streams.  This comes from the tree's
+  * coordinates, species and type, so it stays the same for the life of the
+  * tree whatever order trees are found in.
+  * @param p_oTree Tree.
+  * @return Key, for clModelMath::SetRandomStream().
+  */
+  uint32_t GetStreamKey(clTree *p_oTree);
+
+  /**
+  * Gets whether any remembered crowns may be out of date because a nearby
+  * sapling or adult changed size. Only NCI crowns depend on neighbors, so
+  * this is never true unless a species uses an NCI crown function.
+  * @return Whether ClearDirtyCrowns() has anything to do.
+  */
+  bool CrownsDirty() {return m_bCrownsDirty;};
+
+  /**
+  * Clears the remembered crown radius and depth of every sapling, adult and
+  * snag within NCI crown reach (see clAllometry::GetNCICrownReach()) of a
+  * hash cell where a sapling or adult has changed size since the last call.
+  * Each cell is walked once no matter how many size changes are near it.
+  * This writes to trees, so don't call it from inside a parallel loop.
+  */
+  void ClearDirtyCrowns();
+
+  /**
+  * Sets how much tree heights and diameters in a hash cell must change, as
+  * proportions of their old values added up since the cell last changed,
+  * before the cell counts as changed again. The default is 0, so that any
+  * change counts. This does not affect the snapshot, which is out of date
+  * after any change.
+  * @param fTolerance Size change tolerance, as a proportion.
+  */
+  void SetSizeChangeTolerance(float fTolerance)
+      {m_fSizeChangeTolerance = fTolerance;};
+
   /**
   * Creates a new tree and organizes it into the hash table.
   * If this is supposed to be a seedling, and the diam10 creates a height taller
@@ -343,6 +534,114 @@ class clTreePopulation : public clPopulationBase {
   */
   short int GetBoolDataCode(std::string sLabel, int iSpecies, int iType);
 
+  /**
+  * Gets a handle for an integer tree data member label. The label is looked
+  * up once, here; after that, GetIntCode() turns the handle into the data
+  * member code for any species and type with a simple array read. The same
+  * label always gets the same handle, and the handle stays good for the life
+  * of the population, including across later registrations of the label.
+  *
+  * @param sLabel The data member's label.
+  * @return Handle.
+  * @throw BAD_DATA error if the label is empty.
+  */
+  int GetIntDataHandle(std::string sLabel);
+
+  /**
+  * Gets a handle for a float tree data member label. See GetIntDataHandle().
+  *
+  * @param sLabel The data member's label.
+  * @return Handle.
+  * @throw BAD_DATA error if the label is empty.
+  */
+  int GetFloatDataHandle(std::string sLabel);
+
+  /**
+  * Gets a handle for a bool tree data member label. See GetIntDataHandle().
+  *
+  * @param sLabel The data member's label.
+  * @return Handle.
+  * @throw BAD_DATA error if the label is empty.
+  */
+  int GetBoolDataHandle(std::string sLabel);
+
+  /**
+  * Gets the code for an integer tree data member from its handle. Nothing is
+  * validated, so only pass handles from GetIntDataHandle() and good species
+  * and types.
+  * @param iHandle Handle from GetIntDataHandle().
+  * @param iSpecies The species.
+  * @param iType The tree type.
+  * @return Data member code, or -1 if it isn't registered for this species
+  * and type.
+  */
+  short int GetIntCode(int iHandle, int iSpecies, int iType)
+    {return m_intHandles.p_iCodes[iHandle][iSpecies][iType];};
+
+  /**
+  * Gets the code for a float tree data member from its handle. Nothing is
+  * validated, so only pass handles from GetFloatDataHandle() and good species
+  * and types.
+  * @param iHandle Handle from GetFloatDataHandle().
+  * @param iSpecies The species.
+  * @param iType The tree type.
+  * @return Data member code, or -1 if it isn't registered for this species
+  * and type.
+  */
+  short int GetFloatCode(int iHandle, int iSpecies, int iType)
+    {return m_floatHandles.p_iCodes[iHandle][iSpecies][iType];};
+
+  /**
+  * Gets the code for a bool tree data member from its handle. Nothing is
+  * validated, so only pass handles from GetBoolDataHandle() and good species
+  * and types.
+  * @param iHandle Handle from GetBoolDataHandle().
+  * @param iSpecies The species.
+  * @param iType The tree type.
+  * @return Data member code, or -1 if it isn't registered for this species
+  * and type.
+  */
+  short int GetBoolCode(int iHandle, int iSpecies, int iType)
+    {return m_boolHandles.p_iCodes[iHandle][iSpecies][iType];};
+
+  /**
+  * Gets the table of codes for the "dead" integer data member, which is
+  * registered by mortality behaviors. The table can be cached at setup and
+  * read directly in tree loops, without the validation done by
+  * GetIntDataCode(). It is filled in as registrations happen.
+  * @return Code table, sized number of species by number of types. Entries
+  * are -1 where "dead" is not registered.
+  */
+  short int **GetDeadCodes() {return m_intHandles.p_iCodes[m_iDeadHandle];};
+
+  /**
+  * Gets the table of codes for the "X" data member, for reading without the
+  * validation done by GetXCode().
+  * @return Code table, sized number of species by number of types.
+  */
+  short int **GetXCodes() {return mp_iXCode;};
+
+  /**
+  * Gets the table of codes for the "Y" data member, for reading without the
+  * validation done by GetYCode().
+  * @return Code table, sized number of species by number of types.
+  */
+  short int **GetYCodes() {return mp_iYCode;};
+
+  /**
+  * Gets the table of codes for the "DBH" data member, for reading without the
+  * validation done by GetDbhCode().
+  * @return Code table, sized number of species by number of types.
+  */
+  short int **GetDbhCodes() {return mp_iDbhCode;};
+
+  /**
+  * Gets the table of codes for the "Height" data member, for reading without
+  * the validation done by GetHeightCode().
+  * @return Code table, sized number of species by number of types.
+  */
+  short int **GetHeightCodes() {return mp_iHeightCode;};
+
   /**
   * Gets the label for an integer tree data member. This function will not be
   * responsible for duplicate labels.
@@ -404,13 +703,34 @@ class clTreePopulation : public clPopulationBase {
 
   /**
    * Sorts the hash table by height.
-   * This does a complete sort of the entire hash table using the Insertion Sort
-   * algorithm, which is good for almost-sorted datasets, which the hash table
-   * probably will be. This function will be used to sort the hash table if a
-   * behavior has been updating trees and has let them get out of order.
+   * This function will be used to sort the hash table if a behavior has been
+   * updating trees and has let them get out of order.
+   *
+   * Each cell's trees are gathered into an array along with their heights,
+   * checking whether any neighboring pairs are out of order. A cell with none
+   * is left as it is. Otherwise the cell is repaired with an insertion sort,
+   * which is fastest when trees have only moved a few places, as after
+   * growth. If a cell of HASH_SORT_MIN_BULK or more trees turns out to need
+   * more than HASH_SORT_MOVE_RATIO shifts per tree, such as after its trees
+   * have been shuffled, the insertion sort stops and the cell is bulk sorted
+   * with a merge sort. Both sorts are stable, so trees of equal height keep
+   * their order. The cell's links and height division pointers are then
+   * rebuilt in one pass.
    */
   void SortHashTable();
 
+  /**
+  * Gets the number of hash table cells repaired with an insertion sort.
+  * @return Number of cells repaired.
+  */
+  long GetNumCellsRepaired() {return m_lNumCellsRepaired;};
+
+  /**
+  * Gets the number of hash table cells bulk sorted with a merge sort.
+  * @return Number of cells bulk sorted.
+  */
+  long GetNumCellsBulkSorted() {return m_lNumCellsBulkSorted;};
+
   /**
   * Gets a random diameter at 10 cm value for a seedling. This function
   * slightly randomizes the diameter at 10 cm value around a "seed" value.
@@ -541,11 +861,23 @@ class clTreePopulation : public clPopulationBase {
   int GetNumberOfTypes() {return m_iNumTypes;};
 
   /**
-  * Gets the tree population internal grid cell size (grids are square).
+  * Gets the standard grid cell size (grids are square). This is the default
+  * cell size for grids that behaviors create and for output subplots. It is
+  * always 8 m, whatever the size of the hash table cells.
   *
   * @return Grid cell size in meters.
   */
-  int GetGridCellSize() {return m_iLengthGrids;};
+  int GetGridCellSize() {return m_iGridCellSize;};
+
+  /**
+  * Gets the length of the tree population's internal hash table cells
+  * (cells are square). Use this, not GetGridCellSize(), with the cell
+  * numbers of GetNumXCells(), GetNumYCells(), and the functions that find
+  * trees by hash table cell.
+  *
+  * @return Hash table cell length in meters.
+  */
+  int GetHashCellLength() {return m_iLengthGrids;};
 
   /**
   * Gets the number of cells in the X direction for the tree population's
@@ -661,6 +993,33 @@ class clTreePopulation : public clPopulationBase {
   */
   clTree* GetFirstStump(){return mp_oStumps;};
 
+  /**
+  * Gets the number of tree slabs that have been allocated. Each slab holds
+  * TREE_SLAB_SIZE trees.
+  * @return Number of tree slabs.
+  */
+  long GetNumTreeSlabs() {return m_lNumTreeSlabs;};
+
+  /**
+  * Gets the number of trees that have been handed out by the tree pools,
+  * including recycled ones.
+  * @return Number of trees handed out.
+  */
+  long GetNumTreesAllocated() {return m_lNumTreesAllocated;};
+
+  /**
+  * Gets the number of trees that have been handed out by the tree pools that
+  * were recycled from trees that had been killed or removed.
+  * @return Number of recycled trees handed out.
+  */
+  long GetNumTreesRecycled() {return m_lNumTreesRecycled;};
+
+  /**
+  * Gets the number of times a set of data member columns had to grow.
+  * @return Number of column grows.
+  */
+  long GetNumColumnGrows() {return m_lNumColumnGrows;};
+
 ///////////////////////////////////////////////////////////////////////////
 //                            PROTECTED
 ///////////////////////////////////////////////////////////////////////////
@@ -698,8 +1057,12 @@ class clTreePopulation : public clPopulationBase {
   int m_iNumYCells; /**<Mumber of tree population internal grid cells in the
         Y direction.*/
   int m_iNumSizeClasses; /**<Number of tree size classes defined.*/
-  int m_iLengthGrids; /**<Length of internal grid cells, in meters. Make
-        this always a power of 2!*/
+  int m_iGridCellSize; /**<Standard grid cell length, in meters - always 8*/
+  int m_iLengthGrids; /**<Length of internal grid cells, in meters. Defaults
+        to m_iGridCellSize. This can be set with the optional tr_hashCellSize parameter; a
+        value of 0 means choose it with ChooseGridCellSize().*/
+  float m_fInvLengthGrids; /**<1 / m_iLengthGrids, so that finding a grid cell
+        is a multiply whatever the cell size*/
   bool m_bDoUpdates; /**<Whether or not to sort the hash table when DoDataUpdates
                    is called.*/
   bool *mp_bMakeStump; /**<Whether a harvested tree should be made into a stump,
@@ -758,6 +1121,143 @@ class clTreePopulation : public clPopulationBase {
   short int *mp_iWhyDeadCode; /**<Codes for "Why dead" snag tree data member.
         Array size is number of species.*/
 
+  float ****mp_fFloatColumns; /**<Columnar storage of tree float data members.
+        Array size is number of species by number of types by number of float
+        data members by column capacity. A tree's values are at its slot.*/
+  int ****mp_iIntColumns; /**<Columnar storage of tree int data members.
+        Array size is number of species by number of types by number of int
+        data members by column capacity. A tree's values are at its slot.*/
+  bool ****mp_bBoolColumns; /**<Columnar storage of tree bool data members.
+        Array size is number of species by number of types by number of bool
+        data members by column capacity. A tree's values are at its slot.*/
+  int **mp_iColumnCapacity; /**<Number of slots allocated in the data member
+        columns. Array size is number of species by number of types.*/
+  int **mp_iNumColumnSlots; /**<Number of slots that have ever been handed
+        out since the columns were last compacted. Array size is number of
+        species by number of types.*/
+  int ***mp_iFreeSlots; /**<Stack of released slots available for re-use.
+        Array size is number of species by number of types by column
+        capacity.*/
+  int **mp_iNumFreeSlots; /**<Number of slots on the free slot stack. Array
+        size is number of species by number of types.*/
+
+  /**For keeping track of tree slabs so they can be deleted.*/
+  struct stcTreeSlab {
+    clTree *p_oTrees; /**<Array of TREE_SLAB_SIZE trees*/
+    stcTreeSlab *p_nextSlab; /**<Pointer to the next slab on the list*/
+  } *mp_treeSlabs; /**<Linked list of all tree slabs*/
+  clTree ***mp_oFreeTrees; /**<Linked lists, through the tree's mp_oNext
+        pointer, of pooled trees ready to be handed out. Trees are pooled by
+        the species and type they had when freed, so their string arrays are
+        already the right size. Array size is number of species by number of
+        types.*/
+  long m_lNumTreeSlabs; /**<Number of tree slabs allocated*/
+  long m_lNumTreesAllocated; /**<Number of trees handed out by the pools*/
+  long m_lNumTreesRecycled; /**<Number of recycled trees handed out*/
+  long m_lNumColumnGrows; /**<Number of times data member columns grew*/
+  long m_lNumCellsRepaired; /**<Number of hash cells repaired in place*/
+  long m_lNumCellsBulkSorted; /**<Number of hash cells bulk sorted*/
+  clTree **mp_oSortTrees; /**<Scratch space for SortHashTable(): a cell's
+        trees. Array size is m_iSortCapacity times 2; the second half is for
+        merging.*/
+  float *mp_fSortHeights; /**<Scratch space for SortHashTable(): heights
+        matching mp_oSortTrees. Array size is m_iSortCapacity times 2.*/
+  int m_iSortCapacity; /**<Number of trees the sort scratch space can hold*/
+  long m_lNumOpenSearches; /**<Number of searches on mp_openSearches*/
+  unsigned long m_lSearchEpoch; /**<Search epoch. This moves on whenever the
+        trees in the hash table may have been freed, which makes any search
+        armed before then stale.*/
+  unsigned long m_lTreeEpoch; /**<Tree epoch. This moves on whenever a tree is
+        added to or removed from the hash table, changes type, or has its
+        height, diameter, or dead code set, which makes the snapshot stale.*/
+  clTreeSnapshot *mp_oSnapshot; /**<Tree snapshot, or NULL if none has been
+        asked for yet*/
+  unsigned long *mp_lCellChangeEpoch; /**<Tree epoch of the last change to
+        each hash cell. Array size is m_iNumXCells * m_iNumYCells, X-major.*/
+  float *mp_fCellSizeChange; /**<Proportional height and diameter changes
+        added up in each hash cell since the cell last changed. Array size is
+        m_iNumXCells * m_iNumYCells, X-major.*/
+  float m_fSizeChangeTolerance; /**<Proportional height or diameter change
+        that counts as a change to a tree's hash cell*/
+  bool *mp_bCrownCellDirty; /**<Whether each hash cell has had a sapling or
+        adult change size since the crowns around it were last cleared. Array
+        size is m_iNumXCells * m_iNumYCells, X-major.*/
+  bool m_bCrownsDirty; /**<Whether any of mp_bCrownCellDirty is true*/
+
+  /**
+  * Gets the hash table rows and the starting height division to walk in
+  * ForEachNeighbor(). The rows are not corrected for torus wrapping, and
+  * there are never more of them than there are rows in the hash table.
+  * @param fX X coordinate of the point.
+  * @param fY Y coordinate of the point.
+  * @param fRadius Search radius, in meters.
+  * @param fMinHeight Minimum tree height, in meters.
+  * @param iMinY Set to the first row to walk.
+  * @param iMaxY Set to the last row to walk.
+  * @param iStartDiv Set to the first height division to walk.
+  * @throws BAD_DATA error if the radius or height is negative or if the point
+  * is outside the plot.
+  */
+  void GetNeighborRows(float fX, float fY, float fRadius, float fMinHeight,
+      int &iMinY, int &iMaxY, int &iStartDiv);
+
+  /**
+  * Gets the hash table cells to walk in one row in ForEachNeighbor(). Only
+  * the cells that the search circle reaches in that row are included. The
+  * cells are not corrected for torus wrapping, and there are never more of
+  * them than there are cells in the row.
+  * @param fX X coordinate of the point.
+  * @param fY Y coordinate of the point.
+  * @param fRadius Search radius, in meters.
+  * @param iY Row, corrected for torus wrapping.
+  * @param iMinX Set to the first cell to walk.
+  * @param iMaxX Set to the last cell to walk.
+  */
+  void GetNeighborColumns(float fX, float fY, float fRadius, int iY,
+      int &iMinX, int &iMaxX);
+
+  /**
+  * Gets the hash table cell that holds a coordinate that may be off the plot
+  * by less than one plot length. The cell number is not corrected for torus
+  * wrapping: a coordinate below zero gives a negative cell, and a coordinate
+  * past the plot length gives a cell past the last one. This takes short end
+  * cells into account.
+  * @param fCoord Coordinate.
+  * @param fPlotLength Plot length in that direction.
+  * @param iNumCells Number of hash table cells in that direction.
+  * @return Uncorrected cell number.
+  */
+  int GetUncorrectedCell(float fCoord, float fPlotLength, int iNumCells);
+
+  /**
+  * Gets the hash table cell that holds a coordinate on the plot. A coordinate
+  * equal to the plot length goes in the last cell; anything off either end
+  * goes in the nearest cell.
+  * @param fCoord Coordinate, between 0 and the plot length.
+  * @param iNumCells Number of hash table cells in that direction.
+  * @return Cell number.
+  */
+  int GetHashCell(float fCoord, int iNumCells) {
+    int iCell = (int)(fCoord * m_fInvLengthGrids);
+    if (iCell < 0) return 0;
+    return iCell < iNumCells ? iCell : iNumCells - 1;
+  };
+
+  /**
+  * Settles the hash table cell size. If the parameter file asked for the
+  * size to be chosen automatically, each behavior is asked for its largest
+  * neighborhood search radius with clBehaviorBase::GetNeighborSearchRadius(),
+  * and the cell size is set to half of the largest radius, rounded up. A
+  * search then covers about five cells across, which keeps both the number
+  * of cells visited and the number of trees outside the circle small. If no
+  * behavior searches neighborhoods, the default of 8 m is kept. The size is
+  * kept between 2 m and the shorter plot dimension. Then m_fInvLengthGrids is
+  * calculated. Call after ReadParameters() and SetupCalculations(), and
+  * before CreateHashTable().
+  * @param p_oDoc Parsed parameter file.
+  */
+  void ChooseGridCellSize(xercesc::DOMDocument *p_oDoc);
+
   /**
    * Triggers the tree data member registration process for all behaviors.
    */
@@ -773,6 +1273,7 @@ class clTreePopulation : public clPopulationBase {
   * <li>DoTreeDataStructureSetup() to create the tree data structure;</li>
   * <li>DoDataMemberRegistrations() to perform the data member
   * registrations;</li>
+  * <li>CreateTreeColumns() to allocate tree data member storage;</li>
   * <li>CreateTreesFromInitialDensities() and CreateTreesFromTreeMap() to
   * create trees.</li>
   * </ul>
@@ -791,6 +1292,7 @@ class clTreePopulation : public clPopulationBase {
   * <li>Deletes all stumps.</li>
   * <li>Updates the ages of all snags in years.</li>
   * <li>Resets all crown radius and depth values to -1.</li>
+  * <li>Compacts the tree data member columns into hash table order.</li>
   * </ul>
   */
   void TimestepCleanup();
@@ -807,6 +1309,14 @@ class clTreePopulation : public clPopulationBase {
   */
   void SetupCalculations();
 
+  /**
+  * Sorts a hash table cell's trees, already gathered into mp_oSortTrees and
+  * mp_fSortHeights, from shortest to tallest with a stable bottom-up merge
+  * sort.
+  * @param iNumTrees Number of trees gathered.
+  */
+  void MergeSortCell(int iNumTrees);
+
   /**
   * Allocates memory for the hash table. GetPlotDimensions() must be called
   * first.
@@ -814,6 +1324,38 @@ class clTreePopulation : public clPopulationBase {
   void CreateHashTable();
 
 
+  /**Interned data member labels and their code tables, for one kind of
+   * data member.*/
+  struct stcDataHandles {
+    std::string *p_sLabels; /**<Label for each handle*/
+    short int ***p_iCodes; /**<Code table for each handle. Array size is
+          number of handles by number of species by number of types.*/
+    int iNumHandles; /**<Number of handles in use*/
+    int iCapacity; /**<Size of the arrays*/
+  } m_intHandles, /**<Integer data member handles*/
+    m_floatHandles, /**<Float data member handles*/
+    m_boolHandles; /**<Bool data member handles*/
+  int m_iDeadHandle; /**<Handle for the "dead" integer data member*/
+
+  /**
+   * Does the work for the GetXDataHandle() functions. If the label is new,
+   * its code table is filled from the labels registered so far.
+   * @param sLabel Label.
+   * @param oHandles Handles for this kind of data member.
+   * @param p_iNumTreeVals Pointer to the correct mp_iNumTree[x]Vals array
+   * @param p_sLabels Pointer to the correct mp_s[x]Labels array
+   * @return Handle.
+   * @throw BAD_DATA error if the label is empty.
+   */
+  int GetDataHandle(std::string sLabel, stcDataHandles &oHandles,
+      short int **p_iNumTreeVals, std::string ***p_sLabels);
+
+  /**
+   * Frees the memory of a set of data member handles.
+   * @param oHandles Handles to free.
+   */
+  void DeleteDataHandles(stcDataHandles &oHandles);
+
   /**
    * Core function for registering new tree data members.
    * @param sLabel Name of the new data member.
@@ -822,13 +1364,16 @@ class clTreePopulation : public clPopulationBase {
    * data member
    * @param p_iNumTreeVals Pointer to the correct mp_iNumTree[x]Vals array
    * @param p_sLabels Pointer to the correct mp_s[x]Labels array
+   * @param p_oHandles Handles for this kind of data member, to be updated if
+   * the label has one. NULL if this kind of data member has no handles.
    * @return Code that will be used to access values of that type in the future
    * for that species/type combo. This is faster than trying to do lookups
    * by character string.
    * @throw BAD_DATA or ILLEGAL_OP error if the registration was unsuccessful.
    */
   short int RegisterDataMember(std::string sLabel, int iSpecies, int iType,
-   short int **p_iNumTreeVals, std::string ***p_sLabels);
+   short int **p_iNumTreeVals, std::string ***p_sLabels,
+   stcDataHandles *p_oHandles);
 
   /**
    * Queries all behaviors for data members that they wish to add to the tree's
@@ -928,12 +1473,146 @@ class clTreePopulation : public clPopulationBase {
   */
   void RemoveTreeFromHashTable(clTree *p_oByeTree);
 
+  /**
+  * Marks the hash cell a tree is in as changed at the current tree epoch.
+  * Move the tree epoch on first. The tree's coordinates must already have
+  * been checked to be in the plot.
+  * @param p_oTree Tree whose cell has changed.
+  */
+  void MarkCellChanged(clTree *p_oTree);
+
+  /**
+  * Adds a tree's height or diameter change to the changes in its hash cell
+  * since the cell last changed, and marks the cell as changed if they add up
+  * to more than the size change tolerance. With no tolerance, any change
+  * marks the cell. Move the tree epoch on first.
+  * @param p_oTree Tree whose size is changing.
+  * @param fOldValue Old height or diameter.
+  * @param fNewValue New height or diameter.
+  */
+  void AddCellSizeChange(clTree *p_oTree, float fOldValue, float fNewValue);
+
+  /**
+  * Marks a tree's hash cell as holding a size change that its neighbors'
+  * NCI crowns haven't seen yet. Call this when a sapling's or adult's size
+  * changes, since NCI crowns depend on neighbor DBH. Does nothing if no
+  * species uses an NCI crown function.
+  * @param p_oTree Tree whose size is changing.
+  */
+  void MarkCrownCellDirty(clTree *p_oTree);
+
   /**
   * Deletes stumps from the stump linked list and sets the linked list pointer
   * to NULL.
   */
   void DeleteStumps();
 
+  /**
+  * Allocates the free tree lists for the tree pools.
+  */
+  void CreateTreePools();
+
+  /**
+  * Deletes all tree slabs. Any tree not already returned to the pools is
+  * deleted too, so this should only be called at the very end.
+  */
+  void DeleteTreePools();
+
+  /**
+  * Hands out a tree from the pools. If there are no pooled trees for the
+  * species and type, a new slab is allocated. The tree gets a data member
+  * slot with all values zeroed and a cleared string array.
+  * @param iSpecies Species of the tree.
+  * @param iType Type of the tree.
+  * @return Tree.
+  */
+  clTree* AllocateTree(int iSpecies, int iType);
+
+  /**
+  * Returns a tree to the pools. Its data member slot is released. The tree
+  * must already be out of the hash table and the stump list.
+  * @param p_oTree Tree to free.
+  */
+  void FreeTree(clTree *p_oTree);
+
+  /**
+  * Allocates the data member columns. DoTreeDataStructureSetup() must be
+  * called first so that the number of data members for each species/type is
+  * known.
+  */
+  void CreateTreeColumns();
+
+  /**
+  * Frees the data member columns. All trees must already be deleted.
+  */
+  void DeleteTreeColumns();
+
+  /**
+  * Hands out a slot in the data member columns for a new tree. Released slots
+  * are re-used first; if there are none, the columns are grown as needed. All
+  * values in the slot are set to 0 and false.
+  * @param iSpecies Species of the tree.
+  * @param iType Type of the tree.
+  * @return Slot index.
+  */
+  int AllocateTreeSlot(int iSpecies, int iType);
+
+  /**
+  * Returns a tree's slot to the free slot stack.
+  * @param iSpecies Species of the tree.
+  * @param iType Type of the tree.
+  * @param iSlot Slot to release.
+  */
+  void ReleaseTreeSlot(int iSpecies, int iType, int iSlot);
+
+  /**
+  * Doubles the capacity of the columns for one species/type combo.
+  * @param iSpecies Species to grow.
+  * @param iType Type to grow.
+  */
+  void GrowTreeColumns(int iSpecies, int iType);
+
+  /**
+  * Renumbers the slots of all trees, in hash table order, so that trees next
+  * to each other in the hash table are next to each other in the columns.
+  * Stumps are numbered after the hash table trees. This empties the free slot
+  * stacks.
+  */
+  void CompactTreeColumns();
+
+  /**
+  * Gets a reference to a tree's float value in the columns. No checking is
+  * done.
+  * @param p_oTree Tree.
+  * @param iCode Float data member code.
+  * @return Reference to the value.
+  */
+  inline float &TreeFloat(clTree *p_oTree, short int iCode) {
+    return mp_fFloatColumns[p_oTree->m_iSpecies][p_oTree->m_iType][iCode][p_oTree->m_iSlot];
+  }
+
+  /**
+  * Gets a reference to a tree's int value in the columns. No checking is
+  * done.
+  * @param p_oTree Tree.
+  * @param iCode Int data member code.
+  * @return Reference to the value.
+  */
+  inline int &TreeInt(clTree *p_oTree, short int iCode) {
+    return mp_iIntColumns[p_oTree->m_iSpecies][p_oTree->m_iType][iCode][p_oTree->m_iSlot];
+  }
+
+  /**
+  * Gets a reference to a tree's bool value in the columns. No checking is
+  * done.
+  * @param p_oTree Tree.
+  * @param iCode Bool data member code.
+  * @return Reference to the value.
+  */
+  inline bool &TreeBool(clTree *p_oTree, short int iCode) {
+    return mp_bBoolColumns[p_oTree->m_iSpecies][p_oTree->m_iType][iCode][p_oTree->m_iSlot];
+  }
+
   /**
   * Changes a tree's type (life history stage).
   * This will change a tree's type and copy over all the applicable variables.
@@ -1043,6 +1722,10 @@ class clTreePopulation : public clPopulationBase {
   clGhostTreePopulation *mp_oGhosts;
 
 }; //end of class treePopulation
+
+//The snapshot needs the whole population class, and ForEachNeighbor() needs
+//the whole snapshot class
+#include "TreeSnapshot.h"
 //----------------------------------------------------------------------------
 #endif
 
@@ -53,7 +53,11 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode, int iValue)
       stcErr.sMoreInfo = s.str();
       throw(stcErr);
     }
-    p_oTree->mp_iIntValues[iCode] = iValue;
+    TreeInt(p_oTree, iCode) = iValue;
+    if (iCode == GetDeadCodes()[p_oTree->m_iSpecies][p_oTree->m_iType]) {
+      m_lTreeEpoch++;
+      MarkCellChanged(p_oTree);
+    }
   }
   catch (modelErr & err)
   {
@@ -128,7 +132,7 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode, bool bValue
       stcErr.sMoreInfo = s.str();
       throw(stcErr);
     }
-    p_oTree->mp_bBoolValues[iCode] = bValue;
+    TreeBool(p_oTree, iCode) = bValue;
   }
   catch (modelErr & err)
   {
@@ -180,6 +184,22 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
       throw(stcErr);
     }
 
+    //Size changes make the tree snapshot out of date, and the crown
+    //dimensions the allometry object remembered for this tree. The tree's
+    //hash cell changes once the size changes in it since it last changed add
+    //up to more than the tolerance.
+    if (iCode == mp_iHeightCode[iSp][iType] || iCode == mp_iDbhCode[iSp][iType]
+        || iCode == mp_iDiam10Code[iSp][iType]) {
+      m_lTreeEpoch++;
+      AddCellSizeChange(p_oTree, TreeFloat(p_oTree, iCode), fValue);
+      if (-1 != mp_iCrownRadCode[iSp][iType])
+        TreeFloat(p_oTree, mp_iCrownRadCode[iSp][iType]) = -1;
+      if (-1 != mp_iCrownDepthCode[iSp][iType])
+        TreeFloat(p_oTree, mp_iCrownDepthCode[iSp][iType]) = -1;
+      //NCI crowns depend on the DBH of neighboring saplings and adults
+      if (sapling == iType || adult == iType) MarkCrownCellDirty(p_oTree);
+    }
+
     if (bUpdateAllometry)
     {
 
@@ -200,10 +220,10 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
             stcErr.sMoreInfo = "Attempt to set seedling diameter below minimum.";
             throw(stcErr);
           }
-          p_oTree->mp_fFloatValues[iCode] = fValue;
+          TreeFloat(p_oTree, iCode) = fValue;
           //calculate height based on diam10
           fAllomValue = mp_oAllom->CalcSeedlingHeight(fValue, iSp);
-          p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] = fAllomValue;
+          TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) = fAllomValue;
           bAllometryUpdated = true;
         }
         else if (mp_iHeightCode[iSp][iType] == iCode)
@@ -217,19 +237,19 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
             throw(stcErr);
           }
 
-          p_oTree->mp_fFloatValues[iCode] = fValue;
+          TreeFloat(p_oTree, iCode) = fValue;
           //calculate diam10 based on height
           fAllomValue = mp_oAllom->CalcSeedlingDiam10(fValue, iSp);
-          p_oTree->mp_fFloatValues[mp_iDiam10Code[iSp][iType]] = fAllomValue;
+          TreeFloat(p_oTree, mp_iDiam10Code[iSp][iType]) = fAllomValue;
           bAllometryUpdated = true;
         }
         else
         { //this is not an allometric value - just assign it
-          p_oTree->mp_fFloatValues[iCode] = fValue;
+          TreeFloat(p_oTree, iCode) = fValue;
           return;
         }
         //Check to see if this seedling is big enough to be a sapling
-        if (p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] > mp_fMaxSeedlingHeight[iSp])
+        if (TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) > mp_fMaxSeedlingHeight[iSp])
         {
           //Re-do the allometry based on sapling equations, keeping constant the
           //thing that was assigned
@@ -239,7 +259,7 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
             fAllomValue = mp_oAllom->ConvertDiam10ToDbh(fValue, iSp);
             //calculate height based on diam10
             fAllomValue = mp_oAllom->CalcSaplingHeight(fAllomValue, iSp);
-            p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] = fAllomValue;
+            TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) = fAllomValue;
 
           }
           else if (mp_iHeightCode[iSp][iType] == iCode)
@@ -248,13 +268,13 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
             fAllomValue = mp_oAllom->CalcSaplingDbh(fValue, iSp);
             //Convert dbh to diam10 and assign
             fAllomValue = mp_oAllom->ConvertDbhToDiam10(fAllomValue, iSp);
-            p_oTree->mp_fFloatValues[mp_iDiam10Code[iSp][iType]] = fAllomValue;
+            TreeFloat(p_oTree, mp_iDiam10Code[iSp][iType]) = fAllomValue;
           }
           ChangeTreeType(p_oTree, sapling);
 
           //Just in case - is the sapling big enough to be an adult?  If so,
           //convert it a second time
-          if (p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][sapling]] >= mp_fMinAdultDbh[iSp])
+          if (TreeFloat(p_oTree, mp_iDbhCode[iSp][sapling]) >= mp_fMinAdultDbh[iSp])
           {
 
             //Convert the type and species codes to sapling
@@ -269,20 +289,20 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
             if (mp_iDiam10Code[iSp][iType] == iCode)
             { //update diam10
               //calculate height based on dbh
-              fAllomValue = mp_oAllom->CalcAdultHeight(p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]], iSp);
-              p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] = fAllomValue;
+              fAllomValue = mp_oAllom->CalcAdultHeight(TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]), iSp);
+              TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) = fAllomValue;
             }
             else if (mp_iHeightCode[iSp][iType] == iCode)
             { //update height
               //calculate dbh based on height
               fAllomValue = mp_oAllom->CalcAdultDbh(fValue, iSp);
-              p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] = fAllomValue;
+              TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) = fAllomValue;
             }
             else if (mp_iDbhCode[iSp][iType] == iCode)
             { //update dbh
               //calculate height based on dbh
               fAllomValue = mp_oAllom->CalcAdultHeight(fValue, iSp);
-              p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] = fAllomValue;
+              TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) = fAllomValue;
             }
             ChangeTreeType(p_oTree, adult);
           }
@@ -305,13 +325,13 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
             stcErr.sMoreInfo = "Attempt to set sapling diameter below minimum.";
             throw(stcErr);
           }
-          p_oTree->mp_fFloatValues[iCode] = fValue;
+          TreeFloat(p_oTree, iCode) = fValue;
           //calculate dbh based on diam10
           fAllomValue = mp_oAllom->ConvertDiam10ToDbh(fValue, iSp);
-          p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] = fAllomValue;
+          TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) = fAllomValue;
           //calculate height based on dbh
           fAllomValue = mp_oAllom->CalcSaplingHeight(fAllomValue, iSp);
-          p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] = fAllomValue;
+          TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) = fAllomValue;
           bAllometryUpdated = true;
 
         }
@@ -329,24 +349,24 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
           if (fValue < mp_fMaxSeedlingHeight[iSp])
           {
             //Assign height
-            p_oTree->mp_fFloatValues[iCode] = fValue;
+            TreeFloat(p_oTree, iCode) = fValue;
             //Re-do the allometry based on seedling equations, keeping height
             //constant
             //calculate diam10 based on height and assign
             fAllomValue = mp_oAllom->CalcSeedlingDiam10(fValue, iSp);
-            p_oTree->mp_fFloatValues[mp_iDiam10Code[iSp][iType]] = fAllomValue;
+            TreeFloat(p_oTree, mp_iDiam10Code[iSp][iType]) = fAllomValue;
             ChangeTreeType(p_oTree, seedling);
             bAllometryUpdated = true;
           }
           else
           { //normal - no shrinking back to seedling - update
-            p_oTree->mp_fFloatValues[iCode] = fValue;
+            TreeFloat(p_oTree, iCode) = fValue;
             //calculate dbh based on height
             fAllomValue = mp_oAllom->CalcSaplingDbh(fValue, iSp);
-            p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] = fAllomValue;
+            TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) = fAllomValue;
             //calculate diam10 based on dbh
             fAllomValue = mp_oAllom->ConvertDbhToDiam10(fAllomValue, iSp);
-            p_oTree->mp_fFloatValues[mp_iDiam10Code[iSp][iType]] = fAllomValue;
+            TreeFloat(p_oTree, mp_iDiam10Code[iSp][iType]) = fAllomValue;
             bAllometryUpdated = true;
           }
 
@@ -360,42 +380,42 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
             stcErr.sMoreInfo = "Attempt to set sapling DBH to negative value.";
             throw(stcErr);
           }
-          p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] = fValue;
+          TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) = fValue;
           //calculate diam10 based on dbh
           fAllomValue = mp_oAllom->ConvertDbhToDiam10(fValue, iSp);
-          p_oTree->mp_fFloatValues[mp_iDiam10Code[iSp][iType]] = fAllomValue;
+          TreeFloat(p_oTree, mp_iDiam10Code[iSp][iType]) = fAllomValue;
           //calculate height based on dbh
           fAllomValue = mp_oAllom->CalcSaplingHeight(fValue, iSp);
-          p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] = fAllomValue;
+          TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) = fAllomValue;
           bAllometryUpdated = true;
         }
         else
         { //this is not an allometric value - just assign it
-          p_oTree->mp_fFloatValues[iCode] = fValue;
+          TreeFloat(p_oTree, iCode) = fValue;
           return;
         }
         //Check to see if this sapling is big enough to be an adult
-        if (p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] >= mp_fMinAdultDbh[iSp])
+        if (TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) >= mp_fMinAdultDbh[iSp])
         {
           //Re-do the allometry based on adult equations, keeping constant the
           //thing that was assigned
           if (mp_iDiam10Code[iSp][iType] == iCode)
           { //update diam10
             //calculate height based on dbh
-            fAllomValue = mp_oAllom->CalcAdultHeight(p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]], iSp);
-            p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] = fAllomValue;
+            fAllomValue = mp_oAllom->CalcAdultHeight(TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]), iSp);
+            TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) = fAllomValue;
           }
           else if (mp_iHeightCode[iSp][iType] == iCode)
           { //update height
             //calculate dbh based on height
             fAllomValue = mp_oAllom->CalcAdultDbh(fValue, iSp);
-            p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] = fAllomValue;
+            TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) = fAllomValue;
           }
           else if (mp_iDbhCode[iSp][iType] == iCode)
           { //update dbh
             //calculate height based on dbh
             fAllomValue = mp_oAllom->CalcAdultHeight(fValue, iSp);
-            p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] = fAllomValue;
+            TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) = fAllomValue;
           }
           ChangeTreeType(p_oTree, adult);
         }
@@ -414,10 +434,10 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
             stcErr.sMoreInfo = "Attempt to set adult height to negative value.";
             throw(stcErr);
           }
-          p_oTree->mp_fFloatValues[iCode] = fValue;
+          TreeFloat(p_oTree, iCode) = fValue;
           //calculate dbh based on height
           fValue = mp_oAllom->CalcAdultDbh(fValue, iSp);
-          p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] = fValue;
+          TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) = fValue;
           bAllometryUpdated = true;
         }
         else if (mp_iDbhCode[iSp][iType] == iCode)
@@ -429,20 +449,20 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
             stcErr.sMoreInfo = "Attempt to set adult DBH to negative value.";
             throw(stcErr);
           }
-          p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] = fValue;
+          TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) = fValue;
           //calculate height based on dbh
           fValue = mp_oAllom->CalcAdultHeight(fValue, iSp);
-          p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] = fValue;
+          TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) = fValue;
           bAllometryUpdated = true;
         }
         else
         { //this is not an allometric value - just assign it
-          p_oTree->mp_fFloatValues[iCode] = fValue;
+          TreeFloat(p_oTree, iCode) = fValue;
           return;
         }
         //Check dbh - smaller than sapling cutoff if adult?  If so, send this back to
         //sapling status
-        if (adult == p_oTree->m_iType && p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] < mp_fMinAdultDbh[iSp])
+        if (adult == p_oTree->m_iType && TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) < mp_fMinAdultDbh[iSp])
         {
           //Re-do the allometry based on sapling equations, keeping constant the
           //thing that was assigned
@@ -450,13 +470,13 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
           { //update dbh
             //calculate height based on dbh
             fAllomValue = mp_oAllom->CalcSaplingHeight(fValue, iSp);
-            p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] = fAllomValue;
+            TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) = fAllomValue;
           }
           else if (mp_iHeightCode[iSp][iType] == iCode)
           { //update height
             //calculate dbh based on height and assign
             fAllomValue = mp_oAllom->CalcSaplingDbh(fValue, iSp);
-            p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] = fAllomValue;
+            TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) = fAllomValue;
           }
           ChangeTreeType(p_oTree, sapling);
         }
@@ -486,7 +506,7 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
         bAllometryUpdated = true;
       }
 
-      p_oTree->mp_fFloatValues[iCode] = fValue;
+      TreeFloat(p_oTree, iCode) = fValue;
 
       //If this is a sapling, and we're updating either DBH or diam10, update
       //the other
@@ -496,17 +516,17 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
         {
           //calculate dbh based on diam10
           fAllomValue = mp_oAllom->ConvertDiam10ToDbh(fValue, iSp);
-          p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] = fAllomValue;
+          TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) = fAllomValue;
         }
         else if (mp_iDbhCode[iSp][iType] == iCode)
         {
           //calculate diam10 based on dbh
           fAllomValue = mp_oAllom->ConvertDbhToDiam10(fValue, iSp);
-          p_oTree->mp_fFloatValues[mp_iDiam10Code[iSp][iType]] = fAllomValue;
+          TreeFloat(p_oTree, mp_iDiam10Code[iSp][iType]) = fAllomValue;
         }
       }
 
-      if (seedling == p_oTree->m_iType && p_oTree->mp_fFloatValues[mp_iHeightCode[iSp][iType]] > mp_fMaxSeedlingHeight[iSp])
+      if (seedling == p_oTree->m_iType && TreeFloat(p_oTree, mp_iHeightCode[iSp][iType]) > mp_fMaxSeedlingHeight[iSp])
       {
         //This height makes the tree taller than the max seedling height
         ChangeTreeType(p_oTree, sapling);
@@ -517,11 +537,11 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
         ChangeTreeType(p_oTree, seedling);
       }
       //Check to see if this sapling is big enough to be an adult
-      else if (sapling == p_oTree->m_iType && p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] >= mp_fMinAdultDbh[iSp])
+      else if (sapling == p_oTree->m_iType && TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) >= mp_fMinAdultDbh[iSp])
       {
         ChangeTreeType(p_oTree, adult);
       }
-      else if (adult == p_oTree->m_iType && p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iType]] < mp_fMinAdultDbh[iSp])
+      else if (adult == p_oTree->m_iType && TreeFloat(p_oTree, mp_iDbhCode[iSp][iType]) < mp_fMinAdultDbh[iSp])
       {
         ChangeTreeType(p_oTree, sapling);
       }
@@ -561,60 +581,42 @@ void clTreePopulation::UpdateTree(clTree * p_oTree, short int iCode,
 void clTreePopulation::ChangeTreeType(clTree * p_oTree, enum iTreeType iNewType) {
   try
   {
-    //Copies of the old arrays
-    float * p_fFloatCopy = NULL;
-    int * p_iIntCopy = NULL;
+    //Copy of the old string array
     string * p_sStringCopy = NULL;
-    bool * p_bBoolCopy = NULL;
     unsigned short int iSp, iOldType, i, j;
+    int iOldSlot, iNewSlot;
 
     iSp = p_oTree->m_iSpecies;
     iOldType = p_oTree->m_iType;
-    //Declare the copy arrays and copy in the tree's values
-    p_fFloatCopy = new float[mp_iNumTreeFloatVals[iSp][iOldType]];
-    for (i = 0; i < mp_iNumTreeFloatVals[iSp][iOldType]; i++)
-      p_fFloatCopy[i] = p_oTree->mp_fFloatValues[i];
-    p_iIntCopy = new int[mp_iNumTreeIntVals[iSp][iOldType]];
-    for (i = 0; i < mp_iNumTreeIntVals[iSp][iOldType]; i++)
-      p_iIntCopy[i] = p_oTree->mp_iIntValues[i];
+    iOldSlot = p_oTree->m_iSlot;
+    m_lTreeEpoch++;
+    MarkCellChanged(p_oTree);
+
+    //Get a slot in the new type's columns - its values start out zeroed
+    iNewSlot = AllocateTreeSlot(iSp, iNewType);
+
+    //Declare the string copy array and copy in the tree's values
     p_sStringCopy = new string[mp_iNumTreeStringVals[iSp][iOldType]];
     for (i = 0; i < mp_iNumTreeStringVals[iSp][iOldType]; i++)
       p_sStringCopy[i] = p_oTree->mp_sStringValues[i];
-    p_bBoolCopy = new bool[mp_iNumTreeBoolVals[iSp][iOldType]];
-    for (i = 0; i < mp_iNumTreeBoolVals[iSp][iOldType]; i++)
-      p_bBoolCopy[i] = p_oTree->mp_bBoolValues[i];
 
-    //Delete out the tree's old variable array and redeclare
-    delete[] p_oTree->mp_fFloatValues; p_oTree->mp_fFloatValues = NULL;
-    delete[] p_oTree->mp_iIntValues; p_oTree->mp_iIntValues = NULL;
+    //Delete out the tree's old string array and redeclare
     delete[] p_oTree->mp_sStringValues; p_oTree->mp_sStringValues = NULL;
-    delete[] p_oTree->mp_bBoolValues; p_oTree->mp_bBoolValues = NULL;
-    p_oTree->mp_fFloatValues = new float[mp_iNumTreeFloatVals[iSp][iNewType]];
-    for (i = 0; i < mp_iNumTreeFloatVals[iSp][iNewType]; i++)
-      p_oTree->mp_fFloatValues[i] = 0.0;
-    p_oTree->mp_iIntValues = new int[mp_iNumTreeIntVals[iSp][iNewType]];
-    for (i = 0; i < mp_iNumTreeIntVals[iSp][iNewType]; i++)
-      p_oTree->mp_iIntValues[i] = 0;
     p_oTree->mp_sStringValues = new string[mp_iNumTreeStringVals[iSp][iNewType]];
     for (i = 0; i < mp_iNumTreeStringVals[iSp][iNewType]; i++)
       p_oTree->mp_sStringValues[i] = "";
 
-    p_oTree->mp_bBoolValues = new bool[mp_iNumTreeBoolVals[iSp][iNewType]];
-    for (i = 0; i < mp_iNumTreeBoolVals[iSp][iNewType]; i++)
-      p_oTree->mp_bBoolValues[i] = false;
-
-    //Assign the new type
-    p_oTree->m_iType = iNewType;
-
     //Now any other values that are present in both types
     for (i = 0; i < mp_iNumTreeIntVals[iSp][iOldType]; i++)
       for (j = 0; j < mp_iNumTreeIntVals[iSp][iNewType]; j++)
         if (mp_sIntLabels[iSp][iNewType][j].compare(mp_sIntLabels[iSp][iOldType][i]) == 0)
-          p_oTree->mp_iIntValues[j] = p_iIntCopy[i];
+          mp_iIntColumns[iSp][iNewType][j][iNewSlot] =
+              mp_iIntColumns[iSp][iOldType][i][iOldSlot];
     for (i = 0; i < mp_iNumTreeFloatVals[iSp][iOldType]; i++)
       for (j = 0; j < mp_iNumTreeFloatVals[iSp][iNewType]; j++)
         if (mp_sFloatLabels[iSp][iNewType][j].compare(mp_sFloatLabels[iSp][iOldType][i]) == 0)
-          p_oTree->mp_fFloatValues[j] = p_fFloatCopy[i];
+          mp_fFloatColumns[iSp][iNewType][j][iNewSlot] =
+              mp_fFloatColumns[iSp][iOldType][i][iOldSlot];
     for (i = 0; i < mp_iNumTreeStringVals[iSp][iOldType]; i++)
       for (j = 0; j < mp_iNumTreeStringVals[iSp][iNewType]; j++)
         if (mp_sStringLabels[iSp][iNewType][j].compare(mp_sStringLabels[iSp][iOldType][i]) == 0)
@@ -622,23 +624,28 @@ void clTreePopulation::ChangeTreeType(clTree * p_oTree, enum iTreeType iNewType)
     for (i = 0; i < mp_iNumTreeBoolVals[iSp][iOldType]; i++)
       for (j = 0; j < mp_iNumTreeBoolVals[iSp][iNewType]; j++)
         if (mp_sBoolLabels[iSp][iNewType][j].compare(mp_sBoolLabels[iSp][iOldType][i]) == 0)
-          p_oTree->mp_bBoolValues[j] = p_bBoolCopy[i];
+          mp_bBoolColumns[iSp][iNewType][j][iNewSlot] =
+              mp_bBoolColumns[iSp][iOldType][i][iOldSlot];
 
     //If seedling to sapling, do a dbh
     if (iOldType == seedling && iNewType == sapling)
-      p_oTree->mp_fFloatValues[mp_iDbhCode[iSp][iNewType]] =
-          mp_oAllom->ConvertDiam10ToDbh(p_fFloatCopy[mp_iDiam10Code[iSp][iOldType]], iSp);
+      mp_fFloatColumns[iSp][iNewType][mp_iDbhCode[iSp][iNewType]][iNewSlot] =
+          mp_oAllom->ConvertDiam10ToDbh(
+              mp_fFloatColumns[iSp][iOldType][mp_iDiam10Code[iSp][iOldType]][iOldSlot], iSp);
 
     //If adult to sapling, do a diam10
     if (iOldType == adult && iNewType == sapling)
-      p_oTree->mp_fFloatValues[mp_iDiam10Code[iSp][iNewType]] =
-          mp_oAllom->ConvertDbhToDiam10(p_fFloatCopy[mp_iDbhCode[iSp][iOldType]], iSp);
+      mp_fFloatColumns[iSp][iNewType][mp_iDiam10Code[iSp][iNewType]][iNewSlot] =
+          mp_oAllom->ConvertDbhToDiam10(
+              mp_fFloatColumns[iSp][iOldType][mp_iDbhCode[iSp][iOldType]][iOldSlot], iSp);
 
-    //Delete the copy arrays
-    delete[] p_fFloatCopy;
-    delete[] p_iIntCopy;
+    //Give back the old slot and assign the new type
+    ReleaseTreeSlot(iSp, iOldType, iOldSlot);
+    p_oTree->m_iType = iNewType;
+    p_oTree->m_iSlot = iNewSlot;
+
+    //Delete the copy array
     delete[] p_sStringCopy;
-    delete[] p_bBoolCopy;
 
   } //end of try block
   catch (modelErr & err)
@@ -725,7 +732,8 @@ string clTreePopulation::TranslateSpeciesCodeToName(int iSpecies) {
 // RegisterDataMember()
 //////////////////////////////////////////////////////////////////////////////
 short int clTreePopulation::RegisterDataMember(string sLabel, int iSpecies,
-    int iType, short int **p_iNumTreeVals, string ***p_sLabels) {
+    int iType, short int **p_iNumTreeVals, string ***p_sLabels,
+    stcDataHandles *p_oHandles) {
   short int iNumVals, //number of values for this species/type combo
   iReturnCode = -1, //what we'll return
   i;
@@ -766,6 +774,15 @@ short int clTreePopulation::RegisterDataMember(string sLabel, int iSpecies,
   }
 
   p_sLabels[iSpecies][iType][iReturnCode] = sLabel;
+
+  //If this label already has a handle, put the new code in its table
+  if (p_oHandles)
+    for (i = 0; i < p_oHandles->iNumHandles; i++)
+      if (p_oHandles->p_sLabels[i].compare(sLabel) == 0) {
+        p_oHandles->p_iCodes[i][iSpecies][iType] = iReturnCode;
+        break;
+      }
+
   return iReturnCode;
 }
 
@@ -775,7 +792,7 @@ short int clTreePopulation::RegisterDataMember(string sLabel, int iSpecies,
 //////////////////////////////////////////////////////////////////////////////
 short int clTreePopulation::RegisterInt(string sLabel, int iSpecies, int iType) {
   return RegisterDataMember(sLabel, iSpecies, iType, mp_iNumTreeIntVals,
-      mp_sIntLabels);
+      mp_sIntLabels, &m_intHandles);
 }
 
 
@@ -785,7 +802,7 @@ short int clTreePopulation::RegisterInt(string sLabel, int iSpecies, int iType)
 //////////////////////////////////////////////////////////////////////////////
 short int clTreePopulation::RegisterFloat(string sLabel, int iSpecies, int iType) {
   return RegisterDataMember(sLabel, iSpecies, iType, mp_iNumTreeFloatVals,
-      mp_sFloatLabels);
+      mp_sFloatLabels, &m_floatHandles);
 }
 
 
@@ -795,7 +812,7 @@ short int clTreePopulation::RegisterFloat(string sLabel, int iSpecies, int iType
 //////////////////////////////////////////////////////////////////////////////
 short int clTreePopulation::RegisterChar(string sLabel, int iSpecies, int iType) {
   return RegisterDataMember(sLabel, iSpecies, iType, mp_iNumTreeStringVals,
-      mp_sStringLabels);
+      mp_sStringLabels, NULL);
 }
 
 
@@ -805,10 +822,110 @@ short int clTreePopulation::RegisterChar(string sLabel, int iSpecies, int iType)
 //////////////////////////////////////////////////////////////////////////////
 short int clTreePopulation::RegisterBool(string sLabel, int iSpecies, int iType) {
   return RegisterDataMember(sLabel, iSpecies, iType, mp_iNumTreeBoolVals,
+      mp_sBoolLabels, &m_boolHandles);
+}
+
+
+
+//////////////////////////////////////////////////////////////////////////////
+// GetIntDataHandle()
+//////////////////////////////////////////////////////////////////////////////
+int clTreePopulation::GetIntDataHandle(string sLabel) {
+  return GetDataHandle(sLabel, m_intHandles, mp_iNumTreeIntVals, mp_sIntLabels);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// GetFloatDataHandle()
+//////////////////////////////////////////////////////////////////////////////
+int clTreePopulation::GetFloatDataHandle(string sLabel) {
+  return GetDataHandle(sLabel, m_floatHandles, mp_iNumTreeFloatVals,
+      mp_sFloatLabels);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// GetBoolDataHandle()
+//////////////////////////////////////////////////////////////////////////////
+int clTreePopulation::GetBoolDataHandle(string sLabel) {
+  return GetDataHandle(sLabel, m_boolHandles, mp_iNumTreeBoolVals,
       mp_sBoolLabels);
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// GetDataHandle()
+//////////////////////////////////////////////////////////////////////////////
+int clTreePopulation::GetDataHandle(string sLabel, stcDataHandles &oHandles,
+    short int **p_iNumTreeVals, string ***p_sLabels) {
+  string *p_sNewLabels;
+  short int ***p_iNewCodes;
+  int iHandle, iSp, iTp, i;
+
+  //Make sure the label passed wasn't an empty string
+  if (0 == sLabel.length()) {
+    modelErr stcErr;
+    stcErr.iErrorCode = BAD_DATA;
+    stcErr.sFunction = "clTreePopulation::GetDataHandle";
+    stcErr.sMoreInfo = "Data label is required.";
+    throw stcErr;
+  }
 
+  //If the label already has a handle, return it
+  for (iHandle = 0; iHandle < oHandles.iNumHandles; iHandle++)
+    if (oHandles.p_sLabels[iHandle].compare(sLabel) == 0)
+      return iHandle;
+
+  //Make room for a new handle, if needed
+  if (oHandles.iNumHandles == oHandles.iCapacity) {
+    oHandles.iCapacity = 0 == oHandles.iCapacity ? 8 : oHandles.iCapacity * 2;
+    p_sNewLabels = new string[oHandles.iCapacity];
+    p_iNewCodes = new short int**[oHandles.iCapacity];
+    for (i = 0; i < oHandles.iNumHandles; i++) {
+      p_sNewLabels[i] = oHandles.p_sLabels[i];
+      p_iNewCodes[i] = oHandles.p_iCodes[i];
+    }
+    delete[] oHandles.p_sLabels;
+    delete[] oHandles.p_iCodes;
+    oHandles.p_sLabels = p_sNewLabels;
+    oHandles.p_iCodes = p_iNewCodes;
+  }
+
+  //Fill in the code table from what has been registered so far
+  iHandle = oHandles.iNumHandles;
+  oHandles.p_sLabels[iHandle] = sLabel;
+  oHandles.p_iCodes[iHandle] = new short int*[m_iNumSpecies];
+  for (iSp = 0; iSp < m_iNumSpecies; iSp++) {
+    oHandles.p_iCodes[iHandle][iSp] = new short int[m_iNumTypes];
+    for (iTp = 0; iTp < m_iNumTypes; iTp++) {
+      oHandles.p_iCodes[iHandle][iSp][iTp] = -1;
+      if (NULL == p_sLabels) continue;
+      for (i = 0; i < p_iNumTreeVals[iSp][iTp]; i++)
+        if (p_sLabels[iSp][iTp][i].compare(sLabel) == 0) {
+          oHandles.p_iCodes[iHandle][iSp][iTp] = i;
+          break;
+        }
+    }
+  }
+  oHandles.iNumHandles++;
+
+  return iHandle;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// DeleteDataHandles()
+//////////////////////////////////////////////////////////////////////////////
+void clTreePopulation::DeleteDataHandles(stcDataHandles &oHandles) {
+  int i, j;
+  for (i = 0; i < oHandles.iNumHandles; i++) {
+    for (j = 0; j < m_iNumSpecies; j++)
+      delete[] oHandles.p_iCodes[i][j];
+    delete[] oHandles.p_iCodes[i];
+  }
+  delete[] oHandles.p_iCodes;
+  delete[] oHandles.p_sLabels;
+  oHandles.p_iCodes = NULL;
+  oHandles.p_sLabels = NULL;
+  oHandles.iNumHandles = 0;
+  oHandles.iCapacity = 0;
+}
 
 //////////////////////////////////////////////////////////////////////////////
 // GetDataCode()
@@ -0,0 +1,94 @@
+//---------------------------------------------------------------------------
+#include <sstream>
+#include "TreeQuery.h"
+#include "TreePopulation.h"
+//---------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////
+// Constructor
+////////////////////////////////////////////////////////////////////////////
+clTreeQuery::clTreeQuery(clTreePopulation *p_oPop) {
+  mp_oPop = p_oPop;
+  m_iNumSpecies = p_oPop->GetNumberOfSpecies();
+  mp_bWhatSpecies = new bool[m_iNumSpecies];
+  Clear();
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Destructor
+////////////////////////////////////////////////////////////////////////////
+clTreeQuery::~clTreeQuery() {
+  delete[] mp_bWhatSpecies;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Clear()
+////////////////////////////////////////////////////////////////////////////
+void clTreeQuery::Clear() {
+  int i;
+
+  m_bDistanceHeightUsed = false;
+  m_bTypeUsed = false;
+  m_bSpeciesUsed = false;
+  m_bAllUsed = false;
+  m_fFromX = 0;
+  m_fFromY = 0;
+  m_fDistanceCutoff = 0;
+  m_fHeightCutoff = 0;
+  m_iWhatTypes = 0;
+  for (i = 0; i < m_iNumSpecies; i++)
+    mp_bWhatSpecies[i] = false;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// SetAll()
+////////////////////////////////////////////////////////////////////////////
+void clTreeQuery::SetAll() {
+  m_bAllUsed = true;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// SetDistanceHeight()
+////////////////////////////////////////////////////////////////////////////
+void clTreeQuery::SetDistanceHeight(float fDistance, float fHeight, float fX,
+    float fY) {
+  m_bDistanceHeightUsed = true;
+  m_fDistanceCutoff = fDistance;
+  m_fHeightCutoff = fHeight;
+  m_fFromX = fX;
+  m_fFromY = fY;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// AddType()
+////////////////////////////////////////////////////////////////////////////
+void clTreeQuery::AddType(int iType) {
+  if (iType < clTreePopulation::seed || iType > clTreePopulation::woody_debris) {
+    modelErr stcErr;
+    stcErr.sFunction = "clTreeQuery::AddType" ;
+    stcErr.iErrorCode = BAD_DATA;
+    std::stringstream s;
+    s << "Unrecognized type: " << iType;
+    stcErr.sMoreInfo = s.str();
+    throw(stcErr);
+  }
+  m_bTypeUsed = true;
+  m_iWhatTypes = m_iWhatTypes | (1 << iType);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// AddSpecies()
+////////////////////////////////////////////////////////////////////////////
+void clTreeQuery::AddSpecies(int iSpecies) {
+  if (iSpecies < 0 || iSpecies >= m_iNumSpecies) {
+    modelErr stcErr;
+    stcErr.sFunction = "clTreeQuery::AddSpecies" ;
+    stcErr.iErrorCode = BAD_DATA;
+    std::stringstream s;
+    s << "Unrecognized species number: " << iSpecies;
+    stcErr.sMoreInfo = s.str();
+    throw(stcErr);
+  }
+  m_bSpeciesUsed = true;
+  mp_bWhatSpecies[iSpecies] = true;
+}
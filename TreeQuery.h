@@ -0,0 +1,127 @@
+//---------------------------------------------------------------------------
+
+#ifndef TreeQueryH
+#define TreeQueryH
+//---------------------------------------------------------------------------
+
+class clTreePopulation;
+
+/**
+* Tree Query Class - Version 1.0
+* This class holds the criteria for a tree search in already-parsed form, so
+* that clTreePopulation::Find() can set up a search without doing any string
+* handling. A query is meant to be built once (for instance, during a
+* behavior's setup) and then re-used. For neighborhood searches, only the
+* center point needs to change from one target tree to the next; use
+* SetCenter() to re-aim the query.
+*
+* The same rules for valid searches apply as for the string form of
+* clTreePopulation::Find(): "all" alone, distance/height alone, type alone,
+* or type and species together. These are enforced when the search is set up.
+*
+* Copyright 2026 agent.
+* @author agent
+*
+* <br>Edit history:
+* <br>-----------------
+* <br>October 17, 2026 - Created (agent)
+*/
+class clTreeQuery {
+  friend class clTreeSearch;
+  friend class clTreePopulation;
+
+  public:
+
+  /**
+  * Constructor. The query starts out empty.
+  * @param p_oPop Tree population. Used to size the species array and to
+  * validate species and types.
+  */
+  clTreeQuery(clTreePopulation *p_oPop);
+
+  /**
+  * Destructor.
+  */
+  ~clTreeQuery();
+
+  /**
+  * Clears all criteria.
+  */
+  void Clear();
+
+  /**
+  * Makes this a search for all trees.
+  */
+  void SetAll();
+
+  /**
+  * Makes this a distance/height search.
+  * @param fDistance Maximum distance from the center point, in meters.
+  * @param fHeight Minimum tree height, in meters. Can be zero.
+  * @param fX X coordinate of the center point.
+  * @param fY Y coordinate of the center point.
+  */
+  void SetDistanceHeight(float fDistance, float fHeight, float fX, float fY);
+
+  /**
+  * Re-aims a distance/height search at a new center point.
+  * @param fX X coordinate of the center point.
+  * @param fY Y coordinate of the center point.
+  */
+  void SetCenter(float fX, float fY) {m_fFromX = fX; m_fFromY = fY;};
+
+  /**
+  * Adds a type to search for.
+  * @param iType Type, as a member of clTreePopulation::iTreeType.
+  * @throw BAD_DATA error if the type is not recognized.
+  */
+  void AddType(int iType);
+
+  /**
+  * Adds a species to search for.
+  * @param iSpecies Species number.
+  * @throw BAD_DATA error if the species is not recognized.
+  */
+  void AddSpecies(int iSpecies);
+
+  /**
+  * Gets the distance cutoff of a distance/height search.
+  * @return Distance cutoff, in meters.
+  */
+  float GetDistance() {return m_fDistanceCutoff;};
+
+  /**
+  * Gets the height cutoff of a distance/height search.
+  * @return Height cutoff, in meters.
+  */
+  float GetHeight() {return m_fHeightCutoff;};
+
+  /**
+  * Gets the type mask. Each type is one bit, counting from the right by
+  * its clTreePopulation::iTreeType value.
+  * @return Type mask.
+  */
+  short int GetTypes() {return m_iWhatTypes;};
+
+  protected:
+
+  /**Tree population*/
+  clTreePopulation *mp_oPop;
+
+  float m_fFromX; /**<X coordinate of search point in a distance/height search*/
+  float m_fFromY; /**<Y coordinate of search point in a distance/height search*/
+  float m_fDistanceCutoff; /**<Maximum distance, in meters, in a
+       distance/height search*/
+  float m_fHeightCutoff;  /**<Minimum height, in meters, in a
+        distance/height search - can be zero*/
+  short int m_iWhatTypes; /**<Which types to search for, as a bit mask*/
+  bool *mp_bWhatSpecies; /**<Which species to search for. Array is sized
+        number of species.*/
+  int m_iNumSpecies; /**<Number of species*/
+  bool m_bDistanceHeightUsed;  /**<Whether or not this is a distance and height search*/
+  bool m_bTypeUsed;            /**<Whether or not this is searching by tree type*/
+  bool m_bSpeciesUsed;         /**<Whether or not this is searching by species*/
+  bool m_bAllUsed;             /**<Whether or not this should simply return all*/
+};
+//---------------------------------------------------------------------------
+#endif
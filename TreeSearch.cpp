@@ -3,18 +3,38 @@
 #include "Allometry.h"
 #include "TreePopulation.h"
 #include "Plot.h"
+#include "TreeQuery.h"
+#include "SimManager.h"
 //---------------------------------------------------------------------------
 
 ////////////////////////////////////////////////////////////////////////////
 // Constructor
 ////////////////////////////////////////////////////////////////////////////
 clTreeSearch::clTreeSearch(clTreePopulation *p_oTreePop, clPlot *p_oPlot) {
+  Initialize(p_oTreePop, p_oPlot);
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Constructor
+////////////////////////////////////////////////////////////////////////////
+clTreeSearch::clTreeSearch(clTreePopulation *p_oTreePop) {
+  Initialize(p_oTreePop, p_oTreePop->mp_oSimManager->GetPlotObject());
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Initialize()
+////////////////////////////////////////////////////////////////////////////
+void clTreeSearch::Initialize(clTreePopulation *p_oTreePop, clPlot *p_oPlot) {
   try {
     //Initialize variables
     mp_oTreePop = p_oTreePop;
     mp_oCurrentTree = NULL;
     function = NULL;
 
+    //An unarmed search is stale from the start, so NextTree() returns NULL
+    mp_lPopEpoch = &p_oTreePop->m_lSearchEpoch;
+    m_lEpoch = p_oTreePop->m_lSearchEpoch - 1;
+
     //Initialize search flags
     m_bDistanceHeightUsed = false;
     m_bTypeUsed = false;
@@ -36,6 +56,9 @@ clTreeSearch::clTreeSearch(clTreePopulation *p_oTreePop, clPlot *p_oPlot) {
     m_fFromX = 0;
     m_fFromY = 0;
     m_fDistanceCutoff = 0;
+    m_fDistanceCutoffSq = 0;
+    m_fPlotLengthX = 0;
+    m_fPlotLengthY = 0;
 
     //Create the array for which species will be used (if it's a species
     //search), and set all to false
@@ -65,7 +88,7 @@ clTreeSearch::clTreeSearch(clTreePopulation *p_oTreePop, clPlot *p_oPlot) {
   catch (...) {
     modelErr stcErr;
     stcErr.iErrorCode = UNKNOWN;
-    stcErr.sFunction = "clTreeSearch::clTreeSearch";
+    stcErr.sFunction = "clTreeSearch::Initialize";
     throw(stcErr);
   }
 }
@@ -96,6 +119,17 @@ void clTreeSearch::Setup() {
       throw(stcErr);
     }
 
+    //Reset whatever a previous use of this search left behind
+    m_iCurrentXGrid = 0;
+    m_iCurrentYGrid = 0;
+    m_bSeeds = false;
+    m_bSeedlings = false;
+    m_bSaplings = false;
+    m_bAdults = false;
+    m_bSnags = false;
+    m_bWoody_Debris = false;
+    m_lEpoch = *mp_lPopEpoch;
+
     //Validate the data
     if (m_bDistanceHeightUsed) {
       //Make sure we have a positive number for distance and height
@@ -193,6 +227,32 @@ void clTreeSearch::Setup() {
   }
 }
 
+////////////////////////////////////////////////////////////////////////////
+// Arm()
+////////////////////////////////////////////////////////////////////////////
+void clTreeSearch::Arm(const clTreeQuery &oQuery) {
+  int i;
+
+  //Copy over the search criteria
+  m_bAllUsed = oQuery.m_bAllUsed;
+  m_bDistanceHeightUsed = oQuery.m_bDistanceHeightUsed;
+  m_bTypeUsed = oQuery.m_bTypeUsed;
+  m_bSpeciesUsed = oQuery.m_bSpeciesUsed;
+  m_fDistanceCutoff = oQuery.m_fDistanceCutoff;
+  m_fDistanceCutoffSq = m_fDistanceCutoff * m_fDistanceCutoff;
+  m_fPlotLengthX = mp_oTreePop->m_fPlotLengthX;
+  m_fPlotLengthY = mp_oTreePop->m_fPlotLengthY;
+  m_fHeightCutoff = oQuery.m_fHeightCutoff;
+  m_fFromX = oQuery.m_fFromX;
+  m_fFromY = oQuery.m_fFromY;
+  m_iWhatTypes = oQuery.m_iWhatTypes;
+  if (oQuery.m_bSpeciesUsed)
+    for (i = 0; i < oQuery.m_iNumSpecies; i++)
+      mp_bWhatSpecies[i] = oQuery.mp_bWhatSpecies[i];
+
+  Setup();
+}
+
 ////////////////////////////////////////////////////////////////////////////
 // StartOver()
 ////////////////////////////////////////////////////////////////////////////
@@ -200,6 +260,7 @@ void clTreeSearch::StartOver() {
   try {
     m_iCurrentXGrid = 0;
     m_iCurrentYGrid = 0;
+    m_lEpoch = *mp_lPopEpoch;
 
     if (m_bAllUsed)
       mp_oCurrentTree = FindFirstAllTree();
@@ -598,16 +659,16 @@ clTree* clTreeSearch::FindFirstDHTree() {
   clTree *p_oTree;
   float fHeight, fX, fY;
   //fHalfGrLen; //half of the grid length
+  float fInvGrLen; //1 / tree population grid length
   short int iX, iY, //grid cell coords, corrected for torus
-  iOldX, iOldY, iDiv, //loop counters
-  iGrLen;  //tree population grid length
+  iOldX, iOldY, iDiv; //loop counters
 
-  iGrLen = mp_oTreePop->m_iLengthGrids;
+  fInvGrLen = mp_oTreePop->m_fInvLengthGrids;
   //fHalfGrLen = iGrLen / 2.0;
 
   //Get the home grid cell of the target point
-  m_iHomeX = (int)floor(m_fFromX / iGrLen);
-  m_iHomeY = (int)floor(m_fFromY / iGrLen);
+  m_iHomeX = (int)floor(m_fFromX * fInvGrLen);
+  m_iHomeY = (int)floor(m_fFromY * fInvGrLen);
 
   //Get the starting height division based on the target height
   m_iStartHeightDiv = (int)floor(m_fHeightCutoff / mp_oTreePop->m_iSizeHeightDivs);
@@ -620,11 +681,11 @@ clTree* clTreeSearch::FindFirstDHTree() {
   //If the distance cutoff is greater than 1/2 the Y plot length, only use
   //that value so that we don't wrap
   if (m_fDistanceCutoff >= mp_oTreePop->m_fPlotLengthY / 2) {
-    m_iMaxY = (int)floor((m_fFromY + mp_oTreePop->m_fPlotLengthY/2) / iGrLen);
-    m_iMinY = (int)floor((m_fFromY - mp_oTreePop->m_fPlotLengthY/2) / iGrLen) + 1;
+    m_iMaxY = (int)floor((m_fFromY + mp_oTreePop->m_fPlotLengthY/2) * fInvGrLen);
+    m_iMinY = (int)floor((m_fFromY - mp_oTreePop->m_fPlotLengthY/2) * fInvGrLen) + 1;
   } else {
-    m_iMaxY = (int)ceil((m_fFromY + m_fDistanceCutoff) / iGrLen);
-    m_iMinY = (int)floor((m_fFromY - m_fDistanceCutoff) / iGrLen);
+    m_iMaxY = (int)ceil((m_fFromY + m_fDistanceCutoff) * fInvGrLen);
+    m_iMinY = (int)floor((m_fFromY - m_fDistanceCutoff) * fInvGrLen);
   }
 
   //Move from min to max Y until we find a tree
@@ -636,7 +697,7 @@ clTree* clTreeSearch::FindFirstDHTree() {
       iY = iOldY - mp_oTreePop->m_iNumYCells;
     else iY = iOldY;
 
-    GetMinMaxX(iOldY, iGrLen);
+    GetMinMaxX(iOldY);
 
     for (iOldX = m_iMinX; iOldX <= m_iMaxX; iOldX++) {
       //"Fix" the X grid cell for torus, if needed
@@ -663,8 +724,7 @@ clTree* clTreeSearch::FindFirstDHTree() {
         if (fHeight > m_fHeightCutoff) {
           p_oTree->GetValue(mp_oTreePop->mp_iXCode[iSp][iTp], &fX);
           p_oTree->GetValue(mp_oTreePop->mp_iYCode[iSp][iTp], &fY);
-          if (mp_oPlot->GetDistance(m_fFromX, m_fFromY, fX, fY)
-              <= m_fDistanceCutoff) {
+          if (IsWithinDistance(fX, fY)) {
             m_iCurrentXGrid = iOldX; m_iCurrentYGrid = iOldY;
             return p_oTree;
           }
@@ -686,8 +746,7 @@ clTree* clTreeSearch::FindNextDHTree() {
   float fHeight, fX, fY;
   //fHalfGrLen; //half of the grid length
   short int iX, iY, //grid cell coords, corrected for torus
-  iOldX, iOldY, iDiv, //loop counters
-  iGrLen;  //tree population grid length
+  iOldX, iOldY, iDiv; //loop counters
 
 
   //First see if the current tree has a taller tree that works
@@ -699,16 +758,12 @@ clTree* clTreeSearch::FindNextDHTree() {
       iSp = p_oTree->GetSpecies(); iTp = p_oTree->GetType();
       p_oTree->GetValue(mp_oTreePop->mp_iXCode[iSp][iTp], &fX);
       p_oTree->GetValue(mp_oTreePop->mp_iYCode[iSp][iTp], &fY);
-      if (mp_oPlot->GetDistance(m_fFromX, m_fFromY, fX, fY)
-          <= m_fDistanceCutoff)
+      if (IsWithinDistance(fX, fY))
         return p_oTree;
       p_oTree = p_oTree->GetTaller();
     }
   }
 
-  iGrLen = mp_oTreePop->m_iLengthGrids;
-  //fHalfGrLen = iGrLen / 2.0;
-
   //If we're still here, it means that there was nothing else in this grid
   //cell.  Thus, look for the next one.  Start by checking the X grids.
   if (m_iCurrentXGrid < m_iMaxX)
@@ -740,8 +795,7 @@ clTree* clTreeSearch::FindNextDHTree() {
         if (fHeight > m_fHeightCutoff) {
           p_oTree->GetValue(mp_oTreePop->mp_iXCode[iSp][iTp], &fX);
           p_oTree->GetValue(mp_oTreePop->mp_iYCode[iSp][iTp], &fY);
-          if (mp_oPlot->GetDistance(m_fFromX, m_fFromY, fX, fY)
-              <= m_fDistanceCutoff) {
+          if (IsWithinDistance(fX, fY)) {
             m_iCurrentXGrid = iOldX;
             return p_oTree;
           }
@@ -751,8 +805,6 @@ clTree* clTreeSearch::FindNextDHTree() {
     } //end of for (iOldX = m_iCurrentXGrid + 1; iOldX < m_iMaxX; iOldX++)
 
   //Still nothing - or it's time to search the next Y grid
-  iGrLen = mp_oTreePop->m_iLengthGrids;
-
   //Move from min to max Y until we find a tree
   for (iOldY = m_iCurrentYGrid + 1; iOldY <= m_iMaxY; iOldY++) {
 
@@ -762,7 +814,7 @@ clTree* clTreeSearch::FindNextDHTree() {
       iY = iOldY - mp_oTreePop->m_iNumYCells;
     else iY = iOldY;
 
-    GetMinMaxX(iOldY, iGrLen);
+    GetMinMaxX(iOldY);
 
     for (iOldX = m_iMinX; iOldX <= m_iMaxX; iOldX++) {
       //"Fix" the X grid cell for torus, if needed
@@ -789,8 +841,7 @@ clTree* clTreeSearch::FindNextDHTree() {
         if (fHeight > m_fHeightCutoff) {
           p_oTree->GetValue(mp_oTreePop->mp_iXCode[iSp][iTp], &fX);
           p_oTree->GetValue(mp_oTreePop->mp_iYCode[iSp][iTp], &fY);
-          if (mp_oPlot->GetDistance(m_fFromX, m_fFromY, fX, fY)
-              <= m_fDistanceCutoff) {
+          if (IsWithinDistance(fX, fY)) {
             m_iCurrentXGrid = iOldX; m_iCurrentYGrid = iOldY;
             return p_oTree;
           }
@@ -807,12 +858,14 @@ clTree* clTreeSearch::FindNextDHTree() {
 ////////////////////////////////////////////////////////////////////////////
 // GetMinMaxX()
 ////////////////////////////////////////////////////////////////////////////
-void clTreeSearch::GetMinMaxX(const int &iY, const int &iGrLen) {
+void clTreeSearch::GetMinMaxX(const int &iY) {
   //we know XY of center, and Y of point on edge of circle - solve for X
   //X2 = X1 - square root(distance^2 - (Y1 - Y2)^2)
   //If this is the home Y cell, then the X dist = the radius
 
-  float fXDist, fYCellEdge, fMinX, fMaxX;
+  float fXDist, fYCellEdge, fMinX, fMaxX,
+        fInvGrLen = mp_oTreePop->m_fInvLengthGrids;
+  int iGrLen = mp_oTreePop->m_iLengthGrids;
   //If Y is the home row, the search radius equals the distance
   if (iY == m_iHomeY) {
     fXDist = m_fDistanceCutoff;
@@ -824,7 +877,8 @@ void clTreeSearch::GetMinMaxX(const int &iY, const int &iGrLen) {
     else
       fYCellEdge = iY * iGrLen;
 
-    fXDist = pow(m_fDistanceCutoff,2) - pow(m_fFromY - fYCellEdge,2);
+    fXDist = m_fDistanceCutoff * m_fDistanceCutoff -
+        (m_fFromY - fYCellEdge) * (m_fFromY - fYCellEdge);
     if (fXDist > 0)
       fXDist = sqrt(fXDist);
     else fXDist = 0;
@@ -843,8 +897,8 @@ void clTreeSearch::GetMinMaxX(const int &iY, const int &iGrLen) {
   fMinX = m_fFromX - fXDist;
   fMaxX = m_fFromX + fXDist;
 
-  m_iMaxX = (int)(mp_oPlot->CorrectX(fMaxX) / iGrLen) + 1;
-  m_iMinX = (int)(mp_oPlot->CorrectX(fMinX) / iGrLen);
+  m_iMaxX = (int)(mp_oPlot->CorrectX(fMaxX) * fInvGrLen) + 1;
+  m_iMinX = (int)(mp_oPlot->CorrectX(fMinX) * fInvGrLen);
 
   //DECORRECT for torus
   if (fMinX < 0) m_iMinX -= mp_oTreePop->GetNumXCells();
@@ -5,9 +5,11 @@
 #define TreeSearchH
 //---------------------------------------------------------------------------
 
+#include <math.h>
 #include "Tree.h"
 
 class clPlot;
+class clTreeQuery;
 
 
 /**
@@ -51,6 +53,15 @@ class clPlot;
 * searches. It makes sense in theory but most searches are 10 meters or less.
 * Plus there's a bug - short end cells are treated as full-size and may lead
 * to their regular-sized neighbors being skipped. (LEM)
+* <br>October 17, 2026 - Searches can now be owned by the caller and re-armed
+* with clTreePopulation::Find(const clTreeQuery&, clTreeSearch*). A search
+* remembers the population's search epoch when it is armed and stops
+* returning trees once the epoch has moved on. (agent)
+* <br>October 17, 2026 - Grid cells are found by multiplying by the
+* population's reciprocal grid length, so any cell size is equally cheap (agent)
+* <br>October 17, 2026 - Distance/height searches compare squared torus
+* distances with IsWithinDistance() instead of calling clPlot::GetDistance()
+* (agent)
 */
 class clTreeSearch {
   friend class clTreePopulation;
@@ -80,6 +91,7 @@ class clTreeSearch {
   */
   clTree* NextTree() {
     clTree *p_oReturnTree; //tree to return
+    if (m_lEpoch != *mp_lPopEpoch) return NULL;
     p_oReturnTree = mp_oCurrentTree;
     mp_oCurrentTree = (*this.*function)();
     return p_oReturnTree;
@@ -107,6 +119,15 @@ class clTreeSearch {
   */
   clTreeSearch(clTreePopulation* p_oTreePop, clPlot *p_oPlot);
 
+  /**
+  * Constructor for a caller-owned search. The search is empty until it is
+  * armed with clTreePopulation::Find(const clTreeQuery&, clTreeSearch*); until
+  * then NextTree() returns NULL.
+  *
+  * @param p_oTreePop Pointer to the tree population object
+  */
+  clTreeSearch(clTreePopulation* p_oTreePop);
+
   /**
   * Destructor.  Frees memory.
   */
@@ -189,17 +210,52 @@ class clTreeSearch {
    * X2 = X1 - square root(distance^2 - (Y1 - Y2)^2). The min and max values
    * are set in m_iMinX and m_iMaxX, uncorrected for torus.
    * @param iY The Y grid cell, uncorrected for torus.
-   * @param iGrLen Grid length
    */
-  void GetMinMaxX(const int &iY, const int &iGrLen);
+  void GetMinMaxX(const int &iY);
 
   /**
   * Does final data validation and gets things ready for the NextTree() methods.
   */
   void Setup();
 
+  /**
+  * Copies search criteria from a query and calls Setup(). This can be done any
+  * number of times on the same object.
+  * @param oQuery Query to copy.
+  */
+  void Arm(const clTreeQuery &oQuery);
+
+  /**
+  * Does the work of the constructors.
+  * @param p_oTreePop Pointer to the tree population object
+  * @param p_oPlot Pointer to the plot object
+  */
+  void Initialize(clTreePopulation *p_oTreePop, clPlot *p_oPlot);
+
+  /**
+  * Tests whether a point is within the distance cutoff of the search point in
+  * a distance/height search, corrected for torus wrapping. This compares
+  * squared distances, so no square root is taken, and it has none of the
+  * branching of clPlot::GetDistance().
+  * @param fX X coordinate of the point.
+  * @param fY Y coordinate of the point.
+  * @return True if the point is within the distance cutoff.
+  */
+  bool IsWithinDistance(float fX, float fY) {
+    float fDX = fabs(fX - m_fFromX), fDY = fabs(fY - m_fFromY);
+    if (fDX > m_fPlotLengthX - fDX) fDX = m_fPlotLengthX - fDX;
+    if (fDY > m_fPlotLengthY - fDY) fDY = m_fPlotLengthY - fDY;
+    return fDX * fDX + fDY * fDY <= m_fDistanceCutoffSq;
+  };
+
   clTree  *mp_oCurrentTree; /**<The tree that the search is currently on*/
 
+  /**Points to the tree population's search epoch. The population moves the
+  epoch on whenever the hash table is rebuilt or emptied.*/
+  const unsigned long *mp_lPopEpoch;
+  unsigned long m_lEpoch; /**<Value of the population's search epoch when this
+        search was last armed or started over*/
+
   //Flags for what kinds of arguments were specified
   bool m_bDistanceHeightUsed;  /**<Whether or not this is a distance and height search*/
   bool m_bTypeUsed;            /**<Whether or not this is searching by tree type*/
@@ -216,6 +272,9 @@ class clTreeSearch {
   float m_fFromY; /**<Y coordinate of search point in a distance/height search*/
   float m_fDistanceCutoff; /**<Target maximum distance, in meters, in a
        distance/height seach*/
+  float m_fDistanceCutoffSq; /**<Square of m_fDistanceCutoff*/
+  float m_fPlotLengthX; /**<Plot length in X, for torus distances*/
+  float m_fPlotLengthY; /**<Plot length in Y, for torus distances*/
   float m_fHeightCutoff;  /**<Target minimum height, in meters, in a
         distance/height search - can be zero*/
   short int m_iMaxX; /**<Maximum X grid cell number to search in a distance/height search*/
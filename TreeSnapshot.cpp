@@ -0,0 +1,193 @@
+//---------------------------------------------------------------------------
+#include "TreeSnapshot.h"
+#include "Allometry.h"
+//---------------------------------------------------------------------------
+
+////////////////////////////////////////////////////////////////////////////
+// Constructor
+////////////////////////////////////////////////////////////////////////////
+clTreeSnapshot::clTreeSnapshot(clTreePopulation *p_oPop) {
+  mp_oPop = p_oPop;
+  mp_lPopEpoch = &p_oPop->m_lTreeEpoch;
+  m_lEpoch = p_oPop->m_lTreeEpoch - 1;
+
+  mp_fX = NULL;
+  mp_fY = NULL;
+  mp_fHeight = NULL;
+  mp_fDbh = NULL;
+  mp_fCrownRadius = NULL;
+  mp_fCrownDepth = NULL;
+  mp_iSpecies = NULL;
+  mp_iType = NULL;
+  mp_iDead = NULL;
+  mp_oTrees = NULL;
+  mp_iCellStart = NULL;
+
+  m_fPlotLengthX = 0;
+  m_fPlotLengthY = 0;
+  m_iNumTrees = 0;
+  m_iCapacity = 0;
+  m_iNumXCells = 0;
+  m_iNumYCells = 0;
+  m_iNumCells = 0;
+  m_bCrownRadiusDone = false;
+  m_bCrownDepthDone = false;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Destructor
+////////////////////////////////////////////////////////////////////////////
+clTreeSnapshot::~clTreeSnapshot() {
+  delete[] mp_fX;
+  delete[] mp_fY;
+  delete[] mp_fHeight;
+  delete[] mp_fDbh;
+  delete[] mp_fCrownRadius;
+  delete[] mp_fCrownDepth;
+  delete[] mp_iSpecies;
+  delete[] mp_iType;
+  delete[] mp_iDead;
+  delete[] mp_oTrees;
+  delete[] mp_iCellStart;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Reserve()
+////////////////////////////////////////////////////////////////////////////
+void clTreeSnapshot::Reserve(int iNumTrees) {
+  if (iNumTrees <= m_iCapacity) return;
+
+  delete[] mp_fX;
+  delete[] mp_fY;
+  delete[] mp_fHeight;
+  delete[] mp_fDbh;
+  delete[] mp_fCrownRadius;
+  delete[] mp_fCrownDepth;
+  delete[] mp_iSpecies;
+  delete[] mp_iType;
+  delete[] mp_iDead;
+  delete[] mp_oTrees;
+
+  //Leave some room so a growing population doesn't reallocate every time
+  m_iCapacity = iNumTrees + iNumTrees / 4 + 1;
+  mp_fX = new float[m_iCapacity];
+  mp_fY = new float[m_iCapacity];
+  mp_fHeight = new float[m_iCapacity];
+  mp_fDbh = new float[m_iCapacity];
+  mp_fCrownRadius = new float[m_iCapacity];
+  mp_fCrownDepth = new float[m_iCapacity];
+  mp_iSpecies = new short int[m_iCapacity];
+  mp_iType = new short int[m_iCapacity];
+  mp_iDead = new int[m_iCapacity];
+  mp_oTrees = new clTree*[m_iCapacity];
+}
+
+////////////////////////////////////////////////////////////////////////////
+// Build()
+////////////////////////////////////////////////////////////////////////////
+void clTreeSnapshot::Build() {
+  clTree *p_oTree;
+  short int **p_iDeadCodes = mp_oPop->GetDeadCodes();
+  int iX, iY, iDiv, iCell, iSp, iTp, i;
+
+  m_fPlotLengthX = mp_oPop->m_fPlotLengthX;
+  m_fPlotLengthY = mp_oPop->m_fPlotLengthY;
+  m_iNumXCells = mp_oPop->m_iNumXCells;
+  m_iNumYCells = mp_oPop->m_iNumYCells;
+  if (m_iNumXCells * m_iNumYCells != m_iNumCells) {
+    delete[] mp_iCellStart;
+    m_iNumCells = m_iNumXCells * m_iNumYCells;
+    mp_iCellStart = new int[m_iNumCells + 1];
+  }
+
+  //Count the trees so the arrays are only sized once
+  i = 0;
+  for (iX = 0; iX < m_iNumXCells; iX++) {
+    for (iY = 0; iY < m_iNumYCells; iY++) {
+      p_oTree = NULL;
+      for (iDiv = 0; iDiv < mp_oPop->m_iNumHeightDivs && !p_oTree; iDiv++)
+        p_oTree = mp_oPop->mp_oTreeShortest[iX][iY][iDiv];
+      while (p_oTree) {
+        i++;
+        p_oTree = p_oTree->GetTaller();
+      }
+    }
+  }
+  Reserve(i);
+
+  //Copy the trees, cell by cell
+  i = 0;
+  for (iX = 0; iX < m_iNumXCells; iX++) {
+    for (iY = 0; iY < m_iNumYCells; iY++) {
+      iCell = iX * m_iNumYCells + iY;
+      mp_iCellStart[iCell] = i;
+      p_oTree = NULL;
+      for (iDiv = 0; iDiv < mp_oPop->m_iNumHeightDivs && !p_oTree; iDiv++)
+        p_oTree = mp_oPop->mp_oTreeShortest[iX][iY][iDiv];
+      while (p_oTree) {
+        iSp = p_oTree->GetSpecies(); iTp = p_oTree->GetType();
+        mp_fX[i] = mp_oPop->TreeFloat(p_oTree, mp_oPop->mp_iXCode[iSp][iTp]);
+        mp_fY[i] = mp_oPop->TreeFloat(p_oTree, mp_oPop->mp_iYCode[iSp][iTp]);
+        mp_fHeight[i] = mp_oPop->TreeFloat(p_oTree,
+            mp_oPop->mp_iHeightCode[iSp][iTp]);
+        mp_fDbh[i] = mp_oPop->mp_iDbhCode[iSp][iTp] < 0 ? 0 :
+            mp_oPop->TreeFloat(p_oTree, mp_oPop->mp_iDbhCode[iSp][iTp]);
+        mp_iDead[i] = p_iDeadCodes[iSp][iTp] < 0 ? notdead :
+            mp_oPop->TreeInt(p_oTree, p_iDeadCodes[iSp][iTp]);
+        mp_iSpecies[i] = iSp;
+        mp_iType[i] = iTp;
+        mp_oTrees[i] = p_oTree;
+        i++;
+        p_oTree = p_oTree->GetTaller();
+      }
+    }
+  }
+  mp_iCellStart[m_iNumCells] = i;
+  m_iNumTrees = i;
+
+  m_bCrownRadiusDone = false;
+  m_bCrownDepthDone = false;
+  m_lEpoch = *mp_lPopEpoch;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// GetCrownRadius()
+////////////////////////////////////////////////////////////////////////////
+const float *clTreeSnapshot::GetCrownRadius() {
+  clAllometry *p_oAllom;
+  int i;
+
+  if (!m_bCrownRadiusDone) {
+    p_oAllom = mp_oPop->GetAllometryObject();
+    for (i = 0; i < m_iNumTrees; i++) {
+      if (clTreePopulation::adult == mp_iType[i])
+        mp_fCrownRadius[i] = p_oAllom->CalcAdultCrownRadius(mp_oTrees[i]);
+      else if (clTreePopulation::sapling == mp_iType[i])
+        mp_fCrownRadius[i] = p_oAllom->CalcSaplingCrownRadius(mp_oTrees[i]);
+      else mp_fCrownRadius[i] = 0;
+    }
+    m_bCrownRadiusDone = true;
+  }
+  return mp_fCrownRadius;
+}
+
+////////////////////////////////////////////////////////////////////////////
+// GetCrownDepth()
+////////////////////////////////////////////////////////////////////////////
+const float *clTreeSnapshot::GetCrownDepth() {
+  clAllometry *p_oAllom;
+  int i;
+
+  if (!m_bCrownDepthDone) {
+    p_oAllom = mp_oPop->GetAllometryObject();
+    for (i = 0; i < m_iNumTrees; i++) {
+      if (clTreePopulation::adult == mp_iType[i])
+        mp_fCrownDepth[i] = p_oAllom->CalcAdultCrownDepth(mp_oTrees[i]);
+      else if (clTreePopulation::sapling == mp_iType[i])
+        mp_fCrownDepth[i] = p_oAllom->CalcSaplingCrownDepth(mp_oTrees[i]);
+      else mp_fCrownDepth[i] = 0;
+    }
+    m_bCrownDepthDone = true;
+  }
+  return mp_fCrownDepth;
+}
@@ -0,0 +1,371 @@
+//---------------------------------------------------------------------------
+
+#ifndef TreeSnapshotH
+#define TreeSnapshotH
+//---------------------------------------------------------------------------
+#include "TreePopulation.h"
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/**
+* Tree Snapshot Class - Version 1.0
+* This class holds a read-only copy of the core data of every tree in the
+* hash table, packed into one array per value. Behaviors that only read tree
+* data can loop over these arrays instead of following tree pointers through
+* a clTreeSearch.
+*
+* Trees are ordered by hash table cell, X-major (cell number = X cell *
+* number of Y cells + Y cell), and shortest to tallest within each cell, the
+* same order as the hash table's own lists. The cell offset index gives the
+* first tree of each cell; the trees of cell c are GetCellStart(c) up to, but
+* not including, GetCellStart(c + 1).
+*
+* A snapshot is gotten from clTreePopulation::GetSnapshot(), which owns it and
+* rebuilds it when it is out of date. It goes out of date as soon as a tree is
+* created or removed, changes type, or has its height, diameter, or dead code
+* set through clTreePopulation. IsCurrent() tells whether that has happened;
+* a behavior should not hold on to array pointers across calls that might
+* change trees.
+*
+* Crown radius and crown depth come from the allometry object. They are only
+* calculated the first time they are asked for after a rebuild. They are zero
+* for seedlings and snags.
+*
+* Copyright 2026 agent.
+* @author agent
+*
+* <br>Edit history:
+* <br>-----------------
+* <br>October 17, 2026 - Created (agent)
+* <br>October 17, 2026 - ForEachNeighbor() tests trees four at a time, with
+* SSE2 where the compiler has it (agent)
+* <br>October 17, 2026 - clTreePopulation::ForEachNeighbor() is defined here
+* and searches the snapshot when it is current (agent)
+*/
+class clTreeSnapshot {
+  friend class clTreePopulation;
+
+  public:
+
+  /**
+  * Constructor. The snapshot starts out empty and out of date.
+  * @param p_oPop Tree population.
+  */
+  clTreeSnapshot(clTreePopulation *p_oPop);
+
+  /**
+  * Destructor. Frees memory.
+  */
+  ~clTreeSnapshot();
+
+  /**
+  * Gets whether this snapshot still matches the tree population.
+  * @return True if no tree has changed since the snapshot was built.
+  */
+  bool IsCurrent() {return m_lEpoch == *mp_lPopEpoch;};
+
+  /**
+  * Gets the number of trees in the snapshot.
+  * @return Number of trees.
+  */
+  int GetNumTrees() {return m_iNumTrees;};
+
+  /**
+  * Gets the number of hash table cells in the X direction.
+  * @return Number of X cells.
+  */
+  int GetNumXCells() {return m_iNumXCells;};
+
+  /**
+  * Gets the number of hash table cells in the Y direction.
+  * @return Number of Y cells.
+  */
+  int GetNumYCells() {return m_iNumYCells;};
+
+  /**
+  * Gets the index of the first tree in a cell. Pass the total number of cells
+  * to get the number of trees.
+  * @param iCell Cell number, X cell * number of Y cells + Y cell.
+  * @return Index of the cell's first tree.
+  */
+  int GetCellStart(int iCell) {return mp_iCellStart[iCell];};
+
+  /**Gets the X coordinates. @return X array.*/
+  const float *GetX() {return mp_fX;};
+  /**Gets the Y coordinates. @return Y array.*/
+  const float *GetY() {return mp_fY;};
+  /**Gets the heights. @return Height array.*/
+  const float *GetHeight() {return mp_fHeight;};
+  /**Gets the DBHs, which are zero for seedlings. @return DBH array.*/
+  const float *GetDbh() {return mp_fDbh;};
+  /**Gets the species. @return Species array.*/
+  const short int *GetSpecies() {return mp_iSpecies;};
+  /**Gets the types. @return Type array.*/
+  const short int *GetType() {return mp_iType;};
+  /**Gets the dead codes, which are notdead for trees with no "dead" data
+  * member. @return Dead code array.*/
+  const int *GetDead() {return mp_iDead;};
+  /**Gets the trees themselves. @return Tree array.*/
+  clTree * const *GetTrees() {return mp_oTrees;};
+
+  /**
+  * Gets the crown radii, calculating them if this is the first time they have
+  * been asked for since the snapshot was built.
+  * @return Crown radius array.
+  */
+  const float *GetCrownRadius();
+
+  /**
+  * Gets the crown depths, calculating them if this is the first time they
+  * have been asked for since the snapshot was built.
+  * @return Crown depth array.
+  */
+  const float *GetCrownDepth();
+
+  /**
+  * Calls a function object once for each tree within a given distance of a
+  * point. This visits the same trees as
+  * clTreePopulation::ForEachNeighbor(), in the same cells, but each cell is a
+  * run of array elements.
+  *
+  * The function object is called as fn(iIndex, fDistanceSq), where iIndex is
+  * the tree's index in the snapshot arrays and fDistanceSq is the squared
+  * distance from the point, corrected for torus wrapping.
+  *
+  * Trees are tested against the distance and height cutoffs four at a time
+  * with FilterBlock(); only the trees that pass are checked for type and
+  * handed to the function object.
+  *
+  * @param fX X coordinate of the point.
+  * @param fY Y coordinate of the point.
+  * @param fRadius Maximum distance from the point, in meters.
+  * @param fMinHeight Trees must be taller than this, in meters. Can be zero.
+  * @param iTypeMask Which types to visit, as bits flipped by type number
+  * (1 << clTreePopulation::adult, and so on). Pass 0 to visit all types.
+  * @param fn Function object to call for each tree.
+  * @throws Error if the radius or height is negative or if the point is
+  * outside the plot.
+  */
+  template <class Visitor>
+  void ForEachNeighbor(float fX, float fY, float fRadius, float fMinHeight,
+      int iTypeMask, Visitor &fn) {
+    float fRadiusSq = fRadius * fRadius, fDX, fDY, fDistSq, fBlockDistSq[4];
+    int iMinX, iMaxX, iMinY, iMaxY, iStartDiv, iOldX, iOldY, iX, iY, iCell,
+        i, k, iEnd, iHits;
+
+    mp_oPop->GetNeighborRows(fX, fY, fRadius, fMinHeight, iMinY, iMaxY,
+        iStartDiv);
+    for (iOldY = iMinY; iOldY <= iMaxY; iOldY++) {
+      iY = iOldY;
+      if (iY < 0) iY += m_iNumYCells;
+      else if (iY >= m_iNumYCells) iY -= m_iNumYCells;
+
+      mp_oPop->GetNeighborColumns(fX, fY, fRadius, iY, iMinX, iMaxX);
+      for (iOldX = iMinX; iOldX <= iMaxX; iOldX++) {
+        iX = iOldX;
+        if (iX < 0) iX += m_iNumXCells;
+        else if (iX >= m_iNumXCells) iX -= m_iNumXCells;
+
+        iCell = iX * m_iNumYCells + iY;
+        iEnd = mp_iCellStart[iCell + 1];
+
+        //Trees are shortest first, so skip ahead past the short ones
+        i = mp_iCellStart[iCell];
+        while (i < iEnd && mp_fHeight[i] <= fMinHeight) i++;
+
+        for (; i + 4 <= iEnd; i += 4) {
+          iHits = FilterBlock(i, fX, fY, fRadiusSq, fMinHeight, fBlockDistSq);
+          for (k = 0; iHits; k++, iHits >>= 1)
+            if ((iHits & 1) &&
+                (0 == iTypeMask || ((iTypeMask >> mp_iType[i + k]) & 1)))
+              fn(i + k, fBlockDistSq[k]);
+        }
+
+        //Whatever is left over
+        for (; i < iEnd; i++) {
+          if (mp_fHeight[i] <= fMinHeight) continue;
+          if (0 != iTypeMask && 0 == ((iTypeMask >> mp_iType[i]) & 1))
+            continue;
+          fDX = fabs(mp_fX[i] - fX);
+          if (fDX > m_fPlotLengthX - fDX) fDX = m_fPlotLengthX - fDX;
+          fDY = fabs(mp_fY[i] - fY);
+          if (fDY > m_fPlotLengthY - fDY) fDY = m_fPlotLengthY - fDY;
+          fDistSq = fDX * fDX + fDY * fDY;
+          if (fDistSq <= fRadiusSq) fn(i, fDistSq);
+        }
+      }
+    }
+  };
+
+  protected:
+
+  /**
+  * Hands snapshot trees to a clTreePopulation::ForEachNeighbor() function
+  * object as tree pointers.
+  */
+  template <class Visitor>
+  struct stcTreeVisitor {
+    clTree * const *p_oTrees; /**<Snapshot trees*/
+    Visitor *p_fn; /**<Function object to call*/
+    /**
+    * Calls the function object for one tree.
+    * @param iIndex Tree's index in the snapshot arrays.
+    * @param fDistanceSq Squared distance to the tree.
+    */
+    void operator()(int iIndex, float fDistanceSq)
+        {(*p_fn)(p_oTrees[iIndex], fDistanceSq);};
+  };
+
+  /**
+  * Tests four trees in a row against a point's distance and height cutoffs.
+  * The squared distance is figured the same way as in ForEachNeighbor(), so
+  * the SSE2 and plain versions give the same answers.
+  * @param i Index of the first tree. There must be four trees from here.
+  * @param fX X coordinate of the point.
+  * @param fY Y coordinate of the point.
+  * @param fRadiusSq Square of the maximum distance.
+  * @param fMinHeight Trees must be taller than this.
+  * @param p_fDistSq Set to the four squared distances.
+  * @return Bit mask of the trees that pass, lowest bit for tree i.
+  */
+  int FilterBlock(int i, float fX, float fY, float fRadiusSq,
+      float fMinHeight, float *p_fDistSq) {
+#if defined(__SSE2__)
+    const __m128 vAbs = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff)),
+                 vLenX = _mm_set1_ps(m_fPlotLengthX),
+                 vLenY = _mm_set1_ps(m_fPlotLengthY);
+    __m128 vDX, vDY, vDistSq;
+
+    vDX = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(mp_fX + i), _mm_set1_ps(fX)),
+        vAbs);
+    vDX = _mm_min_ps(vDX, _mm_sub_ps(vLenX, vDX));
+    vDY = _mm_and_ps(_mm_sub_ps(_mm_loadu_ps(mp_fY + i), _mm_set1_ps(fY)),
+        vAbs);
+    vDY = _mm_min_ps(vDY, _mm_sub_ps(vLenY, vDY));
+    vDistSq = _mm_add_ps(_mm_mul_ps(vDX, vDX), _mm_mul_ps(vDY, vDY));
+    _mm_storeu_ps(p_fDistSq, vDistSq);
+    return _mm_movemask_ps(_mm_and_ps(
+        _mm_cmple_ps(vDistSq, _mm_set1_ps(fRadiusSq)),
+        _mm_cmpgt_ps(_mm_loadu_ps(mp_fHeight + i), _mm_set1_ps(fMinHeight))));
+#else
+    float fDX, fDY;
+    int k, iHits = 0;
+    for (k = 0; k < 4; k++) {
+      fDX = fabs(mp_fX[i + k] - fX);
+      if (fDX > m_fPlotLengthX - fDX) fDX = m_fPlotLengthX - fDX;
+      fDY = fabs(mp_fY[i + k] - fY);
+      if (fDY > m_fPlotLengthY - fDY) fDY = m_fPlotLengthY - fDY;
+      p_fDistSq[k] = fDX * fDX + fDY * fDY;
+      if (p_fDistSq[k] <= fRadiusSq && mp_fHeight[i + k] > fMinHeight)
+        iHits |= 1 << k;
+    }
+    return iHits;
+#endif
+  };
+
+  /**
+  * Copies the trees out of the hash table. Called by the tree population.
+  * Arrays are only reallocated if they are too small.
+  */
+  void Build();
+
+  /**
+  * Makes sure the per-tree arrays can hold a number of trees.
+  * @param iNumTrees Number of trees.
+  */
+  void Reserve(int iNumTrees);
+
+  /**Tree population*/
+  clTreePopulation *mp_oPop;
+
+  /**Points to the tree population's tree epoch*/
+  const unsigned long *mp_lPopEpoch;
+
+  /**Value of the tree epoch when this snapshot was built*/
+  unsigned long m_lEpoch;
+
+  float *mp_fX; /**<X coordinates. Array sized m_iCapacity.*/
+  float *mp_fY; /**<Y coordinates. Array sized m_iCapacity.*/
+  float *mp_fHeight; /**<Heights. Array sized m_iCapacity.*/
+  float *mp_fDbh; /**<DBHs. Array sized m_iCapacity.*/
+  float *mp_fCrownRadius; /**<Crown radii. Array sized m_iCapacity.*/
+  float *mp_fCrownDepth; /**<Crown depths. Array sized m_iCapacity.*/
+  short int *mp_iSpecies; /**<Species. Array sized m_iCapacity.*/
+  short int *mp_iType; /**<Types. Array sized m_iCapacity.*/
+  int *mp_iDead; /**<Dead codes. Array sized m_iCapacity.*/
+  clTree **mp_oTrees; /**<The trees. Array sized m_iCapacity.*/
+
+  /**Index of the first tree in each cell. Array sized number of cells + 1.*/
+  int *mp_iCellStart;
+
+  float m_fPlotLengthX; /**<Plot length in X, for torus distances*/
+  float m_fPlotLengthY; /**<Plot length in Y, for torus distances*/
+  int m_iNumTrees; /**<Number of trees in the snapshot*/
+  int m_iCapacity; /**<Number of trees the per-tree arrays can hold*/
+  int m_iNumXCells; /**<Number of hash table cells in X*/
+  int m_iNumYCells; /**<Number of hash table cells in Y*/
+  int m_iNumCells; /**<Number of cells mp_iCellStart was sized for*/
+  bool m_bCrownRadiusDone; /**<Whether crown radii have been calculated since
+                           the last build*/
+  bool m_bCrownDepthDone; /**<Whether crown depths have been calculated since
+                          the last build*/
+};
+
+////////////////////////////////////////////////////////////////////////////
+// clTreePopulation::ForEachNeighbor()
+////////////////////////////////////////////////////////////////////////////
+template <class Visitor>
+void clTreePopulation::ForEachNeighbor(float fX, float fY, float fRadius,
+    float fMinHeight, int iTypeMask, Visitor &fn) {
+  clTree *p_oTree;
+  float fRadiusSq = fRadius * fRadius, fDX, fDY, fDistSq;
+  int iMinX, iMaxX, iMinY, iMaxY, iStartDiv, iOldX, iOldY, iX, iY, iDiv,
+      iSp, iTp;
+
+  //A current snapshot has the same trees in the same order, packed so they
+  //can be filtered four at a time
+  if (mp_oSnapshot && mp_oSnapshot->IsCurrent()) {
+    clTreeSnapshot::stcTreeVisitor<Visitor> oVisitor;
+    oVisitor.p_oTrees = mp_oSnapshot->GetTrees();
+    oVisitor.p_fn = &fn;
+    mp_oSnapshot->ForEachNeighbor(fX, fY, fRadius, fMinHeight, iTypeMask,
+        oVisitor);
+    return;
+  }
+
+  GetNeighborRows(fX, fY, fRadius, fMinHeight, iMinY, iMaxY, iStartDiv);
+  for (iOldY = iMinY; iOldY <= iMaxY; iOldY++) {
+    iY = iOldY;
+    if (iY < 0) iY += m_iNumYCells;
+    else if (iY >= m_iNumYCells) iY -= m_iNumYCells;
+
+    GetNeighborColumns(fX, fY, fRadius, iY, iMinX, iMaxX);
+    for (iOldX = iMinX; iOldX <= iMaxX; iOldX++) {
+      iX = iOldX;
+      if (iX < 0) iX += m_iNumXCells;
+      else if (iX >= m_iNumXCells) iX -= m_iNumXCells;
+
+      //Find the first tree at or above the starting height division
+      p_oTree = NULL;
+      for (iDiv = iStartDiv; iDiv < m_iNumHeightDivs && !p_oTree; iDiv++)
+        p_oTree = mp_oTreeShortest[iX][iY][iDiv];
+
+      while (p_oTree) {
+        iSp = p_oTree->m_iSpecies; iTp = p_oTree->m_iType;
+        if ((0 == iTypeMask || ((iTypeMask >> iTp) & 1)) &&
+            TreeFloat(p_oTree, mp_iHeightCode[iSp][iTp]) > fMinHeight) {
+          fDX = fabs(TreeFloat(p_oTree, mp_iXCode[iSp][iTp]) - fX);
+          if (fDX > m_fPlotLengthX - fDX) fDX = m_fPlotLengthX - fDX;
+          fDY = fabs(TreeFloat(p_oTree, mp_iYCode[iSp][iTp]) - fY);
+          if (fDY > m_fPlotLengthY - fDY) fDY = m_fPlotLengthY - fDY;
+          fDistSq = fDX * fDX + fDY * fDY;
+          if (fDistSq <= fRadiusSq) fn(p_oTree, fDistSq);
+        }
+        p_oTree = p_oTree->mp_oNext;
+      }
+    }
+  }
+}
+//---------------------------------------------------------------------------
+#endif
@@ -0,0 +1,388 @@
+//---------------------------------------------------------------------------
+// GLIFisheyeBench.cpp
+//
+// Standalone equivalence check and microbenchmark for the azimuth chunk
+// search in clGLIBase::GLIFisheyeNoCanopyIntersect().  It holds a copy of the
+// old search (step chunk by chunk from the neighbor's azimuth, solving a
+// quadratic for each, with the home chunk from clPlot::GetFastAzimuthAngle())
+// and of the current one (find the blocked span directly with atan2 and
+// asin).  Both fill a fisheye photo for the same random neighbors; the photos
+// are compared cell by cell and then each routine is timed.
+//
+// This does not link against the model.  If either routine in GLIBase.cpp or
+// GetFastAzimuthAngle() in Plot.cpp changes, change the copy here to match.
+//
+// Build and run:
+//   g++ -O2 -o GLIFisheyeBench GLIFisheyeBench.cpp -lm
+//   ./GLIFisheyeBench [altitude divisions] [azimuth divisions] [neighbors]
+// The defaults are 18, 72 and 200000.
+//---------------------------------------------------------------------------
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+#define CONVERT_TO_RADIANS 0.0174532925199433
+
+//Stand-ins for the clGLIBase and clPlot members the routines use
+int m_iNumAltAng = 18; /**<Number of altitude divisions*/
+int m_iNumAziAng = 72; /**<Number of azimuth divisions*/
+int m_iMinAngRow; /**<First altitude row above the minimum sun angle*/
+float m_fAziChunkConverter; /**<Degrees to azimuth chunks*/
+float *mp_fAziSlope; /**<Slope of the line through each azimuth chunk center*/
+float *mp_fAziTans; /**<Tangent of each whole degree, as clPlot keeps it*/
+
+//////////////////////////////////////////////////////////////////////////////
+// GetFastAzimuthAngle()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Copy of clPlot::GetFastAzimuthAngle(), taking the distances directly.
+*/
+int GetFastAzimuthAngle(float fDistX, float fDistY) {
+  int i, iAzimuth = -1;
+  float fTanAzimuth;
+
+  if (fDistY == 0) {
+    if (fDistX > 0) return 90;
+    else if (fDistX < 0) return 270;
+    else return 0;
+  }
+  else if (fDistX == 0) {
+    if (fDistY > 0) return 0;
+    else return 180;
+  }
+
+  fTanAzimuth = fDistX / fDistY;
+  if (fTanAzimuth > 9999) fTanAzimuth = 9999;
+
+  if ((fDistY > 0) && (fDistX >= 0)) {
+    for (i = 0; i < 91; i++)
+      if (mp_fAziTans[i] <= fTanAzimuth && mp_fAziTans[i + 1] > fTanAzimuth) {
+        iAzimuth = i; break;
+      }
+  }
+  else if ((fDistX > 0) && (fDistY <= 0)) {
+    if (fTanAzimuth < mp_fAziTans[91]) return 90;
+    for (i = 91; i < 180; i++)
+      if (mp_fAziTans[i] <= fTanAzimuth && mp_fAziTans[i + 1] > fTanAzimuth) {
+        iAzimuth = i; break;
+      }
+  }
+  else if ((fDistX <= 0) && (fDistY < 0)) {
+    if (fTanAzimuth < mp_fAziTans[180]) return 180;
+    for (i = 180; i < 271; i++)
+      if (mp_fAziTans[i] <= fTanAzimuth && mp_fAziTans[i + 1] > fTanAzimuth) {
+        iAzimuth = i; break;
+      }
+  }
+  else if ((fDistX < 0) && (fDistY >= 0)) {
+    if (fTanAzimuth < mp_fAziTans[271]) return 270;
+    for (i = 271; i < 359; i++) {
+      if (mp_fAziTans[i] <= fTanAzimuth && mp_fAziTans[i + 1] > fTanAzimuth) {
+        iAzimuth = i; break;
+      }
+      if (iAzimuth < 0) iAzimuth = 359;
+    }
+  }
+  return iAzimuth;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// FillAltitudes()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Multiplies the light extinction coefficient into one azimuth chunk's
+* altitude range, as both versions do.
+*/
+inline void FillAltitudes(float fSquareOfNearDist, float fSquareOfFarDist,
+    float fHeightDiffChunkConv, float fHeightDiffSquared,
+    float fCrownBaseDiffChunkConv, float fCrownBaseDiffSquared,
+    float fLightExtCoeff, int iAziChunk, float **p_fPhoto) {
+  int iAltStart, iAltEnd, i;
+  iAltStart = (int) (fCrownBaseDiffChunkConv /
+               sqrt((double)(fSquareOfFarDist + fCrownBaseDiffSquared)));
+  if (iAltStart < m_iMinAngRow) iAltStart = m_iMinAngRow;
+  iAltEnd = (int) (fHeightDiffChunkConv /
+               sqrt((double)(fSquareOfNearDist + fHeightDiffSquared)));
+  if (iAltEnd >= m_iNumAltAng) iAltEnd = m_iNumAltAng - 1;
+  for (i = iAltStart; i <= iAltEnd; i++)
+    p_fPhoto[i][iAziChunk] *= fLightExtCoeff;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// OldFisheye()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* The azimuth search as it was before the direct span calculation.
+*/
+void OldFisheye(float fXDist, float fYDist, float fNeighCanrad,
+    float fHeightDiff, float fCrownBaseDiff, float fLightExtCoeff,
+    float **p_fPhoto) {
+  float fSquareOfNearDist, fSquareOfFarDist, fFarX, fNearX, fFarY, fNearY,
+        fA, fB, fC, fNeighAzi, fAziChunkSlope,
+        fHeightDiffSquared = fHeightDiff * fHeightDiff,
+        fHeightDiffChunkConv = fHeightDiff * m_iNumAltAng,
+        fCrownBaseDiffSquared = fCrownBaseDiff * fCrownBaseDiff,
+        fCrownBaseDiffChunkConv = fCrownBaseDiff * m_iNumAltAng;
+  int iAziChunkIncrementer = -1, iHomeAziChunk, iAziChunk,
+      iChunkCounter = 0, iHalfTheAzis = m_iNumAziAng/2;
+
+  fAziChunkSlope = (fXDist == 0) ? 100000.0 : fYDist / fXDist;
+  fNeighAzi = GetFastAzimuthAngle(fXDist, fYDist);
+  iHomeAziChunk = (int)floor(fNeighAzi * m_fAziChunkConverter);
+  iAziChunk = iHomeAziChunk;
+
+  while (1) {
+    fA = 1.0 + fAziChunkSlope * fAziChunkSlope;
+    fB = -2.0 * (fXDist + fAziChunkSlope * fYDist);
+    fC = fYDist * fYDist + fXDist * fXDist - fNeighCanrad * fNeighCanrad;
+    fC = fB * fB - 4.0 * fA * fC;
+
+    if (fC >= 0.0) {
+      fC = sqrt((double) fC);
+      fNearX = (-fB - fC) / (2.0 * fA);
+      fFarX = (-fB + fC) / (2.0 * fA);
+      fNearY = fAziChunkSlope * fNearX;
+      fFarY = fAziChunkSlope * fFarX;
+      fSquareOfNearDist = fNearX * fNearX + fNearY * fNearY;
+      fSquareOfFarDist = fFarX * fFarX + fFarY * fFarY;
+      if (fSquareOfNearDist > fSquareOfFarDist) {
+        fA = fSquareOfNearDist;
+        fSquareOfNearDist = fSquareOfFarDist;
+        fSquareOfFarDist = fA;
+      }
+      FillAltitudes(fSquareOfNearDist, fSquareOfFarDist, fHeightDiffChunkConv,
+          fHeightDiffSquared, fCrownBaseDiffChunkConv, fCrownBaseDiffSquared,
+          fLightExtCoeff, iAziChunk, p_fPhoto);
+    }
+    else if (iAziChunkIncrementer == 1) return;
+    else {
+      iAziChunk = iHomeAziChunk;
+      iAziChunkIncrementer = 1;
+      iChunkCounter = 0;
+    }
+
+    iAziChunk += iAziChunkIncrementer;
+    iChunkCounter++;
+    if (iChunkCounter == iHalfTheAzis) return;
+    if (iAziChunk < 0) iAziChunk = m_iNumAziAng - 1;
+    else if (iAziChunk == m_iNumAziAng) iAziChunk = 0;
+    fAziChunkSlope = mp_fAziSlope[iAziChunk];
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// NewFisheye()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* The azimuth search as it is now in GLIFisheyeNoCanopyIntersect().
+*/
+void NewFisheye(float fXDist, float fYDist, float fNeighCanrad,
+    float fHeightDiff, float fCrownBaseDiff, float fLightExtCoeff,
+    float **p_fPhoto) {
+  float fNearDist, fFarDist, fDistance, fCanradSquared, fNeighAzi, fHalfWidth,
+        fChunkSize, fCosChunk, fSinChunk, fChunkX, fChunkY, fTemp, fAlong,
+        fAcross, fHalfChord,
+        fHeightDiffSquared = fHeightDiff * fHeightDiff,
+        fHeightDiffChunkConv = fHeightDiff * m_iNumAltAng,
+        fCrownBaseDiffSquared = fCrownBaseDiff * fCrownBaseDiff,
+        fCrownBaseDiffChunkConv = fCrownBaseDiff * m_iNumAltAng;
+  int iHomeAziChunk, iFirstChunk, iLastChunk, iNumWest, iNumEast,
+      iHalfTheAzis = m_iNumAziAng/2, iAziChunk, j;
+
+  fDistance = sqrt(fXDist * fXDist + fYDist * fYDist);
+  fCanradSquared = fNeighCanrad * fNeighCanrad;
+
+  fChunkSize = (2.0 * M_PI) / m_iNumAziAng;
+  fNeighAzi = atan2(fXDist, fYDist);
+  if (fNeighAzi < 0) fNeighAzi += 2.0 * M_PI;
+  iHomeAziChunk = (int)floor(fNeighAzi / fChunkSize);
+  if (iHomeAziChunk >= m_iNumAziAng) iHomeAziChunk = m_iNumAziAng - 1;
+  fHalfWidth = fNeighCanrad >= fDistance ? M_PI / 2.0 :
+      asin(fNeighCanrad / fDistance);
+  iFirstChunk = (int)ceil((fNeighAzi - fHalfWidth) / fChunkSize - 0.5);
+  iLastChunk = (int)floor((fNeighAzi + fHalfWidth) / fChunkSize - 0.5);
+  iNumWest = iHomeAziChunk - iFirstChunk;
+  iNumEast = iLastChunk - iHomeAziChunk;
+  if (iNumWest < 0) iNumWest = 0;
+  if (iNumEast < 0) iNumEast = 0;
+  if (iNumWest >= iHalfTheAzis - 1) {
+    iNumWest = iHalfTheAzis - 1;
+    iNumEast = 0;
+  }
+  else if (iNumEast > iHalfTheAzis - 1) iNumEast = iHalfTheAzis - 1;
+  if (iNumWest < 0) iNumWest = 0;
+  if (iNumEast < 0) iNumEast = 0;
+
+  fCosChunk = cos(fChunkSize);
+  fSinChunk = sin(fChunkSize);
+  fTemp = (iHomeAziChunk - iNumWest + 0.5) * fChunkSize;
+  fChunkX = sin(fTemp);
+  fChunkY = cos(fTemp);
+  iAziChunk = iHomeAziChunk - iNumWest;
+  if (iAziChunk < 0) iAziChunk += m_iNumAziAng;
+  for (j = -iNumWest; j <= iNumEast; j++) {
+    if (0 == j) {
+      fNearDist = fDistance - fNeighCanrad;
+      fFarDist = fDistance + fNeighCanrad;
+    } else {
+      fAlong = fXDist * fChunkX + fYDist * fChunkY;
+      fAcross = fXDist * fChunkY - fYDist * fChunkX;
+      fHalfChord = fCanradSquared - fAcross * fAcross;
+      fHalfChord = fHalfChord > 0 ? sqrt(fHalfChord) : 0;
+      fNearDist = fAlong - fHalfChord;
+      fFarDist = fAlong + fHalfChord;
+    }
+    FillAltitudes(fNearDist * fNearDist, fFarDist * fFarDist,
+        fHeightDiffChunkConv, fHeightDiffSquared, fCrownBaseDiffChunkConv,
+        fCrownBaseDiffSquared, fLightExtCoeff, iAziChunk, p_fPhoto);
+
+    fTemp = fChunkX * fCosChunk + fChunkY * fSinChunk;
+    fChunkY = fChunkY * fCosChunk - fChunkX * fSinChunk;
+    fChunkX = fTemp;
+    iAziChunk++;
+    if (iAziChunk == m_iNumAziAng) iAziChunk = 0;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// ClearPhoto()
+//////////////////////////////////////////////////////////////////////////////
+void ClearPhoto(float **p_fPhoto) {
+  int i, j;
+  for (i = 0; i < m_iNumAltAng; i++)
+    for (j = 0; j < m_iNumAziAng; j++)
+      p_fPhoto[i][j] = 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// main()
+//////////////////////////////////////////////////////////////////////////////
+int main(int argc, char **argv) {
+  float **p_fOldPhoto, **p_fNewPhoto, *p_fX, *p_fY, *p_fRadius, *p_fHeight,
+        *p_fBase, fAngChunk, fRadius, fDist, fAngle;
+  double fOldGli, fNewGli, fMaxGliDiff = 0;
+  clock_t tStart, tOld, tNew;
+  long lNumCellsDiff = 0;
+  int iNumNeighbors = 200000, iNumCasesDiff = 0, iCellsDiff, iRep, i, j, n;
+
+  if (argc > 2) {
+    m_iNumAltAng = atoi(argv[1]);
+    m_iNumAziAng = atoi(argv[2]);
+  }
+  if (argc > 3) iNumNeighbors = atoi(argv[3]);
+  if (m_iNumAltAng <= 0 || m_iNumAziAng <= 1 || iNumNeighbors <= 0) {
+    fprintf(stderr, "Usage: %s [altitude divisions] [azimuth divisions] "
+        "[neighbors]\n", argv[0]);
+    return 1;
+  }
+
+  //Set up the tables the way clPlot and clGLILight do, with a 15 degree
+  //minimum sun angle
+  mp_fAziTans = new float[360];
+  for (i = 0; i < 360; i++)
+    mp_fAziTans[i] = (i == 90 || i == 270) ? 10000 :
+        tan(i * CONVERT_TO_RADIANS);
+  m_iMinAngRow = (int)floor(sin(15 * CONVERT_TO_RADIANS) * m_iNumAltAng);
+  m_fAziChunkConverter = m_iNumAziAng/360.0;
+  mp_fAziSlope = new float[m_iNumAziAng];
+  fAngChunk = (2.0 * M_PI) / m_iNumAziAng;
+  for (i = 0; i < m_iNumAziAng/2; i++) {
+    mp_fAziSlope[i] = 1/(tan(fAngChunk*(i + 0.5)));
+    mp_fAziSlope[i + m_iNumAziAng/2] = mp_fAziSlope[i];
+  }
+
+  p_fOldPhoto = new float*[m_iNumAltAng];
+  p_fNewPhoto = new float*[m_iNumAltAng];
+  for (i = 0; i < m_iNumAltAng; i++) {
+    p_fOldPhoto[i] = new float[m_iNumAziAng];
+    p_fNewPhoto[i] = new float[m_iNumAziAng];
+  }
+
+  //Random neighbors: crown radius 0.5 - 10 m, from just outside the crown
+  //to 60 m beyond it, in any direction, 2 - 40 m taller than the target, with
+  //crowns 20 - 80% of that
+  p_fX = new float[iNumNeighbors];
+  p_fY = new float[iNumNeighbors];
+  p_fRadius = new float[iNumNeighbors];
+  p_fHeight = new float[iNumNeighbors];
+  p_fBase = new float[iNumNeighbors];
+  srand(7);
+  for (n = 0; n < iNumNeighbors; n++) {
+    fRadius = 0.5 + 9.5 * rand() / (float)RAND_MAX;
+    fDist = fRadius * 1.0001 + 60.0 * rand() / (float)RAND_MAX;
+    fAngle = 2 * M_PI * rand() / (float)RAND_MAX;
+    p_fX[n] = fDist * sin(fAngle);
+    p_fY[n] = fDist * cos(fAngle);
+    p_fRadius[n] = fRadius;
+    p_fHeight[n] = 2 + 38 * rand() / (float)RAND_MAX;
+    p_fBase[n] = p_fHeight[n] * (0.2 + 0.6 * rand() / (float)RAND_MAX);
+  }
+
+  //Equivalence: one neighbor per photo, compared cell by cell and as GLI
+  //under a uniform sky
+  for (n = 0; n < iNumNeighbors; n++) {
+    ClearPhoto(p_fOldPhoto);
+    ClearPhoto(p_fNewPhoto);
+    OldFisheye(p_fX[n], p_fY[n], p_fRadius[n], p_fHeight[n],
+        p_fHeight[n] - p_fBase[n], 0.5, p_fOldPhoto);
+    NewFisheye(p_fX[n], p_fY[n], p_fRadius[n], p_fHeight[n],
+        p_fHeight[n] - p_fBase[n], 0.5, p_fNewPhoto);
+    iCellsDiff = 0;
+    fOldGli = 0;
+    fNewGli = 0;
+    for (i = 0; i < m_iNumAltAng; i++)
+      for (j = 0; j < m_iNumAziAng; j++) {
+        if (p_fOldPhoto[i][j] != p_fNewPhoto[i][j]) iCellsDiff++;
+        fOldGli += p_fOldPhoto[i][j];
+        fNewGli += p_fNewPhoto[i][j];
+      }
+    if (iCellsDiff > 0) {
+      iNumCasesDiff++;
+      lNumCellsDiff += iCellsDiff;
+    }
+    fOldGli = fabs(fOldGli - fNewGli) * 100.0 / (m_iNumAltAng * m_iNumAziAng);
+    if (fOldGli > fMaxGliDiff) fMaxGliDiff = fOldGli;
+  }
+  printf("%d x %d sky, %d neighbors: %d photos differ (%.3f%%), %ld cells, "
+      "max GLI difference %.4f\n", m_iNumAltAng, m_iNumAziAng, iNumNeighbors,
+      iNumCasesDiff, 100.0 * iNumCasesDiff / iNumNeighbors, lNumCellsDiff,
+      fMaxGliDiff);
+
+  //Timing: all neighbors into one photo, with a coefficient near 1 so the
+  //photo doesn't underflow
+  for (iRep = 0; iRep < 3; iRep++) {
+    ClearPhoto(p_fOldPhoto);
+    ClearPhoto(p_fNewPhoto);
+    tStart = clock();
+    for (n = 0; n < iNumNeighbors; n++)
+      OldFisheye(p_fX[n], p_fY[n], p_fRadius[n], p_fHeight[n],
+          p_fHeight[n] - p_fBase[n], 0.999, p_fOldPhoto);
+    tOld = clock();
+    for (n = 0; n < iNumNeighbors; n++)
+      NewFisheye(p_fX[n], p_fY[n], p_fRadius[n], p_fHeight[n],
+          p_fHeight[n] - p_fBase[n], 0.999, p_fNewPhoto);
+    tNew = clock();
+    printf("  old %.1f ns/neighbor, new %.1f ns/neighbor\n",
+        1e9 * (tOld - tStart) / CLOCKS_PER_SEC / iNumNeighbors,
+        1e9 * (tNew - tOld) / CLOCKS_PER_SEC / iNumNeighbors);
+  }
+
+  for (i = 0; i < m_iNumAltAng; i++) {
+    delete[] p_fOldPhoto[i];
+    delete[] p_fNewPhoto[i];
+  }
+  delete[] p_fOldPhoto;
+  delete[] p_fNewPhoto;
+  delete[] p_fX;
+  delete[] p_fY;
+  delete[] p_fRadius;
+  delete[] p_fHeight;
+  delete[] p_fBase;
+  delete[] mp_fAziSlope;
+  delete[] mp_fAziTans;
+  return 0;
+}
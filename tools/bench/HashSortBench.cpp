@@ -0,0 +1,424 @@
+//---------------------------------------------------------------------------
+// HashSortBench.cpp
+//
+// Standalone equivalence check and benchmark for the per-cell sort in
+// clTreePopulation::SortHashTable().  It holds a copy of the old sort (an
+// insertion sort done on the linked list itself, then a pass comparing each
+// tree to its neighbors for the height division pointers) and of the current
+// one (gather into an array, repair with an insertion sort, falling back to a
+// bulk merge sort if a big cell needs too much shifting, then relink in one
+// pass).  Trees here carry only their height and
+// links; the old sort's height lookups are plain reads, so the timings favor
+// it slightly.
+//
+// Each cell starts sorted, then the given share of its trees have their
+// heights changed by up to 30%, as growth would.  A share of -1 gives every
+// tree a random height instead, so the cell is shuffled.  Both sorts get the
+// same cells; the resulting orders and height division pointers are compared
+// and each sort is timed.
+//
+// This does not link against the model.  If SortHashTable(),
+// HASH_SORT_MIN_BULK or HASH_SORT_MOVE_RATIO changes, change the copy here to
+// match.
+//
+// Build and run:
+//   g++ -O2 -o HashSortBench HashSortBench.cpp
+//   ./HashSortBench [cells] [trees per cell] [share perturbed, 0 - 1, or -1]
+// With no arguments, it runs a table of cell sizes and shares.
+//---------------------------------------------------------------------------
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define HASH_SORT_MIN_BULK 64
+#define HASH_SORT_MOVE_RATIO 64
+#define NUM_HEIGHT_DIVS 10
+#define SIZE_HEIGHT_DIVS 5
+
+/**Just enough of clTree for sorting*/
+struct stcTree {
+  float fHeight; /**<Tree height*/
+  int iId; /**<Where the tree started, for comparing orders*/
+  stcTree *mp_oNext; /**<Next taller tree*/
+  stcTree *mp_oPrevious; /**<Next shorter tree*/
+};
+
+/**One hash table cell*/
+struct stcCell {
+  stcTree *mp_oTreeShortest[NUM_HEIGHT_DIVS]; /**<Shortest in each division*/
+  stcTree *mp_oTreeTallest[NUM_HEIGHT_DIVS]; /**<Tallest in each division*/
+};
+
+stcTree **mp_oSortTrees = NULL; /**<Scratch trees, as in clTreePopulation*/
+float *mp_fSortHeights = NULL; /**<Scratch heights, as in clTreePopulation*/
+int m_iSortCapacity = 0; /**<Size of each half of the scratch space*/
+long m_lNumCellsRepaired = 0; /**<Cells repaired with an insertion sort*/
+long m_lNumCellsBulkSorted = 0; /**<Cells bulk sorted with a merge sort*/
+
+//////////////////////////////////////////////////////////////////////////////
+// GetHeightDiv()
+//////////////////////////////////////////////////////////////////////////////
+int GetHeightDiv(float fHeight) {
+  int iHeightDiv = (int)floor(fHeight / SIZE_HEIGHT_DIVS);
+  return iHeightDiv < NUM_HEIGHT_DIVS - 1 ? iHeightDiv : NUM_HEIGHT_DIVS - 1;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// OldSortCell()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* One cell of SortHashTable() as it was before the array sort.
+*/
+void OldSortCell(stcCell *p_oCell) {
+  stcTree *p_oTargetTree = NULL, *p_oNeighbor, *p_oOldShorter, *p_oOldTaller,
+          *p_oNewShorter = NULL;
+  int iHeightDiv, k;
+  bool bMove;
+
+  for (k = NUM_HEIGHT_DIVS - 1; k >= 0; k--) {
+    p_oTargetTree = p_oCell->mp_oTreeTallest[k];
+    if (p_oTargetTree) break;
+  }
+  while (p_oTargetTree) {
+    bMove = false;
+    p_oOldShorter = p_oTargetTree->mp_oPrevious;
+    p_oOldTaller = p_oTargetTree->mp_oNext;
+    p_oNeighbor = p_oOldTaller;
+    while (p_oNeighbor) {
+      if (p_oNeighbor->fHeight >= p_oTargetTree->fHeight) break;
+      else bMove = true;
+      p_oNewShorter = p_oNeighbor;
+      p_oNeighbor = p_oNeighbor->mp_oNext;
+    }
+    if (bMove) {
+      if (p_oOldShorter) p_oOldShorter->mp_oNext = p_oOldTaller;
+      if (p_oOldTaller) p_oOldTaller->mp_oPrevious = p_oOldShorter;
+      if (p_oNeighbor) {
+        p_oNewShorter = p_oNeighbor->mp_oPrevious;
+        p_oNewShorter->mp_oNext = p_oTargetTree;
+        p_oNeighbor->mp_oPrevious = p_oTargetTree;
+        p_oTargetTree->mp_oNext = p_oNeighbor;
+        p_oTargetTree->mp_oPrevious = p_oNewShorter;
+      }
+      else {
+        p_oNewShorter->mp_oNext = p_oTargetTree;
+        p_oTargetTree->mp_oPrevious = p_oNewShorter;
+        p_oTargetTree->mp_oNext = NULL;
+      }
+    }
+    p_oTargetTree = p_oOldShorter;
+  }
+
+  //Height division pointers
+  for (k = 0; k < NUM_HEIGHT_DIVS; k++) {
+    p_oTargetTree = p_oCell->mp_oTreeShortest[k];
+    if (p_oTargetTree) break;
+  }
+  for (k = 0; k < NUM_HEIGHT_DIVS; k++) {
+    p_oCell->mp_oTreeShortest[k] = NULL;
+    p_oCell->mp_oTreeTallest[k] = NULL;
+  }
+  if (!p_oTargetTree) return;
+  while (p_oTargetTree->mp_oPrevious)
+    p_oTargetTree = p_oTargetTree->mp_oPrevious;
+  while (p_oTargetTree) {
+    iHeightDiv = GetHeightDiv(p_oTargetTree->fHeight);
+    p_oOldTaller = p_oTargetTree->mp_oNext;
+    if (!p_oOldTaller || GetHeightDiv(p_oOldTaller->fHeight) != iHeightDiv)
+      p_oCell->mp_oTreeTallest[iHeightDiv] = p_oTargetTree;
+    p_oOldShorter = p_oTargetTree->mp_oPrevious;
+    if (!p_oOldShorter || GetHeightDiv(p_oOldShorter->fHeight) != iHeightDiv)
+      p_oCell->mp_oTreeShortest[iHeightDiv] = p_oTargetTree;
+    p_oTargetTree = p_oOldTaller;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// MergeSortCell()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Copy of clTreePopulation::MergeSortCell().
+*/
+void MergeSortCell(int iNumTrees) {
+  stcTree **p_oFrom = mp_oSortTrees, **p_oTo = mp_oSortTrees + m_iSortCapacity,
+          **p_oSwapTrees;
+  float *p_fFrom = mp_fSortHeights, *p_fTo = mp_fSortHeights + m_iSortCapacity,
+        *p_fSwapHeights;
+  int iWidth, iLeft, iMid, iRight, a, b, c;
+
+  for (iWidth = 1; iWidth < iNumTrees; iWidth *= 2) {
+    for (iLeft = 0; iLeft < iNumTrees; iLeft += 2 * iWidth) {
+      iMid = iLeft + iWidth < iNumTrees ? iLeft + iWidth : iNumTrees;
+      iRight = iLeft + 2 * iWidth < iNumTrees ? iLeft + 2 * iWidth : iNumTrees;
+      a = iLeft; b = iMid; c = iLeft;
+      while (a < iMid && b < iRight) {
+        if (p_fFrom[b] < p_fFrom[a]) {
+          p_oTo[c] = p_oFrom[b]; p_fTo[c] = p_fFrom[b]; b++;
+        }
+        else {
+          p_oTo[c] = p_oFrom[a]; p_fTo[c] = p_fFrom[a]; a++;
+        }
+        c++;
+      }
+      while (a < iMid) {
+        p_oTo[c] = p_oFrom[a]; p_fTo[c] = p_fFrom[a]; a++; c++;
+      }
+      while (b < iRight) {
+        p_oTo[c] = p_oFrom[b]; p_fTo[c] = p_fFrom[b]; b++; c++;
+      }
+    }
+    p_oSwapTrees = p_oFrom; p_oFrom = p_oTo; p_oTo = p_oSwapTrees;
+    p_fSwapHeights = p_fFrom; p_fFrom = p_fTo; p_fTo = p_fSwapHeights;
+  }
+
+  if (p_oFrom != mp_oSortTrees)
+    for (a = 0; a < iNumTrees; a++) {
+      mp_oSortTrees[a] = p_oFrom[a];
+      mp_fSortHeights[a] = p_fFrom[a];
+    }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// NewSortCell()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* One cell of SortHashTable() as it is now.
+*/
+void NewSortCell(stcCell *p_oCell) {
+  stcTree *p_oTree = NULL, **p_oNewTrees;
+  float fHeight, *p_fNewHeights;
+  long lMoves, lMaxMoves;
+  int iNumTrees = 0, iNumDescents = 0, iHeightDiv, iLastDiv, iCapacity, k, m, n;
+
+  for (k = 0; k < NUM_HEIGHT_DIVS && !p_oTree; k++)
+    p_oTree = p_oCell->mp_oTreeShortest[k];
+  if (!p_oTree) return;
+  while (p_oTree->mp_oPrevious) p_oTree = p_oTree->mp_oPrevious;
+
+  while (p_oTree) {
+    if (iNumTrees == m_iSortCapacity) {
+      iCapacity = 0 == m_iSortCapacity ? 256 : m_iSortCapacity * 2;
+      p_oNewTrees = new stcTree*[iCapacity * 2];
+      p_fNewHeights = new float[iCapacity * 2];
+      for (m = 0; m < iNumTrees; m++) {
+        p_oNewTrees[m] = mp_oSortTrees[m];
+        p_fNewHeights[m] = mp_fSortHeights[m];
+      }
+      delete[] mp_oSortTrees;
+      delete[] mp_fSortHeights;
+      mp_oSortTrees = p_oNewTrees;
+      mp_fSortHeights = p_fNewHeights;
+      m_iSortCapacity = iCapacity;
+    }
+    fHeight = p_oTree->fHeight;
+    if (iNumTrees > 0 && mp_fSortHeights[iNumTrees - 1] > fHeight)
+      iNumDescents++;
+    mp_oSortTrees[iNumTrees] = p_oTree;
+    mp_fSortHeights[iNumTrees] = fHeight;
+    iNumTrees++;
+    p_oTree = p_oTree->mp_oNext;
+  }
+
+  if (iNumDescents > 0) {
+    lMaxMoves = iNumTrees < HASH_SORT_MIN_BULK ? -1 :
+        (long)iNumTrees * HASH_SORT_MOVE_RATIO;
+    lMoves = 0;
+    for (m = 1; m < iNumTrees; m++) {
+      p_oTree = mp_oSortTrees[m];
+      fHeight = mp_fSortHeights[m];
+      for (n = m - 1; n >= 0 && mp_fSortHeights[n] > fHeight; n--) {
+        mp_oSortTrees[n + 1] = mp_oSortTrees[n];
+        mp_fSortHeights[n + 1] = mp_fSortHeights[n];
+      }
+      mp_oSortTrees[n + 1] = p_oTree;
+      mp_fSortHeights[n + 1] = fHeight;
+      lMoves += m - 1 - n;
+      if (lMaxMoves >= 0 && lMoves > lMaxMoves) break;
+    }
+    if (m < iNumTrees) {
+      MergeSortCell(iNumTrees);
+      m_lNumCellsBulkSorted++;
+    }
+    else m_lNumCellsRepaired++;
+  }
+
+  for (k = 0; k < NUM_HEIGHT_DIVS; k++) {
+    p_oCell->mp_oTreeShortest[k] = NULL;
+    p_oCell->mp_oTreeTallest[k] = NULL;
+  }
+  iLastDiv = -1;
+  for (m = 0; m < iNumTrees; m++) {
+    p_oTree = mp_oSortTrees[m];
+    p_oTree->mp_oPrevious = m > 0 ? mp_oSortTrees[m - 1] : NULL;
+    p_oTree->mp_oNext = m < iNumTrees - 1 ? mp_oSortTrees[m + 1] : NULL;
+    iHeightDiv = GetHeightDiv(mp_fSortHeights[m]);
+    if (iHeightDiv != iLastDiv) {
+      p_oCell->mp_oTreeShortest[iHeightDiv] = p_oTree;
+      iLastDiv = iHeightDiv;
+    }
+    p_oCell->mp_oTreeTallest[iHeightDiv] = p_oTree;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// BuildCells()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Links each cell's trees in their starting order and sets the height
+* division pointers the way they were before the heights changed.  The
+* pointers only need to reach into the list, which is all either sort uses
+* them for.
+*/
+void BuildCells(stcTree *p_oTrees, stcCell *p_oCells, int iNumCells,
+    int iNumPerCell, const float *p_fHeights) {
+  stcTree *p_oTree;
+  int i, k, m;
+  for (i = 0; i < iNumCells; i++) {
+    for (k = 0; k < NUM_HEIGHT_DIVS; k++) {
+      p_oCells[i].mp_oTreeShortest[k] = NULL;
+      p_oCells[i].mp_oTreeTallest[k] = NULL;
+    }
+    for (m = 0; m < iNumPerCell; m++) {
+      p_oTree = p_oTrees + i * iNumPerCell + m;
+      p_oTree->fHeight = p_fHeights[i * iNumPerCell + m];
+      p_oTree->iId = i * iNumPerCell + m;
+      p_oTree->mp_oPrevious = m > 0 ? p_oTree - 1 : NULL;
+      p_oTree->mp_oNext = m < iNumPerCell - 1 ? p_oTree + 1 : NULL;
+    }
+    p_oCells[i].mp_oTreeShortest[0] = p_oTrees + i * iNumPerCell;
+    p_oCells[i].mp_oTreeTallest[NUM_HEIGHT_DIVS - 1] =
+        p_oTrees + (i + 1) * iNumPerCell - 1;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// SameCells()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Whether two sets of sorted cells have the same tree order and height
+* division pointers.
+*/
+bool SameCells(stcCell *p_oOld, stcTree *p_oOldTrees, stcCell *p_oNew,
+    stcTree *p_oNewTrees, int iNumCells) {
+  stcTree *p_oOldTree, *p_oNewTree;
+  int i, k;
+  for (i = 0; i < iNumCells; i++) {
+    for (k = 0; k < NUM_HEIGHT_DIVS; k++) {
+      p_oOldTree = p_oOld[i].mp_oTreeShortest[k];
+      p_oNewTree = p_oNew[i].mp_oTreeShortest[k];
+      if ((p_oOldTree ? p_oOldTree - p_oOldTrees : -1) !=
+          (p_oNewTree ? p_oNewTree - p_oNewTrees : -1)) return false;
+      p_oOldTree = p_oOld[i].mp_oTreeTallest[k];
+      p_oNewTree = p_oNew[i].mp_oTreeTallest[k];
+      if ((p_oOldTree ? p_oOldTree - p_oOldTrees : -1) !=
+          (p_oNewTree ? p_oNewTree - p_oNewTrees : -1)) return false;
+    }
+    for (k = 0; k < NUM_HEIGHT_DIVS && !p_oOld[i].mp_oTreeShortest[k]; k++);
+    if (k == NUM_HEIGHT_DIVS) continue;
+    p_oOldTree = p_oOld[i].mp_oTreeShortest[k];
+    p_oNewTree = p_oNew[i].mp_oTreeShortest[k];
+    while (p_oOldTree && p_oNewTree) {
+      if (p_oOldTree->iId != p_oNewTree->iId) return false;
+      p_oOldTree = p_oOldTree->mp_oNext;
+      p_oNewTree = p_oNewTree->mp_oNext;
+    }
+    if (p_oOldTree || p_oNewTree) return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// RunCase()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Sorts the same perturbed cells both ways and prints the timings.
+* @return Whether the two sorts agreed.
+*/
+bool RunCase(int iNumCells, int iNumPerCell, float fShare) {
+  const int iNumReps = 5;
+  stcTree *p_oOldTrees = new stcTree[iNumCells * iNumPerCell],
+          *p_oNewTrees = new stcTree[iNumCells * iNumPerCell];
+  stcCell *p_oOldCells = new stcCell[iNumCells],
+          *p_oNewCells = new stcCell[iNumCells];
+  float *p_fHeights = new float[iNumCells * iNumPerCell];
+  double fOldTime = 0, fNewTime = 0;
+  clock_t tStart;
+  bool bSame = true;
+  int iRep, i, m;
+
+  m_lNumCellsRepaired = 0;
+  m_lNumCellsBulkSorted = 0;
+  srand(11);
+  for (iRep = 0; iRep < iNumReps; iRep++) {
+    //Sorted heights spread over the height divisions, then grow some - or
+    //shuffle them all
+    for (i = 0; i < iNumCells; i++)
+      for (m = 0; m < iNumPerCell; m++) {
+        p_fHeights[i * iNumPerCell + m] = 0.1 +
+            (NUM_HEIGHT_DIVS * SIZE_HEIGHT_DIVS - 0.2) * m / iNumPerCell;
+        if (fShare < 0)
+          p_fHeights[i * iNumPerCell + m] = 0.1 +
+              (NUM_HEIGHT_DIVS * SIZE_HEIGHT_DIVS - 0.2) * rand() / RAND_MAX;
+        else if (rand() < fShare * RAND_MAX)
+          p_fHeights[i * iNumPerCell + m] *= 1.0 + 0.3 * rand() / RAND_MAX;
+      }
+
+    BuildCells(p_oOldTrees, p_oOldCells, iNumCells, iNumPerCell, p_fHeights);
+    BuildCells(p_oNewTrees, p_oNewCells, iNumCells, iNumPerCell, p_fHeights);
+
+    tStart = clock();
+    for (i = 0; i < iNumCells; i++) OldSortCell(p_oOldCells + i);
+    fOldTime += (double)(clock() - tStart) / CLOCKS_PER_SEC;
+    tStart = clock();
+    for (i = 0; i < iNumCells; i++) NewSortCell(p_oNewCells + i);
+    fNewTime += (double)(clock() - tStart) / CLOCKS_PER_SEC;
+
+    if (!SameCells(p_oOldCells, p_oOldTrees, p_oNewCells, p_oNewTrees,
+        iNumCells)) bSame = false;
+  }
+
+  if (fShare < 0) printf("  %10d   shuffled", iNumPerCell);
+  else printf("  %10d  %9.0f%%", iNumPerCell, 100.0 * fShare);
+  printf("  %8.2f  %8.2f  %8ld  %8ld  %s\n", 1000.0 * fOldTime / iNumReps,
+      1000.0 * fNewTime / iNumReps, m_lNumCellsRepaired / iNumReps,
+      m_lNumCellsBulkSorted / iNumReps, bSame ? "same" : "DIFFERENT");
+
+  delete[] p_oOldTrees;
+  delete[] p_oNewTrees;
+  delete[] p_oOldCells;
+  delete[] p_oNewCells;
+  delete[] p_fHeights;
+  return bSame;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// main()
+//////////////////////////////////////////////////////////////////////////////
+int main(int argc, char **argv) {
+  const int p_iSizes[] = {20, 200, 2000};
+  const float p_fShares[] = {0.01, 0.1, 0.5, 1.0, -1};
+  bool bSame = true;
+  int iNumCells = 100, i, j;
+
+  printf("  trees/cell  perturbed  old (ms)  new (ms)  repaired  bulk      "
+      "order\n");
+  if (argc > 3) {
+    iNumCells = atoi(argv[1]);
+    if (iNumCells <= 0 || atoi(argv[2]) <= 0) {
+      fprintf(stderr, "Usage: %s [cells] [trees per cell] [share perturbed]\n",
+          argv[0]);
+      return 1;
+    }
+    bSame = RunCase(iNumCells, atoi(argv[2]), atof(argv[3]));
+  }
+  else {
+    for (i = 0; i < 3; i++)
+      for (j = 0; j < 5; j++)
+        if (!RunCase(iNumCells, p_iSizes[i], p_fShares[j])) bSame = false;
+  }
+
+  delete[] mp_oSortTrees;
+  delete[] mp_fSortHeights;
+  return bSame ? 0 : 1;
+}
@@ -0,0 +1,656 @@
+//---------------------------------------------------------------------------
+// VoxelGliBench.cpp
+//
+// Standalone comparison of clVoxelLight against clGliLight, with the photo
+// at the top of the crown.  It holds a copy of the clGliLight fisheye photo
+// (clGLIBase::GLIFisheyeNoCanopyIntersect() and GLIFisheyeCanopyIntersect(),
+// with the neighbor search done by brute force over a wrapped plot) and of
+// the clVoxelLight voxel grid (SetupRays(), FillVoxels(), AddCrown(),
+// GetBoundaryIndex() and MarchRays()).
+//
+// A random stand of saplings and adults is made, and GLI is found for every
+// tree both ways.  The differences are reported, and then each way is timed.
+// The voxel shell is timed twice: once with every tree needing light, as in
+// a full refresh, and once with only the given share of trees needing it, as
+// in incremental light mode, where boundaries holding only trees that keep
+// their light aren't marched.
+//
+// Both shells get the same sky: a standard overcast sky weighted by the sine
+// of the altitude, which stands in for PopulateGLIBrightnessArray().  Every
+// crown has a light extinction coefficient of 0.4.
+//
+// This does not link against the model.  If GLIBase.cpp, GLILight.cpp or
+// VoxelLight.cpp changes, change the copy here to match.
+//
+// Build and run:
+//   g++ -O2 -o VoxelGliBench VoxelGliBench.cpp -lm
+//   ./VoxelGliBench [trees per ha] [share needing light, 0 - 1]
+// The defaults are 800 and 0.1.  The plot is 200 X 200 m, the sky is 18 X 72
+// with a 0.8 radian minimum sun angle, and voxels 1, 2 and 4 m on a side are
+// tried.
+//---------------------------------------------------------------------------
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define PLOT_LENGTH 200.0
+#define MAX_TREE_HEIGHT 40.0
+#define LIGHT_EXT_COEFF 0.4
+
+//Stand-ins for the clGLIBase and clVoxelLight members the routines use
+int m_iNumAltAng = 18; /**<Number of altitude divisions*/
+int m_iNumAziAng = 72; /**<Number of azimuth divisions*/
+float m_fMinSunAngle = 0.8; /**<Minimum sun angle, in radians*/
+int m_iMinAngRow; /**<First altitude row above the minimum sun angle*/
+float m_fSinMinSunAng; /**<Sine of the minimum sun angle*/
+float m_fRcpTanMinAng; /**<Reciprocal of the tangent of the minimum sun angle*/
+float m_fMaxCrownRad; /**<Largest crown radius in the stand*/
+float **mp_fBrightness; /**<Sky brightness*/
+float *mp_fAziSlope; /**<Slope of the line through each azimuth chunk center*/
+
+float *mp_fExtinction; /**<Extinction rate of each voxel*/
+float *mp_fRayX, *mp_fRayY, *mp_fRayZ, *mp_fRayBrightness; /**<Rays*/
+float m_fVoxelLengthX, m_fVoxelLengthY, m_fVoxelHeight; /**<Voxel size*/
+int m_iNumXVoxels, m_iNumYVoxels, m_iNumLayers, m_iNumRays; /**<Grid size*/
+
+/**Just enough of a tree for light*/
+struct stcTree {
+  float fX, fY, fHeight, fRadius, fDepth;
+};
+
+//////////////////////////////////////////////////////////////////////////////
+// GetWrappedDistance()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Copy of clPlot::GetXDistance() and GetYDistance(): the shortest distance
+* from one coordinate to another, wrapping around the plot.
+*/
+float GetWrappedDistance(float fFrom, float fTo) {
+  float fDist = fTo - fFrom;
+  if (fDist > PLOT_LENGTH / 2) fDist -= PLOT_LENGTH;
+  else if (fDist < -PLOT_LENGTH / 2) fDist += PLOT_LENGTH;
+  return fDist;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// NoCanopyIntersect()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Copy of clGLIBase::GLIFisheyeNoCanopyIntersect().
+*/
+void NoCanopyIntersect(float fXDist, float fYDist, float fNeighCanrad,
+    float fNeighHeight, float fNeighDepth, float fTargetHeight,
+    float fDistToNearEdge, float **p_fPhoto) {
+  float fNearDist, fFarDist, fSquareOfNearDist, fSquareOfFarDist, fDistance,
+        fCanradSquared, fCrownBase, fNeighAzi, fHalfWidth, fChunkSize,
+        fCosChunk, fSinChunk, fChunkX, fChunkY, fTemp, fAlong, fAcross,
+        fHalfChord, fHeightDiff, fHeightDiffSquared, fHeightDiffChunkConv,
+        fCrownBaseDiff, fCrownBaseDiffSquared, fCrownBaseDiffChunkConv;
+  int iAltStart, iAltEnd, iHomeAziChunk, iFirstChunk, iLastChunk, iNumWest,
+      iNumEast, iHalfTheAzis = m_iNumAziAng/2, iAziChunk, i, j;
+
+  fHeightDiff = fNeighHeight - fTargetHeight;
+  if (m_fSinMinSunAng > fHeightDiff /
+       sqrt((fHeightDiff * fHeightDiff) + (fDistToNearEdge * fDistToNearEdge)))
+    return;
+
+  fCrownBase = fNeighHeight - fNeighDepth;
+  fHeightDiffSquared = fHeightDiff * fHeightDiff;
+  fHeightDiffChunkConv = fHeightDiff * m_iNumAltAng;
+  fCrownBaseDiff = fCrownBase - fTargetHeight;
+  fCrownBaseDiffSquared = fCrownBaseDiff * fCrownBaseDiff;
+  fCrownBaseDiffChunkConv = fCrownBaseDiff * m_iNumAltAng;
+  fDistance = sqrt(fXDist * fXDist + fYDist * fYDist);
+  fCanradSquared = fNeighCanrad * fNeighCanrad;
+
+  fChunkSize = (2.0 * M_PI) / m_iNumAziAng;
+  fNeighAzi = atan2(fXDist, fYDist);
+  if (fNeighAzi < 0) fNeighAzi += 2.0 * M_PI;
+  iHomeAziChunk = (int)floor(fNeighAzi / fChunkSize);
+  if (iHomeAziChunk >= m_iNumAziAng) iHomeAziChunk = m_iNumAziAng - 1;
+  fHalfWidth = fNeighCanrad >= fDistance ? M_PI / 2.0 :
+      asin(fNeighCanrad / fDistance);
+  iFirstChunk = (int)ceil((fNeighAzi - fHalfWidth) / fChunkSize - 0.5);
+  iLastChunk = (int)floor((fNeighAzi + fHalfWidth) / fChunkSize - 0.5);
+  iNumWest = iHomeAziChunk - iFirstChunk;
+  iNumEast = iLastChunk - iHomeAziChunk;
+  if (iNumWest < 0) iNumWest = 0;
+  if (iNumEast < 0) iNumEast = 0;
+  if (iNumWest >= iHalfTheAzis - 1) {
+    iNumWest = iHalfTheAzis - 1;
+    iNumEast = 0;
+  }
+  else if (iNumEast > iHalfTheAzis - 1) iNumEast = iHalfTheAzis - 1;
+  if (iNumWest < 0) iNumWest = 0;
+  if (iNumEast < 0) iNumEast = 0;
+
+  fCosChunk = cos(fChunkSize);
+  fSinChunk = sin(fChunkSize);
+  fTemp = (iHomeAziChunk - iNumWest + 0.5) * fChunkSize;
+  fChunkX = sin(fTemp);
+  fChunkY = cos(fTemp);
+  iAziChunk = iHomeAziChunk - iNumWest;
+  if (iAziChunk < 0) iAziChunk += m_iNumAziAng;
+  for (j = -iNumWest; j <= iNumEast; j++) {
+    if (0 == j) {
+      fNearDist = fDistance - fNeighCanrad;
+      fFarDist = fDistance + fNeighCanrad;
+    } else {
+      fAlong = fXDist * fChunkX + fYDist * fChunkY;
+      fAcross = fXDist * fChunkY - fYDist * fChunkX;
+      fHalfChord = fCanradSquared - fAcross * fAcross;
+      fHalfChord = fHalfChord > 0 ? sqrt(fHalfChord) : 0;
+      fNearDist = fAlong - fHalfChord;
+      fFarDist = fAlong + fHalfChord;
+    }
+    fSquareOfNearDist = fNearDist * fNearDist;
+    fSquareOfFarDist = fFarDist * fFarDist;
+
+    iAltStart = (int) (fCrownBaseDiffChunkConv /
+                 sqrt((double)(fSquareOfFarDist + fCrownBaseDiffSquared)));
+    if (iAltStart < m_iMinAngRow)  iAltStart = m_iMinAngRow;
+    iAltEnd = (int) (fHeightDiffChunkConv /
+                 sqrt((double)(fSquareOfNearDist + fHeightDiffSquared)));
+    if (iAltEnd >= m_iNumAltAng)  iAltEnd = m_iNumAltAng - 1;
+
+    for (i = iAltStart; i <= iAltEnd; i++)
+      p_fPhoto[i][iAziChunk] *= LIGHT_EXT_COEFF;
+
+    fTemp = fChunkX * fCosChunk + fChunkY * fSinChunk;
+    fChunkY = fChunkY * fCosChunk - fChunkX * fSinChunk;
+    fChunkX = fTemp;
+    iAziChunk++;
+    if (iAziChunk == m_iNumAziAng) iAziChunk = 0;
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// CanopyIntersect()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Copy of clGLIBase::GLIFisheyeCanopyIntersect().
+*/
+void CanopyIntersect(float fXDist, float fYDist, float fNeighCanrad,
+    float fNeighHeight, float fNeighDepth, float fTargetHeight,
+    float **p_fPhoto) {
+  float fDistToFarEdge, fCrownBase, fX1, fX2, fY1, fY2, fXSolution,
+        fYSolution, fHeightDiff, fA, fB, fC, fCCoeff;
+  short int iAltStart, iAltEnd = m_iNumAltAng - 1, iHalfAzi = m_iNumAziAng/2,
+            iAziChunk, i, j, k;
+
+  fCrownBase = fNeighHeight - fNeighDepth;
+  fHeightDiff = fCrownBase - fTargetHeight;
+  fCCoeff = (fXDist*fXDist) + (fYDist*fYDist) - (fNeighCanrad * fNeighCanrad);
+
+  if (fCrownBase <= fTargetHeight) {
+    for (i = m_iMinAngRow; i <= iAltEnd; i++)
+      for (j = 0; j < m_iNumAziAng; j++)
+        p_fPhoto[i][j] *= LIGHT_EXT_COEFF;
+    return;
+  }
+
+  for (i = 0; i < iHalfAzi; i++) {
+    fA = 1.0 + mp_fAziSlope[i] * mp_fAziSlope[i];
+    fB = -2.0 * (fXDist + mp_fAziSlope[i] * fYDist);
+    fC = fB * fB - 4.0 * fA * fCCoeff;
+    if (fC < 0) fC = 0;
+    fC = sqrt((double) fC);
+    fX1 = (-fB + fC) / (2.0 * fA);
+    fX2 = (-fB - fC) / (2.0 * fA);
+    fY1 = mp_fAziSlope[i] * fX1;
+    fY2 = mp_fAziSlope[i] * fX2;
+    if (fX1  < 0.0) {
+      fC = fX1; fX1 = fX2; fX2 = fC;
+      fC = fY1; fY1 = fY2; fY2 = fC;
+    }
+    for (j = 0; j < 2; j++) {
+      fXSolution = j == 0 ? fX1 : fX2;
+      fYSolution = j == 0 ? fY1 : fY2;
+      iAziChunk = j == 0 ? i : (i + iHalfAzi);
+      fDistToFarEdge = (fXSolution*fXSolution) + (fYSolution*fYSolution);
+      iAltStart = (int)(floor(((fHeightDiff * m_iNumAltAng)
+           / sqrt((fDistToFarEdge) + (fHeightDiff * fHeightDiff)))));
+      if (iAltStart < m_iMinAngRow) iAltStart = m_iMinAngRow;
+      for (k = iAltStart; k <= iAltEnd; k++)
+        p_fPhoto[k][iAziChunk] *= LIGHT_EXT_COEFF;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// CalcGli()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Copy of clGliLight::CalcLightValue() with the photo at the top of the
+* crown.  Neighbors are found by checking every tree.
+*/
+float CalcGli(stcTree *p_oTrees, int iNumTrees, int iTarget,
+    float **p_fPhoto) {
+  stcTree *p_oTarget = p_oTrees + iTarget, *p_oNeighbor;
+  float fMaxSearchRad, fXDist, fYDist, fDistance, fGli;
+  int i, j;
+
+  for (i = 0; i < m_iNumAltAng; i++)
+    for (j = 0; j < m_iNumAziAng; j++)
+      p_fPhoto[i][j] = 1.0;
+
+  fMaxSearchRad = (MAX_TREE_HEIGHT - p_oTarget->fHeight) * m_fRcpTanMinAng +
+      m_fMaxCrownRad;
+  for (i = 0; i < iNumTrees; i++) {
+    p_oNeighbor = p_oTrees + i;
+    if (i == iTarget || p_oNeighbor->fHeight <= p_oTarget->fHeight) continue;
+    fXDist = GetWrappedDistance(p_oTarget->fX, p_oNeighbor->fX);
+    fYDist = GetWrappedDistance(p_oTarget->fY, p_oNeighbor->fY);
+    fDistance = sqrt(fXDist * fXDist + fYDist * fYDist);
+    if (fDistance > fMaxSearchRad) continue;
+    if (fDistance - p_oNeighbor->fRadius > 0)
+      NoCanopyIntersect(fXDist, fYDist, p_oNeighbor->fRadius,
+          p_oNeighbor->fHeight, p_oNeighbor->fDepth, p_oTarget->fHeight,
+          fDistance - p_oNeighbor->fRadius, p_fPhoto);
+    else
+      CanopyIntersect(fXDist, fYDist, p_oNeighbor->fRadius,
+          p_oNeighbor->fHeight, p_oNeighbor->fDepth, p_oTarget->fHeight,
+          p_fPhoto);
+  }
+
+  fGli = 0.0;
+  for (i = 0; i < m_iNumAltAng; i++)
+    for (j = 0; j < m_iNumAziAng; j++)
+      fGli += (p_fPhoto[i][j] * mp_fBrightness[i][j]);
+  return fGli * 100;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// SetupRays()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Copy of clVoxelLight::SetupRays().
+*/
+void SetupRays() {
+  float fSinAlt, fCosAlt, fAzi;
+  int i, j;
+
+  m_iNumRays = 0;
+  for (i = m_iMinAngRow; i < m_iNumAltAng; i++)
+    for (j = 0; j < m_iNumAziAng; j++)
+      if (mp_fBrightness[i][j] > 0) m_iNumRays++;
+
+  mp_fRayX = new float[m_iNumRays];
+  mp_fRayY = new float[m_iNumRays];
+  mp_fRayZ = new float[m_iNumRays];
+  mp_fRayBrightness = new float[m_iNumRays];
+
+  m_iNumRays = 0;
+  for (i = m_iMinAngRow; i < m_iNumAltAng; i++) {
+    fSinAlt = (i + 0.5) / m_iNumAltAng;
+    fCosAlt = sqrt(1 - fSinAlt * fSinAlt);
+    for (j = 0; j < m_iNumAziAng; j++) {
+      if (mp_fBrightness[i][j] <= 0) continue;
+      fAzi = (j + 0.5) * 2.0 * M_PI / m_iNumAziAng;
+      mp_fRayX[m_iNumRays] = fCosAlt * sin(fAzi);
+      mp_fRayY[m_iNumRays] = fCosAlt * cos(fAzi);
+      mp_fRayZ[m_iNumRays] = fSinAlt;
+      mp_fRayBrightness[m_iNumRays] = mp_fBrightness[i][j];
+      m_iNumRays++;
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// AddCrown()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Copy of clVoxelLight::AddCrown().
+*/
+void AddCrown(float fX, float fY, float fBase, float fTop, float fRadius,
+    float fRate) {
+  const int iNumSamples = 4;
+  float fRadiusSq = fRadius * fRadius, fColumnArea, fScale, fDX, fDY,
+        fLayerBottom, fLayerTop;
+  int iMinX, iMaxX, iMinY, iMaxY, iNumHits, iTotalHits, iX, iY, iWrapX,
+      iWrapY, iSX, iSY, iLayer, iFirstLayer, iLastLayer, iColumn, iPass;
+
+  iFirstLayer = (int)floor(fBase / m_fVoxelHeight);
+  iLastLayer = (int)ceil(fTop / m_fVoxelHeight) - 1;
+  if (iFirstLayer < 0) iFirstLayer = 0;
+  if (iLastLayer >= m_iNumLayers) iLastLayer = m_iNumLayers - 1;
+  if (iLastLayer < iFirstLayer) return;
+
+  iMinX = (int)floor((fX - fRadius) / m_fVoxelLengthX);
+  iMaxX = (int)floor((fX + fRadius) / m_fVoxelLengthX);
+  iMinY = (int)floor((fY - fRadius) / m_fVoxelLengthY);
+  iMaxY = (int)floor((fY + fRadius) / m_fVoxelLengthY);
+  if (iMaxX - iMinX >= m_iNumXVoxels) iMaxX = iMinX + m_iNumXVoxels - 1;
+  if (iMaxY - iMinY >= m_iNumYVoxels) iMaxY = iMinY + m_iNumYVoxels - 1;
+  fColumnArea = m_fVoxelLengthX * m_fVoxelLengthY;
+
+  iTotalHits = 0;
+  fScale = 0;
+  for (iPass = 0; iPass < 2; iPass++) {
+    if (1 == iPass) {
+      if (0 == iTotalHits) {
+        iMinX = iMaxX = (int)floor(fX / m_fVoxelLengthX);
+        iMinY = iMaxY = (int)floor(fY / m_fVoxelLengthY);
+        fScale = M_PI * fRadiusSq / fColumnArea;
+      }
+      else fScale = M_PI * fRadiusSq / (fColumnArea * iTotalHits);
+    }
+    for (iX = iMinX; iX <= iMaxX; iX++) {
+      iWrapX = ((iX % m_iNumXVoxels) + m_iNumXVoxels) % m_iNumXVoxels;
+      for (iY = iMinY; iY <= iMaxY; iY++) {
+        iWrapY = ((iY % m_iNumYVoxels) + m_iNumYVoxels) % m_iNumYVoxels;
+        if (1 == iPass && 0 == iTotalHits) iNumHits = 1;
+        else {
+          iNumHits = 0;
+          for (iSX = 0; iSX < iNumSamples; iSX++) {
+            fDX = (iX + (iSX + 0.5) / iNumSamples) * m_fVoxelLengthX - fX;
+            for (iSY = 0; iSY < iNumSamples; iSY++) {
+              fDY = (iY + (iSY + 0.5) / iNumSamples) * m_fVoxelLengthY - fY;
+              if (fDX * fDX + fDY * fDY <= fRadiusSq) iNumHits++;
+            }
+          }
+        }
+        if (0 == iPass) {
+          iTotalHits += iNumHits;
+          continue;
+        }
+        if (0 == iNumHits) continue;
+
+        iColumn = (iWrapX * m_iNumYVoxels + iWrapY) * m_iNumLayers;
+        for (iLayer = iFirstLayer; iLayer <= iLastLayer; iLayer++) {
+          fLayerBottom = iLayer * m_fVoxelHeight;
+          fLayerTop = fLayerBottom + m_fVoxelHeight;
+          if (fLayerBottom < fBase) fLayerBottom = fBase;
+          if (fLayerTop > fTop) fLayerTop = fTop;
+          if (fLayerTop <= fLayerBottom) continue;
+          mp_fExtinction[iColumn + iLayer] += fRate * fScale * iNumHits *
+              (fLayerTop - fLayerBottom) / m_fVoxelHeight;
+        }
+      }
+    }
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// FillVoxels()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Copy of clVoxelLight::FillVoxels().
+*/
+void FillVoxels(stcTree *p_oTrees, int iNumTrees) {
+  float fChord;
+  int iNumVoxels = m_iNumXVoxels * m_iNumYVoxels * m_iNumLayers, i;
+
+  for (i = 0; i < iNumVoxels; i++) mp_fExtinction[i] = 0;
+  for (i = 0; i < iNumTrees; i++) {
+    fChord = 2 * p_oTrees[i].fRadius * p_oTrees[i].fDepth /
+        (p_oTrees[i].fRadius + p_oTrees[i].fDepth);
+    AddCrown(p_oTrees[i].fX, p_oTrees[i].fY,
+        p_oTrees[i].fHeight - p_oTrees[i].fDepth, p_oTrees[i].fHeight,
+        p_oTrees[i].fRadius, -log(LIGHT_EXT_COEFF) / fChord);
+  }
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// GetBoundaryIndex()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Copy of clVoxelLight::GetBoundaryIndex().
+*/
+int GetBoundaryIndex(float fX, float fY, float fHeight) {
+  int iX = (int)floor(fX / m_fVoxelLengthX),
+      iY = (int)floor(fY / m_fVoxelLengthY),
+      iBoundary = (int)ceil(fHeight / m_fVoxelHeight);
+  if (iX < 0) iX = 0;
+  if (iX >= m_iNumXVoxels) iX = m_iNumXVoxels - 1;
+  if (iY < 0) iY = 0;
+  if (iY >= m_iNumYVoxels) iY = m_iNumYVoxels - 1;
+  if (iBoundary < 0) iBoundary = 0;
+  if (iBoundary > m_iNumLayers) iBoundary = m_iNumLayers;
+  return (iX * m_iNumYVoxels + iY) * (m_iNumLayers + 1) + iBoundary;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// MarchRays()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Copy of clVoxelLight::MarchRays().
+*/
+float MarchRays(int iX, int iY, int iBoundary) {
+  const float fMaxDepth = 30;
+  float fGli = 0, fDepth, fT, fNextT, fTMaxX, fTMaxY, fTMaxZ, fTDeltaX,
+        fTDeltaY, fTDeltaZ, fBig = 1.0E30;
+  int iRay, iVX, iVY, iLayer, iStepX, iStepY;
+
+  if (iBoundary >= m_iNumLayers) return 100;
+
+  for (iRay = 0; iRay < m_iNumRays; iRay++) {
+    iVX = iX;
+    iVY = iY;
+    iLayer = iBoundary;
+    iStepX = mp_fRayX[iRay] > 0 ? 1 : -1;
+    iStepY = mp_fRayY[iRay] > 0 ? 1 : -1;
+    fTDeltaX = 0 == mp_fRayX[iRay] ? fBig : m_fVoxelLengthX / fabs(mp_fRayX[iRay]);
+    fTDeltaY = 0 == mp_fRayY[iRay] ? fBig : m_fVoxelLengthY / fabs(mp_fRayY[iRay]);
+    fTDeltaZ = m_fVoxelHeight / mp_fRayZ[iRay];
+    fTMaxX = 0.5 * fTDeltaX;
+    fTMaxY = 0.5 * fTDeltaY;
+    fTMaxZ = fTDeltaZ;
+    fT = 0;
+    fDepth = 0;
+    while (iLayer < m_iNumLayers && fDepth < fMaxDepth) {
+      fNextT = fTMaxX < fTMaxY ? fTMaxX : fTMaxY;
+      if (fTMaxZ < fNextT) fNextT = fTMaxZ;
+      fDepth += mp_fExtinction[(iVX * m_iNumYVoxels + iVY) * m_iNumLayers +
+          iLayer] * (fNextT - fT);
+      fT = fNextT;
+      if (fTMaxZ <= fT) {
+        iLayer++;
+        fTMaxZ += fTDeltaZ;
+      }
+      if (fTMaxX <= fT) {
+        iVX += iStepX;
+        if (iVX < 0) iVX = m_iNumXVoxels - 1;
+        else if (iVX >= m_iNumXVoxels) iVX = 0;
+        fTMaxX += fTDeltaX;
+      }
+      if (fTMaxY <= fT) {
+        iVY += iStepY;
+        if (iVY < 0) iVY = m_iNumYVoxels - 1;
+        else if (iVY >= m_iNumYVoxels) iVY = 0;
+        fTMaxY += fTDeltaY;
+      }
+    }
+    if (fDepth < fMaxDepth) fGli += mp_fRayBrightness[iRay] * exp(-fDepth);
+  }
+  return 100 * fGli;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// VoxelTimestep()
+//////////////////////////////////////////////////////////////////////////////
+/**
+* Does what clVoxelLight::PreLightCalcs() does: fills the voxel grid and
+* marches the boundaries holding trees that need light.
+* @param p_bNeedsLight Whether each tree needs light.
+* @param p_bNeeded Boundary flags, sized like p_fVoxelGli.
+* @param p_fVoxelGli GLI at each boundary.
+* @return Number of boundaries marched.
+*/
+int VoxelTimestep(stcTree *p_oTrees, int iNumTrees, bool *p_bNeedsLight,
+    bool *p_bNeeded, float *p_fVoxelGli) {
+  int iNumBoundaries = m_iNumXVoxels * m_iNumYVoxels * (m_iNumLayers + 1),
+      iColumn, iNumMarched = 0, i;
+
+  FillVoxels(p_oTrees, iNumTrees);
+  for (i = 0; i < iNumBoundaries; i++) p_bNeeded[i] = false;
+  for (i = 0; i < iNumTrees; i++)
+    if (p_bNeedsLight[i])
+      p_bNeeded[GetBoundaryIndex(p_oTrees[i].fX, p_oTrees[i].fY,
+          p_oTrees[i].fHeight)] = true;
+  for (i = 0; i < iNumBoundaries; i++) {
+    if (!p_bNeeded[i]) continue;
+    iColumn = i / (m_iNumLayers + 1);
+    p_fVoxelGli[i] = MarchRays(iColumn / m_iNumYVoxels,
+        iColumn % m_iNumYVoxels, i % (m_iNumLayers + 1));
+    iNumMarched++;
+  }
+  return iNumMarched;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// main()
+//////////////////////////////////////////////////////////////////////////////
+int main(int argc, char *argv[]) {
+  const float p_fVoxelSizes[] = {1, 2, 4};
+  const int iNumSizes = 3;
+  stcTree *p_oTrees;
+  float **p_fPhoto, *p_fGli, *p_fVoxelGli, fTreesPerHa = 800, fShare = 0.1,
+        fSinAlt, fTotal, fDiff, fSumDiff, fSumSqDiff, fMaxDiff, fSumGli,
+        fSumVoxel, fGliTime, fFullTime, fIncTime;
+  bool *p_bNeedsAll, *p_bNeedsSome, *p_bNeeded;
+  clock_t tStart;
+  int iNumTrees, iNumMarchedAll, iNumMarchedSome, iSize, i, j;
+
+  if (argc > 1) fTreesPerHa = atof(argv[1]);
+  if (argc > 2) fShare = atof(argv[2]);
+  if (argc > 3 || fTreesPerHa <= 0 || fShare < 0 || fShare > 1) {
+    fprintf(stderr, "Usage: %s [trees per ha] [share needing light, 0 - 1]\n",
+        argv[0]);
+    return 1;
+  }
+  iNumTrees = (int)(fTreesPerHa * PLOT_LENGTH * PLOT_LENGTH / 10000.0);
+
+  //Sky and GLI setup, as clGliLight::DoShellSetup() does it
+  m_fSinMinSunAng = sin(m_fMinSunAngle);
+  m_iMinAngRow = (int)floor(m_fSinMinSunAng * m_iNumAltAng);
+  m_fRcpTanMinAng = 1 / (tan(m_fMinSunAngle));
+  mp_fAziSlope = new float[m_iNumAziAng];
+  for (i = 0; i < m_iNumAziAng / 2; i++) {
+    mp_fAziSlope[i] = 1/(tan((2.0 * M_PI) / m_iNumAziAng * (i + 0.5)));
+    mp_fAziSlope[i + m_iNumAziAng / 2] = mp_fAziSlope[i];
+  }
+  mp_fBrightness = new float*[m_iNumAltAng];
+  p_fPhoto = new float*[m_iNumAltAng];
+  fTotal = 0;
+  for (i = 0; i < m_iNumAltAng; i++) {
+    mp_fBrightness[i] = new float[m_iNumAziAng];
+    p_fPhoto[i] = new float[m_iNumAziAng];
+    fSinAlt = (i + 0.5) / m_iNumAltAng;
+    for (j = 0; j < m_iNumAziAng; j++) {
+      mp_fBrightness[i][j] = i < m_iMinAngRow ? 0 :
+          fSinAlt * (1 + 2 * fSinAlt);
+      fTotal += mp_fBrightness[i][j];
+    }
+  }
+  for (i = 0; i < m_iNumAltAng; i++)
+    for (j = 0; j < m_iNumAziAng; j++)
+      mp_fBrightness[i][j] /= fTotal;
+  SetupRays();
+
+  //Random stand: heights 1 - 38 m, crown radius 0.5 m plus 15% of height,
+  //crown depth 30 - 70% of height
+  srand(13);
+  p_oTrees = new stcTree[iNumTrees];
+  m_fMaxCrownRad = 0;
+  for (i = 0; i < iNumTrees; i++) {
+    p_oTrees[i].fX = PLOT_LENGTH * rand() / ((float)RAND_MAX + 1);
+    p_oTrees[i].fY = PLOT_LENGTH * rand() / ((float)RAND_MAX + 1);
+    p_oTrees[i].fHeight = 1 + 37.0 * rand() / RAND_MAX;
+    p_oTrees[i].fRadius = 0.5 + 0.15 * p_oTrees[i].fHeight;
+    p_oTrees[i].fDepth = p_oTrees[i].fHeight * (0.3 + 0.4 * rand() / RAND_MAX);
+    if (p_oTrees[i].fRadius > m_fMaxCrownRad)
+      m_fMaxCrownRad = p_oTrees[i].fRadius;
+  }
+  p_bNeedsAll = new bool[iNumTrees];
+  p_bNeedsSome = new bool[iNumTrees];
+  for (i = 0; i < iNumTrees; i++) {
+    p_bNeedsAll[i] = true;
+    p_bNeedsSome[i] = rand() < fShare * RAND_MAX;
+  }
+
+  //clGliLight for every tree
+  p_fGli = new float[iNumTrees];
+  tStart = clock();
+  for (i = 0; i < iNumTrees; i++)
+    p_fGli[i] = CalcGli(p_oTrees, iNumTrees, i, p_fPhoto);
+  fGliTime = (double)(clock() - tStart) / CLOCKS_PER_SEC;
+  fSumGli = 0;
+  for (i = 0; i < iNumTrees; i++) fSumGli += p_fGli[i];
+
+  printf("%.0f m plot, %d trees (%.0f/ha), %d x %d sky, %d rays\n",
+      PLOT_LENGTH, iNumTrees, fTreesPerHa, m_iNumAltAng, m_iNumAziAng,
+      m_iNumRays);
+  printf("clGliLight: mean GLI %.2f, %.1f ms for every tree\n\n",
+      fSumGli / iNumTrees, 1000.0 * fGliTime);
+  printf("  voxel (m)  mean GLI  mean |diff|  RMS diff  max |diff|"
+      "  all (ms)  marched  %3.0f%% (ms)  marched\n", 100.0 * fShare);
+
+  for (iSize = 0; iSize < iNumSizes; iSize++) {
+    m_iNumXVoxels = (int)ceil(PLOT_LENGTH / p_fVoxelSizes[iSize]);
+    m_iNumYVoxels = m_iNumXVoxels;
+    m_fVoxelLengthX = PLOT_LENGTH / m_iNumXVoxels;
+    m_fVoxelLengthY = m_fVoxelLengthX;
+    m_fVoxelHeight = p_fVoxelSizes[iSize];
+    m_iNumLayers = (int)ceil(MAX_TREE_HEIGHT / m_fVoxelHeight);
+    mp_fExtinction = new float[m_iNumXVoxels * m_iNumYVoxels * m_iNumLayers];
+    p_fVoxelGli = new float[m_iNumXVoxels * m_iNumYVoxels * (m_iNumLayers + 1)];
+    p_bNeeded = new bool[m_iNumXVoxels * m_iNumYVoxels * (m_iNumLayers + 1)];
+
+    //Full refresh, compared tree by tree
+    tStart = clock();
+    iNumMarchedAll = VoxelTimestep(p_oTrees, iNumTrees, p_bNeedsAll, p_bNeeded,
+        p_fVoxelGli);
+    fFullTime = (double)(clock() - tStart) / CLOCKS_PER_SEC;
+    fSumDiff = 0;
+    fSumSqDiff = 0;
+    fMaxDiff = 0;
+    fSumVoxel = 0;
+    for (i = 0; i < iNumTrees; i++) {
+      j = GetBoundaryIndex(p_oTrees[i].fX, p_oTrees[i].fY,
+          p_oTrees[i].fHeight);
+      fSumVoxel += p_fVoxelGli[j];
+      fDiff = fabs(p_fVoxelGli[j] - p_fGli[i]);
+      fSumDiff += fDiff;
+      fSumSqDiff += fDiff * fDiff;
+      if (fDiff > fMaxDiff) fMaxDiff = fDiff;
+    }
+
+    //Incremental: only some trees need light
+    tStart = clock();
+    iNumMarchedSome = VoxelTimestep(p_oTrees, iNumTrees, p_bNeedsSome,
+        p_bNeeded, p_fVoxelGli);
+    fIncTime = (double)(clock() - tStart) / CLOCKS_PER_SEC;
+
+    printf("  %9.0f  %8.2f  %11.2f  %8.2f  %10.2f  %8.1f  %7d  %8.1f  %7d\n",
+        p_fVoxelSizes[iSize], fSumVoxel / iNumTrees, fSumDiff / iNumTrees,
+        sqrt(fSumSqDiff / iNumTrees), fMaxDiff, 1000.0 * fFullTime,
+        iNumMarchedAll, 1000.0 * fIncTime, iNumMarchedSome);
+
+    delete[] mp_fExtinction;
+    delete[] p_fVoxelGli;
+    delete[] p_bNeeded;
+  }
+
+  for (i = 0; i < m_iNumAltAng; i++) {
+    delete[] mp_fBrightness[i];
+    delete[] p_fPhoto[i];
+  }
+  delete[] mp_fBrightness;
+  delete[] p_fPhoto;
+  delete[] mp_fAziSlope;
+  delete[] mp_fRayX;
+  delete[] mp_fRayY;
+  delete[] mp_fRayZ;
+  delete[] mp_fRayBrightness;
+  delete[] p_oTrees;
+  delete[] p_bNeedsAll;
+  delete[] p_bNeedsSome;
+  delete[] p_fGli;
+  return 0;
+}